@@ -9,12 +9,18 @@
 #include <d3dcompiler.h>
 #include <ComPtr.h>
 #include <DescriptorPool.h>
+#include <DescriptorRing.h>
+#include <DeferredReleaseQueue.h>
+#include <FrameUploadAllocator.h>
 #include <ColorTarget.h>
 #include <DepthTarget.h>
-#include <CommandList.h>
+#include <CommandListPool.h>
 #include <Fence.h>
+#include <FramePacer.h>
+#include <QueueSyncTracker.h>
 #include <Mesh.h>
 #include <Texture.h>
+#include <ThreadPool.h>
 #include <InlineUtil.h>
 
 #pragma comment(lib, "d3d12.lib")
@@ -31,7 +37,12 @@ class App
 public:
 
 	//! @brief constructor
-	App(uint32_t width, uint32_t height, DXGI_FORMAT format);
+	//! 
+	//! @param[in] width width of window
+	//! @param[in] height height of window
+	//! @param[in] format back buffer format
+	//! @param[in] frameCount frame buffer count, which is also the frame count in flight (2 to MaxFrameCount)
+	App(uint32_t width, uint32_t height, DXGI_FORMAT format, uint32_t frameCount = 2);
 
 	//! @brief destructor
 	virtual ~App();
@@ -52,7 +63,9 @@ protected:
 		POOL_COUNT = 4,
 	};
 
-	static const uint32_t FrameCount = 2; // frame buffer count
+	static const uint32_t MaxFrameCount = FramePacer::MaxFrameCount; // maximum frame buffer count
+	static_assert(MaxFrameCount >= 2, "the frame count is clamped to [2, MaxFrameCount]");
+	static const uint32_t CommandListCount = 16; // maximum commandlist count of a frame
 
 	HINSTANCE m_hInst; // instance handle
 	HWND m_hWnd; // window handle
@@ -62,21 +75,38 @@ protected:
 	ComPtr<IDXGIFactory4> m_pFactory; // DXGI factory
 	ComPtr<ID3D12Device> m_pDevice; // device
 	ComPtr<ID3D12CommandQueue> m_pQueue; // command queue
+	ComPtr<ID3D12CommandQueue> m_pCopyQueue; // command queue for uploads
+	ComPtr<ID3D12CommandQueue> m_pComputeQueue; // command queue for async compute (the direct queue if it is not supported)
 	ComPtr<IDXGISwapChain4> m_pSwapChain; // swap chain
-	ColorTarget m_ColorTarget[FrameCount]; // color target
+	ColorTarget m_ColorTarget[MaxFrameCount]; // color target
 	DepthTarget m_DepthTarget; // depth target
 	DescriptorPool* m_pPool[POOL_COUNT]; // descriptor pool
-	CommandList m_CommandList; // command list
-	Fence m_Fence; // fence
-	uint32_t m_FrameIndex; // frame index
+	DescriptorRing m_DescriptorRing; // transient CBV_SRV_UAV descriptors, valid for the current frame
+	FrameUploadAllocator m_UploadAllocator; // transient constant buffer memory, valid for the current frame
+	CommandListPool m_CommandListPool; // commandlists of the current frame, one per recording thread
+	Fence m_Fence; // fence of the direct queue
+	Fence m_CopyFence; // fence of the copy queue
+	Fence m_ComputeFence; // fence of the compute queue
+	QueueSyncTracker m_QueueSync; // dependencies between the queues
+	FramePacer m_FramePacer; // fence values of frames in flight
+	DeferredReleaseQueue m_ReleaseQueue; // releases resources once the frames which used them have finished
+	ThreadPool m_ThreadPool; // worker threads shared by loading and other background work
+	uint32_t m_FrameCount; // frame buffer count
+	uint32_t m_FrameIndex; // frame index (back buffer)
 	D3D12_VIEWPORT m_Viewport; // view port
 	D3D12_RECT m_Scissor; // scissor quad
 	DXGI_FORMAT m_BackBufferFormat; // back buffer format
 
 	void Present(uint32_t interval);
+	void WaitForGpu();
+	ID3D12CommandQueue* GetQueue(QUEUE_TYPE type) const;
+	UINT64 SignalQueue(QUEUE_TYPE type);
+	void WaitQueue(QUEUE_TYPE waiter, QUEUE_TYPE signaler, UINT64 value);
+	UINT64 GetCompletedValue(QUEUE_TYPE type);
 	bool IsSupportHDR() const;
 	float GetMaxLuminance() const;
 	float GetMinLuminance() const;
+	D3D12_GPU_DESCRIPTOR_HANDLE CreateTransientCBV(const UploadAllocation& allocation);
 
 	virtual bool OnInit()
 	{
@@ -109,6 +139,7 @@ private:
 	void TermD3D();
 	void MainLoop();
 	void CheckSupportHDR();
+	Fence* GetFence(QUEUE_TYPE type);
 
 	static LRESULT CALLBACK WndProc(HWND hWnd, UINT msg, WPARAM wp, LPARAM lp);
 };
\ No newline at end of file
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <set>
+#include <vector>
+
+//
+// BuddyAllocator class
+//
+// Allocates contiguous ranges of indices [0, capacity) in power-of-two blocks.
+// It knows nothing about descriptor heaps, so it can be used for any index space.
+//
+class BuddyAllocator
+{
+
+public:
+
+	static const uint32_t InvalidOffset = UINT32_MAX; //!< returned when allocation fails
+
+	//! @brief constructor
+	BuddyAllocator();
+
+	//! @brief destructor
+	~BuddyAllocator();
+
+	//! @brief initialize
+	//! 
+	//! @param[in] capacity number of indices to manage (need not be a power of two)
+	//! @retval true successfully initialized
+	//! @retval false failed to initialize
+	bool Init(uint32_t capacity);
+
+	//! @brief end
+	void Term();
+
+	//! @brief allocate contiguous range
+	//! 
+	//! @param[in] count number of indices (rounded up to a power of two)
+	//! @return offset of the first index, InvalidOffset if no block is large enough
+	uint32_t Alloc(uint32_t count);
+
+	//! @brief free range
+	//! 
+	//! @param[in] offset offset returned by Alloc()
+	void Free(uint32_t offset);
+
+	//! @brief get size of the block allocated at offset
+	//! 
+	//! @param[in] offset offset returned by Alloc()
+	//! @return block size, 0 if offset is not allocated
+	uint32_t GetBlockSize(uint32_t offset) const;
+
+	//! @brief get total index count
+	//! 
+	//! @return return total index count
+	uint32_t GetCapacity() const;
+
+	//! @brief get allocated index count (including rounding)
+	//! 
+	//! @return return allocated index count
+	uint32_t GetUsedCount() const;
+
+	//! @brief get size of the largest free block
+	//! 
+	//! @return return size of the largest free block
+	uint32_t GetLargestFreeBlock() const;
+
+private:
+
+	static const uint8_t NotAllocated = 0xff;
+
+	std::vector<std::set<uint32_t>> m_FreeList; //!< free block offsets per level (block size = 1 << level)
+	std::vector<uint8_t> m_AllocLevel; //!< level of the block allocated at each offset
+	uint32_t m_Capacity; //!< total index count
+	uint32_t m_UsedCount; //!< allocated index count
+
+	BuddyAllocator(const BuddyAllocator&) = delete;
+	void operator = (const BuddyAllocator&) = delete;
+};
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <d3d12.h>
+#include <ComPtr.h>
+#include <CommandList.h>
+#include <Fence.h>
+#include <StagingPlanner.h>
+#include <vector>
+
+//
+// BufferUploadBatch class
+//
+// Stages buffer data through upload chunks and copies it into DEFAULT heap buffers.
+// On a copy queue no barrier is recorded: buffers decay to COMMON when the copy finishes
+// and are promoted implicitly on first use. On a direct queue all transitions are issued
+// as one ResourceBarrier call at the end of the batch.
+// At most maxChunkCount chunks are kept: when an upload needs more, the staged copies are
+// submitted and waited for, and the chunks are reused for the rest of the batch.
+//
+class BufferUploadBatch
+{
+
+public:
+
+	static const uint64_t DefaultChunkSize = 4 * 1024 * 1024; //!< default size of one staging chunk
+	static const uint32_t DefaultMaxChunkCount = 8; //!< default cap of staging chunks (32 MB)
+
+	//! @brief constructor
+	BufferUploadBatch();
+
+	//! @brief destructor
+	~BufferUploadBatch();
+
+	//! @brief initialize
+	//! 
+	//! @param[in] pDevice device
+	//! @param[in] pQueue command queue to submit copies to (copy or direct)
+	//! @param[in] chunkSize size of one staging chunk
+	//! @param[in] maxChunkCount maximum number of staging chunks kept alive
+	//! @retval true successfully initialized
+	//! @retval false failed to initialize
+	bool Init(
+		ID3D12Device* pDevice,
+		ID3D12CommandQueue* pQueue,
+		uint64_t chunkSize = DefaultChunkSize,
+		uint32_t maxChunkCount = DefaultMaxChunkCount);
+
+	//! @brief end
+	//! @note waits for the copies submitted last before releasing the staging chunks
+	void Term();
+
+	//! @brief begin batch
+	//! @note waits for the copies of the previous batch, whose staging chunks are reused
+	void Begin();
+
+	//! @brief upload data to a DEFAULT heap buffer
+	//! 
+	//! @param[in] pDst destination buffer (created in COMMON state)
+	//! @param[in] dstOffset offset in the destination
+	//! @param[in] pData data to upload (copied before returning)
+	//! @param[in] size size in bytes
+	//! @param[in] stateAfter state of the buffer after the batch (used on a direct queue)
+	//! @retval true successfully staged
+	//! @retval false failed to stage
+	//! @note may submit and wait for the copies staged so far when the staging chunks are full
+	bool Upload(
+		ID3D12Resource* pDst,
+		UINT64 dstOffset,
+		const void* pData,
+		UINT64 size,
+		D3D12_RESOURCE_STATES stateAfter);
+
+	//! @brief submit the batch without waiting for completion
+	//! 
+	//! @return return value of the batch's own fence which frees the staging chunks, 0 if failed
+	//! @note queues using the buffers have to wait for a value signaled on the queue afterwards
+	UINT64 End();
+
+	//! @brief get device
+	//! 
+	//! @return return device
+	ID3D12Device* GetDevice() const;
+
+private:
+
+	//
+	// Target structure
+	//
+	struct Target
+	{
+		ComPtr<ID3D12Resource> pResource; //!< destination buffer
+		D3D12_RESOURCE_STATES StateAfter; //!< state after the batch
+	};
+
+	ComPtr<ID3D12Device> m_pDevice; //!< device
+	ComPtr<ID3D12CommandQueue> m_pQueue; //!< command queue
+	D3D12_COMMAND_LIST_TYPE m_Type; //!< command list type of the queue
+	CommandList m_CommandList; //!< command list
+	Fence m_Fence; //!< fence
+	StagingPlanner m_Planner; //!< staging layout
+	std::vector<ComPtr<ID3D12Resource>> m_pChunks; //!< staging chunks
+	std::vector<uint8_t*> m_pChunkPtrs; //!< memory-mapped pointers of staging chunks
+	std::vector<Target> m_Targets; //!< destination buffers
+	uint32_t m_MaxChunkCount; //!< maximum number of staging chunks
+	UINT64 m_FenceValue; //!< fence value of the last submission
+	bool m_IsOpen; //!< whether Begin() has been called
+
+	bool AddChunks();
+	UINT64 Submit();
+	bool WaitChunks();
+
+	BufferUploadBatch(const BufferUploadBatch&) = delete;
+	void operator = (const BufferUploadBatch&) = delete;
+};
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <d3d12.h>
+#include <ComPtr.h>
+#include <cstdint>
+#include <atomic>
+#include <vector>
+
+//! @brief get count of command lists to record draws with
+//!
+//! @param[in] drawCount draw count
+//! @param[in] maxListCount maximum list count
+//! @param[in] minDrawsPerList draws one list takes at least, since each list pays for its state setup
+//! @return return list count, 0 if there is nothing to draw
+uint32_t GetRecordingListCount(uint32_t drawCount, uint32_t maxListCount, uint32_t minDrawsPerList);
+
+//! @brief get the first draw which a command list records
+//!
+//! @param[in] drawCount draw count
+//! @param[in] listCount list count returned by GetRecordingListCount()
+//! @param[in] listIndex index of the list (listCount gives the end of the last list)
+//! @return return index of the first draw
+uint32_t GetRecordingBegin(uint32_t drawCount, uint32_t listCount, uint32_t listIndex);
+
+//
+// CommandListPool class
+//
+// Command lists for recording one frame on several threads. Every list has one allocator per
+// frame in flight, so Acquire() can reset them on any thread without locking. The lists are
+// submitted in the order the caller chooses, not in the order they were acquired.
+//
+class CommandListPool
+{
+
+public:
+
+	//! @brief constructor
+	CommandListPool();
+
+	//! @brief destructor
+	~CommandListPool();
+
+	//! @brief initialize
+	//!
+	//! @param[in] pDevice device
+	//! @param[in] type type of commandlist
+	//! @param[in] frameCount frame count in flight
+	//! @param[in] listCount maximum list count of a frame
+	//! @retval true successfully initialized
+	//! @retval false failed to initialize
+	bool Init(ID3D12Device* pDevice, D3D12_COMMAND_LIST_TYPE type, uint32_t frameCount, uint32_t listCount);
+
+	//! @brief end
+	void Term();
+
+	//! @brief begin frame, making every list available again
+	//!
+	//! @param[in] frameIndex frame index (the GPU must have finished the frame which last used it)
+	void Begin(uint32_t frameIndex);
+
+	//! @brief get a reset commandlist of the current frame
+	//!
+	//! @return return reset commandlist, nullptr if every list of the frame is in use
+	//! @note thread safe. the list must be closed before it is submitted
+	ID3D12GraphicsCommandList* Acquire();
+
+	//! @brief get maximum list count of a frame
+	//!
+	//! @return return list count
+	uint32_t GetListCount() const;
+
+	//! @brief get count of lists acquired in the current frame
+	//!
+	//! @return return acquired list count
+	uint32_t GetAcquiredCount() const;
+
+private:
+
+	std::vector<ComPtr<ID3D12GraphicsCommandList>> m_pCmdLists; //!< commandlists
+	std::vector<ComPtr<ID3D12CommandAllocator>> m_pAllocators; //!< command allocators (frame major)
+	uint32_t m_FrameCount; //!< frame count in flight
+	uint32_t m_ListCount; //!< maximum list count of a frame
+	uint32_t m_FrameIndex; //!< current frame index
+	std::atomic<uint32_t> m_Acquired; //!< count of lists acquired in the current frame
+
+	CommandListPool(const CommandListPool&) = delete;
+	void operator = (const CommandListPool&) = delete;
+};
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <ThreadPool.h>
+#include <cstdint>
+#include <atomic>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <vector>
+
+//
+// COMPILE_STATE enum
+//
+enum COMPILE_STATE
+{
+	COMPILE_STATE_QUEUED = 0, //!< waiting for a worker
+	COMPILE_STATE_COMPILING, //!< being compiled on a worker
+	COMPILE_STATE_READY, //!< ready to use
+	COMPILE_STATE_FAILED, //!< failed to compile
+	COMPILE_STATE_CANCELED, //!< canceled before it became ready
+};
+
+//
+// PipelineCompiler class
+//
+// Work of one request which the scheduler drives. Compile() runs on pool threads, Finish()
+// on the thread which calls CompileScheduler::Update().
+//
+class PipelineCompiler
+{
+public:
+	virtual ~PipelineCompiler()
+	{
+		// Do Nothing//
+	}
+
+	//! @brief compile a request (worker thread)
+	virtual bool Compile(uint32_t id) = 0;
+
+	//! @brief take the result of a request (COMPILE_STATE_READY, FAILED or CANCELED)
+	virtual void Finish(uint32_t id, COMPILE_STATE state) = 0;
+};
+
+//
+// CompileScheduler class
+//
+// Request queue of background compilation, independent of D3D12. At most maxInFlight
+// requests compile at once and higher priorities leave the queue first (requests of the
+// same priority in request order). Requests of the same key share one id while they are
+// queued, compiling or ready. A canceled request never becomes ready: if it is already
+// compiling, its result is handed to Finish() as canceled.
+//
+class CompileScheduler
+{
+
+public:
+
+	//
+	// Result structure
+	//
+	struct Result
+	{
+		uint32_t Id; //!< request id
+		COMPILE_STATE State; //!< COMPILE_STATE_READY, FAILED or CANCELED
+	};
+
+	static const uint32_t InvalidId = UINT32_MAX;
+
+	//! @brief constructor
+	CompileScheduler();
+
+	//! @brief destructor
+	~CompileScheduler();
+
+	//! @brief initialize
+	//!
+	//! @param[in] pCompiler work of a request
+	//! @param[in] pWorkerPool threads which run Compile() (an uninitialized pool runs it inline)
+	//! @param[in] maxInFlight maximum request count compiling at once
+	//! @retval true successfully initialized
+	//! @retval false failed to initialize
+	bool Init(PipelineCompiler* pCompiler, ThreadPool* pWorkerPool, uint32_t maxInFlight);
+
+	//! @brief end
+	//!
+	//! @note waits for Compile() calls in flight. requests left are dropped without Finish()
+	void Term();
+
+	//! @brief queue a request
+	//!
+	//! @param[in] key identity of the work (a failed or canceled key is queued again)
+	//! @param[in] priority higher values are started first
+	//! @return return request id
+	uint32_t Request(uint64_t key, int priority = 0);
+
+	//! @brief cancel a request
+	//!
+	//! @param[in] id request id
+	//! @retval true canceled, Update() reports it as COMPILE_STATE_CANCELED
+	//! @retval false the request is unknown or has already finished
+	bool Cancel(uint32_t id);
+
+	//! @brief start queued requests and report finished ones
+	//!
+	//! @param[out] results requests which finished since the last call (Finish() has been called for each)
+	void Update(std::vector<Result>& results);
+
+	//! @brief get state of a request
+	//!
+	//! @param[in] id request id
+	//! @return return state (COMPILE_STATE_FAILED for an unknown id)
+	COMPILE_STATE GetState(uint32_t id) const;
+
+	//! @brief check whether every request has finished
+	//!
+	//! @retval true no request is queued or compiling
+	bool IsIdle() const;
+
+private:
+
+	//
+	// Entry structure
+	//
+	struct Entry
+	{
+		uint64_t Key; //!< identity of the work
+		COMPILE_STATE State; //!< current state
+		bool IsCanceled; //!< whether the request was canceled while compiling
+	};
+
+	PipelineCompiler* m_pCompiler; //!< work of a request
+	ThreadPool* m_pWorkerPool; //!< threads which compile
+	uint32_t m_MaxInFlight; //!< maximum request count compiling at once
+	uint32_t m_InFlight; //!< request count compiling
+	std::vector<Entry> m_Entries; //!< every request (index is the id)
+	std::map<uint64_t, uint32_t> m_Ids; //!< live id of each key
+	std::multimap<int, uint32_t, std::greater<int>> m_Queue; //!< queued requests by priority
+	std::vector<uint32_t> m_Canceled; //!< queued requests canceled since the last Update()
+	std::vector<std::pair<uint32_t, bool>> m_Finished; //!< requests which left the pool threads
+	mutable std::mutex m_Mutex; //!< guards m_Entries states and m_Finished
+	std::atomic<uint32_t> m_Tasks; //!< Compile() calls in flight
+
+	void Dispatch(uint32_t id);
+	void SetState(uint32_t id, COMPILE_STATE state);
+
+	CompileScheduler(const CompileScheduler&) = delete;
+	void operator = (const CompileScheduler&) = delete;
+};
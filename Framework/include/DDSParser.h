@@ -0,0 +1,103 @@
+#pragma once
+
+#include <d3d12.h>
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+//
+// DDSSubresource structure
+//
+struct DDSSubresource
+{
+	size_t Offset; //!< offset of the data from the beginning of the file
+	size_t Size; //!< size of the data in bytes (SlicePitch * Depth)
+	size_t SlicePitch; //!< bytes per depth slice (RowPitch * RowCount)
+	uint32_t Width; //!< width in pixels
+	uint32_t Height; //!< height in pixels
+	uint32_t Depth; //!< depth in pixels (1 unless the texture is 3D)
+	uint32_t RowPitch; //!< bytes per row (a row of 4x4 blocks for block compressed formats)
+	uint32_t RowCount; //!< row count (of blocks for block compressed formats)
+};
+
+//
+// DDSInfo structure
+//
+struct DDSInfo
+{
+	D3D12_RESOURCE_DIMENSION Dimension; //!< TEXTURE1D, TEXTURE2D or TEXTURE3D
+	uint32_t Width; //!< width of mip 0
+	uint32_t Height; //!< height of mip 0
+	uint32_t Depth; //!< depth of mip 0 (1 unless the texture is 3D)
+	uint32_t ArraySize; //!< array slice count (6 per cube for cube maps)
+	uint32_t MipCount; //!< mip level count
+	DXGI_FORMAT Format; //!< pixel format
+	bool IsCube; //!< whether the slices are cube faces
+	std::vector<DDSSubresource> Subresources; //!< location of each subresource (index = mip + slice * MipCount)
+};
+
+//! @brief parse a DDS file in memory
+//!
+//! @param[in] pData contents of the file
+//! @param[in] size size of the contents
+//! @param[out] info layout of the texture
+//! @retval true successfully parsed
+//! @retval false not a DDS file, unsupported format or truncated data
+//! @note the data is not copied. offsets refer to pData
+bool ParseDDS(const void* pData, size_t size, DDSInfo& info);
+
+//! @brief get resource description of a DDS texture
+//!
+//! @param[in] info layout of the texture
+//! @param[in] firstMip most detailed mip of the resource
+//! @return return description of a resource holding mips [firstMip, MipCount) of every slice
+D3D12_RESOURCE_DESC GetDDSResourceDesc(const DDSInfo& info, uint32_t firstMip = 0);
+
+//! @brief lay out subresources of a DDS texture in a staging buffer
+//!
+//! @param[in] info layout of the texture
+//! @param[in] firstMip most detailed mip to lay out
+//! @param[in] baseOffset offset where the first subresource may start
+//! @param[out] layouts footprint of each subresource of GetDDSResourceDesc(info, firstMip)
+//! @return return offset just past the last subresource
+//! @note follows the row pitch and placement alignment of ID3D12Device::GetCopyableFootprints()
+UINT64 GetDDSFootprints(
+	const DDSInfo& info,
+	uint32_t firstMip,
+	UINT64 baseOffset,
+	std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT>& layouts);
+
+//! @brief copy a subresource from the file into a staging buffer
+//!
+//! @param[in] pFile contents of the file
+//! @param[in] src subresource in the file
+//! @param[in] layout footprint of the subresource in the staging buffer
+//! @param[out] pStaging beginning of the staging buffer
+void CopyDDSSubresource(
+	const uint8_t* pFile,
+	const DDSSubresource& src,
+	const D3D12_PLACED_SUBRESOURCE_FOOTPRINT& layout,
+	uint8_t* pStaging);
+
+//! @brief get size of one pixel
+//!
+//! @param[in] format pixel format
+//! @return return bits per pixel (block compressed formats are averaged over a block), 0 if unsupported
+uint32_t GetBitsPerPixel(DXGI_FORMAT format);
+
+//! @brief check whether a format is compressed in 4x4 blocks
+//!
+//! @param[in] format pixel format
+//! @retval true BC1 to BC7
+bool IsBlockCompressed(DXGI_FORMAT format);
+
+//! @brief compute tightly packed layout of one surface
+//!
+//! @param[in] width width in pixels
+//! @param[in] height height in pixels
+//! @param[in] format pixel format
+//! @param[out] rowPitch bytes per row (of blocks)
+//! @param[out] rowCount row count (of blocks)
+//! @retval true successfully computed
+//! @retval false unsupported format
+bool GetSurfaceInfo(uint32_t width, uint32_t height, DXGI_FORMAT format, uint32_t& rowPitch, uint32_t& rowCount);
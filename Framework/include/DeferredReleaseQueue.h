@@ -0,0 +1,140 @@
+#pragma once
+
+#include <d3d12.h>
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <functional>
+
+//
+// Forward Declarations.
+//
+class DescriptorPool;
+class DescriptorHandle;
+
+//
+// DeferredReleaseQueue class
+//
+// Releases GPU objects once the fence value of their last use has completed, so a resource
+// or a descriptor can be dropped while frames in flight still read it. Push methods may be
+// called from any thread without locking: an entry is linked onto a stack with one CAS.
+// Collect() is called from one thread. It takes every pushed entry at once and releases
+// those whose value has completed in one batch.
+//
+class DeferredReleaseQueue
+{
+
+public:
+
+	//! @brief constructor
+	DeferredReleaseQueue();
+
+	//! @brief destructor
+	~DeferredReleaseQueue();
+
+	//! @brief end
+	//!
+	//! @note releases every entry, so the GPU must be idle. producers must have stopped
+	void Term();
+
+	//! @brief set the value which the frame being recorded will signal
+	//!
+	//! @param[in] value fence value which push methods without a value are tagged with
+	void SetFenceValue(uint64_t value);
+
+	//! @brief get the value which push methods without a value are tagged with
+	//!
+	//! @return return fence value
+	uint64_t GetFenceValue() const;
+
+	//! @brief release an object after a fence value
+	//!
+	//! @param[in] pObject object whose reference is taken over
+	//! @param[in] fenceValue fence value of the last use
+	//! @retval true queued
+	//! @retval false out of memory. the reference is left to the caller
+	bool Push(IUnknown* pObject, uint64_t fenceValue);
+
+	//! @brief release an object after the frame being recorded
+	//!
+	//! @param[in] pObject object whose reference is taken over
+	//! @retval true queued
+	//! @retval false out of memory. the reference is left to the caller
+	bool Push(IUnknown* pObject);
+
+	//! @brief free a descriptor handle after a fence value
+	//!
+	//! @param[in] pPool pool the handle belongs to (kept alive until the handle is freed)
+	//! @param[in] pHandle handle to free
+	//! @param[in] fenceValue fence value of the last use
+	//! @retval true queued
+	//! @retval false out of memory. the handle is left to the caller
+	bool PushHandle(DescriptorPool* pPool, DescriptorHandle* pHandle, uint64_t fenceValue);
+
+	//! @brief free a descriptor handle after the frame being recorded
+	//!
+	//! @param[in] pPool pool the handle belongs to (kept alive until the handle is freed)
+	//! @param[in] pHandle handle to free
+	//! @retval true queued
+	//! @retval false out of memory. the handle is left to the caller
+	bool PushHandle(DescriptorPool* pPool, DescriptorHandle* pHandle);
+
+	//! @brief run a function after a fence value
+	//!
+	//! @param[in] func function which frees something, called on the thread of Collect()
+	//! @param[in] fenceValue fence value of the last use
+	//! @retval true queued
+	//! @retval false out of memory
+	bool PushCallback(std::function<void()> func, uint64_t fenceValue);
+
+	//! @brief run a function after the frame being recorded
+	//!
+	//! @param[in] func function which frees something, called on the thread of Collect()
+	//! @retval true queued
+	//! @retval false out of memory
+	bool PushCallback(std::function<void()> func);
+
+	//! @brief release entries whose fence value has completed
+	//!
+	//! @param[in] completedValue completed fence value
+	//! @return return count of released entries
+	size_t Collect(uint64_t completedValue);
+
+	//! @brief get count of entries not released yet
+	//!
+	//! @return return entry count
+	size_t GetPendingCount() const;
+
+private:
+
+	//
+	// Entry structure
+	//
+	struct Entry
+	{
+		Entry* pNext; //!< next entry
+		uint64_t FenceValue; //!< fence value of the last use
+		IUnknown* pObject; //!< object to release
+		DescriptorPool* pPool; //!< pool of pHandle
+		DescriptorHandle* pHandle; //!< handle to free
+		std::function<void()> Callback; //!< function to run
+	};
+
+	std::atomic<Entry*> m_pHead; //!< entries pushed since the last Collect()
+	Entry* m_pPending; //!< entries taken by Collect() whose value has not completed
+	std::atomic<uint64_t> m_FenceValue; //!< value of the frame being recorded
+	std::atomic<size_t> m_Count; //!< count of entries not released yet
+
+	//! @brief link an entry onto the stack
+	//!
+	//! @param[in] pEntry entry
+	void Link(Entry* pEntry);
+
+	//! @brief release an entry
+	//!
+	//! @param[in] pEntry entry, deleted by this call
+	static void Release(Entry* pEntry);
+
+	DeferredReleaseQueue(const DeferredReleaseQueue&) = delete;
+	void operator = (const DeferredReleaseQueue&) = delete;
+};
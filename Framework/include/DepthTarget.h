@@ -41,6 +41,47 @@ public:
 		float clearDepth,
 		uint8_t clearStencil);
 
+	//! @brief initialize in a heap
+	//! 
+	//! @param[in] pDevice device
+	//! @param[in] pPoolDSV descriptor pool
+	//! @param[in] pPoolSRV descriptor pool (for SRV, optional)
+	//! @param[in] width width
+	//! @param[in] height height
+	//! @param[in] format pixel format
+	//! @param[in] clearDepth clear depth
+	//! @param[in] clearStencil clear stencil
+	//! @param[in] pHeap heap to place the target in (nullptr for a committed resource)
+	//! @param[in] heapOffset offset in the heap, aligned as GetAllocationInfo() reports
+	//! @param[in] state initial resource state
+	//! @retval true successfully initialized
+	//! @retval false failed to initialize
+	bool Init(
+		ID3D12Device* pDevice,
+		DescriptorPool* pPoolDSV,
+		DescriptorPool* pPoolSRV,
+		uint32_t width,
+		uint32_t height,
+		DXGI_FORMAT format,
+		float clearDepth,
+		uint8_t clearStencil,
+		ID3D12Heap* pHeap,
+		UINT64 heapOffset,
+		D3D12_RESOURCE_STATES state);
+
+	//! @brief get allocation size and alignment of a target
+	//! 
+	//! @param[in] pDevice device
+	//! @param[in] width width
+	//! @param[in] height height
+	//! @param[in] format pixel format
+	//! @return return size and alignment in a heap
+	static D3D12_RESOURCE_ALLOCATION_INFO GetAllocationInfo(
+		ID3D12Device* pDevice,
+		uint32_t width,
+		uint32_t height,
+		DXGI_FORMAT format);
+
 	//! @brief end
 	void Term();
 
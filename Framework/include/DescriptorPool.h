@@ -2,8 +2,10 @@
 
 #include <d3d12.h>
 #include <atomic>
+#include <mutex>
 #include <ComPtr.h>
-#include <Pool.h>
+#include <LockFreePool.h>
+#include <BuddyAllocator.h>
 
 // DescriptorHandle class
 class DescriptorHandle
@@ -23,6 +25,31 @@ public:
 	}
 };
 
+// DescriptorRange class
+class DescriptorRange
+{
+public:
+	D3D12_CPU_DESCRIPTOR_HANDLE HandleCPU; //!< CPU handle of the first descriptor
+	D3D12_GPU_DESCRIPTOR_HANDLE HandleGPU; //!< GPU handle of the first descriptor (use as descriptor table)
+	uint32_t Offset; //!< index of the first descriptor in the heap
+	uint32_t Count; //!< descriptor count
+	uint32_t Increment; //!< descriptor handle increment size
+
+	D3D12_CPU_DESCRIPTOR_HANDLE GetHandleCPU(uint32_t index) const
+	{
+		auto handle = HandleCPU;
+		handle.ptr += SIZE_T(Increment) * index;
+		return handle;
+	}
+
+	D3D12_GPU_DESCRIPTOR_HANDLE GetHandleGPU(uint32_t index) const
+	{
+		auto handle = HandleGPU;
+		handle.ptr += UINT64(Increment) * index;
+		return handle;
+	}
+};
+
 // DescriptorPool class
 class DescriptorPool
 {
@@ -43,6 +70,20 @@ public:
 		const D3D12_DESCRIPTOR_HEAP_DESC* pDesc,
 		DescriptorPool** ppPool);
 
+	//! @brief generate
+	//! 
+	//! @param[in] pDevice device
+	//! @param[in] pDesc configuration settings of descriptorheap
+	//! @param[in] rangeCount descriptors reserved at the end of the heap for AllocRange()
+	//! @param[out] ppPool container of descriptorpool
+	//! @retval true successfully generated
+	//! @retval false failed to generate
+	static bool Create(
+		ID3D12Device* pDevice,
+		const D3D12_DESCRIPTOR_HEAP_DESC* pDesc,
+		uint32_t rangeCount,
+		DescriptorPool** ppPool);
+
 	//! @brief QƃJEg𑝂₷
 	void AddRef();
 
@@ -62,8 +103,20 @@ public:
 	//! @brief release descriptorhandle
 	//! 
 	//! @param[in] pHandle pointer to handle to release
+	//! @note the handle is reused at once. while frames in flight may read it, use DeferredReleaseQueue::PushHandle()
 	void FreeHandle(DescriptorHandle*& pHandle);
 
+	//! @brief allocate contiguous descriptors
+	//! 
+	//! @param[in] count descriptor count
+	//! @return return allocated range, nullptr if allocation failed
+	DescriptorRange* AllocRange(uint32_t count);
+
+	//! @brief release contiguous descriptors
+	//! 
+	//! @param[in] pRange pointer to range to release
+	void FreeRange(DescriptorRange*& pRange);
+
 	//! @brief get available handle count
 	//! 
 	//! @return return available handle count
@@ -84,11 +137,20 @@ public:
 	//! @return release descriptor heap
 	ID3D12DescriptorHeap* const GetHeap() const;
 
+	//! @brief get index of a descriptor in the heap
+	//! 
+	//! @param[in] handle GPU descriptor handle allocated from this pool
+	//! @return return index from the heap start (as seen by an unbounded range at the heap start)
+	uint32_t GetIndex(D3D12_GPU_DESCRIPTOR_HANDLE handle) const;
+
 private:
 
 	//private variables
 	std::atomic<uint32_t> m_RefCount;
-	Pool<DescriptorHandle> m_Pool;
+	LockFreePool<DescriptorHandle> m_Pool; //!< lock-free, so loader threads can allocate handles concurrently
+	BuddyAllocator m_RangeAllocator; //!< sub-allocator for contiguous ranges
+	std::mutex m_RangeMutex; //!< guards m_RangeAllocator
+	uint32_t m_RangeBase; //!< heap index where the range region begins
 	ComPtr<ID3D12DescriptorHeap> m_pHeap;
 	uint32_t m_DescriptorSize;
 
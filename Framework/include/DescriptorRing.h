@@ -0,0 +1,58 @@
+#pragma once
+
+#include <DescriptorPool.h>
+#include <RingAllocator.h>
+
+//
+// DescriptorRing class
+//
+// Per-frame descriptors for transient views. Alloc() is a bump of the ring head and
+// there is no per-handle free; a whole frame is reclaimed once its fence value has completed.
+//
+class DescriptorRing
+{
+
+public:
+
+	//! @brief constructor
+	DescriptorRing();
+
+	//! @brief destructor
+	~DescriptorRing();
+
+	//! @brief initialize
+	//! 
+	//! @param[in] pPool descriptor pool (must have a range region)
+	//! @param[in] count descriptor count of the ring
+	//! @retval true successfully initialized
+	//! @retval false failed to initialize
+	bool Init(DescriptorPool* pPool, uint32_t count);
+
+	//! @brief end
+	void Term();
+
+	//! @brief allocate descriptors valid until the current frame retires
+	//! 
+	//! @param[in] count descriptor count (contiguous)
+	//! @return return handle of the first descriptor, empty handle if the ring is full
+	DescriptorHandle Alloc(uint32_t count = 1);
+
+	//! @brief close the current frame
+	//! 
+	//! @param[in] fenceValue fence value signaled after the frame
+	void FinishFrame(uint64_t fenceValue);
+
+	//! @brief reclaim descriptors of completed frames
+	//! 
+	//! @param[in] completedValue completed fence value
+	void Retire(uint64_t completedValue);
+
+private:
+
+	DescriptorPool* m_pPool; //!< descriptor pool
+	DescriptorRange* m_pRange; //!< descriptors owned by the ring
+	RingAllocator m_Allocator; //!< allocation policy
+
+	DescriptorRing(const DescriptorRing&) = delete;
+	void operator = (const DescriptorRing&) = delete;
+};
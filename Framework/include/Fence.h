@@ -38,6 +38,35 @@ public:
 	//! @param[in] pQueue command queue
 	void Sync(ID3D12CommandQueue* pQueue);
 
+	//! @brief signal the next value without waiting
+	//! 
+	//! @param[in] pQueue command queue
+	//! @return return the signaled value, 0 if it could not be signaled
+	UINT64 Signal(ID3D12CommandQueue* pQueue);
+
+	//! @brief wait for specified time until a value has completed
+	//! 
+	//! @param[in] value fence value returned by Signal()
+	//! @param[in] timeout timeout time (milisec)
+	//! @retval true the value has completed
+	//! @retval false timed out or failed to wait
+	bool WaitFor(UINT64 value, UINT timeout);
+
+	//! @brief get the value which the next Signal(), Wait() or Sync() will signal
+	//! 
+	//! @return return the next fence value
+	UINT64 GetNextValue() const;
+
+	//! @brief get completed value
+	//! 
+	//! @return return the value the GPU has reached
+	UINT64 GetCompletedValue() const;
+
+	//! @brief get fence
+	//! 
+	//! @return return fence object, which another queue can wait for
+	ID3D12Fence* GetPtr() const;
+
 private:
 
 	ComPtr<ID3D12Fence> m_pFence; //!< fence
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+
+//
+// FramePacer class
+//
+// Bookkeeping of frames in flight, independent of D3D12. Frames are recorded into slots in
+// turn, and each slot remembers the fence value signaled after the last frame recorded into
+// it. The CPU only waits for that value before it reuses the slot's command allocator and
+// upload memory, so up to frameCount frames can be queued on the GPU.
+//
+class FramePacer
+{
+
+public:
+
+	static const uint32_t MaxFrameCount = 3; //!< maximum frame count in flight (App sizes its back buffers by it)
+
+	//! @brief constructor
+	FramePacer();
+
+	//! @brief destructor
+	~FramePacer();
+
+	//! @brief initialize
+	//!
+	//! @param[in] frameCount frame count in flight (1 waits for every frame)
+	//! @retval true successfully initialized
+	//! @retval false failed to initialize
+	bool Init(uint32_t frameCount);
+
+	//! @brief end
+	void Term();
+
+	//! @brief close the frame being recorded and move to the next slot
+	//!
+	//! @param[in] fenceValue fence value signaled after the frame (must increase every frame)
+	//! @return return the value which must complete before the next slot is recorded into, 0 if none
+	uint64_t EndFrame(uint64_t fenceValue);
+
+	//! @brief get the value which must complete before the current slot is recorded into
+	//!
+	//! @return return the fence value, 0 if the slot has never been used
+	uint64_t GetWaitValue() const;
+
+	//! @brief check whether the current slot can be recorded into
+	//!
+	//! @param[in] completedValue completed fence value
+	//! @retval true the GPU has finished the frame which last used the slot
+	bool CanBegin(uint64_t completedValue) const;
+
+	//! @brief get count of frames the GPU has not finished
+	//!
+	//! @param[in] completedValue completed fence value
+	//! @return return count of closed frames which are still in flight
+	uint32_t GetInFlightCount(uint64_t completedValue) const;
+
+	//! @brief get the value signaled after the last closed frame
+	//!
+	//! @return return the fence value, 0 if no frame has been closed
+	uint64_t GetLastValue() const;
+
+	//! @brief get frame count in flight
+	//!
+	//! @return return frame count
+	uint32_t GetFrameCount() const;
+
+	//! @brief get slot of the frame being recorded
+	//!
+	//! @return return slot index in [0, frameCount)
+	uint32_t GetSlot() const;
+
+	//! @brief get count of closed frames
+	//!
+	//! @return return frame number of the frame being recorded
+	uint64_t GetFrameNumber() const;
+
+private:
+
+	uint64_t m_Values[MaxFrameCount]; //!< fence value of the last frame recorded into each slot
+	uint32_t m_FrameCount; //!< frame count in flight
+	uint32_t m_Slot; //!< slot of the frame being recorded
+	uint64_t m_FrameNumber; //!< count of closed frames
+
+	FramePacer(const FramePacer&) = delete;
+	void operator = (const FramePacer&) = delete;
+};
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <d3d12.h>
+#include <ComPtr.h>
+#include <LinearAllocator.h>
+
+//
+// UploadAllocation class
+//
+class UploadAllocation
+{
+public:
+	void* pCPU; //!< memory-mapped pointer
+	D3D12_GPU_VIRTUAL_ADDRESS AddressGPU; //!< GPU virtual address
+	uint32_t Size; //!< size in bytes (aligned)
+
+	UploadAllocation()
+		: pCPU(nullptr)
+		, AddressGPU(0)
+		, Size(0)
+	{
+		// Do Nothing//
+	}
+
+	bool IsValid() const
+	{
+		return pCPU != nullptr;
+	}
+
+	template<typename T>
+	T* GetPtr() const
+	{
+		return reinterpret_cast<T*>(pCPU);
+	}
+
+	//! @brief get constant buffer view desc
+	//! 
+	//! @return return view desc which covers the allocation
+	D3D12_CONSTANT_BUFFER_VIEW_DESC GetViewDesc() const
+	{
+		D3D12_CONSTANT_BUFFER_VIEW_DESC desc = {};
+		desc.BufferLocation = AddressGPU;
+		desc.SizeInBytes = Size;
+		return desc;
+	}
+};
+
+//
+// FrameUploadAllocator class
+//
+// One persistently mapped upload buffer per frame in flight, sub-allocated linearly with
+// constant buffer alignment. Everything allocated for a frame is released by Begin() when
+// the same frame index comes around again, so the caller must have waited for the GPU.
+//
+class FrameUploadAllocator
+{
+
+public:
+
+	//! @brief constructor
+	FrameUploadAllocator();
+
+	//! @brief destructor
+	~FrameUploadAllocator();
+
+	//! @brief initialize
+	//! 
+	//! @param[in] pDevice device
+	//! @param[in] frameCount frame count in flight
+	//! @param[in] sizePerFrame buffer size per frame in bytes
+	//! @retval true successfully initialized
+	//! @retval false failed to initialize
+	bool Init(ID3D12Device* pDevice, uint32_t frameCount, uint64_t sizePerFrame);
+
+	//! @brief end
+	void Term();
+
+	//! @brief begin frame, releasing previous allocations of the frame
+	//! 
+	//! @param[in] frameIndex frame index
+	void Begin(uint32_t frameIndex);
+
+	//! @brief allocate memory of the current frame
+	//! 
+	//! @param[in] size size in bytes (rounded up to 256 bytes)
+	//! @return return allocation, invalid allocation if the frame buffer is full
+	UploadAllocation Alloc(size_t size);
+
+	//! @brief allocate memory of the current frame and copy data
+	//! 
+	//! @param[in] data data to copy
+	//! @return return allocation, invalid allocation if the frame buffer is full
+	template<typename T>
+	UploadAllocation Push(const T& data)
+	{
+		auto result = Alloc(sizeof(T));
+		if (result.IsValid())
+		{
+			*result.GetPtr<T>() = data;
+		}
+
+		return result;
+	}
+
+	//! @brief get used size of the current frame
+	//! 
+	//! @return return used size in bytes
+	uint64_t GetUsedSize() const;
+
+private:
+
+	//
+	// Frame structure
+	//
+	struct Frame
+	{
+		ComPtr<ID3D12Resource> pBuffer; //!< upload buffer
+		uint8_t* pMappedPtr; //!< memory-mapped pointer
+		D3D12_GPU_VIRTUAL_ADDRESS Address; //!< GPU virtual address of the buffer
+		LinearAllocator Allocator; //!< allocation policy
+
+		Frame()
+			: pBuffer(nullptr)
+			, pMappedPtr(nullptr)
+			, Address(0)
+			, Allocator()
+		{
+			// Do Nothing//
+		}
+	};
+
+	Frame* m_pFrames; //!< per frame buffers
+	uint32_t m_FrameCount; //!< frame count in flight
+	uint32_t m_FrameIndex; //!< current frame index
+
+	FrameUploadAllocator(const FrameUploadAllocator&) = delete;
+	void operator = (const FrameUploadAllocator&) = delete;
+};
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <vector>
+
+//
+// FreeListAllocator class
+//
+// First-fit allocator of contiguous ranges of elements [0, capacity). Freed ranges are
+// merged with their free neighbours, and Compact() slides every live range to the front,
+// reporting the moves the owner has to apply to its memory. It never touches the GPU.
+//
+class FreeListAllocator
+{
+
+public:
+
+	static const uint32_t InvalidOffset = UINT32_MAX; //!< returned when allocation fails
+
+	//
+	// Move structure
+	//
+	struct Move
+	{
+		uint32_t SrcOffset; //!< offset before compaction
+		uint32_t DstOffset; //!< offset after compaction
+		uint32_t Count; //!< element count
+	};
+
+	//! @brief constructor
+	FreeListAllocator();
+
+	//! @brief destructor
+	~FreeListAllocator();
+
+	//! @brief initialize
+	//! 
+	//! @param[in] capacity number of elements to manage
+	//! @retval true successfully initialized
+	//! @retval false failed to initialize
+	bool Init(uint32_t capacity);
+
+	//! @brief end
+	void Term();
+
+	//! @brief allocate contiguous range
+	//! 
+	//! @param[in] count element count
+	//! @return offset of the first element, InvalidOffset if no free range is large enough
+	uint32_t Alloc(uint32_t count);
+
+	//! @brief free range
+	//! 
+	//! @param[in] offset offset returned by Alloc()
+	void Free(uint32_t offset);
+
+	//! @brief pack every live range to the front
+	//! 
+	//! @param[out] moves moves to apply, in ascending order of offset (each DstOffset <= SrcOffset)
+	void Compact(std::vector<Move>& moves);
+
+	//! @brief check whether live ranges are already packed to the front
+	//! 
+	//! @retval true Compact() would not move anything
+	//! @retval false there is a free range between live ranges
+	bool IsCompact() const;
+
+	//! @brief get element count of a live range
+	//! 
+	//! @param[in] offset offset returned by Alloc()
+	//! @return return element count, 0 if offset is not allocated
+	uint32_t GetCount(uint32_t offset) const;
+
+	//! @brief get total element count
+	//! 
+	//! @return return total element count
+	uint32_t GetCapacity() const;
+
+	//! @brief get allocated element count
+	//! 
+	//! @return return allocated element count
+	uint32_t GetUsedCount() const;
+
+	//! @brief get size of the largest free range
+	//! 
+	//! @return return size of the largest free range
+	uint32_t GetLargestFreeRange() const;
+
+private:
+
+	std::map<uint32_t, uint32_t> m_Free; //!< free ranges (offset -> count)
+	std::map<uint32_t, uint32_t> m_Used; //!< live ranges (offset -> count)
+	uint32_t m_Capacity; //!< total element count
+	uint32_t m_UsedCount; //!< allocated element count
+
+	FreeListAllocator(const FreeListAllocator&) = delete;
+	void operator = (const FreeListAllocator&) = delete;
+};
@@ -0,0 +1,208 @@
+#pragma once
+
+#include <d3d12.h>
+#include <ComPtr.h>
+#include <FreeListAllocator.h>
+#include <vector>
+
+//
+// Forward Declarations.
+//
+class BufferUploadBatch;
+class DeferredReleaseQueue;
+
+//
+// GeometryAllocation class
+//
+class GeometryAllocation
+{
+public:
+	uint32_t BaseVertex; //!< first vertex in the arena
+	uint32_t VertexCount; //!< vertex count
+	uint32_t FirstIndex; //!< first index in the arena
+	uint32_t IndexCount; //!< index count
+	DXGI_FORMAT IndexFormat; //!< index format (selects the index buffer of the arena)
+
+	GeometryAllocation()
+		: BaseVertex(0)
+		, VertexCount(0)
+		, FirstIndex(0)
+		, IndexCount(0)
+		, IndexFormat(DXGI_FORMAT_R32_UINT)
+	{
+		// Do Nothing//
+	}
+};
+
+//
+// GeometryArena class
+//
+// One DEFAULT heap vertex buffer and two index buffers (16-bit and 32-bit) shared by many
+// meshes. Indices stay relative to their mesh and are offset with BaseVertex at draw time,
+// so a mesh with up to MaxVertexCount16 vertices is stored with 16-bit indices and the
+// index buffer is only rebound when the format changes. Allocation objects keep their
+// address across Compact(); only the offsets inside them change. With a release queue, a
+// freed range is reused only after the frames which may still draw from it have finished.
+//
+class GeometryArena
+{
+
+public:
+
+	//! @brief constructor
+	GeometryArena();
+
+	//! @brief destructor
+	~GeometryArena();
+
+	//! @brief initialize
+	//! 
+	//! @param[in] pDevice device
+	//! @param[in] vertexStride size of one vertex
+	//! @param[in] vertexCapacity vertex count of the arena
+	//! @param[in] indexCapacity16 16-bit index count of the arena (0 to store every mesh with 32-bit indices)
+	//! @param[in] indexCapacity32 32-bit index count of the arena
+	//! @param[in] pReleaseQueue queue which returns freed ranges once the frames in flight have finished with them (nullptr to return them at once)
+	//! @retval true successfully initialized
+	//! @retval false failed to initialize
+	//! @note the queue must not run the frees of this arena after the arena has been destroyed
+	bool Init(
+		ID3D12Device* pDevice,
+		uint32_t vertexStride,
+		uint32_t vertexCapacity,
+		uint32_t indexCapacity16,
+		uint32_t indexCapacity32,
+		DeferredReleaseQueue* pReleaseQueue = nullptr);
+
+	//! @brief end
+	//!
+	//! @note frees still queued do nothing afterwards
+	void Term();
+
+	//! @brief allocate geometry and stage its data
+	//! 
+	//! @param[in] batch upload batch which copies the data
+	//! @param[in] pVertices vertices
+	//! @param[in] vertexCount vertex count
+	//! @param[in] pIndices indices, relative to the first vertex
+	//! @param[in] indexCount index count
+	//! @return return allocation, nullptr if the arena is full
+	//! @note indices are narrowed to 16 bits when vertexCount allows and 16-bit space remains
+	GeometryAllocation* Alloc(
+		BufferUploadBatch& batch,
+		const void* pVertices,
+		uint32_t vertexCount,
+		const uint32_t* pIndices,
+		uint32_t indexCount);
+
+	//! @brief allocate geometry and stage its data
+	//! 
+	//! @param[in] batch upload batch which copies the data
+	//! @param[in] pVertices vertices
+	//! @param[in] vertexCount vertex count
+	//! @param[in] pIndices indices, relative to the first vertex
+	//! @param[in] indexFormat format of pIndices (DXGI_FORMAT_R16_UINT or DXGI_FORMAT_R32_UINT)
+	//! @param[in] indexCount index count
+	//! @return return allocation, nullptr if the arena is full
+	//! @note indices already in the format of the allocation are uploaded as they are, others are
+	//! narrowed or widened
+	GeometryAllocation* Alloc(
+		BufferUploadBatch& batch,
+		const void* pVertices,
+		uint32_t vertexCount,
+		const void* pIndices,
+		DXGI_FORMAT indexFormat,
+		uint32_t indexCount);
+
+	//! @brief free geometry
+	//! 
+	//! @param[in,out] pAllocation allocation to free (set to nullptr)
+	//! @note the range is returned after the frame being recorded, unless no release queue was given
+	void Free(GeometryAllocation*& pAllocation);
+
+	//! @brief pack live geometry to the front of the buffers
+	//! 
+	//! @param[in] pQueue command queue to copy with (waits for completion)
+	//! @param[in] pReleaseQueue queue which releases the old buffers once the frames in flight have finished with them (nullptr to release at once)
+	//! @retval true successfully compacted
+	//! @retval false failed to compact
+	//! @note frames in flight may still read the arena, but the GPU must not be writing to it
+	bool Compact(ID3D12CommandQueue* pQueue, DeferredReleaseQueue* pReleaseQueue);
+
+	//! @brief bind vertex and index buffer
+	//! 
+	//! @param[in] pCmdList command list
+	//! @param[in] indexFormat index buffer to bind
+	void Bind(ID3D12GraphicsCommandList* pCmdList, DXGI_FORMAT indexFormat) const;
+
+	//! @brief bind index buffer only
+	//! 
+	//! @param[in] pCmdList command list
+	//! @param[in] indexFormat index buffer to bind
+	void BindIndexBuffer(ID3D12GraphicsCommandList* pCmdList, DXGI_FORMAT indexFormat) const;
+
+	//! @brief get vertex buffer view
+	//! 
+	//! @return return vertex buffer view
+	D3D12_VERTEX_BUFFER_VIEW GetVertexView() const;
+
+	//! @brief get index buffer view
+	//! 
+	//! @param[in] indexFormat DXGI_FORMAT_R16_UINT or DXGI_FORMAT_R32_UINT
+	//! @return return index buffer view
+	D3D12_INDEX_BUFFER_VIEW GetIndexView(DXGI_FORMAT indexFormat) const;
+
+	//! @brief get used vertex count
+	//! 
+	//! @return return used vertex count (freed ranges count until they are returned)
+	uint32_t GetUsedVertexCount() const;
+
+	//! @brief get used index count
+	//! 
+	//! @param[in] indexFormat DXGI_FORMAT_R16_UINT or DXGI_FORMAT_R32_UINT
+	//! @return return used index count (freed ranges count until they are returned)
+	uint32_t GetUsedIndexCount(DXGI_FORMAT indexFormat) const;
+
+private:
+
+	//
+	// IndexRegion structure
+	//
+	struct IndexRegion
+	{
+		ComPtr<ID3D12Resource> pIB; //!< index buffer
+		FreeListAllocator Allocator; //!< index ranges
+		DXGI_FORMAT Format; //!< index format
+		uint32_t Stride; //!< size of one index
+	};
+
+	//
+	// RetiredRange structure
+	//
+	struct RetiredRange
+	{
+		uint64_t Id; //!< id which the release queue returns it with
+		uint32_t BaseVertex; //!< first vertex
+		uint32_t FirstIndex; //!< first index
+		DXGI_FORMAT IndexFormat; //!< index format
+	};
+
+	ComPtr<ID3D12Device> m_pDevice; //!< device
+	ComPtr<ID3D12Resource> m_pVB; //!< vertex buffer
+	uint32_t m_VertexStride; //!< size of one vertex
+	FreeListAllocator m_VertexAllocator; //!< vertex ranges
+	IndexRegion m_Index[2]; //!< 16-bit and 32-bit indices
+	std::vector<GeometryAllocation*> m_pAllocations; //!< live allocations
+	DeferredReleaseQueue* m_pReleaseQueue; //!< queue which returns freed ranges
+	std::vector<RetiredRange> m_Retired; //!< freed ranges which frames in flight may still read
+	uint64_t m_NextRetiredId; //!< id of the next freed range
+
+	bool CreateBuffer(UINT64 size, ComPtr<ID3D12Resource>& pBuffer);
+	void FreeRange(const RetiredRange& range);
+	void Reclaim(uint64_t id);
+	IndexRegion& GetRegion(DXGI_FORMAT indexFormat);
+	const IndexRegion& GetRegion(DXGI_FORMAT indexFormat) const;
+
+	GeometryArena(const GeometryArena&) = delete;
+	void operator = (const GeometryArena&) = delete;
+};
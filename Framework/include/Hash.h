@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+//! @brief FNV-1a offset basis (seed of the first call)
+static const uint64_t HashSeed = 0xcbf29ce484222325ull;
+
+//! @brief hash a memory block with 64-bit FNV-1a
+//! 
+//! @param[in] pData data to hash
+//! @param[in] size size of the data
+//! @param[in] seed result of a previous call to continue, HashSeed to start
+//! @return return hash value
+inline uint64_t HashBytes(const void* pData, size_t size, uint64_t seed = HashSeed)
+{
+	auto ptr = static_cast<const uint8_t*>(pData);
+	auto hash = seed;
+	for (size_t i = 0; i < size; ++i)
+	{
+		hash ^= ptr[i];
+		hash *= 0x100000001b3ull;
+	}
+
+	return hash;
+}
+
+//! @brief hash a value with 64-bit FNV-1a
+//! 
+//! @param[in] value value to hash (hashed as raw bytes, so it must not contain padding)
+//! @param[in] seed result of a previous call to continue, HashSeed to start
+//! @return return hash value
+template<typename T>
+inline uint64_t HashValue(const T& value, uint64_t seed = HashSeed)
+{
+	return HashBytes(&value, sizeof(T), seed);
+}
@@ -4,6 +4,11 @@
 #include <ComPtr.h>
 #include <cstdint>
 
+//
+// Forward Declarations.
+//
+class BufferUploadBatch;
+
 class IndexBuffer
 {
 
@@ -24,10 +29,41 @@ public:
 	//! @retval false failed to initialize
 	bool Init(ID3D12Device* pDevice, size_t size, const uint32_t* pInitData = nullptr);
 
+	//! @brief initialize as static geometry in a DEFAULT heap
+	//! 
+	//! @param[in] batch upload batch which copies the initial data
+	//! @param[in] size size of index buffer
+	//! @param[in] pInitData initialize data
+	//! @retval true successfully initialized
+	//! @retval false failed to initialize
+	//! @note the data is on the GPU once batch.End() has returned. Map() is not available
+	bool Init(BufferUploadBatch& batch, size_t size, const uint32_t* pInitData);
+
+	//! @brief initialize with 16-bit indices
+	//! 
+	//! @param[in] pDevice device
+	//! @param[in] size size of index buffer
+	//! @param[in] pInitData initialize data
+	//! @retval true successfully initialized
+	//! @retval false failed to initialize
+	bool Init(ID3D12Device* pDevice, size_t size, const uint16_t* pInitData);
+
+	//! @brief initialize as static geometry in a DEFAULT heap with 16-bit indices
+	//! 
+	//! @param[in] batch upload batch which copies the initial data
+	//! @param[in] size size of index buffer
+	//! @param[in] pInitData initialize data
+	//! @retval true successfully initialized
+	//! @retval false failed to initialize
+	bool Init(BufferUploadBatch& batch, size_t size, const uint16_t* pInitData);
+
 	//! @brief end
 	void Term();
 
 	//! @brief memory mappint
+	//! 
+	//! @return return memory-mapped pointer, nullptr for static geometry
+	//! @note the pointer addresses uint16_t indices if GetFormat() is DXGI_FORMAT_R16_UINT
 	uint32_t* Map();
 
 	//! @brief unmap memory
@@ -38,10 +74,19 @@ public:
 	//! @return return index buffer view
 	D3D12_INDEX_BUFFER_VIEW GetView() const;
 
+	//! @brief get index format
+	//! 
+	//! @return return DXGI_FORMAT_R16_UINT or DXGI_FORMAT_R32_UINT
+	DXGI_FORMAT GetFormat() const;
+
 private:
 
 	ComPtr<ID3D12Resource> m_pIB; //!< Index Buffer
 	D3D12_INDEX_BUFFER_VIEW m_View; //!< Index Buffer View
+	bool m_IsStatic; //!< whether the buffer is in a DEFAULT heap
+
+	bool InitUpload(ID3D12Device* pDevice, size_t size, const void* pInitData, DXGI_FORMAT format);
+	bool InitStatic(BufferUploadBatch& batch, size_t size, const void* pInitData, DXGI_FORMAT format);
 
 	IndexBuffer(const IndexBuffer&) = delete;
 	void operator = (const IndexBuffer&) = delete;
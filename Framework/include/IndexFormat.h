@@ -0,0 +1,39 @@
+#pragma once
+
+#include <ResMesh.h>
+#include <cstdint>
+#include <vector>
+
+//! @brief largest vertex count which 16-bit indices can address
+static const uint32_t MaxVertexCount16 = 65536;
+
+//! @brief select index format for a vertex count
+//! 
+//! @param[in] vertexCount vertex count of the mesh
+//! @return return DXGI_FORMAT_R16_UINT if every vertex fits in 16 bits, DXGI_FORMAT_R32_UINT otherwise
+DXGI_FORMAT SelectIndexFormat(size_t vertexCount);
+
+//! @brief get size of one index
+//! 
+//! @param[in] format DXGI_FORMAT_R16_UINT or DXGI_FORMAT_R32_UINT
+//! @return return size of one index in bytes
+uint32_t GetIndexStride(DXGI_FORMAT format);
+
+//! @brief narrow indices to 16 bits
+//! 
+//! @param[in] indices indices (every value must be less than MaxVertexCount16)
+//! @param[out] result 16-bit indices
+void PackIndices16(const std::vector<uint32_t>& indices, std::vector<uint16_t>& result);
+
+//! @brief split a mesh into chunks which 16-bit indices can address
+//! 
+//! @param[in] mesh mesh to split
+//! @param[in] maxVertexCount maximum vertex count of one chunk (3 or more)
+//! @param[out] result chunks in triangle order, sharing the material of the mesh
+//! @note vertices used by triangles of several chunks are duplicated
+void SplitMesh(const ResMesh& mesh, uint32_t maxVertexCount, std::vector<ResMesh>& result);
+
+//! @brief split every mesh which 16-bit indices can not address
+//! 
+//! @param[in,out] meshes meshes (large ones are replaced with their chunks)
+void SplitLargeMeshes(std::vector<ResMesh>& meshes);
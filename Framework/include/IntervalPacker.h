@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+//
+// IntervalPacker class
+//
+// Places blocks which are used over intervals of passes (or any other steps) in one range
+// of memory, independent of D3D12. Blocks whose intervals overlap never overlap in memory,
+// the others may share it. Larger blocks are placed first at the lowest aligned offset
+// which fits, so smaller ones fill the gaps between them.
+//
+class IntervalPacker
+{
+
+public:
+
+	static const uint32_t InvalidId = UINT32_MAX; //!< invalid block id
+
+	//! @brief constructor
+	IntervalPacker();
+
+	//! @brief destructor
+	~IntervalPacker();
+
+	//! @brief discard every block
+	void Reset();
+
+	//! @brief add a block
+	//!
+	//! @param[in] first first step which uses the block
+	//! @param[in] last last step which uses the block (inclusive)
+	//! @param[in] size size in bytes
+	//! @param[in] alignment alignment of the offset in bytes (power of 2)
+	//! @return return block id, InvalidId if an argument is invalid
+	uint32_t Add(uint32_t first, uint32_t last, uint64_t size, uint64_t alignment);
+
+	//! @brief place every block
+	void Pack();
+
+	//! @brief get offset of a block placed by Pack()
+	//!
+	//! @param[in] id block id
+	//! @return return offset in bytes
+	uint64_t GetOffset(uint32_t id) const;
+
+	//! @brief check whether two blocks share memory
+	//!
+	//! @param[in] a block id
+	//! @param[in] b block id
+	//! @retval true the byte ranges of the blocks overlap
+	bool IsOverlapped(uint32_t a, uint32_t b) const;
+
+	//! @brief get size of the memory which every block is placed in
+	//!
+	//! @return return size in bytes
+	uint64_t GetSize() const;
+
+	//! @brief get size which the blocks would take without sharing memory
+	//!
+	//! @return return size in bytes
+	uint64_t GetUnaliasedSize() const;
+
+	//! @brief get block count
+	//!
+	//! @return return count of added blocks
+	uint32_t GetCount() const;
+
+private:
+
+	//
+	// Block structure
+	//
+	struct Block
+	{
+		uint32_t First; //!< first step
+		uint32_t Last; //!< last step (inclusive)
+		uint64_t Size; //!< size in bytes
+		uint64_t Alignment; //!< alignment in bytes
+		uint64_t Offset; //!< placed offset
+	};
+
+	std::vector<Block> m_Blocks; //!< blocks in the order they were added
+	uint64_t m_Size; //!< size of the memory
+	uint64_t m_UnaliasedSize; //!< size without sharing memory
+
+	IntervalPacker(const IntervalPacker&) = delete;
+	void operator = (const IntervalPacker&) = delete;
+};
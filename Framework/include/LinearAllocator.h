@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+
+//
+// LinearAllocator class
+//
+// Bump allocator over the byte range [0, capacity). There is no per-allocation free;
+// Reset() releases everything at once. It only hands out offsets, the memory itself
+// belongs to the caller.
+//
+class LinearAllocator
+{
+
+public:
+
+	static const uint64_t InvalidOffset = UINT64_MAX; //!< returned when allocation fails
+
+	//! @brief constructor
+	LinearAllocator();
+
+	//! @brief destructor
+	~LinearAllocator();
+
+	//! @brief initialize
+	//! 
+	//! @param[in] capacity size of the range in bytes
+	//! @retval true successfully initialized
+	//! @retval false failed to initialize
+	bool Init(uint64_t capacity);
+
+	//! @brief end
+	void Term();
+
+	//! @brief allocate
+	//! 
+	//! @param[in] size size in bytes
+	//! @param[in] alignment alignment in bytes (power of 2)
+	//! @return offset of the allocation, InvalidOffset if there is not enough space
+	uint64_t Alloc(uint64_t size, uint64_t alignment);
+
+	//! @brief release every allocation
+	void Reset();
+
+	//! @brief get size of the range
+	//! 
+	//! @return return size of the range in bytes
+	uint64_t GetCapacity() const;
+
+	//! @brief get used size (including alignment padding)
+	//! 
+	//! @return return used size in bytes
+	uint64_t GetUsedSize() const;
+
+private:
+
+	uint64_t m_Capacity; //!< size of the range
+	uint64_t m_Offset; //!< next allocation position
+
+	LinearAllocator(const LinearAllocator&) = delete;
+	void operator = (const LinearAllocator&) = delete;
+};
@@ -0,0 +1,527 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <atomic>
+#include <cassert>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+
+//
+// LockFreePool class
+//
+// Fixed capacity pool whose free list is an index+generation stack updated with CAS.
+// Each thread additionally owns a small magazine of free indices, so most Alloc/Free
+// calls do not touch the shared stack at all. A magazine is guarded by a flag which only
+// its owner sets, except when Alloc() of another thread finds the shared stack empty and
+// takes the indices parked there, so Alloc() fails only when no item is free anywhere.
+// A thread's magazines are flushed to the shared stacks when it exits, and its slot is
+// handed to the next thread.
+//
+template<typename T, uint32_t MagazineSize = 16, uint32_t MaxThreads = 64>
+class LockFreePool
+{
+	static_assert(MagazineSize >= 2, "MagazineSize must be at least 2");
+
+public:
+
+	LockFreePool()
+		: m_pBuffer(nullptr)
+		, m_Capacity(0)
+		, m_Head(Pack(InvalidIndex, 0))
+		, m_Count(0)
+	{
+		// the registry is created first, so it outlives pools with static storage
+		GetRegistry();
+	}
+
+	~LockFreePool()
+	{
+		Term();
+	}
+
+	//! @brief initialize
+	//!
+	//! @param[in] count item count to reserve
+	//! @retval true : successfully initialized
+	//! @retval false : failed to initialize
+	//! @note not thread safe. call before the pool is shared between threads
+	bool Init(uint32_t count)
+	{
+		if (count == 0 || count == InvalidIndex)
+		{
+			return false;
+		}
+
+		m_pBuffer = static_cast<uint8_t*>(malloc(sizeof(Item) * count));
+		if (m_pBuffer == nullptr)
+		{
+			return false;
+		}
+
+		m_Capacity = count;
+
+		for (auto i = 0u; i < m_Capacity; ++i)
+		{
+			auto item = AssignItem(i);
+			item->m_Index = i;
+			item->m_Next.store((i + 1 < m_Capacity) ? i + 1 : InvalidIndex, std::memory_order_relaxed);
+		}
+
+		for (auto i = 0u; i < MaxThreads; ++i)
+		{
+			m_Magazine[i].m_Count = 0;
+			m_Magazine[i].m_Locked.store(false, std::memory_order_relaxed);
+		}
+
+		m_Head.store(Pack(0, 0), std::memory_order_release);
+		m_Count.store(0, std::memory_order_release);
+
+		// exiting threads flush their magazines of this pool from now on
+		auto& registry = GetRegistry();
+		std::lock_guard<std::mutex> lock(registry.m_Mutex);
+		registry.m_pPools.push_back(this);
+
+		return true;
+	}
+
+	//! @brief end
+	//!
+	//! @note not thread safe. all threads must have stopped using the pool
+	void Term()
+	{
+		{
+			auto& registry = GetRegistry();
+			std::lock_guard<std::mutex> lock(registry.m_Mutex);
+			for (auto itr = registry.m_pPools.begin(); itr != registry.m_pPools.end(); ++itr)
+			{
+				if (*itr == this)
+				{
+					registry.m_pPools.erase(itr);
+					break;
+				}
+			}
+		}
+
+		if (m_pBuffer) // has the same meaning as "if (m_pBuffer != nullptr)
+		{
+			free(m_pBuffer);
+			m_pBuffer = nullptr;
+		}
+
+		for (auto i = 0u; i < MaxThreads; ++i)
+		{
+			m_Magazine[i].m_Count = 0;
+		}
+
+		m_Head.store(Pack(InvalidIndex, 0), std::memory_order_release);
+		m_Capacity = 0;
+		m_Count.store(0, std::memory_order_release);
+	}
+
+	//! @brief allocate item
+	//!
+	//! @param[in] func user initialization, called as func(index, pItem)
+	//! @return pointer to the allocated item, nullptr if allocation failed
+	template<typename Func>
+	T* Alloc(Func func)
+	{
+		auto index = InvalidIndex;
+
+		auto slot = GetThreadSlot();
+		if (slot < MaxThreads)
+		{
+			auto& magazine = m_Magazine[slot];
+			Lock(magazine);
+
+			// refill half a magazine at once from the shared stack
+			if (magazine.m_Count == 0)
+			{
+				while (magazine.m_Count < MagazineSize / 2)
+				{
+					auto popped = Pop();
+					if (popped == InvalidIndex)
+					{
+						break;
+					}
+
+					magazine.m_Items[magazine.m_Count++] = popped;
+				}
+			}
+
+			if (magazine.m_Count > 0)
+			{
+				index = magazine.m_Items[--magazine.m_Count];
+			}
+
+			Unlock(magazine);
+		}
+		else
+		{
+			index = Pop();
+		}
+
+		// the rest of the free items are parked in the magazines of other threads
+		if (index == InvalidIndex)
+		{
+			index = Steal(slot);
+		}
+
+		if (index == InvalidIndex)
+		{
+			return nullptr;
+		}
+
+		m_Count.fetch_add(1, std::memory_order_relaxed);
+
+		auto item = GetItem(index);
+		auto val = new((void*)item) T();
+
+		func(index, val);
+
+		return val;
+	}
+
+	//! @brief allocate item without user initialization
+	//!
+	//! @return pointer to the allocated item, nullptr if allocation failed
+	T* Alloc()
+	{
+		return Alloc([](uint32_t, T*) {});
+	}
+
+	//! @brief free the item
+	//!
+	//! @param[in] pValue pointer to the item to be free
+	void Free(T* pValue)
+	{
+		if (pValue == nullptr)
+		{
+			return;
+		}
+
+		auto item = reinterpret_cast<Item*>(pValue);
+		auto index = item->m_Index;
+		assert(index < m_Capacity);
+
+		m_Count.fetch_sub(1, std::memory_order_relaxed);
+
+		auto slot = GetThreadSlot();
+		if (slot < MaxThreads)
+		{
+			auto& magazine = m_Magazine[slot];
+			Lock(magazine);
+
+			// return half a magazine to the shared stack when it is full
+			if (magazine.m_Count == MagazineSize)
+			{
+				while (magazine.m_Count > MagazineSize / 2)
+				{
+					Push(magazine.m_Items[--magazine.m_Count]);
+				}
+			}
+
+			magazine.m_Items[magazine.m_Count++] = index;
+			Unlock(magazine);
+		}
+		else
+		{
+			Push(index);
+		}
+	}
+
+	//! @brief get total item amount
+	//!
+	//! @return return total item amount
+	uint32_t GetSize() const
+	{
+		return m_Capacity;
+	}
+
+	//! @brief get currently used item amount
+	//!
+	//! @return return currently used item amount
+	uint32_t GetUsedCount() const
+	{
+		return m_Count.load(std::memory_order_relaxed);
+	}
+
+	//! @brief get available item amount
+	//!
+	//! @return return available item amount
+	//! @note includes items parked in per-thread magazines, which Alloc() takes when the shared stack is empty
+	uint32_t GetAvailableCount() const
+	{
+		return m_Capacity - GetUsedCount();
+	}
+
+	//! @brief get amount of free items parked in per-thread magazines
+	//!
+	//! @return return parked item amount
+	uint32_t GetParkedCount() const
+	{
+		auto count = 0u;
+		for (auto i = 0u; i < MaxThreads; ++i)
+		{
+			Lock(m_Magazine[i]);
+			count += m_Magazine[i].m_Count;
+			Unlock(m_Magazine[i]);
+		}
+		return count;
+	}
+
+private:
+
+	static const uint32_t InvalidIndex = UINT32_MAX;
+
+	// padding between data which different threads write. a pool may be allocated with new,
+	// which does not honor alignas(64) before C++17, so whole lines of padding are used instead
+	static const uint32_t CacheLineSize = 64;
+
+	//Item structure
+	struct Item
+	{
+		T m_Value;
+		uint32_t m_Index;
+		std::atomic<uint32_t> m_Next;
+
+		Item()
+			: m_Value()
+			, m_Index(0)
+			, m_Next(InvalidIndex)
+		{
+			// Do Nothing//
+		}
+	};
+
+	//Magazine structure (touched by other threads only to steal or flush)
+	struct Magazine
+	{
+		mutable std::atomic<bool> m_Locked;
+		uint32_t m_Count;
+		uint32_t m_Items[MagazineSize];
+		uint8_t m_Padding[CacheLineSize]; // keeps the next magazine off these lines
+	};
+
+	//Registry structure (thread slots and live pools, shared by the pools of one type)
+	struct Registry
+	{
+		std::mutex m_Mutex;
+		bool m_IsSlotUsed[MaxThreads] = {};
+		std::vector<LockFreePool*> m_pPools;
+	};
+
+	//SlotOwner structure (holds the slot of a thread until it exits)
+	struct SlotOwner
+	{
+		uint32_t m_Slot;
+
+		SlotOwner()
+			: m_Slot(MaxThreads)
+		{
+			auto& registry = GetRegistry();
+			std::lock_guard<std::mutex> lock(registry.m_Mutex);
+			for (auto i = 0u; i < MaxThreads; ++i)
+			{
+				if (!registry.m_IsSlotUsed[i])
+				{
+					registry.m_IsSlotUsed[i] = true;
+					m_Slot = i;
+					break;
+				}
+			}
+		}
+
+		~SlotOwner()
+		{
+			if (m_Slot == MaxThreads)
+			{
+				return;
+			}
+
+			// the next owner of the slot starts with empty magazines
+			auto& registry = GetRegistry();
+			std::lock_guard<std::mutex> lock(registry.m_Mutex);
+			for (auto pPool : registry.m_pPools)
+			{
+				pPool->Flush(m_Slot);
+			}
+			registry.m_IsSlotUsed[m_Slot] = false;
+		}
+	};
+
+	//private variables
+	uint8_t* m_pBuffer;
+	uint32_t m_Capacity;
+	uint8_t m_HeadPadding[CacheLineSize];
+	std::atomic<uint64_t> m_Head; // (generation << 32) | index
+	uint8_t m_CountPadding[CacheLineSize];
+	std::atomic<uint32_t> m_Count;
+	uint8_t m_MagazinePadding[CacheLineSize];
+	Magazine m_Magazine[MaxThreads];
+
+	//private methods
+
+	static uint64_t Pack(uint32_t index, uint32_t tag)
+	{
+		return (uint64_t(tag) << 32) | uint64_t(index);
+	}
+
+	static uint32_t IndexOf(uint64_t head)
+	{
+		return uint32_t(head & 0xffffffff);
+	}
+
+	static uint32_t TagOf(uint64_t head)
+	{
+		return uint32_t(head >> 32);
+	}
+
+	//! @brief get registry
+	//!
+	//! @return return registry of the pools of this type
+	static Registry& GetRegistry()
+	{
+		static Registry s_Registry;
+		return s_Registry;
+	}
+
+	//! @brief get thread slot
+	//!
+	//! @return slot index of calling thread. threads beyond MaxThreads alive at once get MaxThreads and bypass magazines
+	static uint32_t GetThreadSlot()
+	{
+		static thread_local SlotOwner t_Owner;
+		return t_Owner.m_Slot;
+	}
+
+	//! @brief lock magazine
+	//!
+	//! @param[in] magazine magazine to lock
+	static void Lock(const Magazine& magazine)
+	{
+		while (magazine.m_Locked.exchange(true, std::memory_order_acquire))
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	//! @brief unlock magazine
+	//!
+	//! @param[in] magazine magazine to unlock
+	static void Unlock(const Magazine& magazine)
+	{
+		magazine.m_Locked.store(false, std::memory_order_release);
+	}
+
+	//! @brief take a free index from the magazine of another thread
+	//!
+	//! @param[in] slot slot of calling thread
+	//! @return taken index, InvalidIndex if every magazine is empty
+	uint32_t Steal(uint32_t slot)
+	{
+		for (auto i = 0u; i < MaxThreads; ++i)
+		{
+			if (i == slot)
+			{
+				continue;
+			}
+
+			auto& magazine = m_Magazine[i];
+			auto index = InvalidIndex;
+			Lock(magazine);
+			if (magazine.m_Count > 0)
+			{
+				index = magazine.m_Items[--magazine.m_Count];
+			}
+			Unlock(magazine);
+
+			if (index != InvalidIndex)
+			{
+				return index;
+			}
+		}
+
+		return InvalidIndex;
+	}
+
+	//! @brief return every index of a magazine to the shared stack
+	//!
+	//! @param[in] slot slot of the magazine
+	void Flush(uint32_t slot)
+	{
+		auto& magazine = m_Magazine[slot];
+		Lock(magazine);
+		while (magazine.m_Count > 0)
+		{
+			Push(magazine.m_Items[--magazine.m_Count]);
+		}
+		Unlock(magazine);
+	}
+
+	//! @brief pop index from shared stack
+	//!
+	//! @return popped index, InvalidIndex if the stack is empty
+	uint32_t Pop()
+	{
+		auto head = m_Head.load(std::memory_order_acquire);
+		while (IndexOf(head) != InvalidIndex)
+		{
+			// the generation tag makes a stale m_Next harmless (ABA)
+			auto next = GetItem(IndexOf(head))->m_Next.load(std::memory_order_relaxed);
+			if (m_Head.compare_exchange_weak(
+				head,
+				Pack(next, TagOf(head) + 1),
+				std::memory_order_acquire,
+				std::memory_order_acquire))
+			{
+				return IndexOf(head);
+			}
+		}
+
+		return InvalidIndex;
+	}
+
+	//! @brief push index to shared stack
+	//!
+	//! @param[in] index index of the item to push
+	void Push(uint32_t index)
+	{
+		auto item = GetItem(index);
+		auto head = m_Head.load(std::memory_order_relaxed);
+		do
+		{
+			item->m_Next.store(IndexOf(head), std::memory_order_relaxed);
+		} while (!m_Head.compare_exchange_weak(
+			head,
+			Pack(index, TagOf(head) + 1),
+			std::memory_order_release,
+			std::memory_order_relaxed));
+	}
+
+	//! @brief get item
+	//!
+	//! @param[in] index index of item to get
+	//! @return return pointer to the item
+	Item* GetItem(uint32_t index)
+	{
+		assert(index < m_Capacity);
+		return reinterpret_cast<Item*>(m_pBuffer + sizeof(Item) * index);
+	}
+
+	//! @brief construct item in place
+	//!
+	//! @param[in] index index of the item to construct
+	//! @return return pointer to the item
+	Item* AssignItem(uint32_t index)
+	{
+		assert(index < m_Capacity);
+		auto buf = (m_pBuffer + sizeof(Item) * index);
+		return new (buf) Item;
+	}
+
+	LockFreePool(const LockFreePool&) = delete;
+	void operator = (const LockFreePool&) = delete;
+};
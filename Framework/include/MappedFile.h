@@ -0,0 +1,53 @@
+#pragma once
+
+#include <Windows.h>
+#include <cstdint>
+#include <cstddef>
+
+//
+// MappedFile class
+//
+// Read-only view of a whole file. The data stays valid until Close(), so loaders can read
+// it in place instead of copying it through a stream.
+//
+class MappedFile
+{
+
+public:
+
+	//! @brief constructor
+	MappedFile();
+
+	//! @brief destructor
+	~MappedFile();
+
+	//! @brief open and map a file
+	//! 
+	//! @param[in] filename path of the file
+	//! @retval true successfully mapped
+	//! @retval false failed to open or map (an empty file can not be mapped)
+	bool Open(const wchar_t* filename);
+
+	//! @brief unmap and close
+	void Close();
+
+	//! @brief get mapped data
+	//! 
+	//! @return return pointer to the first byte, nullptr if not mapped
+	const uint8_t* GetData() const;
+
+	//! @brief get size of the file
+	//! 
+	//! @return return size in bytes
+	size_t GetSize() const;
+
+private:
+
+	HANDLE m_hFile; //!< file handle
+	HANDLE m_hMapping; //!< file mapping handle
+	const uint8_t* m_pData; //!< mapped view
+	size_t m_Size; //!< size of the file
+
+	MappedFile(const MappedFile&) = delete;
+	void operator = (const MappedFile&) = delete;
+};
@@ -4,8 +4,19 @@
 #include <ResourceUploadBatch.h>
 #include <Texture.h>
 #include <ConstantBuffer.h>
+#include <ComPtr.h>
+#include <MaterialTable.h>
+#include <TextureCache.h>
 #include <map>
 
+//
+// Forward Declarations.
+//
+class DeferredReleaseQueue;
+class FrameUploadAllocator;
+class MipStreamer;
+class StreamingTexture;
+
 //
 // Material class
 //
@@ -31,6 +42,8 @@ public:
 		TEXTURE_USAGE_COUNT
 	};
 
+	static const uint32_t TextureTableSize = 4; //!< BaseColor, Metallic, Roughness, Normal
+
 	//! @brief constructor
 	Material();
 
@@ -41,6 +54,7 @@ public:
 	//! 
 	//! @param[in] pDevice device
 	//! @param[in] pPool Descriptor pool (set the one for CBV_SRV_UAV)
+	//! @param[in] pReleaseQueue queue which frees replaced texture tables after the frames reading them
 	//! @param[in] bufferSize constant buffer size per one mateerial
 	//! @param[in] count material count
 	//! @retval true successfully initialized
@@ -48,12 +62,21 @@ public:
 	bool Init(
 		ID3D12Device* pDevice,
 		DescriptorPool* pPool,
+		DeferredReleaseQueue* pReleaseQueue,
 		size_t bufferSize,
 		size_t count);
 
 	//! @brief end
 	void Term();
 
+	//! @brief load hashes of texture files from a cooked manifest
+	//! 
+	//! @param[in] filename path of the manifest
+	//! @retval true successfully loaded
+	//! @retval false failed to load (texture files are hashed instead)
+	//! @note call after Init(). textures listed in the manifest are matched without reading their files
+	bool SetTextureManifest(const wchar_t* filename);
+
 	//! @brief set texture
 	//! 
 	//! @param[in] index material index
@@ -68,6 +91,34 @@ public:
 		const std::wstring& path,
 		DirectX::ResourceUploadBatch& batch);
 
+	//! @brief set texture whose mips are streamed
+	//! 
+	//! @param[in] index material index
+	//! @param[in] usage texture usage
+	//! @param[in] path texture path
+	//! @param[in] streamer mip streamer which keeps the texture resident
+	//! @retval true successfully set (the dummy texture is bound until the mip tail is resident)
+	//! @retval false failed to set
+	//! @note every streamed texture of a material must use the same streamer, which must be
+	//! terminated after this material
+	bool SetTexture(
+		size_t index,
+		TEXTURE_USAGE usage,
+		const std::wstring& path,
+		MipStreamer& streamer);
+
+	//! @brief write texture tables of the materials whose textures have changed
+	//! 
+	//! @note call once per frame before recording draws. a changed table is written to a new
+	//! range, since frames in flight may still read the old one
+	void Update();
+
+	//! @brief request mips of the streamed textures of a material
+	//! 
+	//! @param[in] index material index
+	//! @param[in] screenSize size of the textures on screen in pixels
+	void RequestMips(size_t index, float screenSize);
+
 	//! @brief get pointer of constant buffer
 	//! 
 	//! @param[in] index material index to get
@@ -108,11 +159,32 @@ public:
 	//! @return w肳ꂽԍɈveNX`̃fBXNv^nhԋp܂
 	D3D12_GPU_DESCRIPTOR_HANDLE GetTextureHandle(size_t index, TEXTURE_USAGE usage) const;
 
+	//! @brief get texture table handle
+	//! 
+	//! @param[in] index material index to get
+	//! @return return descriptor table of BaseColor, Metallic, Roughness and Normal (t0-t3),
+	//! or an empty handle if the descriptor pool has no range region
+	D3D12_GPU_DESCRIPTOR_HANDLE GetTableHandle(size_t index) const;
+
+	//! @brief copy the material index table to the memory of the current frame
+	//! 
+	//! @param[in] allocator upload allocator of the current frame
+	//! @return return address of the StructuredBuffer of MaterialIndices, one per material,
+	//! which holds heap indices of the PBR textures for bindless drawing (bind as a root SRV).
+	//! 0 if the frame buffer is full
+	//! @note frames in flight keep their own copy, so the table may change every frame
+	D3D12_GPU_VIRTUAL_ADDRESS PushIndexTable(FrameUploadAllocator& allocator) const;
+
 	//! @brief get material count
 	//! 
 	//! @return return material count
 	size_t GetCount() const;
 
+	//! @brief get bytes saved by sharing textures
+	//! 
+	//! @return return total file size of the textures which were identical to one already set
+	uint64_t GetSavedTextureBytes() const;
+
 private:
 
 	//
@@ -122,12 +194,68 @@ private:
 	{
 		ConstantBuffer* pConstantBuffer; //!< constant buffer
 		D3D12_GPU_DESCRIPTOR_HANDLE TextureHandle[TEXTURE_USAGE_COUNT]; //!< texture handle
+		DescriptorRange* pTable; //!< contiguous copy of the PBR texture views
+		StreamingTexture* pStreamingTexture[TEXTURE_USAGE_COUNT]; //!< streamed texture bound to each usage
+		Texture* pTexture[TEXTURE_USAGE_COUNT]; //!< texture bound to each usage (nullptr if streamed)
+		bool IsTableDirty; //!< whether pTable differs from the bound textures
 	};
 
 	std::map<std::wstring, Texture*> m_pTexture; //!< texture
 	std::vector<Subset> m_Subset; //!< subset
+	std::map<std::wstring, StreamingTexture*> m_pStreamingTexture; //!< textures whose mips are streamed
+	MipStreamer* m_pMipStreamer; //!< streamer of m_pStreamingTexture
+	TextureManifest m_Manifest; //!< precomputed keys of texture files
+	TextureKeyTable m_KeyTable; //!< keys of the texture files which the manifest does not list
+	TextureCache<Texture> m_TextureCache; //!< textures shared by identical files
+	TextureCache<StreamingTexture> m_StreamingCache; //!< streamed textures shared by identical files
+	MaterialTable m_IndexTable; //!< heap indices of the PBR textures
 	ID3D12Device* m_pDevice; //!< device
 	DescriptorPool* m_pPool; //!< descriptor pool (CBV_SRV_UAV)
+	DeferredReleaseQueue* m_pReleaseQueue; //!< queue which frees replaced texture tables
+
+	//! @brief get key of a texture file
+	//! 
+	//! @param[in] path texture path as passed to SetTexture()
+	//! @param[in] findPath path of the file
+	//! @param[in] isSRGB whether the texture is sampled as SRGB
+	//! @param[out] key key of the texture
+	//! @retval true successfully computed
+	//! @retval false the file could not be read
+	//! @note a file is hashed in full only when another file has the same size and first bytes
+	bool GetTextureKey(const std::wstring& path, const std::wstring& findPath, bool isSRGB, TextureKey& key);
+
+	//! @brief update heap index of a texture in the index table
+	//! 
+	//! @param[in] index material index
+	//! @param[in] slot slot in the texture table
+	//! @param[in] handle GPU descriptor handle of the texture
+	void SetTableIndex(size_t index, uint32_t slot, D3D12_GPU_DESCRIPTOR_HANDLE handle);
+
+	//! @brief bind texture to the subset
+	//! 
+	//! @param[in] index material index
+	//! @param[in] usage texture usage
+	//! @param[in] pTexture texture to bind
+	void ApplyTexture(size_t index, TEXTURE_USAGE usage, Texture* pTexture);
+
+	//! @brief bind texture whose mips are streamed to the subset
+	//! 
+	//! @param[in] index material index
+	//! @param[in] usage texture usage
+	//! @param[in] pTexture texture to bind (the dummy texture is bound while nothing is resident)
+	void ApplyTexture(size_t index, TEXTURE_USAGE usage, StreamingTexture* pTexture);
+
+	//! @brief write the texture table of a subset to a new range
+	//! 
+	//! @param[in] index material index
+	//! @retval true successfully written
+	//! @retval false no range is available (the old table stays bound)
+	bool WriteTable(size_t index);
+
+	//! @brief rebind a texture whose resident mips have changed
+	//! 
+	//! @param[in] pTexture texture whose resident mips have changed
+	void OnMipsChanged(StreamingTexture* pTexture);
 
 	Material(const Material&) = delete;
 	void operator = (const Material&) = delete;
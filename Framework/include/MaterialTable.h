@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+//
+// MaterialIndices structure
+//
+// One element of the material StructuredBuffer. Each member is the index of a texture view
+// in the shader visible descriptor heap, which the shader uses to index the unbounded
+// texture range.
+//
+struct MaterialIndices
+{
+	uint32_t BaseColor; //!< index of the base color map
+	uint32_t Metallic; //!< index of the metallic map
+	uint32_t Roughness; //!< index of the roughness map
+	uint32_t Normal; //!< index of the normal map
+};
+
+static_assert(sizeof(MaterialIndices) == 16, "MaterialIndices must match the HLSL structure.");
+
+//
+// MaterialTable class
+//
+// CPU side copy of the material StructuredBuffer. Slots follow the order of MaterialIndices
+// (BaseColor, Metallic, Roughness, Normal). It does not touch the GPU, so the owner copies
+// GetData() into the buffer the shader reads.
+//
+class MaterialTable
+{
+
+public:
+
+	static const uint32_t SlotCount = 4; //!< texture count per material
+
+	//! @brief constructor
+	MaterialTable();
+
+	//! @brief destructor
+	~MaterialTable();
+
+	//! @brief initialize
+	//! 
+	//! @param[in] count material count
+	//! @param[in] defaultIndex descriptor index every slot starts with (typically a dummy texture)
+	//! @retval true successfully initialized
+	//! @retval false failed to initialize
+	bool Init(size_t count, uint32_t defaultIndex);
+
+	//! @brief end
+	void Term();
+
+	//! @brief set texture of a material
+	//! 
+	//! @param[in] index material index
+	//! @param[in] slot slot in MaterialIndices
+	//! @param[in] descriptorIndex index of the texture view in the descriptor heap
+	//! @retval true successfully set
+	//! @retval false the index or the slot is out of range
+	bool SetTexture(size_t index, uint32_t slot, uint32_t descriptorIndex);
+
+	//! @brief get texture of a material
+	//! 
+	//! @param[in] index material index
+	//! @param[in] slot slot in MaterialIndices
+	//! @return return index of the texture view, the default index if out of range
+	uint32_t GetTexture(size_t index, uint32_t slot) const;
+
+	//! @brief get entries
+	//! 
+	//! @return return pointer to the first entry
+	const MaterialIndices* GetData() const;
+
+	//! @brief get material count
+	//! 
+	//! @return return material count
+	size_t GetCount() const;
+
+	//! @brief get size of the entries
+	//! 
+	//! @return return size in bytes
+	size_t GetSize() const;
+
+private:
+
+	std::vector<MaterialIndices> m_Entries; //!< entries by material
+	uint32_t m_DefaultIndex; //!< index every slot starts with
+
+	MaterialTable(const MaterialTable&) = delete;
+	void operator = (const MaterialTable&) = delete;
+};
@@ -3,6 +3,9 @@
 #include <ResMesh.h>
 #include <VertexBuffer.h>>
 #include <IndexBuffer.h>
+#include <GeometryArena.h>
+#include <VertexCodec.h>
+#include <MeshCache.h>
 
 //
 // Mesh class
@@ -26,6 +29,48 @@ public:
 	//! @retval false failed to initialize
 	bool Init(ID3D12Device* pDevice, const ResMesh& resource);
 
+	//! @brief initialize as static geometry in DEFAULT heaps
+	//! 
+	//! @param[in] batch upload batch which copies vertices and indices
+	//! @param[in] resource resource mesh
+	//! @retval true successfully initialized
+	//! @retval false failed to initialize
+	//! @note indices are stored in 16 bits when the vertex count allows
+	bool Init(BufferUploadBatch& batch, const ResMesh& resource);
+
+	//! @brief initialize in a shared geometry arena
+	//! 
+	//! @param[in] arena geometry arena to allocate from
+	//! @param[in] batch upload batch which copies vertices and indices
+	//! @param[in] resource resource mesh
+	//! @retval true successfully initialized
+	//! @retval false failed to initialize
+	//! @note Draw() does not bind buffers for such a mesh. call GeometryArena::Bind() with GetIndexFormat() beforehand
+	bool Init(GeometryArena& arena, BufferUploadBatch& batch, const ResMesh& resource);
+
+	//! @brief initialize in a shared geometry arena with an encoded vertex format
+	//! 
+	//! @param[in] arena geometry arena to allocate from (stride must be GetVertexStride(format))
+	//! @param[in] batch upload batch which copies vertices and indices
+	//! @param[in] resource resource mesh
+	//! @param[in] format vertex format
+	//! @retval true successfully initialized
+	//! @retval false failed to initialize
+	bool Init(
+		GeometryArena& arena,
+		BufferUploadBatch& batch,
+		const ResMesh& resource,
+		VERTEX_FORMAT format);
+
+	//! @brief initialize in a shared geometry arena with a cooked mesh
+	//! 
+	//! @param[in] arena geometry arena to allocate from (stride must be the vertex stride of the cache)
+	//! @param[in] batch upload batch which copies vertices and indices
+	//! @param[in] mesh cooked mesh, uploaded without conversion
+	//! @retval true successfully initialized
+	//! @retval false failed to initialize
+	bool Init(GeometryArena& arena, BufferUploadBatch& batch, const CookedMesh& mesh);
+
 	//! @brief end
 	void Term();
 
@@ -39,12 +84,25 @@ public:
 	//! @return return material id
 	uint32_t GetMaterialId() const;
 
+	//! @brief get index format
+	//! 
+	//! @return return DXGI_FORMAT_R16_UINT if the mesh has at most MaxVertexCount16 vertices
+	DXGI_FORMAT GetIndexFormat() const;
+
+	//! @brief get dequantization of positions
+	//! 
+	//! @return return dequantization of positions (identity unless VERTEX_FORMAT_QUANTIZED)
+	const VertexQuantization& GetQuantization() const;
+
 private:
 
 	VertexBuffer m_VB; //!< vertex buffer
 	IndexBuffer m_IB; //!< index buffer
+	GeometryArena* m_pArena; //!< arena which owns the geometry (nullptr if buffers are owned)
+	GeometryAllocation* m_pAllocation; //!< geometry in the arena
 	uint32_t m_MaterialId; //!< material id
 	uint32_t m_IndexCount; //!< index count
+	VertexQuantization m_Quantization; //!< dequantization of positions
 
 	Mesh(const Mesh&) = delete;
 	void operator = (const Mesh&) = delete;
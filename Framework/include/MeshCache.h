@@ -0,0 +1,140 @@
+#pragma once
+
+#include <ResMesh.h>
+#include <MappedFile.h>
+#include <VertexCodec.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//! @brief version of the cooked mesh format (bump whenever the layout or the mesh processing changes)
+static const uint32_t MeshCacheVersion = 2;
+
+//
+// CookedMesh structure
+//
+// Geometry of one mesh in its GPU layout. The pointers refer to the cooked data, so they are
+// valid as long as the MeshCache which returned them.
+//
+struct CookedMesh
+{
+	const void* pVertices; //!< encoded vertices (GetVertexStride() of the cache format each)
+	const void* pIndices; //!< indices of IndexFormat
+	uint32_t VertexCount; //!< vertex count
+	uint32_t IndexCount; //!< index count
+	DXGI_FORMAT IndexFormat; //!< DXGI_FORMAT_R16_UINT or DXGI_FORMAT_R32_UINT
+	uint32_t MaterialId; //!< material id
+	VertexQuantization Quantization; //!< dequantization of positions
+	DirectX::XMFLOAT4 Bounds; //!< bounding sphere (center and radius)
+};
+
+//! @brief compute key of a cooked mesh
+//! 
+//! @param[in] filename path of the source file, which its mtllib paths are resolved against (nullptr to hash the contents only)
+//! @param[in] pSource contents of the source file
+//! @param[in] size size of the source file
+//! @param[in] importFlags importer flags the source is processed with
+//! @return return key (MeshCacheVersion is part of it)
+//! @note the material libraries of the source and the textures they refer to are hashed as
+//! well, so editing any of them invalidates the cooked file
+uint64_t ComputeMeshCacheKey(
+	const wchar_t* filename,
+	const void* pSource,
+	size_t size,
+	uint32_t importFlags);
+
+//! @brief get path of the cooked file of a source file
+//! 
+//! @param[in] filename path of the source file
+//! @return return path of the cooked file
+std::wstring GetMeshCachePath(const wchar_t* filename);
+
+//! @brief serialize meshes and materials into the cooked format
+//! 
+//! @param[in] key key of the source
+//! @param[in] format vertex format to encode vertices with
+//! @param[in] meshes meshes (split with SplitLargeMeshes() to store every mesh with 16-bit indices)
+//! @param[in] materials materials
+//! @param[out] result cooked data
+void SerializeMeshCache(
+	uint64_t key,
+	VERTEX_FORMAT format,
+	const std::vector<ResMesh>& meshes,
+	const std::vector<ResMaterial>& materials,
+	std::vector<uint8_t>& result);
+
+//! @brief write a cooked mesh file
+//! 
+//! @param[in] filename path of the cooked file
+//! @param[in] data cooked data (see SerializeMeshCache())
+//! @retval true successfully written
+//! @retval false failed to write
+bool SaveMeshCache(const wchar_t* filename, const std::vector<uint8_t>& data);
+
+//
+// MeshCache class
+//
+// Cooked meshes, read in place from a memory-mapped file or from cooked data in memory.
+// Vertices and indices are already in the layout of the vertex and index buffers, so they
+// are uploaded straight from the file.
+//
+class MeshCache
+{
+
+public:
+
+	//! @brief constructor
+	MeshCache();
+
+	//! @brief destructor
+	~MeshCache();
+
+	//! @brief open a cooked mesh file
+	//! 
+	//! @param[in] filename path of the cooked file
+	//! @param[in] key key the file must have been cooked with
+	//! @param[in] format vertex format the file must have been cooked with
+	//! @retval true cache hit
+	//! @retval false cache miss (no file, stale key, another format or broken file)
+	bool Open(const wchar_t* filename, uint64_t key, VERTEX_FORMAT format);
+
+	//! @brief initialize with cooked data in memory
+	//! 
+	//! @param[in,out] data cooked data (taken over, left empty)
+	//! @param[in] key key the data must have been cooked with
+	//! @param[in] format vertex format the data must have been cooked with
+	//! @retval true successfully initialized
+	//! @retval false the data is broken, stale or of another format
+	bool Init(std::vector<uint8_t>& data, uint64_t key, VERTEX_FORMAT format);
+
+	//! @brief end
+	void Term();
+
+	//! @brief get mesh count
+	//! 
+	//! @return return mesh count
+	size_t GetMeshCount() const;
+
+	//! @brief get mesh
+	//! 
+	//! @param[in] index mesh index
+	//! @return return mesh
+	const CookedMesh& GetMesh(size_t index) const;
+
+	//! @brief get materials
+	//! 
+	//! @return return materials
+	const std::vector<ResMaterial>& GetMaterials() const;
+
+private:
+
+	MappedFile m_File; //!< mapped cooked file
+	std::vector<uint8_t> m_Data; //!< cooked data which was not read from a file
+	std::vector<CookedMesh> m_Meshes; //!< meshes
+	std::vector<ResMaterial> m_Materials; //!< materials
+
+	bool Parse(const uint8_t* pData, size_t size, uint64_t key, VERTEX_FORMAT format);
+
+	MeshCache(const MeshCache&) = delete;
+	void operator = (const MeshCache&) = delete;
+};
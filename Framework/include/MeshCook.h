@@ -0,0 +1,40 @@
+#pragma once
+
+#include <MeshCache.h>
+#include <cstdint>
+#include <vector>
+
+//
+// Forward Declarations.
+//
+class ThreadPool;
+
+//! @brief import a mesh and cook it into the GPU layout
+//! 
+//! @param[in] filename path of the source file
+//! @param[in] format vertex format to encode vertices with
+//! @param[out] result cooked data (see SerializeMeshCache())
+//! @param[in] pPool thread pool which converts meshes and materials in parallel (nullptr runs serially)
+//! @retval true successfully cooked
+//! @retval false failed to read or import the source
+//! @note large meshes are split so that every mesh is stored with 16-bit indices
+bool CookMesh(
+	const wchar_t* filename,
+	VERTEX_FORMAT format,
+	std::vector<uint8_t>& result,
+	ThreadPool* pPool = nullptr);
+
+//! @brief load the cooked mesh of a source file, cooking it on a miss
+//! 
+//! @param[in] filename path of the source file
+//! @param[in] format vertex format of the vertex buffer
+//! @param[out] cache cooked meshes
+//! @param[in] pPool thread pool used when the source has to be imported (nullptr runs serially)
+//! @retval true successfully loaded
+//! @retval false failed to load
+//! @note a miss writes the cooked file next to the source for the next launch
+bool LoadCookedMesh(
+	const wchar_t* filename,
+	VERTEX_FORMAT format,
+	MeshCache& cache,
+	ThreadPool* pPool = nullptr);
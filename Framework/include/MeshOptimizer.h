@@ -0,0 +1,58 @@
+#pragma once
+
+#include <ResMesh.h>
+#include <cstdint>
+#include <vector>
+
+//
+// MeshOptimizeStats structure
+//
+struct MeshOptimizeStats
+{
+	float AcmrBefore; //!< average cache miss ratio (misses per triangle) before optimization
+	float AcmrAfter; //!< average cache miss ratio after optimization
+	float AtvrBefore; //!< average transformed vertex ratio (misses per vertex) before optimization
+	float AtvrAfter; //!< average transformed vertex ratio after optimization
+};
+
+//! @brief simulate a FIFO post-transform cache
+//! 
+//! @param[in] indices triangle list
+//! @param[in] vertexCount vertex count
+//! @param[in] cacheSize FIFO cache size
+//! @param[out] pAtvr average transformed vertex ratio (optional)
+//! @return return average cache miss ratio
+float ComputeACMR(
+	const std::vector<uint32_t>& indices,
+	size_t vertexCount,
+	uint32_t cacheSize,
+	float* pAtvr = nullptr);
+
+//! @brief reorder triangles for the post-transform cache (Forsyth)
+//! 
+//! @param[in,out] indices triangle list
+//! @param[in] vertexCount vertex count
+void OptimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount);
+
+//! @brief reorder clusters of triangles so that outward facing ones are drawn first
+//! 
+//! @param[in,out] indices triangle list, already optimized for the vertex cache
+//! @param[in] vertices vertices
+//! @param[in] cacheSize FIFO cache size used to find cluster boundaries
+//! @note clusters are cut where the cache has been flushed, so the cache efficiency is kept
+void OptimizeOverdraw(
+	std::vector<uint32_t>& indices,
+	const std::vector<MeshVertex>& vertices,
+	uint32_t cacheSize);
+
+//! @brief reorder vertices in order of first use and drop unreferenced ones
+//! 
+//! @param[in,out] vertices vertices
+//! @param[in,out] indices triangle list
+void OptimizeVertexFetch(std::vector<MeshVertex>& vertices, std::vector<uint32_t>& indices);
+
+//! @brief run vertex cache, overdraw and vertex fetch optimization
+//! 
+//! @param[in,out] mesh mesh to optimize
+//! @return return cache statistics before and after
+MeshOptimizeStats OptimizeMesh(ResMesh& mesh);
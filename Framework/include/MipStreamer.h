@@ -0,0 +1,258 @@
+#pragma once
+
+#include <d3d12.h>
+#include <ComPtr.h>
+#include <DDSParser.h>
+#include <MappedFile.h>
+#include <ResidencyManager.h>
+#include <StreamingScheduler.h>
+#include <Texture.h>
+#include <ThreadPool.h>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <vector>
+
+//
+// Forward Declarations.
+//
+class DeferredReleaseQueue;
+class DescriptorPool;
+
+//
+// StreamingTexture class
+//
+// DDS texture whose resident mip range changes over time. The file stays mapped, so mips
+// can be uploaded again after they have been evicted.
+//
+class StreamingTexture
+{
+	friend class MipStreamer;
+
+public:
+
+	//! @brief check whether any mip is resident
+	//!
+	//! @retval true the texture can be bound
+	bool IsResident() const;
+
+	//! @brief get most detailed resident mip
+	//!
+	//! @return return mip index in the file, mip count if nothing is resident
+	uint32_t GetResidentMip() const;
+
+	//! @brief get layout of the file
+	//!
+	//! @return return layout of the file (empty until the file has been parsed)
+	const DDSInfo& GetInfo() const;
+
+	//! @brief get GPU descriptor handle
+	//!
+	//! @return return GPU descriptor handle of the resident mips
+	D3D12_GPU_DESCRIPTOR_HANDLE GetHandleGPU() const;
+
+	//! @brief create another shader resource view of the resident mips
+	//!
+	//! @param[in] pDevice device
+	//! @param[in] handle CPU descriptor handle to write the view to
+	void CreateView(ID3D12Device* pDevice, D3D12_CPU_DESCRIPTOR_HANDLE handle) const;
+
+private:
+
+	//! @brief called from MipStreamer::Finish() when the resident mips have changed
+	typedef std::function<void(StreamingTexture* pTexture)> Callback;
+
+	MappedFile m_File; //!< mapped DDS file
+	DDSInfo m_Info; //!< layout of the file
+	std::vector<uint64_t> m_MipSizes; //!< bytes of each mip level over every slice
+	uint32_t m_TailMip; //!< most detailed mip of the tail
+	uint32_t m_LoadId; //!< request id of the streaming scheduler
+	Texture m_Texture; //!< resident mips
+	bool m_IsSRGB; //!< whether the texture is sampled as SRGB
+	uint32_t m_Id; //!< residency id
+	uint32_t m_ResidentMip; //!< most detailed mip in m_Texture
+	ComPtr<ID3D12Resource> m_pPending; //!< resource being uploaded
+	uint32_t m_PendingMip; //!< most detailed mip in m_pPending
+	Callback m_Callback; //!< called when the resident mips have changed
+
+	StreamingTexture();
+	~StreamingTexture();
+
+	StreamingTexture(const StreamingTexture&) = delete;
+	void operator = (const StreamingTexture&) = delete;
+};
+
+//
+// MipStreamer class
+//
+// Keeps streamed textures within a video memory budget. Each texture starts with its mip
+// tail and gets finer mips as Request() reports it larger on screen; mips of the least
+// recently used textures are dropped when the budget runs out. A texture whose range
+// changes is rebuilt from its mapped file on the copy queue, one batch at a time. The owner
+// of the copy queue signals it after Submit() and reports the completed value to Finish().
+// Files are opened and parsed on the worker pool through a StreamingScheduler, and a loaded
+// texture joins the residency policy in the next Submit().
+//
+class MipStreamer : private StreamingUploader
+{
+
+public:
+
+	typedef StreamingTexture::Callback Callback;
+
+	//! @brief constructor
+	MipStreamer();
+
+	//! @brief destructor
+	~MipStreamer();
+
+	//! @brief initialize
+	//!
+	//! @param[in] pDevice device
+	//! @param[in] pPool descriptor pool (CBV_SRV_UAV)
+	//! @param[in] pCopyQueue copy queue which uploads mips
+	//! @param[in] pWorkerPool threads which open and parse files and fill the staging buffer (nullptr to do it on the calling thread)
+	//! @param[in] pReleaseQueue queue which releases replaced mips after the frames reading them (nullptr to release at once)
+	//! @param[in] budget bytes which resident mips may use
+	//! @param[in] tailSize mips this size or smaller are always resident
+	//! @param[in] maxUploadBytes bytes which one batch may upload (0 for no limit)
+	//! @retval true successfully initialized
+	//! @retval false failed to initialize
+	bool Init(
+		ID3D12Device* pDevice,
+		DescriptorPool* pPool,
+		ID3D12CommandQueue* pCopyQueue,
+		ThreadPool* pWorkerPool,
+		DeferredReleaseQueue* pReleaseQueue,
+		uint64_t budget,
+		uint32_t tailSize = 64,
+		uint64_t maxUploadBytes = 32 * 1024 * 1024);
+
+	//! @brief end
+	//!
+	//! @note the copy queue must be idle, it releases the batch in flight and every texture
+	void Term();
+
+	//! @brief load a texture
+	//!
+	//! @param[in] filename DDS file
+	//! @param[in] isSRGB whether the texture is sampled as SRGB
+	//! @param[in] callback called from Finish() when the resident mips have changed
+	//! @return return the texture, nullptr if an argument is invalid
+	//! @note the file is opened and parsed on the worker pool, so nothing is resident until
+	//! a later Submit() has uploaded the tail. a file which can not be mapped or parsed is
+	//! logged and never becomes resident
+	StreamingTexture* Load(const wchar_t* filename, bool isSRGB, Callback callback);
+
+	//! @brief release a texture
+	//!
+	//! @param[in] pTexture texture returned by Load()
+	void Release(StreamingTexture* pTexture);
+
+	//! @brief request mips for the current frame
+	//!
+	//! @param[in] pTexture texture
+	//! @param[in] screenSize size of the texture on screen in pixels
+	void Request(StreamingTexture* pTexture, float screenSize);
+
+	//! @brief swap in the resources of the batch in flight if it has completed
+	//!
+	//! @param[in] completedValue completed fence value of the copy queue
+	//! @retval true the batch has been swapped in and callbacks have been called
+	//! @retval false no batch has completed
+	//! @note call once per frame before recording. replaced mips go to the release queue, so
+	//! frames in flight may still read them
+	bool Finish(UINT64 completedValue);
+
+	//! @brief advance loading textures and upload the mips requested since the last batch
+	//!
+	//! @retval true copies have been executed on the copy queue, pass the value signaled
+	//! after them to SetFenceValue()
+	//! @retval false nothing has been executed
+	//! @note uploads nothing while a batch is in flight. call after Finish()
+	bool Submit();
+
+	//! @brief set the fence value of the copy queue which completes the batch in flight
+	//!
+	//! @param[in] value value signaled after Submit() has returned true
+	void SetFenceValue(UINT64 value);
+
+	//! @brief get the fence value of the copy queue which completes the last batch
+	//!
+	//! @return return fence value
+	UINT64 GetFenceValue() const;
+
+	//! @brief check whether nothing is being loaded or uploaded
+	//!
+	//! @retval true no texture is loading and no batch is in flight
+	bool IsIdle() const;
+
+	//! @brief get bytes used by resident mips
+	//!
+	//! @return return bytes used by resident mips
+	uint64_t GetUsedBytes() const;
+
+	//! @brief get budget
+	//!
+	//! @return return bytes which resident mips may use
+	uint64_t GetBudget() const;
+
+	//! @brief set budget
+	//!
+	//! @param[in] budget bytes which resident mips may use
+	void SetBudget(uint64_t budget);
+
+private:
+
+	ComPtr<ID3D12Device> m_pDevice; //!< device
+	ComPtr<ID3D12CommandQueue> m_pQueue; //!< copy queue
+	ComPtr<ID3D12CommandAllocator> m_pAllocator; //!< command allocator
+	ComPtr<ID3D12GraphicsCommandList> m_pCmdList; //!< copy command list
+	UINT64 m_FenceValue; //!< value of the copy queue which completes the batch (UINT64_MAX until it is set)
+	ComPtr<ID3D12Resource> m_pUpload; //!< staging buffer of the batch in flight
+	DescriptorPool* m_pPool; //!< descriptor pool
+	ThreadPool* m_pWorkerPool; //!< threads which fill the staging buffer
+	DeferredReleaseQueue* m_pReleaseQueue; //!< queue which releases replaced mips
+	ResidencyManager m_Residency; //!< residency policy
+	uint32_t m_TailSize; //!< largest size of a mip in the tail
+	std::vector<StreamingTexture*> m_pTextures; //!< textures by residency id
+	std::vector<StreamingTexture*> m_pBatch; //!< textures in the batch in flight
+	std::vector<StreamingTexture*> m_pReleased; //!< released textures still used by the batch
+	StreamingScheduler m_Scheduler; //!< opens and parses loaded files
+	ThreadPool m_InlinePool; //!< pool which is never initialized, so files are loaded inline
+	std::map<uint32_t, StreamingTexture*> m_pLoading; //!< textures by request id until the scheduler has finished them
+	std::mutex m_LoadingMutex; //!< guards m_pLoading
+	std::vector<StreamingTexture*> m_pRegistered; //!< textures whose tails the scheduler waits for
+	uint64_t m_LoadTicket; //!< ticket of the last textures handed to the residency policy
+
+	//! @brief swap in the resources of a completed batch
+	void FinishBatch();
+
+	//! @brief unregister a texture and delete it once no batch uses it
+	//!
+	//! @param[in] pTexture texture which no pool thread uses
+	void Discard(StreamingTexture* pTexture);
+
+	//! @brief get a texture which is being loaded
+	//!
+	//! @param[in] id request id
+	//! @return return the texture, nullptr if the request is unknown
+	StreamingTexture* GetLoading(uint32_t id);
+
+	bool Read(uint32_t id, const std::wstring& path) override;
+	bool Parse(uint32_t id) override;
+	bool Submit(const std::vector<uint32_t>& ids, uint64_t& ticket) override;
+	bool IsComplete(uint64_t ticket) override;
+	void Finish(uint32_t id, STREAMING_STATE state) override;
+
+	//! @brief upload changed textures
+	//!
+	//! @param[in] changes new resident mips
+	//! @param[out] isExecuted whether copies have been executed
+	//! @retval true the batch has been submitted
+	//! @retval false failed to submit
+	bool SubmitBatch(const std::vector<ResidencyManager::Change>& changes, bool& isExecuted);
+
+	MipStreamer(const MipStreamer&) = delete;
+	void operator = (const MipStreamer&) = delete;
+};
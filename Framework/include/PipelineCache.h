@@ -0,0 +1,305 @@
+#pragma once
+
+#include <d3d12.h>
+#include <d3dcompiler.h>
+#include <ComPtr.h>
+#include <CompileScheduler.h>
+#include <ThreadPool.h>
+#include <cstdint>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+//
+// Forward Declarations.
+//
+class PipelineCache;
+
+//! @brief version of the pipeline cache file format
+static const uint32_t PipelineCacheVersion = 1;
+
+//! @brief hash a root signature description
+//!
+//! @param[in] desc root signature description
+//! @return return hash which only depends on the contents (never on addresses)
+uint64_t HashRootSignatureDesc(const D3D12_ROOT_SIGNATURE_DESC& desc);
+
+//! @brief hash a graphics pipeline state description
+//!
+//! @param[in] desc pipeline state description
+//! @param[in] rootSignatureHash hash of the root signature, which stands in for desc.pRootSignature
+//! @return return hash which only depends on the contents (shader bytecode included)
+//! @note desc.CachedPSO is not part of the hash
+uint64_t HashGraphicsPipelineDesc(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, uint64_t rootSignatureHash);
+
+//! @brief get name of a pipeline in the pipeline library
+//!
+//! @param[in] hash hash of the pipeline state description
+//! @return return the hash as 16 hexadecimal digits
+std::wstring GetPipelineName(uint64_t hash);
+
+//! @brief wrap a serialized pipeline library into the cache file format
+//!
+//! @param[in] pLibrary data of ID3D12PipelineLibrary::Serialize()
+//! @param[in] size size of the data
+//! @param[out] result cache file data
+void SerializePipelineCache(const void* pLibrary, size_t size, std::vector<uint8_t>& result);
+
+//! @brief find the serialized pipeline library in cache file data
+//!
+//! @param[in] pData cache file data
+//! @param[in] size size of the data
+//! @param[out] pLibrary data to pass to ID3D12Device1::CreatePipelineLibrary()
+//! @param[out] librarySize size of the library data
+//! @retval true successfully restored
+//! @retval false the data is broken or of another version
+bool DeserializePipelineCache(const void* pData, size_t size, const uint8_t*& pLibrary, size_t& librarySize);
+
+//
+// PipelineHandle class
+//
+// Refers to a pipeline state requested from PipelineCache::RequestGraphicsPipeline(), like a
+// future. Get() returns nullptr until the pipeline is ready, so a draw which needs it can be
+// skipped meanwhile.
+//
+class PipelineHandle
+{
+
+public:
+
+	//! @brief constructor
+	PipelineHandle();
+
+	//! @brief constructor
+	//!
+	//! @param[in] pCache cache the pipeline was requested from
+	//! @param[in] hash hash of the pipeline state description
+	PipelineHandle(PipelineCache* pCache, uint64_t hash);
+
+	//! @brief check whether the handle refers to a request
+	//!
+	//! @retval true the handle refers to a request
+	bool IsValid() const;
+
+	//! @brief get state of the pipeline
+	//!
+	//! @return return state (COMPILE_STATE_FAILED for an invalid handle)
+	COMPILE_STATE GetState() const;
+
+	//! @brief get the pipeline state
+	//!
+	//! @return return the pipeline state, nullptr until it is ready
+	ID3D12PipelineState* Get() const;
+
+	//! @brief get hash of the pipeline state description
+	//!
+	//! @return return hash
+	uint64_t GetHash() const;
+
+private:
+
+	PipelineCache* m_pCache; //!< cache the pipeline was requested from
+	uint64_t m_Hash; //!< hash of the pipeline state description
+};
+
+//
+// PipelineCache class
+//
+// Creates each root signature and pipeline state once per description. Shader blobs are
+// read once per path. Pipelines are also stored in an ID3D12PipelineLibrary which is
+// written to disk, so the driver can skip compiling them on the next start. The library is
+// optional: without ID3D12Device1, or when the driver rejects the file, pipelines are
+// simply compiled. RequestGraphicsPipeline() compiles on the worker pool instead of blocking;
+// the other methods must be called from one thread.
+//
+class PipelineCache : private PipelineCompiler
+{
+
+public:
+
+	//! @brief constructor
+	PipelineCache();
+
+	//! @brief destructor
+	~PipelineCache();
+
+	//! @brief initialize
+	//!
+	//! @param[in] pDevice device
+	//! @param[in] filename file to load the pipeline library from and save it to (nullptr to keep it in memory)
+	//! @param[in] pWorkerPool threads which compile requested pipelines (nullptr to compile them in Update())
+	//! @param[in] maxInFlight maximum pipeline count compiling at once
+	//! @retval true successfully initialized
+	//! @retval false failed to initialize
+	bool Init(
+		ID3D12Device* pDevice,
+		const wchar_t* filename,
+		ThreadPool* pWorkerPool = nullptr,
+		uint32_t maxInFlight = 4);
+
+	//! @brief end
+	//!
+	//! @note waits for compiles in flight and saves the library when pipelines have been added to it
+	void Term();
+
+	//! @brief write the pipeline library to the file
+	//!
+	//! @retval true successfully written, or nothing to write
+	//! @retval false failed to write
+	bool Save();
+
+	//! @brief read a compiled shader
+	//!
+	//! @param[in] filename path of the .cso file
+	//! @return return the shader blob, nullptr if it could not be read
+	//! @note the blob is owned by the cache
+	ID3DBlob* LoadShader(const wchar_t* filename);
+
+	//! @brief get a root signature
+	//!
+	//! @param[in] pDesc root signature description
+	//! @return return the root signature, nullptr if it could not be created
+	//! @note the root signature is owned by the cache
+	ID3D12RootSignature* GetRootSignature(const D3D12_ROOT_SIGNATURE_DESC* pDesc);
+
+	//! @brief get a graphics pipeline state
+	//!
+	//! @param[in] desc pipeline state description (pRootSignature must come from GetRootSignature())
+	//! @return return the pipeline state, nullptr if it could not be created
+	//! @note the pipeline state is owned by the cache
+	ID3D12PipelineState* GetGraphicsPipeline(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc);
+
+	//! @brief request a graphics pipeline state without waiting for it
+	//!
+	//! @param[in] desc pipeline state description (pRootSignature must come from GetRootSignature())
+	//! @param[in] priority higher values are compiled first
+	//! @return return handle of the pipeline state, invalid if the description could not be hashed
+	//! @note the description is copied, so it may be released after the call
+	PipelineHandle RequestGraphicsPipeline(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, int priority = 0);
+
+	//! @brief cancel a requested pipeline state which is not ready yet
+	//!
+	//! @param[in] handle handle returned by RequestGraphicsPipeline()
+	//! @retval true canceled
+	//! @retval false the pipeline is ready, failed or unknown
+	bool Cancel(const PipelineHandle& handle);
+
+	//! @brief start queued compiles and take finished ones
+	//!
+	//! @note call once per frame
+	void Update();
+
+	//! @brief check whether nothing is being compiled
+	//!
+	//! @retval true no requested pipeline is queued or compiling
+	bool IsIdle() const;
+
+	//! @brief get state of a pipeline state
+	//!
+	//! @param[in] hash hash of the pipeline state description
+	//! @return return state (COMPILE_STATE_FAILED if it has never been requested)
+	COMPILE_STATE GetState(uint64_t hash) const;
+
+	//! @brief get a pipeline state which is ready
+	//!
+	//! @param[in] hash hash of the pipeline state description
+	//! @return return the pipeline state, nullptr if it is not ready
+	ID3D12PipelineState* GetPipeline(uint64_t hash) const;
+
+	//! @brief get count of pipeline states
+	//!
+	//! @return return count of unique pipeline states
+	size_t GetPipelineCount() const;
+
+	//! @brief get count of pipeline states loaded from the library
+	//!
+	//! @return return count of pipeline states which were not compiled
+	size_t GetLibraryHitCount() const;
+
+private:
+
+	//
+	// Item structure
+	//
+	// Deep copy of a requested description, since it is compiled after the call returns.
+	//
+	struct Item
+	{
+		uint64_t Hash; //!< hash of the description
+		D3D12_GRAPHICS_PIPELINE_STATE_DESC Desc; //!< description (pointers refer to the members below)
+		std::vector<uint8_t> Shaders[5]; //!< bytecode of VS, PS, DS, HS and GS
+		std::vector<D3D12_INPUT_ELEMENT_DESC> Elements; //!< input layout
+		std::vector<D3D12_SO_DECLARATION_ENTRY> Entries; //!< stream output declaration
+		std::vector<UINT> Strides; //!< stream output strides
+		std::vector<std::string> Names; //!< semantic names
+		ComPtr<ID3D12PipelineState> pPipeline; //!< result of Compile()
+		bool IsFromLibrary; //!< whether the result was loaded from the library
+	};
+
+	ComPtr<ID3D12Device> m_pDevice; //!< device
+	ComPtr<ID3D12PipelineLibrary> m_pLibrary; //!< pipeline library (nullptr if unsupported)
+	std::vector<uint8_t> m_LibraryData; //!< data the library was created from (must outlive the library)
+	std::wstring m_Filename; //!< file of the library
+	bool m_IsDirty; //!< whether the library has pipelines which are not saved
+	size_t m_LibraryHits; //!< count of pipelines loaded from the library
+	std::map<std::wstring, ComPtr<ID3DBlob>> m_Shaders; //!< shader blobs by path
+	std::map<uint64_t, ComPtr<ID3D12RootSignature>> m_RootSignatures; //!< root signatures by description hash
+	std::map<ID3D12RootSignature*, uint64_t> m_RootSignatureHashes; //!< description hashes by root signature
+	std::map<uint64_t, ComPtr<ID3D12PipelineState>> m_Pipelines; //!< pipeline states by description hash
+	std::mutex m_LibraryMutex; //!< guards the library, which must not load one pipeline on two threads
+	CompileScheduler m_Scheduler; //!< queue of requested pipelines
+	ThreadPool m_InlinePool; //!< pool which is never initialized, so it compiles inline
+	std::map<uint64_t, uint32_t> m_Requests; //!< latest request id by description hash
+	std::map<uint32_t, Item*> m_pItems; //!< requested pipelines by request id
+	mutable std::mutex m_ItemMutex; //!< guards m_pItems
+
+	//! @brief create the pipeline library
+	//!
+	//! @param[in] pDevice device
+	void InitLibrary(ID3D12Device* pDevice);
+
+	//! @brief hash a description with its root signature
+	//!
+	//! @param[in] desc pipeline state description
+	//! @param[out] hash hash of the description
+	//! @retval true successfully hashed
+	//! @retval false the root signature is not from GetRootSignature()
+	bool GetPipelineHash(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, uint64_t& hash) const;
+
+	//! @brief load a pipeline state from the library or compile it
+	//!
+	//! @param[in] desc pipeline state description
+	//! @param[in] hash hash of the description
+	//! @param[out] pPipeline pipeline state
+	//! @param[out] isFromLibrary whether it was loaded from the library
+	//! @retval true successfully created
+	//! @retval false failed to compile
+	//! @note thread safe
+	bool CreatePipeline(
+		const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc,
+		uint64_t hash,
+		ComPtr<ID3D12PipelineState>& pPipeline,
+		bool& isFromLibrary);
+
+	//! @brief add a created pipeline state
+	//!
+	//! @param[in] hash hash of the description
+	//! @param[in] pPipeline pipeline state
+	//! @param[in] isFromLibrary whether it was loaded from the library
+	//! @return return the pipeline state kept by the cache
+	ID3D12PipelineState* AddPipeline(uint64_t hash, ID3D12PipelineState* pPipeline, bool isFromLibrary);
+
+	//! @brief copy a description which is compiled later
+	//!
+	//! @param[in] desc pipeline state description
+	//! @param[out] item deep copy
+	static void CopyDesc(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, Item& item);
+
+	bool Compile(uint32_t id) override;
+	void Finish(uint32_t id, COMPILE_STATE state) override;
+
+	PipelineCache(const PipelineCache&) = delete;
+	void operator = (const PipelineCache&) = delete;
+};
@@ -3,7 +3,6 @@
 #include <cstdint>
 #include <mutex>
 #include <cassert>
-#include <functional>
 
 template<typename T>
 class Pool
@@ -90,7 +89,8 @@ public:
 	//! 
 	//! @param[in] func [Uɂ鏉
 	//! @return mۂACeւ̃|C^, mۂɎsƂnullptr
-	T* Alloc(std::function<void(uint32_t, T*)> func = nullptr)
+	template<typename Func>
+	T* Alloc(Func func)
 	{
 		std::lock_guard<std::mutex> guard(m_Mutex);
 
@@ -111,14 +111,19 @@ public:
 		//蓖
 		auto val = new((void*)item) T();
 
-		if (func != nullptr)
-		{
-			func(item->m_Index, val);
-		}
+		func(item->m_Index, val);
 
 		return val;
 	}
 
+	//! @brief allocate item without user initialization
+	//! 
+	//! @return pointer to the allocated item, nullptr if allocation failed
+	T* Alloc()
+	{
+		return Alloc([](uint32_t, T*) {});
+	}
+
 	//! @brief free the item
 	//! 
 	//! @param[in] pValue pointer to the item to be free
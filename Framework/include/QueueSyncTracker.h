@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+
+//
+// QUEUE_TYPE enum
+//
+enum QUEUE_TYPE
+{
+	QUEUE_TYPE_DIRECT = 0, //!< graphics
+	QUEUE_TYPE_COPY, //!< uploads
+	QUEUE_TYPE_COMPUTE, //!< async compute
+	QUEUE_TYPE_COUNT,
+};
+
+//
+// QueueSyncTracker class
+//
+// Dependencies between command queues, independent of D3D12. Every queue keeps the highest
+// value of each queue which its next work is already ordered after, and every signal keeps a
+// copy of it. A wait takes over the copy of the signal it waits for, so dependencies carry
+// through other queues, and a wait which is already implied is reported as unnecessary.
+//
+class QueueSyncTracker
+{
+
+public:
+
+	//! @brief constructor
+	QueueSyncTracker();
+
+	//! @brief destructor
+	~QueueSyncTracker();
+
+	//! @brief forget every signal and wait
+	void Reset();
+
+	//! @brief record a signal
+	//!
+	//! @param[in] queue queue which signals
+	//! @param[in] value signaled value
+	//! @retval true recorded
+	//! @retval false the value does not increase
+	bool Signal(QUEUE_TYPE queue, uint64_t value);
+
+	//! @brief check whether a queue has to wait for a value
+	//!
+	//! @param[in] waiter queue which would wait
+	//! @param[in] signaler queue which signals the value
+	//! @param[in] value fence value of signaler
+	//! @retval true the wait is necessary
+	//! @retval false waiter is already ordered after the value, or the value has completed
+	bool NeedsWait(QUEUE_TYPE waiter, QUEUE_TYPE signaler, uint64_t value) const;
+
+	//! @brief record a wait
+	//!
+	//! @param[in] waiter queue which waits
+	//! @param[in] signaler queue which signals the value
+	//! @param[in] value fence value of signaler
+	void Wait(QUEUE_TYPE waiter, QUEUE_TYPE signaler, uint64_t value);
+
+	//! @brief record a value which the CPU has seen completed
+	//!
+	//! @param[in] queue queue of the value
+	//! @param[in] completedValue completed fence value
+	void Complete(QUEUE_TYPE queue, uint64_t completedValue);
+
+	//! @brief get the highest value of a queue which the next work of another is ordered after
+	//!
+	//! @param[in] waiter queue whose next work is asked about
+	//! @param[in] signaler queue of the value
+	//! @return return fence value of signaler, 0 if none
+	uint64_t GetKnownValue(QUEUE_TYPE waiter, QUEUE_TYPE signaler) const;
+
+	//! @brief get the last signaled value of a queue
+	//!
+	//! @param[in] queue queue
+	//! @return return fence value, 0 if the queue has not signaled
+	uint64_t GetSignaledValue(QUEUE_TYPE queue) const;
+
+	//! @brief get the last completed value of a queue
+	//!
+	//! @param[in] queue queue
+	//! @return return fence value passed to Complete()
+	uint64_t GetCompletedValue(QUEUE_TYPE queue) const;
+
+private:
+
+	//
+	// Snapshot structure
+	//
+	struct Snapshot
+	{
+		uint64_t Value; //!< signaled value
+		uint64_t Known[QUEUE_TYPE_COUNT]; //!< values the signal is ordered after
+	};
+
+	uint64_t m_Known[QUEUE_TYPE_COUNT][QUEUE_TYPE_COUNT]; //!< values the next work of each queue is ordered after
+	uint64_t m_Completed[QUEUE_TYPE_COUNT]; //!< completed value of each queue
+	std::deque<Snapshot> m_History[QUEUE_TYPE_COUNT]; //!< signals of each queue which have not completed
+};
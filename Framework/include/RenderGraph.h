@@ -0,0 +1,260 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//
+// RESOURCE_USAGE enum
+//
+// Flags of how a pass uses a resource. Read usages may be combined, a write usage may not.
+//
+enum RESOURCE_USAGE
+{
+	RESOURCE_USAGE_NONE = 0,
+	RESOURCE_USAGE_RENDER_TARGET = 0x1, //!< written as render target
+	RESOURCE_USAGE_DEPTH_WRITE = 0x2, //!< written as depth stencil
+	RESOURCE_USAGE_COPY_DEST = 0x4, //!< written by copy
+	RESOURCE_USAGE_DEPTH_READ = 0x8, //!< read only depth stencil
+	RESOURCE_USAGE_PIXEL_SHADER = 0x10, //!< read by pixel shader
+	RESOURCE_USAGE_NON_PIXEL_SHADER = 0x20, //!< read by other shaders
+	RESOURCE_USAGE_COPY_SOURCE = 0x40, //!< read by copy
+	RESOURCE_USAGE_PRESENT = 0x80, //!< presented
+
+	RESOURCE_USAGE_WRITE_MASK = RESOURCE_USAGE_RENDER_TARGET | RESOURCE_USAGE_DEPTH_WRITE | RESOURCE_USAGE_COPY_DEST,
+};
+
+//
+// RenderGraph class
+//
+// Passes of a frame and the resources they read and write, independent of D3D12. Compile()
+// culls passes whose results nothing uses, derives the barriers each pass needs (batched, so
+// a pass issues them with one call, and merged over passes which only read a resource), and
+// places transient resources whose lifetimes do not overlap in shared heap memory. As frames
+// repeat, a resource also takes over memory from those used after it in the previous frame.
+// Passes run in the order they were added. A pass which writes a resource without reading it
+// overwrites the whole resource, so passes writing it before are not needed for it.
+//
+class RenderGraph
+{
+
+public:
+
+	static const uint32_t InvalidId = UINT32_MAX; //!< invalid pass or resource id
+
+	//
+	// BARRIER_TYPE enum
+	//
+	enum BARRIER_TYPE
+	{
+		BARRIER_TYPE_TRANSITION = 0, //!< change usage of Resource from Before to After
+		BARRIER_TYPE_ALIASING, //!< Resource starts to use memory which ResourceBefore used
+	};
+
+	//
+	// ResourceDesc structure
+	//
+	struct ResourceDesc
+	{
+		uint32_t Usage; //!< usage between frames (RESOURCE_USAGE flags). the graph starts and ends in it
+		uint64_t Size; //!< size in memory in bytes (transient resources only)
+		uint64_t Alignment; //!< alignment of the heap offset in bytes, power of 2 (transient resources only)
+		bool IsTransient; //!< contents are not needed outside the frame, so the memory may be shared
+		bool IsOutput; //!< contents are used after the frame (e.g. back buffer), so its writers are never culled
+	};
+
+	//
+	// Barrier structure
+	//
+	struct Barrier
+	{
+		BARRIER_TYPE Type; //!< barrier type
+		uint32_t Resource; //!< resource id
+		uint32_t ResourceBefore; //!< resource id which used the memory before (aliasing only)
+		uint32_t Before; //!< usage before (transition only)
+		uint32_t After; //!< usage after (transition only)
+	};
+
+	//
+	// Placement structure
+	//
+	struct Placement
+	{
+		uint64_t Offset; //!< offset in the transient heap
+		uint64_t Size; //!< size in bytes
+		uint32_t FirstPass; //!< position of the first pass using the resource in GetPassOrder()
+		uint32_t LastPass; //!< position of the last pass using the resource in GetPassOrder()
+	};
+
+	//! @brief constructor
+	RenderGraph();
+
+	//! @brief destructor
+	~RenderGraph();
+
+	//! @brief discard every pass, resource and compiled result
+	void Reset();
+
+	//! @brief add a resource
+	//!
+	//! @param[in] name name for logs
+	//! @param[in] desc resource description
+	//! @return return resource id, InvalidId if the description is invalid
+	uint32_t AddResource(const char* name, const ResourceDesc& desc);
+
+	//! @brief add a pass
+	//!
+	//! @param[in] name name for logs
+	//! @param[in] hasSideEffects if true, the pass is never culled
+	//! @return return pass id
+	uint32_t AddPass(const char* name, bool hasSideEffects = false);
+
+	//! @brief declare that a pass reads a resource
+	//!
+	//! @param[in] pass pass id
+	//! @param[in] resource resource id
+	//! @param[in] usage read usages (RESOURCE_USAGE flags)
+	//! @retval true declared
+	//! @retval false invalid argument, or the pass writes the resource with another usage
+	bool Read(uint32_t pass, uint32_t resource, uint32_t usage);
+
+	//! @brief declare that a pass writes a resource
+	//!
+	//! @param[in] pass pass id
+	//! @param[in] resource resource id
+	//! @param[in] usage one write usage (RESOURCE_USAGE flag)
+	//! @retval true declared
+	//! @retval false invalid argument, or the pass already uses the resource with another usage
+	//! @note a pass which also reads what it writes (e.g. blending) declares Read() with the same usage
+	bool Write(uint32_t pass, uint32_t resource, uint32_t usage);
+
+	//! @brief cull passes, derive barriers and place transient resources
+	//!
+	//! @retval true successfully compiled
+	//! @retval false failed to compile
+	bool Compile();
+
+	//! @brief check whether a pass has been culled
+	//!
+	//! @param[in] pass pass id
+	//! @retval true the pass is not run
+	bool IsCulled(uint32_t pass) const;
+
+	//! @brief get ids of the passes to run, in order
+	//!
+	//! @return return pass ids
+	const std::vector<uint32_t>& GetPassOrder() const;
+
+	//! @brief get barriers to issue before a pass
+	//!
+	//! @param[in] pass pass id
+	//! @return return barriers, empty if the pass has been culled
+	const std::vector<Barrier>& GetBarriers(uint32_t pass) const;
+
+	//! @brief get barriers to issue after the last pass
+	//!
+	//! @return return barriers which return resources to their usage between frames
+	const std::vector<Barrier>& GetFinalBarriers() const;
+
+	//! @brief get placement of a transient resource
+	//!
+	//! @param[in] resource resource id
+	//! @param[out] result placement
+	//! @retval true the resource is placed in the transient heap
+	//! @retval false the resource is not transient or no pass uses it
+	bool GetPlacement(uint32_t resource, Placement& result) const;
+
+	//! @brief get size of the heap which transient resources are placed in
+	//!
+	//! @return return heap size in bytes
+	uint64_t GetHeapSize() const;
+
+	//! @brief get size which transient resources would take without sharing memory
+	//!
+	//! @return return size in bytes
+	uint64_t GetUnaliasedSize() const;
+
+	//! @brief get pass count
+	//!
+	//! @return return count of added passes
+	uint32_t GetPassCount() const;
+
+	//! @brief get resource count
+	//!
+	//! @return return count of added resources
+	uint32_t GetResourceCount() const;
+
+	//! @brief get name of a pass
+	//!
+	//! @param[in] pass pass id
+	//! @return return pass name
+	const char* GetPassName(uint32_t pass) const;
+
+	//! @brief get name of a resource
+	//!
+	//! @param[in] resource resource id
+	//! @return return resource name
+	const char* GetResourceName(uint32_t resource) const;
+
+private:
+
+	//
+	// Access structure
+	//
+	struct Access
+	{
+		uint32_t Resource; //!< resource id
+		uint32_t Usage; //!< RESOURCE_USAGE flags
+		bool IsRead; //!< the pass needs the contents
+		bool IsWrite; //!< the pass changes the contents
+	};
+
+	//
+	// Pass structure
+	//
+	struct Pass
+	{
+		std::string Name; //!< name
+		bool HasSideEffects; //!< never culled
+		bool IsCulled; //!< culled by Compile()
+		std::vector<Access> Accesses; //!< resources the pass uses
+		std::vector<Barrier> Barriers; //!< barriers before the pass
+	};
+
+	//
+	// Resource structure
+	//
+	struct Resource
+	{
+		std::string Name; //!< name
+		ResourceDesc Desc; //!< description
+		bool IsPlaced; //!< placed in the transient heap
+		Placement Place; //!< placement in the transient heap
+	};
+
+	std::vector<Pass> m_Passes; //!< passes in the order they run
+	std::vector<Resource> m_Resources; //!< resources
+	std::vector<uint32_t> m_Order; //!< ids of passes not culled
+	std::vector<Barrier> m_FinalBarriers; //!< barriers after the last pass
+	uint64_t m_HeapSize; //!< size of the transient heap
+	uint64_t m_UnaliasedSize; //!< size of transient resources without sharing memory
+
+	//! @brief find the access of a pass to a resource
+	//!
+	//! @return return the access, nullptr if the pass does not use the resource
+	Access* FindAccess(uint32_t pass, uint32_t resource);
+
+	//! @brief mark passes which do not contribute to outputs
+	void Cull();
+
+	//! @brief derive barriers of passes not culled
+	void BuildBarriers();
+
+	//! @brief place transient resources and add aliasing barriers
+	//!
+	//! @retval false a resource sharing memory is read before it is written
+	bool PlaceResources();
+
+	RenderGraph(const RenderGraph&) = delete;
+	void operator = (const RenderGraph&) = delete;
+};
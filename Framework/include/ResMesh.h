@@ -5,6 +5,11 @@
 #include <string>
 #include <vector>
 
+//
+// Forward Declarations.
+//
+class ThreadPool;
+
 //
 // ResMaterial structure
 //
@@ -66,9 +71,16 @@ struct ResMesh
 //! @param[in] filename path of the file
 //! @param[out] meshes container of mesh
 //! @param[out] materials container of material
+//! @param[in] pPool thread pool which converts meshes and materials in parallel (nullptr runs serially)
 //! @retval true successfully loaded
 //! @retval false failed to load
 bool LoadMesh(
 	const wchar_t* filename,
 	std::vector<ResMesh>& meshes,
-	std::vector<ResMaterial>& materials);
+	std::vector<ResMaterial>& materials,
+	ThreadPool* pPool = nullptr);
+
+//! @brief get post processing flags LoadMesh() imports with
+//! 
+//! @return return importer flags (part of the key of a cooked mesh)
+uint32_t GetMeshImportFlags();
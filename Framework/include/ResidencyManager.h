@@ -0,0 +1,148 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+//
+// ResidencyManager class
+//
+// Decides which mip levels of streamed textures stay in video memory. Every texture keeps
+// its mip tail resident; finer mips are brought in as they are requested and evicted from
+// the least recently used textures when the byte budget runs out. It only does the
+// bookkeeping, so the caller uploads or drops the mips reported by Update().
+//
+class ResidencyManager
+{
+
+public:
+
+	static const uint32_t InvalidId = UINT32_MAX; //!< id which is never registered
+
+	//
+	// Change structure
+	//
+	struct Change
+	{
+		uint32_t Id; //!< texture id
+		uint32_t ResidentMip; //!< new most detailed resident mip
+	};
+
+	//! @brief constructor
+	ResidencyManager();
+
+	//! @brief destructor
+	~ResidencyManager();
+
+	//! @brief initialize
+	//!
+	//! @param[in] budget bytes which resident mips may use
+	//! @param[in] maxUploadBytes bytes which one update may bring in (0 for no limit)
+	//! @retval true successfully initialized
+	//! @retval false failed to initialize
+	bool Init(uint64_t budget, uint64_t maxUploadBytes = 0);
+
+	//! @brief end
+	void Term();
+
+	//! @brief register a texture
+	//!
+	//! @param[in] pMipSizes size of each mip, the most detailed first
+	//! @param[in] mipCount mip level count
+	//! @param[in] tailMip most detailed mip of the tail, which stays resident
+	//! @return return id of the texture, InvalidId if the arguments are invalid
+	//! @note the tail is reported by the next Update(). it is counted even if it exceeds the budget
+	uint32_t Register(const uint64_t* pMipSizes, uint32_t mipCount, uint32_t tailMip);
+
+	//! @brief unregister a texture
+	//!
+	//! @param[in] id texture id
+	void Unregister(uint32_t id);
+
+	//! @brief request mips of a texture for the current frame
+	//!
+	//! @param[in] id texture id
+	//! @param[in] mip most detailed mip needed (several requests in a frame keep the finest)
+	void Request(uint32_t id, uint32_t mip);
+
+	//! @brief decide residency and advance to the next frame
+	//!
+	//! @param[out] changes textures whose resident mip changed
+	//! @note upload cost counts the whole new mip range, since a resized texture is rebuilt
+	void Update(std::vector<Change>& changes);
+
+	//! @brief correct the resident mip of a texture whose change could not be applied
+	//!
+	//! @param[in] id texture id
+	//! @param[in] mip most detailed mip actually resident (mip count if nothing is resident)
+	//! @note the next Update() requests the mips again if the texture still needs them
+	void SetResidentMip(uint32_t id, uint32_t mip);
+
+	//! @brief get most detailed resident mip
+	//!
+	//! @param[in] id texture id
+	//! @return return most detailed resident mip, 0 if the id is invalid
+	uint32_t GetResidentMip(uint32_t id) const;
+
+	//! @brief get bytes used by resident mips
+	//!
+	//! @return return bytes used by resident mips
+	uint64_t GetUsedBytes() const;
+
+	//! @brief get budget
+	//!
+	//! @return return bytes which resident mips may use
+	uint64_t GetBudget() const;
+
+	//! @brief set budget
+	//!
+	//! @param[in] budget bytes which resident mips may use
+	//! @note a smaller budget evicts unused mips on the next Update()
+	void SetBudget(uint64_t budget);
+
+private:
+
+	//
+	// Entry structure
+	//
+	struct Entry
+	{
+		std::vector<uint64_t> Bytes; //!< Bytes[i] is the size of mips i to the last one
+		uint32_t TailMip; //!< most detailed mip of the tail
+		uint32_t ResidentMip; //!< most detailed resident mip
+		uint32_t RequestedMip; //!< most detailed mip requested at LastUsed
+		uint64_t LastUsed; //!< frame of the last request
+		bool IsActive; //!< whether the id is registered
+	};
+
+	std::vector<Entry> m_Entries; //!< entries by id
+	std::vector<uint32_t> m_FreeIds; //!< unregistered ids
+	std::vector<Change> m_Registered; //!< tails reported by the next update
+	uint64_t m_Budget; //!< bytes which resident mips may use
+	uint64_t m_MaxUploadBytes; //!< bytes which one update may bring in
+	uint64_t m_UsedBytes; //!< bytes used by resident mips
+	uint64_t m_Frame; //!< current frame
+
+	//! @brief get most detailed mip a texture needs this frame
+	uint32_t GetNeededMip(const Entry& entry) const;
+
+	ResidencyManager(const ResidencyManager&) = delete;
+	void operator = (const ResidencyManager&) = delete;
+};
+
+//! @brief compute projected size of an object on screen
+//!
+//! @param[in] worldSize size of the object in world units
+//! @param[in] distance distance from the camera
+//! @param[in] fovY vertical field of view in radians
+//! @param[in] viewportHeight height of the viewport in pixels
+//! @return return size in pixels
+float ComputeScreenSize(float worldSize, float distance, float fovY, float viewportHeight);
+
+//! @brief select the most detailed mip needed to cover a size on screen
+//!
+//! @param[in] width width of mip 0
+//! @param[in] height height of mip 0
+//! @param[in] mipCount mip level count
+//! @param[in] screenSize size of the texture on screen in pixels
+//! @return return mip whose texels are not smaller than one pixel
+uint32_t SelectMip(uint32_t width, uint32_t height, uint32_t mipCount, float screenSize);
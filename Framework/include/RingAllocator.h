@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+
+//
+// RingAllocator class
+//
+// Bump allocator over a ring of indices [0, capacity). Allocations made during a frame
+// are tagged with a fence value by FinishFrame() and released together by Retire()
+// once that value has completed. It only sees plain numbers, never a GPU fence.
+//
+class RingAllocator
+{
+
+public:
+
+	static const uint32_t InvalidOffset = UINT32_MAX; //!< returned when allocation fails
+
+	//! @brief constructor
+	RingAllocator();
+
+	//! @brief destructor
+	~RingAllocator();
+
+	//! @brief initialize
+	//! 
+	//! @param[in] capacity number of indices in the ring
+	//! @retval true successfully initialized
+	//! @retval false failed to initialize
+	bool Init(uint32_t capacity);
+
+	//! @brief end
+	void Term();
+
+	//! @brief allocate contiguous indices for the current frame
+	//! 
+	//! @param[in] count index count
+	//! @return offset of the first index, InvalidOffset if the ring is full
+	uint32_t Alloc(uint32_t count);
+
+	//! @brief close the current frame
+	//! 
+	//! @param[in] fenceValue value which is signaled when the frame has been processed
+	void FinishFrame(uint64_t fenceValue);
+
+	//! @brief release every frame whose fence value has completed
+	//! 
+	//! @param[in] completedValue completed fence value
+	void Retire(uint64_t completedValue);
+
+	//! @brief get total index count
+	//! 
+	//! @return return total index count
+	uint32_t GetCapacity() const;
+
+	//! @brief get index count in use (including padding skipped at wrap around)
+	//! 
+	//! @return return index count in use
+	uint32_t GetUsedCount() const;
+
+private:
+
+	//
+	// Frame structure
+	//
+	struct Frame
+	{
+		uint64_t FenceValue; //!< fence value which retires the frame
+		uint32_t Size; //!< index count used by the frame
+	};
+
+	std::deque<Frame> m_Frames; //!< frames waiting for their fence
+	uint32_t m_Capacity; //!< total index count
+	uint32_t m_Head; //!< next allocation position
+	uint32_t m_UsedCount; //!< index count in use
+	uint32_t m_FrameSize; //!< index count used by the current frame
+
+	RingAllocator(const RingAllocator&) = delete;
+	void operator = (const RingAllocator&) = delete;
+};
@@ -4,6 +4,11 @@
 #include <d3d12.h>
 #include <vector>
 
+//
+// Forward Declarations.
+//
+class PipelineCache;
+
 //
 // ShaderState enum
 //
@@ -30,6 +35,17 @@ enum SamplerState
 	AnisotropicClamp, //!< anisotropic sampling - clamp
 };
 
+//! @brief maximum cost of a root signature in DWORDs
+//!
+//! descriptor tables cost 1, root descriptors 2, and root constants 1 per 32 bit value
+static const uint32_t MaxRootSignatureCost = 64;
+
+//! @brief compute cost of a root signature
+//!
+//! @param[in] desc root signature description
+//! @return return cost in DWORDs
+uint32_t GetRootSignatureCost(const D3D12_ROOT_SIGNATURE_DESC& desc);
+
 //
 // RootSignature class
 //
@@ -47,15 +63,21 @@ public:
 		Desc();
 		~Desc();
 		Desc& Begin(int count);
-		Desc& SetCBV(ShaderStage stage, int index, uint32_t reg);
-		Desc& SetSRV(ShaderStage stage, int index, uint32_t reg);
-		Desc& SetUAV(ShaderStage stage, int index, uint32_t reg);
-		Desc& SetSmp(ShaderStage stage, int index, uint32_t reg);
+		Desc& SetCBV(ShaderStage stage, int index, uint32_t reg, uint32_t count = 1);
+		Desc& SetSRV(ShaderStage stage, int index, uint32_t reg, uint32_t count = 1);
+		Desc& SetUAV(ShaderStage stage, int index, uint32_t reg, uint32_t count = 1);
+		Desc& SetSmp(ShaderStage stage, int index, uint32_t reg, uint32_t count = 1);
+		Desc& SetUnboundedSRV(ShaderStage stage, int index, uint32_t reg, uint32_t space);
+		Desc& SetConstants(ShaderStage stage, int index, uint32_t reg, uint32_t count);
+		Desc& SetRootCBV(ShaderStage stage, int index, uint32_t reg);
+		Desc& SetRootSRV(ShaderStage stage, int index, uint32_t reg);
 		Desc& AddStaticSmp(ShaderStage stage, uint32_t reg, SamplerState state);
 		Desc& AllowIL();
 		Desc& AllowSO();
 		Desc& End();
 		const D3D12_ROOT_SIGNATURE_DESC* GetDesc() const;
+		uint32_t GetCost() const;
+		bool IsValid() const;
 
 	private:
 		std::vector<D3D12_DESCRIPTOR_RANGE> m_Ranges;
@@ -66,13 +88,15 @@ public:
 		uint32_t m_Flags;
 
 		void CheckStage(ShaderStage stage);
-		void SetParam(ShaderStage, int index, uint32_t reg, D3D12_DESCRIPTOR_RANGE_TYPE type);
+		void SetParam(ShaderStage, int index, uint32_t reg, uint32_t count, D3D12_DESCRIPTOR_RANGE_TYPE type, uint32_t space = 0);
+		void SetRootParam(ShaderStage stage, int index, uint32_t reg, D3D12_ROOT_PARAMETER_TYPE type);
 	};
 
 	// public methods
 	RootSignature();
 	~RootSignature();
 	bool Init(ID3D12Device* pDevice, const D3D12_ROOT_SIGNATURE_DESC* pDesc);
+	bool Init(PipelineCache* pCache, const D3D12_ROOT_SIGNATURE_DESC* pDesc);
 	void Term();
 	ID3D12RootSignature* GetPtr() const;
 
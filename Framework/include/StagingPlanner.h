@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+//
+// StagingPlanner class
+//
+// Decides where each upload lands in fixed-size staging chunks and which copy regions
+// have to be recorded. Requests larger than a chunk are split, every placement starts at
+// an aligned offset, and neighbouring regions which are contiguous both in the staging
+// chunk and in the destination are merged by Coalesce(). It never touches the GPU.
+//
+class StagingPlanner
+{
+
+public:
+
+	//
+	// Region structure
+	//
+	struct Region
+	{
+		uint32_t Chunk; //!< staging chunk index
+		uint64_t SrcOffset; //!< offset in the staging chunk
+		uint32_t Target; //!< destination id given by the caller
+		uint64_t DstOffset; //!< offset in the destination
+		uint64_t Size; //!< size in bytes
+	};
+
+	//! @brief constructor
+	StagingPlanner();
+
+	//! @brief destructor
+	~StagingPlanner();
+
+	//! @brief initialize
+	//! 
+	//! @param[in] chunkSize size of one staging chunk in bytes
+	//! @param[in] alignment alignment of placements in bytes (power of 2)
+	//! @retval true successfully initialized
+	//! @retval false failed to initialize
+	bool Init(uint64_t chunkSize, uint64_t alignment);
+
+	//! @brief end
+	void Term();
+
+	//! @brief discard every planned region
+	void Reset();
+
+	//! @brief plan an upload
+	//! 
+	//! @param[in] target destination id
+	//! @param[in] dstOffset offset in the destination
+	//! @param[in] size size in bytes
+	//! @param[out] pFirst index of the first region added by this call (optional)
+	//! @retval true successfully planned
+	//! @retval false invalid argument
+	//! @note regions [*pFirst, GetRegionCount()) belong to this upload, in destination order
+	bool Add(uint32_t target, uint64_t dstOffset, uint64_t size, size_t* pFirst = nullptr);
+
+	//! @brief get staging chunk count after planning an upload
+	//! 
+	//! @param[in] target destination id
+	//! @param[in] dstOffset offset in the destination
+	//! @param[in] size size in bytes
+	//! @return return chunk count which Add() with the same arguments would leave
+	uint32_t GetChunkCountAfter(uint32_t target, uint64_t dstOffset, uint64_t size) const;
+
+	//! @brief get planned region
+	//! 
+	//! @param[in] index region index
+	//! @return return planned region
+	const Region& GetRegion(size_t index) const;
+
+	//! @brief get planned region count
+	//! 
+	//! @return return planned region count
+	size_t GetRegionCount() const;
+
+	//! @brief get copy regions, merging contiguous ones
+	//! 
+	//! @param[out] result copy regions to record
+	void Coalesce(std::vector<Region>& result) const;
+
+	//! @brief get staging chunk count
+	//! 
+	//! @return return staging chunk count
+	uint32_t GetChunkCount() const;
+
+	//! @brief get size of one staging chunk
+	//! 
+	//! @return return size of one staging chunk in bytes
+	uint64_t GetChunkSize() const;
+
+private:
+
+	std::vector<Region> m_Regions; //!< planned regions
+	uint64_t m_ChunkSize; //!< size of one staging chunk
+	uint64_t m_Alignment; //!< alignment of placements
+	uint32_t m_ChunkCount; //!< staging chunk count
+	uint64_t m_Cursor; //!< next free offset in the last chunk
+
+	//! @brief decide where an upload starts
+	//! 
+	//! @param[in] target destination id
+	//! @param[in] dstOffset offset in the destination
+	//! @param[in] size size in bytes
+	//! @param[out] remain bytes left from the offset in the last chunk, 0 if a new chunk is opened
+	//! @return return offset in the last chunk
+	uint64_t GetPlacement(uint32_t target, uint64_t dstOffset, uint64_t size, uint64_t& remain) const;
+
+	StagingPlanner(const StagingPlanner&) = delete;
+	void operator = (const StagingPlanner&) = delete;
+};
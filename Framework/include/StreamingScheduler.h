@@ -0,0 +1,177 @@
+#pragma once
+
+#include <ThreadPool.h>
+#include <cstdint>
+#include <atomic>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+//
+// STREAMING_STATE enum
+//
+enum STREAMING_STATE
+{
+	STREAMING_STATE_QUEUED = 0, //!< waiting for a slot
+	STREAMING_STATE_READING, //!< file is being read on an I/O thread
+	STREAMING_STATE_PARSING, //!< data is being parsed on a worker
+	STREAMING_STATE_PARSED, //!< waiting for the next upload batch
+	STREAMING_STATE_UPLOADING, //!< copy is on the GPU
+	STREAMING_STATE_RESIDENT, //!< ready to use
+	STREAMING_STATE_FAILED, //!< failed at some stage
+	STREAMING_STATE_CANCELED, //!< canceled before it became resident
+};
+
+//
+// StreamingUploader class
+//
+// Stages of one request which the scheduler drives. Read() and Parse() run on pool threads,
+// every other method on the thread which calls StreamingScheduler::Update().
+//
+class StreamingUploader
+{
+public:
+	virtual ~StreamingUploader()
+	{
+		// Do Nothing//
+	}
+
+	//! @brief read the file of a request (I/O thread)
+	virtual bool Read(uint32_t id, const std::wstring& path) = 0;
+
+	//! @brief parse the data read by Read() (worker thread)
+	virtual bool Parse(uint32_t id) = 0;
+
+	//! @brief record and submit the copies of parsed requests at once
+	//!
+	//! @param[in] ids requests to upload
+	//! @param[out] ticket value to pass to IsComplete()
+	virtual bool Submit(const std::vector<uint32_t>& ids, uint64_t& ticket) = 0;
+
+	//! @brief check whether a submitted batch has reached the GPU
+	virtual bool IsComplete(uint64_t ticket) = 0;
+
+	//! @brief take the result of a request (STREAMING_STATE_RESIDENT, FAILED or CANCELED)
+	//!
+	//! @note no pool thread uses the request any more, so its data may be released here
+	virtual void Finish(uint32_t id, STREAMING_STATE state) = 0;
+};
+
+//
+// StreamingScheduler class
+//
+// Request queue and stage tracking of background loading, independent of D3D12. At most
+// maxInFlight requests are between reading and parsing at once, higher priorities leave the
+// queue first (requests of the same priority in request order), and everything parsed while
+// an upload batch is on the GPU goes into the next batch, so one batch is in flight at a time.
+// A request has finished once Update() has reported it, and it can be canceled until then.
+// A canceled request never becomes resident: if a pool thread or the GPU still works on it,
+// it is handed to Finish() as canceled once they are done with it.
+//
+class StreamingScheduler
+{
+
+public:
+
+	//
+	// Result structure
+	//
+	struct Result
+	{
+		uint32_t Id; //!< request id
+		STREAMING_STATE State; //!< STREAMING_STATE_RESIDENT, FAILED or CANCELED
+	};
+
+	static const uint32_t InvalidId = UINT32_MAX;
+
+	//! @brief constructor
+	StreamingScheduler();
+
+	//! @brief destructor
+	~StreamingScheduler();
+
+	//! @brief initialize
+	//!
+	//! @param[in] pUploader stages of a request
+	//! @param[in] pIoPool threads which run Read() (an uninitialized pool runs it inline)
+	//! @param[in] pWorkerPool threads which run Parse() (an uninitialized pool runs it inline)
+	//! @param[in] maxInFlight maximum request count between reading and parsing
+	//! @retval true successfully initialized
+	//! @retval false failed to initialize
+	bool Init(
+		StreamingUploader* pUploader,
+		ThreadPool* pIoPool,
+		ThreadPool* pWorkerPool,
+		uint32_t maxInFlight);
+
+	//! @brief end
+	//!
+	//! @note waits for Read() and Parse() calls in flight. requests left are dropped without Finish()
+	void Term();
+
+	//! @brief queue a request
+	//!
+	//! @param[in] path file path (every call is a request of its own)
+	//! @param[in] priority higher values are started first
+	//! @return return request id
+	uint32_t Request(const std::wstring& path, int priority = 0);
+
+	//! @brief cancel a request
+	//!
+	//! @param[in] id request id
+	//! @retval true canceled, Update() reports it as STREAMING_STATE_CANCELED
+	//! @retval false the request is unknown or has already finished
+	bool Cancel(uint32_t id);
+
+	//! @brief advance requests
+	//!
+	//! @param[out] results requests which finished during this call (Finish() has been called for each)
+	void Update(std::vector<Result>& results);
+
+	//! @brief get state of a request
+	//!
+	//! @param[in] id request id
+	//! @return return state (STREAMING_STATE_FAILED for an unknown id)
+	STREAMING_STATE GetState(uint32_t id) const;
+
+	//! @brief check whether every request has finished
+	//!
+	//! @retval true no request is queued or in flight
+	bool IsIdle() const;
+
+private:
+
+	//
+	// Entry structure
+	//
+	struct Entry
+	{
+		std::wstring Path; //!< file path
+		STREAMING_STATE State; //!< current stage
+		bool IsCanceled; //!< whether the request was canceled after it had left the queue
+	};
+
+	StreamingUploader* m_pUploader; //!< stages of a request
+	ThreadPool* m_pIoPool; //!< threads which read
+	ThreadPool* m_pWorkerPool; //!< threads which parse
+	uint32_t m_MaxInFlight; //!< maximum request count between reading and parsing
+	uint32_t m_InFlight; //!< request count between reading and parsing
+	std::vector<Entry> m_Entries; //!< every request (index is the id)
+	std::multimap<int, uint32_t, std::greater<int>> m_Queue; //!< queued requests by priority
+	std::vector<uint32_t> m_Canceled; //!< queued requests canceled since the last Update()
+	std::vector<uint32_t> m_Parsed; //!< requests waiting for the next upload batch
+	std::vector<uint32_t> m_Uploading; //!< requests of the batch on the GPU
+	uint64_t m_Ticket; //!< ticket of the batch on the GPU
+	std::vector<std::pair<uint32_t, bool>> m_Finished; //!< requests which left the pool threads
+	mutable std::mutex m_Mutex; //!< guards m_Entries states and m_Finished
+	std::atomic<uint32_t> m_Tasks; //!< Read() and Parse() calls in flight
+
+	void Dispatch(uint32_t id);
+	void SetState(uint32_t id, STREAMING_STATE state);
+	void Report(uint32_t id, STREAMING_STATE state, std::vector<Result>& results);
+
+	StreamingScheduler(const StreamingScheduler&) = delete;
+	void operator = (const StreamingScheduler&) = delete;
+};
@@ -7,6 +7,7 @@
 // Forward Declarations
 class DescriptorHandle;
 class DescriptorPool;
+class DeferredReleaseQueue;
 
 // Texture class
 class Texture
@@ -82,9 +83,30 @@ public:
 		bool isCube,
 		bool isSRGB);
 
+	//! @brief initialize with an existing resource
+	//! 
+	//! @param[in] pDevice device
+	//! @param[in] pPool descriptor pool
+	//! @param[in] pResource texture resource (a reference is kept)
+	//! @param[in] isCube if texture is cube map, then specify true
+	//! @param[in] isSRGB if you use SRGB format, then specify true
+	//! @retval true successfully initialized
+	//! @retval false failed to initialize
+	bool Init(
+		ID3D12Device* pDevice,
+		DescriptorPool* pPool,
+		ID3D12Resource* pResource,
+		bool isCube,
+		bool isSRGB);
+
 	//! @brief I
 	void Term();
 
+	//! @brief end after the frames in flight
+	//! 
+	//! @param[in] pQueue queue which releases the texture and its view once the GPU has finished with them (nullptr to release at once)
+	void Term(DeferredReleaseQueue* pQueue);
+
 	//! @brief get CPU DescriptorHandle
 	//! 
 	//! @return return CPU DescriptorHandle
@@ -95,12 +117,19 @@ public:
 	//! @return return GPU DescriptorHandle
 	D3D12_GPU_DESCRIPTOR_HANDLE GetHandleGPU() const;
 
+	//! @brief create another shader resource view of this texture
+	//! 
+	//! @param[in] pDevice device
+	//! @param[in] handle CPU descriptor handle to write the view to
+	void CreateView(ID3D12Device* pDevice, D3D12_CPU_DESCRIPTOR_HANDLE handle) const;
+
 private:
 
 	// private variables
 	ComPtr<ID3D12Resource> m_pTex;
 	DescriptorHandle* m_pHandle;
 	DescriptorPool* m_pPool;
+	D3D12_SHADER_RESOURCE_VIEW_DESC m_ViewDesc;
 
 	// private methods
 	Texture(const Texture&) = delete;
@@ -0,0 +1,327 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+//! @brief version of the cooked texture manifest format
+static const uint32_t TextureManifestVersion = 1;
+
+//! @brief bytes at the start of a texture file which its pre-key hashes (the DDS header and the first page)
+static const size_t TexturePreKeySize = 4096;
+
+//
+// TextureKey structure
+//
+// Identifies a texture by the contents of its file. The size is part of the key, so a hash
+// collision also needs files of the same size; SRGB and linear views of one file differ.
+//
+struct TextureKey
+{
+	uint64_t Hash; //!< hash of the file contents
+	uint64_t Size; //!< size of the file in bytes
+	bool IsSRGB; //!< whether the texture is sampled as SRGB
+
+	//! @brief compare keys (for ordered containers)
+	bool operator < (const TextureKey& value) const;
+
+	//! @brief check whether keys are equal
+	bool operator == (const TextureKey& value) const;
+};
+
+//
+// TextureManifestEntry structure
+//
+struct TextureManifestEntry
+{
+	std::wstring Path; //!< texture path as passed to the loader
+	uint64_t Hash; //!< hash of the file contents (ComputeTextureKey)
+	uint64_t Size; //!< size of the file in bytes
+};
+
+//! @brief compute key of a texture file
+//! 
+//! @param[in] pData contents of the file
+//! @param[in] size size of the file
+//! @param[in] isSRGB whether the texture is sampled as SRGB
+//! @return return key of the texture
+TextureKey ComputeTextureKey(const void* pData, size_t size, bool isSRGB);
+
+//! @brief compute cheap key of a texture file from its size and first bytes
+//! 
+//! @param[in] pData contents of the file (only the first TexturePreKeySize bytes are read)
+//! @param[in] size size of the file
+//! @param[in] isSRGB whether the texture is sampled as SRGB
+//! @return return pre-key of the texture, which never equals a key of ComputeTextureKey()
+//! in practice, since it is hashed from another seed
+TextureKey ComputeTexturePreKey(const void* pData, size_t size, bool isSRGB);
+
+//! @brief serialize manifest entries into the cooked format
+//! 
+//! @param[in] entries hashes of texture files
+//! @param[out] result cooked data
+void SerializeTextureManifest(const std::vector<TextureManifestEntry>& entries, std::vector<uint8_t>& result);
+
+//! @brief restore manifest entries from cooked data
+//! 
+//! @param[in] pData cooked data
+//! @param[in] size size of the data
+//! @param[out] entries hashes of texture files
+//! @retval true successfully restored
+//! @retval false the data is broken or of another version
+bool DeserializeTextureManifest(const void* pData, size_t size, std::vector<TextureManifestEntry>& entries);
+
+//! @brief load a cooked texture manifest
+//! 
+//! @param[in] filename path of the manifest
+//! @param[out] entries hashes of texture files
+//! @retval true successfully loaded
+//! @retval false no file, or the file is broken or of another version
+bool LoadTextureManifest(const wchar_t* filename, std::vector<TextureManifestEntry>& entries);
+
+//! @brief write a cooked texture manifest
+//! 
+//! @param[in] filename path of the manifest
+//! @param[in] entries hashes of texture files
+//! @retval true successfully written
+//! @retval false failed to write
+bool SaveTextureManifest(const wchar_t* filename, const std::vector<TextureManifestEntry>& entries);
+
+//
+// TextureManifest class
+//
+// Precomputed keys by texture path, so textures can be matched without reading their files.
+//
+class TextureManifest
+{
+
+public:
+
+	//! @brief constructor
+	TextureManifest();
+
+	//! @brief destructor
+	~TextureManifest();
+
+	//! @brief replace the entries
+	//! 
+	//! @param[in] entries hashes of texture files
+	void SetEntries(const std::vector<TextureManifestEntry>& entries);
+
+	//! @brief remove every entry
+	void Clear();
+
+	//! @brief find key of a texture
+	//! 
+	//! @param[in] path texture path
+	//! @param[in] isSRGB whether the texture is sampled as SRGB
+	//! @param[out] key key of the texture
+	//! @retval true the manifest has the texture
+	//! @retval false the file has to be hashed
+	bool Find(const std::wstring& path, bool isSRGB, TextureKey& key) const;
+
+	//! @brief get entry count
+	//! 
+	//! @return return entry count
+	size_t GetCount() const;
+
+private:
+
+	std::map<std::wstring, TextureManifestEntry> m_Entries; //!< entries by path
+
+	TextureManifest(const TextureManifest&) = delete;
+	void operator = (const TextureManifest&) = delete;
+};
+
+//
+// TextureKeyTable class
+//
+// Gives texture files keys for TextureCache without hashing whole files in the common case.
+// The first file of each pre-key is keyed by the pre-key. Only when another file has the same
+// pre-key are both hashed in full: an identical file gets the pre-key as well, a different
+// one the key of its full hash.
+//
+class TextureKeyTable
+{
+
+public:
+
+	//! @brief compute the hash of a whole file as ComputeTextureKey() does
+	typedef std::function<bool(const std::wstring& path, uint64_t& hash)> HashFunc;
+
+	//! @brief constructor
+	TextureKeyTable();
+
+	//! @brief destructor
+	~TextureKeyTable();
+
+	//! @brief find key of a texture file
+	//! 
+	//! @param[in] path path of the file
+	//! @param[in] pData contents of the file (only the first TexturePreKeySize bytes are read)
+	//! @param[in] size size of the file
+	//! @param[in] isSRGB whether the texture is sampled as SRGB
+	//! @param[in] hashFile hashes a whole file, called only when pre-keys collide
+	//! @param[out] key key of the texture
+	//! @retval true successfully found
+	//! @retval false a file could not be hashed
+	bool Find(
+		const std::wstring& path,
+		const void* pData,
+		size_t size,
+		bool isSRGB,
+		const HashFunc& hashFile,
+		TextureKey& key);
+
+	//! @brief forget every file
+	void Clear();
+
+	//! @brief get count of files which have been hashed in full
+	//! 
+	//! @return return count of files hashed by hashFile
+	size_t GetFullHashCount() const;
+
+private:
+
+	std::map<TextureKey, std::wstring> m_Paths; //!< first file of each pre-key
+	std::map<std::wstring, uint64_t> m_Hashes; //!< full hashes of the files whose pre-keys collided
+
+	//! @brief get full hash of a file, hashing it only once
+	bool GetHash(const std::wstring& path, const HashFunc& hashFile, uint64_t& hash);
+
+	TextureKeyTable(const TextureKeyTable&) = delete;
+	void operator = (const TextureKeyTable&) = delete;
+};
+
+//
+// TextureCache class
+//
+// Shares one texture among every file with the same contents. Each Acquire() or Add() holds
+// a reference which Release() gives back; the caller destroys a texture when its last
+// reference is gone. The cache only stores pointers, so it works without a GPU.
+//
+template<typename T>
+class TextureCache
+{
+
+public:
+
+	//! @brief constructor
+	TextureCache()
+		: m_SavedBytes(0)
+	{
+	}
+
+	//! @brief destructor
+	~TextureCache()
+	{
+		Clear();
+	}
+
+	//! @brief find a texture and add a reference to it
+	//! 
+	//! @param[in] key key of the texture
+	//! @return return the shared texture, nullptr if no texture has the key
+	T* Acquire(const TextureKey& key)
+	{
+		auto itr = m_Entries.find(key);
+		if (itr == m_Entries.end())
+		{
+			return nullptr;
+		}
+
+		itr->second.RefCount++;
+		m_SavedBytes += key.Size;
+		return itr->second.pTexture;
+	}
+
+	//! @brief add a texture with one reference
+	//! 
+	//! @param[in] key key of the texture
+	//! @param[in] pTexture texture created for the key
+	//! @retval true successfully added
+	//! @retval false the key or the texture is registered already
+	bool Add(const TextureKey& key, T* pTexture)
+	{
+		if (pTexture == nullptr || m_Entries.find(key) != m_Entries.end() || m_Keys.find(pTexture) != m_Keys.end())
+		{
+			return false;
+		}
+
+		m_Entries[key] = { pTexture, 1 };
+		m_Keys[pTexture] = key;
+		return true;
+	}
+
+	//! @brief release a reference
+	//! 
+	//! @param[in] pTexture texture returned by Acquire() or passed to Add()
+	//! @retval true the last reference is gone, so the caller destroys the texture
+	//! @retval false the texture is still shared, or it is not in the cache
+	bool Release(T* pTexture)
+	{
+		auto itr = m_Keys.find(pTexture);
+		if (itr == m_Keys.end())
+		{
+			return false;
+		}
+
+		auto& entry = m_Entries[itr->second];
+		entry.RefCount--;
+		if (entry.RefCount > 0)
+		{
+			return false;
+		}
+
+		m_Entries.erase(itr->second);
+		m_Keys.erase(itr);
+		return true;
+	}
+
+	//! @brief forget every texture
+	//! 
+	//! @note textures are not destroyed
+	void Clear()
+	{
+		m_Entries.clear();
+		m_Keys.clear();
+		m_SavedBytes = 0;
+	}
+
+	//! @brief get count of unique textures
+	//! 
+	//! @return return texture count
+	size_t GetCount() const
+	{
+		return m_Entries.size();
+	}
+
+	//! @brief get bytes saved by sharing
+	//! 
+	//! @return return total file size of the textures which were not loaded again
+	uint64_t GetSavedBytes() const
+	{
+		return m_SavedBytes;
+	}
+
+private:
+
+	//
+	// Entry structure
+	//
+	struct Entry
+	{
+		T* pTexture; //!< shared texture
+		uint32_t RefCount; //!< reference count
+	};
+
+	std::map<TextureKey, Entry> m_Entries; //!< textures by key
+	std::map<T*, TextureKey> m_Keys; //!< keys by texture
+	uint64_t m_SavedBytes; //!< total file size which was not loaded again
+
+	TextureCache(const TextureCache&) = delete;
+	void operator = (const TextureCache&) = delete;
+};
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+//
+// ThreadPool class
+//
+// Every worker owns a task deque. A worker pops its own newest task first and steals the
+// oldest task of another worker when its deque is empty, so tasks submitted from a task
+// stay on that worker while idle workers still pick up the slack.
+//
+class ThreadPool
+{
+
+public:
+
+	//! @brief constructor
+	ThreadPool();
+
+	//! @brief destructor
+	~ThreadPool();
+
+	//! @brief initialize
+	//! 
+	//! @param[in] threadCount worker count (0 selects hardware concurrency - 1, at least 1)
+	//! @retval true successfully initialized
+	//! @retval false failed to initialize
+	bool Init(uint32_t threadCount = 0);
+
+	//! @brief end
+	//! 
+	//! @note runs every task still queued before the workers exit
+	void Term();
+
+	//! @brief queue a task
+	//! 
+	//! @param[in] task task to run on a worker
+	void Submit(std::function<void()> task);
+
+	//! @brief run func(i) for every i in [0, count) and wait for completion
+	//! 
+	//! @param[in] count iteration count
+	//! @param[in] func function to run
+	//! @param[in] grain iterations one task takes at once
+	//! @note the calling thread runs iterations as well, so it may be called from a task.
+	//! it waits only for its own iterations and never runs unrelated tasks.
+	//! runs serially if the pool is not initialized
+	void ParallelFor(size_t count, const std::function<void(size_t)>& func, size_t grain = 1);
+
+	//! @brief get worker count
+	//! 
+	//! @return return worker count
+	uint32_t GetThreadCount() const;
+
+private:
+
+	//
+	// Worker structure
+	//
+	struct Worker
+	{
+		std::mutex Mutex; //!< guards Tasks
+		std::deque<std::function<void()>> Tasks; //!< queued tasks
+		std::thread Thread; //!< worker thread
+	};
+
+	Worker* m_pWorkers; //!< workers
+	uint32_t m_ThreadCount; //!< worker count
+	std::atomic<uint32_t> m_Pending; //!< queued task count
+	std::atomic<uint32_t> m_NextWorker; //!< round robin target of external submissions
+	std::atomic<bool> m_Quit; //!< whether the workers should exit
+	std::mutex m_WakeMutex; //!< guards sleeping
+	std::condition_variable m_Wake; //!< wakes sleeping workers
+
+	void WorkerMain(uint32_t index);
+	bool TryRunTask(uint32_t index);
+
+	ThreadPool(const ThreadPool&) = delete;
+	void operator = (const ThreadPool&) = delete;
+};
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <d3d12.h>
+#include <ComPtr.h>
+#include <cstdint>
+
+//
+// TransientHeap class
+//
+// Video memory which render targets and depth targets living for part of a frame are
+// placed in. Offsets come from the lifetimes of the targets (see RenderGraph), so targets
+// which are never used at the same time share memory. It only accepts render target and
+// depth stencil textures, which every resource heap tier allows in one heap.
+//
+class TransientHeap
+{
+
+public:
+
+	//! @brief constructor
+	TransientHeap();
+
+	//! @brief destructor
+	~TransientHeap();
+
+	//! @brief initialize
+	//!
+	//! @param[in] pDevice device
+	//! @param[in] size heap size in bytes
+	//! @param[in] alignment heap alignment (D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT, or the MSAA one)
+	//! @retval true successfully initialized
+	//! @retval false failed to initialize
+	bool Init(ID3D12Device* pDevice, uint64_t size, uint64_t alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT);
+
+	//! @brief end
+	//!
+	//! @note resources placed in the heap must have been released
+	void Term();
+
+	//! @brief get heap
+	//!
+	//! @return return heap, nullptr before Init()
+	ID3D12Heap* GetHeap() const;
+
+	//! @brief get heap size
+	//!
+	//! @return return size in bytes
+	uint64_t GetSize() const;
+
+private:
+
+	ComPtr<ID3D12Heap> m_pHeap; //!< heap
+	uint64_t m_Size; //!< heap size
+
+	TransientHeap(const TransientHeap&) = delete;
+	void operator = (const TransientHeap&) = delete;
+};
@@ -3,6 +3,11 @@
 #include <d3d12.h>
 #include <ComPtr.h>
 
+//
+// Forward Declarations.
+//
+class BufferUploadBatch;
+
 //
 // VertexBuffer class
 //
@@ -39,10 +44,36 @@ public:
 		return Init(pDevice, size, sizeof(T), pInitData);
 	}
 
+	//! @brief initialize as static geometry in a DEFAULT heap
+	//! 
+	//! @param[in] batch upload batch which copies the initial data
+	//! @param[in] size size of VertexBuffer
+	//! @param[in] stride size of one vertex
+	//! @param[in] pInitData initialize data
+	//! @retval true successfully initialized
+	//! @retval false failed to initialize
+	//! @note the data is on the GPU once batch.End() has returned. Map() is not available
+	bool Init(BufferUploadBatch& batch, size_t size, size_t stride, const void* pInitData);
+
+	//! @brief initialize as static geometry in a DEFAULT heap
+	//! 
+	//! @param[in] batch upload batch which copies the initial data
+	//! @param[in] size size of VertexBuffer
+	//! @param[in] pInitData initialize data
+	//! @retval true successfully initialized
+	//! @retval false failed to initialize
+	template<typename T>
+	bool Init(BufferUploadBatch& batch, size_t size, const T* pInitData)
+	{
+		return Init(batch, size, sizeof(T), pInitData);
+	}
+
 	//! @brief end
 	void Term();
 
 	//! @brief memory mapping
+	//! 
+	//! @return return memory-mapped pointer, nullptr for static geometry
 	void* Map() const;
 
 	//! @brief unmap memory
@@ -64,6 +95,7 @@ private:
 
 	ComPtr<ID3D12Resource> m_pVB; //!< vertex buffer
 	D3D12_VERTEX_BUFFER_VIEW m_View; //!< vertex buffer view
+	bool m_IsStatic; //!< whether the buffer is in a DEFAULT heap
 
 	VertexBuffer(const VertexBuffer&) = delete;
 	void operator = (const VertexBuffer&) = delete;
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <ResMesh.h>
+#include <cstdint>
+#include <vector>
+
+//
+// VERTEX_FORMAT enum
+//
+enum VERTEX_FORMAT
+{
+	VERTEX_FORMAT_FULL = 0, //!< MeshVertex as is (44 bytes)
+	VERTEX_FORMAT_COMPACT, //!< float3 position, octahedral normal/tangent, half UV (24 bytes)
+	VERTEX_FORMAT_QUANTIZED, //!< unorm16 position in the mesh AABB, octahedral normal/tangent, half UV (20 bytes)
+
+	VERTEX_FORMAT_COUNT
+};
+
+//
+// CompactVertex class
+//
+class CompactVertex
+{
+public:
+	DirectX::XMFLOAT3 Position; //!< position
+	int16_t Normal[2]; //!< octahedral normal (snorm16)
+	int16_t Tangent[2]; //!< octahedral tangent (snorm16)
+	uint16_t TexCoord[2]; //!< texture coords (half)
+
+	static const D3D12_INPUT_LAYOUT_DESC InputLayout;
+
+private:
+	static const int InputElementCount = 4;
+	static const D3D12_INPUT_ELEMENT_DESC InputElements[InputElementCount];
+};
+
+//
+// QuantizedVertex class
+//
+class QuantizedVertex
+{
+public:
+	uint16_t Position[4]; //!< position in the mesh AABB (unorm16, w is unused)
+	int16_t Normal[2]; //!< octahedral normal (snorm16)
+	int16_t Tangent[2]; //!< octahedral tangent (snorm16)
+	uint16_t TexCoord[2]; //!< texture coords (half)
+
+	static const D3D12_INPUT_LAYOUT_DESC InputLayout;
+
+private:
+	static const int InputElementCount = 4;
+	static const D3D12_INPUT_ELEMENT_DESC InputElements[InputElementCount];
+};
+
+//
+// VertexQuantization structure
+//
+struct VertexQuantization
+{
+	DirectX::XMFLOAT3 Offset; //!< minimum of the AABB
+	DirectX::XMFLOAT3 Scale; //!< extent of the AABB (position = Offset + Scale * unorm)
+};
+
+//
+// VertexCodecError structure
+//
+struct VertexCodecError
+{
+	float MaxPosition; //!< maximum position error (object space)
+	float MaxNormalAngle; //!< maximum normal error in degrees
+	float MaxTangentAngle; //!< maximum tangent error in degrees
+	float MaxTexCoord; //!< maximum texture coords error
+};
+
+//! @brief get size of one vertex
+//! 
+//! @param[in] format vertex format
+//! @return return size of one vertex in bytes
+uint32_t GetVertexStride(VERTEX_FORMAT format);
+
+//! @brief get input layout
+//! 
+//! @param[in] format vertex format
+//! @return return input layout which matches the format
+D3D12_INPUT_LAYOUT_DESC GetVertexInputLayout(VERTEX_FORMAT format);
+
+//! @brief encode vertices
+//! 
+//! @param[in] format vertex format
+//! @param[in] vertices vertices to encode
+//! @param[out] result encoded vertices (GetVertexStride(format) bytes each)
+//! @param[out] quantization dequantization of positions (identity unless VERTEX_FORMAT_QUANTIZED)
+void EncodeVertices(
+	VERTEX_FORMAT format,
+	const std::vector<MeshVertex>& vertices,
+	std::vector<uint8_t>& result,
+	VertexQuantization& quantization);
+
+//! @brief decode vertices
+//! 
+//! @param[in] format vertex format
+//! @param[in] data encoded vertices
+//! @param[in] count vertex count
+//! @param[in] quantization dequantization of positions
+//! @param[out] result decoded vertices
+void DecodeVertices(
+	VERTEX_FORMAT format,
+	const uint8_t* data,
+	size_t count,
+	const VertexQuantization& quantization,
+	std::vector<MeshVertex>& result);
+
+//! @brief measure round trip error of a format
+//! 
+//! @param[in] format vertex format
+//! @param[in] vertices original vertices
+//! @return return maximum errors after encoding and decoding
+VertexCodecError MeasureVertexError(
+	VERTEX_FORMAT format,
+	const std::vector<MeshVertex>& vertices);
+
+//! @brief get error limit of a format
+//! 
+//! @param[in] format vertex format
+//! @param[in] vertices original vertices
+//! @return return largest errors which the precision of the format allows for the vertices
+//! @note MeasureVertexError() of the same vertices must not exceed any of the limits.
+VertexCodecError GetVertexErrorLimit(
+	VERTEX_FORMAT format,
+	const std::vector<MeshVertex>& vertices);
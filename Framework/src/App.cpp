@@ -1,4 +1,5 @@
 #include "App.h"
+#include "Logger.h"
 #include <algorithm>
 
 namespace
@@ -23,11 +24,12 @@ namespace
 //
 
 // constructor
-App::App(uint32_t width, uint32_t height, DXGI_FORMAT format)
+App::App(uint32_t width, uint32_t height, DXGI_FORMAT format, uint32_t frameCount)
 	: m_hInst(nullptr)
 	, m_hWnd(nullptr)
 	, m_Width(width)
 	, m_Height(height)
+	, m_FrameCount(std::min(std::max(frameCount, 2u), uint32_t(MaxFrameCount)))
 	, m_FrameIndex(0)
 	, m_BackBufferFormat(format)
 {
@@ -64,6 +66,12 @@ bool App::InitApp()
 		return false;
 	}
 
+	// initialize worker threads
+	if (!m_ThreadPool.Init())
+	{
+		return false;
+	}
+
 	// initialize application-specific
 	if (!OnInit())
 	{
@@ -86,9 +94,15 @@ bool App::InitApp()
 // end
 void App::TermApp()
 {
+	// frames in flight may still use the application's resources
+	WaitForGpu();
+
 	// end application-specific
 	OnTerm();
 
+	// end worker threads
+	m_ThreadPool.Term();
+
 	// end Direct3D 12
 	TermD3D();
 
@@ -212,6 +226,37 @@ bool App::InitD3D()
 		}
 	}
 
+	// generate command queue for uploads
+	{
+		D3D12_COMMAND_QUEUE_DESC desc = {};
+		desc.Type = D3D12_COMMAND_LIST_TYPE_COPY;
+		desc.Priority = D3D12_COMMAND_QUEUE_PRIORITY_NORMAL;
+		desc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
+		desc.NodeMask = 0;
+
+		hr = m_pDevice->CreateCommandQueue(&desc, IID_PPV_ARGS(&m_pCopyQueue));
+		if (FAILED(hr))
+		{
+			return false;
+		}
+	}
+
+	// generate command queue for async compute
+	{
+		D3D12_COMMAND_QUEUE_DESC desc = {};
+		desc.Type = D3D12_COMMAND_LIST_TYPE_COMPUTE;
+		desc.Priority = D3D12_COMMAND_QUEUE_PRIORITY_NORMAL;
+		desc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
+		desc.NodeMask = 0;
+
+		// compute work runs in order with graphics if the queue is not available
+		hr = m_pDevice->CreateCommandQueue(&desc, IID_PPV_ARGS(&m_pComputeQueue));
+		if (FAILED(hr))
+		{
+			m_pComputeQueue = m_pQueue;
+		}
+	}
+
 	// generate swap chain
 	{
 		// generate DXGI factory
@@ -233,7 +278,7 @@ bool App::InitD3D()
 		desc.SampleDesc.Count = 1;
 		desc.SampleDesc.Quality = 0;
 		desc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
-		desc.BufferCount = FrameCount;
+		desc.BufferCount = m_FrameCount;
 		desc.OutputWindow = m_hWnd;
 		desc.Windowed = TRUE;
 		desc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD;
@@ -269,7 +314,7 @@ bool App::InitD3D()
 		desc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
 		desc.NumDescriptors = 512;
 		desc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
-		if (!DescriptorPool::Create(m_pDevice.Get(), &desc, &m_pPool[POOL_TYPE_RES]))
+		if (!DescriptorPool::Create(m_pDevice.Get(), &desc, 256, &m_pPool[POOL_TYPE_RES])) // reserve 256 for descriptor tables
 		{
 			return false;
 		}
@@ -299,20 +344,48 @@ bool App::InitD3D()
 		}
 	}
 
-	// generate command list
+	// generate ring for transient descriptors
 	{
-		if (!m_CommandList.Init(
+		if (!m_DescriptorRing.Init(m_pPool[POOL_TYPE_RES], 128))
+		{
+			return false;
+		}
+	}
+
+	// generate upload buffers for transient constant buffers
+	{
+		if (!m_UploadAllocator.Init(m_pDevice.Get(), m_FrameCount, 1024 * 1024))
+		{
+			return false;
+		}
+	}
+
+	// generate command lists
+	{
+		if (!m_CommandListPool.Init(
 			m_pDevice.Get(),
 			D3D12_COMMAND_LIST_TYPE_DIRECT,
-			FrameCount))
+			m_FrameCount,
+			CommandListCount))
+		{
+			return false;
+		}
+	}
+
+	// generate bookkeeping of frames in flight
+	{
+		if (!m_FramePacer.Init(m_FrameCount))
 		{
 			return false;
 		}
+
+		m_UploadAllocator.Begin(m_FramePacer.GetSlot());
+		m_CommandListPool.Begin(m_FramePacer.GetSlot());
 	}
 
 	// generate render target view
 	{
-		for (auto i = 0u; i < FrameCount; ++i)
+		for (auto i = 0u; i < m_FrameCount; ++i)
 		{
 			if (!m_ColorTarget[i].InitFromBackBuffer(
 				m_pDevice.Get(),
@@ -348,6 +421,15 @@ bool App::InitD3D()
 		return false;
 	}
 
+	// generate fences of the copy and compute queues
+	if (!m_CopyFence.Init(m_pDevice.Get()) || !m_ComputeFence.Init(m_pDevice.Get()))
+	{
+		return false;
+	}
+
+	// resources released while recording the first frame wait for its value
+	m_ReleaseQueue.SetFenceValue(m_Fence.GetNextValue());
+
 	// viewport settings
 	{
 		m_Viewport.TopLeftX = 0.0f;
@@ -374,13 +456,22 @@ bool App::InitD3D()
 void App::TermD3D()
 {
 	// wait for completing of GPU processing
+	m_CopyFence.Sync(m_pCopyQueue.Get());
+	m_ComputeFence.Sync(m_pComputeQueue.Get());
 	m_Fence.Sync(m_pQueue.Get());
 
+	// release resources which were waiting for the GPU
+	m_ReleaseQueue.Term();
+
 	// abandon fence
 	m_Fence.Term();
+	m_CopyFence.Term();
+	m_ComputeFence.Term();
+	m_QueueSync.Reset();
+	m_FramePacer.Term();
 
 	// abandon render target view
-	for (auto i = 0u; i < FrameCount; ++i)
+	for (auto i = 0u; i < m_FrameCount; ++i)
 	{
 		m_ColorTarget[i].Term();
 	}
@@ -388,8 +479,14 @@ void App::TermD3D()
 	// abandon depth stencil view
 	m_DepthTarget.Term();
 
-	// abandon command list
-	m_CommandList.Term();
+	// abandon command lists
+	m_CommandListPool.Term();
+
+	// abandon transient descriptors
+	m_DescriptorRing.Term();
+
+	// abandon transient constant buffer memory
+	m_UploadAllocator.Term();
 
 	for (auto i = 0; i < POOL_COUNT; ++i)
 	{
@@ -404,6 +501,8 @@ void App::TermD3D()
 	m_pSwapChain.Reset();
 
 	// abandon command queue
+	m_pComputeQueue.Reset();
+	m_pCopyQueue.Reset();
 	m_pQueue.Reset();
 
 	// abandon device
@@ -435,11 +534,172 @@ void App::Present(uint32_t interval)
 	// show in screen
 	m_pSwapChain->Present(interval, 0);
 
-	//
-	m_Fence.Wait(m_pQueue.Get(), INFINITE);
+	// close this frame. what it used retires when the GPU reaches the signaled value
+	auto fenceValue = SignalQueue(QUEUE_TYPE_DIRECT);
+	m_DescriptorRing.FinishFrame(fenceValue);
+	m_ReleaseQueue.SetFenceValue(m_Fence.GetNextValue());
+
+	// wait only for the frame which last used the next slot, so the other frames stay in flight
+	auto waitValue = m_FramePacer.EndFrame(fenceValue);
+	m_Fence.WaitFor(waitValue, INFINITE);
+
+	// reclaim transient descriptors and released resources of completed frames
+	m_DescriptorRing.Retire(m_Fence.GetCompletedValue());
+	m_ReleaseQueue.Collect(m_Fence.GetCompletedValue());
+
+	// completed values make waits for them unnecessary
+	for (auto i = 0; i < QUEUE_TYPE_COUNT; ++i)
+	{
+		GetCompletedValue(QUEUE_TYPE(i));
+	}
 
 	// renew frame index
 	m_FrameIndex = m_pSwapChain->GetCurrentBackBufferIndex();
+
+	// the GPU has finished with this slot, so its upload memory and allocators can be reused
+	m_UploadAllocator.Begin(m_FramePacer.GetSlot());
+	m_CommandListPool.Begin(m_FramePacer.GetSlot());
+}
+
+// wait until the GPU has finished every frame and upload in flight
+void App::WaitForGpu()
+{
+	m_CopyFence.Sync(m_pCopyQueue.Get());
+	m_ComputeFence.Sync(m_pComputeQueue.Get());
+	m_Fence.Sync(m_pQueue.Get());
+
+	// Sync() signaled the value the queue was tagged with, so tag what is pushed from now on
+	// with the value the frame being recorded will signal
+	m_ReleaseQueue.SetFenceValue(m_Fence.GetNextValue());
+
+	// reclaim transient descriptors and released resources of completed frames
+	m_DescriptorRing.Retire(m_Fence.GetCompletedValue());
+	m_ReleaseQueue.Collect(m_Fence.GetCompletedValue());
+
+	for (auto i = 0; i < QUEUE_TYPE_COUNT; ++i)
+	{
+		GetCompletedValue(QUEUE_TYPE(i));
+	}
+}
+
+// get command queue
+ID3D12CommandQueue* App::GetQueue(QUEUE_TYPE type) const
+{
+	ID3D12CommandQueue* pQueue = nullptr;
+
+	switch (type)
+	{
+	case QUEUE_TYPE_COPY:
+	{
+		pQueue = m_pCopyQueue.Get();
+	}
+	break;
+
+	case QUEUE_TYPE_COMPUTE:
+	{
+		pQueue = m_pComputeQueue.Get();
+	}
+	break;
+
+	default:
+	{
+		pQueue = m_pQueue.Get();
+	}
+	break;
+	}
+
+	return pQueue;
+}
+
+// signal the fence of a queue
+UINT64 App::SignalQueue(QUEUE_TYPE type)
+{
+	auto value = GetFence(type)->Signal(GetQueue(type));
+	if (value != 0)
+	{
+		m_QueueSync.Signal(type, value);
+	}
+
+	return value;
+}
+
+// make a queue wait on the GPU for a value of another queue
+void App::WaitQueue(QUEUE_TYPE waiter, QUEUE_TYPE signaler, UINT64 value)
+{
+	// waits which an earlier wait or the CPU already covers are skipped
+	if (!m_QueueSync.NeedsWait(waiter, signaler, value))
+	{
+		return;
+	}
+
+	auto hr = GetQueue(waiter)->Wait(GetFence(signaler)->GetPtr(), value);
+	if (FAILED(hr))
+	{
+		ELOG("Error : ID3D12CommandQueue::Wait() Failed. retcode = 0x%x", hr);
+		return;
+	}
+
+	m_QueueSync.Wait(waiter, signaler, value);
+}
+
+// get the completed value of a queue
+UINT64 App::GetCompletedValue(QUEUE_TYPE type)
+{
+	auto value = GetFence(type)->GetCompletedValue();
+
+	// the CPU has seen it, so no queue has to wait for it anymore
+	m_QueueSync.Complete(type, value);
+
+	return value;
+}
+
+// get fence of a queue
+Fence* App::GetFence(QUEUE_TYPE type)
+{
+	Fence* pFence = nullptr;
+
+	switch (type)
+	{
+	case QUEUE_TYPE_COPY:
+	{
+		pFence = &m_CopyFence;
+	}
+	break;
+
+	case QUEUE_TYPE_COMPUTE:
+	{
+		pFence = &m_ComputeFence;
+	}
+	break;
+
+	default:
+	{
+		pFence = &m_Fence;
+	}
+	break;
+	}
+
+	return pFence;
+}
+
+// create constant buffer view valid for the current frame
+D3D12_GPU_DESCRIPTOR_HANDLE App::CreateTransientCBV(const UploadAllocation& allocation)
+{
+	if (!allocation.IsValid())
+	{
+		return D3D12_GPU_DESCRIPTOR_HANDLE();
+	}
+
+	auto handle = m_DescriptorRing.Alloc();
+	if (!handle.HasCPU())
+	{
+		return D3D12_GPU_DESCRIPTOR_HANDLE();
+	}
+
+	auto desc = allocation.GetViewDesc();
+	m_pDevice->CreateConstantBufferView(&desc, handle.HandleCPU);
+
+	return handle.HandleGPU;
 }
 
 // return if HDR display is supported
@@ -0,0 +1,174 @@
+#include "BuddyAllocator.h"
+
+namespace {
+	// level of the smallest power of two which is equal to or larger than value
+	uint32_t CeilLevel(uint32_t value)
+	{
+		auto level = 0u;
+		while ((1ull << level) < value)
+		{
+			++level;
+		}
+		return level;
+	}
+} // namespace
+
+//
+// BuddyAllocator class
+//
+
+// constructor
+BuddyAllocator::BuddyAllocator()
+	: m_Capacity(0)
+	, m_UsedCount(0)
+{
+}
+
+// destructor
+BuddyAllocator::~BuddyAllocator()
+{
+	Term();
+}
+
+// initialize
+bool BuddyAllocator::Init(uint32_t capacity)
+{
+	if (capacity == 0 || capacity == InvalidOffset)
+	{
+		return false;
+	}
+
+	Term();
+
+	m_Capacity = capacity;
+	m_FreeList.resize(CeilLevel(capacity) + 1);
+	m_AllocLevel.resize(capacity, uint8_t(NotAllocated));
+
+	// split capacity into aligned power of two blocks, largest first
+	uint32_t offset = 0;
+	for (auto level = uint32_t(m_FreeList.size()); level-- > 0;)
+	{
+		auto size = 1u << level;
+		if ((capacity - offset) >= size)
+		{
+			m_FreeList[level].insert(offset);
+			offset += size;
+		}
+	}
+
+	return true;
+}
+
+// end
+void BuddyAllocator::Term()
+{
+	m_FreeList.clear();
+	m_AllocLevel.clear();
+	m_Capacity = 0;
+	m_UsedCount = 0;
+}
+
+// allocate
+uint32_t BuddyAllocator::Alloc(uint32_t count)
+{
+	if (count == 0 || count > m_Capacity)
+	{
+		return InvalidOffset;
+	}
+
+	auto level = CeilLevel(count);
+
+	// find the smallest free block which fits
+	auto found = level;
+	while (found < m_FreeList.size() && m_FreeList[found].empty())
+	{
+		++found;
+	}
+
+	if (found >= m_FreeList.size())
+	{
+		return InvalidOffset;
+	}
+
+	auto offset = *m_FreeList[found].begin();
+	m_FreeList[found].erase(m_FreeList[found].begin());
+
+	// split down to the requested level, returning upper halves to the free list
+	while (found > level)
+	{
+		--found;
+		m_FreeList[found].insert(offset + (1u << found));
+	}
+
+	m_AllocLevel[offset] = uint8_t(level);
+	m_UsedCount += (1u << level);
+
+	return offset;
+}
+
+// free
+void BuddyAllocator::Free(uint32_t offset)
+{
+	if (offset >= m_Capacity || m_AllocLevel[offset] == NotAllocated)
+	{
+		return;
+	}
+
+	auto level = uint32_t(m_AllocLevel[offset]);
+	m_AllocLevel[offset] = NotAllocated;
+	m_UsedCount -= (1u << level);
+
+	// merge with free buddies as long as possible
+	while (level + 1 < m_FreeList.size())
+	{
+		auto buddy = offset ^ (1u << level);
+		auto itr = m_FreeList[level].find(buddy);
+		if (itr == m_FreeList[level].end())
+		{
+			break;
+		}
+
+		m_FreeList[level].erase(itr);
+		offset = (offset < buddy) ? offset : buddy;
+		++level;
+	}
+
+	m_FreeList[level].insert(offset);
+}
+
+// get size of allocated block
+uint32_t BuddyAllocator::GetBlockSize(uint32_t offset) const
+{
+	if (offset >= m_Capacity || m_AllocLevel[offset] == NotAllocated)
+	{
+		return 0;
+	}
+
+	return 1u << m_AllocLevel[offset];
+}
+
+// get total index count
+uint32_t BuddyAllocator::GetCapacity() const
+{
+	return m_Capacity;
+}
+
+// get allocated index count
+uint32_t BuddyAllocator::GetUsedCount() const
+{
+	return m_UsedCount;
+}
+
+// get size of the largest free block
+uint32_t BuddyAllocator::GetLargestFreeBlock() const
+{
+	for (auto level = m_FreeList.size(); level-- > 0;)
+	{
+		if (!m_FreeList[level].empty())
+		{
+			return 1u << level;
+		}
+	}
+
+	return 0;
+}
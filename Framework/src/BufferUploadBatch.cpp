@@ -0,0 +1,370 @@
+#include "BufferUploadBatch.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cstring>
+#include <cassert>
+
+namespace {
+
+	// alignment of placements in staging chunks
+	const uint64_t StagingAlignment = 16;
+
+} // namespace
+
+//
+// BufferUploadBatch class
+//
+
+// constructor
+BufferUploadBatch::BufferUploadBatch()
+	: m_pDevice(nullptr)
+	, m_pQueue(nullptr)
+	, m_Type(D3D12_COMMAND_LIST_TYPE_COPY)
+	, m_MaxChunkCount(0)
+	, m_FenceValue(0)
+	, m_IsOpen(false)
+{
+}
+
+// destructor
+BufferUploadBatch::~BufferUploadBatch()
+{
+	Term();
+}
+
+// initialize
+bool BufferUploadBatch::Init
+(
+	ID3D12Device* pDevice,
+	ID3D12CommandQueue* pQueue,
+	uint64_t chunkSize,
+	uint32_t maxChunkCount
+)
+{
+	if (pDevice == nullptr || pQueue == nullptr || maxChunkCount == 0)
+	{
+		return false;
+	}
+
+	m_pDevice = pDevice;
+	m_pQueue = pQueue;
+	m_Type = pQueue->GetDesc().Type;
+
+	if (!m_CommandList.Init(pDevice, m_Type, 1))
+	{
+		ELOG("Error : CommandList::Init() Failed.");
+		return false;
+	}
+
+	if (!m_Fence.Init(pDevice))
+	{
+		ELOG("Error : Fence::Init() Failed.");
+		return false;
+	}
+
+	if (!m_Planner.Init(chunkSize, StagingAlignment))
+	{
+		ELOG("Error : StagingPlanner::Init() Failed.");
+		return false;
+	}
+
+	m_MaxChunkCount = maxChunkCount;
+	m_FenceValue = 0;
+
+	return true;
+}
+
+// end
+void BufferUploadBatch::Term()
+{
+	// the GPU may still read the staging chunks
+	WaitChunks();
+
+	m_Targets.clear();
+	m_pChunkPtrs.clear();
+	m_pChunks.clear();
+	m_Planner.Term();
+	m_Fence.Term();
+	m_CommandList.Term();
+	m_pQueue.Reset();
+	m_pDevice.Reset();
+	m_MaxChunkCount = 0;
+	m_FenceValue = 0;
+	m_IsOpen = false;
+}
+
+// begin batch
+void BufferUploadBatch::Begin()
+{
+	assert(!m_IsOpen);
+
+	// the chunks of the previous batch are written again
+	WaitChunks();
+
+	m_Planner.Reset();
+	m_Targets.clear();
+	m_IsOpen = true;
+}
+
+// upload data
+bool BufferUploadBatch::Upload
+(
+	ID3D12Resource* pDst,
+	UINT64 dstOffset,
+	const void* pData,
+	UINT64 size,
+	D3D12_RESOURCE_STATES stateAfter
+)
+{
+	if (!m_IsOpen || pDst == nullptr || pData == nullptr || size == 0)
+	{
+		return false;
+	}
+
+	// stage at most one chunk at a time, so the chunks can be flushed in between
+	auto pSrc = static_cast<const uint8_t*>(pData);
+	while (size > 0)
+	{
+		auto pieceSize = std::min(size, m_Planner.GetChunkSize());
+
+		auto isNewTarget = m_Targets.empty() || m_Targets.back().pResource.Get() != pDst;
+		auto index = uint32_t(isNewTarget ? m_Targets.size() : m_Targets.size() - 1);
+
+		// submit what has been staged when the piece would exceed the cap
+		if (m_Planner.GetRegionCount() > 0
+			&& m_Planner.GetChunkCountAfter(index, dstOffset, pieceSize) > m_MaxChunkCount)
+		{
+			if (Submit() == 0 || !WaitChunks())
+			{
+				return false;
+			}
+
+			isNewTarget = true;
+			index = 0;
+		}
+
+		// register destination
+		if (isNewTarget)
+		{
+			Target target;
+			target.pResource = pDst;
+			target.StateAfter = stateAfter;
+			m_Targets.push_back(target);
+		}
+
+		size_t first = 0;
+		if (!m_Planner.Add(index, dstOffset, pieceSize, &first))
+		{
+			return false;
+		}
+
+		if (!AddChunks())
+		{
+			return false;
+		}
+
+		// write data to the staging chunks
+		for (auto i = first; i < m_Planner.GetRegionCount(); ++i)
+		{
+			const auto& region = m_Planner.GetRegion(i);
+			memcpy(
+				m_pChunkPtrs[region.Chunk] + region.SrcOffset,
+				pSrc + (region.DstOffset - dstOffset),
+				size_t(region.Size));
+		}
+
+		pSrc += pieceSize;
+		dstOffset += pieceSize;
+		size -= pieceSize;
+	}
+
+	return true;
+}
+
+// submit batch
+UINT64 BufferUploadBatch::End()
+{
+	if (!m_IsOpen)
+	{
+		return 0;
+	}
+
+	m_IsOpen = false;
+
+	return Submit();
+}
+
+// get device
+ID3D12Device* BufferUploadBatch::GetDevice() const
+{
+	return m_pDevice.Get();
+}
+
+// record and execute the staged copies, then signal the fence
+UINT64 BufferUploadBatch::Submit()
+{
+	if (m_Planner.GetRegionCount() == 0)
+	{
+		// nothing to copy, the value still orders the caller after earlier submissions
+		auto value = m_Fence.Signal(m_pQueue.Get());
+		if (value != 0)
+		{
+			m_FenceValue = value;
+		}
+		return value;
+	}
+
+	auto pCmd = m_CommandList.Reset();
+	if (pCmd == nullptr)
+	{
+		return 0;
+	}
+
+	// record copies
+	std::vector<StagingPlanner::Region> regions;
+	m_Planner.Coalesce(regions);
+
+	for (size_t i = 0; i < regions.size(); ++i)
+	{
+		const auto& region = regions[i];
+		pCmd->CopyBufferRegion(
+			m_Targets[region.Target].pResource.Get(),
+			region.DstOffset,
+			m_pChunks[region.Chunk].Get(),
+			region.SrcOffset,
+			region.Size);
+	}
+
+	// transition every destination with a single call. buffers decay to COMMON when the
+	// submission completes, so a buffer copied again after a flush is promoted again
+	if (m_Type == D3D12_COMMAND_LIST_TYPE_DIRECT)
+	{
+		std::vector<D3D12_RESOURCE_BARRIER> barriers;
+		barriers.reserve(m_Targets.size());
+
+		for (size_t i = 0; i < m_Targets.size(); ++i)
+		{
+			// the same buffer may be registered more than once
+			auto found = false;
+			for (size_t j = 0; j < barriers.size(); ++j)
+			{
+				if (barriers[j].Transition.pResource == m_Targets[i].pResource.Get())
+				{
+					found = true;
+					break;
+				}
+			}
+
+			if (found)
+			{
+				continue;
+			}
+
+			D3D12_RESOURCE_BARRIER barrier = {};
+			barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+			barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+			barrier.Transition.pResource = m_Targets[i].pResource.Get();
+			barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_DEST;
+			barrier.Transition.StateAfter = m_Targets[i].StateAfter;
+			barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+			barriers.push_back(barrier);
+		}
+
+		pCmd->ResourceBarrier(UINT(barriers.size()), barriers.data());
+	}
+
+	pCmd->Close();
+
+	ID3D12CommandList* pLists[] = { pCmd };
+	m_pQueue->ExecuteCommandLists(1, pLists);
+
+	auto value = m_Fence.Signal(m_pQueue.Get());
+	if (value == 0)
+	{
+		ELOG("Error : Fence::Signal() Failed.");
+		return 0;
+	}
+
+	DLOG("Info : BufferUploadBatch submitted %zu regions (%zu copies) with %u staging chunks.",
+		m_Planner.GetRegionCount(), regions.size(), m_Planner.GetChunkCount());
+
+	m_FenceValue = value;
+	m_Targets.clear();
+	m_Planner.Reset();
+
+	return value;
+}
+
+// wait until the GPU has finished reading the staging chunks
+bool BufferUploadBatch::WaitChunks()
+{
+	if (m_FenceValue == 0)
+	{
+		return true;
+	}
+
+	if (!m_Fence.WaitFor(m_FenceValue, INFINITE))
+	{
+		ELOG("Error : Fence::WaitFor() Failed.");
+		return false;
+	}
+
+	return true;
+}
+
+// create staging chunks which the planner has opened
+bool BufferUploadBatch::AddChunks()
+{
+	// heap property
+	D3D12_HEAP_PROPERTIES prop = {};
+	prop.Type = D3D12_HEAP_TYPE_UPLOAD;
+	prop.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+	prop.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+	prop.CreationNodeMask = 1;
+	prop.VisibleNodeMask = 1;
+
+	// settings of resource
+	D3D12_RESOURCE_DESC desc = {};
+	desc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+	desc.Alignment = 0;
+	desc.Width = m_Planner.GetChunkSize();
+	desc.Height = 1;
+	desc.DepthOrArraySize = 1;
+	desc.MipLevels = 1;
+	desc.Format = DXGI_FORMAT_UNKNOWN;
+	desc.SampleDesc.Count = 1;
+	desc.SampleDesc.Quality = 0;
+	desc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+	desc.Flags = D3D12_RESOURCE_FLAG_NONE;
+
+	// staging chunks are kept mapped and reused by later batches
+	while (m_pChunks.size() < m_Planner.GetChunkCount())
+	{
+		ComPtr<ID3D12Resource> pChunk;
+		auto hr = m_pDevice->CreateCommittedResource(
+			&prop,
+			D3D12_HEAP_FLAG_NONE,
+			&desc,
+			D3D12_RESOURCE_STATE_GENERIC_READ,
+			nullptr,
+			IID_PPV_ARGS(pChunk.GetAddressOf()));
+		if (FAILED(hr))
+		{
+			ELOG("Error : ID3D12Device::CreateCommittedResource() Failed. retcode = 0x%x", hr);
+			return false;
+		}
+
+		void* ptr = nullptr;
+		hr = pChunk->Map(0, nullptr, &ptr);
+		if (FAILED(hr))
+		{
+			ELOG("Error : ID3D12Resource::Map() Failed. retcode = 0x%x", hr);
+			return false;
+		}
+
+		m_pChunks.push_back(pChunk);
+		m_pChunkPtrs.push_back(static_cast<uint8_t*>(ptr));
+	}
+
+	return true;
+}
@@ -58,6 +58,25 @@ namespace
 		return result;
 	}
 
+	// get settings of a render target texture
+	D3D12_RESOURCE_DESC GetTargetDesc(uint32_t width, uint32_t height, DXGI_FORMAT format)
+	{
+		D3D12_RESOURCE_DESC desc = {};
+		desc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+		desc.Alignment = 0;
+		desc.Width = UINT64(width);
+		desc.Height = height;
+		desc.DepthOrArraySize = 1;
+		desc.MipLevels = 1;
+		desc.Format = format;
+		desc.SampleDesc.Count = 1;
+		desc.SampleDesc.Quality = 0;
+		desc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+		desc.Flags = D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET;
+
+		return desc;
+	}
+
 } // namespace
 
 //
@@ -97,6 +116,34 @@ bool ColorTarget::Init
 	DXGI_FORMAT format,
 	float clearColor[4]
 )
+{
+	return Init(
+		pDevice,
+		pPoolRTV,
+		pPoolSRV,
+		width,
+		height,
+		format,
+		clearColor,
+		nullptr,
+		0,
+		D3D12_RESOURCE_STATE_RENDER_TARGET);
+}
+
+// initialize in a heap
+bool ColorTarget::Init
+(
+	ID3D12Device* pDevice,
+	DescriptorPool* pPoolRTV,
+	DescriptorPool* pPoolSRV,
+	uint32_t width,
+	uint32_t height,
+	DXGI_FORMAT format,
+	float clearColor[4],
+	ID3D12Heap* pHeap,
+	UINT64 heapOffset,
+	D3D12_RESOURCE_STATES state
+)
 {
 	if (pDevice == nullptr || pPoolRTV == nullptr || width == 0 || height == 0)
 	{
@@ -134,18 +181,7 @@ bool ColorTarget::Init
 	prop.CreationNodeMask = 1;
 	prop.VisibleNodeMask = 1;
 
-	D3D12_RESOURCE_DESC desc = {};
-	desc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
-	desc.Alignment = 0;
-	desc.Width = UINT64(width);
-	desc.Height = height;
-	desc.DepthOrArraySize = 1;
-	desc.MipLevels = 1;
-	desc.Format = format;
-	desc.SampleDesc.Count = 1;
-	desc.SampleDesc.Quality = 0;
-	desc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
-	desc.Flags = D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET;
+	auto desc = GetTargetDesc(width, height, format);
 
 	m_ClearColor[0] = clearColor[0];
 	m_ClearColor[1] = clearColor[1];
@@ -159,13 +195,28 @@ bool ColorTarget::Init
 	clearValue.Color[2] = clearColor[2];
 	clearValue.Color[3] = clearColor[3];
 
-	auto hr = pDevice->CreateCommittedResource(
-		&prop,
-		D3D12_HEAP_FLAG_NONE,
-		&desc,
-		D3D12_RESOURCE_STATE_RENDER_TARGET,
-		&clearValue,
-		IID_PPV_ARGS(m_pTarget.GetAddressOf()));
+	HRESULT hr;
+	if (pHeap != nullptr)
+	{
+		hr = pDevice->CreatePlacedResource(
+			pHeap,
+			heapOffset,
+			&desc,
+			state,
+			&clearValue,
+			IID_PPV_ARGS(m_pTarget.GetAddressOf()));
+	}
+	else
+	{
+		hr = pDevice->CreateCommittedResource(
+			&prop,
+			D3D12_HEAP_FLAG_NONE,
+			&desc,
+			state,
+			&clearValue,
+			IID_PPV_ARGS(m_pTarget.GetAddressOf()));
+	}
+
 	if (FAILED(hr))
 	{
 		return false;
@@ -194,6 +245,19 @@ bool ColorTarget::Init
 	return true;
 }
 
+// get allocation size and alignment of a target
+D3D12_RESOURCE_ALLOCATION_INFO ColorTarget::GetAllocationInfo
+(
+	ID3D12Device* pDevice,
+	uint32_t width,
+	uint32_t height,
+	DXGI_FORMAT format
+)
+{
+	auto desc = GetTargetDesc(width, height, format);
+	return pDevice->GetResourceAllocationInfo(0, 1, &desc);
+}
+
 // initialize from back buffer
 bool ColorTarget::InitFromBackBuffer
 (
@@ -0,0 +1,169 @@
+#include "CommandListPool.h"
+#include "Logger.h"
+#include <algorithm>
+
+// get count of command lists to record draws with
+uint32_t GetRecordingListCount(uint32_t drawCount, uint32_t maxListCount, uint32_t minDrawsPerList)
+{
+	if (drawCount == 0 || maxListCount == 0)
+	{
+		return 0;
+	}
+
+	auto count = drawCount / std::max(minDrawsPerList, 1u);
+	return std::min(std::max(count, 1u), std::min(maxListCount, drawCount));
+}
+
+// get the first draw which a command list records
+uint32_t GetRecordingBegin(uint32_t drawCount, uint32_t listCount, uint32_t listIndex)
+{
+	if (listCount == 0)
+	{
+		return 0;
+	}
+
+	// spread the remainder, so list sizes differ by one at most
+	return uint32_t(uint64_t(drawCount) * std::min(listIndex, listCount) / listCount);
+}
+
+//
+// CommandListPool class
+//
+
+// constructor
+CommandListPool::CommandListPool()
+	: m_FrameCount(0)
+	, m_ListCount(0)
+	, m_FrameIndex(0)
+	, m_Acquired(0)
+{
+}
+
+// destructor
+CommandListPool::~CommandListPool()
+{
+	Term();
+}
+
+// initialize
+bool CommandListPool::Init
+(
+	ID3D12Device* pDevice,
+	D3D12_COMMAND_LIST_TYPE type,
+	uint32_t frameCount,
+	uint32_t listCount
+)
+{
+	if (pDevice == nullptr || frameCount == 0 || listCount == 0)
+	{
+		return false;
+	}
+
+	Term();
+
+	m_pAllocators.resize(frameCount * listCount);
+	for (size_t i = 0; i < m_pAllocators.size(); ++i)
+	{
+		auto hr = pDevice->CreateCommandAllocator(
+			type,
+			IID_PPV_ARGS(m_pAllocators[i].GetAddressOf()));
+		if (FAILED(hr))
+		{
+			ELOG("Error : ID3D12Device::CreateCommandAllocator() Failed. retcode = 0x%x", hr);
+			Term();
+			return false;
+		}
+	}
+
+	m_pCmdLists.resize(listCount);
+	for (size_t i = 0; i < m_pCmdLists.size(); ++i)
+	{
+		auto hr = pDevice->CreateCommandList(
+			1,
+			type,
+			m_pAllocators[i].Get(),
+			nullptr,
+			IID_PPV_ARGS(m_pCmdLists[i].GetAddressOf()));
+		if (FAILED(hr))
+		{
+			ELOG("Error : ID3D12Device::CreateCommandList() Failed. retcode = 0x%x", hr);
+			Term();
+			return false;
+		}
+
+		m_pCmdLists[i]->Close();
+	}
+
+	m_FrameCount = frameCount;
+	m_ListCount = listCount;
+	m_FrameIndex = 0;
+	m_Acquired = 0;
+
+	return true;
+}
+
+// end
+void CommandListPool::Term()
+{
+	m_pCmdLists.clear();
+	m_pCmdLists.shrink_to_fit();
+
+	m_pAllocators.clear();
+	m_pAllocators.shrink_to_fit();
+
+	m_FrameCount = 0;
+	m_ListCount = 0;
+	m_FrameIndex = 0;
+	m_Acquired = 0;
+}
+
+// begin frame
+void CommandListPool::Begin(uint32_t frameIndex)
+{
+	if (m_FrameCount == 0)
+	{
+		return;
+	}
+
+	m_FrameIndex = frameIndex % m_FrameCount;
+	m_Acquired.store(0, std::memory_order_relaxed);
+}
+
+// get a reset commandlist
+ID3D12GraphicsCommandList* CommandListPool::Acquire()
+{
+	auto index = m_Acquired.fetch_add(1, std::memory_order_relaxed);
+	if (index >= m_ListCount)
+	{
+		return nullptr;
+	}
+
+	// the list and the allocator belong to this caller only, so no lock is needed
+	auto pAllocator = m_pAllocators[m_FrameIndex * m_ListCount + index].Get();
+	auto hr = pAllocator->Reset();
+	if (FAILED(hr))
+	{
+		return nullptr;
+	}
+
+	auto pCmdList = m_pCmdLists[index].Get();
+	hr = pCmdList->Reset(pAllocator, nullptr);
+	if (FAILED(hr))
+	{
+		return nullptr;
+	}
+
+	return pCmdList;
+}
+
+// get maximum list count of a frame
+uint32_t CommandListPool::GetListCount() const
+{
+	return m_ListCount;
+}
+
+// get count of lists acquired in the current frame
+uint32_t CommandListPool::GetAcquiredCount() const
+{
+	return std::min(m_Acquired.load(std::memory_order_relaxed), m_ListCount);
+}
@@ -0,0 +1,234 @@
+#include "CompileScheduler.h"
+
+//
+// CompileScheduler class
+//
+
+// constructor
+CompileScheduler::CompileScheduler()
+	: m_pCompiler(nullptr)
+	, m_pWorkerPool(nullptr)
+	, m_MaxInFlight(0)
+	, m_InFlight(0)
+	, m_Tasks(0)
+{
+}
+
+// destructor
+CompileScheduler::~CompileScheduler()
+{
+	Term();
+}
+
+// initialize
+bool CompileScheduler::Init(PipelineCompiler* pCompiler, ThreadPool* pWorkerPool, uint32_t maxInFlight)
+{
+	if (pCompiler == nullptr || pWorkerPool == nullptr || maxInFlight == 0)
+	{
+		return false;
+	}
+
+	Term();
+
+	m_pCompiler = pCompiler;
+	m_pWorkerPool = pWorkerPool;
+	m_MaxInFlight = maxInFlight;
+
+	return true;
+}
+
+// end
+void CompileScheduler::Term()
+{
+	// tasks refer to this object, so they must have finished
+	while (m_Tasks.load(std::memory_order_acquire) > 0)
+	{
+		std::this_thread::yield();
+	}
+
+	m_Entries.clear();
+	m_Ids.clear();
+	m_Queue.clear();
+	m_Canceled.clear();
+	m_Finished.clear();
+	m_InFlight = 0;
+	m_pCompiler = nullptr;
+	m_pWorkerPool = nullptr;
+	m_MaxInFlight = 0;
+}
+
+// queue a request
+uint32_t CompileScheduler::Request(uint64_t key, int priority)
+{
+	if (m_pCompiler == nullptr)
+	{
+		return InvalidId;
+	}
+
+	auto itr = m_Ids.find(key);
+	if (itr != m_Ids.end())
+	{
+		return itr->second;
+	}
+
+	Entry entry;
+	entry.Key = key;
+	entry.State = COMPILE_STATE_QUEUED;
+	entry.IsCanceled = false;
+
+	uint32_t id;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		id = uint32_t(m_Entries.size());
+		m_Entries.push_back(entry);
+	}
+
+	m_Ids[key] = id;
+	m_Queue.insert(std::make_pair(priority, id));
+
+	return id;
+}
+
+// cancel a request
+bool CompileScheduler::Cancel(uint32_t id)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	if (id >= m_Entries.size())
+	{
+		return false;
+	}
+
+	auto& entry = m_Entries[id];
+	if (entry.State == COMPILE_STATE_QUEUED)
+	{
+		for (auto itr = m_Queue.begin(); itr != m_Queue.end(); ++itr)
+		{
+			if (itr->second == id)
+			{
+				m_Queue.erase(itr);
+				break;
+			}
+		}
+
+		m_Canceled.push_back(id);
+	}
+	else if (entry.State != COMPILE_STATE_COMPILING)
+	{
+		return false;
+	}
+
+	// a compiling request is reported when its worker returns. a later request of the key starts over
+	entry.State = COMPILE_STATE_CANCELED;
+	entry.IsCanceled = true;
+	m_Ids.erase(entry.Key);
+	return true;
+}
+
+// start queued requests and report finished ones
+void CompileScheduler::Update(std::vector<Result>& results)
+{
+	results.clear();
+
+	if (m_pCompiler == nullptr)
+	{
+		return;
+	}
+
+	// requests canceled before they started
+	for (size_t i = 0; i < m_Canceled.size(); ++i)
+	{
+		m_pCompiler->Finish(m_Canceled[i], COMPILE_STATE_CANCELED);
+		results.push_back({ m_Canceled[i], COMPILE_STATE_CANCELED });
+	}
+	m_Canceled.clear();
+
+	// collect requests which left the pool threads
+	std::vector<std::pair<uint32_t, bool>> finished;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		finished.swap(m_Finished);
+	}
+
+	for (size_t i = 0; i < finished.size(); ++i)
+	{
+		auto id = finished[i].first;
+		m_InFlight--;
+
+		COMPILE_STATE state;
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			auto& entry = m_Entries[id];
+			if (entry.IsCanceled)
+			{
+				state = COMPILE_STATE_CANCELED;
+			}
+			else if (finished[i].second)
+			{
+				state = COMPILE_STATE_READY;
+			}
+			else
+			{
+				// a later request of the key tries again
+				state = COMPILE_STATE_FAILED;
+				m_Ids.erase(entry.Key);
+			}
+			entry.State = state;
+		}
+
+		m_pCompiler->Finish(id, state);
+		results.push_back({ id, state });
+	}
+
+	// start queued requests
+	while (m_InFlight < m_MaxInFlight && !m_Queue.empty())
+	{
+		auto id = m_Queue.begin()->second;
+		m_Queue.erase(m_Queue.begin());
+
+		m_InFlight++;
+		Dispatch(id);
+	}
+}
+
+// get state of a request
+COMPILE_STATE CompileScheduler::GetState(uint32_t id) const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	if (id >= m_Entries.size())
+	{
+		return COMPILE_STATE_FAILED;
+	}
+
+	return m_Entries[id].State;
+}
+
+// check whether every request has finished
+bool CompileScheduler::IsIdle() const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return m_Queue.empty() && m_InFlight == 0 && m_Canceled.empty();
+}
+
+// compile on a worker
+void CompileScheduler::Dispatch(uint32_t id)
+{
+	SetState(id, COMPILE_STATE_COMPILING);
+
+	m_Tasks.fetch_add(1, std::memory_order_acq_rel);
+	m_pWorkerPool->Submit([this, id]()
+	{
+		auto result = m_pCompiler->Compile(id);
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Finished.push_back(std::make_pair(id, result));
+		}
+		m_Tasks.fetch_sub(1, std::memory_order_acq_rel);
+	});
+}
+
+// set state of a request
+void CompileScheduler::SetState(uint32_t id, COMPILE_STATE state)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Entries[id].State = state;
+}
@@ -84,7 +84,12 @@ bool ConstantBuffer::Init(
 
 	m_Desc.BufferLocation = m_pCB->GetGPUVirtualAddress();
 	m_Desc.SizeInBytes = UINT(sizeAligned);
-	m_pHandle = pPool->AllocHandle();
+
+	m_pHandle = m_pPool->AllocHandle();
+	if (m_pHandle == nullptr)
+	{
+		return false;
+	}
 
 	pDevice->CreateConstantBufferView(&m_Desc, m_pHandle->HandleCPU);
 
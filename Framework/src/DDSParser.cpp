@@ -0,0 +1,654 @@
+#include "DDSParser.h"
+#include <cstring>
+
+namespace {
+
+	// make a four character code
+	constexpr uint32_t FourCC(char a, char b, char c, char d)
+	{
+		return uint32_t(uint8_t(a)) | (uint32_t(uint8_t(b)) << 8) | (uint32_t(uint8_t(c)) << 16) | (uint32_t(uint8_t(d)) << 24);
+	}
+
+	// Constant values.
+	const uint32_t DDSMagic = FourCC('D', 'D', 'S', ' ');
+	const uint32_t DDSD_MIPMAPCOUNT = 0x00020000;
+	const uint32_t DDSD_DEPTH = 0x00800000;
+	const uint32_t DDPF_ALPHA = 0x00000002;
+	const uint32_t DDPF_FOURCC = 0x00000004;
+	const uint32_t DDPF_RGB = 0x00000040;
+	const uint32_t DDPF_LUMINANCE = 0x00020000;
+	const uint32_t DDSCAPS2_CUBEMAP = 0x00000200;
+	const uint32_t DDSCAPS2_CUBEMAP_ALLFACES = 0x0000fc00;
+	const uint32_t DDS_MISC_TEXTURECUBE = 0x4;
+	const uint32_t MaxMipCount = 15; // D3D12_REQ_MIP_LEVELS
+	const uint32_t MaxDimension = 16384; // D3D12_REQ_TEXTURE2D_U_OR_V_DIMENSION
+	const uint32_t MaxDimension3D = 2048; // D3D12_REQ_TEXTURE3D_U_V_OR_W_DIMENSION
+	const uint32_t MaxArraySize = 2048; // D3D12_REQ_TEXTURE2D_ARRAY_AXIS_DIMENSION
+
+	//
+	// DDSPixelFormat structure
+	//
+	struct DDSPixelFormat
+	{
+		uint32_t Size;
+		uint32_t Flags;
+		uint32_t FourCC;
+		uint32_t RGBBitCount;
+		uint32_t RBitMask;
+		uint32_t GBitMask;
+		uint32_t BBitMask;
+		uint32_t ABitMask;
+	};
+
+	//
+	// DDSHeader structure
+	//
+	struct DDSHeader
+	{
+		uint32_t Size;
+		uint32_t Flags;
+		uint32_t Height;
+		uint32_t Width;
+		uint32_t PitchOrLinearSize;
+		uint32_t Depth;
+		uint32_t MipMapCount;
+		uint32_t Reserved1[11];
+		DDSPixelFormat PixelFormat;
+		uint32_t Caps;
+		uint32_t Caps2;
+		uint32_t Caps3;
+		uint32_t Caps4;
+		uint32_t Reserved2;
+	};
+
+	//
+	// DDSHeaderDX10 structure
+	//
+	struct DDSHeaderDX10
+	{
+		uint32_t Format;
+		uint32_t ResourceDimension;
+		uint32_t MiscFlag;
+		uint32_t ArraySize;
+		uint32_t MiscFlags2;
+	};
+
+	static_assert(sizeof(DDSHeader) == 124, "DDS header must be 124 bytes");
+	static_assert(sizeof(DDSHeaderDX10) == 20, "DX10 header must be 20 bytes");
+
+	//
+	// MaskFormat structure
+	//
+	struct MaskFormat
+	{
+		uint32_t Flags; //!< DDPF_RGB, DDPF_LUMINANCE or DDPF_ALPHA
+		uint32_t BitCount; //!< bits per pixel
+		uint32_t Mask[4]; //!< R, G, B, A bit masks
+		DXGI_FORMAT Format; //!< matching format
+	};
+
+	//
+	// FourCCFormat structure
+	//
+	struct FourCCFormat
+	{
+		uint32_t FourCC; //!< four character code (or D3DFORMAT value)
+		DXGI_FORMAT Format; //!< matching format
+	};
+
+	// legacy formats described by bit masks
+	const MaskFormat MaskFormats[] = {
+		{ DDPF_RGB, 32, { 0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000 }, DXGI_FORMAT_R8G8B8A8_UNORM },
+		{ DDPF_RGB, 32, { 0x00ff0000, 0x0000ff00, 0x000000ff, 0xff000000 }, DXGI_FORMAT_B8G8R8A8_UNORM },
+		{ DDPF_RGB, 32, { 0x00ff0000, 0x0000ff00, 0x000000ff, 0x00000000 }, DXGI_FORMAT_B8G8R8X8_UNORM },
+		{ DDPF_RGB, 32, { 0x000003ff, 0x000ffc00, 0x3ff00000, 0xc0000000 }, DXGI_FORMAT_R10G10B10A2_UNORM },
+		{ DDPF_RGB, 32, { 0x0000ffff, 0xffff0000, 0x00000000, 0x00000000 }, DXGI_FORMAT_R16G16_UNORM },
+		{ DDPF_RGB, 32, { 0xffffffff, 0x00000000, 0x00000000, 0x00000000 }, DXGI_FORMAT_R32_FLOAT },
+		{ DDPF_RGB, 16, { 0xf800, 0x07e0, 0x001f, 0x0000 }, DXGI_FORMAT_B5G6R5_UNORM },
+		{ DDPF_RGB, 16, { 0x7c00, 0x03e0, 0x001f, 0x8000 }, DXGI_FORMAT_B5G5R5A1_UNORM },
+		{ DDPF_RGB, 16, { 0x0f00, 0x00f0, 0x000f, 0xf000 }, DXGI_FORMAT_B4G4R4A4_UNORM },
+		{ DDPF_LUMINANCE, 8, { 0xff, 0, 0, 0 }, DXGI_FORMAT_R8_UNORM },
+		{ DDPF_LUMINANCE, 16, { 0xffff, 0, 0, 0 }, DXGI_FORMAT_R16_UNORM },
+		{ DDPF_LUMINANCE, 16, { 0x00ff, 0, 0, 0xff00 }, DXGI_FORMAT_R8G8_UNORM },
+		{ DDPF_ALPHA, 8, { 0, 0, 0, 0xff }, DXGI_FORMAT_A8_UNORM },
+	};
+
+	// legacy formats described by four character codes
+	const FourCCFormat FourCCFormats[] = {
+		{ FourCC('D', 'X', 'T', '1'), DXGI_FORMAT_BC1_UNORM },
+		{ FourCC('D', 'X', 'T', '2'), DXGI_FORMAT_BC2_UNORM },
+		{ FourCC('D', 'X', 'T', '3'), DXGI_FORMAT_BC2_UNORM },
+		{ FourCC('D', 'X', 'T', '4'), DXGI_FORMAT_BC3_UNORM },
+		{ FourCC('D', 'X', 'T', '5'), DXGI_FORMAT_BC3_UNORM },
+		{ FourCC('A', 'T', 'I', '1'), DXGI_FORMAT_BC4_UNORM },
+		{ FourCC('B', 'C', '4', 'U'), DXGI_FORMAT_BC4_UNORM },
+		{ FourCC('B', 'C', '4', 'S'), DXGI_FORMAT_BC4_SNORM },
+		{ FourCC('A', 'T', 'I', '2'), DXGI_FORMAT_BC5_UNORM },
+		{ FourCC('B', 'C', '5', 'U'), DXGI_FORMAT_BC5_UNORM },
+		{ FourCC('B', 'C', '5', 'S'), DXGI_FORMAT_BC5_SNORM },
+		{ 36, DXGI_FORMAT_R16G16B16A16_UNORM },
+		{ 110, DXGI_FORMAT_R16G16B16A16_SNORM },
+		{ 111, DXGI_FORMAT_R16_FLOAT },
+		{ 112, DXGI_FORMAT_R16G16_FLOAT },
+		{ 113, DXGI_FORMAT_R16G16B16A16_FLOAT },
+		{ 114, DXGI_FORMAT_R32_FLOAT },
+		{ 115, DXGI_FORMAT_R32G32_FLOAT },
+		{ 116, DXGI_FORMAT_R32G32B32A32_FLOAT },
+	};
+
+	// get format of a legacy pixel format
+	DXGI_FORMAT GetLegacyFormat(const DDSPixelFormat& pf)
+	{
+		if (pf.Flags & DDPF_FOURCC)
+		{
+			for (const auto& entry : FourCCFormats)
+			{
+				if (entry.FourCC == pf.FourCC)
+				{
+					return entry.Format;
+				}
+			}
+
+			return DXGI_FORMAT_UNKNOWN;
+		}
+
+		for (const auto& entry : MaskFormats)
+		{
+			if ((pf.Flags & entry.Flags) != 0
+				&& pf.RGBBitCount == entry.BitCount
+				&& pf.RBitMask == entry.Mask[0]
+				&& pf.GBitMask == entry.Mask[1]
+				&& pf.BBitMask == entry.Mask[2]
+				&& pf.ABitMask == entry.Mask[3])
+			{
+				return entry.Format;
+			}
+		}
+
+		return DXGI_FORMAT_UNKNOWN;
+	}
+
+	// get size of a mip level along one axis
+	uint32_t GetMipSize(uint32_t size, uint32_t mip)
+	{
+		return ((size >> mip) > 0) ? (size >> mip) : 1;
+	}
+
+	// align a value to a power of 2
+	UINT64 AlignUp(UINT64 value, UINT64 alignment)
+	{
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+
+} // namespace
+
+// parse a DDS file in memory
+bool ParseDDS(const void* pData, size_t size, DDSInfo& info)
+{
+	info = DDSInfo();
+
+	auto pBytes = static_cast<const uint8_t*>(pData);
+	if (pBytes == nullptr || size < sizeof(uint32_t) + sizeof(DDSHeader))
+	{
+		return false;
+	}
+
+	uint32_t magic = 0;
+	memcpy(&magic, pBytes, sizeof(magic));
+	if (magic != DDSMagic)
+	{
+		return false;
+	}
+
+	DDSHeader header;
+	memcpy(&header, pBytes + sizeof(uint32_t), sizeof(header));
+	if (header.Size != sizeof(DDSHeader) || header.PixelFormat.Size != sizeof(DDSPixelFormat))
+	{
+		return false;
+	}
+
+	auto offset = sizeof(uint32_t) + sizeof(DDSHeader);
+	auto dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+	auto format = DXGI_FORMAT_UNKNOWN;
+	auto width = header.Width;
+	auto height = header.Height;
+	auto depth = 1u;
+	auto arraySize = 1u;
+	auto isCube = false;
+
+	if ((header.PixelFormat.Flags & DDPF_FOURCC) && header.PixelFormat.FourCC == FourCC('D', 'X', '1', '0'))
+	{
+		if (size < offset + sizeof(DDSHeaderDX10))
+		{
+			return false;
+		}
+
+		DDSHeaderDX10 ext;
+		memcpy(&ext, pBytes + offset, sizeof(ext));
+		offset += sizeof(DDSHeaderDX10);
+
+		format = DXGI_FORMAT(ext.Format);
+		arraySize = ext.ArraySize;
+		if (arraySize == 0)
+		{
+			return false;
+		}
+
+		switch (ext.ResourceDimension)
+		{
+		case D3D12_RESOURCE_DIMENSION_TEXTURE1D:
+			{
+				if (height > 1)
+				{
+					return false;
+				}
+
+				dimension = D3D12_RESOURCE_DIMENSION_TEXTURE1D;
+				height = 1;
+			}
+			break;
+
+		case D3D12_RESOURCE_DIMENSION_TEXTURE2D:
+			{
+				if (ext.MiscFlag & DDS_MISC_TEXTURECUBE)
+				{
+					if (arraySize > MaxArraySize / 6)
+					{
+						return false;
+					}
+
+					arraySize *= 6;
+					isCube = true;
+				}
+			}
+			break;
+
+		case D3D12_RESOURCE_DIMENSION_TEXTURE3D:
+			{
+				if (!(header.Flags & DDSD_DEPTH) || arraySize > 1)
+				{
+					return false;
+				}
+
+				dimension = D3D12_RESOURCE_DIMENSION_TEXTURE3D;
+				depth = header.Depth;
+			}
+			break;
+
+		default:
+			{
+				return false;
+			}
+		}
+	}
+	else
+	{
+		format = GetLegacyFormat(header.PixelFormat);
+
+		if (header.Flags & DDSD_DEPTH)
+		{
+			dimension = D3D12_RESOURCE_DIMENSION_TEXTURE3D;
+			depth = header.Depth;
+		}
+		else if (header.Caps2 & DDSCAPS2_CUBEMAP)
+		{
+			// partial cube maps can not be created in D3D12
+			if ((header.Caps2 & DDSCAPS2_CUBEMAP_ALLFACES) != DDSCAPS2_CUBEMAP_ALLFACES)
+			{
+				return false;
+			}
+
+			arraySize = 6;
+			isCube = true;
+		}
+	}
+
+	if (GetBitsPerPixel(format) == 0)
+	{
+		return false;
+	}
+
+	auto mipCount = (header.Flags & DDSD_MIPMAPCOUNT) ? header.MipMapCount : 1u;
+	if (mipCount == 0)
+	{
+		mipCount = 1;
+	}
+
+	auto maxDimension = (dimension == D3D12_RESOURCE_DIMENSION_TEXTURE3D) ? MaxDimension3D : MaxDimension;
+	if (width == 0 || height == 0 || depth == 0
+		|| width > maxDimension || height > maxDimension || depth > maxDimension
+		|| arraySize > MaxArraySize
+		|| mipCount > MaxMipCount)
+	{
+		return false;
+	}
+
+	// cube faces are square
+	if (isCube && width != height)
+	{
+		return false;
+	}
+
+	// a chain can not go below 1x1x1
+	auto largest = (width > height) ? width : height;
+	largest = (largest > depth) ? largest : depth;
+	auto fullCount = 1u;
+	while ((largest >> fullCount) > 0)
+	{
+		fullCount++;
+	}
+
+	if (mipCount > fullCount)
+	{
+		return false;
+	}
+
+	info.Dimension = dimension;
+	info.Width = width;
+	info.Height = height;
+	info.Depth = depth;
+	info.ArraySize = arraySize;
+	info.MipCount = mipCount;
+	info.Format = format;
+	info.IsCube = isCube;
+	info.Subresources.resize(size_t(arraySize) * mipCount);
+
+	// every mip of a slice is stored before the next slice
+	for (auto slice = 0u; slice < arraySize; ++slice)
+	{
+		for (auto mip = 0u; mip < mipCount; ++mip)
+		{
+			auto& sub = info.Subresources[mip + slice * mipCount];
+			sub.Width = GetMipSize(width, mip);
+			sub.Height = GetMipSize(height, mip);
+			sub.Depth = GetMipSize(depth, mip);
+
+			if (!GetSurfaceInfo(sub.Width, sub.Height, format, sub.RowPitch, sub.RowCount))
+			{
+				info = DDSInfo();
+				return false;
+			}
+
+			sub.Offset = offset;
+			sub.SlicePitch = size_t(sub.RowPitch) * sub.RowCount;
+			sub.Size = sub.SlicePitch * sub.Depth;
+
+			if (sub.Size > size - offset)
+			{
+				info = DDSInfo();
+				return false;
+			}
+
+			offset += sub.Size;
+		}
+	}
+
+	return true;
+}
+
+// get resource description of a DDS texture
+D3D12_RESOURCE_DESC GetDDSResourceDesc(const DDSInfo& info, uint32_t firstMip)
+{
+	D3D12_RESOURCE_DESC desc = {};
+	desc.Dimension = info.Dimension;
+	desc.Alignment = 0;
+	desc.Width = GetMipSize(info.Width, firstMip);
+	desc.Height = GetMipSize(info.Height, firstMip);
+	desc.DepthOrArraySize = UINT16((info.Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE3D)
+		? GetMipSize(info.Depth, firstMip)
+		: info.ArraySize);
+	desc.MipLevels = UINT16((firstMip < info.MipCount) ? info.MipCount - firstMip : 0);
+	desc.Format = info.Format;
+	desc.SampleDesc.Count = 1;
+	desc.SampleDesc.Quality = 0;
+	desc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+	desc.Flags = D3D12_RESOURCE_FLAG_NONE;
+
+	return desc;
+}
+
+// lay out subresources in a staging buffer
+UINT64 GetDDSFootprints
+(
+	const DDSInfo& info,
+	uint32_t firstMip,
+	UINT64 baseOffset,
+	std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT>& layouts
+)
+{
+	layouts.clear();
+	if (firstMip >= info.MipCount)
+	{
+		return baseOffset;
+	}
+
+	auto mipCount = info.MipCount - firstMip;
+	auto isBlock = IsBlockCompressed(info.Format);
+	auto offset = baseOffset;
+
+	layouts.resize(size_t(info.ArraySize) * mipCount);
+
+	for (auto slice = 0u; slice < info.ArraySize; ++slice)
+	{
+		for (auto i = 0u; i < mipCount; ++i)
+		{
+			const auto& sub = info.Subresources[firstMip + i + slice * info.MipCount];
+			auto& layout = layouts[i + slice * mipCount];
+
+			// block compressed footprints cover whole blocks
+			layout.Offset = AlignUp(offset, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+			layout.Footprint.Format = info.Format;
+			layout.Footprint.Width = (isBlock) ? UINT(AlignUp(sub.Width, 4)) : sub.Width;
+			layout.Footprint.Height = (isBlock) ? UINT(AlignUp(sub.Height, 4)) : sub.Height;
+			layout.Footprint.Depth = sub.Depth;
+			layout.Footprint.RowPitch = UINT(AlignUp(sub.RowPitch, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT));
+
+			offset = layout.Offset + UINT64(layout.Footprint.RowPitch) * sub.RowCount * sub.Depth;
+		}
+	}
+
+	return offset;
+}
+
+// copy a subresource into a staging buffer
+void CopyDDSSubresource
+(
+	const uint8_t* pFile,
+	const DDSSubresource& src,
+	const D3D12_PLACED_SUBRESOURCE_FOOTPRINT& layout,
+	uint8_t* pStaging
+)
+{
+	auto pSrc = pFile + src.Offset;
+	auto pDst = pStaging + layout.Offset;
+	auto dstSlicePitch = size_t(layout.Footprint.RowPitch) * src.RowCount;
+
+	// rows of the file are tightly packed, so whole slices can be copied when the pitches agree
+	if (src.RowPitch == layout.Footprint.RowPitch)
+	{
+		memcpy(pDst, pSrc, src.Size);
+		return;
+	}
+
+	for (auto z = 0u; z < src.Depth; ++z)
+	{
+		for (auto y = 0u; y < src.RowCount; ++y)
+		{
+			memcpy(
+				pDst + dstSlicePitch * z + size_t(layout.Footprint.RowPitch) * y,
+				pSrc + src.SlicePitch * z + size_t(src.RowPitch) * y,
+				src.RowPitch);
+		}
+	}
+}
+
+// get size of one pixel
+uint32_t GetBitsPerPixel(DXGI_FORMAT format)
+{
+	switch (format)
+	{
+	case DXGI_FORMAT_R32G32B32A32_TYPELESS:
+	case DXGI_FORMAT_R32G32B32A32_FLOAT:
+	case DXGI_FORMAT_R32G32B32A32_UINT:
+	case DXGI_FORMAT_R32G32B32A32_SINT:
+		return 128;
+
+	case DXGI_FORMAT_R32G32B32_TYPELESS:
+	case DXGI_FORMAT_R32G32B32_FLOAT:
+	case DXGI_FORMAT_R32G32B32_UINT:
+	case DXGI_FORMAT_R32G32B32_SINT:
+		return 96;
+
+	case DXGI_FORMAT_R16G16B16A16_TYPELESS:
+	case DXGI_FORMAT_R16G16B16A16_FLOAT:
+	case DXGI_FORMAT_R16G16B16A16_UNORM:
+	case DXGI_FORMAT_R16G16B16A16_UINT:
+	case DXGI_FORMAT_R16G16B16A16_SNORM:
+	case DXGI_FORMAT_R16G16B16A16_SINT:
+	case DXGI_FORMAT_R32G32_TYPELESS:
+	case DXGI_FORMAT_R32G32_FLOAT:
+	case DXGI_FORMAT_R32G32_UINT:
+	case DXGI_FORMAT_R32G32_SINT:
+		return 64;
+
+	case DXGI_FORMAT_R10G10B10A2_TYPELESS:
+	case DXGI_FORMAT_R10G10B10A2_UNORM:
+	case DXGI_FORMAT_R10G10B10A2_UINT:
+	case DXGI_FORMAT_R11G11B10_FLOAT:
+	case DXGI_FORMAT_R8G8B8A8_TYPELESS:
+	case DXGI_FORMAT_R8G8B8A8_UNORM:
+	case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+	case DXGI_FORMAT_R8G8B8A8_UINT:
+	case DXGI_FORMAT_R8G8B8A8_SNORM:
+	case DXGI_FORMAT_R8G8B8A8_SINT:
+	case DXGI_FORMAT_R16G16_TYPELESS:
+	case DXGI_FORMAT_R16G16_FLOAT:
+	case DXGI_FORMAT_R16G16_UNORM:
+	case DXGI_FORMAT_R16G16_UINT:
+	case DXGI_FORMAT_R16G16_SNORM:
+	case DXGI_FORMAT_R16G16_SINT:
+	case DXGI_FORMAT_R32_TYPELESS:
+	case DXGI_FORMAT_R32_FLOAT:
+	case DXGI_FORMAT_R32_UINT:
+	case DXGI_FORMAT_R32_SINT:
+	case DXGI_FORMAT_R9G9B9E5_SHAREDEXP:
+	case DXGI_FORMAT_B8G8R8A8_TYPELESS:
+	case DXGI_FORMAT_B8G8R8A8_UNORM:
+	case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+	case DXGI_FORMAT_B8G8R8X8_TYPELESS:
+	case DXGI_FORMAT_B8G8R8X8_UNORM:
+	case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
+		return 32;
+
+	case DXGI_FORMAT_R8G8_TYPELESS:
+	case DXGI_FORMAT_R8G8_UNORM:
+	case DXGI_FORMAT_R8G8_UINT:
+	case DXGI_FORMAT_R8G8_SNORM:
+	case DXGI_FORMAT_R8G8_SINT:
+	case DXGI_FORMAT_R16_TYPELESS:
+	case DXGI_FORMAT_R16_FLOAT:
+	case DXGI_FORMAT_R16_UNORM:
+	case DXGI_FORMAT_R16_UINT:
+	case DXGI_FORMAT_R16_SNORM:
+	case DXGI_FORMAT_R16_SINT:
+	case DXGI_FORMAT_B5G6R5_UNORM:
+	case DXGI_FORMAT_B5G5R5A1_UNORM:
+	case DXGI_FORMAT_B4G4R4A4_UNORM:
+		return 16;
+
+	case DXGI_FORMAT_R8_TYPELESS:
+	case DXGI_FORMAT_R8_UNORM:
+	case DXGI_FORMAT_R8_UINT:
+	case DXGI_FORMAT_R8_SNORM:
+	case DXGI_FORMAT_R8_SINT:
+	case DXGI_FORMAT_A8_UNORM:
+		return 8;
+
+	case DXGI_FORMAT_BC1_TYPELESS:
+	case DXGI_FORMAT_BC1_UNORM:
+	case DXGI_FORMAT_BC1_UNORM_SRGB:
+	case DXGI_FORMAT_BC4_TYPELESS:
+	case DXGI_FORMAT_BC4_UNORM:
+	case DXGI_FORMAT_BC4_SNORM:
+		return 4;
+
+	case DXGI_FORMAT_BC2_TYPELESS:
+	case DXGI_FORMAT_BC2_UNORM:
+	case DXGI_FORMAT_BC2_UNORM_SRGB:
+	case DXGI_FORMAT_BC3_TYPELESS:
+	case DXGI_FORMAT_BC3_UNORM:
+	case DXGI_FORMAT_BC3_UNORM_SRGB:
+	case DXGI_FORMAT_BC5_TYPELESS:
+	case DXGI_FORMAT_BC5_UNORM:
+	case DXGI_FORMAT_BC5_SNORM:
+	case DXGI_FORMAT_BC6H_TYPELESS:
+	case DXGI_FORMAT_BC6H_UF16:
+	case DXGI_FORMAT_BC6H_SF16:
+	case DXGI_FORMAT_BC7_TYPELESS:
+	case DXGI_FORMAT_BC7_UNORM:
+	case DXGI_FORMAT_BC7_UNORM_SRGB:
+		return 8;
+
+	default:
+		return 0;
+	}
+}
+
+// check whether a format is block compressed
+bool IsBlockCompressed(DXGI_FORMAT format)
+{
+	switch (format)
+	{
+	case DXGI_FORMAT_BC1_TYPELESS:
+	case DXGI_FORMAT_BC1_UNORM:
+	case DXGI_FORMAT_BC1_UNORM_SRGB:
+	case DXGI_FORMAT_BC2_TYPELESS:
+	case DXGI_FORMAT_BC2_UNORM:
+	case DXGI_FORMAT_BC2_UNORM_SRGB:
+	case DXGI_FORMAT_BC3_TYPELESS:
+	case DXGI_FORMAT_BC3_UNORM:
+	case DXGI_FORMAT_BC3_UNORM_SRGB:
+	case DXGI_FORMAT_BC4_TYPELESS:
+	case DXGI_FORMAT_BC4_UNORM:
+	case DXGI_FORMAT_BC4_SNORM:
+	case DXGI_FORMAT_BC5_TYPELESS:
+	case DXGI_FORMAT_BC5_UNORM:
+	case DXGI_FORMAT_BC5_SNORM:
+	case DXGI_FORMAT_BC6H_TYPELESS:
+	case DXGI_FORMAT_BC6H_UF16:
+	case DXGI_FORMAT_BC6H_SF16:
+	case DXGI_FORMAT_BC7_TYPELESS:
+	case DXGI_FORMAT_BC7_UNORM:
+	case DXGI_FORMAT_BC7_UNORM_SRGB:
+		return true;
+
+	default:
+		return false;
+	}
+}
+
+// compute tightly packed layout of one surface
+bool GetSurfaceInfo(uint32_t width, uint32_t height, DXGI_FORMAT format, uint32_t& rowPitch, uint32_t& rowCount)
+{
+	auto bpp = GetBitsPerPixel(format);
+	if (bpp == 0)
+	{
+		return false;
+	}
+
+	if (IsBlockCompressed(format))
+	{
+		// bpp * 16 pixels / 8 bits
+		auto blocksWide = (width + 3) / 4;
+		auto blocksHigh = (height + 3) / 4;
+		rowPitch = ((blocksWide > 0) ? blocksWide : 1) * bpp * 2;
+		rowCount = (blocksHigh > 0) ? blocksHigh : 1;
+	}
+	else
+	{
+		rowPitch = (width * bpp + 7) / 8;
+		rowCount = height;
+	}
+
+	return true;
+}
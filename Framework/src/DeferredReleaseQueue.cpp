@@ -0,0 +1,214 @@
+#include "DeferredReleaseQueue.h"
+#include "DescriptorPool.h"
+#include "Logger.h"
+#include <new>
+
+//
+// DeferredReleaseQueue class
+//
+
+// constructor
+DeferredReleaseQueue::DeferredReleaseQueue()
+	: m_pHead(nullptr)
+	, m_pPending(nullptr)
+	, m_FenceValue(0)
+	, m_Count(0)
+{
+}
+
+// destructor
+DeferredReleaseQueue::~DeferredReleaseQueue()
+{
+	Term();
+}
+
+// end
+void DeferredReleaseQueue::Term()
+{
+	Collect(UINT64_MAX);
+	m_FenceValue = 0;
+}
+
+// set the value of the frame being recorded
+void DeferredReleaseQueue::SetFenceValue(uint64_t value)
+{
+	m_FenceValue.store(value, std::memory_order_release);
+}
+
+// get the value of the frame being recorded
+uint64_t DeferredReleaseQueue::GetFenceValue() const
+{
+	return m_FenceValue.load(std::memory_order_acquire);
+}
+
+// release an object after a fence value
+bool DeferredReleaseQueue::Push(IUnknown* pObject, uint64_t fenceValue)
+{
+	if (pObject == nullptr)
+	{
+		return true;
+	}
+
+	auto pEntry = new (std::nothrow) Entry();
+	if (pEntry == nullptr)
+	{
+		ELOG("Error : Out of memory.");
+		return false;
+	}
+
+	pEntry->FenceValue = fenceValue;
+	pEntry->pObject = pObject;
+	pEntry->pPool = nullptr;
+	pEntry->pHandle = nullptr;
+
+	Link(pEntry);
+	return true;
+}
+
+// release an object after the frame being recorded
+bool DeferredReleaseQueue::Push(IUnknown* pObject)
+{
+	return Push(pObject, GetFenceValue());
+}
+
+// free a descriptor handle after a fence value
+bool DeferredReleaseQueue::PushHandle(DescriptorPool* pPool, DescriptorHandle* pHandle, uint64_t fenceValue)
+{
+	if (pPool == nullptr || pHandle == nullptr)
+	{
+		return true;
+	}
+
+	auto pEntry = new (std::nothrow) Entry();
+	if (pEntry == nullptr)
+	{
+		ELOG("Error : Out of memory.");
+		return false;
+	}
+
+	pEntry->FenceValue = fenceValue;
+	pEntry->pObject = nullptr;
+	pEntry->pPool = pPool;
+	pEntry->pHandle = pHandle;
+
+	// the owner may release the pool before the handle is freed
+	pPool->AddRef();
+
+	Link(pEntry);
+	return true;
+}
+
+// free a descriptor handle after the frame being recorded
+bool DeferredReleaseQueue::PushHandle(DescriptorPool* pPool, DescriptorHandle* pHandle)
+{
+	return PushHandle(pPool, pHandle, GetFenceValue());
+}
+
+// run a function after a fence value
+bool DeferredReleaseQueue::PushCallback(std::function<void()> func, uint64_t fenceValue)
+{
+	if (!func)
+	{
+		return true;
+	}
+
+	auto pEntry = new (std::nothrow) Entry();
+	if (pEntry == nullptr)
+	{
+		ELOG("Error : Out of memory.");
+		return false;
+	}
+
+	pEntry->FenceValue = fenceValue;
+	pEntry->pObject = nullptr;
+	pEntry->pPool = nullptr;
+	pEntry->pHandle = nullptr;
+	pEntry->Callback = std::move(func);
+
+	Link(pEntry);
+	return true;
+}
+
+// run a function after the frame being recorded
+bool DeferredReleaseQueue::PushCallback(std::function<void()> func)
+{
+	return PushCallback(std::move(func), GetFenceValue());
+}
+
+// release entries whose fence value has completed
+size_t DeferredReleaseQueue::Collect(uint64_t completedValue)
+{
+	// take every pushed entry at once. producers start a new stack meanwhile
+	auto pTaken = m_pHead.exchange(nullptr, std::memory_order_acquire);
+	while (pTaken != nullptr)
+	{
+		auto pNext = pTaken->pNext;
+		pTaken->pNext = m_pPending;
+		m_pPending = pTaken;
+		pTaken = pNext;
+	}
+
+	size_t count = 0;
+	auto ppLink = &m_pPending;
+	while (*ppLink != nullptr)
+	{
+		auto pEntry = *ppLink;
+		if (pEntry->FenceValue > completedValue)
+		{
+			ppLink = &pEntry->pNext;
+			continue;
+		}
+
+		*ppLink = pEntry->pNext;
+		Release(pEntry);
+		count++;
+	}
+
+	m_Count.fetch_sub(count, std::memory_order_relaxed);
+	return count;
+}
+
+// get count of entries not released yet
+size_t DeferredReleaseQueue::GetPendingCount() const
+{
+	return m_Count.load(std::memory_order_relaxed);
+}
+
+// link an entry onto the stack
+void DeferredReleaseQueue::Link(Entry* pEntry)
+{
+	m_Count.fetch_add(1, std::memory_order_relaxed);
+
+	auto pHead = m_pHead.load(std::memory_order_relaxed);
+	do
+	{
+		pEntry->pNext = pHead;
+	}
+	while (!m_pHead.compare_exchange_weak(
+		pHead,
+		pEntry,
+		std::memory_order_release,
+		std::memory_order_relaxed));
+}
+
+// release an entry
+void DeferredReleaseQueue::Release(Entry* pEntry)
+{
+	if (pEntry->pObject != nullptr)
+	{
+		pEntry->pObject->Release();
+	}
+
+	if (pEntry->pHandle != nullptr)
+	{
+		pEntry->pPool->FreeHandle(pEntry->pHandle);
+		pEntry->pPool->Release();
+	}
+
+	if (pEntry->Callback)
+	{
+		pEntry->Callback();
+	}
+
+	delete pEntry;
+}
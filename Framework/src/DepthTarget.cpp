@@ -1,6 +1,28 @@
 #include "DepthTarget.h"
 #include "DescriptorPool.h"
 
+namespace
+{
+	// get settings of a depth stencil texture
+	D3D12_RESOURCE_DESC GetTargetDesc(uint32_t width, uint32_t height, DXGI_FORMAT format)
+	{
+		D3D12_RESOURCE_DESC desc = {};
+		desc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+		desc.Alignment = 0;
+		desc.Width = UINT64(width);
+		desc.Height = height;
+		desc.DepthOrArraySize = 1;
+		desc.MipLevels = 1;
+		desc.Format = format;
+		desc.SampleDesc.Count = 1;
+		desc.SampleDesc.Quality = 0;
+		desc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+		desc.Flags = D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL;
+
+		return desc;
+	}
+} // namespace
+
 //
 // DepthTarget class
 //
@@ -32,6 +54,35 @@ bool DepthTarget::Init(
 	float clearDepth,
 	uint8_t clearStencil
 )
+{
+	return Init(
+		pDevice,
+		pPoolRTV,
+		pPoolSRV,
+		width,
+		height,
+		format,
+		clearDepth,
+		clearStencil,
+		nullptr,
+		0,
+		D3D12_RESOURCE_STATE_DEPTH_WRITE);
+}
+
+// initialize in a heap
+bool DepthTarget::Init(
+	ID3D12Device* pDevice,
+	DescriptorPool* pPoolRTV,
+	DescriptorPool* pPoolSRV,
+	uint32_t width,
+	uint32_t height,
+	DXGI_FORMAT format,
+	float clearDepth,
+	uint8_t clearStencil,
+	ID3D12Heap* pHeap,
+	UINT64 heapOffset,
+	D3D12_RESOURCE_STATES state
+)
 {
 	if (pDevice == nullptr || pPoolRTV == nullptr || width == 0 || height == 0)
 	{
@@ -69,18 +120,7 @@ bool DepthTarget::Init(
 	prop.CreationNodeMask = 1;
 	prop.VisibleNodeMask = 1;
 
-	D3D12_RESOURCE_DESC desc = {};
-	desc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
-	desc.Alignment = 0;
-	desc.Width = UINT64(width);
-	desc.Height = height;
-	desc.DepthOrArraySize = 1;
-	desc.MipLevels = 1;
-	desc.Format = format;
-	desc.SampleDesc.Count = 1;
-	desc.SampleDesc.Quality = 0;
-	desc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
-	desc.Flags = D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL;
+	auto desc = GetTargetDesc(width, height, format);
 
 	m_ClearDepth = clearDepth;
 	m_ClearStencil = clearStencil;
@@ -90,13 +130,28 @@ bool DepthTarget::Init(
 	clearValue.DepthStencil.Depth = m_ClearDepth;
 	clearValue.DepthStencil.Stencil = m_ClearStencil;
 
-	auto hr = pDevice->CreateCommittedResource(
-		&prop,
-		D3D12_HEAP_FLAG_NONE,
-		&desc,
-		D3D12_RESOURCE_STATE_DEPTH_WRITE,
-		&clearValue,
-		IID_PPV_ARGS(m_pTarget.GetAddressOf()));
+	HRESULT hr;
+	if (pHeap != nullptr)
+	{
+		hr = pDevice->CreatePlacedResource(
+			pHeap,
+			heapOffset,
+			&desc,
+			state,
+			&clearValue,
+			IID_PPV_ARGS(m_pTarget.GetAddressOf()));
+	}
+	else
+	{
+		hr = pDevice->CreateCommittedResource(
+			&prop,
+			D3D12_HEAP_FLAG_NONE,
+			&desc,
+			state,
+			&clearValue,
+			IID_PPV_ARGS(m_pTarget.GetAddressOf()));
+	}
+
 	if (FAILED(hr))
 	{
 		return false;
@@ -128,6 +183,18 @@ bool DepthTarget::Init(
 	return true;
 }
 
+// get allocation size and alignment of a target
+D3D12_RESOURCE_ALLOCATION_INFO DepthTarget::GetAllocationInfo(
+	ID3D12Device* pDevice,
+	uint32_t width,
+	uint32_t height,
+	DXGI_FORMAT format
+)
+{
+	auto desc = GetTargetDesc(width, height, format);
+	return pDevice->GetResourceAllocationInfo(0, 1, &desc);
+}
+
 // end
 void DepthTarget::Term()
 {
@@ -5,6 +5,8 @@
 DescriptorPool::DescriptorPool()
 	: m_RefCount(1)
 	, m_Pool()
+	, m_RangeAllocator()
+	, m_RangeBase(0)
 	, m_pHeap()
 	, m_DescriptorSize(0)
 {
@@ -15,6 +17,7 @@ DescriptorPool::DescriptorPool()
 DescriptorPool::~DescriptorPool()
 {
 	m_Pool.Term();
+	m_RangeAllocator.Term();
 	m_pHeap.Reset();
 	m_DescriptorSize = 0;
 }
@@ -69,6 +72,58 @@ void DescriptorPool::FreeHandle(DescriptorHandle*& pHandle)
 	}
 }
 
+// allocate contiguous descriptors
+DescriptorRange* DescriptorPool::AllocRange(uint32_t count)
+{
+	uint32_t offset;
+	{
+		std::lock_guard<std::mutex> guard(m_RangeMutex);
+		offset = m_RangeAllocator.Alloc(count);
+	}
+
+	if (offset == BuddyAllocator::InvalidOffset)
+	{
+		return nullptr;
+	}
+
+	auto pRange = new (std::nothrow) DescriptorRange();
+	if (pRange == nullptr)
+	{
+		std::lock_guard<std::mutex> guard(m_RangeMutex);
+		m_RangeAllocator.Free(offset);
+		return nullptr;
+	}
+
+	auto index = m_RangeBase + offset;
+
+	pRange->HandleCPU = m_pHeap->GetCPUDescriptorHandleForHeapStart();
+	pRange->HandleCPU.ptr += SIZE_T(m_DescriptorSize) * index;
+
+	pRange->HandleGPU = m_pHeap->GetGPUDescriptorHandleForHeapStart();
+	pRange->HandleGPU.ptr += UINT64(m_DescriptorSize) * index;
+
+	pRange->Offset = index;
+	pRange->Count = count;
+	pRange->Increment = m_DescriptorSize;
+
+	return pRange;
+}
+
+// release contiguous descriptors
+void DescriptorPool::FreeRange(DescriptorRange*& pRange)
+{
+	if (pRange != nullptr)
+	{
+		{
+			std::lock_guard<std::mutex> guard(m_RangeMutex);
+			m_RangeAllocator.Free(pRange->Offset - m_RangeBase);
+		}
+
+		delete pRange;
+		pRange = nullptr;
+	}
+}
+
 // get available handle count
 uint32_t DescriptorPool::GetAvailableHandleCount() const
 {
@@ -93,10 +148,28 @@ ID3D12DescriptorHeap* const DescriptorPool::GetHeap() const
 	return m_pHeap.Get();
 }
 
+// get index of a descriptor in the heap
+uint32_t DescriptorPool::GetIndex(D3D12_GPU_DESCRIPTOR_HANDLE handle) const
+{
+	auto start = m_pHeap->GetGPUDescriptorHandleForHeapStart();
+	return uint32_t((handle.ptr - start.ptr) / m_DescriptorSize);
+}
+
+bool DescriptorPool::Create
+(
+	ID3D12Device* pDevice,
+	const D3D12_DESCRIPTOR_HEAP_DESC* pDesc,
+	DescriptorPool** ppPool
+)
+{
+	return Create(pDevice, pDesc, 0, ppPool);
+}
+
 bool DescriptorPool::Create
 (
 	ID3D12Device* pDevice,
 	const D3D12_DESCRIPTOR_HEAP_DESC* pDesc,
+	uint32_t rangeCount,
 	DescriptorPool** ppPool
 )
 {
@@ -105,6 +178,11 @@ bool DescriptorPool::Create
 		return false;
 	}
 
+	if (rangeCount >= pDesc->NumDescriptors)
+	{
+		return false;
+	}
+
 	auto instance = new (std::nothrow) DescriptorPool();
 	if (instance == nullptr)
 	{
@@ -121,7 +199,16 @@ bool DescriptorPool::Create
 		return false;
 	}
 
-	if (!instance->m_Pool.Init(pDesc->NumDescriptors))
+	// single handles come from the front of the heap, ranges from the back
+	instance->m_RangeBase = pDesc->NumDescriptors - rangeCount;
+
+	if (!instance->m_Pool.Init(instance->m_RangeBase))
+	{
+		instance->Release();
+		return false;
+	}
+
+	if (rangeCount > 0 && !instance->m_RangeAllocator.Init(rangeCount))
 	{
 		instance->Release();
 		return false;
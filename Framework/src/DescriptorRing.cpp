@@ -0,0 +1,93 @@
+#include "DescriptorRing.h"
+
+//
+// DescriptorRing class
+//
+
+// constructor
+DescriptorRing::DescriptorRing()
+	: m_pPool(nullptr)
+	, m_pRange(nullptr)
+	, m_Allocator()
+{
+}
+
+// destructor
+DescriptorRing::~DescriptorRing()
+{
+	Term();
+}
+
+// initialize
+bool DescriptorRing::Init(DescriptorPool* pPool, uint32_t count)
+{
+	if (pPool == nullptr || count == 0)
+	{
+		return false;
+	}
+
+	assert(m_pPool == nullptr);
+	assert(m_pRange == nullptr);
+
+	m_pPool = pPool;
+	m_pPool->AddRef();
+
+	m_pRange = m_pPool->AllocRange(count);
+	if (m_pRange == nullptr)
+	{
+		return false;
+	}
+
+	return m_Allocator.Init(count);
+}
+
+// end
+void DescriptorRing::Term()
+{
+	m_Allocator.Term();
+
+	if (m_pPool != nullptr && m_pRange != nullptr)
+	{
+		m_pPool->FreeRange(m_pRange);
+		m_pRange = nullptr;
+	}
+
+	if (m_pPool != nullptr)
+	{
+		m_pPool->Release();
+		m_pPool = nullptr;
+	}
+}
+
+// allocate transient descriptors
+DescriptorHandle DescriptorRing::Alloc(uint32_t count)
+{
+	DescriptorHandle result = {};
+
+	if (m_pRange == nullptr)
+	{
+		return result;
+	}
+
+	auto offset = m_Allocator.Alloc(count);
+	if (offset == RingAllocator::InvalidOffset)
+	{
+		return result;
+	}
+
+	result.HandleCPU = m_pRange->GetHandleCPU(offset);
+	result.HandleGPU = m_pRange->GetHandleGPU(offset);
+	return result;
+}
+
+// close current frame
+void DescriptorRing::FinishFrame(uint64_t fenceValue)
+{
+	m_Allocator.FinishFrame(fenceValue);
+}
+
+// reclaim completed frames
+void DescriptorRing::Retire(uint64_t completedValue)
+{
+	m_Allocator.Retire(completedValue);
+}
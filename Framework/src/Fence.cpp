@@ -70,45 +70,68 @@ void Fence::Term()
 // wait for specified time until signal
 void Fence::Wait(ID3D12CommandQueue* pQueue, UINT timeout)
 {
-	if (pQueue == nullptr)
+	// signal
+	auto fenceValue = Signal(pQueue);
+	if (fenceValue == 0)
 	{
 		return;
 	}
 
+	// wait if the preparation for next frame hasn't been done yet.
+	WaitFor(fenceValue, timeout);
+}
+
+// signal without waiting
+UINT64 Fence::Signal(ID3D12CommandQueue* pQueue)
+{
+	if (pQueue == nullptr || m_pFence == nullptr)
+	{
+		return 0;
+	}
+
 	const auto fenceValue = m_Counter;
 
 	// signal
 	auto hr = pQueue->Signal(m_pFence.Get(), fenceValue);
 	if (FAILED(hr))
 	{
-		return;
+		return 0;
 	}
 
 	// increment counter
 	++m_Counter;
 
-	// wait if the preparation for next frame hasn't been done yet.
-	if (m_pFence->GetCompletedValue() < fenceValue)
+	return fenceValue;
+}
+
+// wait for specified time until a value has completed
+bool Fence::WaitFor(UINT64 value, UINT timeout)
+{
+	if (m_pFence == nullptr)
 	{
-		// set event when completed
-		auto hr = m_pFence->SetEventOnCompletion(fenceValue, m_Event);
-		if (FAILED(hr))
-		{
-			return;
-		}
-
-		// wait
-		if (WAIT_OBJECT_0 != WaitForSingleObjectEx(m_Event, timeout, FALSE))
-		{
-			return;
-		}
+		return false;
 	}
+
+	if (m_pFence->GetCompletedValue() >= value)
+	{
+		return true;
+	}
+
+	// set event when completed
+	auto hr = m_pFence->SetEventOnCompletion(value, m_Event);
+	if (FAILED(hr))
+	{
+		return false;
+	}
+
+	// wait
+	return WAIT_OBJECT_0 == WaitForSingleObjectEx(m_Event, timeout, FALSE);
 }
 
 // wait for signal
 void Fence::Sync(ID3D12CommandQueue* pQueue)
 {
-	if (pQueue == nullptr)
+	if (pQueue == nullptr || m_pFence == nullptr)
 	{
 		return;
 	}
@@ -135,4 +158,27 @@ void Fence::Sync(ID3D12CommandQueue* pQueue)
 
 	// increment counter
 	++m_Counter;
+}
+
+// get next fence value
+UINT64 Fence::GetNextValue() const
+{
+	return m_Counter;
+}
+
+// get completed value
+UINT64 Fence::GetCompletedValue() const
+{
+	if (m_pFence == nullptr)
+	{
+		return 0;
+	}
+
+	return m_pFence->GetCompletedValue();
+}
+
+// get fence
+ID3D12Fence* Fence::GetPtr() const
+{
+	return m_pFence.Get();
 }
\ No newline at end of file
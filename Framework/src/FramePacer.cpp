@@ -0,0 +1,126 @@
+#include "FramePacer.h"
+
+//
+// FramePacer class
+//
+
+// constructor
+FramePacer::FramePacer()
+	: m_FrameCount(0)
+	, m_Slot(0)
+	, m_FrameNumber(0)
+{
+	for (auto i = 0u; i < MaxFrameCount; ++i)
+	{
+		m_Values[i] = 0;
+	}
+}
+
+// destructor
+FramePacer::~FramePacer()
+{
+	Term();
+}
+
+// initialize
+bool FramePacer::Init(uint32_t frameCount)
+{
+	if (frameCount == 0 || frameCount > MaxFrameCount)
+	{
+		return false;
+	}
+
+	Term();
+
+	m_FrameCount = frameCount;
+	return true;
+}
+
+// end
+void FramePacer::Term()
+{
+	for (auto i = 0u; i < MaxFrameCount; ++i)
+	{
+		m_Values[i] = 0;
+	}
+
+	m_FrameCount = 0;
+	m_Slot = 0;
+	m_FrameNumber = 0;
+}
+
+// close the frame being recorded
+uint64_t FramePacer::EndFrame(uint64_t fenceValue)
+{
+	if (m_FrameCount == 0)
+	{
+		return 0;
+	}
+
+	m_Values[m_Slot] = fenceValue;
+	m_Slot = (m_Slot + 1) % m_FrameCount;
+	m_FrameNumber++;
+
+	return m_Values[m_Slot];
+}
+
+// get the value to wait for before recording the current slot
+uint64_t FramePacer::GetWaitValue() const
+{
+	if (m_FrameCount == 0)
+	{
+		return 0;
+	}
+
+	return m_Values[m_Slot];
+}
+
+// check whether the current slot can be recorded into
+bool FramePacer::CanBegin(uint64_t completedValue) const
+{
+	return completedValue >= GetWaitValue();
+}
+
+// get count of frames in flight
+uint32_t FramePacer::GetInFlightCount(uint64_t completedValue) const
+{
+	auto count = 0u;
+	for (auto i = 0u; i < m_FrameCount; ++i)
+	{
+		if (m_Values[i] > completedValue)
+		{
+			count++;
+		}
+	}
+
+	return count;
+}
+
+// get the value of the last closed frame
+uint64_t FramePacer::GetLastValue() const
+{
+	if (m_FrameNumber == 0)
+	{
+		return 0;
+	}
+
+	return m_Values[(m_Slot + m_FrameCount - 1) % m_FrameCount];
+}
+
+// get frame count in flight
+uint32_t FramePacer::GetFrameCount() const
+{
+	return m_FrameCount;
+}
+
+// get slot of the frame being recorded
+uint32_t FramePacer::GetSlot() const
+{
+	return m_Slot;
+}
+
+// get frame number
+uint64_t FramePacer::GetFrameNumber() const
+{
+	return m_FrameNumber;
+}
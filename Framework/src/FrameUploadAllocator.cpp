@@ -0,0 +1,178 @@
+#include "FrameUploadAllocator.h"
+#include "Logger.h"
+#include <new>
+#include <cassert>
+
+//
+// FrameUploadAllocator class
+//
+
+// constructor
+FrameUploadAllocator::FrameUploadAllocator()
+	: m_pFrames(nullptr)
+	, m_FrameCount(0)
+	, m_FrameIndex(0)
+{
+}
+
+// destructor
+FrameUploadAllocator::~FrameUploadAllocator()
+{
+	Term();
+}
+
+// initialize
+bool FrameUploadAllocator::Init(ID3D12Device* pDevice, uint32_t frameCount, uint64_t sizePerFrame)
+{
+	if (pDevice == nullptr || frameCount == 0 || sizePerFrame == 0)
+	{
+		return false;
+	}
+
+	assert(m_pFrames == nullptr);
+
+	m_pFrames = new (std::nothrow) Frame[frameCount];
+	if (m_pFrames == nullptr)
+	{
+		ELOG("Error : Out of memory.");
+		return false;
+	}
+
+	m_FrameCount = frameCount;
+	m_FrameIndex = 0;
+
+	UINT64 align = D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT;
+	UINT64 sizeAligned = (sizePerFrame + (align - 1)) & ~(align - 1); // round up to align
+
+	// heap property
+	D3D12_HEAP_PROPERTIES prop = {};
+	prop.Type = D3D12_HEAP_TYPE_UPLOAD;
+	prop.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+	prop.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+	prop.CreationNodeMask = 1;
+	prop.VisibleNodeMask = 1;
+
+	// set resource
+	D3D12_RESOURCE_DESC desc = {};
+	desc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+	desc.Alignment = 0;
+	desc.Width = sizeAligned;
+	desc.Height = 1;
+	desc.DepthOrArraySize = 1;
+	desc.MipLevels = 1;
+	desc.Format = DXGI_FORMAT_UNKNOWN;
+	desc.SampleDesc.Count = 1;
+	desc.SampleDesc.Quality = 0;
+	desc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+	desc.Flags = D3D12_RESOURCE_FLAG_NONE;
+
+	for (auto i = 0u; i < m_FrameCount; ++i)
+	{
+		auto& frame = m_pFrames[i];
+
+		auto hr = pDevice->CreateCommittedResource(
+			&prop,
+			D3D12_HEAP_FLAG_NONE,
+			&desc,
+			D3D12_RESOURCE_STATE_GENERIC_READ,
+			nullptr,
+			IID_PPV_ARGS(frame.pBuffer.GetAddressOf()));
+		if (FAILED(hr))
+		{
+			ELOG("Error : ID3D12Device::CreateCommittedResource() Failed. retcode = 0x%x", hr);
+			return false;
+		}
+
+		// keep mapped for the lifetime of the buffer
+		void* ptr = nullptr;
+		hr = frame.pBuffer->Map(0, nullptr, &ptr);
+		if (FAILED(hr))
+		{
+			ELOG("Error : ID3D12Resource::Map() Failed. retcode = 0x%x", hr);
+			return false;
+		}
+
+		frame.pMappedPtr = static_cast<uint8_t*>(ptr);
+		frame.Address = frame.pBuffer->GetGPUVirtualAddress();
+
+		if (!frame.Allocator.Init(sizeAligned))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// end
+void FrameUploadAllocator::Term()
+{
+	if (m_pFrames != nullptr)
+	{
+		for (auto i = 0u; i < m_FrameCount; ++i)
+		{
+			auto& frame = m_pFrames[i];
+			if (frame.pBuffer != nullptr && frame.pMappedPtr != nullptr)
+			{
+				frame.pBuffer->Unmap(0, nullptr);
+			}
+		}
+
+		delete[] m_pFrames;
+		m_pFrames = nullptr;
+	}
+
+	m_FrameCount = 0;
+	m_FrameIndex = 0;
+}
+
+// begin frame
+void FrameUploadAllocator::Begin(uint32_t frameIndex)
+{
+	if (m_pFrames == nullptr)
+	{
+		return;
+	}
+
+	assert(frameIndex < m_FrameCount);
+	m_FrameIndex = frameIndex % m_FrameCount;
+	m_pFrames[m_FrameIndex].Allocator.Reset();
+}
+
+// allocate memory of the current frame
+UploadAllocation FrameUploadAllocator::Alloc(size_t size)
+{
+	UploadAllocation result;
+
+	if (m_pFrames == nullptr || size == 0)
+	{
+		return result;
+	}
+
+	UINT64 align = D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT;
+	UINT64 sizeAligned = (size + (align - 1)) & ~(align - 1); // round up to align
+
+	auto& frame = m_pFrames[m_FrameIndex];
+	auto offset = frame.Allocator.Alloc(sizeAligned, align);
+	if (offset == LinearAllocator::InvalidOffset)
+	{
+		ELOG("Error : FrameUploadAllocator is full. size = %zu", size);
+		return result;
+	}
+
+	result.pCPU = frame.pMappedPtr + offset;
+	result.AddressGPU = frame.Address + offset;
+	result.Size = uint32_t(sizeAligned);
+	return result;
+}
+
+// get used size of the current frame
+uint64_t FrameUploadAllocator::GetUsedSize() const
+{
+	if (m_pFrames == nullptr)
+	{
+		return 0;
+	}
+
+	return m_pFrames[m_FrameIndex].Allocator.GetUsedSize();
+}
@@ -0,0 +1,192 @@
+#include "FreeListAllocator.h"
+#include <cassert>
+#include <iterator>
+
+//
+// FreeListAllocator class
+//
+
+// constructor
+FreeListAllocator::FreeListAllocator()
+	: m_Capacity(0)
+	, m_UsedCount(0)
+{
+}
+
+// destructor
+FreeListAllocator::~FreeListAllocator()
+{
+	Term();
+}
+
+// initialize
+bool FreeListAllocator::Init(uint32_t capacity)
+{
+	if (capacity == 0 || capacity == InvalidOffset)
+	{
+		return false;
+	}
+
+	Term();
+
+	m_Capacity = capacity;
+	m_Free[0] = capacity;
+
+	return true;
+}
+
+// end
+void FreeListAllocator::Term()
+{
+	m_Free.clear();
+	m_Used.clear();
+	m_Capacity = 0;
+	m_UsedCount = 0;
+}
+
+// allocate contiguous range
+uint32_t FreeListAllocator::Alloc(uint32_t count)
+{
+	if (count == 0)
+	{
+		return InvalidOffset;
+	}
+
+	// first fit
+	for (auto itr = m_Free.begin(); itr != m_Free.end(); ++itr)
+	{
+		if (itr->second < count)
+		{
+			continue;
+		}
+
+		auto offset = itr->first;
+		auto remain = itr->second - count;
+
+		m_Free.erase(itr);
+		if (remain > 0)
+		{
+			m_Free[offset + count] = remain;
+		}
+
+		m_Used[offset] = count;
+		m_UsedCount += count;
+
+		return offset;
+	}
+
+	return InvalidOffset;
+}
+
+// free range
+void FreeListAllocator::Free(uint32_t offset)
+{
+	auto used = m_Used.find(offset);
+	if (used == m_Used.end())
+	{
+		assert(offset == InvalidOffset);
+		return;
+	}
+
+	auto count = used->second;
+	m_Used.erase(used);
+	m_UsedCount -= count;
+
+	// merge with the following free range
+	auto next = m_Free.lower_bound(offset);
+	if (next != m_Free.end() && offset + count == next->first)
+	{
+		count += next->second;
+		next = m_Free.erase(next);
+	}
+
+	// merge with the preceding free range
+	if (next != m_Free.begin())
+	{
+		auto prev = std::prev(next);
+		if (prev->first + prev->second == offset)
+		{
+			prev->second += count;
+			return;
+		}
+	}
+
+	m_Free[offset] = count;
+}
+
+// pack live ranges to the front
+void FreeListAllocator::Compact(std::vector<Move>& moves)
+{
+	moves.clear();
+
+	std::map<uint32_t, uint32_t> used;
+	auto cursor = 0u;
+
+	for (auto itr = m_Used.begin(); itr != m_Used.end(); ++itr)
+	{
+		if (itr->first != cursor)
+		{
+			Move move;
+			move.SrcOffset = itr->first;
+			move.DstOffset = cursor;
+			move.Count = itr->second;
+			moves.push_back(move);
+		}
+
+		used[cursor] = itr->second;
+		cursor += itr->second;
+	}
+
+	m_Used.swap(used);
+
+	m_Free.clear();
+	if (cursor < m_Capacity)
+	{
+		m_Free[cursor] = m_Capacity - cursor;
+	}
+}
+
+// check whether live ranges are packed
+bool FreeListAllocator::IsCompact() const
+{
+	if (m_Free.empty())
+	{
+		return true;
+	}
+
+	return m_Free.size() == 1 && m_Free.begin()->first == m_UsedCount;
+}
+
+// get element count of live range
+uint32_t FreeListAllocator::GetCount(uint32_t offset) const
+{
+	auto itr = m_Used.find(offset);
+	return (itr != m_Used.end()) ? itr->second : 0;
+}
+
+// get total element count
+uint32_t FreeListAllocator::GetCapacity() const
+{
+	return m_Capacity;
+}
+
+// get allocated element count
+uint32_t FreeListAllocator::GetUsedCount() const
+{
+	return m_UsedCount;
+}
+
+// get size of the largest free range
+uint32_t FreeListAllocator::GetLargestFreeRange() const
+{
+	auto result = 0u;
+	for (auto itr = m_Free.begin(); itr != m_Free.end(); ++itr)
+	{
+		if (itr->second > result)
+		{
+			result = itr->second;
+		}
+	}
+
+	return result;
+}
@@ -0,0 +1,530 @@
+#include "GeometryArena.h"
+#include "BufferUploadBatch.h"
+#include "CommandList.h"
+#include "DeferredReleaseQueue.h"
+#include "Fence.h"
+#include "IndexFormat.h"
+#include "Logger.h"
+#include <algorithm>
+#include <new>
+
+//
+// GeometryArena class
+//
+
+// constructor
+GeometryArena::GeometryArena()
+	: m_pDevice(nullptr)
+	, m_pVB(nullptr)
+	, m_VertexStride(0)
+	, m_pReleaseQueue(nullptr)
+	, m_NextRetiredId(0)
+{
+	m_Index[0].Format = DXGI_FORMAT_R16_UINT;
+	m_Index[0].Stride = sizeof(uint16_t);
+	m_Index[1].Format = DXGI_FORMAT_R32_UINT;
+	m_Index[1].Stride = sizeof(uint32_t);
+}
+
+// destructor
+GeometryArena::~GeometryArena()
+{
+	Term();
+}
+
+// initialize
+bool GeometryArena::Init
+(
+	ID3D12Device* pDevice,
+	uint32_t vertexStride,
+	uint32_t vertexCapacity,
+	uint32_t indexCapacity16,
+	uint32_t indexCapacity32,
+	DeferredReleaseQueue* pReleaseQueue
+)
+{
+	if (pDevice == nullptr || vertexStride == 0 || vertexCapacity == 0)
+	{
+		return false;
+	}
+
+	if (indexCapacity16 == 0 && indexCapacity32 == 0)
+	{
+		return false;
+	}
+
+	m_pDevice = pDevice;
+	m_VertexStride = vertexStride;
+	m_pReleaseQueue = pReleaseQueue;
+
+	if (!m_VertexAllocator.Init(vertexCapacity))
+	{
+		return false;
+	}
+
+	if (!CreateBuffer(UINT64(vertexStride) * vertexCapacity, m_pVB))
+	{
+		return false;
+	}
+
+	// a region without capacity has no buffer and never allocates
+	const uint32_t capacities[] = { indexCapacity16, indexCapacity32 };
+	for (auto i = 0; i < 2; ++i)
+	{
+		if (capacities[i] == 0)
+		{
+			continue;
+		}
+
+		auto& region = m_Index[i];
+		if (!region.Allocator.Init(capacities[i]))
+		{
+			return false;
+		}
+
+		if (!CreateBuffer(UINT64(region.Stride) * capacities[i], region.pIB))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// end
+void GeometryArena::Term()
+{
+	for (size_t i = 0; i < m_pAllocations.size(); ++i)
+	{
+		delete m_pAllocations[i];
+	}
+	m_pAllocations.clear();
+
+	// frees still in the release queue find nothing to return
+	m_Retired.clear();
+	m_pReleaseQueue = nullptr;
+
+	m_VertexAllocator.Term();
+	for (auto i = 0; i < 2; ++i)
+	{
+		m_Index[i].Allocator.Term();
+		m_Index[i].pIB.Reset();
+	}
+	m_pVB.Reset();
+	m_pDevice.Reset();
+	m_VertexStride = 0;
+}
+
+// allocate geometry
+GeometryAllocation* GeometryArena::Alloc
+(
+	BufferUploadBatch& batch,
+	const void* pVertices,
+	uint32_t vertexCount,
+	const uint32_t* pIndices,
+	uint32_t indexCount
+)
+{
+	return Alloc(batch, pVertices, vertexCount, pIndices, DXGI_FORMAT_R32_UINT, indexCount);
+}
+
+// allocate geometry with indices of the given format
+GeometryAllocation* GeometryArena::Alloc
+(
+	BufferUploadBatch& batch,
+	const void* pVertices,
+	uint32_t vertexCount,
+	const void* pIndices,
+	DXGI_FORMAT indexFormat,
+	uint32_t indexCount
+)
+{
+	if (pVertices == nullptr || vertexCount == 0 || pIndices == nullptr || indexCount == 0)
+	{
+		return nullptr;
+	}
+
+	if (indexFormat != DXGI_FORMAT_R16_UINT && indexFormat != DXGI_FORMAT_R32_UINT)
+	{
+		return nullptr;
+	}
+
+	auto baseVertex = m_VertexAllocator.Alloc(vertexCount);
+	if (baseVertex == FreeListAllocator::InvalidOffset)
+	{
+		ELOG("Error : GeometryArena is out of vertices. count = %u", vertexCount);
+		return nullptr;
+	}
+
+	// prefer 16-bit indices, fall back to 32 bits when the 16-bit region is full
+	auto format = SelectIndexFormat(vertexCount);
+	auto firstIndex = FreeListAllocator::InvalidOffset;
+	if (format == DXGI_FORMAT_R16_UINT)
+	{
+		firstIndex = GetRegion(format).Allocator.Alloc(indexCount);
+		if (firstIndex == FreeListAllocator::InvalidOffset)
+		{
+			format = DXGI_FORMAT_R32_UINT;
+		}
+	}
+
+	auto& region = GetRegion(format);
+	if (firstIndex == FreeListAllocator::InvalidOffset)
+	{
+		firstIndex = region.Allocator.Alloc(indexCount);
+	}
+
+	if (firstIndex == FreeListAllocator::InvalidOffset)
+	{
+		ELOG("Error : GeometryArena is out of indices. count = %u", indexCount);
+		m_VertexAllocator.Free(baseVertex);
+		return nullptr;
+	}
+
+	auto pAllocation = new (std::nothrow) GeometryAllocation();
+	if (pAllocation == nullptr)
+	{
+		ELOG("Error : Out of memory.");
+		m_VertexAllocator.Free(baseVertex);
+		region.Allocator.Free(firstIndex);
+		return nullptr;
+	}
+
+	pAllocation->BaseVertex = baseVertex;
+	pAllocation->VertexCount = vertexCount;
+	pAllocation->FirstIndex = firstIndex;
+	pAllocation->IndexCount = indexCount;
+	pAllocation->IndexFormat = format;
+
+	// convert indices only when the formats differ (batch.Upload() copies the data, so a
+	// temporary is enough)
+	std::vector<uint16_t> indices16;
+	std::vector<uint32_t> indices32;
+	const void* pIndexData = pIndices;
+	if (format == DXGI_FORMAT_R16_UINT && indexFormat == DXGI_FORMAT_R32_UINT)
+	{
+		auto pSrc = static_cast<const uint32_t*>(pIndices);
+		PackIndices16(std::vector<uint32_t>(pSrc, pSrc + indexCount), indices16);
+		pIndexData = indices16.data();
+	}
+	else if (format == DXGI_FORMAT_R32_UINT && indexFormat == DXGI_FORMAT_R16_UINT)
+	{
+		auto pSrc = static_cast<const uint16_t*>(pIndices);
+		indices32.assign(pSrc, pSrc + indexCount);
+		pIndexData = indices32.data();
+	}
+
+	// stage data
+	auto result = batch.Upload(
+		m_pVB.Get(),
+		UINT64(m_VertexStride) * baseVertex,
+		pVertices,
+		UINT64(m_VertexStride) * vertexCount,
+		D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER);
+	result &= batch.Upload(
+		region.pIB.Get(),
+		UINT64(region.Stride) * firstIndex,
+		pIndexData,
+		UINT64(region.Stride) * indexCount,
+		D3D12_RESOURCE_STATE_INDEX_BUFFER);
+	if (!result)
+	{
+		m_VertexAllocator.Free(baseVertex);
+		region.Allocator.Free(firstIndex);
+		delete pAllocation;
+		return nullptr;
+	}
+
+	m_pAllocations.push_back(pAllocation);
+	return pAllocation;
+}
+
+// free geometry
+void GeometryArena::Free(GeometryAllocation*& pAllocation)
+{
+	if (pAllocation == nullptr)
+	{
+		return;
+	}
+
+	auto itr = std::find(m_pAllocations.begin(), m_pAllocations.end(), pAllocation);
+	if (itr != m_pAllocations.end())
+	{
+		RetiredRange range = {};
+		range.Id = m_NextRetiredId++;
+		range.BaseVertex = pAllocation->BaseVertex;
+		range.FirstIndex = pAllocation->FirstIndex;
+		range.IndexFormat = pAllocation->IndexFormat;
+
+		m_pAllocations.erase(itr);
+		delete pAllocation;
+
+		// frames in flight may still draw from the range. whatever the queue does not take is returned at once
+		auto id = range.Id;
+		m_Retired.push_back(range);
+		if (m_pReleaseQueue == nullptr || !m_pReleaseQueue->PushCallback([this, id]() { Reclaim(id); }))
+		{
+			Reclaim(id);
+		}
+	}
+
+	pAllocation = nullptr;
+}
+
+// return a range to the allocators
+void GeometryArena::FreeRange(const RetiredRange& range)
+{
+	m_VertexAllocator.Free(range.BaseVertex);
+	GetRegion(range.IndexFormat).Allocator.Free(range.FirstIndex);
+}
+
+// return a freed range whose frames have finished
+void GeometryArena::Reclaim(uint64_t id)
+{
+	for (auto itr = m_Retired.begin(); itr != m_Retired.end(); ++itr)
+	{
+		if (itr->Id == id)
+		{
+			FreeRange(*itr);
+			m_Retired.erase(itr);
+			return;
+		}
+	}
+}
+
+// pack live geometry
+bool GeometryArena::Compact(ID3D12CommandQueue* pQueue, DeferredReleaseQueue* pReleaseQueue)
+{
+	if (pQueue == nullptr || m_pDevice == nullptr)
+	{
+		return false;
+	}
+
+	// retired ranges still look allocated, and returning them needs the fresh buffers
+	if (m_Retired.empty()
+	 && m_VertexAllocator.IsCompact()
+	 && m_Index[0].Allocator.IsCompact()
+	 && m_Index[1].Allocator.IsCompact())
+	{
+		return true;
+	}
+
+	// a buffer can not be copy source and destination at once, so copy into fresh buffers
+	ComPtr<ID3D12Resource> pVB;
+	ComPtr<ID3D12Resource> pIB[2];
+	if (!CreateBuffer(UINT64(m_VertexStride) * m_VertexAllocator.GetCapacity(), pVB))
+	{
+		return false;
+	}
+
+	for (auto i = 0; i < 2; ++i)
+	{
+		auto capacity = m_Index[i].Allocator.GetCapacity();
+		if (capacity > 0 && !CreateBuffer(UINT64(m_Index[i].Stride) * capacity, pIB[i]))
+		{
+			return false;
+		}
+	}
+
+	CommandList commandList;
+	Fence fence;
+	if (!commandList.Init(m_pDevice.Get(), pQueue->GetDesc().Type, 1) || !fence.Init(m_pDevice.Get()))
+	{
+		return false;
+	}
+
+	auto pCmd = commandList.Reset();
+	if (pCmd == nullptr)
+	{
+		return false;
+	}
+
+	// freed ranges are not copied, and frames in flight keep reading them from the old buffers
+	for (size_t i = 0; i < m_Retired.size(); ++i)
+	{
+		FreeRange(m_Retired[i]);
+	}
+	m_Retired.clear();
+
+	std::vector<FreeListAllocator::Move> vertexMoves;
+	std::vector<FreeListAllocator::Move> indexMoves[2];
+	m_VertexAllocator.Compact(vertexMoves);
+	m_Index[0].Allocator.Compact(indexMoves[0]);
+	m_Index[1].Allocator.Compact(indexMoves[1]);
+
+	auto GetNewOffset = [](const std::vector<FreeListAllocator::Move>& moves, uint32_t offset)
+	{
+		for (size_t i = 0; i < moves.size(); ++i)
+		{
+			if (moves[i].SrcOffset == offset)
+			{
+				return moves[i].DstOffset;
+			}
+		}
+
+		return offset;
+	};
+
+	// every buffer is in COMMON, so they are promoted to copy states implicitly
+	for (size_t i = 0; i < m_pAllocations.size(); ++i)
+	{
+		auto pAllocation = m_pAllocations[i];
+		auto regionIndex = (pAllocation->IndexFormat == DXGI_FORMAT_R16_UINT) ? 0 : 1;
+		const auto& region = m_Index[regionIndex];
+		auto baseVertex = GetNewOffset(vertexMoves, pAllocation->BaseVertex);
+		auto firstIndex = GetNewOffset(indexMoves[regionIndex], pAllocation->FirstIndex);
+
+		pCmd->CopyBufferRegion(
+			pVB.Get(),
+			UINT64(m_VertexStride) * baseVertex,
+			m_pVB.Get(),
+			UINT64(m_VertexStride) * pAllocation->BaseVertex,
+			UINT64(m_VertexStride) * pAllocation->VertexCount);
+		pCmd->CopyBufferRegion(
+			pIB[regionIndex].Get(),
+			UINT64(region.Stride) * firstIndex,
+			region.pIB.Get(),
+			UINT64(region.Stride) * pAllocation->FirstIndex,
+			UINT64(region.Stride) * pAllocation->IndexCount);
+
+		pAllocation->BaseVertex = baseVertex;
+		pAllocation->FirstIndex = firstIndex;
+	}
+
+	pCmd->Close();
+
+	ID3D12CommandList* pLists[] = { pCmd };
+	pQueue->ExecuteCommandLists(1, pLists);
+	fence.Sync(pQueue);
+
+	DLOG("Info : GeometryArena compacted. %zu vertex moves, %zu index moves.",
+		vertexMoves.size(), indexMoves[0].size() + indexMoves[1].size());
+
+	// frames recorded before this call still draw from the old buffers.
+	// whatever the queue does not take is released at once
+	ComPtr<ID3D12Resource> pOld[] = { m_pVB, m_Index[0].pIB, m_Index[1].pIB };
+	for (auto& pBuffer : pOld)
+	{
+		if (pReleaseQueue != nullptr && pBuffer != nullptr && pReleaseQueue->Push(pBuffer.Get()))
+		{
+			pBuffer.Detach();
+		}
+	}
+
+	m_pVB = pVB;
+	m_Index[0].pIB = pIB[0];
+	m_Index[1].pIB = pIB[1];
+
+	return true;
+}
+
+// bind vertex and index buffer
+void GeometryArena::Bind(ID3D12GraphicsCommandList* pCmdList, DXGI_FORMAT indexFormat) const
+{
+	auto VBV = GetVertexView();
+	pCmdList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+	pCmdList->IASetVertexBuffers(0, 1, &VBV);
+	BindIndexBuffer(pCmdList, indexFormat);
+}
+
+// bind index buffer only
+void GeometryArena::BindIndexBuffer(ID3D12GraphicsCommandList* pCmdList, DXGI_FORMAT indexFormat) const
+{
+	auto IBV = GetIndexView(indexFormat);
+	pCmdList->IASetIndexBuffer(&IBV);
+}
+
+// get vertex buffer view
+D3D12_VERTEX_BUFFER_VIEW GeometryArena::GetVertexView() const
+{
+	D3D12_VERTEX_BUFFER_VIEW result = {};
+	if (m_pVB != nullptr)
+	{
+		result.BufferLocation = m_pVB->GetGPUVirtualAddress();
+		result.StrideInBytes = m_VertexStride;
+		result.SizeInBytes = UINT(m_VertexStride * m_VertexAllocator.GetCapacity());
+	}
+
+	return result;
+}
+
+// get index buffer view
+D3D12_INDEX_BUFFER_VIEW GeometryArena::GetIndexView(DXGI_FORMAT indexFormat) const
+{
+	const auto& region = GetRegion(indexFormat);
+
+	D3D12_INDEX_BUFFER_VIEW result = {};
+	if (region.pIB != nullptr)
+	{
+		result.BufferLocation = region.pIB->GetGPUVirtualAddress();
+		result.Format = region.Format;
+		result.SizeInBytes = UINT(region.Stride * region.Allocator.GetCapacity());
+	}
+
+	return result;
+}
+
+// get used vertex count
+uint32_t GeometryArena::GetUsedVertexCount() const
+{
+	return m_VertexAllocator.GetUsedCount();
+}
+
+// get used index count
+uint32_t GeometryArena::GetUsedIndexCount(DXGI_FORMAT indexFormat) const
+{
+	return GetRegion(indexFormat).Allocator.GetUsedCount();
+}
+
+// get index region of a format
+GeometryArena::IndexRegion& GeometryArena::GetRegion(DXGI_FORMAT indexFormat)
+{
+	return (indexFormat == DXGI_FORMAT_R16_UINT) ? m_Index[0] : m_Index[1];
+}
+
+// get index region of a format
+const GeometryArena::IndexRegion& GeometryArena::GetRegion(DXGI_FORMAT indexFormat) const
+{
+	return (indexFormat == DXGI_FORMAT_R16_UINT) ? m_Index[0] : m_Index[1];
+}
+
+// create DEFAULT heap buffer
+bool GeometryArena::CreateBuffer(UINT64 size, ComPtr<ID3D12Resource>& pBuffer)
+{
+	// heap property
+	D3D12_HEAP_PROPERTIES prop = {};
+	prop.Type = D3D12_HEAP_TYPE_DEFAULT;
+	prop.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+	prop.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+	prop.CreationNodeMask = 1;
+	prop.VisibleNodeMask = 1;
+
+	// settings of resource
+	D3D12_RESOURCE_DESC desc = {};
+	desc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+	desc.Alignment = 0;
+	desc.Width = size;
+	desc.Height = 1;
+	desc.DepthOrArraySize = 1;
+	desc.MipLevels = 1;
+	desc.Format = DXGI_FORMAT_UNKNOWN;
+	desc.SampleDesc.Count = 1;
+	desc.SampleDesc.Quality = 0;
+	desc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+	desc.Flags = D3D12_RESOURCE_FLAG_NONE;
+
+	auto hr = m_pDevice->CreateCommittedResource(
+		&prop,
+		D3D12_HEAP_FLAG_NONE,
+		&desc,
+		D3D12_RESOURCE_STATE_COMMON,
+		nullptr,
+		IID_PPV_ARGS(pBuffer.ReleaseAndGetAddressOf()));
+	if (FAILED(hr))
+	{
+		ELOG("Error : ID3D12Device::CreateCommittedResource() Failed. retcode = 0x%x", hr);
+		return false;
+	}
+
+	return true;
+}
@@ -1,4 +1,5 @@
 #include "IndexBuffer.h"
+#include "BufferUploadBatch.h"
 
 //
 // IndexBuffer class
@@ -7,6 +8,7 @@
 // constructor
 IndexBuffer::IndexBuffer()
 	: m_pIB(nullptr)
+	, m_IsStatic(false)
 {
 	memset(&m_View, 0, sizeof(m_View));
 }
@@ -19,6 +21,30 @@ IndexBuffer::~IndexBuffer()
 
 // initialize
 bool IndexBuffer::Init(ID3D12Device* pDevice, size_t size, const uint32_t* pInitData)
+{
+	return InitUpload(pDevice, size, pInitData, DXGI_FORMAT_R32_UINT);
+}
+
+// initialize as static geometry
+bool IndexBuffer::Init(BufferUploadBatch& batch, size_t size, const uint32_t* pInitData)
+{
+	return InitStatic(batch, size, pInitData, DXGI_FORMAT_R32_UINT);
+}
+
+// initialize with 16-bit indices
+bool IndexBuffer::Init(ID3D12Device* pDevice, size_t size, const uint16_t* pInitData)
+{
+	return InitUpload(pDevice, size, pInitData, DXGI_FORMAT_R16_UINT);
+}
+
+// initialize as static geometry with 16-bit indices
+bool IndexBuffer::Init(BufferUploadBatch& batch, size_t size, const uint16_t* pInitData)
+{
+	return InitStatic(batch, size, pInitData, DXGI_FORMAT_R16_UINT);
+}
+
+// initialize in an UPLOAD heap
+bool IndexBuffer::InitUpload(ID3D12Device* pDevice, size_t size, const void* pInitData, DXGI_FORMAT format)
 {
 	// heap property
 	D3D12_HEAP_PROPERTIES prop = {};
@@ -57,7 +83,7 @@ bool IndexBuffer::Init(ID3D12Device* pDevice, size_t size, const uint32_t* pInit
 
 	// settings of index buffer view
 	m_View.BufferLocation = m_pIB->GetGPUVirtualAddress();
-	m_View.Format = DXGI_FORMAT_R32_UINT;
+	m_View.Format = format;
 	m_View.SizeInBytes = UINT(size);
 
 	// if there's initialize data, write out
@@ -78,16 +104,83 @@ bool IndexBuffer::Init(ID3D12Device* pDevice, size_t size, const uint32_t* pInit
 	return true;
 }
 
+// initialize in a DEFAULT heap
+bool IndexBuffer::InitStatic(BufferUploadBatch& batch, size_t size, const void* pInitData, DXGI_FORMAT format)
+{
+	auto pDevice = batch.GetDevice();
+
+	if (pDevice == nullptr || size == 0 || pInitData == nullptr)
+	{
+		return false;
+	}
+
+	// heap property
+	D3D12_HEAP_PROPERTIES prop = {};
+	prop.Type = D3D12_HEAP_TYPE_DEFAULT;
+	prop.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+	prop.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+	prop.CreationNodeMask = 1;
+	prop.VisibleNodeMask = 1;
+
+	// settings of the resource
+	D3D12_RESOURCE_DESC desc = {};
+	desc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+	desc.Alignment = 0;
+	desc.Width = UINT64(size);
+	desc.Height = 1;
+	desc.DepthOrArraySize = 1;
+	desc.MipLevels = 1;
+	desc.Format = DXGI_FORMAT_UNKNOWN;
+	desc.SampleDesc.Count = 1;
+	desc.SampleDesc.Quality = 0;
+	desc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+	desc.Flags = D3D12_RESOURCE_FLAG_NONE;
+
+	// generate resource (COMMON, so that a copy queue can write to it)
+	auto hr = pDevice->CreateCommittedResource(
+		&prop,
+		D3D12_HEAP_FLAG_NONE,
+		&desc,
+		D3D12_RESOURCE_STATE_COMMON,
+		nullptr,
+		IID_PPV_ARGS(m_pIB.GetAddressOf()));
+	if (FAILED(hr))
+	{
+		return false;
+	}
+
+	m_IsStatic = true;
+
+	// settings of index buffer view
+	m_View.BufferLocation = m_pIB->GetGPUVirtualAddress();
+	m_View.Format = format;
+	m_View.SizeInBytes = UINT(size);
+
+	// stage initial data
+	return batch.Upload(
+		m_pIB.Get(),
+		0,
+		pInitData,
+		UINT64(size),
+		D3D12_RESOURCE_STATE_INDEX_BUFFER);
+}
+
 // end
 void IndexBuffer::Term()
 {
 	m_pIB.Reset();
 	memset(&m_View, 0, sizeof(m_View)); // fill the memory with 0
+	m_IsStatic = false;
 }
 
 // mapping memory
 uint32_t* IndexBuffer::Map()
 {
+	if (m_IsStatic)
+	{
+		return nullptr;
+	}
+
 	uint32_t* ptr;
 	auto hr = m_pIB->Map(0, nullptr, reinterpret_cast<void**>(&ptr));
 	if (FAILED(hr))
@@ -108,4 +201,10 @@ void IndexBuffer::Unmap()
 D3D12_INDEX_BUFFER_VIEW IndexBuffer::GetView() const
 {
 	return m_View;
+}
+
+// get index format
+DXGI_FORMAT IndexBuffer::GetFormat() const
+{
+	return m_View.Format;
 }
\ No newline at end of file
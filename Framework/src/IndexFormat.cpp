@@ -0,0 +1,120 @@
+#include "IndexFormat.h"
+#include <cassert>
+
+// select index format
+DXGI_FORMAT SelectIndexFormat(size_t vertexCount)
+{
+	return (vertexCount <= MaxVertexCount16) ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+}
+
+// get size of one index
+uint32_t GetIndexStride(DXGI_FORMAT format)
+{
+	return (format == DXGI_FORMAT_R16_UINT) ? uint32_t(sizeof(uint16_t)) : uint32_t(sizeof(uint32_t));
+}
+
+// narrow indices to 16 bits
+void PackIndices16(const std::vector<uint32_t>& indices, std::vector<uint16_t>& result)
+{
+	result.resize(indices.size());
+	for (size_t i = 0; i < indices.size(); ++i)
+	{
+		assert(indices[i] < MaxVertexCount16);
+		result[i] = uint16_t(indices[i]);
+	}
+}
+
+// split a mesh
+void SplitMesh(const ResMesh& mesh, uint32_t maxVertexCount, std::vector<ResMesh>& result)
+{
+	result.clear();
+	if (maxVertexCount < 3 || mesh.Indices.size() < 3)
+	{
+		return;
+	}
+
+	const auto Unused = UINT32_MAX;
+	std::vector<uint32_t> remap(mesh.Vertices.size(), Unused);
+	std::vector<uint32_t> touched;
+
+	ResMesh chunk;
+	chunk.MaterialId = mesh.MaterialId;
+
+	for (size_t t = 0; t + 2 < mesh.Indices.size(); t += 3)
+	{
+		// vertices the triangle adds to the chunk
+		auto added = 0u;
+		for (auto k = 0; k < 3; ++k)
+		{
+			auto v = mesh.Indices[t + k];
+			auto duplicated = false;
+			for (auto j = 0; j < k; ++j)
+			{
+				duplicated |= (mesh.Indices[t + j] == v);
+			}
+
+			if (remap[v] == Unused && !duplicated)
+			{
+				added++;
+			}
+		}
+
+		// close the chunk when the triangle does not fit
+		if (chunk.Vertices.size() + added > maxVertexCount)
+		{
+			result.push_back(std::move(chunk));
+
+			chunk = ResMesh();
+			chunk.MaterialId = mesh.MaterialId;
+
+			for (size_t i = 0; i < touched.size(); ++i)
+			{
+				remap[touched[i]] = Unused;
+			}
+			touched.clear();
+		}
+
+		for (auto k = 0; k < 3; ++k)
+		{
+			auto v = mesh.Indices[t + k];
+			if (remap[v] == Unused)
+			{
+				remap[v] = uint32_t(chunk.Vertices.size());
+				chunk.Vertices.push_back(mesh.Vertices[v]);
+				touched.push_back(v);
+			}
+
+			chunk.Indices.push_back(remap[v]);
+		}
+	}
+
+	if (!chunk.Indices.empty())
+	{
+		result.push_back(std::move(chunk));
+	}
+}
+
+// split every large mesh
+void SplitLargeMeshes(std::vector<ResMesh>& meshes)
+{
+	std::vector<ResMesh> result;
+	result.reserve(meshes.size());
+
+	std::vector<ResMesh> chunks;
+	for (size_t i = 0; i < meshes.size(); ++i)
+	{
+		if (meshes[i].Vertices.size() <= MaxVertexCount16)
+		{
+			result.push_back(std::move(meshes[i]));
+			continue;
+		}
+
+		SplitMesh(meshes[i], MaxVertexCount16, chunks);
+		for (size_t j = 0; j < chunks.size(); ++j)
+		{
+			result.push_back(std::move(chunks[j]));
+		}
+	}
+
+	meshes.swap(result);
+}
@@ -0,0 +1,160 @@
+#include "IntervalPacker.h"
+#include <algorithm>
+
+namespace {
+	// align a value to a power of 2
+	uint64_t AlignUp(uint64_t value, uint64_t alignment)
+	{
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+} // namespace
+
+//
+// IntervalPacker class
+//
+
+// constructor
+IntervalPacker::IntervalPacker()
+	: m_Size(0)
+	, m_UnaliasedSize(0)
+{
+}
+
+// destructor
+IntervalPacker::~IntervalPacker()
+{
+	Reset();
+}
+
+// discard every block
+void IntervalPacker::Reset()
+{
+	m_Blocks.clear();
+	m_Size = 0;
+	m_UnaliasedSize = 0;
+}
+
+// add a block
+uint32_t IntervalPacker::Add(uint32_t first, uint32_t last, uint64_t size, uint64_t alignment)
+{
+	if (first > last || size == 0 || alignment == 0 || (alignment & (alignment - 1)) != 0)
+	{
+		return InvalidId;
+	}
+
+	Block block = {};
+	block.First = first;
+	block.Last = last;
+	block.Size = size;
+	block.Alignment = alignment;
+	block.Offset = 0;
+
+	m_Blocks.push_back(block);
+	return uint32_t(m_Blocks.size() - 1);
+}
+
+// place every block
+void IntervalPacker::Pack()
+{
+	m_Size = 0;
+	m_UnaliasedSize = 0;
+
+	// larger blocks first, so smaller ones fill the gaps between them
+	std::vector<uint32_t> order(m_Blocks.size());
+	for (uint32_t i = 0; i < m_Blocks.size(); ++i)
+	{
+		order[i] = i;
+	}
+
+	std::stable_sort(order.begin(), order.end(), [this](uint32_t lhs, uint32_t rhs)
+	{
+		const auto& a = m_Blocks[lhs];
+		const auto& b = m_Blocks[rhs];
+		if (a.Size != b.Size)
+		{
+			return a.Size > b.Size;
+		}
+		return a.First < b.First;
+	});
+
+	std::vector<uint32_t> live;
+	for (size_t i = 0; i < order.size(); ++i)
+	{
+		auto& block = m_Blocks[order[i]];
+
+		// blocks placed already whose interval overlaps, in offset order
+		live.clear();
+		for (size_t j = 0; j < i; ++j)
+		{
+			const auto& other = m_Blocks[order[j]];
+			if (other.First <= block.Last && block.First <= other.Last)
+			{
+				live.push_back(order[j]);
+			}
+		}
+
+		std::sort(live.begin(), live.end(), [this](uint32_t lhs, uint32_t rhs)
+		{
+			return m_Blocks[lhs].Offset < m_Blocks[rhs].Offset;
+		});
+
+		// take the lowest gap which is large enough
+		uint64_t offset = 0;
+		for (auto id : live)
+		{
+			const auto& other = m_Blocks[id];
+			if (offset + block.Size <= other.Offset)
+			{
+				break;
+			}
+
+			offset = std::max(offset, AlignUp(other.Offset + other.Size, block.Alignment));
+		}
+
+		block.Offset = offset;
+		m_Size = std::max(m_Size, offset + block.Size);
+		m_UnaliasedSize = AlignUp(m_UnaliasedSize, block.Alignment) + block.Size;
+	}
+}
+
+// get offset of a block
+uint64_t IntervalPacker::GetOffset(uint32_t id) const
+{
+	if (id >= m_Blocks.size())
+	{
+		return 0;
+	}
+
+	return m_Blocks[id].Offset;
+}
+
+// check whether two blocks share memory
+bool IntervalPacker::IsOverlapped(uint32_t a, uint32_t b) const
+{
+	if (a >= m_Blocks.size() || b >= m_Blocks.size())
+	{
+		return false;
+	}
+
+	const auto& x = m_Blocks[a];
+	const auto& y = m_Blocks[b];
+	return x.Offset < y.Offset + y.Size && y.Offset < x.Offset + x.Size;
+}
+
+// get size of the memory
+uint64_t IntervalPacker::GetSize() const
+{
+	return m_Size;
+}
+
+// get size without sharing memory
+uint64_t IntervalPacker::GetUnaliasedSize() const
+{
+	return m_UnaliasedSize;
+}
+
+// get block count
+uint32_t IntervalPacker::GetCount() const
+{
+	return uint32_t(m_Blocks.size());
+}
@@ -0,0 +1,74 @@
+#include "LinearAllocator.h"
+
+//
+// LinearAllocator class
+//
+
+// constructor
+LinearAllocator::LinearAllocator()
+	: m_Capacity(0)
+	, m_Offset(0)
+{
+}
+
+// destructor
+LinearAllocator::~LinearAllocator()
+{
+	Term();
+}
+
+// initialize
+bool LinearAllocator::Init(uint64_t capacity)
+{
+	if (capacity == 0 || capacity == InvalidOffset)
+	{
+		return false;
+	}
+
+	m_Capacity = capacity;
+	m_Offset = 0;
+	return true;
+}
+
+// end
+void LinearAllocator::Term()
+{
+	m_Capacity = 0;
+	m_Offset = 0;
+}
+
+// allocate
+uint64_t LinearAllocator::Alloc(uint64_t size, uint64_t alignment)
+{
+	if (size == 0 || alignment == 0 || (alignment & (alignment - 1)) != 0)
+	{
+		return InvalidOffset;
+	}
+
+	auto offset = (m_Offset + (alignment - 1)) & ~(alignment - 1); // round up to alignment
+	if (offset < m_Offset || offset > m_Capacity || size > m_Capacity - offset)
+	{
+		return InvalidOffset;
+	}
+
+	m_Offset = offset + size;
+	return offset;
+}
+
+// release every allocation
+void LinearAllocator::Reset()
+{
+	m_Offset = 0;
+}
+
+// get size of the range
+uint64_t LinearAllocator::GetCapacity() const
+{
+	return m_Capacity;
+}
+
+// get used size
+uint64_t LinearAllocator::GetUsedSize() const
+{
+	return m_Offset;
+}
@@ -0,0 +1,105 @@
+#include "MappedFile.h"
+
+//
+// MappedFile class
+//
+
+// constructor
+MappedFile::MappedFile()
+	: m_hFile(INVALID_HANDLE_VALUE)
+	, m_hMapping(nullptr)
+	, m_pData(nullptr)
+	, m_Size(0)
+{
+}
+
+// destructor
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+// open and map a file
+bool MappedFile::Open(const wchar_t* filename)
+{
+	Close();
+
+	if (filename == nullptr)
+	{
+		return false;
+	}
+
+	m_hFile = CreateFileW(
+		filename,
+		GENERIC_READ,
+		FILE_SHARE_READ,
+		nullptr,
+		OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+		nullptr);
+	if (m_hFile == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER size = {};
+	if (!GetFileSizeEx(m_hFile, &size) || size.QuadPart == 0)
+	{
+		Close();
+		return false;
+	}
+
+	m_hMapping = CreateFileMappingW(m_hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (m_hMapping == nullptr)
+	{
+		Close();
+		return false;
+	}
+
+	m_pData = static_cast<const uint8_t*>(MapViewOfFile(m_hMapping, FILE_MAP_READ, 0, 0, 0));
+	if (m_pData == nullptr)
+	{
+		Close();
+		return false;
+	}
+
+	m_Size = size_t(size.QuadPart);
+
+	return true;
+}
+
+// unmap and close
+void MappedFile::Close()
+{
+	if (m_pData != nullptr)
+	{
+		UnmapViewOfFile(m_pData);
+		m_pData = nullptr;
+	}
+
+	if (m_hMapping != nullptr)
+	{
+		CloseHandle(m_hMapping);
+		m_hMapping = nullptr;
+	}
+
+	if (m_hFile != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(m_hFile);
+		m_hFile = INVALID_HANDLE_VALUE;
+	}
+
+	m_Size = 0;
+}
+
+// get mapped data
+const uint8_t* MappedFile::GetData() const
+{
+	return m_pData;
+}
+
+// get size of the file
+size_t MappedFile::GetSize() const
+{
+	return m_Size;
+}
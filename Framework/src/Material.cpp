@@ -1,10 +1,37 @@
 #include "Material.h"
+#include "DeferredReleaseQueue.h"
 #include "FileUtil.h"
+#include "FrameUploadAllocator.h"
 #include "Logger.h"
+#include "MappedFile.h"
+#include "MipStreamer.h"
+#include <cstring>
 
 namespace {
 	// Constant values.
 	constexpr wchar_t* DummyTag = L"";
+
+	// get slot in the texture table, or -1 if the usage is not part of the table
+	int GetTableSlot(Material::TEXTURE_USAGE usage)
+	{
+		switch (usage)
+		{
+		case Material::TEXTURE_USAGE_BASE_COLOR:
+			return 0;
+
+		case Material::TEXTURE_USAGE_METALLIC:
+			return 1;
+
+		case Material::TEXTURE_USAGE_ROUGHNESS:
+			return 2;
+
+		case Material::TEXTURE_USAGE_NORMAL:
+			return 3;
+
+		default:
+			return -1;
+		}
+	}
 }// namespace
 
 //
@@ -13,8 +40,10 @@ namespace {
 
 // constructor
 Material::Material()
-	: m_pDevice(nullptr)
+	: m_pMipStreamer(nullptr)
+	, m_pDevice(nullptr)
 	, m_pPool(nullptr)
+	, m_pReleaseQueue(nullptr)
 {
 }
 
@@ -29,6 +58,7 @@ bool Material::Init
 (
 	ID3D12Device* pDevice,
 	DescriptorPool* pPool,
+	DeferredReleaseQueue* pReleaseQueue,
 	size_t bufferSize,
 	size_t count
 )
@@ -47,6 +77,8 @@ bool Material::Init
 	m_pPool = pPool;
 	m_pPool->AddRef();
 
+	m_pReleaseQueue = pReleaseQueue;
+
 	m_Subset.resize(count);
 
 	// generate Dummy Texture
@@ -84,6 +116,36 @@ bool Material::Init
 		m_pTexture[DummyTag] = pTexture;
 	}
 
+	// allocate texture table, filled with the dummy texture
+	for (size_t i = 0; i < m_Subset.size(); ++i)
+	{
+		m_Subset[i].pConstantBuffer = nullptr;
+		m_Subset[i].IsTableDirty = false;
+		for (auto j = 0; j < TEXTURE_USAGE_COUNT; ++j)
+		{
+			m_Subset[i].pStreamingTexture[j] = nullptr;
+			m_Subset[i].pTexture[j] = m_pTexture[DummyTag];
+		}
+
+		m_Subset[i].pTable = pPool->AllocRange(TextureTableSize);
+		if (m_Subset[i].pTable == nullptr)
+		{
+			continue;
+		}
+
+		for (auto j = 0u; j < TextureTableSize; ++j)
+		{
+			m_pTexture[DummyTag]->CreateView(pDevice, m_Subset[i].pTable->GetHandleCPU(j));
+		}
+	}
+
+	// generate index table for bindless drawing, filled with the dummy texture. it is copied
+	// to the upload memory of each frame by PushIndexTable()
+	if (!m_IndexTable.Init(count, pPool->GetIndex(m_pTexture[DummyTag]->GetHandleGPU())))
+	{
+		return false;
+	}
+
 	auto size = bufferSize * count;
 	if (size > 0)
 	{
@@ -126,15 +188,37 @@ bool Material::Init
 // end
 void Material::Term()
 {
+	if (m_pMipStreamer != nullptr)
+	{
+		// a shared texture is released with its last path
+		for (auto& itr : m_pStreamingTexture)
+		{
+			if (m_StreamingCache.Release(itr.second))
+			{
+				m_pMipStreamer->Release(itr.second);
+			}
+		}
+		m_pMipStreamer = nullptr;
+	}
+	m_pStreamingTexture.clear();
+	m_StreamingCache.Clear();
+
 	for (auto& itr : m_pTexture)
 	{
 		if (itr.second != nullptr) // means texture in itr
 		{
-			itr.second->Term();
-			delete itr.second;
+			// the dummy texture is not shared
+			if (itr.first == DummyTag || m_TextureCache.Release(itr.second))
+			{
+				itr.second->Term();
+				delete itr.second;
+			}
 			itr.second = nullptr;
 		}
 	}
+	m_TextureCache.Clear();
+	m_Manifest.Clear();
+	m_KeyTable.Clear();
 
 	for (size_t i = 0; i < m_Subset.size(); ++i)
 	{
@@ -144,8 +228,15 @@ void Material::Term()
 			delete m_Subset[i].pConstantBuffer;
 			m_Subset[i].pConstantBuffer = nullptr;
 		}
+
+		if (m_Subset[i].pTable != nullptr && m_pPool != nullptr)
+		{
+			m_pPool->FreeRange(m_Subset[i].pTable);
+		}
 	}
 
+	m_IndexTable.Term();
+
 	m_pTexture.clear();
 	m_Subset.clear();
 
@@ -160,8 +251,25 @@ void Material::Term()
 		m_pPool->Release();
 		m_pPool = nullptr;
 	}
+
+	m_pReleaseQueue = nullptr;
+}
+
+// load hashes of texture files from a cooked manifest
+bool Material::SetTextureManifest(const wchar_t* filename)
+{
+	std::vector<TextureManifestEntry> entries;
+	if (!LoadTextureManifest(filename, entries))
+	{
+		m_Manifest.Clear();
+		return false;
+	}
+
+	m_Manifest.SetEntries(entries);
+	return true;
 }
 
+// set texture
 bool Material::SetTexture
 (
 	size_t index,
@@ -179,7 +287,7 @@ bool Material::SetTexture
 	// check whether it has been already applied
 	if (m_pTexture.find(path) != m_pTexture.end())
 	{
-		m_Subset[index].TextureHandle[usage] = m_pTexture[path]->GetHandleGPU();
+		ApplyTexture(index, usage, m_pTexture[path]);
 		return true;
 	}
 
@@ -188,7 +296,7 @@ bool Material::SetTexture
 	if (!SearchFilePathW(path.c_str(), findPath))
 	{
 		// set dummy texture in case filepath does not exist
-		m_Subset[index].TextureHandle[usage] = m_pTexture[DummyTag]->GetHandleGPU();
+		ApplyTexture(index, usage, m_pTexture[DummyTag]);
 		return true;
 	}
 
@@ -196,11 +304,28 @@ bool Material::SetTexture
 	{
 		if (PathIsDirectoryW(findPath.c_str()) != FALSE)
 		{
-			m_Subset[index].TextureHandle[usage] = m_pTexture[DummyTag]->GetHandleGPU();
+			ApplyTexture(index, usage, m_pTexture[DummyTag]);
 			return true;
 		}
 	}
 
+	auto isSRGB = (TU_BASE_COLOR == usage) || (TU_DIFFUSE == usage) || (TU_SPECULAR == usage);
+
+	// a file identical to one already loaded shares its texture
+	TextureKey key;
+	if (!GetTextureKey(path, findPath, isSRGB, key))
+	{
+		return false;
+	}
+
+	auto pShared = m_TextureCache.Acquire(key);
+	if (pShared != nullptr)
+	{
+		m_pTexture[path] = pShared;
+		ApplyTexture(index, usage, pShared);
+		return true;
+	}
+
 	// generate instance
 	auto pTexture = new (std::nothrow) Texture();
 	if (pTexture == nullptr)
@@ -209,8 +334,6 @@ bool Material::SetTexture
 		return false;
 	}
 
-	auto isSRGB = (TU_BASE_COLOR == usage) || (TU_DIFFUSE == usage) || (TU_SPECULAR == usage);
-
 	// initialize
 	if (!pTexture->Init(m_pDevice, m_pPool, findPath.c_str(), isSRGB, batch))
 	{
@@ -221,12 +344,270 @@ bool Material::SetTexture
 	}
 
 	// apply
+	m_TextureCache.Add(key, pTexture);
 	m_pTexture[path] = pTexture;
+	ApplyTexture(index, usage, pTexture);
+
+	return true;
+}
+
+// set texture whose mips are streamed
+bool Material::SetTexture
+(
+	size_t index,
+	TEXTURE_USAGE usage,
+	const std::wstring& path,
+	MipStreamer& streamer
+)
+{
+	// check whether it is in range
+	if (index >= GetCount())
+	{
+		return false;
+	}
+
+	// check whether it has been already applied
+	auto itr = m_pStreamingTexture.find(path);
+	if (itr != m_pStreamingTexture.end())
+	{
+		ApplyTexture(index, usage, itr->second);
+		return true;
+	}
+
+	// check whether filepath exists
+	std::wstring findPath;
+	if (!SearchFilePathW(path.c_str(), findPath) || PathIsDirectoryW(findPath.c_str()) != FALSE)
+	{
+		ApplyTexture(index, usage, m_pTexture[DummyTag]);
+		return true;
+	}
+
+	auto isSRGB = (TU_BASE_COLOR == usage) || (TU_DIFFUSE == usage) || (TU_SPECULAR == usage);
+
+	// a file identical to one already streamed shares its texture
+	TextureKey key;
+	if (!GetTextureKey(path, findPath, isSRGB, key))
+	{
+		return false;
+	}
+
+	auto pShared = m_StreamingCache.Acquire(key);
+	if (pShared != nullptr)
+	{
+		m_pStreamingTexture[path] = pShared;
+		ApplyTexture(index, usage, pShared);
+		return true;
+	}
+
+	auto pTexture = streamer.Load(findPath.c_str(), isSRGB, [this](StreamingTexture* pChanged)
+	{
+		OnMipsChanged(pChanged);
+	});
+	if (pTexture == nullptr)
+	{
+		ELOG("Error : MipStreamer::Load() Failed. filepath = %ls", findPath.c_str());
+		return false;
+	}
+
+	m_pMipStreamer = &streamer;
+	m_StreamingCache.Add(key, pTexture);
+	m_pStreamingTexture[path] = pTexture;
+	ApplyTexture(index, usage, pTexture);
+
+	return true;
+}
+
+// write texture tables of the materials whose textures have changed
+void Material::Update()
+{
+	for (size_t i = 0; i < m_Subset.size(); ++i)
+	{
+		// a table which could not be written is retried next frame
+		if (m_Subset[i].IsTableDirty && WriteTable(i))
+		{
+			m_Subset[i].IsTableDirty = false;
+		}
+	}
+}
+
+// request mips of the streamed textures of a material
+void Material::RequestMips(size_t index, float screenSize)
+{
+	if (index >= GetCount() || m_pMipStreamer == nullptr)
+	{
+		return;
+	}
+
+	for (auto i = 0; i < TEXTURE_USAGE_COUNT; ++i)
+	{
+		if (m_Subset[index].pStreamingTexture[i] != nullptr)
+		{
+			m_pMipStreamer->Request(m_Subset[index].pStreamingTexture[i], screenSize);
+		}
+	}
+}
+
+// get key of a texture file
+bool Material::GetTextureKey
+(
+	const std::wstring& path,
+	const std::wstring& findPath,
+	bool isSRGB,
+	TextureKey& key
+)
+{
+	// a cooked manifest saves reading the file
+	if (m_Manifest.Find(path, isSRGB, key))
+	{
+		return true;
+	}
+
+	MappedFile file;
+	if (!file.Open(findPath.c_str()))
+	{
+		ELOG("Error : File Not Found. filepath = %ls", findPath.c_str());
+		return false;
+	}
+
+	// only the first page is read, unless another file starts the same way
+	auto hashFile = [&](const std::wstring& filePath, uint64_t& hash)
+	{
+		if (filePath == findPath)
+		{
+			hash = ComputeTextureKey(file.GetData(), file.GetSize(), isSRGB).Hash;
+			return true;
+		}
+
+		MappedFile other;
+		if (!other.Open(filePath.c_str()))
+		{
+			ELOG("Error : File Not Found. filepath = %ls", filePath.c_str());
+			return false;
+		}
+
+		hash = ComputeTextureKey(other.GetData(), other.GetSize(), isSRGB).Hash;
+		return true;
+	};
+
+	return m_KeyTable.Find(findPath, file.GetData(), file.GetSize(), isSRGB, hashFile, key);
+}
+
+// update heap index of a texture in the index table
+void Material::SetTableIndex(size_t index, uint32_t slot, D3D12_GPU_DESCRIPTOR_HANDLE handle)
+{
+	// frames in flight read their own copy, so only the CPU side changes here
+	m_IndexTable.SetTexture(index, slot, m_pPool->GetIndex(handle));
+}
+
+// bind texture to the subset
+void Material::ApplyTexture(size_t index, TEXTURE_USAGE usage, Texture* pTexture)
+{
 	m_Subset[index].TextureHandle[usage] = pTexture->GetHandleGPU();
+	m_Subset[index].pStreamingTexture[usage] = nullptr;
+	m_Subset[index].pTexture[usage] = pTexture;
+
+	// the texture table is written by Update()
+	auto slot = GetTableSlot(usage);
+	if (slot >= 0)
+	{
+		m_Subset[index].IsTableDirty = true;
+		SetTableIndex(index, uint32_t(slot), pTexture->GetHandleGPU());
+	}
+}
+
+// bind texture whose mips are streamed to the subset
+void Material::ApplyTexture(size_t index, TEXTURE_USAGE usage, StreamingTexture* pTexture)
+{
+	if (!pTexture->IsResident())
+	{
+		// the dummy texture stands in until the mip tail is resident
+		ApplyTexture(index, usage, m_pTexture[DummyTag]);
+	}
+	else
+	{
+		m_Subset[index].TextureHandle[usage] = pTexture->GetHandleGPU();
+		m_Subset[index].pTexture[usage] = nullptr;
+
+		auto slot = GetTableSlot(usage);
+		if (slot >= 0)
+		{
+			m_Subset[index].IsTableDirty = true;
+			SetTableIndex(index, uint32_t(slot), pTexture->GetHandleGPU());
+		}
+	}
 
+	m_Subset[index].pStreamingTexture[usage] = pTexture;
+}
+
+// write the texture table of a subset to a new range
+bool Material::WriteTable(size_t index)
+{
+	auto& subset = m_Subset[index];
+	if (subset.pTable == nullptr)
+	{
+		return true;
+	}
+
+	// frames in flight may still read the old table, so it is never written in place
+	auto pTable = m_pPool->AllocRange(TextureTableSize);
+	if (pTable == nullptr)
+	{
+		return false;
+	}
+
+	for (auto i = 0; i < TEXTURE_USAGE_COUNT; ++i)
+	{
+		auto slot = GetTableSlot(TEXTURE_USAGE(i));
+		if (slot < 0)
+		{
+			continue;
+		}
+
+		auto handle = pTable->GetHandleCPU(uint32_t(slot));
+		if (subset.pStreamingTexture[i] != nullptr && subset.pTexture[i] == nullptr)
+		{
+			subset.pStreamingTexture[i]->CreateView(m_pDevice, handle);
+		}
+		else
+		{
+			subset.pTexture[i]->CreateView(m_pDevice, handle);
+		}
+	}
+
+	// the old range is freed at once if the queue does not take it
+	auto pPool = m_pPool;
+	auto pOld = subset.pTable;
+	pPool->AddRef();
+	auto queued = m_pReleaseQueue != nullptr && m_pReleaseQueue->PushCallback([pPool, pOld]() mutable
+	{
+		pPool->FreeRange(pOld);
+		pPool->Release();
+	});
+	if (!queued)
+	{
+		pPool->FreeRange(pOld);
+		pPool->Release();
+	}
+
+	subset.pTable = pTable;
 	return true;
 }
 
+// rebind a texture whose resident mips have changed
+void Material::OnMipsChanged(StreamingTexture* pTexture)
+{
+	for (size_t i = 0; i < m_Subset.size(); ++i)
+	{
+		for (auto j = 0; j < TEXTURE_USAGE_COUNT; ++j)
+		{
+			if (m_Subset[i].pStreamingTexture[j] == pTexture)
+			{
+				ApplyTexture(i, TEXTURE_USAGE(j), pTexture);
+			}
+		}
+	}
+}
+
 // get the pointer of constant buffer
 void* Material::GetBufferPtr(size_t index) const
 {
@@ -271,8 +652,43 @@ D3D12_GPU_DESCRIPTOR_HANDLE Material::GetTextureHandle(size_t index, TEXTURE_USA
 	return m_Subset[index].TextureHandle[usage];
 }
 
+// get texture table handle
+D3D12_GPU_DESCRIPTOR_HANDLE Material::GetTableHandle(size_t index) const
+{
+	if (index >= GetCount() || m_Subset[index].pTable == nullptr)
+	{
+		return D3D12_GPU_DESCRIPTOR_HANDLE();
+	}
+
+	return m_Subset[index].pTable->HandleGPU;
+}
+
+// copy the material index table to the memory of the current frame
+D3D12_GPU_VIRTUAL_ADDRESS Material::PushIndexTable(FrameUploadAllocator& allocator) const
+{
+	if (m_IndexTable.GetCount() == 0)
+	{
+		return D3D12_GPU_VIRTUAL_ADDRESS();
+	}
+
+	auto allocation = allocator.Alloc(m_IndexTable.GetSize());
+	if (!allocation.IsValid())
+	{
+		return D3D12_GPU_VIRTUAL_ADDRESS();
+	}
+
+	memcpy(allocation.pCPU, m_IndexTable.GetData(), m_IndexTable.GetSize());
+	return allocation.AddressGPU;
+}
+
 // get material count
 size_t Material::GetCount() const
 {
 	return m_Subset.size();
+}
+
+// get bytes saved by sharing textures
+uint64_t Material::GetSavedTextureBytes() const
+{
+	return m_TextureCache.GetSavedBytes() + m_StreamingCache.GetSavedBytes();
 }
\ No newline at end of file
@@ -0,0 +1,115 @@
+#include "MaterialTable.h"
+
+//
+// MaterialTable class
+//
+
+// constructor
+MaterialTable::MaterialTable()
+	: m_DefaultIndex(0)
+{
+}
+
+// destructor
+MaterialTable::~MaterialTable()
+{
+	Term();
+}
+
+// initialize
+bool MaterialTable::Init(size_t count, uint32_t defaultIndex)
+{
+	if (count == 0)
+	{
+		return false;
+	}
+
+	Term();
+
+	MaterialIndices entry = { defaultIndex, defaultIndex, defaultIndex, defaultIndex };
+	m_Entries.resize(count, entry);
+	m_DefaultIndex = defaultIndex;
+
+	return true;
+}
+
+// end
+void MaterialTable::Term()
+{
+	m_Entries.clear();
+	m_DefaultIndex = 0;
+}
+
+// set texture of a material
+bool MaterialTable::SetTexture(size_t index, uint32_t slot, uint32_t descriptorIndex)
+{
+	if (index >= m_Entries.size() || slot >= SlotCount)
+	{
+		return false;
+	}
+
+	auto& entry = m_Entries[index];
+	switch (slot)
+	{
+	case 0:
+		entry.BaseColor = descriptorIndex;
+		break;
+
+	case 1:
+		entry.Metallic = descriptorIndex;
+		break;
+
+	case 2:
+		entry.Roughness = descriptorIndex;
+		break;
+
+	default:
+		entry.Normal = descriptorIndex;
+		break;
+	}
+
+	return true;
+}
+
+// get texture of a material
+uint32_t MaterialTable::GetTexture(size_t index, uint32_t slot) const
+{
+	if (index >= m_Entries.size() || slot >= SlotCount)
+	{
+		return m_DefaultIndex;
+	}
+
+	const auto& entry = m_Entries[index];
+	switch (slot)
+	{
+	case 0:
+		return entry.BaseColor;
+
+	case 1:
+		return entry.Metallic;
+
+	case 2:
+		return entry.Roughness;
+
+	default:
+		return entry.Normal;
+	}
+}
+
+// get entries
+const MaterialIndices* MaterialTable::GetData() const
+{
+	return m_Entries.data();
+}
+
+// get material count
+size_t MaterialTable::GetCount() const
+{
+	return m_Entries.size();
+}
+
+// get size of the entries
+size_t MaterialTable::GetSize() const
+{
+	return m_Entries.size() * sizeof(MaterialIndices);
+}
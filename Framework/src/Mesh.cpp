@@ -1,4 +1,5 @@
 #include "Mesh.h"
+#include "IndexFormat.h"
 
 //
 // Mesh class
@@ -6,9 +7,13 @@
 
 // constructor
 Mesh::Mesh()
-	: m_MaterialId(UINT32_MAX)
+	: m_pArena(nullptr)
+	, m_pAllocation(nullptr)
+	, m_MaterialId(UINT32_MAX)
 	, m_IndexCount(0)
 {
+	m_Quantization.Offset = DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f);
+	m_Quantization.Scale = DirectX::XMFLOAT3(1.0f, 1.0f, 1.0f);
 }
 
 // destructor
@@ -30,7 +35,16 @@ bool Mesh::Init(ID3D12Device* pDevice, const ResMesh& resource)
 	{
 		return false;
 	}
-	if (!m_IB.Init(
+	if (SelectIndexFormat(resource.Vertices.size()) == DXGI_FORMAT_R16_UINT)
+	{
+		std::vector<uint16_t> indices;
+		PackIndices16(resource.Indices, indices);
+		if (!m_IB.Init(pDevice, sizeof(uint16_t) * indices.size(), indices.data()))
+		{
+			return false;
+		}
+	}
+	else if (!m_IB.Init(
 		pDevice, sizeof(uint32_t) * resource.Indices.size(), resource.Indices.data()))
 	{
 		return false;
@@ -42,18 +56,126 @@ bool Mesh::Init(ID3D12Device* pDevice, const ResMesh& resource)
 	return true;
 }
 
+// initialize as static geometry
+bool Mesh::Init(BufferUploadBatch& batch, const ResMesh& resource)
+{
+	if (!m_VB.Init(
+		batch, sizeof(MeshVertex) * resource.Vertices.size(), resource.Vertices.data()))
+	{
+		return false;
+	}
+	if (SelectIndexFormat(resource.Vertices.size()) == DXGI_FORMAT_R16_UINT)
+	{
+		std::vector<uint16_t> indices;
+		PackIndices16(resource.Indices, indices);
+		if (!m_IB.Init(batch, sizeof(uint16_t) * indices.size(), indices.data()))
+		{
+			return false;
+		}
+	}
+	else if (!m_IB.Init(
+		batch, sizeof(uint32_t) * resource.Indices.size(), resource.Indices.data()))
+	{
+		return false;
+	}
+
+	m_MaterialId = resource.MaterialId;
+	m_IndexCount = uint32_t(resource.Indices.size());
+
+	return true;
+}
+
+// initialize in a shared geometry arena
+bool Mesh::Init(GeometryArena& arena, BufferUploadBatch& batch, const ResMesh& resource)
+{
+	return Init(arena, batch, resource, VERTEX_FORMAT_FULL);
+}
+
+// initialize in a shared geometry arena with an encoded vertex format
+bool Mesh::Init
+(
+	GeometryArena& arena,
+	BufferUploadBatch& batch,
+	const ResMesh& resource,
+	VERTEX_FORMAT format
+)
+{
+	std::vector<uint8_t> vertices;
+	EncodeVertices(format, resource.Vertices, vertices, m_Quantization);
+
+	m_pAllocation = arena.Alloc(
+		batch,
+		vertices.data(),
+		uint32_t(resource.Vertices.size()),
+		resource.Indices.data(),
+		uint32_t(resource.Indices.size()));
+	if (m_pAllocation == nullptr)
+	{
+		return false;
+	}
+
+	m_pArena = &arena;
+	m_MaterialId = resource.MaterialId;
+	m_IndexCount = uint32_t(resource.Indices.size());
+
+	return true;
+}
+
+// initialize in a shared geometry arena with a cooked mesh
+bool Mesh::Init(GeometryArena& arena, BufferUploadBatch& batch, const CookedMesh& mesh)
+{
+	m_pAllocation = arena.Alloc(
+		batch,
+		mesh.pVertices,
+		mesh.VertexCount,
+		mesh.pIndices,
+		mesh.IndexFormat,
+		mesh.IndexCount);
+	if (m_pAllocation == nullptr)
+	{
+		return false;
+	}
+
+	m_pArena = &arena;
+	m_MaterialId = mesh.MaterialId;
+	m_IndexCount = mesh.IndexCount;
+	m_Quantization = mesh.Quantization;
+
+	return true;
+}
+
 // end
 void Mesh::Term()
 {
+	if (m_pArena != nullptr)
+	{
+		m_pArena->Free(m_pAllocation);
+		m_pArena = nullptr;
+	}
+
 	m_VB.Term();
 	m_IB.Term();
 	m_MaterialId = UINT32_MAX;
 	m_IndexCount = 0;
+	m_Quantization.Offset = DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f);
+	m_Quantization.Scale = DirectX::XMFLOAT3(1.0f, 1.0f, 1.0f);
 }
 
 // draw
 void Mesh::Draw(ID3D12GraphicsCommandList* pCmdList)
 {
+	// buffers of the arena are bound once for every mesh in it
+	if (m_pAllocation != nullptr)
+	{
+		pCmdList->DrawIndexedInstanced(
+			m_IndexCount,
+			1,
+			m_pAllocation->FirstIndex,
+			INT(m_pAllocation->BaseVertex),
+			0);
+		return;
+	}
+
 	auto VBV = m_VB.GetView();
 	auto IBV = m_IB.GetView();
 	pCmdList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
@@ -67,3 +189,20 @@ uint32_t Mesh::GetMaterialId() const
 {
 	return m_MaterialId;
 }
+
+// get index format
+DXGI_FORMAT Mesh::GetIndexFormat() const
+{
+	if (m_pAllocation != nullptr)
+	{
+		return m_pAllocation->IndexFormat;
+	}
+
+	return m_IB.GetFormat();
+}
+
+// get dequantization of positions
+const VertexQuantization& Mesh::GetQuantization() const
+{
+	return m_Quantization;
+}
@@ -0,0 +1,643 @@
+#include "MeshCache.h"
+#include "IndexFormat.h"
+#include "Hash.h"
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+
+namespace {
+
+	// "MSHC"
+	const uint32_t MeshCacheMagic = 0x4348534d;
+
+	// alignment of vertex and index blobs
+	const size_t BlobAlignment = 16;
+
+	//
+	// MeshCacheHeader structure
+	//
+	struct MeshCacheHeader
+	{
+		uint32_t Magic; // MeshCacheMagic
+		uint32_t Version; // MeshCacheVersion
+		uint64_t Key; // key of the source
+		uint32_t MeshCount; // mesh count
+		uint32_t MaterialCount; // material count
+		uint32_t VertexFormat; // VERTEX_FORMAT of the vertices
+		uint32_t VertexStride; // GetVertexStride() of the format
+		uint64_t Size; // size of the whole file
+	};
+
+	//
+	// MeshCacheEntry structure
+	//
+	struct MeshCacheEntry
+	{
+		uint64_t VertexOffset; // offset of vertices from the top of the file
+		uint64_t IndexOffset; // offset of indices from the top of the file
+		uint32_t VertexCount; // vertex count
+		uint32_t IndexCount; // index count
+		uint32_t MaterialId; // material id
+		uint32_t IndexStride; // 2 or 4
+		VertexQuantization Quantization; // dequantization of positions
+		DirectX::XMFLOAT4 Bounds; // bounding sphere
+	};
+
+	//
+	// MeshCacheMaterial structure
+	//
+	struct MeshCacheMaterial
+	{
+		DirectX::XMFLOAT3 Diffuse; // diffuse
+		DirectX::XMFLOAT3 Specular; // specular
+		float Alpha; // alpha
+		float Shininess; // shininess
+	};
+
+	// round up to the alignment
+	size_t AlignUp(size_t value, size_t alignment)
+	{
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+
+	// bounding sphere of the AABB of the vertices
+	DirectX::XMFLOAT4 ComputeBounds(const std::vector<MeshVertex>& vertices)
+	{
+		if (vertices.empty())
+		{
+			return DirectX::XMFLOAT4(0.0f, 0.0f, 0.0f, 0.0f);
+		}
+
+		auto minPos = DirectX::XMFLOAT3(FLT_MAX, FLT_MAX, FLT_MAX);
+		auto maxPos = DirectX::XMFLOAT3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+		for (const auto& vertex : vertices)
+		{
+			const auto& p = vertex.Position;
+			minPos.x = std::min(minPos.x, p.x);
+			minPos.y = std::min(minPos.y, p.y);
+			minPos.z = std::min(minPos.z, p.z);
+			maxPos.x = std::max(maxPos.x, p.x);
+			maxPos.y = std::max(maxPos.y, p.y);
+			maxPos.z = std::max(maxPos.z, p.z);
+		}
+
+		auto dx = maxPos.x - minPos.x;
+		auto dy = maxPos.y - minPos.y;
+		auto dz = maxPos.z - minPos.z;
+		return DirectX::XMFLOAT4(
+			(minPos.x + maxPos.x) * 0.5f,
+			(minPos.y + maxPos.y) * 0.5f,
+			(minPos.z + maxPos.z) * 0.5f,
+			std::sqrt(dx * dx + dy * dy + dz * dz) * 0.5f);
+	}
+
+	// append raw bytes
+	void Write(std::vector<uint8_t>& dst, const void* pData, size_t size)
+	{
+		auto offset = dst.size();
+		dst.resize(offset + size);
+		if (size > 0)
+		{
+			memcpy(dst.data() + offset, pData, size);
+		}
+	}
+
+	// append a string as UTF-16 code units
+	void WriteString(std::vector<uint8_t>& dst, const std::wstring& value)
+	{
+		auto length = uint32_t(value.size());
+		Write(dst, &length, sizeof(length));
+		for (size_t i = 0; i < value.size(); ++i)
+		{
+			auto c = uint16_t(value[i]);
+			Write(dst, &c, sizeof(c));
+		}
+	}
+
+	//
+	// Reader class
+	//
+	class Reader
+	{
+	public:
+		Reader(const uint8_t* pData, size_t size)
+			: m_pData(pData)
+			, m_Size(size)
+			, m_Offset(0)
+		{
+			// Do Nothing//
+		}
+
+		bool Read(void* pDst, size_t size)
+		{
+			if (size > m_Size - m_Offset)
+			{
+				return false;
+			}
+
+			if (size > 0)
+			{
+				memcpy(pDst, m_pData + m_Offset, size);
+				m_Offset += size;
+			}
+			return true;
+		}
+
+		bool ReadString(std::wstring& value)
+		{
+			uint32_t length = 0;
+			if (!Read(&length, sizeof(length)) || length > (m_Size - m_Offset) / sizeof(uint16_t))
+			{
+				return false;
+			}
+
+			value.resize(length);
+			for (uint32_t i = 0; i < length; ++i)
+			{
+				uint16_t c = 0;
+				Read(&c, sizeof(c));
+				value[i] = wchar_t(c);
+			}
+
+			return true;
+		}
+
+	private:
+		const uint8_t* m_pData;
+		size_t m_Size;
+		size_t m_Offset;
+	};
+
+	// directory part of a path, with its trailing separator
+	std::wstring GetDirectory(const std::wstring& path)
+	{
+		auto pos = path.find_last_of(L"/\\");
+		return (pos == std::wstring::npos) ? std::wstring() : path.substr(0, pos + 1);
+	}
+
+	// resolve a path written in a text file against the directory of that file
+	std::wstring ResolvePath(const std::wstring& directory, const std::string& path)
+	{
+		std::wstring result(path.begin(), path.end());
+		auto isAbsolute = (!result.empty() && (result[0] == L'/' || result[0] == L'\\'))
+			|| (result.size() > 1 && result[1] == L':');
+		return isAbsolute ? result : directory + result;
+	}
+
+	// call func with the whitespace separated tokens of each line of a text file
+	template<typename Func>
+	void ForEachLine(const void* pData, size_t size, Func func)
+	{
+		auto pText = static_cast<const char*>(pData);
+		std::vector<std::string> tokens;
+		size_t pos = 0;
+		while (pos < size)
+		{
+			tokens.clear();
+			while (pos < size && pText[pos] != '\n')
+			{
+				if (pText[pos] == ' ' || pText[pos] == '\t' || pText[pos] == '\r')
+				{
+					pos++;
+					continue;
+				}
+
+				auto begin = pos;
+				while (pos < size && pText[pos] != ' ' && pText[pos] != '\t' && pText[pos] != '\r' && pText[pos] != '\n')
+				{
+					pos++;
+				}
+				tokens.push_back(std::string(pText + begin, pText + pos));
+			}
+			pos++;
+
+			if (!tokens.empty())
+			{
+				func(tokens);
+			}
+		}
+	}
+
+	// whether a material statement refers to a texture
+	bool IsTextureStatement(const std::string& keyword)
+	{
+		return keyword.compare(0, 4, "map_") == 0
+			|| keyword == "bump"
+			|| keyword == "disp"
+			|| keyword == "decal"
+			|| keyword == "norm"
+			|| keyword == "refl";
+	}
+
+	// hash the path and contents of a file the source depends on. a missing file hashes
+	// differently from any contents, so creating it later is a change as well
+	uint64_t HashDependency(const std::wstring& path, MappedFile& file, uint64_t hash)
+	{
+		hash = HashBytes(path.data(), path.size() * sizeof(wchar_t), hash);
+
+		if (!file.Open(path.c_str()))
+		{
+			return HashValue(UINT64_MAX, hash);
+		}
+
+		hash = HashValue(uint64_t(file.GetSize()), hash);
+		return HashBytes(file.GetData(), file.GetSize(), hash);
+	}
+
+} // namespace
+
+// compute key of a cooked mesh
+uint64_t ComputeMeshCacheKey
+(
+	const wchar_t* filename,
+	const void* pSource,
+	size_t size,
+	uint32_t importFlags
+)
+{
+	auto hash = HashBytes(pSource, size);
+	hash = HashValue(importFlags, hash);
+	hash = HashValue(MeshCacheVersion, hash);
+
+	if (filename == nullptr || pSource == nullptr)
+	{
+		return hash;
+	}
+
+	// material libraries of the source, and the textures each of them refers to
+	std::vector<std::wstring> libraries;
+	auto directory = GetDirectory(filename);
+	ForEachLine(pSource, size, [&](const std::vector<std::string>& tokens)
+	{
+		if (tokens[0] != "mtllib")
+		{
+			return;
+		}
+
+		for (size_t i = 1; i < tokens.size(); ++i)
+		{
+			libraries.push_back(ResolvePath(directory, tokens[i]));
+		}
+	});
+
+	for (size_t i = 0; i < libraries.size(); ++i)
+	{
+		MappedFile library;
+		hash = HashDependency(libraries[i], library, hash);
+		if (library.GetData() == nullptr)
+		{
+			continue;
+		}
+
+		// options come before the path, so the path is the last token
+		std::vector<std::wstring> textures;
+		auto libraryDirectory = GetDirectory(libraries[i]);
+		ForEachLine(library.GetData(), library.GetSize(), [&](const std::vector<std::string>& tokens)
+		{
+			if (tokens.size() > 1 && IsTextureStatement(tokens[0]))
+			{
+				textures.push_back(ResolvePath(libraryDirectory, tokens.back()));
+			}
+		});
+
+		for (size_t j = 0; j < textures.size(); ++j)
+		{
+			MappedFile texture;
+			hash = HashDependency(textures[j], texture, hash);
+		}
+	}
+
+	return hash;
+}
+
+// get path of the cooked file
+std::wstring GetMeshCachePath(const wchar_t* filename)
+{
+	std::wstring result(filename);
+	result += L".cooked";
+	return result;
+}
+
+// serialize meshes and materials
+void SerializeMeshCache
+(
+	uint64_t key,
+	VERTEX_FORMAT format,
+	const std::vector<ResMesh>& meshes,
+	const std::vector<ResMaterial>& materials,
+	std::vector<uint8_t>& result
+)
+{
+	result.clear();
+
+	MeshCacheHeader header = {};
+	header.Magic = MeshCacheMagic;
+	header.Version = MeshCacheVersion;
+	header.Key = key;
+	header.MeshCount = uint32_t(meshes.size());
+	header.MaterialCount = uint32_t(materials.size());
+	header.VertexFormat = uint32_t(format);
+	header.VertexStride = GetVertexStride(format);
+
+	// encode vertices and narrow indices as the buffers store them
+	std::vector<std::vector<uint8_t>> vertices(meshes.size());
+	std::vector<std::vector<uint16_t>> indices16(meshes.size());
+	std::vector<MeshCacheEntry> entries(meshes.size());
+	for (size_t i = 0; i < meshes.size(); ++i)
+	{
+		const auto& mesh = meshes[i];
+		auto& entry = entries[i];
+		entry.VertexCount = uint32_t(mesh.Vertices.size());
+		entry.IndexCount = uint32_t(mesh.Indices.size());
+		entry.MaterialId = mesh.MaterialId;
+		entry.Bounds = ComputeBounds(mesh.Vertices);
+
+		EncodeVertices(format, mesh.Vertices, vertices[i], entry.Quantization);
+		if (SelectIndexFormat(mesh.Vertices.size()) == DXGI_FORMAT_R16_UINT)
+		{
+			PackIndices16(mesh.Indices, indices16[i]);
+			entry.IndexStride = uint32_t(sizeof(uint16_t));
+		}
+		else
+		{
+			entry.IndexStride = uint32_t(sizeof(uint32_t));
+		}
+	}
+
+	// lay out vertex and index blobs after the mesh table
+	auto offset = sizeof(MeshCacheHeader) + sizeof(MeshCacheEntry) * meshes.size();
+	for (auto& entry : entries)
+	{
+		offset = AlignUp(offset, BlobAlignment);
+		entry.VertexOffset = offset;
+		offset += size_t(header.VertexStride) * entry.VertexCount;
+
+		offset = AlignUp(offset, BlobAlignment);
+		entry.IndexOffset = offset;
+		offset += size_t(entry.IndexStride) * entry.IndexCount;
+	}
+
+	result.reserve(offset);
+	Write(result, &header, sizeof(header));
+	if (!entries.empty())
+	{
+		Write(result, entries.data(), sizeof(MeshCacheEntry) * entries.size());
+	}
+
+	for (size_t i = 0; i < meshes.size(); ++i)
+	{
+		result.resize(size_t(entries[i].VertexOffset), 0);
+		Write(result, vertices[i].data(), vertices[i].size());
+
+		result.resize(size_t(entries[i].IndexOffset), 0);
+		if (entries[i].IndexStride == sizeof(uint16_t))
+		{
+			Write(result, indices16[i].data(), sizeof(uint16_t) * indices16[i].size());
+		}
+		else
+		{
+			Write(result, meshes[i].Indices.data(), sizeof(uint32_t) * meshes[i].Indices.size());
+		}
+	}
+
+	// material table
+	for (size_t i = 0; i < materials.size(); ++i)
+	{
+		MeshCacheMaterial material = {};
+		material.Diffuse = materials[i].Diffuse;
+		material.Specular = materials[i].Specular;
+		material.Alpha = materials[i].Alpha;
+		material.Shininess = materials[i].Shininess;
+		Write(result, &material, sizeof(material));
+
+		WriteString(result, materials[i].DiffuseMap);
+		WriteString(result, materials[i].SpecularMap);
+		WriteString(result, materials[i].ShininessMap);
+		WriteString(result, materials[i].NormalMap);
+	}
+
+	// the size lets a truncated file be rejected
+	auto size = uint64_t(result.size());
+	memcpy(result.data() + offsetof(MeshCacheHeader, Size), &size, sizeof(size));
+}
+
+// write a cooked mesh file
+bool SaveMeshCache(const wchar_t* filename, const std::vector<uint8_t>& data)
+{
+	if (filename == nullptr || data.empty())
+	{
+		return false;
+	}
+
+	// write to a temporary file first, so a reader never sees a half-written cache
+	std::wstring temp(filename);
+	temp += L".tmp";
+
+	auto hFile = CreateFileW(
+		temp.c_str(),
+		GENERIC_WRITE,
+		0,
+		nullptr,
+		CREATE_ALWAYS,
+		FILE_ATTRIBUTE_NORMAL,
+		nullptr);
+	if (hFile == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	DWORD written = 0;
+	auto result = WriteFile(hFile, data.data(), DWORD(data.size()), &written, nullptr) != FALSE;
+	result &= (written == DWORD(data.size()));
+	CloseHandle(hFile);
+
+	if (!result)
+	{
+		DeleteFileW(temp.c_str());
+		return false;
+	}
+
+	if (!MoveFileExW(temp.c_str(), filename, MOVEFILE_REPLACE_EXISTING))
+	{
+		DeleteFileW(temp.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+//
+// MeshCache class
+//
+
+// constructor
+MeshCache::MeshCache()
+{
+}
+
+// destructor
+MeshCache::~MeshCache()
+{
+	Term();
+}
+
+// open a cooked mesh file
+bool MeshCache::Open(const wchar_t* filename, uint64_t key, VERTEX_FORMAT format)
+{
+	Term();
+
+	if (!m_File.Open(filename))
+	{
+		return false;
+	}
+
+	if (!Parse(m_File.GetData(), m_File.GetSize(), key, format))
+	{
+		Term();
+		return false;
+	}
+
+	return true;
+}
+
+// initialize with cooked data in memory
+bool MeshCache::Init(std::vector<uint8_t>& data, uint64_t key, VERTEX_FORMAT format)
+{
+	Term();
+
+	m_Data.swap(data);
+	if (!Parse(m_Data.data(), m_Data.size(), key, format))
+	{
+		Term();
+		return false;
+	}
+
+	return true;
+}
+
+// end
+void MeshCache::Term()
+{
+	m_Meshes.clear();
+	m_Materials.clear();
+	m_Data.clear();
+	m_File.Close();
+}
+
+// get mesh count
+size_t MeshCache::GetMeshCount() const
+{
+	return m_Meshes.size();
+}
+
+// get mesh
+const CookedMesh& MeshCache::GetMesh(size_t index) const
+{
+	assert(index < m_Meshes.size());
+	return m_Meshes[index];
+}
+
+// get materials
+const std::vector<ResMaterial>& MeshCache::GetMaterials() const
+{
+	return m_Materials;
+}
+
+// read the tables of cooked data, pointing the meshes into it
+bool MeshCache::Parse(const uint8_t* pData, size_t size, uint64_t key, VERTEX_FORMAT format)
+{
+	if (pData == nullptr || size < sizeof(MeshCacheHeader))
+	{
+		return false;
+	}
+
+	MeshCacheHeader header;
+	memcpy(&header, pData, sizeof(header));
+	if (header.Magic != MeshCacheMagic
+	 || header.Version != MeshCacheVersion
+	 || header.Key != key
+	 || header.VertexFormat != uint32_t(format)
+	 || header.VertexStride != GetVertexStride(format)
+	 || header.Size != size)
+	{
+		return false;
+	}
+
+	if (header.MeshCount > size / sizeof(MeshCacheEntry)
+	 || header.MaterialCount > size / sizeof(MeshCacheMaterial))
+	{
+		return false;
+	}
+
+	Reader reader(pData, size);
+	reader.Read(&header, sizeof(header));
+
+	std::vector<MeshCacheEntry> entries(header.MeshCount);
+	if (!reader.Read(entries.data(), sizeof(MeshCacheEntry) * entries.size()))
+	{
+		return false;
+	}
+
+	// blobs are used in place. their indices are not checked, the key vouches for the contents
+	std::vector<CookedMesh> meshes(header.MeshCount);
+	size_t end = sizeof(MeshCacheHeader) + sizeof(MeshCacheEntry) * entries.size();
+	for (size_t i = 0; i < entries.size(); ++i)
+	{
+		const auto& entry = entries[i];
+		if (entry.IndexStride != sizeof(uint16_t) && entry.IndexStride != sizeof(uint32_t))
+		{
+			return false;
+		}
+
+		auto vertexSize = uint64_t(header.VertexStride) * entry.VertexCount;
+		auto indexSize = uint64_t(entry.IndexStride) * entry.IndexCount;
+		if (entry.VertexOffset > size || vertexSize > size - entry.VertexOffset
+		 || entry.IndexOffset > size || indexSize > size - entry.IndexOffset)
+		{
+			return false;
+		}
+
+		auto& mesh = meshes[i];
+		mesh.pVertices = pData + entry.VertexOffset;
+		mesh.pIndices = pData + entry.IndexOffset;
+		mesh.VertexCount = entry.VertexCount;
+		mesh.IndexCount = entry.IndexCount;
+		mesh.IndexFormat = (entry.IndexStride == sizeof(uint16_t)) ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+		mesh.MaterialId = entry.MaterialId;
+		mesh.Quantization = entry.Quantization;
+		mesh.Bounds = entry.Bounds;
+
+		end = std::max(end, size_t(entry.IndexOffset + indexSize));
+		end = std::max(end, size_t(entry.VertexOffset + vertexSize));
+	}
+
+	// material table follows the last blob
+	Reader materialReader(pData + end, size - end);
+	std::vector<ResMaterial> materials(header.MaterialCount);
+	for (size_t i = 0; i < materials.size(); ++i)
+	{
+		MeshCacheMaterial material;
+		auto& dst = materials[i];
+		if (!materialReader.Read(&material, sizeof(material))
+		 || !materialReader.ReadString(dst.DiffuseMap)
+		 || !materialReader.ReadString(dst.SpecularMap)
+		 || !materialReader.ReadString(dst.ShininessMap)
+		 || !materialReader.ReadString(dst.NormalMap))
+		{
+			return false;
+		}
+
+		dst.Diffuse = material.Diffuse;
+		dst.Specular = material.Specular;
+		dst.Alpha = material.Alpha;
+		dst.Shininess = material.Shininess;
+	}
+
+	m_Meshes.swap(meshes);
+	m_Materials.swap(materials);
+
+	return true;
+}
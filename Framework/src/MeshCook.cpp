@@ -0,0 +1,145 @@
+#include "MeshCook.h"
+#include "IndexFormat.h"
+#include "MappedFile.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+
+namespace {
+
+	// key of the cooked file of a source file
+	bool GetSourceKey(const wchar_t* filename, uint64_t& key)
+	{
+		MappedFile source;
+		if (!source.Open(filename))
+		{
+			return false;
+		}
+
+		key = ComputeMeshCacheKey(filename, source.GetData(), source.GetSize(), GetMeshImportFlags());
+		return true;
+	}
+
+} // namespace
+
+// import a mesh and cook it
+bool CookMesh
+(
+	const wchar_t* filename,
+	VERTEX_FORMAT format,
+	std::vector<uint8_t>& result,
+	ThreadPool* pPool
+)
+{
+	if (filename == nullptr)
+	{
+		return false;
+	}
+
+	uint64_t key = 0;
+	if (!GetSourceKey(filename, key))
+	{
+		return false;
+	}
+
+	std::vector<ResMesh> meshes;
+	std::vector<ResMaterial> materials;
+	if (!LoadMesh(filename, meshes, materials, pPool))
+	{
+		return false;
+	}
+
+	// keep every mesh within reach of 16-bit indices
+	auto count = meshes.size();
+	SplitLargeMeshes(meshes);
+	if (meshes.size() != count)
+	{
+		DLOG("Info : split %zu meshes into %zu for 16-bit indices.", count, meshes.size());
+	}
+
+#if defined(DEBUG) || defined(_DEBUG)
+	// report vertex fetch size and precision of the format, which must stay in its limits
+	{
+		size_t vertexCount = 0;
+		VertexCodecError error = {};
+		for (size_t i = 0; i < meshes.size(); ++i)
+		{
+			auto e = MeasureVertexError(format, meshes[i].Vertices);
+			auto limit = GetVertexErrorLimit(format, meshes[i].Vertices);
+			assert(e.MaxPosition <= limit.MaxPosition);
+			assert(e.MaxNormalAngle <= limit.MaxNormalAngle);
+			assert(e.MaxTangentAngle <= limit.MaxTangentAngle);
+			assert(e.MaxTexCoord <= limit.MaxTexCoord);
+
+			error.MaxPosition = std::max(error.MaxPosition, e.MaxPosition);
+			error.MaxNormalAngle = std::max(error.MaxNormalAngle, e.MaxNormalAngle);
+			error.MaxTangentAngle = std::max(error.MaxTangentAngle, e.MaxTangentAngle);
+			error.MaxTexCoord = std::max(error.MaxTexCoord, e.MaxTexCoord);
+			vertexCount += meshes[i].Vertices.size();
+		}
+
+		DLOG("Info : vertex format %d : %zu bytes -> %zu bytes. max error : position %f, normal %f deg, tangent %f deg, texcoord %f",
+			int(format),
+			sizeof(MeshVertex) * vertexCount,
+			size_t(GetVertexStride(format)) * vertexCount,
+			error.MaxPosition,
+			error.MaxNormalAngle,
+			error.MaxTangentAngle,
+			error.MaxTexCoord);
+	}
+#endif
+
+	SerializeMeshCache(key, format, meshes, materials, result);
+	return true;
+}
+
+// load the cooked mesh of a source file
+bool LoadCookedMesh
+(
+	const wchar_t* filename,
+	VERTEX_FORMAT format,
+	MeshCache& cache,
+	ThreadPool* pPool
+)
+{
+	if (filename == nullptr)
+	{
+		return false;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	auto GetElapsedMsec = [&start]()
+	{
+		auto end = std::chrono::steady_clock::now();
+		return std::chrono::duration<double, std::milli>(end - start).count();
+	};
+
+	// the cooked file is keyed by the source, its materials and textures, and the importer flags
+	uint64_t key = 0;
+	if (!GetSourceKey(filename, key))
+	{
+		return false;
+	}
+
+	auto cachePath = GetMeshCachePath(filename);
+	if (cache.Open(cachePath.c_str(), key, format))
+	{
+		DLOG("Info : loaded cooked mesh in %f msec. filepath = %ls", GetElapsedMsec(), cachePath.c_str());
+		return true;
+	}
+
+	// cache miss : import and cook for the next launch
+	std::vector<uint8_t> data;
+	if (!CookMesh(filename, format, data, pPool))
+	{
+		return false;
+	}
+
+	if (!SaveMeshCache(cachePath.c_str(), data))
+	{
+		DLOG("Warning : failed to write cooked mesh. filepath = %ls", cachePath.c_str());
+	}
+
+	return cache.Init(data, key, format);
+}
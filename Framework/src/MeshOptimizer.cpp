@@ -0,0 +1,392 @@
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+	// cache size which the Forsyth score is tuned for
+	const int ScoreCacheSize = 32;
+
+	// FIFO cache size used for statistics and cluster boundaries
+	const uint32_t FifoCacheSize = 16;
+
+	// score of a vertex from its position in the cache and remaining triangles
+	float VertexScore(int cachePos, uint32_t remaining)
+	{
+		if (remaining == 0)
+		{
+			return -1.0f;
+		}
+
+		auto score = 0.0f;
+		if (cachePos >= 0)
+		{
+			if (cachePos < 3)
+			{
+				// the last triangle's vertices are fixed, whichever comes next
+				score = 0.75f;
+			}
+			else
+			{
+				const auto scaler = 1.0f / float(ScoreCacheSize - 3);
+				score = std::pow(1.0f - float(cachePos - 3) * scaler, 1.5f);
+			}
+		}
+
+		// boost vertices with few triangles left, so that they are finished off
+		score += 2.0f / std::sqrt(float(remaining));
+		return score;
+	}
+
+} // namespace
+
+// simulate FIFO post-transform cache
+float ComputeACMR
+(
+	const std::vector<uint32_t>& indices,
+	size_t vertexCount,
+	uint32_t cacheSize,
+	float* pAtvr
+)
+{
+	if (indices.size() < 3 || cacheSize == 0)
+	{
+		if (pAtvr != nullptr)
+		{
+			*pAtvr = 0.0f;
+		}
+		return 0.0f;
+	}
+
+	// time stamp of insertion, a vertex is cached while it is within cacheSize insertions
+	std::vector<uint32_t> stamps(vertexCount, 0);
+	uint32_t time = cacheSize + 1;
+	uint32_t misses = 0;
+
+	for (size_t i = 0; i < indices.size(); ++i)
+	{
+		auto index = indices[i];
+		if (time - stamps[index] > cacheSize)
+		{
+			stamps[index] = time++;
+			misses++;
+		}
+	}
+
+	if (pAtvr != nullptr)
+	{
+		*pAtvr = (vertexCount > 0) ? float(misses) / float(vertexCount) : 0.0f;
+	}
+
+	return float(misses) / float(indices.size() / 3);
+}
+
+// reorder triangles for the vertex cache
+void OptimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount)
+{
+	auto triCount = indices.size() / 3;
+	if (triCount == 0 || vertexCount == 0)
+	{
+		return;
+	}
+
+	// triangles which use each vertex
+	std::vector<uint32_t> offsets(vertexCount + 1, 0);
+	for (size_t i = 0; i < triCount * 3; ++i)
+	{
+		offsets[indices[i] + 1]++;
+	}
+	for (size_t i = 0; i < vertexCount; ++i)
+	{
+		offsets[i + 1] += offsets[i];
+	}
+
+	std::vector<uint32_t> adjacency(triCount * 3);
+	std::vector<uint32_t> remaining(vertexCount, 0);
+	for (size_t i = 0; i < triCount * 3; ++i)
+	{
+		auto v = indices[i];
+		adjacency[offsets[v] + remaining[v]] = uint32_t(i / 3);
+		remaining[v]++;
+	}
+
+	std::vector<int> cachePos(vertexCount, -1);
+	std::vector<float> vertexScore(vertexCount);
+	for (size_t i = 0; i < vertexCount; ++i)
+	{
+		vertexScore[i] = VertexScore(-1, remaining[i]);
+	}
+
+	std::vector<float> triScore(triCount);
+	std::vector<bool> emitted(triCount, false);
+	for (size_t i = 0; i < triCount; ++i)
+	{
+		triScore[i] = vertexScore[indices[i * 3 + 0]]
+			+ vertexScore[indices[i * 3 + 1]]
+			+ vertexScore[indices[i * 3 + 2]];
+	}
+
+	std::vector<uint32_t> result;
+	result.reserve(triCount * 3);
+
+	std::vector<uint32_t> cache;
+	std::vector<uint32_t> nextCache;
+	cache.reserve(ScoreCacheSize + 3);
+	nextCache.reserve(ScoreCacheSize + 3);
+
+	size_t scan = 0;
+	auto best = uint32_t(0);
+	auto bestScore = triScore[0];
+	for (size_t i = 1; i < triCount; ++i)
+	{
+		if (triScore[i] > bestScore)
+		{
+			best = uint32_t(i);
+			bestScore = triScore[i];
+		}
+	}
+
+	for (size_t n = 0; n < triCount; ++n)
+	{
+		// no candidate around the cache, take the next triangle which is left
+		if (bestScore < 0.0f)
+		{
+			while (emitted[scan])
+			{
+				scan++;
+			}
+			best = uint32_t(scan);
+		}
+
+		emitted[best] = true;
+		triScore[best] = -1.0f;
+
+		// put vertices of the triangle at the front of the cache
+		nextCache.clear();
+		for (auto k = 0; k < 3; ++k)
+		{
+			auto v = indices[best * 3 + k];
+			result.push_back(v);
+			nextCache.push_back(v);
+
+			// remove the triangle from the vertex's list
+			auto begin = offsets[v];
+			auto end = begin + remaining[v];
+			for (auto j = begin; j < end; ++j)
+			{
+				if (adjacency[j] == best)
+				{
+					std::swap(adjacency[j], adjacency[end - 1]);
+					break;
+				}
+			}
+			remaining[v]--;
+		}
+
+		for (size_t i = 0; i < cache.size(); ++i)
+		{
+			auto v = cache[i];
+			if (v != nextCache[0] && v != nextCache[1] && v != nextCache[2])
+			{
+				nextCache.push_back(v);
+			}
+		}
+
+		// evicted vertices lose their cache score
+		for (size_t i = ScoreCacheSize; i < nextCache.size(); ++i)
+		{
+			cachePos[nextCache[i]] = -1;
+			vertexScore[nextCache[i]] = VertexScore(-1, remaining[nextCache[i]]);
+		}
+		if (nextCache.size() > size_t(ScoreCacheSize))
+		{
+			nextCache.resize(ScoreCacheSize);
+		}
+
+		for (size_t i = 0; i < nextCache.size(); ++i)
+		{
+			auto v = nextCache[i];
+			cachePos[v] = int(i);
+			vertexScore[v] = VertexScore(int(i), remaining[v]);
+		}
+
+		// rescore triangles touching the cache and pick the best
+		bestScore = -1.0f;
+		for (size_t i = 0; i < nextCache.size(); ++i)
+		{
+			auto v = nextCache[i];
+			for (auto j = offsets[v]; j < offsets[v] + remaining[v]; ++j)
+			{
+				auto t = adjacency[j];
+				triScore[t] = vertexScore[indices[t * 3 + 0]]
+					+ vertexScore[indices[t * 3 + 1]]
+					+ vertexScore[indices[t * 3 + 2]];
+
+				if (triScore[t] > bestScore)
+				{
+					best = t;
+					bestScore = triScore[t];
+				}
+			}
+		}
+
+		cache.swap(nextCache);
+	}
+
+	indices.swap(result);
+}
+
+// reorder clusters for overdraw
+void OptimizeOverdraw
+(
+	std::vector<uint32_t>& indices,
+	const std::vector<MeshVertex>& vertices,
+	uint32_t cacheSize
+)
+{
+	auto triCount = indices.size() / 3;
+	if (triCount == 0 || vertices.empty() || cacheSize == 0)
+	{
+		return;
+	}
+
+	// cut clusters where every vertex of a triangle misses the cache
+	std::vector<size_t> clusters;
+	{
+		std::vector<uint32_t> stamps(vertices.size(), 0);
+		uint32_t time = cacheSize + 1;
+
+		for (size_t t = 0; t < triCount; ++t)
+		{
+			auto misses = 0;
+			for (auto k = 0; k < 3; ++k)
+			{
+				auto v = indices[t * 3 + k];
+				if (time - stamps[v] > cacheSize)
+				{
+					stamps[v] = time++;
+					misses++;
+				}
+			}
+
+			if (t == 0 || misses == 3)
+			{
+				clusters.push_back(t);
+			}
+		}
+	}
+
+	if (clusters.size() < 2)
+	{
+		return;
+	}
+
+	// centroid of the mesh
+	DirectX::XMFLOAT3 center(0.0f, 0.0f, 0.0f);
+	for (size_t i = 0; i < vertices.size(); ++i)
+	{
+		center.x += vertices[i].Position.x;
+		center.y += vertices[i].Position.y;
+		center.z += vertices[i].Position.z;
+	}
+	center.x /= float(vertices.size());
+	center.y /= float(vertices.size());
+	center.z /= float(vertices.size());
+
+	// clusters which face away from the center occlude the others, so draw them first
+	std::vector<std::pair<float, size_t>> sortKeys(clusters.size());
+	for (size_t c = 0; c < clusters.size(); ++c)
+	{
+		auto begin = clusters[c];
+		auto end = (c + 1 < clusters.size()) ? clusters[c + 1] : triCount;
+
+		DirectX::XMFLOAT3 centroid(0.0f, 0.0f, 0.0f);
+		DirectX::XMFLOAT3 normal(0.0f, 0.0f, 0.0f);
+		for (auto t = begin; t < end; ++t)
+		{
+			const auto& p0 = vertices[indices[t * 3 + 0]].Position;
+			const auto& p1 = vertices[indices[t * 3 + 1]].Position;
+			const auto& p2 = vertices[indices[t * 3 + 2]].Position;
+
+			auto e1x = p1.x - p0.x, e1y = p1.y - p0.y, e1z = p1.z - p0.z;
+			auto e2x = p2.x - p0.x, e2y = p2.y - p0.y, e2z = p2.z - p0.z;
+
+			// area weighted normal
+			normal.x += e1y * e2z - e1z * e2y;
+			normal.y += e1z * e2x - e1x * e2z;
+			normal.z += e1x * e2y - e1y * e2x;
+
+			centroid.x += (p0.x + p1.x + p2.x) / 3.0f;
+			centroid.y += (p0.y + p1.y + p2.y) / 3.0f;
+			centroid.z += (p0.z + p1.z + p2.z) / 3.0f;
+		}
+
+		auto count = float(end - begin);
+		centroid.x = centroid.x / count - center.x;
+		centroid.y = centroid.y / count - center.y;
+		centroid.z = centroid.z / count - center.z;
+
+		auto length = std::sqrt(normal.x * normal.x + normal.y * normal.y + normal.z * normal.z);
+		auto dot = centroid.x * normal.x + centroid.y * normal.y + centroid.z * normal.z;
+
+		sortKeys[c].first = (length > 0.0f) ? dot / length : 0.0f;
+		sortKeys[c].second = c;
+	}
+
+	std::stable_sort(sortKeys.begin(), sortKeys.end(),
+		[](const std::pair<float, size_t>& a, const std::pair<float, size_t>& b)
+		{
+			return a.first > b.first;
+		});
+
+	std::vector<uint32_t> result;
+	result.reserve(indices.size());
+	for (size_t i = 0; i < sortKeys.size(); ++i)
+	{
+		auto c = sortKeys[i].second;
+		auto begin = clusters[c];
+		auto end = (c + 1 < clusters.size()) ? clusters[c + 1] : triCount;
+		result.insert(result.end(), indices.begin() + begin * 3, indices.begin() + end * 3);
+	}
+
+	indices.swap(result);
+}
+
+// reorder vertices in order of first use
+void OptimizeVertexFetch(std::vector<MeshVertex>& vertices, std::vector<uint32_t>& indices)
+{
+	const auto Unused = UINT32_MAX;
+	std::vector<uint32_t> remap(vertices.size(), Unused);
+	std::vector<MeshVertex> result;
+	result.reserve(vertices.size());
+
+	for (size_t i = 0; i < indices.size(); ++i)
+	{
+		auto& index = indices[i];
+		if (remap[index] == Unused)
+		{
+			remap[index] = uint32_t(result.size());
+			result.push_back(vertices[index]);
+		}
+
+		index = remap[index];
+	}
+
+	vertices.swap(result);
+}
+
+// run every optimization
+MeshOptimizeStats OptimizeMesh(ResMesh& mesh)
+{
+	MeshOptimizeStats result = {};
+
+	result.AcmrBefore = ComputeACMR(mesh.Indices, mesh.Vertices.size(), FifoCacheSize, &result.AtvrBefore);
+
+	OptimizeVertexCache(mesh.Indices, mesh.Vertices.size());
+	OptimizeOverdraw(mesh.Indices, mesh.Vertices, FifoCacheSize);
+	OptimizeVertexFetch(mesh.Vertices, mesh.Indices);
+
+	result.AcmrAfter = ComputeACMR(mesh.Indices, mesh.Vertices.size(), FifoCacheSize, &result.AtvrAfter);
+
+	return result;
+}
@@ -0,0 +1,807 @@
+#include "MipStreamer.h"
+#include "DeferredReleaseQueue.h"
+#include "DescriptorPool.h"
+#include "Logger.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+namespace {
+
+	// textures being opened or parsed at once
+	const uint32_t MaxLoadsInFlight = 8;
+
+	// check whether a resource can start at the mip
+	bool IsValidTopMip(const DDSInfo& info, uint32_t mip)
+	{
+		// the top level of a block compressed texture must be made of whole blocks
+		if (!IsBlockCompressed(info.Format))
+		{
+			return true;
+		}
+
+		return (info.Subresources[mip].Width % 4) == 0 && (info.Subresources[mip].Height % 4) == 0;
+	}
+
+	// select the most detailed mip of the tail
+	uint32_t SelectTailMip(const DDSInfo& info, uint32_t tailSize)
+	{
+		auto tail = info.MipCount - 1;
+		for (auto i = 0u; i < info.MipCount; ++i)
+		{
+			if (info.Subresources[i].Width <= tailSize && info.Subresources[i].Height <= tailSize)
+			{
+				tail = i;
+				break;
+			}
+		}
+
+		while (tail > 0 && !IsValidTopMip(info, tail))
+		{
+			tail--;
+		}
+
+		// every mip above the tail must be able to start a resource as well
+		for (auto i = 0u; i < tail; ++i)
+		{
+			if (!IsValidTopMip(info, i))
+			{
+				return 0;
+			}
+		}
+
+		return tail;
+	}
+
+} // namespace
+
+//
+// StreamingTexture class
+//
+
+// constructor
+StreamingTexture::StreamingTexture()
+	: m_Info()
+	, m_TailMip(0)
+	, m_LoadId(StreamingScheduler::InvalidId)
+	, m_IsSRGB(false)
+	, m_Id(ResidencyManager::InvalidId)
+	, m_ResidentMip(0)
+	, m_PendingMip(0)
+{
+}
+
+// destructor
+StreamingTexture::~StreamingTexture()
+{
+	m_Texture.Term();
+	m_pPending.Reset();
+	m_File.Close();
+}
+
+// check whether any mip is resident
+bool StreamingTexture::IsResident() const
+{
+	return m_ResidentMip < m_Info.MipCount;
+}
+
+// get most detailed resident mip
+uint32_t StreamingTexture::GetResidentMip() const
+{
+	return m_ResidentMip;
+}
+
+// get layout of the file
+const DDSInfo& StreamingTexture::GetInfo() const
+{
+	return m_Info;
+}
+
+// get GPU descriptor handle
+D3D12_GPU_DESCRIPTOR_HANDLE StreamingTexture::GetHandleGPU() const
+{
+	return m_Texture.GetHandleGPU();
+}
+
+// create another shader resource view
+void StreamingTexture::CreateView(ID3D12Device* pDevice, D3D12_CPU_DESCRIPTOR_HANDLE handle) const
+{
+	m_Texture.CreateView(pDevice, handle);
+}
+
+//
+// MipStreamer class
+//
+
+// constructor
+MipStreamer::MipStreamer()
+	: m_FenceValue(0)
+	, m_pPool(nullptr)
+	, m_pWorkerPool(nullptr)
+	, m_pReleaseQueue(nullptr)
+	, m_TailSize(0)
+	, m_LoadTicket(0)
+{
+}
+
+// destructor
+MipStreamer::~MipStreamer()
+{
+	Term();
+}
+
+// initialize
+bool MipStreamer::Init
+(
+	ID3D12Device* pDevice,
+	DescriptorPool* pPool,
+	ID3D12CommandQueue* pCopyQueue,
+	ThreadPool* pWorkerPool,
+	DeferredReleaseQueue* pReleaseQueue,
+	uint64_t budget,
+	uint32_t tailSize,
+	uint64_t maxUploadBytes
+)
+{
+	if (pDevice == nullptr || pPool == nullptr || pCopyQueue == nullptr || budget == 0 || tailSize == 0)
+	{
+		ELOG("Error : Invalid Argument.");
+		return false;
+	}
+
+	Term();
+
+	m_pDevice = pDevice;
+	m_pQueue = pCopyQueue;
+
+	m_pPool = pPool;
+	m_pPool->AddRef();
+
+	m_pWorkerPool = pWorkerPool;
+	m_pReleaseQueue = pReleaseQueue;
+	m_TailSize = tailSize;
+
+	auto type = pCopyQueue->GetDesc().Type;
+
+	auto hr = pDevice->CreateCommandAllocator(type, IID_PPV_ARGS(m_pAllocator.GetAddressOf()));
+	if (FAILED(hr))
+	{
+		ELOG("Error : ID3D12Device::CreateCommandAllocator() Failed. retcode = 0x%x", hr);
+		return false;
+	}
+
+	hr = pDevice->CreateCommandList(
+		0,
+		type,
+		m_pAllocator.Get(),
+		nullptr,
+		IID_PPV_ARGS(m_pCmdList.GetAddressOf()));
+	if (FAILED(hr))
+	{
+		ELOG("Error : ID3D12Device::CreateCommandList() Failed. retcode = 0x%x", hr);
+		return false;
+	}
+
+	m_pCmdList->Close();
+
+	m_FenceValue = 0;
+
+	// files are opened and parsed on the same threads which fill the staging buffer
+	auto pLoadPool = (pWorkerPool != nullptr) ? pWorkerPool : &m_InlinePool;
+	if (!m_Scheduler.Init(this, pLoadPool, pLoadPool, MaxLoadsInFlight))
+	{
+		ELOG("Error : StreamingScheduler::Init() Failed.");
+		return false;
+	}
+
+	return m_Residency.Init(budget, maxUploadBytes);
+}
+
+// end
+void MipStreamer::Term()
+{
+	// waits for the files being opened and parsed. a texture registered already is deleted with m_pTextures
+	m_Scheduler.Term();
+	for (auto& itr : m_pLoading)
+	{
+		if (itr.second->m_Id == ResidencyManager::InvalidId)
+		{
+			delete itr.second;
+		}
+	}
+	m_pLoading.clear();
+	m_pRegistered.clear();
+	m_LoadTicket = 0;
+
+	m_pBatch.clear();
+	m_pUpload.Reset();
+
+	for (size_t i = 0; i < m_pReleased.size(); ++i)
+	{
+		delete m_pReleased[i];
+	}
+	m_pReleased.clear();
+
+	for (size_t i = 0; i < m_pTextures.size(); ++i)
+	{
+		delete m_pTextures[i];
+	}
+	m_pTextures.clear();
+
+	m_Residency.Term();
+
+	m_pCmdList.Reset();
+	m_pAllocator.Reset();
+	m_pQueue.Reset();
+	m_pDevice.Reset();
+	m_FenceValue = 0;
+	m_pWorkerPool = nullptr;
+	m_pReleaseQueue = nullptr;
+	m_TailSize = 0;
+
+	if (m_pPool != nullptr)
+	{
+		m_pPool->Release();
+		m_pPool = nullptr;
+	}
+}
+
+// load a texture
+StreamingTexture* MipStreamer::Load(const wchar_t* filename, bool isSRGB, Callback callback)
+{
+	if (filename == nullptr || m_pDevice == nullptr)
+	{
+		ELOG("Error : Invalid Argument.");
+		return nullptr;
+	}
+
+	auto pTexture = new (std::nothrow) StreamingTexture();
+	if (pTexture == nullptr)
+	{
+		ELOG("Error : Out of memory.");
+		return nullptr;
+	}
+
+	pTexture->m_IsSRGB = isSRGB;
+	pTexture->m_Callback = callback;
+
+	// the file is opened and parsed on the worker pool
+	auto id = m_Scheduler.Request(filename);
+	if (id == StreamingScheduler::InvalidId)
+	{
+		delete pTexture;
+		return nullptr;
+	}
+
+	pTexture->m_LoadId = id;
+	{
+		std::lock_guard<std::mutex> lock(m_LoadingMutex);
+		m_pLoading[id] = pTexture;
+	}
+
+	return pTexture;
+}
+
+// release a texture
+void MipStreamer::Release(StreamingTexture* pTexture)
+{
+	if (pTexture == nullptr)
+	{
+		return;
+	}
+
+	pTexture->m_Callback = nullptr;
+
+	// a texture still loading is discarded by Finish() once no thread uses it
+	if (m_Scheduler.Cancel(pTexture->m_LoadId))
+	{
+		return;
+	}
+
+	Discard(pTexture);
+}
+
+// request mips for the current frame
+void MipStreamer::Request(StreamingTexture* pTexture, float screenSize)
+{
+	// a texture joins the residency policy after its file has been parsed
+	if (pTexture == nullptr || pTexture->m_Id == ResidencyManager::InvalidId)
+	{
+		return;
+	}
+
+	const auto& info = pTexture->m_Info;
+	m_Residency.Request(pTexture->m_Id, SelectMip(info.Width, info.Height, info.MipCount, screenSize));
+}
+
+// swap in the resources of the batch in flight if it has completed
+bool MipStreamer::Finish(UINT64 completedValue)
+{
+	if (m_pBatch.empty() || completedValue < m_FenceValue)
+	{
+		return false;
+	}
+
+	FinishBatch();
+	return true;
+}
+
+// upload the mips requested since the last batch
+bool MipStreamer::Submit()
+{
+	// register the textures parsed since the last call, so their tails go into this batch
+	std::vector<StreamingScheduler::Result> results;
+	m_Scheduler.Update(results);
+
+	if (!m_pBatch.empty())
+	{
+		return false;
+	}
+
+	std::vector<ResidencyManager::Change> changes;
+	m_Residency.Update(changes);
+	if (changes.empty())
+	{
+		return false;
+	}
+
+	// the batch completes at once when nothing is copied
+	auto isExecuted = false;
+	m_FenceValue = 0;
+
+	if (!SubmitBatch(changes, isExecuted))
+	{
+		ELOG("Error : MipStreamer::SubmitBatch() Failed.");
+
+		// keep the current resources. nothing has been queued, so the policy is told what
+		// is still resident and requests the mips again
+		for (size_t i = 0; i < m_pBatch.size(); ++i)
+		{
+			m_pBatch[i]->m_pPending.Reset();
+			m_Residency.SetResidentMip(m_pBatch[i]->m_Id, m_pBatch[i]->m_ResidentMip);
+		}
+		m_pBatch.clear();
+		m_pUpload.Reset();
+		return false;
+	}
+
+	// wait for the value the owner of the queue signals
+	if (isExecuted)
+	{
+		m_FenceValue = UINT64_MAX;
+	}
+
+	return isExecuted;
+}
+
+// set the fence value which completes the batch in flight
+void MipStreamer::SetFenceValue(UINT64 value)
+{
+	m_FenceValue = value;
+}
+
+// get the fence value which completes the last batch
+UINT64 MipStreamer::GetFenceValue() const
+{
+	return m_FenceValue;
+}
+
+// check whether nothing is being loaded or uploaded
+bool MipStreamer::IsIdle() const
+{
+	return m_pBatch.empty() && m_Scheduler.IsIdle();
+}
+
+// get bytes used by resident mips
+uint64_t MipStreamer::GetUsedBytes() const
+{
+	return m_Residency.GetUsedBytes();
+}
+
+// get budget
+uint64_t MipStreamer::GetBudget() const
+{
+	return m_Residency.GetBudget();
+}
+
+// set budget
+void MipStreamer::SetBudget(uint64_t budget)
+{
+	m_Residency.SetBudget(budget);
+}
+
+// swap in the resources of a completed batch
+void MipStreamer::FinishBatch()
+{
+	for (size_t i = 0; i < m_pBatch.size(); ++i)
+	{
+		auto pTexture = m_pBatch[i];
+		if (pTexture == nullptr || pTexture->m_pPending == nullptr)
+		{
+			continue;
+		}
+
+		// frames in flight may still read the old mips, so they are released after them
+		pTexture->m_Texture.Term(m_pReleaseQueue);
+		if (!pTexture->m_Texture.Init(
+			m_pDevice.Get(),
+			m_pPool,
+			pTexture->m_pPending.Get(),
+			pTexture->m_Info.IsCube,
+			pTexture->m_IsSRGB))
+		{
+			ELOG("Error : Texture::Init() Failed.");
+			pTexture->m_Texture.Term();
+			pTexture->m_ResidentMip = pTexture->m_Info.MipCount;
+			m_Residency.SetResidentMip(pTexture->m_Id, pTexture->m_ResidentMip);
+		}
+		else
+		{
+			pTexture->m_ResidentMip = pTexture->m_PendingMip;
+		}
+
+		pTexture->m_pPending.Reset();
+
+		if (pTexture->m_Callback)
+		{
+			pTexture->m_Callback(pTexture);
+		}
+	}
+
+	m_pBatch.clear();
+	m_pUpload.Reset();
+
+	for (size_t i = 0; i < m_pReleased.size(); ++i)
+	{
+		delete m_pReleased[i];
+	}
+	m_pReleased.clear();
+}
+
+// unregister a texture and delete it once no batch uses it
+void MipStreamer::Discard(StreamingTexture* pTexture)
+{
+	if (pTexture->m_Id != ResidencyManager::InvalidId)
+	{
+		m_Residency.Unregister(pTexture->m_Id);
+		m_pTextures[pTexture->m_Id] = nullptr;
+	}
+	pTexture->m_Callback = nullptr;
+
+	auto registered = std::find(m_pRegistered.begin(), m_pRegistered.end(), pTexture);
+	if (registered != m_pRegistered.end())
+	{
+		m_pRegistered.erase(registered);
+	}
+
+	// frames in flight may still read the resident mips
+	pTexture->m_Texture.Term(m_pReleaseQueue);
+
+	// the batch in flight may still write to it
+	auto itr = std::find(m_pBatch.begin(), m_pBatch.end(), pTexture);
+	if (itr != m_pBatch.end())
+	{
+		*itr = nullptr;
+		m_pReleased.push_back(pTexture);
+		return;
+	}
+
+	delete pTexture;
+}
+
+// get a texture which is being loaded
+StreamingTexture* MipStreamer::GetLoading(uint32_t id)
+{
+	std::lock_guard<std::mutex> lock(m_LoadingMutex);
+	auto itr = m_pLoading.find(id);
+	return (itr != m_pLoading.end()) ? itr->second : nullptr;
+}
+
+// map the file of a texture (worker thread)
+bool MipStreamer::Read(uint32_t id, const std::wstring& path)
+{
+	auto pTexture = GetLoading(id);
+	if (pTexture == nullptr)
+	{
+		return false;
+	}
+
+	if (!pTexture->m_File.Open(path.c_str()))
+	{
+		ELOG("Error : File Not Found. filepath = %ls", path.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+// parse the mapped file of a texture (worker thread)
+bool MipStreamer::Parse(uint32_t id)
+{
+	auto pTexture = GetLoading(id);
+	if (pTexture == nullptr)
+	{
+		return false;
+	}
+
+	auto& info = pTexture->m_Info;
+	if (!ParseDDS(pTexture->m_File.GetData(), pTexture->m_File.GetSize(), info))
+	{
+		ELOG("Error : Unsupported DDS file.");
+		return false;
+	}
+
+	// a mip level spans every slice
+	pTexture->m_MipSizes.assign(info.MipCount, 0);
+	for (size_t i = 0; i < info.Subresources.size(); ++i)
+	{
+		pTexture->m_MipSizes[i % info.MipCount] += info.Subresources[i].Size;
+	}
+
+	pTexture->m_TailMip = SelectTailMip(info, m_TailSize);
+	return true;
+}
+
+// hand parsed textures to the residency policy
+bool MipStreamer::Submit(const std::vector<uint32_t>& ids, uint64_t& ticket)
+{
+	m_pRegistered.clear();
+
+	for (size_t i = 0; i < ids.size(); ++i)
+	{
+		auto pTexture = GetLoading(ids[i]);
+		const auto& info = pTexture->m_Info;
+
+		// a texture which can not be registered stays on the dummy texture
+		auto id = m_Residency.Register(pTexture->m_MipSizes.data(), info.MipCount, pTexture->m_TailMip);
+		if (id == ResidencyManager::InvalidId)
+		{
+			ELOG("Error : ResidencyManager::Register() Failed.");
+			continue;
+		}
+
+		pTexture->m_Id = id;
+		pTexture->m_ResidentMip = info.MipCount;
+
+		if (id >= m_pTextures.size())
+		{
+			m_pTextures.resize(id + 1, nullptr);
+		}
+		m_pTextures[id] = pTexture;
+		m_pRegistered.push_back(pTexture);
+	}
+
+	ticket = ++m_LoadTicket;
+	return true;
+}
+
+// check whether the tails of the registered textures are resident
+bool MipStreamer::IsComplete(uint64_t ticket)
+{
+	if (ticket != m_LoadTicket)
+	{
+		return true;
+	}
+
+	for (size_t i = 0; i < m_pRegistered.size(); ++i)
+	{
+		if (!m_pRegistered[i]->IsResident())
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// take a texture which the scheduler has finished
+void MipStreamer::Finish(uint32_t id, STREAMING_STATE state)
+{
+	StreamingTexture* pTexture = nullptr;
+	{
+		std::lock_guard<std::mutex> lock(m_LoadingMutex);
+		auto itr = m_pLoading.find(id);
+		if (itr == m_pLoading.end())
+		{
+			return;
+		}
+
+		pTexture = itr->second;
+		m_pLoading.erase(itr);
+	}
+
+	if (state == STREAMING_STATE_CANCELED)
+	{
+		// released while it was loading
+		Discard(pTexture);
+		return;
+	}
+
+	if (state == STREAMING_STATE_FAILED)
+	{
+		// the owner keeps binding the dummy texture until it releases this one
+		pTexture->m_File.Close();
+	}
+}
+
+// upload changed textures
+bool MipStreamer::SubmitBatch(const std::vector<ResidencyManager::Change>& changes, bool& isExecuted)
+{
+	// a texture registered in this update may be upgraded as well, so the last change wins
+	for (size_t i = 0; i < changes.size(); ++i)
+	{
+		auto pTexture = m_pTextures[changes[i].Id];
+		if (std::find(m_pBatch.begin(), m_pBatch.end(), pTexture) == m_pBatch.end())
+		{
+			m_pBatch.push_back(pTexture);
+		}
+
+		pTexture->m_PendingMip = changes[i].ResidentMip;
+	}
+
+	// lay out every new mip range in one staging buffer
+	struct Copy
+	{
+		StreamingTexture* pTexture;
+		std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> Layouts;
+	};
+
+	std::vector<Copy> copies;
+	copies.reserve(m_pBatch.size());
+
+	D3D12_HEAP_PROPERTIES prop = {};
+	prop.Type = D3D12_HEAP_TYPE_DEFAULT;
+	prop.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+	prop.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+	prop.CreationNodeMask = 1;
+	prop.VisibleNodeMask = 1;
+
+	UINT64 totalSize = 0;
+	for (size_t i = 0; i < m_pBatch.size(); ++i)
+	{
+		auto pTexture = m_pBatch[i];
+		const auto& info = pTexture->m_Info;
+		auto mip = pTexture->m_PendingMip;
+
+		// nothing changed since the last batch
+		if (mip == pTexture->m_ResidentMip)
+		{
+			continue;
+		}
+
+		auto desc = GetDDSResourceDesc(info, mip);
+
+		// the copy queue promotes it to COPY_DEST and it decays back to COMMON,
+		// from which the direct queue promotes it to a shader resource
+		auto hr = m_pDevice->CreateCommittedResource(
+			&prop,
+			D3D12_HEAP_FLAG_NONE,
+			&desc,
+			D3D12_RESOURCE_STATE_COMMON,
+			nullptr,
+			IID_PPV_ARGS(pTexture->m_pPending.ReleaseAndGetAddressOf()));
+		if (FAILED(hr))
+		{
+			ELOG("Error : ID3D12Device::CreateCommittedResource() Failed. retcode = 0x%x", hr);
+			return false;
+		}
+
+		Copy copy;
+		copy.pTexture = pTexture;
+		totalSize = GetDDSFootprints(info, mip, totalSize, copy.Layouts);
+
+		copies.push_back(std::move(copy));
+	}
+
+	if (copies.empty())
+	{
+		return true;
+	}
+
+	// staging buffer
+	prop.Type = D3D12_HEAP_TYPE_UPLOAD;
+
+	D3D12_RESOURCE_DESC desc = {};
+	desc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+	desc.Alignment = 0;
+	desc.Width = totalSize;
+	desc.Height = 1;
+	desc.DepthOrArraySize = 1;
+	desc.MipLevels = 1;
+	desc.Format = DXGI_FORMAT_UNKNOWN;
+	desc.SampleDesc.Count = 1;
+	desc.SampleDesc.Quality = 0;
+	desc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+	desc.Flags = D3D12_RESOURCE_FLAG_NONE;
+
+	ComPtr<ID3D12Resource> pUpload;
+	auto hr = m_pDevice->CreateCommittedResource(
+		&prop,
+		D3D12_HEAP_FLAG_NONE,
+		&desc,
+		D3D12_RESOURCE_STATE_GENERIC_READ,
+		nullptr,
+		IID_PPV_ARGS(pUpload.GetAddressOf()));
+	if (FAILED(hr))
+	{
+		ELOG("Error : ID3D12Device::CreateCommittedResource() Failed. retcode = 0x%x", hr);
+		return false;
+	}
+
+	uint8_t* pDst = nullptr;
+	hr = pUpload->Map(0, nullptr, reinterpret_cast<void**>(&pDst));
+	if (FAILED(hr))
+	{
+		ELOG("Error : ID3D12Resource::Map() Failed. retcode = 0x%x", hr);
+		return false;
+	}
+
+	// copy straight from the mapped files. reading them may fault pages in, so textures are spread over the workers
+	auto fill = [&](size_t index)
+	{
+		const auto& copy = copies[index];
+		const auto& info = copy.pTexture->m_Info;
+		auto mip = copy.pTexture->m_PendingMip;
+		auto mipCount = info.MipCount - mip;
+
+		for (size_t j = 0; j < copy.Layouts.size(); ++j)
+		{
+			auto slice = uint32_t(j / mipCount);
+			auto level = mip + uint32_t(j % mipCount);
+			CopyDDSSubresource(
+				copy.pTexture->m_File.GetData(),
+				info.Subresources[level + slice * info.MipCount],
+				copy.Layouts[j],
+				pDst);
+		}
+	};
+
+	if (m_pWorkerPool != nullptr)
+	{
+		m_pWorkerPool->ParallelFor(copies.size(), fill);
+	}
+	else
+	{
+		for (size_t i = 0; i < copies.size(); ++i)
+		{
+			fill(i);
+		}
+	}
+
+	pUpload->Unmap(0, nullptr);
+
+	// the previous batch has completed, so the allocator is free
+	m_pAllocator->Reset();
+	m_pCmdList->Reset(m_pAllocator.Get(), nullptr);
+
+	for (size_t i = 0; i < copies.size(); ++i)
+	{
+		const auto& copy = copies[i];
+
+		for (size_t j = 0; j < copy.Layouts.size(); ++j)
+		{
+			D3D12_TEXTURE_COPY_LOCATION dst = {};
+			dst.pResource = copy.pTexture->m_pPending.Get();
+			dst.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+			dst.SubresourceIndex = UINT(j);
+
+			D3D12_TEXTURE_COPY_LOCATION src = {};
+			src.pResource = pUpload.Get();
+			src.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+			src.PlacedFootprint = copy.Layouts[j];
+
+			m_pCmdList->CopyTextureRegion(&dst, 0, 0, 0, &src, nullptr);
+		}
+	}
+
+	m_pCmdList->Close();
+
+	ID3D12CommandList* pLists[] = { m_pCmdList.Get() };
+	m_pQueue->ExecuteCommandLists(1, pLists);
+
+	m_pUpload = pUpload;
+	isExecuted = true;
+
+	return true;
+}
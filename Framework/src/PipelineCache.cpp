@@ -0,0 +1,1005 @@
+#include "PipelineCache.h"
+#include "Hash.h"
+#include "Logger.h"
+#include "MappedFile.h"
+#include "RootSignature.h"
+#include <cstring>
+#include <cwchar>
+#include <new>
+
+namespace {
+
+	// "PSOC"
+	const uint32_t PipelineCacheMagic = 0x434f5350;
+
+	//
+	// PipelineCacheHeader structure
+	//
+	struct PipelineCacheHeader
+	{
+		uint32_t Magic; // PipelineCacheMagic
+		uint32_t Version; // PipelineCacheVersion
+		uint64_t Size; // size of the library data
+		uint64_t Hash; // hash of the library data
+	};
+
+	//
+	// Hasher class
+	//
+	// Hashes members one by one, so padding and pointers never reach the hash.
+	//
+	class Hasher
+	{
+	public:
+		Hasher()
+			: m_Hash(HashSeed)
+		{
+			// Do Nothing//
+		}
+
+		template<typename T>
+		void Add(const T& value)
+		{
+			m_Hash = HashValue(value, m_Hash);
+		}
+
+		void AddBytes(const void* pData, size_t size)
+		{
+			Add(uint64_t(size));
+			m_Hash = HashBytes(pData, size, m_Hash);
+		}
+
+		void AddString(const char* value)
+		{
+			AddBytes(value, (value != nullptr) ? strlen(value) : 0);
+		}
+
+		void AddShader(const D3D12_SHADER_BYTECODE& shader)
+		{
+			AddBytes(shader.pShaderBytecode, (shader.pShaderBytecode != nullptr) ? shader.BytecodeLength : 0);
+		}
+
+		uint64_t Get() const
+		{
+			return m_Hash;
+		}
+
+	private:
+		uint64_t m_Hash;
+	};
+
+	// hash a root parameter
+	void HashRootParameter(Hasher& hasher, const D3D12_ROOT_PARAMETER& param)
+	{
+		hasher.Add(param.ParameterType);
+		hasher.Add(param.ShaderVisibility);
+
+		switch (param.ParameterType)
+		{
+		case D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE:
+		{
+			const auto& table = param.DescriptorTable;
+			hasher.Add(table.NumDescriptorRanges);
+			for (UINT i = 0; i < table.NumDescriptorRanges; ++i)
+			{
+				const auto& range = table.pDescriptorRanges[i];
+				hasher.Add(range.RangeType);
+				hasher.Add(range.NumDescriptors);
+				hasher.Add(range.BaseShaderRegister);
+				hasher.Add(range.RegisterSpace);
+				hasher.Add(range.OffsetInDescriptorsFromTableStart);
+			}
+		}
+		break;
+
+		case D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS:
+		{
+			hasher.Add(param.Constants.ShaderRegister);
+			hasher.Add(param.Constants.RegisterSpace);
+			hasher.Add(param.Constants.Num32BitValues);
+		}
+		break;
+
+		default:
+		{
+			hasher.Add(param.Descriptor.ShaderRegister);
+			hasher.Add(param.Descriptor.RegisterSpace);
+		}
+		break;
+		}
+	}
+
+	// hash a static sampler
+	void HashStaticSampler(Hasher& hasher, const D3D12_STATIC_SAMPLER_DESC& desc)
+	{
+		hasher.Add(desc.Filter);
+		hasher.Add(desc.AddressU);
+		hasher.Add(desc.AddressV);
+		hasher.Add(desc.AddressW);
+		hasher.Add(desc.MipLODBias);
+		hasher.Add(desc.MaxAnisotropy);
+		hasher.Add(desc.ComparisonFunc);
+		hasher.Add(desc.BorderColor);
+		hasher.Add(desc.MinLOD);
+		hasher.Add(desc.MaxLOD);
+		hasher.Add(desc.ShaderRegister);
+		hasher.Add(desc.RegisterSpace);
+		hasher.Add(desc.ShaderVisibility);
+	}
+
+	// hash blend state
+	void HashBlendState(Hasher& hasher, const D3D12_BLEND_DESC& desc)
+	{
+		hasher.Add(desc.AlphaToCoverageEnable);
+		hasher.Add(desc.IndependentBlendEnable);
+		for (auto i = 0; i < D3D12_SIMULTANEOUS_RENDER_TARGET_COUNT; ++i)
+		{
+			const auto& target = desc.RenderTarget[i];
+			hasher.Add(target.BlendEnable);
+			hasher.Add(target.LogicOpEnable);
+			hasher.Add(target.SrcBlend);
+			hasher.Add(target.DestBlend);
+			hasher.Add(target.BlendOp);
+			hasher.Add(target.SrcBlendAlpha);
+			hasher.Add(target.DestBlendAlpha);
+			hasher.Add(target.BlendOpAlpha);
+			hasher.Add(target.LogicOp);
+			hasher.Add(target.RenderTargetWriteMask);
+		}
+	}
+
+	// hash rasterizer state
+	void HashRasterizerState(Hasher& hasher, const D3D12_RASTERIZER_DESC& desc)
+	{
+		hasher.Add(desc.FillMode);
+		hasher.Add(desc.CullMode);
+		hasher.Add(desc.FrontCounterClockwise);
+		hasher.Add(desc.DepthBias);
+		hasher.Add(desc.DepthBiasClamp);
+		hasher.Add(desc.SlopeScaledDepthBias);
+		hasher.Add(desc.DepthClipEnable);
+		hasher.Add(desc.MultisampleEnable);
+		hasher.Add(desc.AntialiasedLineEnable);
+		hasher.Add(desc.ForcedSampleCount);
+		hasher.Add(desc.ConservativeRaster);
+	}
+
+	// hash stencil operations
+	void HashStencilOp(Hasher& hasher, const D3D12_DEPTH_STENCILOP_DESC& desc)
+	{
+		hasher.Add(desc.StencilFailOp);
+		hasher.Add(desc.StencilDepthFailOp);
+		hasher.Add(desc.StencilPassOp);
+		hasher.Add(desc.StencilFunc);
+	}
+
+	// hash depth stencil state
+	void HashDepthStencilState(Hasher& hasher, const D3D12_DEPTH_STENCIL_DESC& desc)
+	{
+		hasher.Add(desc.DepthEnable);
+		hasher.Add(desc.DepthWriteMask);
+		hasher.Add(desc.DepthFunc);
+		hasher.Add(desc.StencilEnable);
+		hasher.Add(desc.StencilReadMask);
+		hasher.Add(desc.StencilWriteMask);
+		HashStencilOp(hasher, desc.FrontFace);
+		HashStencilOp(hasher, desc.BackFace);
+	}
+
+	// hash input layout
+	void HashInputLayout(Hasher& hasher, const D3D12_INPUT_LAYOUT_DESC& desc)
+	{
+		hasher.Add(desc.NumElements);
+		for (UINT i = 0; i < desc.NumElements; ++i)
+		{
+			const auto& element = desc.pInputElementDescs[i];
+			hasher.AddString(element.SemanticName);
+			hasher.Add(element.SemanticIndex);
+			hasher.Add(element.Format);
+			hasher.Add(element.InputSlot);
+			hasher.Add(element.AlignedByteOffset);
+			hasher.Add(element.InputSlotClass);
+			hasher.Add(element.InstanceDataStepRate);
+		}
+	}
+
+	// hash stream output
+	void HashStreamOutput(Hasher& hasher, const D3D12_STREAM_OUTPUT_DESC& desc)
+	{
+		hasher.Add(desc.NumEntries);
+		for (UINT i = 0; i < desc.NumEntries; ++i)
+		{
+			const auto& entry = desc.pSODeclaration[i];
+			hasher.Add(entry.Stream);
+			hasher.AddString(entry.SemanticName);
+			hasher.Add(entry.SemanticIndex);
+			hasher.Add(entry.StartComponent);
+			hasher.Add(entry.ComponentCount);
+			hasher.Add(entry.OutputSlot);
+		}
+
+		hasher.Add(desc.NumStrides);
+		for (UINT i = 0; i < desc.NumStrides; ++i)
+		{
+			hasher.Add(desc.pBufferStrides[i]);
+		}
+
+		hasher.Add(desc.RasterizedStream);
+	}
+
+} // namespace
+
+// hash a root signature description
+uint64_t HashRootSignatureDesc(const D3D12_ROOT_SIGNATURE_DESC& desc)
+{
+	Hasher hasher;
+
+	hasher.Add(desc.NumParameters);
+	for (UINT i = 0; i < desc.NumParameters; ++i)
+	{
+		HashRootParameter(hasher, desc.pParameters[i]);
+	}
+
+	hasher.Add(desc.NumStaticSamplers);
+	for (UINT i = 0; i < desc.NumStaticSamplers; ++i)
+	{
+		HashStaticSampler(hasher, desc.pStaticSamplers[i]);
+	}
+
+	hasher.Add(desc.Flags);
+	return hasher.Get();
+}
+
+// hash a graphics pipeline state description
+uint64_t HashGraphicsPipelineDesc(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, uint64_t rootSignatureHash)
+{
+	Hasher hasher;
+
+	hasher.Add(rootSignatureHash);
+	hasher.AddShader(desc.VS);
+	hasher.AddShader(desc.PS);
+	hasher.AddShader(desc.DS);
+	hasher.AddShader(desc.HS);
+	hasher.AddShader(desc.GS);
+	HashStreamOutput(hasher, desc.StreamOutput);
+	HashBlendState(hasher, desc.BlendState);
+	hasher.Add(desc.SampleMask);
+	HashRasterizerState(hasher, desc.RasterizerState);
+	HashDepthStencilState(hasher, desc.DepthStencilState);
+	HashInputLayout(hasher, desc.InputLayout);
+	hasher.Add(desc.IBStripCutValue);
+	hasher.Add(desc.PrimitiveTopologyType);
+	hasher.Add(desc.NumRenderTargets);
+	for (auto i = 0; i < D3D12_SIMULTANEOUS_RENDER_TARGET_COUNT; ++i)
+	{
+		hasher.Add(desc.RTVFormats[i]);
+	}
+	hasher.Add(desc.DSVFormat);
+	hasher.Add(desc.SampleDesc.Count);
+	hasher.Add(desc.SampleDesc.Quality);
+	hasher.Add(desc.NodeMask);
+	hasher.Add(desc.Flags);
+	return hasher.Get();
+}
+
+// get name of a pipeline in the pipeline library
+std::wstring GetPipelineName(uint64_t hash)
+{
+	static const wchar_t Digits[] = L"0123456789abcdef";
+
+	std::wstring result(16, L'0');
+	for (auto i = 15; i >= 0; --i)
+	{
+		result[i] = Digits[hash & 0xf];
+		hash >>= 4;
+	}
+
+	return result;
+}
+
+// wrap a serialized pipeline library into the cache file format
+void SerializePipelineCache(const void* pLibrary, size_t size, std::vector<uint8_t>& result)
+{
+	if (pLibrary == nullptr)
+	{
+		size = 0;
+	}
+
+	PipelineCacheHeader header = {};
+	header.Magic = PipelineCacheMagic;
+	header.Version = PipelineCacheVersion;
+	header.Size = size;
+	header.Hash = HashBytes(pLibrary, size);
+
+	result.resize(sizeof(header) + size);
+	memcpy(result.data(), &header, sizeof(header));
+	if (size > 0)
+	{
+		memcpy(result.data() + sizeof(header), pLibrary, size);
+	}
+}
+
+// find the serialized pipeline library in cache file data
+bool DeserializePipelineCache(const void* pData, size_t size, const uint8_t*& pLibrary, size_t& librarySize)
+{
+	pLibrary = nullptr;
+	librarySize = 0;
+
+	if (pData == nullptr || size < sizeof(PipelineCacheHeader))
+	{
+		return false;
+	}
+
+	PipelineCacheHeader header = {};
+	memcpy(&header, pData, sizeof(header));
+	if (header.Magic != PipelineCacheMagic
+	 || header.Version != PipelineCacheVersion
+	 || header.Size != size - sizeof(header))
+	{
+		return false;
+	}
+
+	auto ptr = static_cast<const uint8_t*>(pData) + sizeof(header);
+	if (HashBytes(ptr, size_t(header.Size)) != header.Hash)
+	{
+		return false;
+	}
+
+	pLibrary = ptr;
+	librarySize = size_t(header.Size);
+	return true;
+}
+
+//
+// PipelineHandle class
+//
+
+// constructor
+PipelineHandle::PipelineHandle()
+	: m_pCache(nullptr)
+	, m_Hash(0)
+{
+}
+
+// constructor
+PipelineHandle::PipelineHandle(PipelineCache* pCache, uint64_t hash)
+	: m_pCache(pCache)
+	, m_Hash(hash)
+{
+}
+
+// check whether the handle refers to a request
+bool PipelineHandle::IsValid() const
+{
+	return m_pCache != nullptr;
+}
+
+// get state of the pipeline
+COMPILE_STATE PipelineHandle::GetState() const
+{
+	if (m_pCache == nullptr)
+	{
+		return COMPILE_STATE_FAILED;
+	}
+
+	return m_pCache->GetState(m_Hash);
+}
+
+// get the pipeline state
+ID3D12PipelineState* PipelineHandle::Get() const
+{
+	if (m_pCache == nullptr)
+	{
+		return nullptr;
+	}
+
+	return m_pCache->GetPipeline(m_Hash);
+}
+
+// get hash of the pipeline state description
+uint64_t PipelineHandle::GetHash() const
+{
+	return m_Hash;
+}
+
+//
+// PipelineCache class
+//
+
+// constructor
+PipelineCache::PipelineCache()
+	: m_IsDirty(false)
+	, m_LibraryHits(0)
+{
+}
+
+// destructor
+PipelineCache::~PipelineCache()
+{
+	Term();
+}
+
+// initialize
+bool PipelineCache::Init
+(
+	ID3D12Device* pDevice,
+	const wchar_t* filename,
+	ThreadPool* pWorkerPool,
+	uint32_t maxInFlight
+)
+{
+	if (pDevice == nullptr)
+	{
+		return false;
+	}
+
+	if (!m_Scheduler.Init(this, (pWorkerPool != nullptr) ? pWorkerPool : &m_InlinePool, maxInFlight))
+	{
+		ELOG("Error : CompileScheduler::Init() Failed.");
+		return false;
+	}
+
+	m_pDevice = pDevice;
+	m_Filename = (filename != nullptr) ? filename : L"";
+	m_IsDirty = false;
+	m_LibraryHits = 0;
+
+	InitLibrary(pDevice);
+	return true;
+}
+
+// create the pipeline library
+void PipelineCache::InitLibrary(ID3D12Device* pDevice)
+{
+	ComPtr<ID3D12Device1> pDevice1;
+	if (FAILED(pDevice->QueryInterface(IID_PPV_ARGS(pDevice1.GetAddressOf()))))
+	{
+		DLOG("Info : ID3D12PipelineLibrary is not supported. pipelines are always compiled.");
+		return;
+	}
+
+	// copy the file, the library refers to its data until it is released
+	if (!m_Filename.empty())
+	{
+		MappedFile file;
+		if (file.Open(m_Filename.c_str()))
+		{
+			const uint8_t* pLibrary = nullptr;
+			size_t size = 0;
+			if (DeserializePipelineCache(file.GetData(), file.GetSize(), pLibrary, size))
+			{
+				m_LibraryData.assign(pLibrary, pLibrary + size);
+			}
+		}
+	}
+
+	if (!m_LibraryData.empty())
+	{
+		auto hr = pDevice1->CreatePipelineLibrary(
+			m_LibraryData.data(),
+			m_LibraryData.size(),
+			IID_PPV_ARGS(m_pLibrary.GetAddressOf()));
+		if (SUCCEEDED(hr))
+		{
+			return;
+		}
+
+		// another driver or adapter wrote the file, start over
+		DLOG("Info : pipeline library is stale. retcode = 0x%x", hr);
+		m_LibraryData.clear();
+	}
+
+	auto hr = pDevice1->CreatePipelineLibrary(nullptr, 0, IID_PPV_ARGS(m_pLibrary.GetAddressOf()));
+	if (FAILED(hr))
+	{
+		DLOG("Warning : ID3D12Device1::CreatePipelineLibrary() Failed. retcode = 0x%x", hr);
+		m_pLibrary.Reset();
+	}
+}
+
+// end
+void PipelineCache::Term()
+{
+	// workers refer to the items and the library
+	m_Scheduler.Term();
+	{
+		std::lock_guard<std::mutex> lock(m_ItemMutex);
+		for (auto itr = m_pItems.begin(); itr != m_pItems.end(); ++itr)
+		{
+			delete itr->second;
+		}
+		m_pItems.clear();
+	}
+	m_Requests.clear();
+
+	if (m_IsDirty)
+	{
+		if (!Save())
+		{
+			DLOG("Warning : failed to write pipeline library. filepath = %ls", m_Filename.c_str());
+		}
+	}
+
+	m_Pipelines.clear();
+	m_RootSignatureHashes.clear();
+	m_RootSignatures.clear();
+	m_Shaders.clear();
+	m_pLibrary.Reset();
+	m_LibraryData.clear();
+	m_pDevice.Reset();
+	m_IsDirty = false;
+}
+
+// write the pipeline library to the file
+bool PipelineCache::Save()
+{
+	if (m_pLibrary == nullptr || m_Filename.empty() || !m_IsDirty)
+	{
+		return true;
+	}
+
+	std::vector<uint8_t> library;
+	HRESULT hr;
+	{
+		std::lock_guard<std::mutex> lock(m_LibraryMutex);
+		library.resize(m_pLibrary->GetSerializedSize());
+		hr = m_pLibrary->Serialize(library.data(), library.size());
+	}
+	if (FAILED(hr))
+	{
+		ELOG("Error : ID3D12PipelineLibrary::Serialize() Failed. retcode = 0x%x", hr);
+		return false;
+	}
+
+	std::vector<uint8_t> data;
+	SerializePipelineCache(library.data(), library.size(), data);
+
+	// write to a temporary file first, so a reader never sees a half-written cache
+	std::wstring temp(m_Filename);
+	temp += L".tmp";
+
+	auto hFile = CreateFileW(
+		temp.c_str(),
+		GENERIC_WRITE,
+		0,
+		nullptr,
+		CREATE_ALWAYS,
+		FILE_ATTRIBUTE_NORMAL,
+		nullptr);
+	if (hFile == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	DWORD written = 0;
+	auto result = WriteFile(hFile, data.data(), DWORD(data.size()), &written, nullptr) != FALSE;
+	result &= (written == DWORD(data.size()));
+	CloseHandle(hFile);
+
+	if (!result)
+	{
+		DeleteFileW(temp.c_str());
+		return false;
+	}
+
+	if (!MoveFileExW(temp.c_str(), m_Filename.c_str(), MOVEFILE_REPLACE_EXISTING))
+	{
+		DeleteFileW(temp.c_str());
+		return false;
+	}
+
+	m_IsDirty = false;
+	return true;
+}
+
+// read a compiled shader
+ID3DBlob* PipelineCache::LoadShader(const wchar_t* filename)
+{
+	if (filename == nullptr)
+	{
+		return nullptr;
+	}
+
+	auto itr = m_Shaders.find(filename);
+	if (itr != m_Shaders.end())
+	{
+		return itr->second.Get();
+	}
+
+	ComPtr<ID3DBlob> pBlob;
+	auto hr = D3DReadFileToBlob(filename, pBlob.GetAddressOf());
+	if (FAILED(hr))
+	{
+		ELOG("Error : D3DReadFileToBlob() Failed. path = %ls", filename);
+		return nullptr;
+	}
+
+	m_Shaders[filename] = pBlob;
+	return pBlob.Get();
+}
+
+// get a root signature
+ID3D12RootSignature* PipelineCache::GetRootSignature(const D3D12_ROOT_SIGNATURE_DESC* pDesc)
+{
+	if (pDesc == nullptr || m_pDevice == nullptr)
+	{
+		return nullptr;
+	}
+
+	auto hash = HashRootSignatureDesc(*pDesc);
+	auto itr = m_RootSignatures.find(hash);
+	if (itr != m_RootSignatures.end())
+	{
+		return itr->second.Get();
+	}
+
+	auto cost = GetRootSignatureCost(*pDesc);
+	if (cost > MaxRootSignatureCost)
+	{
+		ELOG("Error : Root Signature Cost Exceeded. cost = %u, max = %u", cost, MaxRootSignatureCost);
+		return nullptr;
+	}
+
+	ComPtr<ID3DBlob> pBlob;
+	ComPtr<ID3DBlob> pErrorBlob;
+
+	// serialize
+	auto hr = D3D12SerializeRootSignature(
+		pDesc,
+		D3D_ROOT_SIGNATURE_VERSION_1,
+		pBlob.GetAddressOf(),
+		pErrorBlob.GetAddressOf());
+	if (FAILED(hr))
+	{
+		ELOG("Error : D3D12SerializeRootSignature() Failed. retcode = 0x%x", hr);
+		return nullptr;
+	}
+
+	// generate root signature
+	ComPtr<ID3D12RootSignature> pRootSignature;
+	hr = m_pDevice->CreateRootSignature(
+		0,
+		pBlob->GetBufferPointer(),
+		pBlob->GetBufferSize(),
+		IID_PPV_ARGS(pRootSignature.GetAddressOf()));
+	if (FAILED(hr))
+	{
+		ELOG("Error : ID3D12Device::CreateRootSignature() Failed. retcode = 0x%x", hr);
+		return nullptr;
+	}
+
+	m_RootSignatures[hash] = pRootSignature;
+	m_RootSignatureHashes[pRootSignature.Get()] = hash;
+	return pRootSignature.Get();
+}
+
+// get a graphics pipeline state
+ID3D12PipelineState* PipelineCache::GetGraphicsPipeline(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc)
+{
+	if (m_pDevice == nullptr)
+	{
+		return nullptr;
+	}
+
+	uint64_t hash = 0;
+	if (!GetPipelineHash(desc, hash))
+	{
+		return nullptr;
+	}
+
+	auto itr = m_Pipelines.find(hash);
+	if (itr != m_Pipelines.end())
+	{
+		return itr->second.Get();
+	}
+
+	ComPtr<ID3D12PipelineState> pPipeline;
+	auto isFromLibrary = false;
+	if (!CreatePipeline(desc, hash, pPipeline, isFromLibrary))
+	{
+		return nullptr;
+	}
+
+	return AddPipeline(hash, pPipeline.Get(), isFromLibrary);
+}
+
+// request a graphics pipeline state without waiting for it
+PipelineHandle PipelineCache::RequestGraphicsPipeline(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, int priority)
+{
+	if (m_pDevice == nullptr)
+	{
+		return PipelineHandle();
+	}
+
+	uint64_t hash = 0;
+	if (!GetPipelineHash(desc, hash))
+	{
+		return PipelineHandle();
+	}
+
+	// ready already
+	if (m_Pipelines.find(hash) != m_Pipelines.end())
+	{
+		return PipelineHandle(this, hash);
+	}
+
+	// the scheduler returns the id in flight for the same hash
+	auto id = m_Scheduler.Request(hash, priority);
+	if (id == CompileScheduler::InvalidId)
+	{
+		return PipelineHandle();
+	}
+
+	m_Requests[hash] = id;
+
+	std::lock_guard<std::mutex> lock(m_ItemMutex);
+	if (m_pItems.find(id) == m_pItems.end())
+	{
+		auto pItem = new (std::nothrow) Item();
+		if (pItem == nullptr)
+		{
+			m_Scheduler.Cancel(id);
+			return PipelineHandle();
+		}
+
+		pItem->Hash = hash;
+		pItem->IsFromLibrary = false;
+		CopyDesc(desc, *pItem);
+		m_pItems[id] = pItem;
+	}
+
+	return PipelineHandle(this, hash);
+}
+
+// cancel a requested pipeline state which is not ready yet
+bool PipelineCache::Cancel(const PipelineHandle& handle)
+{
+	auto itr = m_Requests.find(handle.GetHash());
+	if (itr == m_Requests.end())
+	{
+		return false;
+	}
+
+	return m_Scheduler.Cancel(itr->second);
+}
+
+// start queued compiles and take finished ones
+void PipelineCache::Update()
+{
+	std::vector<CompileScheduler::Result> results;
+	m_Scheduler.Update(results);
+}
+
+// check whether nothing is being compiled
+bool PipelineCache::IsIdle() const
+{
+	return m_Scheduler.IsIdle();
+}
+
+// get state of a pipeline state
+COMPILE_STATE PipelineCache::GetState(uint64_t hash) const
+{
+	if (m_Pipelines.find(hash) != m_Pipelines.end())
+	{
+		return COMPILE_STATE_READY;
+	}
+
+	auto itr = m_Requests.find(hash);
+	if (itr == m_Requests.end())
+	{
+		return COMPILE_STATE_FAILED;
+	}
+
+	return m_Scheduler.GetState(itr->second);
+}
+
+// get a pipeline state which is ready
+ID3D12PipelineState* PipelineCache::GetPipeline(uint64_t hash) const
+{
+	auto itr = m_Pipelines.find(hash);
+	if (itr == m_Pipelines.end())
+	{
+		return nullptr;
+	}
+
+	return itr->second.Get();
+}
+
+// get count of pipeline states
+size_t PipelineCache::GetPipelineCount() const
+{
+	return m_Pipelines.size();
+}
+
+// get count of pipeline states loaded from the library
+size_t PipelineCache::GetLibraryHitCount() const
+{
+	return m_LibraryHits;
+}
+
+// hash a description with its root signature
+bool PipelineCache::GetPipelineHash(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, uint64_t& hash) const
+{
+	// the root signature enters the hash by its description, never by its address
+	auto itr = m_RootSignatureHashes.find(desc.pRootSignature);
+	if (itr == m_RootSignatureHashes.end())
+	{
+		ELOG("Error : Root Signature Is Not Created By PipelineCache.");
+		return false;
+	}
+
+	hash = HashGraphicsPipelineDesc(desc, itr->second);
+	return true;
+}
+
+// load a pipeline state from the library or compile it
+bool PipelineCache::CreatePipeline
+(
+	const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc,
+	uint64_t hash,
+	ComPtr<ID3D12PipelineState>& pPipeline,
+	bool& isFromLibrary
+)
+{
+	isFromLibrary = false;
+
+	// the library validates the description, so a hash collision only costs a compile
+	if (m_pLibrary != nullptr)
+	{
+		auto name = GetPipelineName(hash);
+
+		std::lock_guard<std::mutex> lock(m_LibraryMutex);
+		auto hr = m_pLibrary->LoadGraphicsPipeline(name.c_str(), &desc, IID_PPV_ARGS(pPipeline.ReleaseAndGetAddressOf()));
+		if (SUCCEEDED(hr))
+		{
+			isFromLibrary = true;
+			return true;
+		}
+
+		pPipeline.Reset();
+	}
+
+	auto hr = m_pDevice->CreateGraphicsPipelineState(&desc, IID_PPV_ARGS(pPipeline.GetAddressOf()));
+	if (FAILED(hr))
+	{
+		ELOG("Error : ID3D12Device::CreateGraphicsPipelineState() Failed. retcode = 0x%x", hr);
+		pPipeline.Reset();
+		return false;
+	}
+
+	return true;
+}
+
+// add a created pipeline state
+ID3D12PipelineState* PipelineCache::AddPipeline(uint64_t hash, ID3D12PipelineState* pPipeline, bool isFromLibrary)
+{
+	// a synchronous call may have created it while it was compiling
+	auto itr = m_Pipelines.find(hash);
+	if (itr != m_Pipelines.end())
+	{
+		return itr->second.Get();
+	}
+
+	if (isFromLibrary)
+	{
+		m_LibraryHits++;
+	}
+	else if (m_pLibrary != nullptr)
+	{
+		auto name = GetPipelineName(hash);
+
+		std::lock_guard<std::mutex> lock(m_LibraryMutex);
+		if (SUCCEEDED(m_pLibrary->StorePipeline(name.c_str(), pPipeline)))
+		{
+			m_IsDirty = true;
+		}
+	}
+
+	m_Pipelines[hash] = pPipeline;
+	return pPipeline;
+}
+
+// copy a description which is compiled later
+void PipelineCache::CopyDesc(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, Item& item)
+{
+	item.Desc = desc;
+	item.Desc.CachedPSO = {};
+
+	// shaders
+	D3D12_SHADER_BYTECODE* pShaders[] = {
+		&item.Desc.VS,
+		&item.Desc.PS,
+		&item.Desc.DS,
+		&item.Desc.HS,
+		&item.Desc.GS,
+	};
+
+	for (auto i = 0; i < 5; ++i)
+	{
+		auto pShader = pShaders[i];
+		if (pShader->pShaderBytecode == nullptr || pShader->BytecodeLength == 0)
+		{
+			*pShader = {};
+			continue;
+		}
+
+		auto ptr = static_cast<const uint8_t*>(pShader->pShaderBytecode);
+		item.Shaders[i].assign(ptr, ptr + pShader->BytecodeLength);
+		pShader->pShaderBytecode = item.Shaders[i].data();
+	}
+
+	// semantic names are stored first, so the pointers below stay valid
+	const auto& layout = desc.InputLayout;
+	const auto& so = desc.StreamOutput;
+	item.Names.reserve(layout.NumElements + so.NumEntries);
+	for (UINT i = 0; i < layout.NumElements; ++i)
+	{
+		auto name = layout.pInputElementDescs[i].SemanticName;
+		item.Names.push_back((name != nullptr) ? name : "");
+	}
+	for (UINT i = 0; i < so.NumEntries; ++i)
+	{
+		auto name = so.pSODeclaration[i].SemanticName;
+		item.Names.push_back((name != nullptr) ? name : "");
+	}
+
+	// input layout
+	item.Elements.assign(layout.pInputElementDescs, layout.pInputElementDescs + layout.NumElements);
+	for (UINT i = 0; i < layout.NumElements; ++i)
+	{
+		item.Elements[i].SemanticName = item.Names[i].c_str();
+	}
+	item.Desc.InputLayout.pInputElementDescs = item.Elements.data();
+
+	// stream output
+	item.Entries.assign(so.pSODeclaration, so.pSODeclaration + so.NumEntries);
+	for (UINT i = 0; i < so.NumEntries; ++i)
+	{
+		item.Entries[i].SemanticName = item.Names[layout.NumElements + i].c_str();
+	}
+	item.Strides.assign(so.pBufferStrides, so.pBufferStrides + so.NumStrides);
+	item.Desc.StreamOutput.pSODeclaration = item.Entries.data();
+	item.Desc.StreamOutput.pBufferStrides = item.Strides.data();
+}
+
+// compile a requested pipeline state (worker thread)
+bool PipelineCache::Compile(uint32_t id)
+{
+	Item* pItem = nullptr;
+	{
+		std::lock_guard<std::mutex> lock(m_ItemMutex);
+		auto itr = m_pItems.find(id);
+		if (itr == m_pItems.end())
+		{
+			return false;
+		}
+
+		pItem = itr->second;
+	}
+
+	return CreatePipeline(pItem->Desc, pItem->Hash, pItem->pPipeline, pItem->IsFromLibrary);
+}
+
+// take the result of a requested pipeline state
+void PipelineCache::Finish(uint32_t id, COMPILE_STATE state)
+{
+	Item* pItem = nullptr;
+	{
+		std::lock_guard<std::mutex> lock(m_ItemMutex);
+		auto itr = m_pItems.find(id);
+		if (itr == m_pItems.end())
+		{
+			return;
+		}
+
+		pItem = itr->second;
+		m_pItems.erase(itr);
+	}
+
+	if (state == COMPILE_STATE_READY)
+	{
+		AddPipeline(pItem->Hash, pItem->pPipeline.Get(), pItem->IsFromLibrary);
+	}
+
+	delete pItem;
+}
@@ -0,0 +1,135 @@
+#include "QueueSyncTracker.h"
+#include <algorithm>
+
+//
+// QueueSyncTracker class
+//
+
+// constructor
+QueueSyncTracker::QueueSyncTracker()
+{
+	Reset();
+}
+
+// destructor
+QueueSyncTracker::~QueueSyncTracker()
+{
+}
+
+// forget every signal and wait
+void QueueSyncTracker::Reset()
+{
+	for (auto i = 0; i < QUEUE_TYPE_COUNT; ++i)
+	{
+		for (auto j = 0; j < QUEUE_TYPE_COUNT; ++j)
+		{
+			m_Known[i][j] = 0;
+		}
+
+		m_Completed[i] = 0;
+		m_History[i].clear();
+	}
+}
+
+// record a signal
+bool QueueSyncTracker::Signal(QUEUE_TYPE queue, uint64_t value)
+{
+	if (value <= m_Known[queue][queue])
+	{
+		return false;
+	}
+
+	m_Known[queue][queue] = value;
+
+	Snapshot snapshot;
+	snapshot.Value = value;
+	for (auto i = 0; i < QUEUE_TYPE_COUNT; ++i)
+	{
+		snapshot.Known[i] = m_Known[queue][i];
+	}
+	m_History[queue].push_back(snapshot);
+
+	return true;
+}
+
+// check whether a queue has to wait for a value
+bool QueueSyncTracker::NeedsWait(QUEUE_TYPE waiter, QUEUE_TYPE signaler, uint64_t value) const
+{
+	if (waiter == signaler)
+	{
+		return false;
+	}
+
+	return value > m_Completed[signaler] && value > m_Known[waiter][signaler];
+}
+
+// record a wait
+void QueueSyncTracker::Wait(QUEUE_TYPE waiter, QUEUE_TYPE signaler, uint64_t value)
+{
+	if (waiter == signaler)
+	{
+		return;
+	}
+
+	auto& known = m_Known[waiter];
+	known[signaler] = std::max(known[signaler], value);
+
+	// signals which have completed are no longer in the history, and a later one may not
+	// have been reached yet
+	if (value <= m_Completed[signaler])
+	{
+		return;
+	}
+
+	// the wait ends at the first signal which reaches the value, so it is ordered after
+	// whatever that signal was ordered after
+	const auto& history = m_History[signaler];
+	for (size_t i = 0; i < history.size(); ++i)
+	{
+		if (history[i].Value < value)
+		{
+			continue;
+		}
+
+		for (auto j = 0; j < QUEUE_TYPE_COUNT; ++j)
+		{
+			// a queue's own value only moves by its signals
+			if (j != waiter)
+			{
+				known[j] = std::max(known[j], history[i].Known[j]);
+			}
+		}
+		break;
+	}
+}
+
+// record a completed value
+void QueueSyncTracker::Complete(QUEUE_TYPE queue, uint64_t completedValue)
+{
+	m_Completed[queue] = std::max(m_Completed[queue], completedValue);
+
+	// completed signals are never waited for again
+	auto& history = m_History[queue];
+	while (!history.empty() && history.front().Value <= m_Completed[queue])
+	{
+		history.pop_front();
+	}
+}
+
+// get the highest value of a queue which the next work of another is ordered after
+uint64_t QueueSyncTracker::GetKnownValue(QUEUE_TYPE waiter, QUEUE_TYPE signaler) const
+{
+	return m_Known[waiter][signaler];
+}
+
+// get the last signaled value of a queue
+uint64_t QueueSyncTracker::GetSignaledValue(QUEUE_TYPE queue) const
+{
+	return m_Known[queue][queue];
+}
+
+// get the last completed value of a queue
+uint64_t QueueSyncTracker::GetCompletedValue(QUEUE_TYPE queue) const
+{
+	return m_Completed[queue];
+}
@@ -0,0 +1,560 @@
+#include "RenderGraph.h"
+#include "IntervalPacker.h"
+#include "Logger.h"
+#include <algorithm>
+
+namespace {
+	// check whether a usage is one write usage
+	bool IsSingleWrite(uint32_t usage)
+	{
+		return usage != 0
+			&& (usage & ~uint32_t(RESOURCE_USAGE_WRITE_MASK)) == 0
+			&& (usage & (usage - 1)) == 0;
+	}
+} // namespace
+
+//
+// RenderGraph class
+//
+
+// constructor
+RenderGraph::RenderGraph()
+	: m_HeapSize(0)
+	, m_UnaliasedSize(0)
+{
+}
+
+// destructor
+RenderGraph::~RenderGraph()
+{
+	Reset();
+}
+
+// discard every pass, resource and compiled result
+void RenderGraph::Reset()
+{
+	m_Passes.clear();
+	m_Resources.clear();
+	m_Order.clear();
+	m_FinalBarriers.clear();
+	m_HeapSize = 0;
+	m_UnaliasedSize = 0;
+}
+
+// add a resource
+uint32_t RenderGraph::AddResource(const char* name, const ResourceDesc& desc)
+{
+	if (desc.IsTransient)
+	{
+		if (desc.Size == 0 || desc.Alignment == 0 || (desc.Alignment & (desc.Alignment - 1)) != 0)
+		{
+			ELOG("Error : Invalid size or alignment of transient resource %s.", name);
+			return InvalidId;
+		}
+	}
+
+	Resource resource = {};
+	resource.Name = (name != nullptr) ? name : "";
+	resource.Desc = desc;
+	resource.IsPlaced = false;
+
+	m_Resources.push_back(resource);
+	return uint32_t(m_Resources.size() - 1);
+}
+
+// add a pass
+uint32_t RenderGraph::AddPass(const char* name, bool hasSideEffects)
+{
+	Pass pass;
+	pass.Name = (name != nullptr) ? name : "";
+	pass.HasSideEffects = hasSideEffects;
+	pass.IsCulled = false;
+
+	m_Passes.push_back(pass);
+	return uint32_t(m_Passes.size() - 1);
+}
+
+// declare that a pass reads a resource
+bool RenderGraph::Read(uint32_t pass, uint32_t resource, uint32_t usage)
+{
+	if (pass >= m_Passes.size() || resource >= m_Resources.size() || usage == 0)
+	{
+		return false;
+	}
+
+	auto pAccess = FindAccess(pass, resource);
+	if (pAccess == nullptr)
+	{
+		if ((usage & RESOURCE_USAGE_WRITE_MASK) != 0 && !IsSingleWrite(usage))
+		{
+			return false;
+		}
+
+		Access access = {};
+		access.Resource = resource;
+		access.Usage = usage;
+		access.IsRead = true;
+		access.IsWrite = false;
+		m_Passes[pass].Accesses.push_back(access);
+		return true;
+	}
+
+	// read usages are merged. a written resource is read with the usage it is written with
+	if (pAccess->IsWrite)
+	{
+		if (pAccess->Usage != usage)
+		{
+			ELOG("Error : Pass %s reads %s with another usage than it writes it.",
+				m_Passes[pass].Name.c_str(), m_Resources[resource].Name.c_str());
+			return false;
+		}
+	}
+	else
+	{
+		if ((usage & RESOURCE_USAGE_WRITE_MASK) != 0 || (pAccess->Usage & RESOURCE_USAGE_WRITE_MASK) != 0)
+		{
+			return false;
+		}
+
+		pAccess->Usage |= usage;
+	}
+
+	pAccess->IsRead = true;
+	return true;
+}
+
+// declare that a pass writes a resource
+bool RenderGraph::Write(uint32_t pass, uint32_t resource, uint32_t usage)
+{
+	if (pass >= m_Passes.size() || resource >= m_Resources.size() || !IsSingleWrite(usage))
+	{
+		return false;
+	}
+
+	auto pAccess = FindAccess(pass, resource);
+	if (pAccess == nullptr)
+	{
+		Access access = {};
+		access.Resource = resource;
+		access.Usage = usage;
+		access.IsRead = false;
+		access.IsWrite = true;
+		m_Passes[pass].Accesses.push_back(access);
+		return true;
+	}
+
+	if (pAccess->Usage != usage)
+	{
+		ELOG("Error : Pass %s writes %s with another usage than it reads it.",
+			m_Passes[pass].Name.c_str(), m_Resources[resource].Name.c_str());
+		return false;
+	}
+
+	pAccess->IsWrite = true;
+	return true;
+}
+
+// cull passes, derive barriers and place transient resources
+bool RenderGraph::Compile()
+{
+	m_Order.clear();
+	m_FinalBarriers.clear();
+	m_HeapSize = 0;
+	m_UnaliasedSize = 0;
+
+	for (auto& pass : m_Passes)
+	{
+		pass.Barriers.clear();
+	}
+
+	for (auto& resource : m_Resources)
+	{
+		resource.IsPlaced = false;
+		resource.Place = Placement();
+	}
+
+	Cull();
+
+	for (uint32_t i = 0; i < m_Passes.size(); ++i)
+	{
+		if (!m_Passes[i].IsCulled)
+		{
+			m_Order.push_back(i);
+		}
+	}
+
+	BuildBarriers();
+
+	return PlaceResources();
+}
+
+// check whether a pass has been culled
+bool RenderGraph::IsCulled(uint32_t pass) const
+{
+	if (pass >= m_Passes.size())
+	{
+		return true;
+	}
+
+	return m_Passes[pass].IsCulled;
+}
+
+// get ids of the passes to run
+const std::vector<uint32_t>& RenderGraph::GetPassOrder() const
+{
+	return m_Order;
+}
+
+// get barriers to issue before a pass
+const std::vector<RenderGraph::Barrier>& RenderGraph::GetBarriers(uint32_t pass) const
+{
+	static const std::vector<Barrier> empty;
+	if (pass >= m_Passes.size())
+	{
+		return empty;
+	}
+
+	return m_Passes[pass].Barriers;
+}
+
+// get barriers to issue after the last pass
+const std::vector<RenderGraph::Barrier>& RenderGraph::GetFinalBarriers() const
+{
+	return m_FinalBarriers;
+}
+
+// get placement of a transient resource
+bool RenderGraph::GetPlacement(uint32_t resource, Placement& result) const
+{
+	if (resource >= m_Resources.size() || !m_Resources[resource].IsPlaced)
+	{
+		return false;
+	}
+
+	result = m_Resources[resource].Place;
+	return true;
+}
+
+// get size of the transient heap
+uint64_t RenderGraph::GetHeapSize() const
+{
+	return m_HeapSize;
+}
+
+// get size of transient resources without sharing memory
+uint64_t RenderGraph::GetUnaliasedSize() const
+{
+	return m_UnaliasedSize;
+}
+
+// get pass count
+uint32_t RenderGraph::GetPassCount() const
+{
+	return uint32_t(m_Passes.size());
+}
+
+// get resource count
+uint32_t RenderGraph::GetResourceCount() const
+{
+	return uint32_t(m_Resources.size());
+}
+
+// get name of a pass
+const char* RenderGraph::GetPassName(uint32_t pass) const
+{
+	if (pass >= m_Passes.size())
+	{
+		return "";
+	}
+
+	return m_Passes[pass].Name.c_str();
+}
+
+// get name of a resource
+const char* RenderGraph::GetResourceName(uint32_t resource) const
+{
+	if (resource >= m_Resources.size())
+	{
+		return "";
+	}
+
+	return m_Resources[resource].Name.c_str();
+}
+
+// find the access of a pass to a resource
+RenderGraph::Access* RenderGraph::FindAccess(uint32_t pass, uint32_t resource)
+{
+	for (auto& access : m_Passes[pass].Accesses)
+	{
+		if (access.Resource == resource)
+		{
+			return &access;
+		}
+	}
+
+	return nullptr;
+}
+
+// mark passes which do not contribute to outputs
+void RenderGraph::Cull()
+{
+	// walk back from the outputs. a resource is needed while a later pass reads it
+	std::vector<bool> needed(m_Resources.size());
+	for (size_t i = 0; i < m_Resources.size(); ++i)
+	{
+		needed[i] = m_Resources[i].Desc.IsOutput;
+	}
+
+	for (auto i = m_Passes.size(); i > 0; --i)
+	{
+		auto& pass = m_Passes[i - 1];
+
+		pass.IsCulled = !pass.HasSideEffects;
+		for (const auto& access : pass.Accesses)
+		{
+			if (access.IsWrite && needed[access.Resource])
+			{
+				pass.IsCulled = false;
+			}
+		}
+
+		if (pass.IsCulled)
+		{
+			continue;
+		}
+
+		// an overwrite ends the need for earlier writes, a read starts it
+		for (const auto& access : pass.Accesses)
+		{
+			if (access.IsWrite && !access.IsRead)
+			{
+				needed[access.Resource] = false;
+			}
+		}
+
+		for (const auto& access : pass.Accesses)
+		{
+			if (access.IsRead)
+			{
+				needed[access.Resource] = true;
+			}
+		}
+	}
+}
+
+// derive barriers of passes not culled
+void RenderGraph::BuildBarriers()
+{
+	std::vector<uint32_t> current(m_Resources.size());
+	for (size_t i = 0; i < m_Resources.size(); ++i)
+	{
+		current[i] = m_Resources[i].Desc.Usage;
+	}
+
+	for (size_t i = 0; i < m_Order.size(); ++i)
+	{
+		auto& pass = m_Passes[m_Order[i]];
+
+		for (const auto& access : pass.Accesses)
+		{
+			auto before = current[access.Resource];
+			auto after = access.Usage;
+
+			// a usage which writes does not combine with others
+			if (access.IsWrite || (after & RESOURCE_USAGE_WRITE_MASK) != 0)
+			{
+				if (before == after)
+				{
+					continue;
+				}
+			}
+			else
+			{
+				// a read state which already covers the usage needs no barrier
+				if ((before & RESOURCE_USAGE_WRITE_MASK) == 0 && (before & after) == after)
+				{
+					continue;
+				}
+
+				// take the usages of the following reads too, so they need no barrier
+				for (auto j = i + 1; j < m_Order.size(); ++j)
+				{
+					auto pNext = FindAccess(m_Order[j], access.Resource);
+					if (pNext == nullptr)
+					{
+						continue;
+					}
+
+					if (pNext->IsWrite || (pNext->Usage & RESOURCE_USAGE_WRITE_MASK) != 0)
+					{
+						break;
+					}
+
+					after |= pNext->Usage;
+				}
+			}
+
+			Barrier barrier = {};
+			barrier.Type = BARRIER_TYPE_TRANSITION;
+			barrier.Resource = access.Resource;
+			barrier.ResourceBefore = InvalidId;
+			barrier.Before = before;
+			barrier.After = after;
+			pass.Barriers.push_back(barrier);
+
+			current[access.Resource] = after;
+		}
+	}
+
+	// return to the usage between frames
+	for (uint32_t i = 0; i < m_Resources.size(); ++i)
+	{
+		if (current[i] == m_Resources[i].Desc.Usage)
+		{
+			continue;
+		}
+
+		Barrier barrier = {};
+		barrier.Type = BARRIER_TYPE_TRANSITION;
+		barrier.Resource = i;
+		barrier.ResourceBefore = InvalidId;
+		barrier.Before = current[i];
+		barrier.After = m_Resources[i].Desc.Usage;
+		m_FinalBarriers.push_back(barrier);
+	}
+}
+
+// place transient resources and add aliasing barriers
+bool RenderGraph::PlaceResources()
+{
+	// lifetime of each transient resource over the passes to run
+	IntervalPacker packer;
+	std::vector<uint32_t> placed;
+	for (uint32_t i = 0; i < m_Resources.size(); ++i)
+	{
+		auto& resource = m_Resources[i];
+		if (!resource.Desc.IsTransient)
+		{
+			continue;
+		}
+
+		for (uint32_t j = 0; j < m_Order.size(); ++j)
+		{
+			if (FindAccess(m_Order[j], i) == nullptr)
+			{
+				continue;
+			}
+
+			if (!resource.IsPlaced)
+			{
+				resource.IsPlaced = true;
+				resource.Place.FirstPass = j;
+			}
+			resource.Place.LastPass = j;
+		}
+
+		if (resource.IsPlaced)
+		{
+			packer.Add(resource.Place.FirstPass, resource.Place.LastPass, resource.Desc.Size, resource.Desc.Alignment);
+			placed.push_back(i);
+		}
+	}
+
+	packer.Pack();
+
+	for (uint32_t i = 0; i < placed.size(); ++i)
+	{
+		auto& place = m_Resources[placed[i]].Place;
+		place.Offset = packer.GetOffset(i);
+		place.Size = m_Resources[placed[i]].Desc.Size;
+	}
+
+	m_HeapSize = packer.GetSize();
+	m_UnaliasedSize = packer.GetUnaliasedSize();
+
+	// a resource taking over memory needs an aliasing barrier for each resource which used it last.
+	// frames repeat, so resources used after it in the frame used the memory in the previous frame
+	auto passCount = int64_t(m_Order.size());
+	std::vector<Barrier> aliasing;
+	for (uint32_t i = 0; i < placed.size(); ++i)
+	{
+		const auto& place = m_Resources[placed[i]].Place;
+
+		// passes of another resource, relative to the frame in which this resource starts
+		auto getShift = [&](uint32_t index)
+		{
+			return (m_Resources[placed[index]].Place.LastPass < place.FirstPass) ? 0 : passCount;
+		};
+		auto getFirst = [&](uint32_t index)
+		{
+			return int64_t(m_Resources[placed[index]].Place.FirstPass) - getShift(index);
+		};
+		auto getLast = [&](uint32_t index)
+		{
+			return int64_t(m_Resources[placed[index]].Place.LastPass) - getShift(index);
+		};
+
+		aliasing.clear();
+		for (uint32_t j = 0; j < placed.size(); ++j)
+		{
+			if (j == i || !packer.IsOverlapped(i, j))
+			{
+				continue;
+			}
+
+			const auto& prev = m_Resources[placed[j]].Place;
+			auto overlapBegin = std::max(place.Offset, prev.Offset);
+			auto overlapEnd = std::min(place.Offset + place.Size, prev.Offset + prev.Size);
+
+			// skip it if a resource in between has taken over the overlap
+			auto isCovered = false;
+			for (uint32_t k = 0; k < placed.size(); ++k)
+			{
+				const auto& next = m_Resources[placed[k]].Place;
+				if (k != i
+					&& k != j
+					&& getLast(j) < getFirst(k)
+					&& next.Offset <= overlapBegin
+					&& overlapEnd <= next.Offset + next.Size)
+				{
+					isCovered = true;
+					break;
+				}
+			}
+
+			if (isCovered)
+			{
+				continue;
+			}
+
+			Barrier barrier = {};
+			barrier.Type = BARRIER_TYPE_ALIASING;
+			barrier.Resource = placed[i];
+			barrier.ResourceBefore = placed[j];
+			barrier.Before = RESOURCE_USAGE_NONE;
+			barrier.After = RESOURCE_USAGE_NONE;
+			aliasing.push_back(barrier);
+		}
+
+		if (aliasing.empty())
+		{
+			continue;
+		}
+
+		// the contents are undefined after aliasing, so the first use has to overwrite them
+		auto pass = m_Order[place.FirstPass];
+		auto pAccess = FindAccess(pass, placed[i]);
+		if (pAccess->IsRead)
+		{
+			ELOG("Error : Pass %s reads %s whose memory is shared, before it is written.",
+				m_Passes[pass].Name.c_str(), m_Resources[placed[i]].Name.c_str());
+			return false;
+		}
+
+		// aliasing barriers go before the transitions of the pass
+		auto& barriers = m_Passes[pass].Barriers;
+		barriers.insert(barriers.begin(), aliasing.begin(), aliasing.end());
+	}
+
+	return true;
+}
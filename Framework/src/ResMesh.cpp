@@ -1,13 +1,27 @@
 #include "ResMesh.h"
+#include "MeshOptimizer.h"
+#include "ThreadPool.h"
+#include "Logger.h"
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 #include <assimp/cimport.h>
 #include <codecvt>
 #include <cassert>
+#include <chrono>
 
 namespace {
 
+	// post processing of the importer (part of the cooked mesh key)
+	const unsigned int ImportFlags
+		= aiProcess_Triangulate
+		| aiProcess_PreTransformVertices
+		| aiProcess_CalcTangentSpace
+		| aiProcess_GenSmoothNormals
+		| aiProcess_GenUVCoords
+		| aiProcess_RemoveRedundantMaterials
+		| aiProcess_OptimizeMeshes;
+
 	// convert to UTF-8
 	std::string ToUTF8(const std::wstring& value)
 	{
@@ -48,7 +62,8 @@ namespace {
 		bool Load(
 			const wchar_t* filename,
 			std::vector<ResMesh>& meshes,
-			std::vector<ResMaterial>& materials);
+			std::vector<ResMaterial>& materials,
+			ThreadPool* pPool);
 
 	private:
 
@@ -74,7 +89,8 @@ namespace {
 	(
 		const wchar_t* filename,
 		std::vector<ResMesh>& meshes,
-		std::vector<ResMaterial>& materials
+		std::vector<ResMaterial>& materials,
+		ThreadPool* pPool
 	)
 	{
 		if (filename == nullptr)
@@ -86,17 +102,9 @@ namespace {
 		auto path = ToUTF8(filename);
 
 		Assimp::Importer importer;
-		unsigned int flag = 0;
-		flag |= aiProcess_Triangulate;
-		flag |= aiProcess_PreTransformVertices;
-		flag |= aiProcess_CalcTangentSpace;
-		flag |= aiProcess_GenSmoothNormals;
-		flag |= aiProcess_GenUVCoords;
-		flag |= aiProcess_RemoveRedundantMaterials;
-		flag |= aiProcess_OptimizeMeshes;
 
 		// read the file
-		m_pScene = importer.ReadFile(path, flag);
+		m_pScene = importer.ReadFile(path, ImportFlags);
 
 		// check
 		if (m_pScene == nullptr)
@@ -104,26 +112,36 @@ namespace {
 			return false;
 		}
 
+		// an uninitialized pool runs ParallelFor() on this thread
+		ThreadPool serial;
+		auto& pool = (pPool != nullptr) ? *pPool : serial;
+
 		//alloc memory of mesh
 		meshes.clear();
 		meshes.resize(m_pScene->mNumMeshes);
 
-		for (size_t i = 0; i < meshes.size(); ++i)
+		// every mesh only reads the scene and writes its own slot, so they convert in parallel
+		pool.ParallelFor(meshes.size(), [&](size_t i)
 		{
 			const auto pMesh = m_pScene->mMeshes[i];
 			ParseMesh(meshes[i], pMesh);
-		}
+
+			// reorder for the vertex cache, overdraw and vertex fetch
+			auto stats = OptimizeMesh(meshes[i]);
+			DLOG("Info : mesh[%zu] ACMR %f -> %f, ATVR %f -> %f",
+				i, stats.AcmrBefore, stats.AcmrAfter, stats.AtvrBefore, stats.AtvrAfter);
+		});
 
 		// alloc meory of material
 		materials.clear();
 		materials.resize(m_pScene->mNumMaterials);
 
 		// convert material data
-		for (size_t i = 0; i < materials.size(); ++i)
+		pool.ParallelFor(materials.size(), [&](size_t i)
 		{
 			const auto pMaterial = m_pScene->mMaterials[i];
 			ParseMaterial(materials[i], pMaterial);
-		}
+		}, 16);
 
 		// clear as these are no longer necessary
 		importer.FreeScene();
@@ -139,24 +157,57 @@ namespace {
 		// set material id
 		dstMesh.MaterialId = pSrcMesh->mMaterialIndex;
 
-		aiVector3D zero3D(0.0f, 0.0f, 0.0f);
-
 		// alloc memory of vertex data (change the size of vector)
 		dstMesh.Vertices.resize(pSrcMesh->mNumVertices);
 
-		for (auto i = 0u; i < pSrcMesh->mNumVertices; ++i)
+		// copy one attribute stream at a time. the loops have no branches and a fixed
+		// stride, so the compiler can vectorize them
+		auto pDst = dstMesh.Vertices.data();
+		const auto count = pSrcMesh->mNumVertices;
+		static_assert(sizeof(aiVector3D) == sizeof(DirectX::XMFLOAT3), "aiVector3D layout mismatch");
+
+		const auto pPositions = reinterpret_cast<const DirectX::XMFLOAT3*>(pSrcMesh->mVertices);
+		for (auto i = 0u; i < count; ++i)
+		{
+			pDst[i].Position = pPositions[i];
+		}
+
+		const auto pNormals = reinterpret_cast<const DirectX::XMFLOAT3*>(pSrcMesh->mNormals);
+		for (auto i = 0u; i < count; ++i)
+		{
+			pDst[i].Normal = pNormals[i];
+		}
+
+		if (pSrcMesh->HasTextureCoords(0))
+		{
+			const auto pTexCoords = pSrcMesh->mTextureCoords[0];
+			for (auto i = 0u; i < count; ++i)
+			{
+				pDst[i].TexCoord = DirectX::XMFLOAT2(pTexCoords[i].x, pTexCoords[i].y);
+			}
+		}
+		else
+		{
+			for (auto i = 0u; i < count; ++i)
+			{
+				pDst[i].TexCoord = DirectX::XMFLOAT2(0.0f, 0.0f);
+			}
+		}
+
+		if (pSrcMesh->HasTangentsAndBitangents())
 		{
-			auto pPosition = &(pSrcMesh->mVertices[i]);
-			auto pNormal = &(pSrcMesh->mNormals[i]);
-			auto pTexCoord = (pSrcMesh->HasTextureCoords(0)) ? &(pSrcMesh->mTextureCoords[0][i]) : &zero3D;
-			auto pTangent = (pSrcMesh->HasTangentsAndBitangents()) ? &(pSrcMesh->mTangents[i]) : &zero3D;
-
-			dstMesh.Vertices[i] = MeshVertex(
-				DirectX::XMFLOAT3(pPosition->x, pPosition->y, pPosition->z),
-				DirectX::XMFLOAT3(pNormal->x, pNormal->y, pNormal->z),
-				DirectX::XMFLOAT2(pTexCoord->x, pTexCoord->y),
-				DirectX::XMFLOAT3(pTangent->x, pTangent->y, pTangent->z)
-			);
+			const auto pTangents = reinterpret_cast<const DirectX::XMFLOAT3*>(pSrcMesh->mTangents);
+			for (auto i = 0u; i < count; ++i)
+			{
+				pDst[i].Tangent = pTangents[i];
+			}
+		}
+		else
+		{
+			for (auto i = 0u; i < count; ++i)
+			{
+				pDst[i].Tangent = DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f);
+			}
 		}
 
 		// alloc memory of index of vertex
@@ -306,9 +357,37 @@ bool LoadMesh
 (
 	const wchar_t* filename,
 	std::vector<ResMesh>& meshes,
-	std::vector<ResMaterial>& materials
+	std::vector<ResMaterial>& materials,
+	ThreadPool* pPool
 )
 {
+	if (filename == nullptr)
+	{
+		return false;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	auto GetElapsedMsec = [&start]()
+	{
+		auto end = std::chrono::steady_clock::now();
+		return std::chrono::duration<double, std::milli>(end - start).count();
+	};
+
 	MeshLoader loader;
-	return loader.Load(filename, meshes, materials);
+	if (!loader.Load(filename, meshes, materials, pPool))
+	{
+		return false;
+	}
+
+	DLOG("Info : imported mesh in %f msec. filepath = %ls", GetElapsedMsec(), filename);
+
+	return true;
+}
+
+//
+// get importer flags
+//
+uint32_t GetMeshImportFlags()
+{
+	return ImportFlags;
 }
\ No newline at end of file
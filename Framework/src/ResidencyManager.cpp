@@ -0,0 +1,323 @@
+#include "ResidencyManager.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+//
+// ResidencyManager class
+//
+
+// constructor
+ResidencyManager::ResidencyManager()
+	: m_Budget(0)
+	, m_MaxUploadBytes(0)
+	, m_UsedBytes(0)
+	, m_Frame(0)
+{
+}
+
+// destructor
+ResidencyManager::~ResidencyManager()
+{
+	Term();
+}
+
+// initialize
+bool ResidencyManager::Init(uint64_t budget, uint64_t maxUploadBytes)
+{
+	if (budget == 0)
+	{
+		return false;
+	}
+
+	Term();
+
+	m_Budget = budget;
+	m_MaxUploadBytes = maxUploadBytes;
+
+	return true;
+}
+
+// end
+void ResidencyManager::Term()
+{
+	m_Entries.clear();
+	m_FreeIds.clear();
+	m_Registered.clear();
+	m_Budget = 0;
+	m_MaxUploadBytes = 0;
+	m_UsedBytes = 0;
+	m_Frame = 0;
+}
+
+// register a texture
+uint32_t ResidencyManager::Register(const uint64_t* pMipSizes, uint32_t mipCount, uint32_t tailMip)
+{
+	if (pMipSizes == nullptr || mipCount == 0 || tailMip >= mipCount)
+	{
+		return InvalidId;
+	}
+
+	uint32_t id = 0;
+	if (!m_FreeIds.empty())
+	{
+		id = m_FreeIds.back();
+		m_FreeIds.pop_back();
+	}
+	else
+	{
+		id = uint32_t(m_Entries.size());
+		m_Entries.emplace_back();
+	}
+
+	auto& entry = m_Entries[id];
+	entry.Bytes.resize(mipCount + 1);
+	entry.Bytes[mipCount] = 0;
+	for (auto i = mipCount; i > 0; --i)
+	{
+		entry.Bytes[i - 1] = entry.Bytes[i] + pMipSizes[i - 1];
+	}
+
+	entry.TailMip = tailMip;
+	entry.ResidentMip = tailMip;
+	entry.RequestedMip = tailMip;
+	entry.LastUsed = m_Frame;
+	entry.IsActive = true;
+
+	m_UsedBytes += entry.Bytes[tailMip];
+	m_Registered.push_back({ id, tailMip });
+
+	return id;
+}
+
+// unregister a texture
+void ResidencyManager::Unregister(uint32_t id)
+{
+	if (id >= m_Entries.size() || !m_Entries[id].IsActive)
+	{
+		return;
+	}
+
+	auto& entry = m_Entries[id];
+	m_UsedBytes -= entry.Bytes[entry.ResidentMip];
+	entry.Bytes.clear();
+	entry.IsActive = false;
+	m_FreeIds.push_back(id);
+
+	m_Registered.erase(
+		std::remove_if(m_Registered.begin(), m_Registered.end(), [id](const Change& change) { return change.Id == id; }),
+		m_Registered.end());
+}
+
+// request mips for the current frame
+void ResidencyManager::Request(uint32_t id, uint32_t mip)
+{
+	if (id >= m_Entries.size() || !m_Entries[id].IsActive)
+	{
+		return;
+	}
+
+	auto& entry = m_Entries[id];
+	if (entry.LastUsed != m_Frame || mip < entry.RequestedMip)
+	{
+		entry.RequestedMip = mip;
+	}
+
+	entry.LastUsed = m_Frame;
+}
+
+// decide residency
+void ResidencyManager::Update(std::vector<Change>& changes)
+{
+	changes.clear();
+	changes.swap(m_Registered);
+
+	// textures which need finer mips, and textures holding more than they need
+	std::vector<uint32_t> upgrades;
+	std::vector<uint32_t> evictable;
+	uint64_t reclaimable = 0;
+
+	for (auto i = 0u; i < uint32_t(m_Entries.size()); ++i)
+	{
+		const auto& entry = m_Entries[i];
+		if (!entry.IsActive)
+		{
+			continue;
+		}
+
+		auto needed = GetNeededMip(entry);
+		if (needed < entry.ResidentMip)
+		{
+			upgrades.push_back(i);
+		}
+		else if (needed > entry.ResidentMip)
+		{
+			evictable.push_back(i);
+			reclaimable += entry.Bytes[entry.ResidentMip] - entry.Bytes[needed];
+		}
+	}
+
+	// the least recently used textures are evicted first
+	std::sort(evictable.begin(), evictable.end(), [this](uint32_t lhs, uint32_t rhs)
+	{
+		return m_Entries[lhs].LastUsed < m_Entries[rhs].LastUsed;
+	});
+
+	// the textures furthest from what they need are upgraded first
+	std::sort(upgrades.begin(), upgrades.end(), [this](uint32_t lhs, uint32_t rhs)
+	{
+		const auto& a = m_Entries[lhs];
+		const auto& b = m_Entries[rhs];
+		return (a.ResidentMip - GetNeededMip(a)) > (b.ResidentMip - GetNeededMip(b));
+	});
+
+	size_t nextEvict = 0;
+	auto evict = [&](uint64_t required)
+	{
+		while (m_UsedBytes + required > m_Budget && nextEvict < evictable.size())
+		{
+			auto id = evictable[nextEvict++];
+			auto& entry = m_Entries[id];
+			auto needed = GetNeededMip(entry);
+			auto freed = entry.Bytes[entry.ResidentMip] - entry.Bytes[needed];
+
+			m_UsedBytes -= freed;
+			reclaimable -= freed;
+			entry.ResidentMip = needed;
+			changes.push_back({ id, needed });
+		}
+	};
+
+	// a smaller budget drops unused mips even if nothing is requested
+	evict(0);
+
+	uint64_t uploaded = 0;
+	for (size_t i = 0; i < upgrades.size(); ++i)
+	{
+		auto id = upgrades[i];
+		auto& entry = m_Entries[id];
+
+		// the finest mip that fits, at least one step for the first upgrade of an update
+		for (auto target = GetNeededMip(entry); target < entry.ResidentMip; ++target)
+		{
+			auto cost = entry.Bytes[target] - entry.Bytes[entry.ResidentMip];
+			auto upload = entry.Bytes[target];
+
+			if (m_MaxUploadBytes > 0 && uploaded > 0 && uploaded + upload > m_MaxUploadBytes)
+			{
+				continue;
+			}
+
+			if (m_UsedBytes + cost > m_Budget + reclaimable)
+			{
+				continue;
+			}
+
+			evict(cost);
+
+			m_UsedBytes += cost;
+			uploaded += upload;
+			entry.ResidentMip = target;
+			changes.push_back({ id, target });
+			break;
+		}
+	}
+
+	m_Frame++;
+}
+
+// correct the resident mip of a texture
+void ResidencyManager::SetResidentMip(uint32_t id, uint32_t mip)
+{
+	if (id >= m_Entries.size() || !m_Entries[id].IsActive)
+	{
+		return;
+	}
+
+	// Bytes has one more element than mips, which is 0 for nothing resident
+	auto& entry = m_Entries[id];
+	if (mip >= entry.Bytes.size())
+	{
+		return;
+	}
+
+	m_UsedBytes -= entry.Bytes[entry.ResidentMip];
+	m_UsedBytes += entry.Bytes[mip];
+	entry.ResidentMip = mip;
+}
+
+// get most detailed resident mip
+uint32_t ResidencyManager::GetResidentMip(uint32_t id) const
+{
+	if (id >= m_Entries.size() || !m_Entries[id].IsActive)
+	{
+		return 0;
+	}
+
+	return m_Entries[id].ResidentMip;
+}
+
+// get bytes used by resident mips
+uint64_t ResidencyManager::GetUsedBytes() const
+{
+	return m_UsedBytes;
+}
+
+// get budget
+uint64_t ResidencyManager::GetBudget() const
+{
+	return m_Budget;
+}
+
+// set budget
+void ResidencyManager::SetBudget(uint64_t budget)
+{
+	m_Budget = budget;
+}
+
+// get most detailed mip a texture needs this frame
+uint32_t ResidencyManager::GetNeededMip(const Entry& entry) const
+{
+	// textures which were not requested this frame only need their tail
+	if (entry.LastUsed != m_Frame || entry.RequestedMip > entry.TailMip)
+	{
+		return entry.TailMip;
+	}
+
+	return entry.RequestedMip;
+}
+
+// compute projected size on screen
+float ComputeScreenSize(float worldSize, float distance, float fovY, float viewportHeight)
+{
+	if (distance <= 0.0f)
+	{
+		return FLT_MAX;
+	}
+
+	return worldSize * viewportHeight / (2.0f * distance * tanf(fovY * 0.5f));
+}
+
+// select the most detailed mip needed
+uint32_t SelectMip(uint32_t width, uint32_t height, uint32_t mipCount, float screenSize)
+{
+	if (mipCount == 0)
+	{
+		return 0;
+	}
+
+	auto largest = float((width > height) ? width : height);
+	if (screenSize >= largest)
+	{
+		return 0;
+	}
+
+	if (screenSize <= 1.0f)
+	{
+		return mipCount - 1;
+	}
+
+	// each mip halves the texel count along an axis
+	auto mip = uint32_t(floorf(log2f(largest / screenSize)));
+	return (mip < mipCount) ? mip : mipCount - 1;
+}
@@ -0,0 +1,112 @@
+#include "RingAllocator.h"
+
+//
+// RingAllocator class
+//
+
+// constructor
+RingAllocator::RingAllocator()
+	: m_Capacity(0)
+	, m_Head(0)
+	, m_UsedCount(0)
+	, m_FrameSize(0)
+{
+}
+
+// destructor
+RingAllocator::~RingAllocator()
+{
+	Term();
+}
+
+// initialize
+bool RingAllocator::Init(uint32_t capacity)
+{
+	if (capacity == 0 || capacity == InvalidOffset)
+	{
+		return false;
+	}
+
+	Term();
+
+	m_Capacity = capacity;
+	return true;
+}
+
+// end
+void RingAllocator::Term()
+{
+	m_Frames.clear();
+	m_Capacity = 0;
+	m_Head = 0;
+	m_UsedCount = 0;
+	m_FrameSize = 0;
+}
+
+// allocate
+uint32_t RingAllocator::Alloc(uint32_t count)
+{
+	if (count == 0 || count > m_Capacity)
+	{
+		return InvalidOffset;
+	}
+
+	// skip the tail of the ring if the block does not fit before the end
+	auto padding = (m_Head + count > m_Capacity) ? (m_Capacity - m_Head) : 0u;
+
+	if (m_UsedCount + padding + count > m_Capacity)
+	{
+		return InvalidOffset;
+	}
+
+	if (padding > 0)
+	{
+		m_Head = 0;
+	}
+
+	auto offset = m_Head;
+
+	m_Head = (m_Head + count) % m_Capacity;
+	m_UsedCount += padding + count;
+	m_FrameSize += padding + count;
+
+	return offset;
+}
+
+// close current frame
+void RingAllocator::FinishFrame(uint64_t fenceValue)
+{
+	if (m_FrameSize == 0)
+	{
+		return;
+	}
+
+	Frame frame;
+	frame.FenceValue = fenceValue;
+	frame.Size = m_FrameSize;
+	m_Frames.push_back(frame);
+
+	m_FrameSize = 0;
+}
+
+// release completed frames
+void RingAllocator::Retire(uint64_t completedValue)
+{
+	while (!m_Frames.empty() && m_Frames.front().FenceValue <= completedValue)
+	{
+		m_UsedCount -= m_Frames.front().Size;
+		m_Frames.pop_front();
+	}
+}
+
+// get total index count
+uint32_t RingAllocator::GetCapacity() const
+{
+	return m_Capacity;
+}
+
+// get index count in use
+uint32_t RingAllocator::GetUsedCount() const
+{
+	return m_UsedCount;
+}
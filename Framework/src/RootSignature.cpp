@@ -1,5 +1,35 @@
 #include <RootSignature.h>
 #include <Logger.h>
+#include <PipelineCache.h>
+#include <climits>
+
+// compute cost of a root signature
+uint32_t GetRootSignatureCost(const D3D12_ROOT_SIGNATURE_DESC& desc)
+{
+	uint32_t cost = 0;
+	for (UINT i = 0; i < desc.NumParameters; ++i)
+	{
+		const auto& param = desc.pParameters[i];
+		switch (param.ParameterType)
+		{
+		case D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE:
+			cost += 1;
+			break;
+
+		case D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS:
+			cost += param.Constants.Num32BitValues;
+			break;
+
+		case D3D12_ROOT_PARAMETER_TYPE_CBV:
+		case D3D12_ROOT_PARAMETER_TYPE_SRV:
+		case D3D12_ROOT_PARAMETER_TYPE_UAV:
+			cost += 2;
+			break;
+		}
+	}
+
+	return cost;
+}
 
 //
 // RootSignature::Desc class
@@ -56,18 +86,20 @@ void RootSignature::Desc::SetParam
 	ShaderStage stage,
 	int index,
 	uint32_t reg,
-	D3D12_DESCRIPTOR_RANGE_TYPE type
+	uint32_t count,
+	D3D12_DESCRIPTOR_RANGE_TYPE type,
+	uint32_t space
 )
 {
-	if (index >= m_Params.size())
+	if (index < 0 || size_t(index) >= m_Params.size())
 	{
 		return;
 	}
 
 	m_Ranges[index].RangeType = type;
-	m_Ranges[index].NumDescriptors = 1;
+	m_Ranges[index].NumDescriptors = count;
 	m_Ranges[index].BaseShaderRegister = reg;
-	m_Ranges[index].RegisterSpace = 0;
+	m_Ranges[index].RegisterSpace = space;
 	m_Ranges[index].OffsetInDescriptorsFromTableStart = 0;
 
 	m_Params[index].ParameterType = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE;
@@ -78,30 +110,91 @@ void RootSignature::Desc::SetParam
 }
 
 // set constant buffer view
-RootSignature::Desc& RootSignature::Desc::SetCBV(ShaderStage stage, int index, uint32_t reg)
+RootSignature::Desc& RootSignature::Desc::SetCBV(ShaderStage stage, int index, uint32_t reg, uint32_t count)
 {
-	SetParam(stage, index, reg, D3D12_DESCRIPTOR_RANGE_TYPE_CBV);
+	SetParam(stage, index, reg, count, D3D12_DESCRIPTOR_RANGE_TYPE_CBV);
 	return *this;
 }
 
 // set shader resource view
-RootSignature::Desc& RootSignature::Desc::SetSRV(ShaderStage stage, int index, uint32_t reg)
+RootSignature::Desc& RootSignature::Desc::SetSRV(ShaderStage stage, int index, uint32_t reg, uint32_t count)
 {
-	SetParam(stage, index, reg, D3D12_DESCRIPTOR_RANGE_TYPE_SRV);
+	SetParam(stage, index, reg, count, D3D12_DESCRIPTOR_RANGE_TYPE_SRV);
 	return *this;
 }
 
 // set unordered access view
-RootSignature::Desc& RootSignature::Desc::SetUAV(ShaderStage stage, int index, uint32_t reg)
+RootSignature::Desc& RootSignature::Desc::SetUAV(ShaderStage stage, int index, uint32_t reg, uint32_t count)
 {
-	SetParam(stage, index, reg, D3D12_DESCRIPTOR_RANGE_TYPE_UAV);
+	SetParam(stage, index, reg, count, D3D12_DESCRIPTOR_RANGE_TYPE_UAV);
 	return *this;
 }
 
 // set sampler state
-RootSignature::Desc& RootSignature::Desc::SetSmp(ShaderStage stage, int index, uint32_t reg)
+RootSignature::Desc& RootSignature::Desc::SetSmp(ShaderStage stage, int index, uint32_t reg, uint32_t count)
 {
-	SetParam(stage, index, reg, D3D12_DESCRIPTOR_RANGE_TYPE_SAMPLER);
+	SetParam(stage, index, reg, count, D3D12_DESCRIPTOR_RANGE_TYPE_SAMPLER);
+	return *this;
+}
+
+// set shader resource views of unbounded size
+RootSignature::Desc& RootSignature::Desc::SetUnboundedSRV(ShaderStage stage, int index, uint32_t reg, uint32_t space)
+{
+	// the range covers the rest of the heap from the table start (needs shader model 5.1 and
+	// resource binding tier 2). a space of its own keeps it from overlapping other registers
+	SetParam(stage, index, reg, UINT_MAX, D3D12_DESCRIPTOR_RANGE_TYPE_SRV, space);
+	return *this;
+}
+
+// set root constants
+RootSignature::Desc& RootSignature::Desc::SetConstants(ShaderStage stage, int index, uint32_t reg, uint32_t count)
+{
+	if (index < 0 || size_t(index) >= m_Params.size())
+	{
+		return *this;
+	}
+
+	m_Params[index].ParameterType = D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS;
+	m_Params[index].Constants.ShaderRegister = reg;
+	m_Params[index].Constants.RegisterSpace = 0;
+	m_Params[index].Constants.Num32BitValues = count;
+	m_Params[index].ShaderVisibility = D3D12_SHADER_VISIBILITY(stage);
+	CheckStage(stage);
+	return *this;
+}
+
+// set parameters of root descriptor
+void RootSignature::Desc::SetRootParam
+(
+	ShaderStage stage,
+	int index,
+	uint32_t reg,
+	D3D12_ROOT_PARAMETER_TYPE type
+)
+{
+	if (index < 0 || size_t(index) >= m_Params.size())
+	{
+		return;
+	}
+
+	m_Params[index].ParameterType = type;
+	m_Params[index].Descriptor.ShaderRegister = reg;
+	m_Params[index].Descriptor.RegisterSpace = 0;
+	m_Params[index].ShaderVisibility = D3D12_SHADER_VISIBILITY(stage);
+	CheckStage(stage);
+}
+
+// set constant buffer as root descriptor
+RootSignature::Desc& RootSignature::Desc::SetRootCBV(ShaderStage stage, int index, uint32_t reg)
+{
+	SetRootParam(stage, index, reg, D3D12_ROOT_PARAMETER_TYPE_CBV);
+	return *this;
+}
+
+// set buffer shader resource as root descriptor
+RootSignature::Desc& RootSignature::Desc::SetRootSRV(ShaderStage stage, int index, uint32_t reg)
+{
+	SetRootParam(stage, index, reg, D3D12_ROOT_PARAMETER_TYPE_SRV);
 	return *this;
 }
 
@@ -230,6 +323,11 @@ RootSignature::Desc& RootSignature::Desc::End()
 	m_Desc.pStaticSamplers = m_Samplers.data();
 	m_Desc.Flags = D3D12_ROOT_SIGNATURE_FLAGS(m_Flags);
 
+	if (!IsValid())
+	{
+		ELOG("Error : Root Signature Cost Exceeded. cost = %u, max = %u", GetCost(), MaxRootSignatureCost);
+	}
+
 	return *this;
 }
 
@@ -239,6 +337,18 @@ const D3D12_ROOT_SIGNATURE_DESC* RootSignature::Desc::GetDesc() const
 	return &m_Desc;
 }
 
+// obtain cost in DWORDs
+uint32_t RootSignature::Desc::GetCost() const
+{
+	return GetRootSignatureCost(m_Desc);
+}
+
+// check whether the cost fits in the limit
+bool RootSignature::Desc::IsValid() const
+{
+	return GetCost() <= MaxRootSignatureCost;
+}
+
 //
 // RootSignature class
 //
@@ -260,6 +370,19 @@ bool RootSignature::Init(ID3D12Device* pDevice, const D3D12_ROOT_SIGNATURE_DESC*
 	ComPtr<ID3DBlob> pBlob;
 	ComPtr<ID3DBlob> pErrorBlob;
 
+	if (pDesc == nullptr)
+	{
+		return false;
+	}
+
+	// check cost before the runtime rejects it
+	auto cost = GetRootSignatureCost(*pDesc);
+	if (cost > MaxRootSignatureCost)
+	{
+		ELOG("Error : Root Signature Cost Exceeded. cost = %u, max = %u", cost, MaxRootSignatureCost);
+		return false;
+	}
+
 	// serialize
 	auto hr = D3D12SerializeRootSignature(
 		pDesc,
@@ -287,6 +410,18 @@ bool RootSignature::Init(ID3D12Device* pDevice, const D3D12_ROOT_SIGNATURE_DESC*
 	return true;
 }
 
+// initialize from a pipeline cache (shared with identical descriptions)
+bool RootSignature::Init(PipelineCache* pCache, const D3D12_ROOT_SIGNATURE_DESC* pDesc)
+{
+	if (pCache == nullptr)
+	{
+		return false;
+	}
+
+	m_RootSignature = pCache->GetRootSignature(pDesc);
+	return m_RootSignature != nullptr;
+}
+
 // end
 void RootSignature::Term()
 {
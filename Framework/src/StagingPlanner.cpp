@@ -0,0 +1,196 @@
+#include "StagingPlanner.h"
+#include <algorithm>
+#include <cassert>
+
+//
+// StagingPlanner class
+//
+
+// constructor
+StagingPlanner::StagingPlanner()
+	: m_Regions()
+	, m_ChunkSize(0)
+	, m_Alignment(1)
+	, m_ChunkCount(0)
+	, m_Cursor(0)
+{
+}
+
+// destructor
+StagingPlanner::~StagingPlanner()
+{
+	Term();
+}
+
+// initialize
+bool StagingPlanner::Init(uint64_t chunkSize, uint64_t alignment)
+{
+	if (alignment == 0 || (alignment & (alignment - 1)) != 0 || chunkSize < alignment)
+	{
+		return false;
+	}
+
+	m_ChunkSize = chunkSize;
+	m_Alignment = alignment;
+	Reset();
+
+	return true;
+}
+
+// end
+void StagingPlanner::Term()
+{
+	m_Regions.clear();
+	m_Regions.shrink_to_fit();
+	m_ChunkSize = 0;
+	m_Alignment = 1;
+	m_ChunkCount = 0;
+	m_Cursor = 0;
+}
+
+// discard planned regions
+void StagingPlanner::Reset()
+{
+	m_Regions.clear();
+	m_ChunkCount = 0;
+	m_Cursor = 0;
+}
+
+// plan an upload
+bool StagingPlanner::Add(uint32_t target, uint64_t dstOffset, uint64_t size, size_t* pFirst)
+{
+	if (size == 0 || m_ChunkSize == 0)
+	{
+		return false;
+	}
+
+	if (pFirst != nullptr)
+	{
+		*pFirst = m_Regions.size();
+	}
+
+	uint64_t remain = 0;
+	auto offset = GetPlacement(target, dstOffset, size, remain);
+
+	auto done = uint64_t(0);
+	while (done < size)
+	{
+		if (remain == 0)
+		{
+			m_ChunkCount++;
+			offset = 0;
+			remain = m_ChunkSize;
+		}
+
+		auto piece = std::min(size - done, remain);
+
+		Region region;
+		region.Chunk = m_ChunkCount - 1;
+		region.SrcOffset = offset;
+		region.Target = target;
+		region.DstOffset = dstOffset + done;
+		region.Size = piece;
+		m_Regions.push_back(region);
+
+		done += piece;
+		m_Cursor = offset + piece;
+		remain = 0;
+	}
+
+	return true;
+}
+
+// get staging chunk count after planning an upload
+uint32_t StagingPlanner::GetChunkCountAfter(uint32_t target, uint64_t dstOffset, uint64_t size) const
+{
+	if (size == 0 || m_ChunkSize == 0)
+	{
+		return m_ChunkCount;
+	}
+
+	uint64_t remain = 0;
+	GetPlacement(target, dstOffset, size, remain);
+
+	// whatever the last chunk can not hold opens new chunks
+	auto rest = (remain < size) ? size - remain : 0;
+	return m_ChunkCount + uint32_t((rest + m_ChunkSize - 1) / m_ChunkSize);
+}
+
+// get planned region
+const StagingPlanner::Region& StagingPlanner::GetRegion(size_t index) const
+{
+	assert(index < m_Regions.size());
+	return m_Regions[index];
+}
+
+// get planned region count
+size_t StagingPlanner::GetRegionCount() const
+{
+	return m_Regions.size();
+}
+
+// get copy regions
+void StagingPlanner::Coalesce(std::vector<Region>& result) const
+{
+	result.clear();
+	result.reserve(m_Regions.size());
+
+	for (size_t i = 0; i < m_Regions.size(); ++i)
+	{
+		const auto& region = m_Regions[i];
+
+		if (!result.empty())
+		{
+			auto& last = result.back();
+			if (last.Chunk == region.Chunk
+				&& last.Target == region.Target
+				&& last.SrcOffset + last.Size == region.SrcOffset
+				&& last.DstOffset + last.Size == region.DstOffset)
+			{
+				last.Size += region.Size;
+				continue;
+			}
+		}
+
+		result.push_back(region);
+	}
+}
+
+// get staging chunk count
+uint32_t StagingPlanner::GetChunkCount() const
+{
+	return m_ChunkCount;
+}
+
+// get size of one staging chunk
+uint64_t StagingPlanner::GetChunkSize() const
+{
+	return m_ChunkSize;
+}
+
+// decide where an upload starts
+uint64_t StagingPlanner::GetPlacement(uint32_t target, uint64_t dstOffset, uint64_t size, uint64_t& remain) const
+{
+	auto offset = (m_Cursor + (m_Alignment - 1)) & ~(m_Alignment - 1); // round up to alignment
+
+	// an upload continuing the previous one is packed right after it, so Coalesce() can merge them
+	if (!m_Regions.empty())
+	{
+		const auto& last = m_Regions.back();
+		if (last.Target == target
+			&& last.DstOffset + last.Size == dstOffset
+			&& last.SrcOffset + last.Size == m_Cursor)
+		{
+			offset = m_Cursor;
+		}
+	}
+	remain = (m_ChunkCount > 0 && offset < m_ChunkSize) ? m_ChunkSize - offset : 0;
+
+	// keep an upload which fits in one chunk in one piece
+	if (remain < size && size <= m_ChunkSize)
+	{
+		remain = 0;
+	}
+
+	return offset;
+}
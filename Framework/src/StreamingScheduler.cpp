@@ -0,0 +1,338 @@
+#include "StreamingScheduler.h"
+
+//
+// StreamingScheduler class
+//
+
+// constructor
+StreamingScheduler::StreamingScheduler()
+	: m_pUploader(nullptr)
+	, m_pIoPool(nullptr)
+	, m_pWorkerPool(nullptr)
+	, m_MaxInFlight(0)
+	, m_InFlight(0)
+	, m_Ticket(0)
+	, m_Tasks(0)
+{
+}
+
+// destructor
+StreamingScheduler::~StreamingScheduler()
+{
+	Term();
+}
+
+// initialize
+bool StreamingScheduler::Init
+(
+	StreamingUploader* pUploader,
+	ThreadPool* pIoPool,
+	ThreadPool* pWorkerPool,
+	uint32_t maxInFlight
+)
+{
+	if (pUploader == nullptr || pIoPool == nullptr || pWorkerPool == nullptr || maxInFlight == 0)
+	{
+		return false;
+	}
+
+	Term();
+
+	m_pUploader = pUploader;
+	m_pIoPool = pIoPool;
+	m_pWorkerPool = pWorkerPool;
+	m_MaxInFlight = maxInFlight;
+
+	return true;
+}
+
+// end
+void StreamingScheduler::Term()
+{
+	// tasks refer to this object, so they must have finished
+	while (m_Tasks.load(std::memory_order_acquire) > 0)
+	{
+		std::this_thread::yield();
+	}
+
+	m_Entries.clear();
+	m_Queue.clear();
+	m_Canceled.clear();
+	m_Parsed.clear();
+	m_Uploading.clear();
+	m_Finished.clear();
+	m_InFlight = 0;
+	m_Ticket = 0;
+	m_pUploader = nullptr;
+	m_pIoPool = nullptr;
+	m_pWorkerPool = nullptr;
+	m_MaxInFlight = 0;
+}
+
+// queue a request
+uint32_t StreamingScheduler::Request(const std::wstring& path, int priority)
+{
+	if (m_pUploader == nullptr)
+	{
+		return InvalidId;
+	}
+
+	Entry entry;
+	entry.Path = path;
+	entry.State = STREAMING_STATE_QUEUED;
+	entry.IsCanceled = false;
+
+	uint32_t id;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		id = uint32_t(m_Entries.size());
+		m_Entries.push_back(entry);
+	}
+
+	m_Queue.insert(std::make_pair(priority, id));
+
+	return id;
+}
+
+// cancel a request
+bool StreamingScheduler::Cancel(uint32_t id)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	if (id >= m_Entries.size())
+	{
+		return false;
+	}
+
+	auto& entry = m_Entries[id];
+	if (entry.State == STREAMING_STATE_QUEUED)
+	{
+		for (auto itr = m_Queue.begin(); itr != m_Queue.end(); ++itr)
+		{
+			if (itr->second == id)
+			{
+				m_Queue.erase(itr);
+				break;
+			}
+		}
+
+		m_Canceled.push_back(id);
+	}
+	else if (entry.State == STREAMING_STATE_RESIDENT
+		|| entry.State == STREAMING_STATE_FAILED
+		|| entry.State == STREAMING_STATE_CANCELED)
+	{
+		return false;
+	}
+	else
+	{
+		// reported when the pool threads or the GPU are done with it
+		entry.IsCanceled = true;
+	}
+
+	entry.State = STREAMING_STATE_CANCELED;
+	return true;
+}
+
+// advance requests
+void StreamingScheduler::Update(std::vector<Result>& results)
+{
+	results.clear();
+
+	if (m_pUploader == nullptr)
+	{
+		return;
+	}
+
+	// requests canceled before they started
+	std::vector<uint32_t> canceled;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		canceled.swap(m_Canceled);
+	}
+
+	for (size_t i = 0; i < canceled.size(); ++i)
+	{
+		Report(canceled[i], STREAMING_STATE_CANCELED, results);
+	}
+
+	// collect requests which left the pool threads
+	std::vector<std::pair<uint32_t, bool>> finished;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		finished.swap(m_Finished);
+	}
+
+	for (size_t i = 0; i < finished.size(); ++i)
+	{
+		auto id = finished[i].first;
+		m_InFlight--;
+
+		if (GetState(id) == STREAMING_STATE_CANCELED)
+		{
+			Report(id, STREAMING_STATE_CANCELED, results);
+		}
+		else if (finished[i].second)
+		{
+			m_Parsed.push_back(id);
+		}
+		else
+		{
+			Report(id, STREAMING_STATE_FAILED, results);
+		}
+	}
+
+	// retire the batch on the GPU
+	if (!m_Uploading.empty() && m_pUploader->IsComplete(m_Ticket))
+	{
+		for (size_t i = 0; i < m_Uploading.size(); ++i)
+		{
+			auto id = m_Uploading[i];
+			Report(id, (GetState(id) == STREAMING_STATE_CANCELED) ? STREAMING_STATE_CANCELED : STREAMING_STATE_RESIDENT, results);
+		}
+
+		m_Uploading.clear();
+	}
+
+	// everything parsed so far goes into one batch
+	if (m_Uploading.empty() && !m_Parsed.empty())
+	{
+		std::vector<uint32_t> batch;
+		for (size_t i = 0; i < m_Parsed.size(); ++i)
+		{
+			if (GetState(m_Parsed[i]) == STREAMING_STATE_CANCELED)
+			{
+				Report(m_Parsed[i], STREAMING_STATE_CANCELED, results);
+				continue;
+			}
+
+			batch.push_back(m_Parsed[i]);
+		}
+		m_Parsed.clear();
+
+		uint64_t ticket = 0;
+		if (batch.empty())
+		{
+			// every parsed request has been canceled
+		}
+		else if (m_pUploader->Submit(batch, ticket))
+		{
+			for (size_t i = 0; i < batch.size(); ++i)
+			{
+				SetState(batch[i], STREAMING_STATE_UPLOADING);
+			}
+
+			m_Uploading.swap(batch);
+			m_Ticket = ticket;
+		}
+		else
+		{
+			for (size_t i = 0; i < batch.size(); ++i)
+			{
+				Report(batch[i], STREAMING_STATE_FAILED, results);
+			}
+		}
+	}
+
+	// start queued requests
+	while (m_InFlight < m_MaxInFlight && !m_Queue.empty())
+	{
+		auto id = m_Queue.begin()->second;
+		m_Queue.erase(m_Queue.begin());
+
+		m_InFlight++;
+		Dispatch(id);
+	}
+}
+
+// get state of a request
+STREAMING_STATE StreamingScheduler::GetState(uint32_t id) const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	if (id >= m_Entries.size())
+	{
+		return STREAMING_STATE_FAILED;
+	}
+
+	return m_Entries[id].State;
+}
+
+// check whether every request has finished
+bool StreamingScheduler::IsIdle() const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return m_Queue.empty() && m_InFlight == 0 && m_Parsed.empty() && m_Uploading.empty() && m_Canceled.empty();
+}
+
+// read on an I/O thread, then parse on a worker
+void StreamingScheduler::Dispatch(uint32_t id)
+{
+	std::wstring path;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Entries[id].State = STREAMING_STATE_READING;
+		path = m_Entries[id].Path;
+	}
+
+	m_Tasks.fetch_add(1, std::memory_order_acq_rel);
+	m_pIoPool->Submit([this, id, path]()
+	{
+		auto result = m_pUploader->Read(id, path);
+
+		// a request canceled while it was read is not parsed. a failure becomes its state
+		// when Update() reports it, so it can still be canceled until then
+		auto isParsed = false;
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			auto& entry = m_Entries[id];
+			if (!result || entry.IsCanceled)
+			{
+				m_Finished.push_back(std::make_pair(id, false));
+			}
+			else
+			{
+				entry.State = STREAMING_STATE_PARSING;
+				isParsed = true;
+			}
+		}
+
+		if (!isParsed)
+		{
+			m_Tasks.fetch_sub(1, std::memory_order_acq_rel);
+			return;
+		}
+
+		m_Tasks.fetch_add(1, std::memory_order_acq_rel);
+		m_pWorkerPool->Submit([this, id]()
+		{
+			auto result = m_pUploader->Parse(id);
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				auto& entry = m_Entries[id];
+				if (!entry.IsCanceled && result)
+				{
+					entry.State = STREAMING_STATE_PARSED;
+				}
+				m_Finished.push_back(std::make_pair(id, result));
+			}
+			m_Tasks.fetch_sub(1, std::memory_order_acq_rel);
+		});
+
+		// counted until Submit() has returned, so Term() never races with it
+		m_Tasks.fetch_sub(1, std::memory_order_acq_rel);
+	});
+}
+
+// set state of a request
+void StreamingScheduler::SetState(uint32_t id, STREAMING_STATE state)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Entries[id].State = state;
+}
+
+// finish a request
+void StreamingScheduler::Report(uint32_t id, STREAMING_STATE state, std::vector<Result>& results)
+{
+	SetState(id, state);
+	m_pUploader->Finish(id, state);
+	results.push_back({ id, state });
+}
@@ -1,7 +1,10 @@
 #include <Texture.h>
-#include <DDSTextureLoader.h>
+#include <DDSParser.h>
 #include <DescriptorPool.h>
+#include <DeferredReleaseQueue.h>
 #include <Logger.h>
+#include <MappedFile.h>
+#include <vector>
 
 namespace
 {
@@ -68,6 +71,7 @@ Texture::Texture()
 	: m_pTex(nullptr)
 	, m_pHandle(nullptr)
 	, m_pPool(nullptr)
+	, m_ViewDesc()
 {
 }
 
@@ -120,25 +124,73 @@ bool Texture::Init
 		return false;
 	}
 
-	// generate texture from file
-	bool isCube = false;
-	auto hr = DirectX::CreateDDSTextureFromFile(
-		pDevice,
-		batch,
-		filename,
-		m_pTex.GetAddressOf(),
-		true,
-		0,
+	// map the file. the subresources are read in place
+	MappedFile file;
+	if (!file.Open(filename))
+	{
+		ELOG("Error : File Not Found. filename = %ls", filename);
+		return false;
+	}
+
+	DDSInfo info;
+	if (!ParseDDS(file.GetData(), file.GetSize(), info))
+	{
+		ELOG("Error : Unsupported DDS file. filename = %ls", filename);
+		return false;
+	}
+
+	D3D12_HEAP_PROPERTIES prop = {};
+	prop.Type = D3D12_HEAP_TYPE_DEFAULT;
+	prop.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+	prop.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+	prop.CreationNodeMask = 1;
+	prop.VisibleNodeMask = 1;
+
+	// a single level texture gets the rest of its mip chain on the GPU
+	auto generateMips = info.MipCount == 1
+		&& info.Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE2D
+		&& info.ArraySize == 1
+		&& batch.IsSupportedForGenerateMips(info.Format);
+
+	auto desc = GetDDSResourceDesc(info);
+	if (generateMips)
+	{
+		desc.MipLevels = 0;
+	}
+
+	auto hr = pDevice->CreateCommittedResource(
+		&prop,
+		D3D12_HEAP_FLAG_NONE,
+		&desc,
+		D3D12_RESOURCE_STATE_COPY_DEST,
 		nullptr,
-		&isCube);
+		IID_PPV_ARGS(m_pTex.GetAddressOf()));
 	if (FAILED(hr))
 	{
-		ELOG("Error : DirectX::CreateDDSTextureFromFile() Failed. filename = %ls, retcode = 0x%x", filename, hr);
+		ELOG("Error : ID3D12Device::CreateCommittedResource() Failed. filename = %ls, retcode = 0x%x", filename, hr);
 		return false;
 	}
 
+	// the batch copies the subresources into its staging buffer right away, so the mapping may close afterwards
+	std::vector<D3D12_SUBRESOURCE_DATA> subresources(info.Subresources.size());
+	for (size_t i = 0; i < subresources.size(); ++i)
+	{
+		const auto& src = info.Subresources[i];
+		subresources[i].pData = file.GetData() + src.Offset;
+		subresources[i].RowPitch = LONG_PTR(src.RowPitch);
+		subresources[i].SlicePitch = LONG_PTR(src.SlicePitch);
+	}
+
+	batch.Upload(m_pTex.Get(), 0, subresources.data(), UINT(subresources.size()));
+	batch.Transition(m_pTex.Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+
+	if (generateMips)
+	{
+		batch.GenerateMips(m_pTex.Get());
+	}
+
 	// VF[_\[Xr[̐ݒ߂
-	auto viewDesc = GetViewDesc(isCube);
+	auto viewDesc = GetViewDesc(info.IsCube);
 
 	// convert to SRGB format
 	if (isSRGB)
@@ -148,6 +200,7 @@ bool Texture::Init
 
 	// generate shader resource view
 	pDevice->CreateShaderResourceView(m_pTex.Get(), &viewDesc, m_pHandle->HandleCPU);
+	m_ViewDesc = viewDesc;
 
 	// I
 	return true;
@@ -225,6 +278,53 @@ bool Texture::Init(
 
 	// generate shader resource view
 	pDevice->CreateShaderResourceView(m_pTex.Get(), &viewDesc, m_pHandle->HandleCPU);
+	m_ViewDesc = viewDesc;
+
+	return true;
+}
+
+// initialize with an existing resource
+bool Texture::Init
+(
+	ID3D12Device* pDevice,
+	DescriptorPool* pPool,
+	ID3D12Resource* pResource,
+	bool isCube,
+	bool isSRGB
+)
+{
+	if (pDevice == nullptr || pPool == nullptr || pResource == nullptr)
+	{
+		return false;
+	}
+
+	assert(m_pPool == nullptr);
+	assert(m_pHandle == nullptr);
+
+	// set descriptor pool
+	m_pPool = pPool;
+	m_pPool->AddRef();
+
+	// get descriptor handle
+	m_pHandle = pPool->AllocHandle();
+	if (m_pHandle == nullptr)
+	{
+		return false;
+	}
+
+	m_pTex = pResource;
+
+	auto viewDesc = GetViewDesc(isCube);
+
+	// convert to SRGB format
+	if (isSRGB)
+	{
+		viewDesc.Format = ConvertToSRGB(viewDesc.Format);
+	}
+
+	// generate shader resource view
+	pDevice->CreateShaderResourceView(m_pTex.Get(), &viewDesc, m_pHandle->HandleCPU);
+	m_ViewDesc = viewDesc;
 
 	return true;
 }
@@ -249,6 +349,26 @@ void Texture::Term()
 	}
 }
 
+// end after the frames in flight
+void Texture::Term(DeferredReleaseQueue* pQueue)
+{
+	// whatever the queue does not take is released at once by Term()
+	if (pQueue != nullptr)
+	{
+		if (m_pTex != nullptr && pQueue->Push(m_pTex.Get()))
+		{
+			m_pTex.Detach();
+		}
+
+		if (m_pHandle != nullptr && pQueue->PushHandle(m_pPool, m_pHandle))
+		{
+			m_pHandle = nullptr;
+		}
+	}
+
+	Term();
+}
+
 D3D12_CPU_DESCRIPTOR_HANDLE Texture::GetHandleCPU() const
 {
 	if (m_pHandle != nullptr)
@@ -269,6 +389,18 @@ D3D12_GPU_DESCRIPTOR_HANDLE Texture::GetHandleGPU() const
 
 	return D3D12_GPU_DESCRIPTOR_HANDLE();
 }
+
+// create another shader resource view
+void Texture::CreateView(ID3D12Device* pDevice, D3D12_CPU_DESCRIPTOR_HANDLE handle) const
+{
+	if (pDevice == nullptr || m_pTex == nullptr || handle.ptr == 0)
+	{
+		return;
+	}
+
+	pDevice->CreateShaderResourceView(m_pTex.Get(), &m_ViewDesc, handle);
+}
+
 // VF[_\[Xr[̐ݒ߂
 D3D12_SHADER_RESOURCE_VIEW_DESC Texture::GetViewDesc(bool isCube)
 {
@@ -335,7 +467,7 @@ D3D12_SHADER_RESOURCE_VIEW_DESC Texture::GetViewDesc(bool isCube)
 			{
 				if (desc.DepthOrArraySize > 1)
 				{
-					if (desc.MipLevels > 1)
+					if (desc.SampleDesc.Count > 1)
 					{
 						viewDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2DMSARRAY;
 
@@ -356,7 +488,7 @@ D3D12_SHADER_RESOURCE_VIEW_DESC Texture::GetViewDesc(bool isCube)
 				}
 				else
 				{
-					if (desc.MipLevels > 1)
+					if (desc.SampleDesc.Count > 1)
 					{
 						viewDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2DMS; // if the texture is ms, then the index of pixels can be specified by integer value such as 1 and 7(depending on the size of texture)
 					}
@@ -0,0 +1,403 @@
+#include "TextureCache.h"
+#include "Hash.h"
+#include "MappedFile.h"
+#include <cstring>
+
+namespace {
+
+	// "TMAN"
+	const uint32_t TextureManifestMagic = 0x4e414d54;
+
+	// seed of pre-keys, so they differ from keys of the whole file
+	const uint64_t PreKeySeed = HashValue(uint32_t(0x59454b50), HashSeed); // "PKEY"
+
+	//
+	// TextureManifestHeader structure
+	//
+	struct TextureManifestHeader
+	{
+		uint32_t Magic; // TextureManifestMagic
+		uint32_t Version; // TextureManifestVersion
+		uint32_t Count; // entry count
+		uint32_t Reserved; // padding
+	};
+
+	// append raw bytes
+	void Write(std::vector<uint8_t>& dst, const void* pData, size_t size)
+	{
+		auto offset = dst.size();
+		dst.resize(offset + size);
+		if (size > 0)
+		{
+			memcpy(dst.data() + offset, pData, size);
+		}
+	}
+
+	//
+	// Reader class
+	//
+	class Reader
+	{
+	public:
+		Reader(const uint8_t* pData, size_t size)
+			: m_pData(pData)
+			, m_Size(size)
+			, m_Offset(0)
+		{
+			// Do Nothing//
+		}
+
+		bool Read(void* pDst, size_t size)
+		{
+			if (size > m_Size - m_Offset)
+			{
+				return false;
+			}
+
+			memcpy(pDst, m_pData + m_Offset, size);
+			m_Offset += size;
+			return true;
+		}
+
+	private:
+		const uint8_t* m_pData;
+		size_t m_Size;
+		size_t m_Offset;
+	};
+
+} // namespace
+
+// compare keys
+bool TextureKey::operator < (const TextureKey& value) const
+{
+	if (Hash != value.Hash)
+	{
+		return Hash < value.Hash;
+	}
+
+	if (Size != value.Size)
+	{
+		return Size < value.Size;
+	}
+
+	return IsSRGB < value.IsSRGB;
+}
+
+// check whether keys are equal
+bool TextureKey::operator == (const TextureKey& value) const
+{
+	return Hash == value.Hash && Size == value.Size && IsSRGB == value.IsSRGB;
+}
+
+// compute key of a texture file
+TextureKey ComputeTextureKey(const void* pData, size_t size, bool isSRGB)
+{
+	TextureKey key;
+	key.Hash = HashBytes(pData, size);
+	key.Size = size;
+	key.IsSRGB = isSRGB;
+	return key;
+}
+
+// compute cheap key of a texture file
+TextureKey ComputeTexturePreKey(const void* pData, size_t size, bool isSRGB)
+{
+	TextureKey key;
+	key.Hash = HashBytes(pData, (size < TexturePreKeySize) ? size : TexturePreKeySize, PreKeySeed);
+	key.Size = size;
+	key.IsSRGB = isSRGB;
+	return key;
+}
+
+// serialize manifest entries
+void SerializeTextureManifest(const std::vector<TextureManifestEntry>& entries, std::vector<uint8_t>& result)
+{
+	result.clear();
+
+	TextureManifestHeader header = {};
+	header.Magic = TextureManifestMagic;
+	header.Version = TextureManifestVersion;
+	header.Count = uint32_t(entries.size());
+	Write(result, &header, sizeof(header));
+
+	// hash, size and the path as UTF-16 code units
+	for (size_t i = 0; i < entries.size(); ++i)
+	{
+		const auto& entry = entries[i];
+		auto length = uint32_t(entry.Path.size());
+
+		Write(result, &entry.Hash, sizeof(entry.Hash));
+		Write(result, &entry.Size, sizeof(entry.Size));
+		Write(result, &length, sizeof(length));
+		for (size_t j = 0; j < entry.Path.size(); ++j)
+		{
+			auto c = uint16_t(entry.Path[j]);
+			Write(result, &c, sizeof(c));
+		}
+	}
+}
+
+// restore manifest entries
+bool DeserializeTextureManifest(const void* pData, size_t size, std::vector<TextureManifestEntry>& entries)
+{
+	entries.clear();
+	if (pData == nullptr)
+	{
+		return false;
+	}
+
+	Reader reader(static_cast<const uint8_t*>(pData), size);
+
+	TextureManifestHeader header = {};
+	if (!reader.Read(&header, sizeof(header))
+	 || header.Magic != TextureManifestMagic
+	 || header.Version != TextureManifestVersion)
+	{
+		return false;
+	}
+
+	// every entry takes at least its hash, size and length
+	const size_t MinEntrySize = sizeof(uint64_t) * 2 + sizeof(uint32_t);
+	if (header.Count > (size - sizeof(header)) / MinEntrySize)
+	{
+		return false;
+	}
+
+	entries.resize(header.Count);
+	for (size_t i = 0; i < entries.size(); ++i)
+	{
+		auto& entry = entries[i];
+		uint32_t length = 0;
+		if (!reader.Read(&entry.Hash, sizeof(entry.Hash))
+		 || !reader.Read(&entry.Size, sizeof(entry.Size))
+		 || !reader.Read(&length, sizeof(length))
+		 || length > (size - sizeof(header)) / sizeof(uint16_t))
+		{
+			entries.clear();
+			return false;
+		}
+
+		entry.Path.resize(length);
+		for (uint32_t j = 0; j < length; ++j)
+		{
+			uint16_t c = 0;
+			if (!reader.Read(&c, sizeof(c)))
+			{
+				entries.clear();
+				return false;
+			}
+
+			entry.Path[j] = wchar_t(c);
+		}
+	}
+
+	return true;
+}
+
+// load a cooked texture manifest
+bool LoadTextureManifest(const wchar_t* filename, std::vector<TextureManifestEntry>& entries)
+{
+	MappedFile file;
+	if (!file.Open(filename))
+	{
+		entries.clear();
+		return false;
+	}
+
+	return DeserializeTextureManifest(file.GetData(), file.GetSize(), entries);
+}
+
+// write a cooked texture manifest
+bool SaveTextureManifest(const wchar_t* filename, const std::vector<TextureManifestEntry>& entries)
+{
+	if (filename == nullptr)
+	{
+		return false;
+	}
+
+	std::vector<uint8_t> data;
+	SerializeTextureManifest(entries, data);
+
+	// write to a temporary file first, so a reader never sees a half-written manifest
+	std::wstring temp(filename);
+	temp += L".tmp";
+
+	auto hFile = CreateFileW(
+		temp.c_str(),
+		GENERIC_WRITE,
+		0,
+		nullptr,
+		CREATE_ALWAYS,
+		FILE_ATTRIBUTE_NORMAL,
+		nullptr);
+	if (hFile == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	DWORD written = 0;
+	auto result = WriteFile(hFile, data.data(), DWORD(data.size()), &written, nullptr) != FALSE;
+	result &= (written == DWORD(data.size()));
+	CloseHandle(hFile);
+
+	if (!result)
+	{
+		DeleteFileW(temp.c_str());
+		return false;
+	}
+
+	if (!MoveFileExW(temp.c_str(), filename, MOVEFILE_REPLACE_EXISTING))
+	{
+		DeleteFileW(temp.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+//
+// TextureManifest class
+//
+
+// constructor
+TextureManifest::TextureManifest()
+{
+}
+
+// destructor
+TextureManifest::~TextureManifest()
+{
+	Clear();
+}
+
+// replace the entries
+void TextureManifest::SetEntries(const std::vector<TextureManifestEntry>& entries)
+{
+	m_Entries.clear();
+	for (size_t i = 0; i < entries.size(); ++i)
+	{
+		m_Entries[entries[i].Path] = entries[i];
+	}
+}
+
+// remove every entry
+void TextureManifest::Clear()
+{
+	m_Entries.clear();
+}
+
+// find key of a texture
+bool TextureManifest::Find(const std::wstring& path, bool isSRGB, TextureKey& key) const
+{
+	auto itr = m_Entries.find(path);
+	if (itr == m_Entries.end())
+	{
+		return false;
+	}
+
+	key.Hash = itr->second.Hash;
+	key.Size = itr->second.Size;
+	key.IsSRGB = isSRGB;
+	return true;
+}
+
+// get entry count
+size_t TextureManifest::GetCount() const
+{
+	return m_Entries.size();
+}
+
+//
+// TextureKeyTable class
+//
+
+// constructor
+TextureKeyTable::TextureKeyTable()
+{
+}
+
+// destructor
+TextureKeyTable::~TextureKeyTable()
+{
+	Clear();
+}
+
+// find key of a texture file
+bool TextureKeyTable::Find
+(
+	const std::wstring& path,
+	const void* pData,
+	size_t size,
+	bool isSRGB,
+	const HashFunc& hashFile,
+	TextureKey& key
+)
+{
+	auto preKey = ComputeTexturePreKey(pData, size, isSRGB);
+
+	// the first file of a pre-key, or the same file again, needs no full hash
+	auto itr = m_Paths.find(preKey);
+	if (itr == m_Paths.end())
+	{
+		m_Paths[preKey] = path;
+		key = preKey;
+		return true;
+	}
+
+	if (itr->second == path)
+	{
+		key = preKey;
+		return true;
+	}
+
+	// the pre-keys collide, so the contents decide
+	uint64_t first = 0;
+	uint64_t hash = 0;
+	if (!GetHash(itr->second, hashFile, first) || !GetHash(path, hashFile, hash))
+	{
+		return false;
+	}
+
+	if (hash == first)
+	{
+		key = preKey;
+		return true;
+	}
+
+	key.Hash = hash;
+	key.Size = size;
+	key.IsSRGB = isSRGB;
+	return true;
+}
+
+// forget every file
+void TextureKeyTable::Clear()
+{
+	m_Paths.clear();
+	m_Hashes.clear();
+}
+
+// get count of files which have been hashed in full
+size_t TextureKeyTable::GetFullHashCount() const
+{
+	return m_Hashes.size();
+}
+
+// get full hash of a file
+bool TextureKeyTable::GetHash(const std::wstring& path, const HashFunc& hashFile, uint64_t& hash)
+{
+	auto itr = m_Hashes.find(path);
+	if (itr != m_Hashes.end())
+	{
+		hash = itr->second;
+		return true;
+	}
+
+	if (!hashFile || !hashFile(path, hash))
+	{
+		return false;
+	}
+
+	m_Hashes[path] = hash;
+	return true;
+}
@@ -0,0 +1,279 @@
+#include "ThreadPool.h"
+#include <memory>
+#include <new>
+
+namespace {
+
+	// index of the worker running on this thread (UINT32_MAX for other threads)
+	thread_local uint32_t t_WorkerIndex = UINT32_MAX;
+
+	// pool the worker running on this thread belongs to
+	thread_local const void* t_pWorkerPool = nullptr;
+
+} // namespace
+
+//
+// ThreadPool class
+//
+
+// constructor
+ThreadPool::ThreadPool()
+	: m_pWorkers(nullptr)
+	, m_ThreadCount(0)
+	, m_Pending(0)
+	, m_NextWorker(0)
+	, m_Quit(false)
+{
+}
+
+// destructor
+ThreadPool::~ThreadPool()
+{
+	Term();
+}
+
+// initialize
+bool ThreadPool::Init(uint32_t threadCount)
+{
+	if (m_pWorkers != nullptr)
+	{
+		return false;
+	}
+
+	if (threadCount == 0)
+	{
+		auto concurrency = std::thread::hardware_concurrency();
+		threadCount = (concurrency > 1) ? concurrency - 1 : 1;
+	}
+
+	m_pWorkers = new (std::nothrow) Worker[threadCount];
+	if (m_pWorkers == nullptr)
+	{
+		return false;
+	}
+
+	m_ThreadCount = threadCount;
+	m_Pending = 0;
+	m_NextWorker = 0;
+	m_Quit = false;
+
+	for (auto i = 0u; i < m_ThreadCount; ++i)
+	{
+		m_pWorkers[i].Thread = std::thread(&ThreadPool::WorkerMain, this, i);
+	}
+
+	return true;
+}
+
+// end
+void ThreadPool::Term()
+{
+	if (m_pWorkers == nullptr)
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_WakeMutex);
+		m_Quit = true;
+	}
+	m_Wake.notify_all();
+
+	for (auto i = 0u; i < m_ThreadCount; ++i)
+	{
+		if (m_pWorkers[i].Thread.joinable())
+		{
+			m_pWorkers[i].Thread.join();
+		}
+	}
+
+	delete[] m_pWorkers;
+	m_pWorkers = nullptr;
+	m_ThreadCount = 0;
+}
+
+// queue a task
+void ThreadPool::Submit(std::function<void()> task)
+{
+	if (m_pWorkers == nullptr)
+	{
+		task();
+		return;
+	}
+
+	// a worker keeps its own tasks, other threads spread theirs
+	auto index = (t_pWorkerPool == this)
+		? t_WorkerIndex
+		: m_NextWorker.fetch_add(1, std::memory_order_relaxed) % m_ThreadCount;
+
+	// counted before it is visible, so a worker which takes it at once never sees the count below zero
+	m_Pending.fetch_add(1, std::memory_order_release);
+
+	{
+		std::lock_guard<std::mutex> lock(m_pWorkers[index].Mutex);
+		m_pWorkers[index].Tasks.push_back(std::move(task));
+	}
+
+	// taking the lock orders the wake-up after a worker's predicate check
+	{
+		std::lock_guard<std::mutex> lock(m_WakeMutex);
+	}
+	m_Wake.notify_one();
+}
+
+// run func for every index
+void ThreadPool::ParallelFor(size_t count, const std::function<void(size_t)>& func, size_t grain)
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	if (grain == 0)
+	{
+		grain = 1;
+	}
+
+	auto chunkCount = (count + grain - 1) / grain;
+	if (m_pWorkers == nullptr || chunkCount == 1)
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			func(i);
+		}
+		return;
+	}
+
+	// helpers may start after every chunk is taken, so the shared state outlives this call
+	struct State
+	{
+		std::atomic<size_t> Next;
+		std::atomic<size_t> Done;
+		std::mutex Mutex;
+		std::condition_variable Finished;
+	};
+	auto pState = std::make_shared<State>();
+	pState->Next = 0;
+	pState->Done = 0;
+
+	auto pFunc = &func;
+	auto RunChunks = [pState, pFunc, count, grain, chunkCount]()
+	{
+		for (;;)
+		{
+			auto chunk = pState->Next.fetch_add(1, std::memory_order_relaxed);
+			if (chunk >= chunkCount)
+			{
+				return;
+			}
+
+			auto begin = chunk * grain;
+			auto end = (begin + grain < count) ? begin + grain : count;
+			for (auto i = begin; i < end; ++i)
+			{
+				(*pFunc)(i);
+			}
+
+			if (pState->Done.fetch_add(1, std::memory_order_acq_rel) + 1 == chunkCount)
+			{
+				std::lock_guard<std::mutex> lock(pState->Mutex);
+				pState->Finished.notify_all();
+			}
+		}
+	};
+
+	auto helperCount = (chunkCount - 1 < m_ThreadCount) ? chunkCount - 1 : m_ThreadCount;
+	for (size_t i = 0; i < helperCount; ++i)
+	{
+		Submit(RunChunks);
+	}
+
+	RunChunks();
+
+	// every chunk is taken, so the last ones finish on threads already running them.
+	// other tasks are not run here, as a long one (a pipeline compile) would hold up the caller
+	std::unique_lock<std::mutex> lock(pState->Mutex);
+	pState->Finished.wait(lock, [pState, chunkCount]()
+	{
+		return pState->Done.load(std::memory_order_acquire) == chunkCount;
+	});
+}
+
+// get worker count
+uint32_t ThreadPool::GetThreadCount() const
+{
+	return m_ThreadCount;
+}
+
+// worker main loop
+void ThreadPool::WorkerMain(uint32_t index)
+{
+	t_WorkerIndex = index;
+	t_pWorkerPool = this;
+
+	for (;;)
+	{
+		if (TryRunTask(index))
+		{
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(m_WakeMutex);
+		m_Wake.wait(lock, [this]()
+		{
+			return m_Quit.load() || m_Pending.load(std::memory_order_acquire) > 0;
+		});
+
+		if (m_Quit.load() && m_Pending.load(std::memory_order_acquire) == 0)
+		{
+			break;
+		}
+	}
+
+	t_WorkerIndex = UINT32_MAX;
+	t_pWorkerPool = nullptr;
+}
+
+// run one task of its own deque, or steal one
+bool ThreadPool::TryRunTask(uint32_t index)
+{
+	std::function<void()> task;
+
+	// newest task of its own deque
+	if (index < m_ThreadCount)
+	{
+		auto& worker = m_pWorkers[index];
+		std::lock_guard<std::mutex> lock(worker.Mutex);
+		if (!worker.Tasks.empty())
+		{
+			task = std::move(worker.Tasks.back());
+			worker.Tasks.pop_back();
+		}
+	}
+
+	// oldest task of another deque
+	if (!task)
+	{
+		auto start = (index < m_ThreadCount) ? index + 1 : 0;
+		for (auto i = 0u; i < m_ThreadCount && !task; ++i)
+		{
+			auto& victim = m_pWorkers[(start + i) % m_ThreadCount];
+			std::lock_guard<std::mutex> lock(victim.Mutex);
+			if (!victim.Tasks.empty())
+			{
+				task = std::move(victim.Tasks.front());
+				victim.Tasks.pop_front();
+			}
+		}
+	}
+
+	if (!task)
+	{
+		return false;
+	}
+
+	m_Pending.fetch_sub(1, std::memory_order_acq_rel);
+	task();
+
+	return true;
+}
@@ -0,0 +1,69 @@
+#include "TransientHeap.h"
+#include "Logger.h"
+
+//
+// TransientHeap class
+//
+
+// constructor
+TransientHeap::TransientHeap()
+	: m_pHeap()
+	, m_Size(0)
+{
+}
+
+// destructor
+TransientHeap::~TransientHeap()
+{
+	Term();
+}
+
+// initialize
+bool TransientHeap::Init(ID3D12Device* pDevice, uint64_t size, uint64_t alignment)
+{
+	if (pDevice == nullptr || size == 0 || alignment == 0)
+	{
+		return false;
+	}
+
+	Term();
+
+	D3D12_HEAP_DESC desc = {};
+	desc.SizeInBytes = (size + alignment - 1) & ~(alignment - 1);
+	desc.Properties.Type = D3D12_HEAP_TYPE_DEFAULT;
+	desc.Properties.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+	desc.Properties.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+	desc.Properties.CreationNodeMask = 1;
+	desc.Properties.VisibleNodeMask = 1;
+	desc.Alignment = alignment;
+	desc.Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES;
+
+	auto hr = pDevice->CreateHeap(&desc, IID_PPV_ARGS(m_pHeap.GetAddressOf()));
+	if (FAILED(hr))
+	{
+		ELOG("Error : ID3D12Device::CreateHeap() Failed. retcode = 0x%x", hr);
+		return false;
+	}
+
+	m_Size = desc.SizeInBytes;
+	return true;
+}
+
+// end
+void TransientHeap::Term()
+{
+	m_pHeap.Reset();
+	m_Size = 0;
+}
+
+// get heap
+ID3D12Heap* TransientHeap::GetHeap() const
+{
+	return m_pHeap.Get();
+}
+
+// get heap size
+uint64_t TransientHeap::GetSize() const
+{
+	return m_Size;
+}
@@ -1,4 +1,5 @@
 #include "VertexBuffer.h"
+#include "BufferUploadBatch.h"
 
 //
 // VertexBuffer class
@@ -7,6 +8,7 @@
 // constructor
 VertexBuffer::VertexBuffer()
 	: m_pVB(nullptr)
+	, m_IsStatic(false)
 {
 	memset(&m_View, 0, sizeof(m_View)); // fill the content of m_View pointer with 0
 }
@@ -84,16 +86,84 @@ bool VertexBuffer::Init(ID3D12Device* pDevice, size_t size, size_t stride, const
 	return true;
 }
 
+// initialize as static geometry
+bool VertexBuffer::Init(BufferUploadBatch& batch, size_t size, size_t stride, const void* pInitData)
+{
+	auto pDevice = batch.GetDevice();
+
+	// argument check
+	if (pDevice == nullptr || size == 0 || stride == 0 || pInitData == nullptr)
+	{
+		return false;
+	}
+
+	// heap property
+	D3D12_HEAP_PROPERTIES prop = {};
+	prop.Type = D3D12_HEAP_TYPE_DEFAULT;
+	prop.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+	prop.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+	prop.CreationNodeMask = 1;
+	prop.VisibleNodeMask = 1;
+
+	// settings of resource
+	D3D12_RESOURCE_DESC desc = {};
+	desc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+	desc.Alignment = 0;
+	desc.Width = UINT64(size);
+	desc.Height = 1;
+	desc.DepthOrArraySize = 1;
+	desc.MipLevels = 1;
+	desc.Format = DXGI_FORMAT_UNKNOWN;
+	desc.SampleDesc.Count = 1;
+	desc.SampleDesc.Quality = 0;
+	desc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+	desc.Flags = D3D12_RESOURCE_FLAG_NONE;
+
+	// generate resource (COMMON, so that a copy queue can write to it)
+	auto hr = pDevice->CreateCommittedResource(
+		&prop,
+		D3D12_HEAP_FLAG_NONE,
+		&desc,
+		D3D12_RESOURCE_STATE_COMMON,
+		nullptr,
+		IID_PPV_ARGS(m_pVB.GetAddressOf()));
+	if (FAILED(hr))
+	{
+		return false;
+	}
+
+	m_IsStatic = true;
+
+	// settings of vertex buffer view
+	m_View.BufferLocation = m_pVB->GetGPUVirtualAddress();
+	m_View.StrideInBytes = UINT(stride);
+	m_View.SizeInBytes = UINT(size);
+
+	// stage initial data
+	return batch.Upload(
+		m_pVB.Get(),
+		0,
+		pInitData,
+		UINT64(size),
+		D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER);
+}
+
 // end
 void VertexBuffer::Term()
 {
 	m_pVB.Reset();
 	memset(&m_View, 0, sizeof(m_View)); // fill out with zero
+	m_IsStatic = false;
 }
 
 // memory mapping
 void* VertexBuffer::Map() const
 {
+	if (m_IsStatic)
+	{
+		return nullptr;
+	}
+
 	void* ptr;
 	auto hr = m_pVB->Map(0, nullptr, &ptr);
 	if (FAILED(hr))
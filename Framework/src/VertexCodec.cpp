@@ -0,0 +1,383 @@
+#include "VertexCodec.h"
+#include <DirectXPackedVector.h>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+	// largest angle between a unit vector and its octahedral snorm16 encoding in degrees
+	// (measured is below 0.004, the rest is margin for float rounding)
+	const float OctahedralAngleLimit = 0.01f;
+
+	// convert float in [-1, 1] to snorm16
+	int16_t ToSnorm16(float value)
+	{
+		value = std::max(-1.0f, std::min(1.0f, value));
+		return int16_t(std::lround(value * 32767.0f));
+	}
+
+	// convert snorm16 to float in [-1, 1]
+	float FromSnorm16(int16_t value)
+	{
+		return std::max(-1.0f, float(value) / 32767.0f);
+	}
+
+	// convert float in [0, 1] to unorm16
+	uint16_t ToUnorm16(float value)
+	{
+		value = std::max(0.0f, std::min(1.0f, value));
+		return uint16_t(std::lround(value * 65535.0f));
+	}
+
+	// convert unorm16 to float in [0, 1]
+	float FromUnorm16(uint16_t value)
+	{
+		return float(value) / 65535.0f;
+	}
+
+	// sign which treats 0 as positive
+	float SignNotZero(float value)
+	{
+		return (value >= 0.0f) ? 1.0f : -1.0f;
+	}
+
+	// encode unit vector to octahedral snorm16x2
+	void EncodeOctahedral(const DirectX::XMFLOAT3& v, int16_t* result)
+	{
+		auto l1 = std::abs(v.x) + std::abs(v.y) + std::abs(v.z);
+		if (l1 <= 0.0f)
+		{
+			result[0] = 0;
+			result[1] = 0;
+			return;
+		}
+
+		auto x = v.x / l1;
+		auto y = v.y / l1;
+
+		// fold the lower hemisphere over the diagonals
+		if (v.z < 0.0f)
+		{
+			auto fx = (1.0f - std::abs(y)) * SignNotZero(x);
+			auto fy = (1.0f - std::abs(x)) * SignNotZero(y);
+			x = fx;
+			y = fy;
+		}
+
+		result[0] = ToSnorm16(x);
+		result[1] = ToSnorm16(y);
+	}
+
+	// decode octahedral snorm16x2 to unit vector
+	DirectX::XMFLOAT3 DecodeOctahedral(const int16_t* value)
+	{
+		auto x = FromSnorm16(value[0]);
+		auto y = FromSnorm16(value[1]);
+		auto z = 1.0f - std::abs(x) - std::abs(y);
+
+		auto t = std::max(-z, 0.0f);
+		x += (x >= 0.0f) ? -t : t;
+		y += (y >= 0.0f) ? -t : t;
+
+		auto length = std::sqrt(x * x + y * y + z * z);
+		return DirectX::XMFLOAT3(x / length, y / length, z / length);
+	}
+
+	// normalize vector (returns +Z for zero vector)
+	DirectX::XMFLOAT3 Normalize(const DirectX::XMFLOAT3& v)
+	{
+		auto length = std::sqrt(v.x * v.x + v.y * v.y + v.z * v.z);
+		if (length <= 0.0f)
+		{
+			return DirectX::XMFLOAT3(0.0f, 0.0f, 1.0f);
+		}
+
+		return DirectX::XMFLOAT3(v.x / length, v.y / length, v.z / length);
+	}
+
+	// angle between two vectors in degrees (atan2 keeps small angles, which acos rounds to 0.02 deg)
+	float AngleBetween(const DirectX::XMFLOAT3& a, const DirectX::XMFLOAT3& b)
+	{
+		auto na = Normalize(a);
+		auto nb = Normalize(b);
+		auto cx = na.y * nb.z - na.z * nb.y;
+		auto cy = na.z * nb.x - na.x * nb.z;
+		auto cz = na.x * nb.y - na.y * nb.x;
+		auto d = na.x * nb.x + na.y * nb.y + na.z * nb.z;
+		return DirectX::XMConvertToDegrees(std::atan2(std::sqrt(cx * cx + cy * cy + cz * cz), d));
+	}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+// CompactVertex
+//-----------------------------------------------------------------------------
+const D3D12_INPUT_ELEMENT_DESC CompactVertex::InputElements[] = {
+	{ "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+	{ "NORMAL",   0, DXGI_FORMAT_R16G16_SNORM,    0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+	{ "TANGENT",  0, DXGI_FORMAT_R16G16_SNORM,    0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+	{ "TEXCOORD", 0, DXGI_FORMAT_R16G16_FLOAT,    0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 }
+};
+const D3D12_INPUT_LAYOUT_DESC CompactVertex::InputLayout = { CompactVertex::InputElements, CompactVertex::InputElementCount };
+static_assert(sizeof(CompactVertex) == 24, "Vertex struct/layout mismatch");
+
+//-----------------------------------------------------------------------------
+// QuantizedVertex
+//-----------------------------------------------------------------------------
+const D3D12_INPUT_ELEMENT_DESC QuantizedVertex::InputElements[] = {
+	{ "POSITION", 0, DXGI_FORMAT_R16G16B16A16_UNORM, 0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+	{ "NORMAL",   0, DXGI_FORMAT_R16G16_SNORM,       0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+	{ "TANGENT",  0, DXGI_FORMAT_R16G16_SNORM,       0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+	{ "TEXCOORD", 0, DXGI_FORMAT_R16G16_FLOAT,       0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 }
+};
+const D3D12_INPUT_LAYOUT_DESC QuantizedVertex::InputLayout = { QuantizedVertex::InputElements, QuantizedVertex::InputElementCount };
+static_assert(sizeof(QuantizedVertex) == 20, "Vertex struct/layout mismatch");
+
+// get size of one vertex
+uint32_t GetVertexStride(VERTEX_FORMAT format)
+{
+	switch (format)
+	{
+	case VERTEX_FORMAT_COMPACT:
+		return uint32_t(sizeof(CompactVertex));
+
+	case VERTEX_FORMAT_QUANTIZED:
+		return uint32_t(sizeof(QuantizedVertex));
+
+	default:
+		return uint32_t(sizeof(MeshVertex));
+	}
+}
+
+// get input layout
+D3D12_INPUT_LAYOUT_DESC GetVertexInputLayout(VERTEX_FORMAT format)
+{
+	switch (format)
+	{
+	case VERTEX_FORMAT_COMPACT:
+		return CompactVertex::InputLayout;
+
+	case VERTEX_FORMAT_QUANTIZED:
+		return QuantizedVertex::InputLayout;
+
+	default:
+		return MeshVertex::InputLayout;
+	}
+}
+
+// encode vertices
+void EncodeVertices
+(
+	VERTEX_FORMAT format,
+	const std::vector<MeshVertex>& vertices,
+	std::vector<uint8_t>& result,
+	VertexQuantization& quantization
+)
+{
+	quantization.Offset = DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f);
+	quantization.Scale = DirectX::XMFLOAT3(1.0f, 1.0f, 1.0f);
+
+	auto stride = GetVertexStride(format);
+	result.resize(size_t(stride) * vertices.size());
+
+	if (format == VERTEX_FORMAT_FULL)
+	{
+		if (!vertices.empty())
+		{
+			memcpy(result.data(), vertices.data(), result.size());
+		}
+		return;
+	}
+
+	// bounds of positions
+	if (format == VERTEX_FORMAT_QUANTIZED && !vertices.empty())
+	{
+		auto minPos = vertices[0].Position;
+		auto maxPos = vertices[0].Position;
+		for (size_t i = 1; i < vertices.size(); ++i)
+		{
+			const auto& p = vertices[i].Position;
+			minPos.x = std::min(minPos.x, p.x);
+			minPos.y = std::min(minPos.y, p.y);
+			minPos.z = std::min(minPos.z, p.z);
+			maxPos.x = std::max(maxPos.x, p.x);
+			maxPos.y = std::max(maxPos.y, p.y);
+			maxPos.z = std::max(maxPos.z, p.z);
+		}
+
+		// a flat axis keeps scale 1 so that decoding never divides by zero
+		quantization.Offset = minPos;
+		quantization.Scale.x = (maxPos.x > minPos.x) ? maxPos.x - minPos.x : 1.0f;
+		quantization.Scale.y = (maxPos.y > minPos.y) ? maxPos.y - minPos.y : 1.0f;
+		quantization.Scale.z = (maxPos.z > minPos.z) ? maxPos.z - minPos.z : 1.0f;
+	}
+
+	for (size_t i = 0; i < vertices.size(); ++i)
+	{
+		const auto& src = vertices[i];
+		auto ptr = result.data() + stride * i;
+
+		if (format == VERTEX_FORMAT_COMPACT)
+		{
+			auto dst = reinterpret_cast<CompactVertex*>(ptr);
+			dst->Position = src.Position;
+			EncodeOctahedral(Normalize(src.Normal), dst->Normal);
+			EncodeOctahedral(Normalize(src.Tangent), dst->Tangent);
+			dst->TexCoord[0] = DirectX::PackedVector::XMConvertFloatToHalf(src.TexCoord.x);
+			dst->TexCoord[1] = DirectX::PackedVector::XMConvertFloatToHalf(src.TexCoord.y);
+		}
+		else
+		{
+			auto dst = reinterpret_cast<QuantizedVertex*>(ptr);
+			dst->Position[0] = ToUnorm16((src.Position.x - quantization.Offset.x) / quantization.Scale.x);
+			dst->Position[1] = ToUnorm16((src.Position.y - quantization.Offset.y) / quantization.Scale.y);
+			dst->Position[2] = ToUnorm16((src.Position.z - quantization.Offset.z) / quantization.Scale.z);
+			dst->Position[3] = 0;
+			EncodeOctahedral(Normalize(src.Normal), dst->Normal);
+			EncodeOctahedral(Normalize(src.Tangent), dst->Tangent);
+			dst->TexCoord[0] = DirectX::PackedVector::XMConvertFloatToHalf(src.TexCoord.x);
+			dst->TexCoord[1] = DirectX::PackedVector::XMConvertFloatToHalf(src.TexCoord.y);
+		}
+	}
+}
+
+// decode vertices
+void DecodeVertices
+(
+	VERTEX_FORMAT format,
+	const uint8_t* data,
+	size_t count,
+	const VertexQuantization& quantization,
+	std::vector<MeshVertex>& result
+)
+{
+	result.resize(count);
+	if (data == nullptr || count == 0)
+	{
+		return;
+	}
+
+	if (format == VERTEX_FORMAT_FULL)
+	{
+		memcpy(result.data(), data, sizeof(MeshVertex) * count);
+		return;
+	}
+
+	auto stride = GetVertexStride(format);
+	for (size_t i = 0; i < count; ++i)
+	{
+		auto ptr = data + stride * i;
+		auto& dst = result[i];
+
+		if (format == VERTEX_FORMAT_COMPACT)
+		{
+			auto src = reinterpret_cast<const CompactVertex*>(ptr);
+			dst.Position = src->Position;
+			dst.Normal = DecodeOctahedral(src->Normal);
+			dst.Tangent = DecodeOctahedral(src->Tangent);
+			dst.TexCoord.x = DirectX::PackedVector::XMConvertHalfToFloat(src->TexCoord[0]);
+			dst.TexCoord.y = DirectX::PackedVector::XMConvertHalfToFloat(src->TexCoord[1]);
+		}
+		else
+		{
+			auto src = reinterpret_cast<const QuantizedVertex*>(ptr);
+			dst.Position.x = quantization.Offset.x + quantization.Scale.x * FromUnorm16(src->Position[0]);
+			dst.Position.y = quantization.Offset.y + quantization.Scale.y * FromUnorm16(src->Position[1]);
+			dst.Position.z = quantization.Offset.z + quantization.Scale.z * FromUnorm16(src->Position[2]);
+			dst.Normal = DecodeOctahedral(src->Normal);
+			dst.Tangent = DecodeOctahedral(src->Tangent);
+			dst.TexCoord.x = DirectX::PackedVector::XMConvertHalfToFloat(src->TexCoord[0]);
+			dst.TexCoord.y = DirectX::PackedVector::XMConvertHalfToFloat(src->TexCoord[1]);
+		}
+	}
+}
+
+// measure round trip error
+VertexCodecError MeasureVertexError
+(
+	VERTEX_FORMAT format,
+	const std::vector<MeshVertex>& vertices
+)
+{
+	VertexCodecError result = {};
+
+	std::vector<uint8_t> encoded;
+	std::vector<MeshVertex> decoded;
+	VertexQuantization quantization;
+
+	EncodeVertices(format, vertices, encoded, quantization);
+	DecodeVertices(format, encoded.data(), vertices.size(), quantization, decoded);
+
+	for (size_t i = 0; i < vertices.size(); ++i)
+	{
+		const auto& a = vertices[i];
+		const auto& b = decoded[i];
+
+		auto dx = std::abs(a.Position.x - b.Position.x);
+		auto dy = std::abs(a.Position.y - b.Position.y);
+		auto dz = std::abs(a.Position.z - b.Position.z);
+		result.MaxPosition = std::max(result.MaxPosition, std::max(dx, std::max(dy, dz)));
+
+		result.MaxNormalAngle = std::max(result.MaxNormalAngle, AngleBetween(a.Normal, b.Normal));
+		result.MaxTangentAngle = std::max(result.MaxTangentAngle, AngleBetween(a.Tangent, b.Tangent));
+
+		auto du = std::abs(a.TexCoord.x - b.TexCoord.x);
+		auto dv = std::abs(a.TexCoord.y - b.TexCoord.y);
+		result.MaxTexCoord = std::max(result.MaxTexCoord, std::max(du, dv));
+	}
+
+	return result;
+}
+
+// get error limit of a format
+VertexCodecError GetVertexErrorLimit
+(
+	VERTEX_FORMAT format,
+	const std::vector<MeshVertex>& vertices
+)
+{
+	VertexCodecError result = {};
+	if (format == VERTEX_FORMAT_FULL || vertices.empty())
+	{
+		return result;
+	}
+
+	result.MaxNormalAngle = OctahedralAngleLimit;
+	result.MaxTangentAngle = OctahedralAngleLimit;
+
+	// half keeps 11 significant bits, and steps of 2^-24 below 2^-14
+	auto maxTexCoord = 0.0f;
+	for (const auto& vertex : vertices)
+	{
+		maxTexCoord = std::max(maxTexCoord, std::max(std::abs(vertex.TexCoord.x), std::abs(vertex.TexCoord.y)));
+	}
+	result.MaxTexCoord = maxTexCoord * (1.0f / 2048.0f) + (1.0f / 33554432.0f);
+
+	// unorm16 rounds to half a step of the extent. a whole step and a few float steps of the
+	// largest coordinate cover the rounding of the decode arithmetic
+	if (format == VERTEX_FORMAT_QUANTIZED)
+	{
+		auto minPos = vertices[0].Position;
+		auto maxPos = vertices[0].Position;
+		for (const auto& vertex : vertices)
+		{
+			const auto& p = vertex.Position;
+			minPos.x = std::min(minPos.x, p.x);
+			minPos.y = std::min(minPos.y, p.y);
+			minPos.z = std::min(minPos.z, p.z);
+			maxPos.x = std::max(maxPos.x, p.x);
+			maxPos.y = std::max(maxPos.y, p.y);
+			maxPos.z = std::max(maxPos.z, p.z);
+		}
+
+		auto extent = std::max(maxPos.x - minPos.x, std::max(maxPos.y - minPos.y, maxPos.z - minPos.z));
+		auto maxAbs = std::max(
+			std::max(std::max(std::abs(minPos.x), std::abs(maxPos.x)), std::max(std::abs(minPos.y), std::abs(maxPos.y))),
+			std::max(std::abs(minPos.z), std::abs(maxPos.z)));
+		result.MaxPosition = extent / 65535.0f + maxAbs * 4.0f * FLT_EPSILON;
+	}
+
+	return result;
+}
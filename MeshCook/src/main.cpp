@@ -0,0 +1,92 @@
+#if defined(DEBUG) || defined(_DEBUG)
+#define _CRTDBG_MAP_ALLOC
+#include <crtdbg.h>
+#endif//defined(DEBUG) || defined(_DEBUG)
+
+#include "MeshCook.h"
+#include "ThreadPool.h"
+#include "Logger.h"
+#include <chrono>
+#include <cstdio>
+#include <cwchar>
+
+namespace {
+	// names of the vertex formats on the command line
+	const wchar_t* FormatNames[VERTEX_FORMAT_COUNT] = {
+		L"full",
+		L"compact",
+		L"quantized",
+	};
+
+	void PrintUsage()
+	{
+		printf_s("usage : MeshCook <source> [full|compact|quantized]\n");
+		printf_s("  writes <source>.cooked, which the sample loads instead of importing the source.\n");
+		printf_s("  the format must match the vertex format of the sample (quantized by default).\n");
+	}
+} // namespace
+
+int wmain(int argc, wchar_t** argv, wchar_t** envp)
+{
+#if defined(DEBUG) || defined(_DEBUG)
+	_CrtSetDbgFlag(_CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF);
+#endif//defined(DEBUG) || defined(_DEBUG)
+
+	if (argc < 2 || argc > 3)
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	auto format = VERTEX_FORMAT_QUANTIZED;
+	if (argc == 3)
+	{
+		auto found = false;
+		for (auto i = 0; i < VERTEX_FORMAT_COUNT; ++i)
+		{
+			if (wcscmp(argv[2], FormatNames[i]) == 0)
+			{
+				format = VERTEX_FORMAT(i);
+				found = true;
+			}
+		}
+
+		if (!found)
+		{
+			PrintUsage();
+			return 1;
+		}
+	}
+
+	ThreadPool pool;
+	if (!pool.Init())
+	{
+		ELOG("Error : ThreadPool::Init() Failed.");
+		return 1;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+
+	std::vector<uint8_t> data;
+	if (!CookMesh(argv[1], format, data, &pool))
+	{
+		ELOG("Error : Cook Mesh Failed. filepath = %ls", argv[1]);
+		return 1;
+	}
+
+	auto cachePath = GetMeshCachePath(argv[1]);
+	if (!SaveMeshCache(cachePath.c_str(), data))
+	{
+		ELOG("Error : Save Mesh Cache Failed. filepath = %ls", cachePath.c_str());
+		return 1;
+	}
+
+	auto end = std::chrono::steady_clock::now();
+	printf_s("%ls : %zu bytes (%ls) in %f msec.\n",
+		cachePath.c_str(),
+		data.size(),
+		FormatNames[format],
+		std::chrono::duration<double, std::milli>(end - start).count());
+
+	return 0;
+}
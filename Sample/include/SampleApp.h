@@ -4,7 +4,11 @@
 #include <Camera.h>
 #include <ConstantBuffer.h>
 #include <Material.h>
+#include <PipelineCache.h>
 #include <RootSignature.h>
+#include <MipStreamer.h>
+#include <RenderGraph.h>
+#include <TransientHeap.h>
 #include <chrono>
 
 //
@@ -25,22 +29,31 @@ public:
 
 private:
 
-	ComPtr<ID3D12PipelineState> m_pScenePSO; //!< pipeline state for scene
+	PipelineHandle m_ScenePipeline; //!< pipeline state for scene (compiled in the background)
 	RootSignature m_SceneRootSig; //!< root signature for scene
-	ComPtr<ID3D12PipelineState> m_pTonemapPSO; //!< pipeline state for tonemap
+	PipelineHandle m_TonemapPipeline; //!< pipeline state for tonemap (compiled in the background)
 	RootSignature m_TonemapRootSig; //!< root signature for tonemap
+	PipelineCache m_PipelineCache; //!< shares root signatures and pipeline states, and keeps compiled pipelines on disk
 	ColorTarget m_SceneColorTarget; //!< render target for scene
 	DepthTarget m_SceneDepthTarget; //!< depth target for scene
+	TransientHeap m_TransientHeap; //!< memory which the scene targets and the depth target share by lifetime
+	RenderGraph m_RenderGraph; //!< passes of a frame and the barriers between them
+	std::vector<ID3D12Resource*> m_GraphResources; //!< resource of each render graph resource id in the current frame
+	uint32_t m_ScenePass; //!< render graph pass id of scene
+	uint32_t m_TonemapPass; //!< render graph pass id of tonemap
+	uint32_t m_SceneColorId; //!< render graph resource id of the scene color target
+	uint32_t m_SceneDepthId; //!< render graph resource id of the scene depth target
+	uint32_t m_DepthId; //!< render graph resource id of the depth target for the frame buffer
+	uint32_t m_BackBufferId; //!< render graph resource id of the back buffer
 	VertexBuffer m_QuadVB; //!< vertex buffer
 	VertexBuffer m_WallVB; //!< vertex buffer for wall
 	VertexBuffer m_FloorVB; //!< vertex buffer for floor
-	ConstantBuffer m_TonemapCB[FrameCount]; //!< constant buffer
-	ConstantBuffer m_LightCB[FrameCount]; //!< light buffer
-	ConstantBuffer m_CameraCB[FrameCount]; //!< camera buffer
-	ConstantBuffer m_TransformCB[FrameCount]; //!< buffer for transform
-	ConstantBuffer m_MeshCB[FrameCount]; //!< buffer for mesh
+	GeometryArena m_GeometryArena; //!< vertices and indices of every mesh
 	std::vector<Mesh*> m_pMesh; //!< mesh
+	std::vector<DirectX::XMFLOAT4> m_MeshBounds; //!< bounding sphere of each mesh (xyz : center, w : radius)
+	std::vector<D3D12_GPU_VIRTUAL_ADDRESS> m_MeshAddress; //!< constant buffer of each mesh in the current frame (0 if it could not be allocated)
 	Material m_Material; //!< material
+	MipStreamer m_MipStreamer; //!< streams mips of material textures within a budget
 	float m_RotateAngle; //!< rotation angle of light
 	int m_TonemapType; //!< type of tonemap
 	int m_ColorSpace; //!< output color space
@@ -49,6 +62,11 @@ private:
 	float m_Exposure; //!< exposure
 
 	std::chrono::system_clock::time_point m_StartTime; //!< start time
+	std::chrono::steady_clock::time_point m_InitTime; //!< time initialization started
+	bool m_IsFirstFrame; //!< whether the first frame is yet to be presented
+	bool m_IsStreaming; //!< whether texture mips are still being streamed
+	bool m_IsCompiling; //!< whether pipeline states are still being compiled
+	bool m_IsBindless; //!< whether materials are indexed from one unbounded table (resource binding tier 2)
 
 	//! @brief initialize
 	//! 
@@ -70,12 +88,36 @@ private:
 	//! @param[in] hdr if true, change settings for HDR display
 	void ChangeDisplayMode(bool hdr);
 
-	//! @brief draw scene
-	void DrawScene(ID3D12GraphicsCommandList* pCmdList);
+	//! @brief declare passes of a frame and compile their barriers
+	//! 
+	//! @retval true successfully built
+	//! @retval false failed to build
+	bool BuildRenderGraph();
+
+	//! @brief place render targets of the passes in the transient heap
+	//! 
+	//! @retval true successfully initialized
+	//! @retval false failed to initialize
+	bool InitTransientTargets();
+
+	//! @brief draw scene on worker threads
+	//! 
+	//! @param[out] pLists closed commandlists of the scene are appended in draw order
+	void DrawScene(std::vector<ID3D12CommandList*>& pLists);
 
 	//! @brief apply tonemap
 	void DrawTonemap(ID3D12GraphicsCommandList* pCmdList);
 
 	//! @brief draw mesh
-	void DrawMesh(ID3D12GraphicsCommandList* pCmdList);
+	//! 
+	//! @param[in] pCmdList commandlist which the scene pass has been set up for
+	//! @param[in] begin index of the first mesh
+	//! @param[in] end index past the last mesh
+	void DrawMesh(ID3D12GraphicsCommandList* pCmdList, size_t begin, size_t end);
+
+	//! @brief request texture mips by the size of each mesh on screen
+	//! 
+	//! @param[in] cameraPos position of the camera
+	//! @param[in] fovY vertical field of view in radians
+	void RequestTextureMips(const DirectX::XMFLOAT3& cameraPos, float fovY);
 };
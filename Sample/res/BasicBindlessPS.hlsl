@@ -0,0 +1,5 @@
+//
+// BINDLESS variant of BasicPS
+//
+#define BINDLESS
+#include "BasicPS.hlsl"
@@ -0,0 +1,5 @@
+//
+// VERTEX_FORMAT_COMPACT variant of BasicVS
+//
+#define VERTEX_FORMAT_COMPACT
+#include "BasicVS.hlsl"
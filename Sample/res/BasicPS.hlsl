@@ -47,17 +47,47 @@ cbuffer CbCamera : register(b2)
 	float3 CameraPosition : packoffset(c0); // camera position
 };
 
-// textures and samplers
-Texture2D BaseColorMap : register(t0);
-SamplerState BaseColorSmp : register(s0);
+#ifdef BINDLESS
+//
+// MaterialIndices structure
+//
+struct MaterialIndices
+{
+	uint BaseColor; // heap index of base color map
+	uint Metallic; // heap index of metallic map
+	uint Roughness; // heap index of roughness map
+	uint Normal; // heap index of normal map
+};
 
-Texture2D MetallicMap : register(t1);
-SamplerState MetallicSmp : register(s1);
+//
+// CbDraw constant buffer (root constant)
+//
+cbuffer CbDraw : register(b3)
+{
+	uint MaterialId : packoffset(c0); // index into Materials
+};
 
-Texture2D RoughnessMap : register(t2);
-SamplerState RoughnessSmp : register(s2);
+// every material, and every texture of the descriptor heap
+StructuredBuffer<MaterialIndices> Materials : register(t0);
+Texture2D Textures[] : register(t0, space1);
 
+// maps of the current material. MaterialId is the same for the whole draw, so indexing is uniform
+#define BaseColorMap Textures[Materials[MaterialId].BaseColor]
+#define MetallicMap Textures[Materials[MaterialId].Metallic]
+#define RoughnessMap Textures[Materials[MaterialId].Roughness]
+#define NormalMap Textures[Materials[MaterialId].Normal]
+#else
+// textures
+Texture2D BaseColorMap : register(t0);
+Texture2D MetallicMap : register(t1);
+Texture2D RoughnessMap : register(t2);
 Texture2D NormalMap : register(t3);
+#endif // BINDLESS
+
+// samplers
+SamplerState BaseColorSmp : register(s0);
+SamplerState MetallicSmp : register(s1);
+SamplerState RoughnessSmp : register(s2);
 SamplerState NormalSmp : register(s3);
 
 // attenuate according to distance
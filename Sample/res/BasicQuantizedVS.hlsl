@@ -0,0 +1,5 @@
+//
+// VERTEX_FORMAT_QUANTIZED variant of BasicVS
+//
+#define VERTEX_FORMAT_QUANTIZED
+#include "BasicVS.hlsl"
@@ -1,13 +1,4 @@
-//
-// VSInput structure
-//
-struct VSInput
-{
-	float3 Position : POSITION; // position coords
-	float3 Normal : NORMAL; // normal vector
-	float2 TexCoord : TEXCOORD; // texture coords
-	float3 Tangent : TANGENT; // tangent vector
-};
+#include "VertexDecode.hlsli"
 
 //
 // VSOutput structure
@@ -35,6 +26,8 @@ cbuffer CbTransform : register(b0)
 cbuffer CbMesh : register(b1)
 {
 	float4x4 World : packoffset(c0); // world matrix
+	float4 PositionOffset : packoffset(c4); // offset to dequantize position
+	float4 PositionScale : packoffset(c5); // scale to dequantize position
 };
 
 // main entry point to the vertex buffer
@@ -42,7 +35,7 @@ VSOutput main(VSInput input)
 {
 	VSOutput output = (VSOutput)0;
 
-	float4 localPos = float4(input.Position, 1.0f);
+	float4 localPos = float4(DecodePosition(input, PositionOffset.xyz, PositionScale.xyz), 1.0f);
 	float4 worldPos = mul(World, localPos);
 	float4 viewPos = mul(View, worldPos);
 	float4 projPos = mul(Proj, viewPos);
@@ -52,8 +45,8 @@ VSOutput main(VSInput input)
 	output.WorldPos = worldPos.xyz;
 
 	// base vectors
-	float3 N = normalize(mul((float3x3)World, input.Normal));
-	float3 T = normalize(mul((float3x3)World, input.Tangent));
+	float3 N = normalize(mul((float3x3)World, DecodeNormal(input)));
+	float3 T = normalize(mul((float3x3)World, DecodeTangent(input)));
 	float3 B = normalize(cross(N, T));
 
 	// inverse matrix of base transformation
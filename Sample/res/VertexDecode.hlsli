@@ -0,0 +1,77 @@
+#ifndef VERTEX_DECODE_HLSLI
+#define VERTEX_DECODE_HLSLI
+
+//
+// VSInput structure
+//
+// VERTEX_FORMAT_COMPACT   : float3 position, octahedral normal/tangent, half UV
+// VERTEX_FORMAT_QUANTIZED : unorm16 position in the mesh AABB, octahedral normal/tangent, half UV
+// otherwise               : full float layout
+//
+#if defined(VERTEX_FORMAT_COMPACT)
+struct VSInput
+{
+	float3 Position : POSITION; // position coords
+	float2 Normal : NORMAL; // octahedral normal vector
+	float2 Tangent : TANGENT; // octahedral tangent vector
+	float2 TexCoord : TEXCOORD; // texture coords
+};
+#elif defined(VERTEX_FORMAT_QUANTIZED)
+struct VSInput
+{
+	float4 Position : POSITION; // position coords in [0, 1] of the mesh AABB
+	float2 Normal : NORMAL; // octahedral normal vector
+	float2 Tangent : TANGENT; // octahedral tangent vector
+	float2 TexCoord : TEXCOORD; // texture coords
+};
+#else
+struct VSInput
+{
+	float3 Position : POSITION; // position coords
+	float3 Normal : NORMAL; // normal vector
+	float2 TexCoord : TEXCOORD; // texture coords
+	float3 Tangent : TANGENT; // tangent vector
+};
+#endif
+
+// decode octahedral encoded unit vector
+float3 DecodeOctahedral(float2 e)
+{
+	float3 v = float3(e.xy, 1.0f - abs(e.x) - abs(e.y));
+	float t = saturate(-v.z);
+	v.x += (v.x >= 0.0f) ? -t : t;
+	v.y += (v.y >= 0.0f) ? -t : t;
+	return normalize(v);
+}
+
+// decode position
+float3 DecodePosition(VSInput input, float3 offset, float3 scale)
+{
+#if defined(VERTEX_FORMAT_QUANTIZED)
+	return offset + scale * input.Position.xyz;
+#else
+	return input.Position;
+#endif
+}
+
+// decode normal vector
+float3 DecodeNormal(VSInput input)
+{
+#if defined(VERTEX_FORMAT_COMPACT) || defined(VERTEX_FORMAT_QUANTIZED)
+	return DecodeOctahedral(input.Normal);
+#else
+	return input.Normal;
+#endif
+}
+
+// decode tangent vector
+float3 DecodeTangent(VSInput input)
+{
+#if defined(VERTEX_FORMAT_COMPACT) || defined(VERTEX_FORMAT_QUANTIZED)
+	return DecodeOctahedral(input.Tangent);
+#else
+	return input.Tangent;
+#endif
+}
+
+#endif // VERTEX_DECODE_HLSLI
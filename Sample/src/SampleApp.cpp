@@ -1,14 +1,37 @@
 #include "SampleApp.h"
 #include "FileUtil.h"
 #include "Logger.h"
+#include "BufferUploadBatch.h"
+#include "MeshCook.h"
 #include "CommonStates.h"
 #include "DirectXHelpers.h"
 #include "SimpleMath.h"
+#include <algorithm>
 
 // using statements
 using namespace DirectX::SimpleMath;
 
 namespace {
+	// vertex format of scene meshes (BasicVS variant and input layout follow it)
+	const VERTEX_FORMAT SceneVertexFormat = VERTEX_FORMAT_QUANTIZED;
+
+	// video memory which streamed texture mips may use
+	const uint64_t TextureBudget = 64 * 1024 * 1024;
+
+	// formats of scene targets
+	const DXGI_FORMAT SceneColorFormat = DXGI_FORMAT_R10G10B10A2_UNORM;
+	const DXGI_FORMAT SceneDepthFormat = DXGI_FORMAT_D32_FLOAT;
+
+	// draws which one scene commandlist takes at least, as each list sets up the whole state again
+	const uint32_t MinDrawsPerList = 64;
+
+	// vertex shader which decodes each vertex format
+	const wchar_t* SceneVertexShaders[VERTEX_FORMAT_COUNT] = {
+		L"BasicVS.cso",
+		L"BasicCompactVS.cso",
+		L"BasicQuantizedVS.cso",
+	};
+
 	//
 	// COLOR_SPACE_TYPE enum
 	//
@@ -45,6 +68,8 @@ namespace {
 	struct alignas(256) CbMesh
 	{
 		Matrix World; //!< world matrix
+		Vector4 PositionOffset; //!< offset to dequantize position
+		Vector4 PositionScale; //!< scale to dequantize position
 	};
 
 	//
@@ -130,6 +155,74 @@ namespace {
 
 		return result;
 	}
+
+	// resource state of each render graph usage
+	const struct
+	{
+		uint32_t Usage;
+		D3D12_RESOURCE_STATES State;
+	} UsageStates[] = {
+		{ RESOURCE_USAGE_RENDER_TARGET, D3D12_RESOURCE_STATE_RENDER_TARGET },
+		{ RESOURCE_USAGE_DEPTH_WRITE, D3D12_RESOURCE_STATE_DEPTH_WRITE },
+		{ RESOURCE_USAGE_COPY_DEST, D3D12_RESOURCE_STATE_COPY_DEST },
+		{ RESOURCE_USAGE_DEPTH_READ, D3D12_RESOURCE_STATE_DEPTH_READ },
+		{ RESOURCE_USAGE_PIXEL_SHADER, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE },
+		{ RESOURCE_USAGE_NON_PIXEL_SHADER, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE },
+		{ RESOURCE_USAGE_COPY_SOURCE, D3D12_RESOURCE_STATE_COPY_SOURCE },
+		{ RESOURCE_USAGE_PRESENT, D3D12_RESOURCE_STATE_PRESENT },
+	};
+
+	// resource state of render graph usages (read usages are combined)
+	D3D12_RESOURCE_STATES GetResourceState(uint32_t usage)
+	{
+		auto result = D3D12_RESOURCE_STATE_COMMON;
+		for (const auto& item : UsageStates)
+		{
+			if ((usage & item.Usage) != 0)
+			{
+				result |= item.State;
+			}
+		}
+
+		return result;
+	}
+
+	// record barriers compiled by the render graph with one call
+	void RecordBarriers
+	(
+		ID3D12GraphicsCommandList* pCmdList,
+		const std::vector<RenderGraph::Barrier>& barriers,
+		ID3D12Resource* const* ppResources
+	)
+	{
+		if (barriers.empty())
+		{
+			return;
+		}
+
+		std::vector<D3D12_RESOURCE_BARRIER> desc(barriers.size());
+		for (size_t i = 0; i < barriers.size(); ++i)
+		{
+			const auto& barrier = barriers[i];
+			desc[i] = {};
+			if (barrier.Type == RenderGraph::BARRIER_TYPE_ALIASING)
+			{
+				desc[i].Type = D3D12_RESOURCE_BARRIER_TYPE_ALIASING;
+				desc[i].Aliasing.pResourceBefore = ppResources[barrier.ResourceBefore];
+				desc[i].Aliasing.pResourceAfter = ppResources[barrier.Resource];
+			}
+			else
+			{
+				desc[i].Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+				desc[i].Transition.pResource = ppResources[barrier.Resource];
+				desc[i].Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+				desc[i].Transition.StateBefore = GetResourceState(barrier.Before);
+				desc[i].Transition.StateAfter = GetResourceState(barrier.After);
+			}
+		}
+
+		pCmdList->ResourceBarrier(UINT(desc.size()), desc.data());
+	}
 } // namespace
 
 //
@@ -145,6 +238,16 @@ SampleApp::SampleApp(uint32_t width, uint32_t height)
 	, m_MaxLuminance(100.0f)
 	, m_Exposure(1.0f)
 	, m_RotateAngle(0.0f)
+	, m_ScenePass(RenderGraph::InvalidId)
+	, m_TonemapPass(RenderGraph::InvalidId)
+	, m_SceneColorId(RenderGraph::InvalidId)
+	, m_SceneDepthId(RenderGraph::InvalidId)
+	, m_DepthId(RenderGraph::InvalidId)
+	, m_BackBufferId(RenderGraph::InvalidId)
+	, m_IsFirstFrame(true)
+	, m_IsStreaming(false)
+	, m_IsCompiling(false)
+	, m_IsBindless(false)
 {
 }
 
@@ -156,6 +259,8 @@ SampleApp::~SampleApp()
 // initialize
 bool SampleApp::OnInit()
 {
+	m_InitTime = std::chrono::steady_clock::now();
+
 	// load mesh
 	{
 		std::wstring path;
@@ -169,21 +274,65 @@ bool SampleApp::OnInit()
 
 		std::wstring dir = GetDirectoryPath(path.c_str());
 
-		std::vector<ResMesh> resMesh;
-		std::vector<ResMaterial> resMaterial;
-
-		// load mesh resource
-		if (!LoadMesh(path.c_str(), resMesh, resMaterial))
+		// cooked meshes are uploaded straight from the mapped file
+		MeshCache cache;
+		if (!LoadCookedMesh(path.c_str(), SceneVertexFormat, cache, &m_ThreadPool))
 		{
 			ELOG("Error : Load Mesh Failed. filepath = %ls", path.c_str());
 			return false;
 		}
 
 		// reserve memory
-		m_pMesh.reserve(resMesh.size());
+		m_pMesh.reserve(cache.GetMeshCount());
+
+		// static geometry is copied into DEFAULT heaps on the copy queue
+		BufferUploadBatch geometryBatch;
+		if (!geometryBatch.Init(m_pDevice.Get(), m_pCopyQueue.Get()))
+		{
+			ELOG("Error : BufferUploadBatch::Init() Failed.");
+			return false;
+		}
+
+		// every mesh shares one vertex buffer and one index buffer per index format
+		{
+			size_t vertexCount = 0;
+			size_t indexCount16 = 0;
+			size_t indexCount32 = 0;
+			for (size_t i = 0; i < cache.GetMeshCount(); ++i)
+			{
+				const auto& mesh = cache.GetMesh(i);
+				vertexCount += mesh.VertexCount;
+				if (mesh.IndexFormat == DXGI_FORMAT_R16_UINT)
+				{
+					indexCount16 += mesh.IndexCount;
+				}
+				else
+				{
+					indexCount32 += mesh.IndexCount;
+				}
+			}
+
+			DLOG("Info : index buffer %zu bytes -> %zu bytes.",
+				sizeof(uint32_t) * (indexCount16 + indexCount32),
+				sizeof(uint16_t) * indexCount16 + sizeof(uint32_t) * indexCount32);
+
+			if (!m_GeometryArena.Init(
+				m_pDevice.Get(),
+				GetVertexStride(SceneVertexFormat),
+				uint32_t(vertexCount),
+				uint32_t(indexCount16),
+				uint32_t(indexCount32),
+				&m_ReleaseQueue))
+			{
+				ELOG("Error : GeometryArena::Init() Failed.");
+				return false;
+			}
+		}
+
+		geometryBatch.Begin();
 
 		// initialize mesh
-		for (size_t i = 0; i < resMesh.size(); ++i)
+		for (size_t i = 0; i < cache.GetMeshCount(); ++i)
 		{
 			// generate mesh
 			auto mesh = new (std::nothrow) Mesh();
@@ -196,7 +345,7 @@ bool SampleApp::OnInit()
 			}
 
 			// intialize
-			if (!mesh->Init(m_pDevice.Get(), resMesh[i]))
+			if (!mesh->Init(m_GeometryArena, geometryBatch, cache.GetMesh(i)))
 			{
 				ELOG("Error : Mesh Initialize Failed.");
 				delete mesh;
@@ -205,129 +354,135 @@ bool SampleApp::OnInit()
 
 			// if succeeded, subscribe
 			m_pMesh.push_back(mesh);
+
+			// bounding sphere which decides the mips of its textures
+			m_MeshBounds.push_back(cache.GetMesh(i).Bounds);
 		}
 
 		// optimize memory
 		m_pMesh.shrink_to_fit();
 
+		if (geometryBatch.End() == 0)
+		{
+			ELOG("Error : BufferUploadBatch::End() Failed.");
+			return false;
+		}
+
+		// the direct queue waits for the geometry on the GPU, the CPU goes on
+		auto geometryValue = SignalQueue(QUEUE_TYPE_COPY);
+		if (geometryValue == 0)
+		{
+			ELOG("Error : App::SignalQueue() Failed.");
+			return false;
+		}
+		WaitQueue(QUEUE_TYPE_DIRECT, QUEUE_TYPE_COPY, geometryValue);
+
 		// initialzie material
 		if (!m_Material.Init(
 			m_pDevice.Get(),
 			m_pPool[POOL_TYPE_RES],
+			&m_ReleaseQueue,
 			sizeof(CbMaterial),
-			resMaterial.size()))
+			cache.GetMaterials().size()))
 		{
 			ELOG("Error : Material::Init() Failed.");
 			return false;
 		}
 
-		// prepare resource batch
-		DirectX::ResourceUploadBatch batch(m_pDevice.Get());
-
-		// begin batch
-		batch.Begin();
+		// textures start with their mip tail and get finer mips as they grow on screen
+		if (!m_MipStreamer.Init(
+			m_pDevice.Get(),
+			m_pPool[POOL_TYPE_RES],
+			m_pCopyQueue.Get(),
+			&m_ThreadPool,
+			&m_ReleaseQueue,
+			TextureBudget))
+		{
+			ELOG("Error : MipStreamer::Init() Failed.");
+			return false;
+		}
 
-		// set material and texture
+		// set material and texture (the dummy texture is bound until each mip tail is resident)
 		{
 			/* here we're hard coding */
-			m_Material.SetTexture(0, TU_BASE_COLOR, dir + L"wall_bc.dds", batch);
-			m_Material.SetTexture(0, TU_METALLIC, dir + L"wall_m.dds", batch);
-			m_Material.SetTexture(0, TU_ROUGHNESS, dir + L"wall_r.dds", batch);
-			m_Material.SetTexture(0, TU_NORMAL, dir + L"wall_n.dds", batch);
-
-			m_Material.SetTexture(1, TU_BASE_COLOR, dir + L"matball_bc.dds", batch);
-			m_Material.SetTexture(1, TU_METALLIC, dir + L"matball_m.dds", batch);
-			m_Material.SetTexture(1, TU_ROUGHNESS, dir + L"matball_r.dds", batch);
-			m_Material.SetTexture(1, TU_NORMAL, dir + L"matball_n.dds", batch);
+			m_Material.SetTexture(0, TU_BASE_COLOR, dir + L"wall_bc.dds", m_MipStreamer);
+			m_Material.SetTexture(0, TU_METALLIC, dir + L"wall_m.dds", m_MipStreamer);
+			m_Material.SetTexture(0, TU_ROUGHNESS, dir + L"wall_r.dds", m_MipStreamer);
+			m_Material.SetTexture(0, TU_NORMAL, dir + L"wall_n.dds", m_MipStreamer);
+
+			m_Material.SetTexture(1, TU_BASE_COLOR, dir + L"matball_bc.dds", m_MipStreamer);
+			m_Material.SetTexture(1, TU_METALLIC, dir + L"matball_m.dds", m_MipStreamer);
+			m_Material.SetTexture(1, TU_ROUGHNESS, dir + L"matball_r.dds", m_MipStreamer);
+			m_Material.SetTexture(1, TU_NORMAL, dir + L"matball_n.dds", m_MipStreamer);
+
+			DLOG("Info : %llu texture bytes shared by identical files.",
+				static_cast<unsigned long long>(m_Material.GetSavedTextureBytes()));
 		}
 
-		// end batch
-		auto future = batch.End(m_pQueue.Get());
-
-		// wait for complete of batch
-		future.wait();
+		m_IsStreaming = true;
 	}
 
-	// settings of light buffer
+	// declare passes of a frame
+	if (!BuildRenderGraph())
 	{
-		for (auto i = 0; i < FrameCount; ++i)
-		{
-			if (!m_LightCB[i].Init(m_pDevice.Get(), m_pPool[POOL_TYPE_RES], sizeof(CbLight)))
-			{
-				ELOG("Error : ConstnatBuffer::Init() Failed.");
-			}
-			
-			auto ptr = m_LightCB[i].GetPtr<CbLight>();
-			*ptr = ComputePointLight(Vector3(0.0f, 1.0f, 1.5f), 1.0f, Vector3(1.0f, 0.5f, 0.5f), 10.0f);
-		}
+		ELOG("Error : SampleApp::BuildRenderGraph() Failed.");
+		return false;
 	}
 
-	// settings of camera buffer
+	// place render targets of the passes in shared memory
+	if (!InitTransientTargets())
 	{
-		for (auto i = 0; i < FrameCount; ++i)
-		{
-			if (!m_CameraCB[i].Init(m_pDevice.Get(), m_pPool[POOL_TYPE_RES], sizeof(CbCamera)))
-			{
-				ELOG("Error : ConstantBuffer::Init() Failed.");
-				return false;
-			}
-		}
+		ELOG("Error : SampleApp::InitTransientTargets() Failed.");
+		return false;
 	}
 
-	// generate color target for scene
+	// initialize pipeline cache (compiled pipelines of the last run are loaded from the file,
+	// the others are compiled on the worker threads while the first frames are shown)
+	if (!m_PipelineCache.Init(m_pDevice.Get(), L"PipelineCache.bin", &m_ThreadPool))
 	{
-		float clearColor[4] = { 0.2f, 0.2f, 0.2f, 1.0f };
-		if (!m_SceneColorTarget.Init(
-			m_pDevice.Get(),
-			m_pPool[POOL_TYPE_RTV],
-			m_pPool[POOL_TYPE_RES],
-			m_Width,
-			m_Height,
-			DXGI_FORMAT_R10G10B10A2_UNORM,
-			clearColor))
-		{
-			ELOG("Error : ColorTarget::Init() Failed.");
-			return false;
-		}
+		ELOG("Error : PipelineCache::Init() Failed.");
+		return false;
 	}
 
-	// generate depth target for scene
+	// check whether unbounded descriptor tables can be used
 	{
-		if (!m_SceneDepthTarget.Init(
-			m_pDevice.Get(),
-			m_pPool[POOL_TYPE_DSV],
-			nullptr,
-			m_Width,
-			m_Height,
-			DXGI_FORMAT_D32_FLOAT,
-			1.0f,
-			0))
-		{
-			ELOG("Error : DepthTarget::Init() Failed.");
-			return false;
-		}
+		D3D12_FEATURE_DATA_D3D12_OPTIONS options = {};
+		auto hr = m_pDevice->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS, &options, sizeof(options));
+		m_IsBindless = SUCCEEDED(hr) && (options.ResourceBindingTier >= D3D12_RESOURCE_BINDING_TIER_2);
+		DLOG("Info : %s materials.", m_IsBindless ? "Bindless" : "Descriptor table");
 	}
 
 	// generate root signature
 	{
 		RootSignature::Desc desc;
-		desc.Begin(8)
-			.SetCBV(ShaderStage::VS, 0, 0)
-			.SetCBV(ShaderStage::VS, 1, 1)
-			.SetCBV(ShaderStage::PS, 2, 1)
-			.SetCBV(ShaderStage::PS, 3, 2)
-			.SetSRV(ShaderStage::PS, 4, 0)
-			.SetSRV(ShaderStage::PS, 5, 1)
-			.SetSRV(ShaderStage::PS, 6, 2)
-			.SetSRV(ShaderStage::PS, 7, 3)
-			.AddStaticSmp(ShaderStage::PS, 0, SamplerState::LinearWrap)
+		if (m_IsBindless)
+		{
+			desc.Begin(7)
+				.SetCBV(ShaderStage::VS, 0, 0)
+				.SetRootCBV(ShaderStage::VS, 1, 1) // b1 : per-draw mesh data, no descriptor needed
+				.SetCBV(ShaderStage::PS, 2, 1)
+				.SetCBV(ShaderStage::PS, 3, 2)
+				.SetRootSRV(ShaderStage::PS, 4, 0) // t0 : material table, copied to each frame's upload memory
+				.SetUnboundedSRV(ShaderStage::PS, 5, 0, 1) // t0, space1 : every texture of the heap
+				.SetConstants(ShaderStage::PS, 6, 3, 1); // b3 : material ID
+		}
+		else
+		{
+			desc.Begin(5)
+				.SetCBV(ShaderStage::VS, 0, 0)
+				.SetRootCBV(ShaderStage::VS, 1, 1) // b1 : per-draw mesh data, no descriptor needed
+				.SetCBV(ShaderStage::PS, 2, 1)
+				.SetCBV(ShaderStage::PS, 3, 2)
+				.SetSRV(ShaderStage::PS, 4, 0, Material::TextureTableSize); // t0-t3 in one table
+		}
+		desc.AddStaticSmp(ShaderStage::PS, 0, SamplerState::LinearWrap)
 			.AddStaticSmp(ShaderStage::PS, 1, SamplerState::LinearWrap)
 			.AddStaticSmp(ShaderStage::PS, 2, SamplerState::LinearWrap)
 			.AddStaticSmp(ShaderStage::PS, 3, SamplerState::LinearWrap)
 			.AllowIL()
 			.End();
 
-		if (!m_SceneRootSig.Init(m_pDevice.Get(), desc.GetDesc()))
+		if (!m_SceneRootSig.Init(&m_PipelineCache, desc.GetDesc()))
 		{
 			ELOG("Error : RootSignature::Init() Failed.");
 			return false;
@@ -340,48 +495,30 @@ bool SampleApp::OnInit()
 		std::wstring psPath;
 
 		// search for vertex shader
-		if (!SearchFilePath(L"BasicVS.cso", vsPath))
+		if (!SearchFilePath(SceneVertexShaders[SceneVertexFormat], vsPath))
 		{
 			ELOG("Error : Vertex Shader Not Found.");
 			return false;
 		}
 
 		// search for pixel shader
-		if (!SearchFilePath(L"BasicPS.cso", psPath))
+		if (!SearchFilePath(m_IsBindless ? L"BasicBindlessPS.cso" : L"BasicPS.cso", psPath))
 		{
 			ELOG("Error : Pixel Shader Not Found.");
 			return false;
 		}
 
-		ComPtr<ID3DBlob> pVSBlob;
-		ComPtr<ID3DBlob> pPSBlob;
-
-		// read vertex shaader
-		auto hr = D3DReadFileToBlob(vsPath.c_str(), pVSBlob.GetAddressOf());
-		if (FAILED(hr))
-		{
-			ELOG("Error : D3DReadFileToBlob() Failed. path = %ls", vsPath.c_str());
-			return false;
-		}
-
-		// read pixel shader
-		hr = D3DReadFileToBlob(psPath.c_str(), pPSBlob.GetAddressOf());
-		if (FAILED(hr))
+		// read shaders (each file is read once)
+		auto pVSBlob = m_PipelineCache.LoadShader(vsPath.c_str());
+		auto pPSBlob = m_PipelineCache.LoadShader(psPath.c_str());
+		if (pVSBlob == nullptr || pPSBlob == nullptr)
 		{
-			ELOG("Error : D3DReadFileToBlob() Failed. path = %ls", psPath.c_str());
 			return false;
 		}
 
-		D3D12_INPUT_ELEMENT_DESC elements[] = {
-			{ "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0,  D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
-			{ "NORMAL",   0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 12, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
-			{ "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT,    0, 24, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
-			{ "TANGENT",  0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 32, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 }
-		};
-
 		// set graphics pipeline state
 		D3D12_GRAPHICS_PIPELINE_STATE_DESC desc = {};
-		desc.InputLayout = { elements, 4 };
+		desc.InputLayout = GetVertexInputLayout(SceneVertexFormat);
 		desc.pRootSignature = m_SceneRootSig.GetPtr();
 		desc.VS = { pVSBlob->GetBufferPointer(), pVSBlob->GetBufferSize() };
 		desc.PS = { pPSBlob->GetBufferPointer(), pPSBlob->GetBufferSize() };
@@ -396,11 +533,11 @@ bool SampleApp::OnInit()
 		desc.SampleDesc.Count = 1;
 		desc.SampleDesc.Quality = 0;
 
-		// generate pipeline state
-		hr = m_pDevice->CreateGraphicsPipelineState(&desc, IID_PPV_ARGS(m_pScenePSO.GetAddressOf()));
-		if (FAILED(hr))
+		// request pipeline state (the scene is not drawn until it is ready)
+		m_ScenePipeline = m_PipelineCache.RequestGraphicsPipeline(desc);
+		if (!m_ScenePipeline.IsValid())
 		{
-			ELOG("Error : ID3D12Device::CreateGraphicsPipelineState() Failed. retcode = 0x%x", hr);
+			ELOG("Error : PipelineCache::RequestGraphicsPipeline() Failed.");
 			return false;
 		}
 	}
@@ -415,7 +552,7 @@ bool SampleApp::OnInit()
 			.AllowIL()
 			.End();
 
-		if (!m_TonemapRootSig.Init(m_pDevice.Get(), desc.GetDesc()))
+		if (!m_TonemapRootSig.Init(&m_PipelineCache, desc.GetDesc()))
 		{
 			ELOG("Error : RootSignature::Init() Failed.");
 			return false;
@@ -441,22 +578,11 @@ bool SampleApp::OnInit()
 			return false;
 		}
 
-		ComPtr<ID3DBlob> pVSBlob;
-		ComPtr<ID3DBlob> pPSBlob;
-
-		// read vertex shader
-		auto hr = D3DReadFileToBlob(vsPath.c_str(), pVSBlob.GetAddressOf());
-		if (FAILED(hr))
-		{
-			ELOG("Error : D3DReadFileToBlob() Failed. path = %ls", vsPath.c_str());
-			return false;
-		}
-
-		// read pixel shader
-		hr = D3DReadFileToBlob(psPath.c_str(), pPSBlob.GetAddressOf());
-		if (FAILED(hr))
+		// read shaders (each file is read once)
+		auto pVSBlob = m_PipelineCache.LoadShader(vsPath.c_str());
+		auto pPSBlob = m_PipelineCache.LoadShader(psPath.c_str());
+		if (pVSBlob == nullptr || pPSBlob == nullptr)
 		{
-			ELOG("Error : D3DReadFileToBlob() Failed. path = %ls", psPath.c_str());
 			return false;
 		}
 
@@ -482,13 +608,17 @@ bool SampleApp::OnInit()
 		desc.SampleDesc.Count = 1;
 		desc.SampleDesc.Quality = 0;
 
-		// generate pipeline state
-		hr = m_pDevice->CreateGraphicsPipelineState(&desc, IID_PPV_ARGS(m_pTonemapPSO.GetAddressOf()));
-		if (FAILED(hr))
+		// request pipeline state. the tonemap is needed to show anything, so it goes first
+		m_TonemapPipeline = m_PipelineCache.RequestGraphicsPipeline(desc, 1);
+		if (!m_TonemapPipeline.IsValid())
 		{
-			ELOG("Error : ID3D12Device::CreateGraphicsPipelineState() Failed. retcode = 0x%x", hr);
+			ELOG("Error : PipelineCache::RequestGraphicsPipeline() Failed.");
 			return false;
 		}
+
+		// start compiling
+		m_PipelineCache.Update();
+		m_IsCompiling = true;
 	}
 
 	// generate vertex buffer
@@ -569,58 +699,7 @@ bool SampleApp::OnInit()
 		m_WallVB.Unmap();
 	}
 
-	for (auto i = 0; i < FrameCount; ++i)
-	{
-		if (!m_TonemapCB[i].Init(m_pDevice.Get(), m_pPool[POOL_TYPE_RES], sizeof(CbTonemap)))
-		{
-			ELOG("Error : ConstantBuffer::Init() Failed.");
-			return false;
-		}
-	}
-
-	// generate constant buffer for transform matrix
-	{
-		for (auto i = 0u; i < FrameCount; ++i)
-		{
-			// initialize constant buffer
-			if (!m_TransformCB[i].Init(m_pDevice.Get(), m_pPool[POOL_TYPE_RES], sizeof(CbTransform)))
-			{
-				ELOG("Error : ConstantBuffer::Init() Failed.");
-				return false;
-			}
-
-			// camera settings
-			auto eyePos = Vector3(0.0f, 1.0f, 2.0f);
-			auto targetPos = Vector3::Zero;
-			auto upward = Vector3::UnitY;
-
-			// set fov and aspect
-			auto fovY = DirectX::XMConvertToRadians(37.5f);
-			auto aspect = static_cast<float>(m_Width) / static_cast<float>(m_Height);
-
-			// set transform matrix
-			auto ptr = m_TransformCB[i].GetPtr<CbTransform>();
-			ptr->View = Matrix::CreateLookAt(eyePos, targetPos, upward);
-			ptr->Proj = Matrix::CreatePerspectiveFieldOfView(fovY, aspect, 1.0f, 1000.0f);
-		}
-
-		m_RotateAngle = DirectX::XMConvertToRadians(-60.0f);
-	}
-
-	// generate buffer for mesh
-	{
-		for (auto i = 0; i < FrameCount; ++i)
-		{
-			if (!m_MeshCB[i].Init(m_pDevice.Get(), m_pPool[POOL_TYPE_RES], sizeof(CbMesh)))
-			{
-				ELOG("Error : ConstantBuffer::Init() Failed.");
-				return false;
-			}
-
-			auto ptr = m_MeshCB[i].GetPtr<CbMesh>();
-			ptr->World = Matrix::Identity;
-		}
-	}
+	m_RotateAngle = DirectX::XMConvertToRadians(-60.0f);
 
 #if 0
 	// load texture
@@ -651,13 +730,6 @@ bool SampleApp::OnInit()
 void SampleApp::OnTerm()
 {
 	m_QuadVB.Term();
-	for (auto i = 0; i < FrameCount; ++i)
-	{
-		m_TonemapCB[i].Term();
-		m_LightCB[i].Term();
-		m_CameraCB[i].Term();
-		m_TransformCB[i].Term();
-	}
 
 	// abandon mesh
 	for (size_t i = 0; i < m_pMesh.size(); ++i)
@@ -666,75 +738,118 @@ void SampleApp::OnTerm()
 	}
 	m_pMesh.clear();
 	m_pMesh.shrink_to_fit();
+	m_MeshBounds.clear();
+	m_GeometryArena.Term();
 
-	// abandon material
+	// abandon material (it releases its streamed textures)
 	m_Material.Term();
+	m_MipStreamer.Term();
 
-	for (auto i = 0; i < FrameCount; ++i)
-	{
-		m_MeshCB[i].Term();
-	}
+	m_RenderGraph.Reset();
+	m_GraphResources.clear();
 
+	// placed targets are released before their heap (App terminates m_DepthTarget again, which does nothing)
 	m_SceneColorTarget.Term();
 	m_SceneDepthTarget.Term();
+	m_DepthTarget.Term();
+	m_TransientHeap.Term();
 
-	m_pScenePSO.Reset();
-	m_SceneRootSig.Term();
+	// waits for compiles in flight and writes pipelines compiled in this run to the file
+	m_ScenePipeline = PipelineHandle();
+	m_TonemapPipeline = PipelineHandle();
+	m_PipelineCache.Term();
 
-	m_pTonemapPSO.Reset();
+	m_SceneRootSig.Term();
 	m_TonemapRootSig.Term();
 }
 
 // processing that is done on render
 void SampleApp::OnRender()
 {
-	// start recording commandlist
-	auto pCmd = m_CommandList.Reset();
+	// swap in texture mips which became resident. the old textures and descriptor tables go
+	// to the release queue, so frames in flight keep reading them
+	if (m_MipStreamer.Finish(GetCompletedValue(QUEUE_TYPE_COPY)))
+	{
+		// orders the frame after the copies. the CPU has seen them complete, so no GPU wait is issued
+		WaitQueue(QUEUE_TYPE_DIRECT, QUEUE_TYPE_COPY, m_MipStreamer.GetFenceValue());
+	}
+	m_Material.Update();
+
+	// mips are copied on the copy queue while the frame renders
+	if (m_MipStreamer.Submit())
+	{
+		auto value = SignalQueue(QUEUE_TYPE_COPY);
+		if (value == 0)
+		{
+			// the batch can not be tracked, so it is waited for here
+			ELOG("Error : App::SignalQueue() Failed.");
+			WaitForGpu();
+		}
+		m_MipStreamer.SetFenceValue(value);
+	}
+
+	// take pipeline states which finished compiling
+	m_PipelineCache.Update();
+
+	// the back buffer of the render graph changes every frame
+	m_GraphResources[m_BackBufferId] = m_ColorTarget[m_FrameIndex].GetResource();
+
+	// the frame is recorded into several commandlists, which are submitted in the order of pLists.
+	// the lists around the scene are taken first, so the scene can not use them up
+	auto pSceneCmd = m_CommandListPool.Acquire();
+	auto pCmd = m_CommandListPool.Acquire();
+	if (pSceneCmd == nullptr || pCmd == nullptr)
+	{
+		ELOG("Error : CommandListPool::Acquire() Failed.");
+
+		// an open list can not be reset in a later frame
+		if (pSceneCmd != nullptr)
+		{
+			pSceneCmd->Close();
+		}
+		if (pCmd != nullptr)
+		{
+			pCmd->Close();
+		}
+		return;
+	}
+
+	std::vector<ID3D12CommandList*> pLists;
 
 	ID3D12DescriptorHeap* const pHeaps[] = {
 		m_pPool[POOL_TYPE_RES]->GetHeap(),
 	};
 
-	pCmd->SetDescriptorHeaps(1, pHeaps);
-
 	{
+		pSceneCmd->SetDescriptorHeaps(1, pHeaps);
+
 		// get descriptor
 		auto handleRTV = m_SceneColorTarget.GetHandleRTV();
 		auto handleDSV = m_SceneDepthTarget.GetHandleDSV();
 
-		// set resource barrier for writing
-		DirectX::TransitionResource(
-			pCmd,
-			m_SceneColorTarget.GetResource(),
-			D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE,
-			D3D12_RESOURCE_STATE_RENDER_TARGET);
+		// set resource barriers of scene pass
+		RecordBarriers(pSceneCmd, m_RenderGraph.GetBarriers(m_ScenePass), m_GraphResources.data());
 
 		// set render target
-		pCmd->OMSetRenderTargets(1, &handleRTV->HandleCPU, FALSE, &handleDSV->HandleCPU);
+		pSceneCmd->OMSetRenderTargets(1, &handleRTV->HandleCPU, FALSE, &handleDSV->HandleCPU);
 
-		// clear render target
-		m_SceneColorTarget.ClearView(pCmd);
-		m_SceneColorTarget.ClearView(pCmd);
+		// clear render target and depth target
+		m_SceneColorTarget.ClearView(pSceneCmd);
+		m_SceneDepthTarget.ClearView(pSceneCmd);
 
-		// draw scene
-		DrawScene(pCmd);
+		pSceneCmd->Close();
+		pLists.push_back(pSceneCmd);
 
-		// set resource barrier for writing
-		DirectX::TransitionResource(
-			pCmd,
-			m_SceneColorTarget.GetResource(),
-			D3D12_RESOURCE_STATE_RENDER_TARGET,
-			D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+		// draw scene on worker threads
+		DrawScene(pLists);
 	}
 
+	pCmd->SetDescriptorHeaps(1, pHeaps);
+
 	// draw in frame buffer
 	{
-		// resource barrier for writing
-		DirectX::TransitionResource(
-			pCmd,
-			m_ColorTarget[m_FrameIndex].GetResource(),
-			D3D12_RESOURCE_STATE_PRESENT,
-			D3D12_RESOURCE_STATE_RENDER_TARGET);
+		// set resource barriers of tonemap pass (scene for reading, frame buffer for writing)
+		RecordBarriers(pCmd, m_RenderGraph.GetBarriers(m_TonemapPass), m_GraphResources.data());
 
 		// get descriptor
 		auto handleRTV = m_ColorTarget[m_FrameIndex].GetHandleRTV();
@@ -750,95 +865,393 @@ void SampleApp::OnRender()
 		// apply tonemap
 		DrawTonemap(pCmd);
 
-		// settings of resource barrier fo writing
-		DirectX::TransitionResource(
-			pCmd,
-			m_ColorTarget[m_FrameIndex].GetResource(),
-			D3D12_RESOURCE_STATE_RENDER_TARGET,
-			D3D12_RESOURCE_STATE_PRESENT);
+		// return resources to their states between frames (frame buffer for presenting)
+		RecordBarriers(pCmd, m_RenderGraph.GetFinalBarriers(), m_GraphResources.data());
 	}
 
 	// finish recording commandlist
 	pCmd->Close();
+	pLists.push_back(pCmd);
 
-	// execute commandlist
-	ID3D12CommandList* pLists[] = { pCmd };
-	m_pQueue->ExecuteCommandLists(1, pLists);
+	// execute commandlists in one call
+	m_pQueue->ExecuteCommandLists(UINT(pLists.size()), pLists.data());
 
 	// show on screen
 	Present(1);
+
+	// report how long startup, compiling and streaming took
+	if (m_IsFirstFrame || m_IsCompiling || m_IsStreaming)
+	{
+		auto elapsed = std::chrono::duration<double, std::milli>(
+			std::chrono::steady_clock::now() - m_InitTime).count();
+
+		if (m_IsFirstFrame)
+		{
+			DLOG("Info : time to first frame %f msec.", elapsed);
+			m_IsFirstFrame = false;
+		}
+
+		if (m_IsCompiling && m_PipelineCache.IsIdle())
+		{
+			DLOG("Info : pipelines ready after %f msec. %zu pipelines, %zu loaded from the pipeline library.",
+				elapsed,
+				m_PipelineCache.GetPipelineCount(),
+				m_PipelineCache.GetLibraryHitCount());
+			m_IsCompiling = false;
+		}
+
+		if (m_IsStreaming && m_MipStreamer.IsIdle())
+		{
+			DLOG("Info : texture mips settled after %f msec. %llu / %llu bytes resident.",
+				elapsed,
+				static_cast<unsigned long long>(m_MipStreamer.GetUsedBytes()),
+				static_cast<unsigned long long>(m_MipStreamer.GetBudget()));
+			m_IsStreaming = false;
+		}
+	}
+}
+
+// declare passes of a frame and compile their barriers
+bool SampleApp::BuildRenderGraph()
+{
+	m_RenderGraph.Reset();
+
+	auto depthDesc = m_DepthTarget.GetDesc();
+	auto sceneColorInfo = ColorTarget::GetAllocationInfo(m_pDevice.Get(), m_Width, m_Height, SceneColorFormat);
+	auto sceneDepthInfo = DepthTarget::GetAllocationInfo(m_pDevice.Get(), m_Width, m_Height, SceneDepthFormat);
+	auto depthInfo = DepthTarget::GetAllocationInfo(
+		m_pDevice.Get(),
+		uint32_t(depthDesc.Width),
+		depthDesc.Height,
+		m_DepthTarget.GetDSVDesc().Format);
+
+	RenderGraph::ResourceDesc desc = {};
+
+	// targets used only in the frame share the transient heap. they keep the state which they are left in after a frame
+	desc.IsTransient = true;
+	desc.Usage = RESOURCE_USAGE_PIXEL_SHADER;
+	desc.Size = sceneColorInfo.SizeInBytes;
+	desc.Alignment = sceneColorInfo.Alignment;
+	m_SceneColorId = m_RenderGraph.AddResource("SceneColor", desc);
+
+	desc.Usage = RESOURCE_USAGE_DEPTH_WRITE;
+	desc.Size = sceneDepthInfo.SizeInBytes;
+	desc.Alignment = sceneDepthInfo.Alignment;
+	m_SceneDepthId = m_RenderGraph.AddResource("SceneDepth", desc);
+
+	desc.Size = depthInfo.SizeInBytes;
+	desc.Alignment = depthInfo.Alignment;
+	m_DepthId = m_RenderGraph.AddResource("Depth", desc);
+
+	desc = RenderGraph::ResourceDesc();
+	desc.Usage = RESOURCE_USAGE_PRESENT;
+	desc.IsOutput = true;
+	m_BackBufferId = m_RenderGraph.AddResource("BackBuffer", desc);
+
+	if (m_SceneColorId == RenderGraph::InvalidId
+		|| m_SceneDepthId == RenderGraph::InvalidId
+		|| m_DepthId == RenderGraph::InvalidId)
+	{
+		return false;
+	}
+
+	// scene pass
+	m_ScenePass = m_RenderGraph.AddPass("Scene");
+	m_RenderGraph.Write(m_ScenePass, m_SceneColorId, RESOURCE_USAGE_RENDER_TARGET);
+	m_RenderGraph.Write(m_ScenePass, m_SceneDepthId, RESOURCE_USAGE_DEPTH_WRITE);
+
+	// tonemap pass
+	m_TonemapPass = m_RenderGraph.AddPass("Tonemap");
+	m_RenderGraph.Read(m_TonemapPass, m_SceneColorId, RESOURCE_USAGE_PIXEL_SHADER);
+	m_RenderGraph.Write(m_TonemapPass, m_BackBufferId, RESOURCE_USAGE_RENDER_TARGET);
+	m_RenderGraph.Write(m_TonemapPass, m_DepthId, RESOURCE_USAGE_DEPTH_WRITE);
+
+	if (!m_RenderGraph.Compile())
+	{
+		ELOG("Error : RenderGraph::Compile() Failed.");
+		return false;
+	}
+
+	// the commandlists of OnRender() are laid out for these passes
+	if (m_RenderGraph.IsCulled(m_ScenePass) || m_RenderGraph.IsCulled(m_TonemapPass))
+	{
+		ELOG("Error : Pass of the frame has been culled.");
+		return false;
+	}
+
+	DLOG("Info : transient targets take %llu bytes in a shared heap, %llu bytes saved.",
+		static_cast<unsigned long long>(m_RenderGraph.GetHeapSize()),
+		static_cast<unsigned long long>(m_RenderGraph.GetUnaliasedSize() - m_RenderGraph.GetHeapSize()));
+
+	return true;
+}
+
+// place render targets of the passes in shared memory
+bool SampleApp::InitTransientTargets()
+{
+	if (!m_TransientHeap.Init(m_pDevice.Get(), m_RenderGraph.GetHeapSize()))
+	{
+		ELOG("Error : TransientHeap::Init() Failed.");
+		return false;
+	}
+
+	RenderGraph::Placement place;
+
+	// generate color target for scene
+	{
+		float clearColor[4] = { 0.2f, 0.2f, 0.2f, 1.0f };
+		if (!m_RenderGraph.GetPlacement(m_SceneColorId, place)
+			|| !m_SceneColorTarget.Init(
+				m_pDevice.Get(),
+				m_pPool[POOL_TYPE_RTV],
+				m_pPool[POOL_TYPE_RES],
+				m_Width,
+				m_Height,
+				SceneColorFormat,
+				clearColor,
+				m_TransientHeap.GetHeap(),
+				place.Offset,
+				D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE))
+		{
+			ELOG("Error : ColorTarget::Init() Failed.");
+			return false;
+		}
+	}
+
+	// generate depth target for scene
+	{
+		if (!m_RenderGraph.GetPlacement(m_SceneDepthId, place)
+			|| !m_SceneDepthTarget.Init(
+				m_pDevice.Get(),
+				m_pPool[POOL_TYPE_DSV],
+				nullptr,
+				m_Width,
+				m_Height,
+				SceneDepthFormat,
+				1.0f,
+				0,
+				m_TransientHeap.GetHeap(),
+				place.Offset,
+				D3D12_RESOURCE_STATE_DEPTH_WRITE))
+		{
+			ELOG("Error : DepthTarget::Init() Failed.");
+			return false;
+		}
+	}
+
+	// generate depth target for frame buffer again, in the heap (it shares memory with the scene depth)
+	{
+		auto desc = m_DepthTarget.GetDesc();
+		auto format = m_DepthTarget.GetDSVDesc().Format;
+		m_DepthTarget.Term();
+
+		if (!m_RenderGraph.GetPlacement(m_DepthId, place)
+			|| !m_DepthTarget.Init(
+				m_pDevice.Get(),
+				m_pPool[POOL_TYPE_DSV],
+				nullptr,
+				uint32_t(desc.Width),
+				desc.Height,
+				format,
+				1.0f,
+				0,
+				m_TransientHeap.GetHeap(),
+				place.Offset,
+				D3D12_RESOURCE_STATE_DEPTH_WRITE))
+		{
+			ELOG("Error : DepthTarget::Init() Failed.");
+			return false;
+		}
+	}
+
+	m_GraphResources.resize(m_RenderGraph.GetResourceCount());
+	m_GraphResources[m_SceneColorId] = m_SceneColorTarget.GetResource();
+	m_GraphResources[m_SceneDepthId] = m_SceneDepthTarget.GetResource();
+	m_GraphResources[m_DepthId] = m_DepthTarget.GetResource();
+	m_GraphResources[m_BackBufferId] = nullptr;
+
+	return true;
 }
 
 // draw scene
-void SampleApp::DrawScene(ID3D12GraphicsCommandList* pCmd)
+void SampleApp::DrawScene(std::vector<ID3D12CommandList*>& pLists)
 {
+	// skip the scene until its pipeline state has been compiled
+	auto pPipeline = m_ScenePipeline.Get();
+	if (pPipeline == nullptr)
+	{
+		return;
+	}
+
 	auto cameraPos = Vector3(-4.0f, 1.0f, 2.5f);
+	auto fovY = DirectX::XMConvertToRadians(37.5f);
 
 	auto currTime = std::chrono::system_clock::now();
 	auto dt = float(std::chrono::duration_cast<std::chrono::milliseconds>(currTime - m_StartTime).count()) / 1000.0f;
 	auto lightColor = CalcLightColor(dt * 0.25f);
 
 	// update light buffer
+	CbLight light;
 	{
 		auto matrix = Matrix::CreateRotationY(m_RotateAngle);
 		auto pos = Vector3::Transform(Vector3(0.0f, 0.25f, 0.75f), matrix);
 
-		auto ptr = m_LightCB[m_FrameIndex].GetPtr<CbLight>();
-		*ptr = ComputePointLight(pos, 2.0f, lightColor, 100.0f);
+		light = ComputePointLight(pos, 2.0f, lightColor, 100.0f);
 
 		m_RotateAngle += 0.025f;
 	}
 
 	// update camera buffer
+	CbCamera camera = {};
 	{
-		auto ptr = m_CameraCB[m_FrameIndex].GetPtr<CbCamera>();
-		ptr->CameraPosition = cameraPos;
+		camera.CameraPosition = cameraPos;
 	}
 
-	// update world matrix of mesh
+	// update transform parameters
+	CbTransform transform = {};
 	{
-		auto ptr = m_MeshCB[m_FrameIndex].GetPtr<CbMesh>();
-		ptr->World = Matrix::Identity;
+		auto aspect = static_cast<float>(m_Width) / static_cast<float>(m_Height);
+
+		transform.View = Matrix::CreateLookAt(cameraPos, Vector3(0.0f, 0.0f, 0.0f), Vector3(0.0f, 1.0f, 0.0f));
+		transform.Proj = Matrix::CreatePerspectiveFieldOfView(fovY, aspect, 1.0f, 1000.0f);
 	}
 
-	// update transform parameters
+	// mips requested now are brought in by the next update
+	RequestTextureMips(cameraPos, fovY);
+
+	// write constant buffers of this frame to the upload allocator
+	auto handleTransform = CreateTransientCBV(m_UploadAllocator.Push(transform));
+	auto handleLight = CreateTransientCBV(m_UploadAllocator.Push(light));
+	auto handleCamera = CreateTransientCBV(m_UploadAllocator.Push(camera));
+	if (handleTransform.ptr == 0 || handleLight.ptr == 0 || handleCamera.ptr == 0)
 	{
-		auto fovY = DirectX::XMConvertToRadians(37.5f);
-		auto aspect = static_cast<float>(m_Width) / static_cast<float>(m_Height);
+		return;
+	}
 
-		auto ptr = m_TransformCB[m_FrameIndex].GetPtr<CbTransform>();
-		ptr->View = Matrix::CreateLookAt(cameraPos, Vector3(0.0f, 0.0f, 0.0f), Vector3(0.0f, 1.0f, 0.0f));
-		ptr->Proj = Matrix::CreatePerspectiveFieldOfView(fovY, aspect, 1.0f, 1000.0f);
+	// update world matrix and dequantization of each mesh here, as the upload allocator is not thread safe
+	m_MeshAddress.resize(m_pMesh.size());
+	for (size_t i = 0; i < m_pMesh.size(); ++i)
+	{
+		CbMesh mesh = {};
+		{
+			const auto& quantization = m_pMesh[i]->GetQuantization();
+			mesh.World = Matrix::Identity;
+			mesh.PositionOffset = Vector4(quantization.Offset.x, quantization.Offset.y, quantization.Offset.z, 0.0f);
+			mesh.PositionScale = Vector4(quantization.Scale.x, quantization.Scale.y, quantization.Scale.z, 0.0f);
+		}
+
+		auto allocMesh = m_UploadAllocator.Push(mesh);
+		m_MeshAddress[i] = allocMesh.IsValid() ? allocMesh.AddressGPU : 0;
 	}
 
-	pCmd->SetGraphicsRootSignature(m_SceneRootSig.GetPtr());
-	pCmd->SetGraphicsRootDescriptorTable(0, m_TransformCB[m_FrameIndex].GetHandleGPU());
-	pCmd->SetGraphicsRootDescriptorTable(2, m_LightCB[m_FrameIndex].GetHandleGPU());
-	pCmd->SetGraphicsRootDescriptorTable(3, m_CameraCB[m_FrameIndex].GetHandleGPU());
-	pCmd->SetPipelineState(m_pScenePSO.Get());
-	pCmd->RSSetViewports(1, &m_Viewport);
-	pCmd->RSSetScissorRects(1, &m_Scissor);
+	// the material table of this frame, as textures may have been swapped since the last one
+	D3D12_GPU_VIRTUAL_ADDRESS addressMaterials = 0;
+	if (m_IsBindless)
+	{
+		addressMaterials = m_Material.PushIndexTable(m_UploadAllocator);
+		if (addressMaterials == 0)
+		{
+			return;
+		}
+	}
+
+	// split meshes across the commandlists left in the pool
+	auto drawCount = uint32_t(m_pMesh.size());
+	auto listCount = GetRecordingListCount(
+		drawCount,
+		m_CommandListPool.GetListCount() - m_CommandListPool.GetAcquiredCount(),
+		MinDrawsPerList);
+
+	std::vector<ID3D12GraphicsCommandList*> pSceneLists(listCount, nullptr);
+
+	m_ThreadPool.ParallelFor(listCount, [&](size_t i)
+	{
+		auto pCmd = m_CommandListPool.Acquire();
+		if (pCmd == nullptr)
+		{
+			return;
+		}
+
+		// a commandlist inherits no state, so every list sets up the scene pass
+		ID3D12DescriptorHeap* const pHeaps[] = {
+			m_pPool[POOL_TYPE_RES]->GetHeap(),
+		};
+
+		auto handleRTV = m_SceneColorTarget.GetHandleRTV();
+		auto handleDSV = m_SceneDepthTarget.GetHandleDSV();
+
+		pCmd->SetDescriptorHeaps(1, pHeaps);
+		pCmd->OMSetRenderTargets(1, &handleRTV->HandleCPU, FALSE, &handleDSV->HandleCPU);
+		pCmd->SetGraphicsRootSignature(m_SceneRootSig.GetPtr());
+		pCmd->SetGraphicsRootDescriptorTable(0, handleTransform);
+		pCmd->SetGraphicsRootDescriptorTable(2, handleLight);
+		pCmd->SetGraphicsRootDescriptorTable(3, handleCamera);
+		if (m_IsBindless)
+		{
+			// material table and the whole heap are bound once for every mesh
+			pCmd->SetGraphicsRootShaderResourceView(4, addressMaterials);
+			pCmd->SetGraphicsRootDescriptorTable(5, m_pPool[POOL_TYPE_RES]->GetHeap()->GetGPUDescriptorHandleForHeapStart());
+		}
+		pCmd->SetPipelineState(pPipeline);
+		pCmd->RSSetViewports(1, &m_Viewport);
+		pCmd->RSSetScissorRects(1, &m_Scissor);
+
+		// draw object
+		DrawMesh(
+			pCmd,
+			GetRecordingBegin(drawCount, listCount, uint32_t(i)),
+			GetRecordingBegin(drawCount, listCount, uint32_t(i + 1)));
 
-	// draw object
+		pCmd->Close();
+		pSceneLists[i] = pCmd;
+	});
+
+	// submit in mesh order, whichever thread recorded each list
+	for (size_t i = 0; i < pSceneLists.size(); ++i)
 	{
-		pCmd->SetGraphicsRootDescriptorTable(1, m_MeshCB[m_FrameIndex].GetHandleGPU());
-		DrawMesh(pCmd);
+		if (pSceneLists[i] != nullptr)
+		{
+			pLists.push_back(pSceneLists[i]);
+		}
 	}
 }
 
 // draw mesh
-void SampleApp::DrawMesh(ID3D12GraphicsCommandList* pCmd)
+void SampleApp::DrawMesh(ID3D12GraphicsCommandList* pCmd, size_t begin, size_t end)
 {
-	for (size_t i = 0; i < m_pMesh.size(); ++i)
+	// bind geometry of every mesh at once
+	auto indexFormat = DXGI_FORMAT_R16_UINT;
+	m_GeometryArena.Bind(pCmd, indexFormat);
+
+	for (size_t i = begin; i < end; ++i)
 	{
+		// switch index buffer only when the format changes
+		if (m_pMesh[i]->GetIndexFormat() != indexFormat)
+		{
+			indexFormat = m_pMesh[i]->GetIndexFormat();
+			m_GeometryArena.BindIndexBuffer(pCmd, indexFormat);
+		}
+
+		// constant buffer written by DrawScene()
+		if (m_MeshAddress[i] == 0)
+		{
+			continue;
+		}
+
+		pCmd->SetGraphicsRootConstantBufferView(1, m_MeshAddress[i]);
+
 		// get material ID
 		auto id = m_pMesh[i]->GetMaterialId();
 
-		// set texture
-		pCmd->SetGraphicsRootDescriptorTable(4, m_Material.GetTextureHandle(id, TU_BASE_COLOR));
-		pCmd->SetGraphicsRootDescriptorTable(5, m_Material.GetTextureHandle(id, TU_METALLIC));
-		pCmd->SetGraphicsRootDescriptorTable(6, m_Material.GetTextureHandle(id, TU_ROUGHNESS));
-		pCmd->SetGraphicsRootDescriptorTable(7, m_Material.GetTextureHandle(id, TU_NORMAL));
+		// select material
+		if (m_IsBindless)
+		{
+			pCmd->SetGraphicsRoot32BitConstant(6, UINT(id), 0);
+		}
+		else
+		{
+			pCmd->SetGraphicsRootDescriptorTable(4, m_Material.GetTableHandle(id));
+		}
 
 		// draw mesh
 		m_pMesh[i]->Draw(pCmd);
@@ -848,20 +1261,33 @@ void SampleApp::DrawMesh(ID3D12GraphicsCommandList* pCmd)
 // apply tonemap
 void SampleApp::DrawTonemap(ID3D12GraphicsCommandList* pCmd)
 {
+	// skip the tonemap until its pipeline state has been compiled
+	auto pPipeline = m_TonemapPipeline.Get();
+	if (pPipeline == nullptr)
+	{
+		return;
+	}
+
 	// update constant buffer
+	CbTonemap tonemap = {};
 	{
-		auto ptr = m_TonemapCB[m_FrameIndex].GetPtr<CbTonemap>();
-		ptr->Type = m_TonemapType;
-		ptr->ColorSpace = m_ColorSpace;
-		ptr->BaseLuminance = m_BaseLuminance;
-		ptr->MaxLuminance = m_MaxLuminance;
+		tonemap.Type = m_TonemapType;
+		tonemap.ColorSpace = m_ColorSpace;
+		tonemap.BaseLuminance = m_BaseLuminance;
+		tonemap.MaxLuminance = m_MaxLuminance;
+	}
+
+	auto handleTonemap = CreateTransientCBV(m_UploadAllocator.Push(tonemap));
+	if (handleTonemap.ptr == 0)
+	{
+		return;
 	}
 
 	pCmd->SetGraphicsRootSignature(m_TonemapRootSig.GetPtr());
-	pCmd->SetGraphicsRootDescriptorTable(0, m_TonemapCB[m_FrameIndex].GetHandleGPU());
+	pCmd->SetGraphicsRootDescriptorTable(0, handleTonemap);
 	pCmd->SetGraphicsRootDescriptorTable(1, m_SceneColorTarget.GetHandleSRV()->HandleGPU);
 
-	pCmd->SetPipelineState(m_pTonemapPSO.Get());
+	pCmd->SetPipelineState(pPipeline);
 	pCmd->RSSetViewports(1, &m_Viewport);
 	pCmd->RSSetScissorRects(1, &m_Scissor);
 
@@ -1070,4 +1496,20 @@ void SampleApp::OnMsgProc(HWND hWnd, UINT msg, WPARAM wp, LPARAM lp)
 			}
 		}
 	}
+}
+
+// request texture mips by the size of each mesh on screen
+void SampleApp::RequestTextureMips(const DirectX::XMFLOAT3& cameraPos, float fovY)
+{
+	for (size_t i = 0; i < m_pMesh.size(); ++i)
+	{
+		const auto& bounds = m_MeshBounds[i];
+		auto center = Vector3(bounds.x, bounds.y, bounds.z);
+
+		// the nearest point of the sphere, but not nearer than the near plane
+		auto distance = std::max(Vector3::Distance(center, Vector3(cameraPos)) - bounds.w, 1.0f);
+		auto screenSize = ComputeScreenSize(bounds.w * 2.0f, distance, fovY, float(m_Height));
+
+		m_Material.RequestMips(m_pMesh[i]->GetMaterialId(), screenSize);
+	}
 }
\ No newline at end of file
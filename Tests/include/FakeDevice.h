@@ -0,0 +1,669 @@
+#pragma once
+
+#include <d3d12.h>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+//
+// Fakes of D3D12 objects for the host tests
+//
+// They keep COM reference counts and enough state for the Framework classes to run: a
+// descriptor heap hands out handles, buffers are backed by CPU memory and a fence completes
+// whatever value the test sets. A queue runs the buffer copies of a commandlist at once and
+// completes what it signals. Nothing is drawn.
+//
+
+namespace Fake {
+	//! @brief get count of fake objects alive
+	inline std::atomic<int>& LiveCount()
+	{
+		static std::atomic<int> count(0);
+		return count;
+	}
+
+	//
+	// Object class
+	//
+	// Reference counting of a fake interface.
+	//
+	template<typename T>
+	class Object : public T
+	{
+	public:
+		Object()
+			: m_RefCount(1)
+		{
+			LiveCount()++;
+		}
+
+		virtual ~Object()
+		{
+			LiveCount()--;
+		}
+
+		unsigned long AddRef() override
+		{
+			return ++m_RefCount;
+		}
+
+		unsigned long Release() override
+		{
+			auto count = --m_RefCount;
+			if (count == 0)
+			{
+				delete this;
+			}
+			return count;
+		}
+
+		unsigned long GetRefCount() const
+		{
+			return m_RefCount;
+		}
+
+	private:
+		std::atomic<unsigned long> m_RefCount;
+	};
+
+	//
+	// Unknown class
+	//
+	// Object which only counts references, to check when a queue releases it.
+	//
+	class Unknown : public Object<IUnknown>
+	{
+	};
+
+	//
+	// DescriptorHeap class
+	//
+	class DescriptorHeap : public Object<ID3D12DescriptorHeap>
+	{
+	public:
+		static const SIZE_T CpuBase = 0x10000; //!< CPU handle of the first descriptor
+		static const UINT64 GpuBase = 0x80000000; //!< GPU handle of the first descriptor
+
+		explicit DescriptorHeap(const D3D12_DESCRIPTOR_HEAP_DESC& desc)
+			: m_Desc(desc)
+		{
+		}
+
+		D3D12_DESCRIPTOR_HEAP_DESC GetDesc() override
+		{
+			return m_Desc;
+		}
+
+		D3D12_CPU_DESCRIPTOR_HANDLE GetCPUDescriptorHandleForHeapStart() override
+		{
+			D3D12_CPU_DESCRIPTOR_HANDLE handle = { CpuBase };
+			return handle;
+		}
+
+		D3D12_GPU_DESCRIPTOR_HANDLE GetGPUDescriptorHandleForHeapStart() override
+		{
+			D3D12_GPU_DESCRIPTOR_HANDLE handle = {};
+			if (m_Desc.Flags & D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE)
+			{
+				handle.ptr = GpuBase;
+			}
+			return handle;
+		}
+
+	private:
+		D3D12_DESCRIPTOR_HEAP_DESC m_Desc;
+	};
+
+	//
+	// Resource class
+	//
+	// Buffers are backed by CPU memory, which Map() returns and whose address is the GPU address.
+	// The memory is aligned for constant buffers, as the start of a real buffer is.
+	//
+	class Resource : public Object<ID3D12Resource>
+	{
+	public:
+		explicit Resource(const D3D12_RESOURCE_DESC& desc)
+			: m_Desc(desc)
+			, m_pData(nullptr)
+			, m_Size(0)
+			, m_MapCount(0)
+		{
+			if (desc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER && desc.Width > 0)
+			{
+				const size_t align = D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT;
+				m_Memory.resize(size_t(desc.Width) + align - 1, 0);
+
+				auto address = reinterpret_cast<uintptr_t>(m_Memory.data());
+				m_pData = reinterpret_cast<uint8_t*>((address + align - 1) & ~uintptr_t(align - 1));
+				m_Size = size_t(desc.Width);
+			}
+		}
+
+		D3D12_RESOURCE_DESC GetDesc() override
+		{
+			return m_Desc;
+		}
+
+		HRESULT Map(UINT, const D3D12_RANGE*, void** ppData) override
+		{
+			if (m_pData == nullptr)
+			{
+				return E_FAIL;
+			}
+
+			m_MapCount++;
+			if (ppData != nullptr)
+			{
+				*ppData = m_pData;
+			}
+			return S_OK;
+		}
+
+		void Unmap(UINT, const D3D12_RANGE*) override
+		{
+			m_MapCount--;
+		}
+
+		D3D12_GPU_VIRTUAL_ADDRESS GetGPUVirtualAddress() override
+		{
+			return D3D12_GPU_VIRTUAL_ADDRESS(reinterpret_cast<uintptr_t>(m_pData));
+		}
+
+		size_t GetSize() const
+		{
+			return m_Size;
+		}
+
+		uint8_t* GetData()
+		{
+			return m_pData;
+		}
+
+		int GetMapCount() const
+		{
+			return m_MapCount;
+		}
+
+	private:
+		D3D12_RESOURCE_DESC m_Desc;
+		std::vector<uint8_t> m_Memory;
+		uint8_t* m_pData;
+		size_t m_Size;
+		int m_MapCount;
+	};
+
+	//
+	// Fence class
+	//
+	// Completes the value the test sets with SetCompletedValue().
+	//
+	class Fence : public Object<ID3D12Fence>
+	{
+	public:
+		explicit Fence(UINT64 value)
+			: m_Completed(value)
+		{
+		}
+
+		UINT64 GetCompletedValue() override
+		{
+			return m_Completed;
+		}
+
+		HRESULT Signal(UINT64 value) override
+		{
+			m_Completed = value;
+			return S_OK;
+		}
+
+		HRESULT SetEventOnCompletion(UINT64, HANDLE) override
+		{
+			return S_OK;
+		}
+
+		void SetCompletedValue(UINT64 value)
+		{
+			m_Completed = value;
+		}
+
+	private:
+		std::atomic<UINT64> m_Completed;
+	};
+
+	//
+	// CommandAllocator class
+	//
+	class CommandAllocator : public Object<ID3D12CommandAllocator>
+	{
+	public:
+		HRESULT Reset() override
+		{
+			return S_OK;
+		}
+	};
+
+	//
+	// CommandList class
+	//
+	// Records buffer copies, which CommandQueue runs on the memory of the resources.
+	//
+	class CommandList : public Object<ID3D12GraphicsCommandList>
+	{
+	public:
+		//
+		// Copy structure
+		//
+		struct Copy
+		{
+			ID3D12Resource* pDst;
+			UINT64 DstOffset;
+			ID3D12Resource* pSrc;
+			UINT64 SrcOffset;
+			UINT64 Size;
+		};
+
+		CommandList()
+			: m_IsOpen(true)
+			, m_BarrierCount(0)
+		{
+		}
+
+		HRESULT Close() override
+		{
+			if (!m_IsOpen)
+			{
+				return E_FAIL;
+			}
+
+			m_IsOpen = false;
+			return S_OK;
+		}
+
+		HRESULT Reset(ID3D12CommandAllocator*, ID3D12PipelineState*) override
+		{
+			if (m_IsOpen)
+			{
+				return E_FAIL;
+			}
+
+			m_IsOpen = true;
+			m_Copies.clear();
+			m_BarrierCount = 0;
+			return S_OK;
+		}
+
+		void CopyBufferRegion(ID3D12Resource* pDst, UINT64 dstOffset, ID3D12Resource* pSrc, UINT64 srcOffset, UINT64 size) override
+		{
+			Copy copy = { pDst, dstOffset, pSrc, srcOffset, size };
+			m_Copies.push_back(copy);
+		}
+
+		void ResourceBarrier(UINT count, const D3D12_RESOURCE_BARRIER*) override
+		{
+			m_BarrierCount += count;
+		}
+
+		const std::vector<Copy>& GetCopies() const
+		{
+			return m_Copies;
+		}
+
+		bool IsOpen() const
+		{
+			return m_IsOpen;
+		}
+
+	private:
+		std::vector<Copy> m_Copies;
+		bool m_IsOpen;
+		UINT m_BarrierCount;
+	};
+
+	//
+	// CommandQueue class
+	//
+	class CommandQueue : public Object<ID3D12CommandQueue>
+	{
+	public:
+		explicit CommandQueue(D3D12_COMMAND_LIST_TYPE type)
+			: m_Type(type)
+			, m_CopyCount(0)
+		{
+		}
+
+		void ExecuteCommandLists(UINT count, ID3D12CommandList* const* ppLists) override
+		{
+			for (UINT i = 0; i < count; ++i)
+			{
+				auto pList = static_cast<CommandList*>(ppLists[i]);
+				for (auto& copy : pList->GetCopies())
+				{
+					auto pDst = static_cast<Resource*>(copy.pDst);
+					auto pSrc = static_cast<Resource*>(copy.pSrc);
+					if (copy.DstOffset + copy.Size <= pDst->GetSize()
+					 && copy.SrcOffset + copy.Size <= pSrc->GetSize())
+					{
+						memcpy(pDst->GetData() + copy.DstOffset, pSrc->GetData() + copy.SrcOffset, size_t(copy.Size));
+					}
+					m_CopyCount++;
+				}
+			}
+		}
+
+		HRESULT Signal(ID3D12Fence* pFence, UINT64 value) override
+		{
+			return pFence->Signal(value);
+		}
+
+		HRESULT Wait(ID3D12Fence*, UINT64) override
+		{
+			return S_OK;
+		}
+
+		D3D12_COMMAND_QUEUE_DESC GetDesc() override
+		{
+			D3D12_COMMAND_QUEUE_DESC desc = {};
+			desc.Type = m_Type;
+			return desc;
+		}
+
+		//! @brief get count of copies run
+		int GetCopyCount() const
+		{
+			return m_CopyCount;
+		}
+
+	private:
+		D3D12_COMMAND_LIST_TYPE m_Type;
+		int m_CopyCount;
+	};
+
+	//
+	// RootSignature class
+	//
+	class RootSignature : public Object<ID3D12RootSignature>
+	{
+	};
+
+	//
+	// PipelineState class
+	//
+	class PipelineState : public Object<ID3D12PipelineState>
+	{
+	};
+
+	//
+	// PipelineLibrary class
+	//
+	// Keeps the names of stored pipelines, which is all its serialized data holds. Loading a
+	// stored name creates a new pipeline state, as a driver does without compiling.
+	//
+	class PipelineLibrary : public Object<ID3D12PipelineLibrary>
+	{
+	public:
+		static const size_t MagicSize = 8; //!< size of the start of the serialized data
+
+		//! @brief restore a library from serialized data
+		bool Init(const void* pData, size_t size)
+		{
+			if (size == 0)
+			{
+				return true;
+			}
+			if (size < MagicSize || memcmp(pData, GetMagic(), MagicSize) != 0)
+			{
+				return false;
+			}
+
+			auto ptr = static_cast<const char*>(pData) + MagicSize;
+			auto end = static_cast<const char*>(pData) + size;
+			while (ptr < end)
+			{
+				auto length = strnlen(ptr, size_t(end - ptr));
+				m_Names.insert(std::wstring(ptr, ptr + length));
+				ptr += length + 1;
+			}
+			return true;
+		}
+
+		HRESULT StorePipeline(LPCWSTR name, ID3D12PipelineState* pPipeline) override
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			if (name == nullptr || pPipeline == nullptr || !m_Names.insert(name).second)
+			{
+				return E_INVALIDARG;
+			}
+			return S_OK;
+		}
+
+		HRESULT LoadGraphicsPipeline(LPCWSTR name, const D3D12_GRAPHICS_PIPELINE_STATE_DESC*, REFIID, void** ppPipeline) override
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			if (m_Names.find(name) == m_Names.end())
+			{
+				return E_INVALIDARG;
+			}
+
+			*ppPipeline = static_cast<ID3D12PipelineState*>(new PipelineState());
+			return S_OK;
+		}
+
+		SIZE_T GetSerializedSize() override
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			auto size = MagicSize;
+			for (const auto& name : m_Names)
+			{
+				size += name.size() + 1;
+			}
+			return size;
+		}
+
+		HRESULT Serialize(void* pData, SIZE_T size) override
+		{
+			if (size != GetSerializedSize())
+			{
+				return E_INVALIDARG;
+			}
+
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			auto ptr = static_cast<char*>(pData);
+			memcpy(ptr, GetMagic(), MagicSize);
+			ptr += MagicSize;
+			for (const auto& name : m_Names)
+			{
+				for (auto c : name)
+				{
+					*ptr++ = char(c);
+				}
+				*ptr++ = '\0';
+			}
+			return S_OK;
+		}
+
+		static const char* GetMagic()
+		{
+			return "FAKEPSOL";
+		}
+
+	private:
+		std::set<std::wstring> m_Names;
+		std::mutex m_Mutex;
+	};
+
+	//
+	// Device class
+	//
+	class Device : public Object<ID3D12Device1>
+	{
+	public:
+		static const UINT DescriptorSize = 32; //!< descriptor handle increment size
+
+		Device()
+			: m_ViewCount(0)
+			, m_ResourceCount(0)
+			, m_FailResources(false)
+			, m_RootSignatureCount(0)
+			, m_PipelineCount(0)
+			, m_IsLibrarySupported(false)
+		{
+		}
+
+		HRESULT QueryInterface(REFIID, void** ppObject) override
+		{
+			// only ID3D12Device1 is asked for
+			if (!m_IsLibrarySupported)
+			{
+				return E_NOTIMPL;
+			}
+
+			AddRef();
+			*ppObject = static_cast<ID3D12Device1*>(this);
+			return S_OK;
+		}
+
+		HRESULT CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE, REFIID, void** ppAllocator) override
+		{
+			*ppAllocator = static_cast<ID3D12CommandAllocator*>(new CommandAllocator());
+			return S_OK;
+		}
+
+		HRESULT CreateCommandList(UINT, D3D12_COMMAND_LIST_TYPE, ID3D12CommandAllocator*, ID3D12PipelineState*, REFIID, void** ppList) override
+		{
+			*ppList = static_cast<ID3D12GraphicsCommandList*>(new CommandList());
+			return S_OK;
+		}
+
+		HRESULT CreateDescriptorHeap(const D3D12_DESCRIPTOR_HEAP_DESC* pDesc, REFIID, void** ppHeap) override
+		{
+			*ppHeap = static_cast<ID3D12DescriptorHeap*>(new DescriptorHeap(*pDesc));
+			return S_OK;
+		}
+
+		UINT GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE) override
+		{
+			return DescriptorSize;
+		}
+
+		void CreateConstantBufferView(const D3D12_CONSTANT_BUFFER_VIEW_DESC*, D3D12_CPU_DESCRIPTOR_HANDLE) override
+		{
+			m_ViewCount++;
+		}
+
+		void CreateShaderResourceView(ID3D12Resource*, const D3D12_SHADER_RESOURCE_VIEW_DESC*, D3D12_CPU_DESCRIPTOR_HANDLE) override
+		{
+			m_ViewCount++;
+		}
+
+		HRESULT CreateCommittedResource(
+			const D3D12_HEAP_PROPERTIES*,
+			D3D12_HEAP_FLAGS,
+			const D3D12_RESOURCE_DESC* pDesc,
+			D3D12_RESOURCE_STATES,
+			const D3D12_CLEAR_VALUE*,
+			REFIID,
+			void** ppResource) override
+		{
+			if (m_FailResources)
+			{
+				return E_OUTOFMEMORY;
+			}
+
+			m_ResourceCount++;
+			*ppResource = static_cast<ID3D12Resource*>(new Resource(*pDesc));
+			return S_OK;
+		}
+
+		HRESULT CreateFence(UINT64 value, D3D12_FENCE_FLAGS, REFIID, void** ppFence) override
+		{
+			*ppFence = static_cast<ID3D12Fence*>(new Fence(value));
+			return S_OK;
+		}
+
+		HRESULT CreateRootSignature(UINT, const void*, SIZE_T size, REFIID, void** ppRootSignature) override
+		{
+			if (size == 0)
+			{
+				return E_INVALIDARG;
+			}
+
+			m_RootSignatureCount++;
+			*ppRootSignature = static_cast<ID3D12RootSignature*>(new RootSignature());
+			return S_OK;
+		}
+
+		HRESULT CreateGraphicsPipelineState(const D3D12_GRAPHICS_PIPELINE_STATE_DESC* pDesc, REFIID, void** ppPipeline) override
+		{
+			if (pDesc->pRootSignature == nullptr)
+			{
+				return E_INVALIDARG;
+			}
+
+			m_PipelineCount++;
+			*ppPipeline = static_cast<ID3D12PipelineState*>(new PipelineState());
+			return S_OK;
+		}
+
+		HRESULT CreatePipelineLibrary(const void* pData, SIZE_T size, REFIID, void** ppLibrary) override
+		{
+			auto pLibrary = new PipelineLibrary();
+			if (!pLibrary->Init(pData, size))
+			{
+				pLibrary->Release();
+				return E_FAIL;
+			}
+
+			*ppLibrary = static_cast<ID3D12PipelineLibrary*>(pLibrary);
+			return S_OK;
+		}
+
+		//! @brief get count of views created
+		int GetViewCount() const
+		{
+			return m_ViewCount;
+		}
+
+		//! @brief get count of resources created
+		int GetResourceCount() const
+		{
+			return m_ResourceCount;
+		}
+
+		//! @brief get count of root signatures created
+		int GetRootSignatureCount() const
+		{
+			return m_RootSignatureCount;
+		}
+
+		//! @brief get count of pipeline states compiled
+		int GetPipelineCount() const
+		{
+			return m_PipelineCount;
+		}
+
+		//! @brief expose ID3D12Device1 and its pipeline libraries
+		void SetLibrarySupported(bool supported)
+		{
+			m_IsLibrarySupported = supported;
+		}
+
+		//! @brief make resource creation fail
+		void SetFailResources(bool fail)
+		{
+			m_FailResources = fail;
+		}
+
+	private:
+		std::atomic<int> m_ViewCount;
+		std::atomic<int> m_ResourceCount;
+		bool m_FailResources;
+		std::atomic<int> m_RootSignatureCount;
+		std::atomic<int> m_PipelineCount;
+		bool m_IsLibrarySupported;
+	};
+} // namespace Fake
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+
+//
+// Minimal checks for the host tests
+//
+// Each test program checks with CHECK() and returns TEST_RESULT() from main(), so ctest
+// sees a non-zero exit code when a check failed. Failed checks are printed with their
+// location and the test keeps running, so one run reports every failure.
+//
+
+namespace TestUtil {
+	//! @brief get count of failed checks
+	inline uint32_t& FailureCount()
+	{
+		static uint32_t count = 0;
+		return count;
+	}
+
+	//! @brief report a check
+	inline bool Report(bool passed, const char* expr, const char* file, int line)
+	{
+		if (!passed)
+		{
+			printf("[File : %s, Line : %d] check failed : %s\n", file, line, expr);
+			++FailureCount();
+		}
+		return passed;
+	}
+
+	//! @brief random number generator which gives the same sequence on every platform
+	class Random
+	{
+	public:
+		explicit Random(uint64_t seed)
+			: m_State(seed * 2 + 1)
+		{
+		}
+
+		//! @brief get next value in [0, 2^31)
+		uint32_t Next()
+		{
+			m_State = m_State * 6364136223846793005ull + 1442695040888963407ull;
+			return uint32_t(m_State >> 33);
+		}
+
+		//! @brief get value in [0, range)
+		uint32_t Next(uint32_t range)
+		{
+			return (range == 0) ? 0 : Next() % range;
+		}
+
+		//! @brief get value in [0, 1)
+		float NextFloat()
+		{
+			return float(Next() >> 7) / float(1 << 24);
+		}
+
+	private:
+		uint64_t m_State;
+	};
+} // namespace TestUtil
+
+#define CHECK(expr) TestUtil::Report(!!(expr), #expr, __FILE__, __LINE__)
+
+#define RUN_TEST(func) \
+	do { printf("%s\n", #func); func(); } while (false)
+
+#define TEST_RESULT() \
+	((TestUtil::FailureCount() == 0) ? (printf("passed\n"), 0) : (printf("%u check(s) failed\n", TestUtil::FailureCount()), 1))
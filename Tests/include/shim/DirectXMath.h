@@ -0,0 +1,51 @@
+#pragma once
+
+//
+// DirectXMath.h for the host tests
+//
+// Only the storage types and helpers which the mesh sources use. Nothing is vectorized.
+//
+
+namespace DirectX {
+	const float XM_PI = 3.141592654f;
+
+	struct XMFLOAT2
+	{
+		float x;
+		float y;
+
+		XMFLOAT2() = default;
+		XMFLOAT2(float _x, float _y) : x(_x), y(_y) {}
+	};
+
+	struct XMFLOAT3
+	{
+		float x;
+		float y;
+		float z;
+
+		XMFLOAT3() = default;
+		XMFLOAT3(float _x, float _y, float _z) : x(_x), y(_y), z(_z) {}
+	};
+
+	struct XMFLOAT4
+	{
+		float x;
+		float y;
+		float z;
+		float w;
+
+		XMFLOAT4() = default;
+		XMFLOAT4(float _x, float _y, float _z, float _w) : x(_x), y(_y), z(_z), w(_w) {}
+	};
+
+	inline float XMConvertToRadians(float degrees)
+	{
+		return degrees * (XM_PI / 180.0f);
+	}
+
+	inline float XMConvertToDegrees(float radians)
+	{
+		return radians * (180.0f / XM_PI);
+	}
+} // namespace DirectX
@@ -0,0 +1,102 @@
+#pragma once
+
+//
+// DirectXPackedVector.h for the host tests
+//
+// Only the half conversions which the vertex codec uses. They round to nearest even and keep
+// denormals, infinities and NaNs, as the DirectXMath versions do.
+//
+
+#include <cstdint>
+#include <cstring>
+
+namespace DirectX {
+namespace PackedVector {
+	typedef uint16_t HALF;
+
+	inline HALF XMConvertFloatToHalf(float value)
+	{
+		uint32_t bits;
+		memcpy(&bits, &value, sizeof(bits));
+
+		auto sign = HALF((bits >> 16) & 0x8000);
+		auto abs = bits & 0x7fffffff;
+
+		// NaN stays NaN, too large values become infinity
+		if (abs > 0x7f800000)
+		{
+			return HALF(sign | 0x7e00);
+		}
+		if (abs >= 0x477ff000)
+		{
+			return HALF(sign | 0x7c00);
+		}
+
+		// half of the smallest denormal and below round to zero
+		if (abs <= 0x33000000)
+		{
+			return sign;
+		}
+
+		// denormal half, shift the mantissa with its implicit bit
+		if (abs < 0x38800000)
+		{
+			auto shift = 113 - int(abs >> 23);
+			auto mantissa = (abs & 0x007fffff) | 0x00800000;
+			auto half = mantissa >> (shift + 13);
+			auto rest = mantissa & ((1u << (shift + 13)) - 1);
+			auto halfway = 1u << (shift + 12);
+			if (rest > halfway || (rest == halfway && (half & 1) != 0))
+			{
+				half++;
+			}
+			return HALF(sign | half);
+		}
+
+		// rebias the exponent, the carry of rounding may move it up
+		auto half = (abs - 0x38000000) >> 13;
+		auto rest = abs & 0x1fff;
+		if (rest > 0x1000 || (rest == 0x1000 && (half & 1) != 0))
+		{
+			half++;
+		}
+		return HALF(sign | half);
+	}
+
+	inline float XMConvertHalfToFloat(HALF value)
+	{
+		auto sign = uint32_t(value & 0x8000) << 16;
+		auto exponent = (value >> 10) & 0x1f;
+		auto mantissa = uint32_t(value & 0x3ff);
+
+		uint32_t bits;
+		if (exponent == 0x1f)
+		{
+			bits = sign | 0x7f800000 | (mantissa << 13);
+		}
+		else if (exponent != 0)
+		{
+			bits = sign | (uint32_t(exponent + 112) << 23) | (mantissa << 13);
+		}
+		else if (mantissa == 0)
+		{
+			bits = sign;
+		}
+		else
+		{
+			// denormal half, normalize it
+			auto shift = 0;
+			while ((mantissa & 0x400) == 0)
+			{
+				mantissa <<= 1;
+				shift++;
+			}
+			bits = sign | (uint32_t(113 - shift) << 23) | ((mantissa & 0x3ff) << 13);
+		}
+
+		float result;
+		memcpy(&result, &bits, sizeof(result));
+		return result;
+	}
+} // namespace PackedVector
+} // namespace DirectX
@@ -0,0 +1,287 @@
+#pragma once
+
+//
+// Windows.h for the host tests
+//
+// Declares only the Win32 types and macros which the Framework sources compiled by the
+// host tests use, so they build without the Windows SDK. Nothing here talks to a GPU.
+//
+
+#include <cstddef>
+#include <cstdint>
+#include <cwchar>
+#include <map>
+#include <mutex>
+#include <string>
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+typedef int BOOL;
+typedef unsigned char BYTE;
+typedef unsigned long DWORD;
+typedef float FLOAT;
+typedef void* HANDLE;
+typedef int32_t HRESULT; // 32 bit as on Windows, so FAILED() sees the sign of error codes
+typedef void* HWND;
+typedef int INT;
+typedef long LONG;
+typedef long long LONGLONG;
+typedef intptr_t LONG_PTR;
+typedef intptr_t LPARAM;
+typedef const char* LPCSTR;
+typedef const wchar_t* LPCWSTR;
+typedef void* LPVOID;
+typedef size_t SIZE_T;
+typedef unsigned int UINT;
+typedef uint8_t UINT8;
+typedef uint16_t UINT16;
+typedef uint64_t UINT64;
+typedef uintptr_t WPARAM;
+typedef const void* REFIID;
+
+union LARGE_INTEGER
+{
+	LONGLONG QuadPart;
+};
+
+struct RECT
+{
+	LONG left;
+	LONG top;
+	LONG right;
+	LONG bottom;
+};
+
+#define FALSE 0
+#define TRUE 1
+#define INFINITE 0xFFFFFFFF
+
+#define S_OK ((HRESULT)0L)
+#define E_FAIL ((HRESULT)0x80004005L)
+#define E_NOTIMPL ((HRESULT)0x80004001L)
+#define E_INVALIDARG ((HRESULT)0x80070057L)
+#define E_OUTOFMEMORY ((HRESULT)0x8007000EL)
+#define FAILED(hr) (((HRESULT)(hr)) < 0)
+#define SUCCEEDED(hr) (((HRESULT)(hr)) >= 0)
+
+// interface ids are not checked by the fakes
+#define IID_PPV_ARGS(pp) static_cast<REFIID>(nullptr), reinterpret_cast<void**>(pp)
+
+struct IUnknown
+{
+	virtual ~IUnknown() {}
+	virtual HRESULT QueryInterface(REFIID, void**) { return E_NOTIMPL; }
+	virtual unsigned long AddRef() = 0;
+	virtual unsigned long Release() = 0;
+};
+
+//
+// File API
+//
+// Files and mappings on POSIX for MappedFile and the cooked file writers. Paths are taken
+// as ASCII. Every handle is a ShimHandle, so CloseHandle() works for files and mappings.
+//
+
+#define GENERIC_READ 0x80000000L
+#define GENERIC_WRITE 0x40000000L
+#define FILE_SHARE_READ 0x00000001
+#define CREATE_ALWAYS 2
+#define OPEN_EXISTING 3
+#define FILE_ATTRIBUTE_NORMAL 0x00000080
+#define FILE_FLAG_SEQUENTIAL_SCAN 0x08000000
+#define PAGE_READONLY 0x02
+#define FILE_MAP_READ 0x0004
+#define MOVEFILE_REPLACE_EXISTING 0x00000001
+#define INVALID_HANDLE_VALUE (reinterpret_cast<HANDLE>(-1))
+
+struct ShimHandle
+{
+	int Fd; //!< file descriptor (-1 for a mapping)
+	size_t Size; //!< size of the file of a mapping
+	int MappingFd; //!< file descriptor which a mapping maps
+};
+
+namespace Shim {
+	inline std::string ToPath(LPCWSTR filename)
+	{
+		std::string path;
+		for (auto p = filename; *p != 0; ++p)
+		{
+			path.push_back(char(*p));
+		}
+		return path;
+	}
+
+	// sizes of mapped views, which munmap needs
+	inline std::map<const void*, size_t>& GetViews(std::mutex*& pMutex)
+	{
+		static std::mutex mutex;
+		static std::map<const void*, size_t> views;
+		pMutex = &mutex;
+		return views;
+	}
+} // namespace Shim
+
+inline HANDLE CreateFileW(LPCWSTR filename, DWORD access, DWORD, void*, DWORD disposition, DWORD, HANDLE)
+{
+	auto flags = (access & GENERIC_WRITE) ? O_WRONLY : O_RDONLY;
+	if (disposition == CREATE_ALWAYS)
+	{
+		flags |= O_CREAT | O_TRUNC;
+	}
+
+	auto fd = open(Shim::ToPath(filename).c_str(), flags, 0644);
+	if (fd < 0)
+	{
+		return INVALID_HANDLE_VALUE;
+	}
+
+	return new ShimHandle{ fd, 0, -1 };
+}
+
+inline BOOL GetFileSizeEx(HANDLE hFile, LARGE_INTEGER* pSize)
+{
+	struct stat info;
+	if (fstat(static_cast<ShimHandle*>(hFile)->Fd, &info) != 0)
+	{
+		return FALSE;
+	}
+
+	pSize->QuadPart = info.st_size;
+	return TRUE;
+}
+
+inline HANDLE CreateFileMappingW(HANDLE hFile, void*, DWORD, DWORD, DWORD, LPCWSTR)
+{
+	LARGE_INTEGER size = {};
+	if (!GetFileSizeEx(hFile, &size))
+	{
+		return nullptr;
+	}
+
+	return new ShimHandle{ -1, size_t(size.QuadPart), static_cast<ShimHandle*>(hFile)->Fd };
+}
+
+inline LPVOID MapViewOfFile(HANDLE hMapping, DWORD, DWORD, DWORD, SIZE_T)
+{
+	auto pMapping = static_cast<ShimHandle*>(hMapping);
+	auto ptr = mmap(nullptr, pMapping->Size, PROT_READ, MAP_PRIVATE, pMapping->MappingFd, 0);
+	if (ptr == MAP_FAILED)
+	{
+		return nullptr;
+	}
+
+	std::mutex* pMutex = nullptr;
+	auto& views = Shim::GetViews(pMutex);
+	std::lock_guard<std::mutex> lock(*pMutex);
+	views[ptr] = pMapping->Size;
+	return ptr;
+}
+
+inline BOOL UnmapViewOfFile(const void* ptr)
+{
+	std::mutex* pMutex = nullptr;
+	auto& views = Shim::GetViews(pMutex);
+	std::lock_guard<std::mutex> lock(*pMutex);
+	auto itr = views.find(ptr);
+	if (itr == views.end())
+	{
+		return FALSE;
+	}
+
+	munmap(const_cast<void*>(ptr), itr->second);
+	views.erase(itr);
+	return TRUE;
+}
+
+inline BOOL WriteFile(HANDLE hFile, const void* pData, DWORD size, DWORD* pWritten, void*)
+{
+	auto result = write(static_cast<ShimHandle*>(hFile)->Fd, pData, size);
+	*pWritten = (result < 0) ? 0 : DWORD(result);
+	return (result == ssize_t(size)) ? TRUE : FALSE;
+}
+
+inline BOOL CloseHandle(HANDLE handle)
+{
+	auto pHandle = static_cast<ShimHandle*>(handle);
+	if (pHandle->Fd >= 0)
+	{
+		close(pHandle->Fd);
+	}
+
+	delete pHandle;
+	return TRUE;
+}
+
+inline BOOL DeleteFileW(LPCWSTR filename)
+{
+	return (unlink(Shim::ToPath(filename).c_str()) == 0) ? TRUE : FALSE;
+}
+
+inline BOOL MoveFileExW(LPCWSTR from, LPCWSTR to, DWORD)
+{
+	return (rename(Shim::ToPath(from).c_str(), Shim::ToPath(to).c_str()) == 0) ? TRUE : FALSE;
+}
+
+//
+// String API
+//
+// Paths of the tests are ASCII, so conversions copy code units like Shim::ToPath().
+//
+
+#define CP_UTF8 65001
+
+inline int WideCharToMultiByte(UINT, DWORD, LPCWSTR src, int srcLength, char* dst, int dstSize, LPCSTR, BOOL*)
+{
+	auto length = (srcLength < 0) ? int(wcslen(src)) + 1 : srcLength;
+	if (dst == nullptr)
+	{
+		return length;
+	}
+	if (dstSize < length)
+	{
+		return 0;
+	}
+
+	for (auto i = 0; i < length; ++i)
+	{
+		dst[i] = char(src[i]);
+	}
+	return length;
+}
+
+template<size_t Size>
+inline int mbstowcs_s(size_t* pResult, wchar_t (&dst)[Size], const char* src, size_t count)
+{
+	size_t i = 0;
+	for (; i < count && i + 1 < Size && src[i] != 0; ++i)
+	{
+		dst[i] = wchar_t(uint8_t(src[i]));
+	}
+	dst[i] = 0;
+	*pResult = i + 1;
+	return 0;
+}
+
+//
+// Event API
+//
+// The fake queues complete a fence value as soon as it is signaled, so an event is always set
+// by the time it is waited for.
+//
+
+#define EVENT_ALL_ACCESS 0x1F0003
+#define WAIT_OBJECT_0 0x00000000L
+
+inline HANDLE CreateEventEx(void*, LPCWSTR, DWORD, DWORD)
+{
+	return new ShimHandle{ -1, 0, -1 };
+}
+
+inline DWORD WaitForSingleObjectEx(HANDLE, DWORD, BOOL)
+{
+	return WAIT_OBJECT_0;
+}
@@ -0,0 +1,883 @@
+#pragma once
+
+//
+// d3d12.h for the host tests
+//
+// Declares the subset of D3D12 which the Framework sources compiled by the host tests use.
+// Structures and enum values match the Windows SDK. Interfaces only carry the methods which
+// are called, with bodies which fail, so a fake (see FakeDevice.h) overrides what a test needs.
+//
+
+#include <Windows.h>
+#include <dxgiformat.h>
+#include <atomic>
+#include <cstring>
+#include <vector>
+
+typedef UINT64 D3D12_GPU_VIRTUAL_ADDRESS;
+
+struct D3D12_CPU_DESCRIPTOR_HANDLE { SIZE_T ptr; };
+struct D3D12_GPU_DESCRIPTOR_HANDLE { UINT64 ptr; };
+
+enum D3D12_COMMAND_LIST_TYPE
+{
+	D3D12_COMMAND_LIST_TYPE_DIRECT = 0,
+	D3D12_COMMAND_LIST_TYPE_BUNDLE = 1,
+	D3D12_COMMAND_LIST_TYPE_COMPUTE = 2,
+	D3D12_COMMAND_LIST_TYPE_COPY = 3,
+};
+
+enum D3D12_HEAP_TYPE
+{
+	D3D12_HEAP_TYPE_DEFAULT = 1,
+	D3D12_HEAP_TYPE_UPLOAD = 2,
+	D3D12_HEAP_TYPE_READBACK = 3,
+	D3D12_HEAP_TYPE_CUSTOM = 4,
+};
+
+enum D3D12_CPU_PAGE_PROPERTY { D3D12_CPU_PAGE_PROPERTY_UNKNOWN = 0 };
+enum D3D12_MEMORY_POOL { D3D12_MEMORY_POOL_UNKNOWN = 0 };
+
+enum D3D12_HEAP_FLAGS
+{
+	D3D12_HEAP_FLAG_NONE = 0,
+	D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS = 0xc0,
+	D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES = 0x44,
+	D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES = 0x84,
+	D3D12_HEAP_FLAG_ALLOW_ALL_BUFFERS_AND_TEXTURES = 0,
+};
+
+enum D3D12_RESOURCE_DIMENSION
+{
+	D3D12_RESOURCE_DIMENSION_UNKNOWN = 0,
+	D3D12_RESOURCE_DIMENSION_BUFFER = 1,
+	D3D12_RESOURCE_DIMENSION_TEXTURE1D = 2,
+	D3D12_RESOURCE_DIMENSION_TEXTURE2D = 3,
+	D3D12_RESOURCE_DIMENSION_TEXTURE3D = 4,
+};
+
+enum D3D12_TEXTURE_LAYOUT
+{
+	D3D12_TEXTURE_LAYOUT_UNKNOWN = 0,
+	D3D12_TEXTURE_LAYOUT_ROW_MAJOR = 1,
+};
+
+enum D3D12_RESOURCE_FLAGS
+{
+	D3D12_RESOURCE_FLAG_NONE = 0,
+	D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET = 0x1,
+	D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL = 0x2,
+	D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS = 0x4,
+	D3D12_RESOURCE_FLAG_DENY_SHADER_RESOURCE = 0x8,
+};
+
+inline D3D12_RESOURCE_FLAGS operator | (D3D12_RESOURCE_FLAGS a, D3D12_RESOURCE_FLAGS b)
+{
+	return D3D12_RESOURCE_FLAGS(int(a) | int(b));
+}
+
+enum D3D12_RESOURCE_STATES
+{
+	D3D12_RESOURCE_STATE_COMMON = 0,
+	D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER = 0x1,
+	D3D12_RESOURCE_STATE_INDEX_BUFFER = 0x2,
+	D3D12_RESOURCE_STATE_RENDER_TARGET = 0x4,
+	D3D12_RESOURCE_STATE_UNORDERED_ACCESS = 0x8,
+	D3D12_RESOURCE_STATE_DEPTH_WRITE = 0x10,
+	D3D12_RESOURCE_STATE_DEPTH_READ = 0x20,
+	D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE = 0x40,
+	D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE = 0x80,
+	D3D12_RESOURCE_STATE_COPY_DEST = 0x400,
+	D3D12_RESOURCE_STATE_COPY_SOURCE = 0x800,
+	D3D12_RESOURCE_STATE_GENERIC_READ = 0xac3,
+	D3D12_RESOURCE_STATE_PRESENT = 0,
+};
+
+inline D3D12_RESOURCE_STATES operator | (D3D12_RESOURCE_STATES a, D3D12_RESOURCE_STATES b)
+{
+	return D3D12_RESOURCE_STATES(int(a) | int(b));
+}
+
+inline D3D12_RESOURCE_STATES& operator |= (D3D12_RESOURCE_STATES& a, D3D12_RESOURCE_STATES b)
+{
+	a = a | b;
+	return a;
+}
+
+enum D3D12_FENCE_FLAGS { D3D12_FENCE_FLAG_NONE = 0 };
+
+enum D3D12_DESCRIPTOR_HEAP_TYPE
+{
+	D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV = 0,
+	D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER,
+	D3D12_DESCRIPTOR_HEAP_TYPE_RTV,
+	D3D12_DESCRIPTOR_HEAP_TYPE_DSV,
+	D3D12_DESCRIPTOR_HEAP_TYPE_NUM_TYPES,
+};
+
+enum D3D12_DESCRIPTOR_HEAP_FLAGS
+{
+	D3D12_DESCRIPTOR_HEAP_FLAG_NONE = 0,
+	D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE = 0x1,
+};
+
+struct D3D12_DESCRIPTOR_HEAP_DESC
+{
+	D3D12_DESCRIPTOR_HEAP_TYPE Type;
+	UINT NumDescriptors;
+	D3D12_DESCRIPTOR_HEAP_FLAGS Flags;
+	UINT NodeMask;
+};
+
+#define D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT 65536
+#define D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT 256
+#define D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT 512
+#define D3D12_TEXTURE_DATA_PITCH_ALIGNMENT 256
+#define D3D12_REQ_MIP_LEVELS 15
+#define D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES 0xffffffff
+#define D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING 0x1688
+
+struct DXGI_SAMPLE_DESC
+{
+	UINT Count;
+	UINT Quality;
+};
+
+struct D3D12_HEAP_PROPERTIES
+{
+	D3D12_HEAP_TYPE Type;
+	D3D12_CPU_PAGE_PROPERTY CPUPageProperty;
+	D3D12_MEMORY_POOL MemoryPoolPreference;
+	UINT CreationNodeMask;
+	UINT VisibleNodeMask;
+};
+
+struct D3D12_HEAP_DESC
+{
+	UINT64 SizeInBytes;
+	D3D12_HEAP_PROPERTIES Properties;
+	UINT64 Alignment;
+	D3D12_HEAP_FLAGS Flags;
+};
+
+struct D3D12_RESOURCE_DESC
+{
+	D3D12_RESOURCE_DIMENSION Dimension;
+	UINT64 Alignment;
+	UINT64 Width;
+	UINT Height;
+	UINT16 DepthOrArraySize;
+	UINT16 MipLevels;
+	DXGI_FORMAT Format;
+	DXGI_SAMPLE_DESC SampleDesc;
+	D3D12_TEXTURE_LAYOUT Layout;
+	D3D12_RESOURCE_FLAGS Flags;
+};
+
+struct D3D12_RESOURCE_ALLOCATION_INFO
+{
+	UINT64 SizeInBytes;
+	UINT64 Alignment;
+};
+
+struct D3D12_SUBRESOURCE_FOOTPRINT
+{
+	DXGI_FORMAT Format;
+	UINT Width;
+	UINT Height;
+	UINT Depth;
+	UINT RowPitch;
+};
+
+struct D3D12_PLACED_SUBRESOURCE_FOOTPRINT
+{
+	UINT64 Offset;
+	D3D12_SUBRESOURCE_FOOTPRINT Footprint;
+};
+
+struct D3D12_RANGE
+{
+	SIZE_T Begin;
+	SIZE_T End;
+};
+
+struct D3D12_CLEAR_VALUE
+{
+	DXGI_FORMAT Format;
+	union
+	{
+		FLOAT Color[4];
+		struct
+		{
+			FLOAT Depth;
+			UINT8 Stencil;
+		} DepthStencil;
+	};
+};
+
+enum D3D12_SRV_DIMENSION
+{
+	D3D12_SRV_DIMENSION_UNKNOWN = 0,
+	D3D12_SRV_DIMENSION_BUFFER = 1,
+	D3D12_SRV_DIMENSION_TEXTURE1D = 2,
+	D3D12_SRV_DIMENSION_TEXTURE1DARRAY = 3,
+	D3D12_SRV_DIMENSION_TEXTURE2D = 4,
+	D3D12_SRV_DIMENSION_TEXTURE2DARRAY = 5,
+	D3D12_SRV_DIMENSION_TEXTURE2DMS = 6,
+	D3D12_SRV_DIMENSION_TEXTURE2DMSARRAY = 7,
+	D3D12_SRV_DIMENSION_TEXTURE3D = 8,
+	D3D12_SRV_DIMENSION_TEXTURECUBE = 9,
+	D3D12_SRV_DIMENSION_TEXTURECUBEARRAY = 10,
+};
+
+enum D3D12_BUFFER_SRV_FLAGS
+{
+	D3D12_BUFFER_SRV_FLAG_NONE = 0,
+	D3D12_BUFFER_SRV_FLAG_RAW = 0x1,
+};
+
+struct D3D12_BUFFER_SRV { UINT64 FirstElement; UINT NumElements; UINT StructureByteStride; D3D12_BUFFER_SRV_FLAGS Flags; };
+struct D3D12_TEX2D_SRV { UINT MostDetailedMip; UINT MipLevels; UINT PlaneSlice; FLOAT ResourceMinLODClamp; };
+struct D3D12_TEX2D_ARRAY_SRV { UINT MostDetailedMip; UINT MipLevels; UINT FirstArraySlice; UINT ArraySize; UINT PlaneSlice; FLOAT ResourceMinLODClamp; };
+struct D3D12_TEXCUBE_SRV { UINT MostDetailedMip; UINT MipLevels; FLOAT ResourceMinLODClamp; };
+struct D3D12_TEXCUBE_ARRAY_SRV { UINT MostDetailedMip; UINT MipLevels; UINT First2DArrayFace; UINT NumCubes; FLOAT ResourceMinLODClamp; };
+struct D3D12_TEX3D_SRV { UINT MostDetailedMip; UINT MipLevels; FLOAT ResourceMinLODClamp; };
+
+struct D3D12_SHADER_RESOURCE_VIEW_DESC
+{
+	DXGI_FORMAT Format;
+	D3D12_SRV_DIMENSION ViewDimension;
+	UINT Shader4ComponentMapping;
+	union
+	{
+		D3D12_BUFFER_SRV Buffer;
+		D3D12_TEX2D_SRV Texture2D;
+		D3D12_TEX2D_ARRAY_SRV Texture2DArray;
+		D3D12_TEXCUBE_SRV TextureCube;
+		D3D12_TEXCUBE_ARRAY_SRV TextureCubeArray;
+		D3D12_TEX3D_SRV Texture3D;
+	};
+};
+
+struct D3D12_CONSTANT_BUFFER_VIEW_DESC
+{
+	D3D12_GPU_VIRTUAL_ADDRESS BufferLocation;
+	UINT SizeInBytes;
+};
+
+struct D3D12_COMMAND_QUEUE_DESC
+{
+	D3D12_COMMAND_LIST_TYPE Type;
+	INT Priority;
+	UINT Flags;
+	UINT NodeMask;
+};
+
+enum D3D12_INPUT_CLASSIFICATION
+{
+	D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA = 0,
+	D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA = 1,
+};
+
+#define D3D12_APPEND_ALIGNED_ELEMENT 0xffffffff
+
+struct D3D12_INPUT_ELEMENT_DESC
+{
+	LPCSTR SemanticName;
+	UINT SemanticIndex;
+	DXGI_FORMAT Format;
+	UINT InputSlot;
+	UINT AlignedByteOffset;
+	D3D12_INPUT_CLASSIFICATION InputSlotClass;
+	UINT InstanceDataStepRate;
+};
+
+struct D3D12_INPUT_LAYOUT_DESC
+{
+	const D3D12_INPUT_ELEMENT_DESC* pInputElementDescs;
+	UINT NumElements;
+};
+
+enum D3D_PRIMITIVE_TOPOLOGY
+{
+	D3D_PRIMITIVE_TOPOLOGY_UNDEFINED = 0,
+	D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST = 4,
+};
+
+enum D3D12_RESOURCE_BARRIER_TYPE
+{
+	D3D12_RESOURCE_BARRIER_TYPE_TRANSITION = 0,
+	D3D12_RESOURCE_BARRIER_TYPE_ALIASING = 1,
+	D3D12_RESOURCE_BARRIER_TYPE_UAV = 2,
+};
+
+enum D3D12_RESOURCE_BARRIER_FLAGS
+{
+	D3D12_RESOURCE_BARRIER_FLAG_NONE = 0,
+	D3D12_RESOURCE_BARRIER_FLAG_BEGIN_ONLY = 0x1,
+	D3D12_RESOURCE_BARRIER_FLAG_END_ONLY = 0x2,
+};
+
+struct ID3D12Resource;
+
+struct D3D12_RESOURCE_TRANSITION_BARRIER
+{
+	ID3D12Resource* pResource;
+	UINT Subresource;
+	D3D12_RESOURCE_STATES StateBefore;
+	D3D12_RESOURCE_STATES StateAfter;
+};
+
+struct D3D12_RESOURCE_ALIASING_BARRIER
+{
+	ID3D12Resource* pResourceBefore;
+	ID3D12Resource* pResourceAfter;
+};
+
+struct D3D12_RESOURCE_UAV_BARRIER
+{
+	ID3D12Resource* pResource;
+};
+
+struct D3D12_RESOURCE_BARRIER
+{
+	D3D12_RESOURCE_BARRIER_TYPE Type;
+	D3D12_RESOURCE_BARRIER_FLAGS Flags;
+	union
+	{
+		D3D12_RESOURCE_TRANSITION_BARRIER Transition;
+		D3D12_RESOURCE_ALIASING_BARRIER Aliasing;
+		D3D12_RESOURCE_UAV_BARRIER UAV;
+	};
+};
+
+struct D3D12_VERTEX_BUFFER_VIEW
+{
+	D3D12_GPU_VIRTUAL_ADDRESS BufferLocation;
+	UINT SizeInBytes;
+	UINT StrideInBytes;
+};
+
+struct D3D12_INDEX_BUFFER_VIEW
+{
+	D3D12_GPU_VIRTUAL_ADDRESS BufferLocation;
+	UINT SizeInBytes;
+	DXGI_FORMAT Format;
+};
+
+enum D3D12_DESCRIPTOR_RANGE_TYPE
+{
+	D3D12_DESCRIPTOR_RANGE_TYPE_SRV = 0,
+	D3D12_DESCRIPTOR_RANGE_TYPE_UAV = 1,
+	D3D12_DESCRIPTOR_RANGE_TYPE_CBV = 2,
+	D3D12_DESCRIPTOR_RANGE_TYPE_SAMPLER = 3,
+};
+
+enum D3D12_ROOT_PARAMETER_TYPE
+{
+	D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE = 0,
+	D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS = 1,
+	D3D12_ROOT_PARAMETER_TYPE_CBV = 2,
+	D3D12_ROOT_PARAMETER_TYPE_SRV = 3,
+	D3D12_ROOT_PARAMETER_TYPE_UAV = 4,
+};
+
+enum D3D12_SHADER_VISIBILITY
+{
+	D3D12_SHADER_VISIBILITY_ALL = 0,
+	D3D12_SHADER_VISIBILITY_VERTEX = 1,
+	D3D12_SHADER_VISIBILITY_HULL = 2,
+	D3D12_SHADER_VISIBILITY_DOMAIN = 3,
+	D3D12_SHADER_VISIBILITY_GEOMETRY = 4,
+	D3D12_SHADER_VISIBILITY_PIXEL = 5,
+};
+
+enum D3D12_ROOT_SIGNATURE_FLAGS
+{
+	D3D12_ROOT_SIGNATURE_FLAG_NONE = 0,
+	D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT = 0x1,
+	D3D12_ROOT_SIGNATURE_FLAG_DENY_VERTEX_SHADER_ROOT_ACCESS = 0x2,
+	D3D12_ROOT_SIGNATURE_FLAG_DENY_HULL_SHADER_ROOT_ACCESS = 0x4,
+	D3D12_ROOT_SIGNATURE_FLAG_DENY_DOMAIN_SHADER_ROOT_ACCESS = 0x8,
+	D3D12_ROOT_SIGNATURE_FLAG_DENY_GEOMETRY_SHADER_ROOT_ACCESS = 0x10,
+	D3D12_ROOT_SIGNATURE_FLAG_DENY_PIXEL_SHADER_ROOT_ACCESS = 0x20,
+	D3D12_ROOT_SIGNATURE_FLAG_ALLOW_STREAM_OUTPUT = 0x40,
+};
+
+enum D3D12_FILTER
+{
+	D3D12_FILTER_MIN_MAG_MIP_POINT = 0,
+	D3D12_FILTER_MIN_MAG_MIP_LINEAR = 0x15,
+	D3D12_FILTER_ANISOTROPIC = 0x55,
+};
+
+enum D3D12_TEXTURE_ADDRESS_MODE
+{
+	D3D12_TEXTURE_ADDRESS_MODE_WRAP = 1,
+	D3D12_TEXTURE_ADDRESS_MODE_MIRROR = 2,
+	D3D12_TEXTURE_ADDRESS_MODE_CLAMP = 3,
+	D3D12_TEXTURE_ADDRESS_MODE_BORDER = 4,
+};
+
+enum D3D12_COMPARISON_FUNC
+{
+	D3D12_COMPARISON_FUNC_NEVER = 1,
+	D3D12_COMPARISON_FUNC_LESS = 2,
+	D3D12_COMPARISON_FUNC_LESS_EQUAL = 4,
+	D3D12_COMPARISON_FUNC_ALWAYS = 8,
+};
+
+enum D3D12_STATIC_BORDER_COLOR
+{
+	D3D12_STATIC_BORDER_COLOR_TRANSPARENT_BLACK = 0,
+	D3D12_STATIC_BORDER_COLOR_OPAQUE_BLACK = 1,
+	D3D12_STATIC_BORDER_COLOR_OPAQUE_WHITE = 2,
+};
+
+enum D3D_ROOT_SIGNATURE_VERSION
+{
+	D3D_ROOT_SIGNATURE_VERSION_1 = 0x1,
+};
+
+#define D3D12_DEFAULT_MIP_LOD_BIAS (0.0f)
+#define D3D12_FLOAT32_MAX (3.402823466e+38f)
+#define D3D12_MAX_MAXANISOTROPY 16
+
+struct D3D12_DESCRIPTOR_RANGE
+{
+	D3D12_DESCRIPTOR_RANGE_TYPE RangeType;
+	UINT NumDescriptors;
+	UINT BaseShaderRegister;
+	UINT RegisterSpace;
+	UINT OffsetInDescriptorsFromTableStart;
+};
+
+struct D3D12_ROOT_DESCRIPTOR_TABLE
+{
+	UINT NumDescriptorRanges;
+	const D3D12_DESCRIPTOR_RANGE* pDescriptorRanges;
+};
+
+struct D3D12_ROOT_CONSTANTS
+{
+	UINT ShaderRegister;
+	UINT RegisterSpace;
+	UINT Num32BitValues;
+};
+
+struct D3D12_ROOT_DESCRIPTOR
+{
+	UINT ShaderRegister;
+	UINT RegisterSpace;
+};
+
+struct D3D12_ROOT_PARAMETER
+{
+	D3D12_ROOT_PARAMETER_TYPE ParameterType;
+	union
+	{
+		D3D12_ROOT_DESCRIPTOR_TABLE DescriptorTable;
+		D3D12_ROOT_CONSTANTS Constants;
+		D3D12_ROOT_DESCRIPTOR Descriptor;
+	};
+	D3D12_SHADER_VISIBILITY ShaderVisibility;
+};
+
+struct D3D12_STATIC_SAMPLER_DESC
+{
+	D3D12_FILTER Filter;
+	D3D12_TEXTURE_ADDRESS_MODE AddressU;
+	D3D12_TEXTURE_ADDRESS_MODE AddressV;
+	D3D12_TEXTURE_ADDRESS_MODE AddressW;
+	FLOAT MipLODBias;
+	UINT MaxAnisotropy;
+	D3D12_COMPARISON_FUNC ComparisonFunc;
+	D3D12_STATIC_BORDER_COLOR BorderColor;
+	FLOAT MinLOD;
+	FLOAT MaxLOD;
+	UINT ShaderRegister;
+	UINT RegisterSpace;
+	D3D12_SHADER_VISIBILITY ShaderVisibility;
+};
+
+struct D3D12_ROOT_SIGNATURE_DESC
+{
+	UINT NumParameters;
+	const D3D12_ROOT_PARAMETER* pParameters;
+	UINT NumStaticSamplers;
+	const D3D12_STATIC_SAMPLER_DESC* pStaticSamplers;
+	D3D12_ROOT_SIGNATURE_FLAGS Flags;
+};
+
+enum D3D12_BLEND
+{
+	D3D12_BLEND_ZERO = 1,
+	D3D12_BLEND_ONE = 2,
+	D3D12_BLEND_SRC_ALPHA = 5,
+	D3D12_BLEND_INV_SRC_ALPHA = 6,
+};
+
+enum D3D12_BLEND_OP
+{
+	D3D12_BLEND_OP_ADD = 1,
+};
+
+enum D3D12_LOGIC_OP
+{
+	D3D12_LOGIC_OP_CLEAR = 0,
+	D3D12_LOGIC_OP_NOOP = 4,
+};
+
+enum D3D12_COLOR_WRITE_ENABLE
+{
+	D3D12_COLOR_WRITE_ENABLE_ALL = 0xf,
+};
+
+enum D3D12_FILL_MODE
+{
+	D3D12_FILL_MODE_WIREFRAME = 2,
+	D3D12_FILL_MODE_SOLID = 3,
+};
+
+enum D3D12_CULL_MODE
+{
+	D3D12_CULL_MODE_NONE = 1,
+	D3D12_CULL_MODE_FRONT = 2,
+	D3D12_CULL_MODE_BACK = 3,
+};
+
+enum D3D12_CONSERVATIVE_RASTERIZATION_MODE
+{
+	D3D12_CONSERVATIVE_RASTERIZATION_MODE_OFF = 0,
+	D3D12_CONSERVATIVE_RASTERIZATION_MODE_ON = 1,
+};
+
+enum D3D12_DEPTH_WRITE_MASK
+{
+	D3D12_DEPTH_WRITE_MASK_ZERO = 0,
+	D3D12_DEPTH_WRITE_MASK_ALL = 1,
+};
+
+enum D3D12_STENCIL_OP
+{
+	D3D12_STENCIL_OP_KEEP = 1,
+};
+
+enum D3D12_INDEX_BUFFER_STRIP_CUT_VALUE
+{
+	D3D12_INDEX_BUFFER_STRIP_CUT_VALUE_DISABLED = 0,
+};
+
+enum D3D12_PRIMITIVE_TOPOLOGY_TYPE
+{
+	D3D12_PRIMITIVE_TOPOLOGY_TYPE_UNDEFINED = 0,
+	D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE = 3,
+};
+
+enum D3D12_PIPELINE_STATE_FLAGS
+{
+	D3D12_PIPELINE_STATE_FLAG_NONE = 0,
+};
+
+#define D3D12_SIMULTANEOUS_RENDER_TARGET_COUNT 8
+#define D3D12_DEFAULT_SAMPLE_MASK 0xffffffff
+
+struct D3D12_SHADER_BYTECODE
+{
+	const void* pShaderBytecode;
+	SIZE_T BytecodeLength;
+};
+
+struct D3D12_SO_DECLARATION_ENTRY
+{
+	UINT Stream;
+	LPCSTR SemanticName;
+	UINT SemanticIndex;
+	BYTE StartComponent;
+	BYTE ComponentCount;
+	BYTE OutputSlot;
+};
+
+struct D3D12_STREAM_OUTPUT_DESC
+{
+	const D3D12_SO_DECLARATION_ENTRY* pSODeclaration;
+	UINT NumEntries;
+	const UINT* pBufferStrides;
+	UINT NumStrides;
+	UINT RasterizedStream;
+};
+
+struct D3D12_RENDER_TARGET_BLEND_DESC
+{
+	BOOL BlendEnable;
+	BOOL LogicOpEnable;
+	D3D12_BLEND SrcBlend;
+	D3D12_BLEND DestBlend;
+	D3D12_BLEND_OP BlendOp;
+	D3D12_BLEND SrcBlendAlpha;
+	D3D12_BLEND DestBlendAlpha;
+	D3D12_BLEND_OP BlendOpAlpha;
+	D3D12_LOGIC_OP LogicOp;
+	UINT8 RenderTargetWriteMask;
+};
+
+struct D3D12_BLEND_DESC
+{
+	BOOL AlphaToCoverageEnable;
+	BOOL IndependentBlendEnable;
+	D3D12_RENDER_TARGET_BLEND_DESC RenderTarget[D3D12_SIMULTANEOUS_RENDER_TARGET_COUNT];
+};
+
+struct D3D12_RASTERIZER_DESC
+{
+	D3D12_FILL_MODE FillMode;
+	D3D12_CULL_MODE CullMode;
+	BOOL FrontCounterClockwise;
+	INT DepthBias;
+	FLOAT DepthBiasClamp;
+	FLOAT SlopeScaledDepthBias;
+	BOOL DepthClipEnable;
+	BOOL MultisampleEnable;
+	BOOL AntialiasedLineEnable;
+	UINT ForcedSampleCount;
+	D3D12_CONSERVATIVE_RASTERIZATION_MODE ConservativeRaster;
+};
+
+struct D3D12_DEPTH_STENCILOP_DESC
+{
+	D3D12_STENCIL_OP StencilFailOp;
+	D3D12_STENCIL_OP StencilDepthFailOp;
+	D3D12_STENCIL_OP StencilPassOp;
+	D3D12_COMPARISON_FUNC StencilFunc;
+};
+
+struct D3D12_DEPTH_STENCIL_DESC
+{
+	BOOL DepthEnable;
+	D3D12_DEPTH_WRITE_MASK DepthWriteMask;
+	D3D12_COMPARISON_FUNC DepthFunc;
+	BOOL StencilEnable;
+	UINT8 StencilReadMask;
+	UINT8 StencilWriteMask;
+	D3D12_DEPTH_STENCILOP_DESC FrontFace;
+	D3D12_DEPTH_STENCILOP_DESC BackFace;
+};
+
+struct D3D12_CACHED_PIPELINE_STATE
+{
+	const void* pCachedBlob;
+	SIZE_T CachedBlobSizeInBytes;
+};
+
+struct ID3D12RootSignature;
+
+struct D3D12_GRAPHICS_PIPELINE_STATE_DESC
+{
+	ID3D12RootSignature* pRootSignature;
+	D3D12_SHADER_BYTECODE VS;
+	D3D12_SHADER_BYTECODE PS;
+	D3D12_SHADER_BYTECODE DS;
+	D3D12_SHADER_BYTECODE HS;
+	D3D12_SHADER_BYTECODE GS;
+	D3D12_STREAM_OUTPUT_DESC StreamOutput;
+	D3D12_BLEND_DESC BlendState;
+	UINT SampleMask;
+	D3D12_RASTERIZER_DESC RasterizerState;
+	D3D12_DEPTH_STENCIL_DESC DepthStencilState;
+	D3D12_INPUT_LAYOUT_DESC InputLayout;
+	D3D12_INDEX_BUFFER_STRIP_CUT_VALUE IBStripCutValue;
+	D3D12_PRIMITIVE_TOPOLOGY_TYPE PrimitiveTopologyType;
+	UINT NumRenderTargets;
+	DXGI_FORMAT RTVFormats[D3D12_SIMULTANEOUS_RENDER_TARGET_COUNT];
+	DXGI_FORMAT DSVFormat;
+	DXGI_SAMPLE_DESC SampleDesc;
+	UINT NodeMask;
+	D3D12_CACHED_PIPELINE_STATE CachedPSO;
+	D3D12_PIPELINE_STATE_FLAGS Flags;
+};
+
+//
+// Interfaces
+//
+
+struct ID3DBlob : IUnknown
+{
+	virtual LPVOID GetBufferPointer() = 0;
+	virtual SIZE_T GetBufferSize() = 0;
+};
+
+typedef ID3DBlob ID3D10Blob;
+
+struct ID3D12Object : IUnknown
+{
+	virtual HRESULT SetName(LPCWSTR) { return S_OK; }
+};
+
+struct ID3D12Pageable : ID3D12Object {};
+struct ID3D12Heap : ID3D12Pageable {};
+struct ID3D12RootSignature : ID3D12Object {};
+struct ID3D12PipelineState : ID3D12Pageable {};
+
+struct ID3D12PipelineLibrary : ID3D12Object
+{
+	virtual HRESULT StorePipeline(LPCWSTR, ID3D12PipelineState*) { return E_NOTIMPL; }
+	virtual HRESULT LoadGraphicsPipeline(LPCWSTR, const D3D12_GRAPHICS_PIPELINE_STATE_DESC*, REFIID, void**) { return E_NOTIMPL; }
+	virtual SIZE_T GetSerializedSize() { return 0; }
+	virtual HRESULT Serialize(void*, SIZE_T) { return E_NOTIMPL; }
+};
+
+struct ID3D12Resource : ID3D12Pageable
+{
+	virtual D3D12_RESOURCE_DESC GetDesc() { return D3D12_RESOURCE_DESC(); }
+	virtual HRESULT Map(UINT, const D3D12_RANGE*, void**) { return E_NOTIMPL; }
+	virtual void Unmap(UINT, const D3D12_RANGE*) {}
+	virtual D3D12_GPU_VIRTUAL_ADDRESS GetGPUVirtualAddress() { return 0; }
+};
+
+struct ID3D12Fence : ID3D12Pageable
+{
+	virtual UINT64 GetCompletedValue() { return 0; }
+	virtual HRESULT SetEventOnCompletion(UINT64, HANDLE) { return E_NOTIMPL; }
+	virtual HRESULT Signal(UINT64) { return E_NOTIMPL; }
+};
+
+struct ID3D12DescriptorHeap : ID3D12Pageable
+{
+	virtual D3D12_DESCRIPTOR_HEAP_DESC GetDesc() { return D3D12_DESCRIPTOR_HEAP_DESC(); }
+	virtual D3D12_CPU_DESCRIPTOR_HANDLE GetCPUDescriptorHandleForHeapStart() { return D3D12_CPU_DESCRIPTOR_HANDLE(); }
+	virtual D3D12_GPU_DESCRIPTOR_HANDLE GetGPUDescriptorHandleForHeapStart() { return D3D12_GPU_DESCRIPTOR_HANDLE(); }
+};
+
+struct ID3D12CommandAllocator : ID3D12Pageable
+{
+	virtual HRESULT Reset() { return E_NOTIMPL; }
+};
+
+struct ID3D12CommandList : ID3D12Object {};
+
+struct ID3D12GraphicsCommandList : ID3D12CommandList
+{
+	virtual HRESULT Close() { return E_NOTIMPL; }
+	virtual HRESULT Reset(ID3D12CommandAllocator*, ID3D12PipelineState*) { return E_NOTIMPL; }
+	virtual void CopyBufferRegion(ID3D12Resource*, UINT64, ID3D12Resource*, UINT64, UINT64) {}
+	virtual void ResourceBarrier(UINT, const D3D12_RESOURCE_BARRIER*) {}
+	virtual void IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY) {}
+	virtual void SetGraphicsRootSignature(ID3D12RootSignature*) {}
+	virtual void SetGraphicsRootDescriptorTable(UINT, D3D12_GPU_DESCRIPTOR_HANDLE) {}
+	virtual void SetGraphicsRoot32BitConstant(UINT, UINT, UINT) {}
+	virtual void SetGraphicsRootConstantBufferView(UINT, D3D12_GPU_VIRTUAL_ADDRESS) {}
+	virtual void SetGraphicsRootShaderResourceView(UINT, D3D12_GPU_VIRTUAL_ADDRESS) {}
+	virtual void SetPipelineState(ID3D12PipelineState*) {}
+	virtual void IASetIndexBuffer(const D3D12_INDEX_BUFFER_VIEW*) {}
+	virtual void IASetVertexBuffers(UINT, UINT, const D3D12_VERTEX_BUFFER_VIEW*) {}
+	virtual void DrawIndexedInstanced(UINT, UINT, UINT, INT, UINT) {}
+};
+
+struct ID3D12CommandQueue : ID3D12Pageable
+{
+	virtual void ExecuteCommandLists(UINT, ID3D12CommandList* const*) {}
+	virtual HRESULT Signal(ID3D12Fence*, UINT64) { return E_NOTIMPL; }
+	virtual HRESULT Wait(ID3D12Fence*, UINT64) { return E_NOTIMPL; }
+	virtual D3D12_COMMAND_QUEUE_DESC GetDesc() { return D3D12_COMMAND_QUEUE_DESC(); }
+};
+
+struct ID3D12Device : ID3D12Object
+{
+	virtual HRESULT CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE, REFIID, void**) { return E_NOTIMPL; }
+	virtual HRESULT CreateCommandList(UINT, D3D12_COMMAND_LIST_TYPE, ID3D12CommandAllocator*, ID3D12PipelineState*, REFIID, void**) { return E_NOTIMPL; }
+	virtual HRESULT CreateDescriptorHeap(const D3D12_DESCRIPTOR_HEAP_DESC*, REFIID, void**) { return E_NOTIMPL; }
+	virtual UINT GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE) { return 0; }
+	virtual void CreateConstantBufferView(const D3D12_CONSTANT_BUFFER_VIEW_DESC*, D3D12_CPU_DESCRIPTOR_HANDLE) {}
+	virtual void CreateShaderResourceView(ID3D12Resource*, const D3D12_SHADER_RESOURCE_VIEW_DESC*, D3D12_CPU_DESCRIPTOR_HANDLE) {}
+	virtual HRESULT CreateCommittedResource(const D3D12_HEAP_PROPERTIES*, D3D12_HEAP_FLAGS, const D3D12_RESOURCE_DESC*, D3D12_RESOURCE_STATES, const D3D12_CLEAR_VALUE*, REFIID, void**) { return E_NOTIMPL; }
+	virtual HRESULT CreateHeap(const D3D12_HEAP_DESC*, REFIID, void**) { return E_NOTIMPL; }
+	virtual HRESULT CreatePlacedResource(ID3D12Heap*, UINT64, const D3D12_RESOURCE_DESC*, D3D12_RESOURCE_STATES, const D3D12_CLEAR_VALUE*, REFIID, void**) { return E_NOTIMPL; }
+	virtual HRESULT CreateFence(UINT64, D3D12_FENCE_FLAGS, REFIID, void**) { return E_NOTIMPL; }
+	virtual D3D12_RESOURCE_ALLOCATION_INFO GetResourceAllocationInfo(UINT, UINT, const D3D12_RESOURCE_DESC*) { return D3D12_RESOURCE_ALLOCATION_INFO(); }
+	virtual void GetCopyableFootprints(const D3D12_RESOURCE_DESC*, UINT, UINT, UINT64, D3D12_PLACED_SUBRESOURCE_FOOTPRINT*, UINT*, UINT64*, UINT64*) {}
+	virtual HRESULT CreateRootSignature(UINT, const void*, SIZE_T, REFIID, void**) { return E_NOTIMPL; }
+	virtual HRESULT CreateGraphicsPipelineState(const D3D12_GRAPHICS_PIPELINE_STATE_DESC*, REFIID, void**) { return E_NOTIMPL; }
+};
+
+struct ID3D12Device1 : ID3D12Device
+{
+	virtual HRESULT CreatePipelineLibrary(const void*, SIZE_T, REFIID, void**) { return E_NOTIMPL; }
+};
+
+//
+// Functions
+//
+// A serialized root signature only has to reach ID3D12Device::CreateRootSignature(), so the
+// blob holds the parameter and sampler counts instead of the runtime format.
+//
+
+namespace Shim {
+	//
+	// Blob class
+	//
+	class Blob : public ID3DBlob
+	{
+	public:
+		explicit Blob(size_t size)
+			: m_Data(size)
+			, m_RefCount(1)
+		{
+		}
+
+		unsigned long AddRef() override
+		{
+			return ++m_RefCount;
+		}
+
+		unsigned long Release() override
+		{
+			auto count = --m_RefCount;
+			if (count == 0)
+			{
+				delete this;
+			}
+			return count;
+		}
+
+		LPVOID GetBufferPointer() override
+		{
+			return m_Data.data();
+		}
+
+		SIZE_T GetBufferSize() override
+		{
+			return m_Data.size();
+		}
+
+	private:
+		std::vector<uint8_t> m_Data;
+		std::atomic<unsigned long> m_RefCount;
+	};
+} // namespace Shim
+
+inline HRESULT D3D12SerializeRootSignature
+(
+	const D3D12_ROOT_SIGNATURE_DESC* pDesc,
+	D3D_ROOT_SIGNATURE_VERSION,
+	ID3DBlob** ppBlob,
+	ID3DBlob** ppErrorBlob
+)
+{
+	if (ppErrorBlob != nullptr)
+	{
+		*ppErrorBlob = nullptr;
+	}
+
+	if (pDesc == nullptr
+	|| (pDesc->NumParameters > 0 && pDesc->pParameters == nullptr)
+	|| (pDesc->NumStaticSamplers > 0 && pDesc->pStaticSamplers == nullptr))
+	{
+		return E_INVALIDARG;
+	}
+
+	UINT counts[2] = { pDesc->NumParameters, pDesc->NumStaticSamplers };
+	auto pBlob = new Shim::Blob(sizeof(counts));
+	memcpy(pBlob->GetBufferPointer(), counts, sizeof(counts));
+	*ppBlob = pBlob;
+	return S_OK;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+//
+// d3dcompiler.h for the host tests
+//
+// Only D3DReadFileToBlob(), which reads the whole file like the real one.
+//
+
+#include <d3d12.h>
+
+inline HRESULT D3DReadFileToBlob(LPCWSTR filename, ID3DBlob** ppBlob)
+{
+	auto fd = open(Shim::ToPath(filename).c_str(), O_RDONLY);
+	if (fd < 0)
+	{
+		return E_FAIL;
+	}
+
+	struct stat info;
+	if (fstat(fd, &info) != 0)
+	{
+		close(fd);
+		return E_FAIL;
+	}
+
+	auto pBlob = new Shim::Blob(size_t(info.st_size));
+	auto result = read(fd, pBlob->GetBufferPointer(), pBlob->GetBufferSize());
+	close(fd);
+
+	if (result != ssize_t(pBlob->GetBufferSize()))
+	{
+		pBlob->Release();
+		return E_FAIL;
+	}
+
+	*ppBlob = pBlob;
+	return S_OK;
+}
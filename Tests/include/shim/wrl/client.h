@@ -0,0 +1,183 @@
+#pragma once
+
+//
+// wrl/client.h for the host tests
+//
+// ComPtr with the reference counting of Microsoft::WRL::ComPtr, limited to what Framework uses.
+//
+
+#include <cstddef>
+
+namespace Microsoft {
+namespace WRL {
+
+	template<typename T>
+	class ComPtr
+	{
+	public:
+		ComPtr()
+			: m_p(nullptr)
+		{
+		}
+
+		ComPtr(std::nullptr_t)
+			: m_p(nullptr)
+		{
+		}
+
+		ComPtr(T* p)
+			: m_p(p)
+		{
+			InternalAddRef();
+		}
+
+		ComPtr(const ComPtr& other)
+			: m_p(other.m_p)
+		{
+			InternalAddRef();
+		}
+
+		template<typename U>
+		ComPtr(const ComPtr<U>& other)
+			: m_p(other.Get())
+		{
+			InternalAddRef();
+		}
+
+		ComPtr(ComPtr&& other)
+			: m_p(other.m_p)
+		{
+			other.m_p = nullptr;
+		}
+
+		~ComPtr()
+		{
+			InternalRelease();
+		}
+
+		ComPtr& operator = (std::nullptr_t)
+		{
+			InternalRelease();
+			return *this;
+		}
+
+		ComPtr& operator = (T* p)
+		{
+			ComPtr(p).Swap(*this);
+			return *this;
+		}
+
+		ComPtr& operator = (const ComPtr& other)
+		{
+			ComPtr(other).Swap(*this);
+			return *this;
+		}
+
+		ComPtr& operator = (ComPtr&& other)
+		{
+			ComPtr(static_cast<ComPtr&&>(other)).Swap(*this);
+			return *this;
+		}
+
+		T* Get() const
+		{
+			return m_p;
+		}
+
+		T* operator -> () const
+		{
+			return m_p;
+		}
+
+		T** GetAddressOf()
+		{
+			return &m_p;
+		}
+
+		T** ReleaseAndGetAddressOf()
+		{
+			InternalRelease();
+			return &m_p;
+		}
+
+		T* Detach()
+		{
+			auto p = m_p;
+			m_p = nullptr;
+			return p;
+		}
+
+		void Attach(T* p)
+		{
+			InternalRelease();
+			m_p = p;
+		}
+
+		unsigned long Reset()
+		{
+			return InternalRelease();
+		}
+
+		void Swap(ComPtr& other)
+		{
+			auto p = m_p;
+			m_p = other.m_p;
+			other.m_p = p;
+		}
+
+		template<typename U>
+		long As(ComPtr<U>* pOther) const
+		{
+			auto p = dynamic_cast<U*>(m_p);
+			if (p == nullptr)
+			{
+				return long(0x80004002L); // E_NOINTERFACE
+			}
+
+			*pOther = p;
+			return 0;
+		}
+
+		explicit operator bool() const
+		{
+			return m_p != nullptr;
+		}
+
+	private:
+		T* m_p;
+
+		void InternalAddRef()
+		{
+			if (m_p != nullptr)
+			{
+				m_p->AddRef();
+			}
+		}
+
+		unsigned long InternalRelease()
+		{
+			unsigned long count = 0;
+			auto p = m_p;
+			if (p != nullptr)
+			{
+				m_p = nullptr;
+				count = p->Release();
+			}
+			return count;
+		}
+	};
+
+	template<typename T>
+	bool operator == (const ComPtr<T>& lhs, std::nullptr_t)
+	{
+		return lhs.Get() == nullptr;
+	}
+
+	template<typename T>
+	bool operator != (const ComPtr<T>& lhs, std::nullptr_t)
+	{
+		return lhs.Get() != nullptr;
+	}
+
+} // namespace WRL
+} // namespace Microsoft
@@ -0,0 +1,224 @@
+#include "BuddyAllocator.h"
+#include "TestUtil.h"
+#include <map>
+#include <vector>
+
+namespace {
+	// check the allocator against the allocations alive
+	bool CheckConsistency(const BuddyAllocator& allocator, const std::map<uint32_t, uint32_t>& alive)
+	{
+		uint32_t used = 0;
+		uint32_t end = 0;
+		for (auto& itr : alive)
+		{
+			// blocks are aligned to their size, lie in capacity and never overlap
+			if ((itr.first % itr.second) != 0 || itr.first < end || itr.first + itr.second > allocator.GetCapacity())
+			{
+				return false;
+			}
+
+			if (allocator.GetBlockSize(itr.first) != itr.second)
+			{
+				return false;
+			}
+
+			end = itr.first + itr.second;
+			used += itr.second;
+		}
+
+		return used == allocator.GetUsedCount();
+	}
+
+	void TestInit()
+	{
+		BuddyAllocator allocator;
+		CHECK(!allocator.Init(0));
+		CHECK(!allocator.Init(BuddyAllocator::InvalidOffset));
+
+		CHECK(allocator.Init(1024));
+		CHECK(allocator.GetCapacity() == 1024);
+		CHECK(allocator.GetUsedCount() == 0);
+		CHECK(allocator.GetLargestFreeBlock() == 1024);
+
+		// capacity which is not a power of two is split into aligned blocks
+		CHECK(allocator.Init(1000));
+		CHECK(allocator.GetCapacity() == 1000);
+		CHECK(allocator.GetLargestFreeBlock() == 512);
+
+		allocator.Term();
+		CHECK(allocator.GetCapacity() == 0);
+		CHECK(allocator.Alloc(1) == BuddyAllocator::InvalidOffset);
+	}
+
+	void TestAllocRounding()
+	{
+		BuddyAllocator allocator;
+		CHECK(allocator.Init(64));
+
+		CHECK(allocator.Alloc(0) == BuddyAllocator::InvalidOffset);
+		CHECK(allocator.Alloc(65) == BuddyAllocator::InvalidOffset);
+
+		auto a = allocator.Alloc(3);
+		CHECK(a == 0);
+		CHECK(allocator.GetBlockSize(a) == 4);
+		CHECK(allocator.GetUsedCount() == 4);
+
+		auto b = allocator.Alloc(1);
+		CHECK(b == 4);
+		CHECK(allocator.GetBlockSize(b) == 1);
+
+		auto c = allocator.Alloc(16);
+		CHECK(c == 16);
+		CHECK(allocator.GetBlockSize(c) == 16);
+		CHECK(allocator.GetUsedCount() == 21);
+
+		// offsets inside a block or not allocated have no size
+		CHECK(allocator.GetBlockSize(1) == 0);
+		CHECK(allocator.GetBlockSize(64) == 0);
+	}
+
+	void TestMerge()
+	{
+		BuddyAllocator allocator;
+		CHECK(allocator.Init(16));
+
+		uint32_t offsets[16];
+		for (auto i = 0u; i < 16; ++i)
+		{
+			offsets[i] = allocator.Alloc(1);
+			CHECK(offsets[i] == i);
+		}
+		CHECK(allocator.Alloc(1) == BuddyAllocator::InvalidOffset);
+		CHECK(allocator.GetLargestFreeBlock() == 0);
+
+		// freeing every other index leaves only single free indices
+		for (auto i = 0u; i < 16; i += 2)
+		{
+			allocator.Free(offsets[i]);
+		}
+		CHECK(allocator.GetLargestFreeBlock() == 1);
+		CHECK(allocator.Alloc(2) == BuddyAllocator::InvalidOffset);
+
+		// freeing the rest merges the buddies back into one block
+		for (auto i = 1u; i < 16; i += 2)
+		{
+			allocator.Free(offsets[i]);
+		}
+		CHECK(allocator.GetUsedCount() == 0);
+		CHECK(allocator.GetLargestFreeBlock() == 16);
+		CHECK(allocator.Alloc(16) == 0);
+	}
+
+	void TestInvalidFree()
+	{
+		BuddyAllocator allocator;
+		CHECK(allocator.Init(32));
+
+		auto a = allocator.Alloc(8);
+		allocator.Free(a + 1);
+		allocator.Free(100);
+		CHECK(allocator.GetUsedCount() == 8);
+
+		allocator.Free(a);
+		allocator.Free(a);
+		CHECK(allocator.GetUsedCount() == 0);
+		CHECK(allocator.GetLargestFreeBlock() == 32);
+	}
+
+	void TestNonPowerOfTwoCapacity()
+	{
+		BuddyAllocator allocator;
+		CHECK(allocator.Init(6));
+
+		// blocks of 4 and 2, which are never merged past the capacity
+		CHECK(allocator.Alloc(4) == 0);
+		CHECK(allocator.Alloc(2) == 4);
+		CHECK(allocator.Alloc(1) == BuddyAllocator::InvalidOffset);
+
+		allocator.Free(4);
+		allocator.Free(0);
+		CHECK(allocator.GetLargestFreeBlock() == 4);
+		CHECK(allocator.Alloc(8) == BuddyAllocator::InvalidOffset);
+		CHECK(allocator.Alloc(1) != BuddyAllocator::InvalidOffset);
+	}
+
+	// random alloc / free keeping the invariants, then check that freeing everything
+	// restores the initial blocks (no fragmentation is left behind)
+	void TestFragmentationFuzz()
+	{
+		const uint32_t capacities[] = { 1, 7, 64, 1000, 4096 };
+		for (auto capacity : capacities)
+		{
+			for (uint64_t seed = 0; seed < 20; ++seed)
+			{
+				TestUtil::Random random(seed);
+				BuddyAllocator allocator;
+				CHECK(allocator.Init(capacity));
+				auto initialLargest = allocator.GetLargestFreeBlock();
+
+				std::map<uint32_t, uint32_t> alive;
+				std::vector<uint32_t> offsets;
+				for (auto step = 0; step < 2000; ++step)
+				{
+					if (offsets.empty() || random.Next(100) < 55)
+					{
+						auto count = 1 + random.Next(random.Next(2) ? 4 : capacity / 4 + 1);
+						auto largest = allocator.GetLargestFreeBlock();
+						auto offset = allocator.Alloc(count);
+						if (offset == BuddyAllocator::InvalidOffset)
+						{
+							// fails only when no free block is large enough
+							uint32_t size = 1;
+							while (size < count)
+							{
+								size <<= 1;
+							}
+							CHECK(largest < size);
+						}
+						else
+						{
+							CHECK(alive.find(offset) == alive.end());
+							alive[offset] = allocator.GetBlockSize(offset);
+							CHECK(alive[offset] >= count && alive[offset] < count * 2);
+							offsets.push_back(offset);
+						}
+					}
+					else
+					{
+						auto index = random.Next(uint32_t(offsets.size()));
+						auto offset = offsets[index];
+						offsets[index] = offsets.back();
+						offsets.pop_back();
+
+						allocator.Free(offset);
+						alive.erase(offset);
+						CHECK(allocator.GetBlockSize(offset) == 0);
+					}
+
+					if (!CHECK(CheckConsistency(allocator, alive)))
+					{
+						break;
+					}
+				}
+
+				for (auto offset : offsets)
+				{
+					allocator.Free(offset);
+				}
+				CHECK(allocator.GetUsedCount() == 0);
+				CHECK(allocator.GetLargestFreeBlock() == initialLargest);
+			}
+		}
+	}
+} // namespace
+
+int main()
+{
+	RUN_TEST(TestInit);
+	RUN_TEST(TestAllocRounding);
+	RUN_TEST(TestMerge);
+	RUN_TEST(TestInvalidFree);
+	RUN_TEST(TestNonPowerOfTwoCapacity);
+	RUN_TEST(TestFragmentationFuzz);
+	return TEST_RESULT();
+}
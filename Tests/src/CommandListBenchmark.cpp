@@ -0,0 +1,149 @@
+#include "CommandListPool.h"
+#include "ThreadPool.h"
+#include "TestUtil.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+namespace {
+	// lists the sample may record the scene into
+	const uint32_t MaxListCount = 14;
+
+	// draws one list takes at least (SampleApp::MinDrawsPerList)
+	const uint32_t MinDrawsPerList = 64;
+
+	//
+	// StubList class
+	//
+	// Stands in for a commandlist. Every call encodes a few dwords, with some work per dword
+	// like the runtime validating and packing the arguments.
+	//
+	class StubList
+	{
+	public:
+		void Clear()
+		{
+			m_Stream.clear();
+		}
+
+		void SetupPass()
+		{
+			for (uint32_t i = 0; i < 10; ++i)
+			{
+				Call(i, 4);
+			}
+		}
+
+		void DrawMesh(uint32_t index)
+		{
+			Call(100 + index, 4); // index and vertex buffers
+			Call(200 + index, 4); // descriptor tables
+			Call(300 + index, 8); // draw
+		}
+
+	private:
+		std::vector<uint32_t> m_Stream;
+
+		void Call(uint32_t op, int words)
+		{
+			for (auto i = 0; i < words; ++i)
+			{
+				auto value = op * 2654435761u + uint32_t(i);
+				for (auto k = 0; k < 40; ++k)
+				{
+					value = value * 1664525u + 1013904223u;
+				}
+				m_Stream.push_back(value);
+			}
+		}
+	};
+
+	// the draws of each list are contiguous, cover every draw once, and differ in count by one at most
+	void CheckSplit()
+	{
+		CHECK(GetRecordingListCount(0, MaxListCount, MinDrawsPerList) == 0);
+		CHECK(GetRecordingListCount(10, MaxListCount, MinDrawsPerList) == 1);
+		CHECK(GetRecordingListCount(200, MaxListCount, MinDrawsPerList) == 3);
+		CHECK(GetRecordingListCount(1000, MaxListCount, MinDrawsPerList) == MaxListCount);
+		CHECK(GetRecordingListCount(5, MaxListCount, 0) == 5);
+		CHECK(GetRecordingListCount(5, 0, MinDrawsPerList) == 0);
+
+		const uint32_t drawCounts[] = { 1, 7, 100, 1001 };
+		for (auto drawCount : drawCounts)
+		{
+			for (auto listCount = 1u; listCount <= std::min(drawCount, MaxListCount); ++listCount)
+			{
+				CHECK(GetRecordingBegin(drawCount, listCount, 0) == 0);
+				CHECK(GetRecordingBegin(drawCount, listCount, listCount) == drawCount);
+				for (auto i = 0u; i < listCount; ++i)
+				{
+					auto count = GetRecordingBegin(drawCount, listCount, i + 1) - GetRecordingBegin(drawCount, listCount, i);
+					CHECK(count == drawCount / listCount || count == drawCount / listCount + 1);
+				}
+			}
+		}
+	}
+
+	// best time of recording the draws into listCount lists, in microseconds
+	double Record(ThreadPool& pool, std::vector<StubList>& lists, uint32_t drawCount, uint32_t listCount, int repeatCount)
+	{
+		auto best = 1.0e30;
+		for (auto repeat = 0; repeat < repeatCount; ++repeat)
+		{
+			for (auto& list : lists)
+			{
+				list.Clear();
+			}
+
+			auto start = std::chrono::steady_clock::now();
+			pool.ParallelFor(listCount, [&](size_t i)
+			{
+				auto& list = lists[i];
+				list.SetupPass();
+
+				auto end = GetRecordingBegin(drawCount, listCount, uint32_t(i + 1));
+				for (auto draw = GetRecordingBegin(drawCount, listCount, uint32_t(i)); draw < end; ++draw)
+				{
+					list.DrawMesh(draw);
+				}
+			});
+			auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+			best = std::min(best, elapsed);
+		}
+		return best;
+	}
+} // namespace
+
+// recording cost against draw count, with one list and with the lists the sample splits the draws into.
+// --quick runs a few sizes once, to keep the program working under ctest
+int main(int argc, char** argv)
+{
+	auto isQuick = (argc > 1 && strcmp(argv[1], "--quick") == 0);
+
+	CheckSplit();
+
+	ThreadPool pool;
+	CHECK(pool.Init());
+	printf("threads %u\n", pool.GetThreadCount() + 1);
+
+	std::vector<StubList> lists(MaxListCount);
+	const uint32_t drawCounts[] = { 16, 64, 256, 1024, 4096, 16384 };
+	for (auto drawCount : drawCounts)
+	{
+		if (isQuick && drawCount > 1024)
+		{
+			break;
+		}
+
+		auto repeatCount = isQuick ? 1 : 20;
+		auto listCount = GetRecordingListCount(drawCount, MaxListCount, MinDrawsPerList);
+		auto single = Record(pool, lists, drawCount, 1, repeatCount);
+		auto split = Record(pool, lists, drawCount, listCount, repeatCount);
+		printf("draws %6u : 1 list %9.1f us, %2u lists %9.1f us (x%.2f)\n",
+			drawCount, single, listCount, split, single / split);
+	}
+
+	pool.Term();
+	return TEST_RESULT();
+}
@@ -0,0 +1,252 @@
+#include "CompileScheduler.h"
+#include "TestUtil.h"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+	//
+	// MockCompiler class
+	//
+	// Records the order of Compile() calls and the Finish() results. Compile() waits while the
+	// gate is closed, and fails the ids it is told to.
+	//
+	class MockCompiler : public PipelineCompiler
+	{
+	public:
+		MockCompiler()
+			: m_IsOpen(true)
+			, m_Running(0)
+			, m_MaxRunning(0)
+		{
+		}
+
+		bool Compile(uint32_t id) override
+		{
+			auto running = ++m_Running;
+			auto maxRunning = m_MaxRunning.load();
+			while (running > maxRunning && !m_MaxRunning.compare_exchange_weak(maxRunning, running))
+			{
+			}
+
+			while (!m_IsOpen)
+			{
+				std::this_thread::yield();
+			}
+
+			bool isFailed;
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				m_Order.push_back(id);
+				isFailed = std::find(m_FailIds.begin(), m_FailIds.end(), id) != m_FailIds.end();
+			}
+			m_Running--;
+			return !isFailed;
+		}
+
+		void Finish(uint32_t id, COMPILE_STATE state) override
+		{
+			m_Finished.push_back(std::make_pair(id, state));
+		}
+
+		void SetOpen(bool open)
+		{
+			m_IsOpen = open;
+		}
+
+		void Fail(uint32_t id)
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_FailIds.push_back(id);
+		}
+
+		std::vector<uint32_t> GetOrder()
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			return m_Order;
+		}
+
+		const std::vector<std::pair<uint32_t, COMPILE_STATE>>& GetFinished() const
+		{
+			return m_Finished;
+		}
+
+		int GetRunning() const
+		{
+			return m_Running;
+		}
+
+		int GetMaxRunning() const
+		{
+			return m_MaxRunning;
+		}
+
+	private:
+		std::atomic<bool> m_IsOpen;
+		std::atomic<int> m_Running;
+		std::atomic<int> m_MaxRunning;
+		std::mutex m_Mutex;
+		std::vector<uint32_t> m_Order;
+		std::vector<uint32_t> m_FailIds;
+		std::vector<std::pair<uint32_t, COMPILE_STATE>> m_Finished;
+	};
+
+	// higher priority first, request order within a priority, at most maxInFlight per Update()
+	void TestOrder()
+	{
+		ThreadPool inlinePool;
+		MockCompiler compiler;
+		CompileScheduler scheduler;
+		CHECK(!scheduler.Init(nullptr, &inlinePool, 2));
+		CHECK(scheduler.Init(&compiler, &inlinePool, 2));
+
+		auto a = scheduler.Request(10, 0);
+		auto b = scheduler.Request(11, 5);
+		auto c = scheduler.Request(12, 0);
+		auto d = scheduler.Request(13, 5);
+
+		// the same key shares the id while it is queued
+		CHECK(scheduler.Request(10, 9) == a);
+		CHECK(scheduler.GetState(a) == COMPILE_STATE_QUEUED);
+		CHECK(!scheduler.IsIdle());
+
+		std::vector<CompileScheduler::Result> results;
+		scheduler.Update(results);
+		CHECK(results.empty());
+		CHECK(compiler.GetOrder() == std::vector<uint32_t>({ b, d }));
+
+		scheduler.Update(results);
+		CHECK(results.size() == 2 && results[0].Id == b && results[1].Id == d);
+		CHECK(results[0].State == COMPILE_STATE_READY && results[1].State == COMPILE_STATE_READY);
+		CHECK(compiler.GetOrder() == std::vector<uint32_t>({ b, d, a, c }));
+
+		scheduler.Update(results);
+		CHECK(results.size() == 2);
+		CHECK(scheduler.IsIdle());
+
+		// a ready key is not compiled again
+		CHECK(scheduler.Request(11) == b);
+		CHECK(scheduler.GetState(b) == COMPILE_STATE_READY);
+		CHECK(compiler.GetFinished().size() == 4);
+		CHECK(scheduler.GetState(CompileScheduler::InvalidId) == COMPILE_STATE_FAILED);
+	}
+
+	// a failed key is queued again by the next request
+	void TestFailure()
+	{
+		ThreadPool inlinePool;
+		MockCompiler compiler;
+		CompileScheduler scheduler;
+		CHECK(scheduler.Init(&compiler, &inlinePool, 1));
+
+		std::vector<CompileScheduler::Result> results;
+		auto id = scheduler.Request(20);
+		compiler.Fail(id);
+		scheduler.Update(results);
+		scheduler.Update(results);
+		CHECK(results.size() == 1 && results[0].Id == id && results[0].State == COMPILE_STATE_FAILED);
+		CHECK(scheduler.GetState(id) == COMPILE_STATE_FAILED);
+
+		auto retry = scheduler.Request(20);
+		CHECK(retry != id);
+		scheduler.Update(results);
+		scheduler.Update(results);
+		CHECK(results.size() == 1 && results[0].Id == retry && results[0].State == COMPILE_STATE_READY);
+		CHECK(!scheduler.Cancel(retry));
+	}
+
+	// a queued request is canceled without compiling
+	void TestCancelQueued()
+	{
+		ThreadPool inlinePool;
+		MockCompiler compiler;
+		CompileScheduler scheduler;
+		CHECK(scheduler.Init(&compiler, &inlinePool, 4));
+
+		auto a = scheduler.Request(30);
+		auto b = scheduler.Request(31);
+		CHECK(scheduler.Cancel(b));
+		CHECK(!scheduler.Cancel(b));
+		CHECK(!scheduler.Cancel(CompileScheduler::InvalidId));
+		CHECK(scheduler.GetState(b) == COMPILE_STATE_CANCELED);
+
+		std::vector<CompileScheduler::Result> results;
+		scheduler.Update(results);
+		CHECK(results.size() == 1 && results[0].Id == b && results[0].State == COMPILE_STATE_CANCELED);
+		CHECK(compiler.GetOrder() == std::vector<uint32_t>({ a }));
+
+		// a canceled key gets a new request
+		auto again = scheduler.Request(31);
+		CHECK(again != b);
+		scheduler.Update(results);
+		scheduler.Update(results);
+		CHECK(scheduler.GetState(again) == COMPILE_STATE_READY);
+		CHECK(compiler.GetFinished().size() == 3);
+	}
+
+	// a request canceled while it compiles finishes as canceled, and the pool never runs more
+	// than maxInFlight at once
+	void TestCancelCompiling()
+	{
+		ThreadPool pool;
+		CHECK(pool.Init(4));
+
+		MockCompiler compiler;
+		compiler.SetOpen(false);
+		CompileScheduler scheduler;
+		CHECK(scheduler.Init(&compiler, &pool, 2));
+
+		std::vector<uint32_t> ids;
+		for (auto i = 0; i < 6; ++i)
+		{
+			ids.push_back(scheduler.Request(100 + i));
+		}
+
+		std::vector<CompileScheduler::Result> results;
+		scheduler.Update(results);
+		while (compiler.GetRunning() < 2)
+		{
+			std::this_thread::yield();
+		}
+
+		CHECK(scheduler.GetState(ids[0]) == COMPILE_STATE_COMPILING);
+		CHECK(scheduler.Cancel(ids[0]));
+		CHECK(scheduler.GetState(ids[0]) == COMPILE_STATE_CANCELED);
+		auto again = scheduler.Request(100);
+		CHECK(again != ids[0]);
+
+		compiler.SetOpen(true);
+		auto readyCount = 0;
+		auto canceledCount = 0;
+		while (!scheduler.IsIdle())
+		{
+			scheduler.Update(results);
+			for (const auto& result : results)
+			{
+				readyCount += (result.State == COMPILE_STATE_READY) ? 1 : 0;
+				canceledCount += (result.State == COMPILE_STATE_CANCELED) ? 1 : 0;
+				CHECK(result.Id != ids[0] || result.State == COMPILE_STATE_CANCELED);
+			}
+			std::this_thread::yield();
+		}
+
+		CHECK(readyCount == 6 && canceledCount == 1);
+		CHECK(compiler.GetMaxRunning() <= 2);
+		CHECK(scheduler.GetState(again) == COMPILE_STATE_READY);
+
+		scheduler.Term();
+		pool.Term();
+	}
+} // namespace
+
+int main()
+{
+	RUN_TEST(TestOrder);
+	RUN_TEST(TestFailure);
+	RUN_TEST(TestCancelQueued);
+	RUN_TEST(TestCancelCompiling);
+	return TEST_RESULT();
+}
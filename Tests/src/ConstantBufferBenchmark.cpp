@@ -0,0 +1,166 @@
+#include "ConstantBuffer.h"
+#include "DescriptorPool.h"
+#include "FrameUploadAllocator.h"
+#include "FakeDevice.h"
+#include "TestUtil.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace {
+	// frames in flight of the sample
+	const uint32_t FrameCount = 2;
+
+	// per-object constants, like the world, view and projection matrices of a mesh
+	struct Transform
+	{
+		float Matrix[3][16];
+	};
+
+	double GetMicroseconds(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	void Fill(Transform& transform, uint32_t index)
+	{
+		for (auto i = 0; i < 3; ++i)
+		{
+			for (auto j = 0; j < 16; ++j)
+			{
+				transform.Matrix[i][j] = float(index + j);
+			}
+		}
+	}
+
+	//
+	// Result structure
+	//
+	struct Result
+	{
+		double SetupTime; //!< creation time in microseconds
+		double FrameTime; //!< best time of writing the constants of one frame in microseconds
+		int ResourceCount; //!< committed resources created
+	};
+
+	// one ConstantBuffer per object and frame, as SampleApp and Material create them
+	Result RunPerObject(uint32_t objectCount, int repeatCount)
+	{
+		auto pDevice = new Fake::Device();
+		Result result = {};
+
+		// every buffer takes a view from the pool
+		D3D12_DESCRIPTOR_HEAP_DESC desc = {};
+		desc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+		desc.NumDescriptors = objectCount * FrameCount;
+		desc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+
+		DescriptorPool* pPool = nullptr;
+		CHECK(DescriptorPool::Create(pDevice, &desc, &pPool));
+
+		auto start = std::chrono::steady_clock::now();
+		std::vector<std::unique_ptr<ConstantBuffer>> buffers(objectCount * FrameCount);
+		for (auto& pBuffer : buffers)
+		{
+			pBuffer.reset(new ConstantBuffer());
+			CHECK(pBuffer->Init(pDevice, pPool, sizeof(Transform)));
+		}
+		result.SetupTime = GetMicroseconds(start);
+		result.ResourceCount = pDevice->GetResourceCount();
+
+		result.FrameTime = 1.0e30;
+		D3D12_GPU_VIRTUAL_ADDRESS sum = 0;
+		for (auto repeat = 0; repeat < repeatCount; ++repeat)
+		{
+			auto frameIndex = uint32_t(repeat) % FrameCount;
+			start = std::chrono::steady_clock::now();
+			for (auto i = 0u; i < objectCount; ++i)
+			{
+				auto& pBuffer = buffers[frameIndex * objectCount + i];
+				Fill(*pBuffer->GetPtr<Transform>(), i);
+				sum += pBuffer->GetAddress();
+			}
+			result.FrameTime = std::min(result.FrameTime, GetMicroseconds(start));
+		}
+		CHECK(sum != 0);
+
+		buffers.clear();
+		pPool->Release();
+		pDevice->Release();
+		return result;
+	}
+
+	// one FrameUploadAllocator, each object pushing its constants every frame
+	Result RunFrameUpload(uint32_t objectCount, int repeatCount)
+	{
+		auto pDevice = new Fake::Device();
+		Result result = {};
+
+		auto start = std::chrono::steady_clock::now();
+		FrameUploadAllocator allocator;
+		CHECK(allocator.Init(pDevice, FrameCount, uint64_t(objectCount) * D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT));
+		result.SetupTime = GetMicroseconds(start);
+		result.ResourceCount = pDevice->GetResourceCount();
+
+		result.FrameTime = 1.0e30;
+		D3D12_GPU_VIRTUAL_ADDRESS sum = 0;
+		for (auto repeat = 0; repeat < repeatCount; ++repeat)
+		{
+			start = std::chrono::steady_clock::now();
+			allocator.Begin(uint32_t(repeat) % FrameCount);
+			for (auto i = 0u; i < objectCount; ++i)
+			{
+				auto allocation = allocator.Alloc(sizeof(Transform));
+				Fill(*allocation.GetPtr<Transform>(), i);
+				sum += allocation.AddressGPU;
+			}
+			result.FrameTime = std::min(result.FrameTime, GetMicroseconds(start));
+		}
+		CHECK(sum != 0);
+
+		allocator.Term();
+		pDevice->Release();
+		return result;
+	}
+} // namespace
+
+// per-object ConstantBuffer against FrameUploadAllocator, for 64 to 16384 objects. the fake device
+// allocates host memory, so the setup time leaves out the kernel call a committed resource costs;
+// the memory column counts the 64KB each committed buffer takes on a real heap.
+// --quick runs the small counts once, to keep the program working under ctest
+int main(int argc, char** argv)
+{
+	auto isQuick = (argc > 1 && strcmp(argv[1], "--quick") == 0);
+	auto repeatCount = isQuick ? 2 : 50;
+
+	const uint32_t objectCounts[] = { 64, 256, 1024, 4096, 16384 };
+	for (auto objectCount : objectCounts)
+	{
+		if (isQuick && objectCount > 256)
+		{
+			break;
+		}
+
+		auto perObject = RunPerObject(objectCount, repeatCount);
+		auto frameUpload = RunFrameUpload(objectCount, repeatCount);
+
+		// committed buffers are placed with 64KB alignment, the frame buffers are rounded up to it
+		auto perObjectBytes = uint64_t(perObject.ResourceCount) * D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+		auto frameBytes = uint64_t(objectCount) * D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT;
+		frameBytes = (frameBytes + D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT - 1) / D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT * D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+		auto frameUploadBytes = frameBytes * FrameCount;
+
+		printf("objects %5u : ConstantBuffer %5d resources %8.1f MB setup %9.1f us frame %8.1f us | FrameUploadAllocator %d resources %6.1f MB setup %7.1f us frame %8.1f us\n",
+			objectCount,
+			perObject.ResourceCount, double(perObjectBytes) / (1024.0 * 1024.0), perObject.SetupTime, perObject.FrameTime,
+			frameUpload.ResourceCount, double(frameUploadBytes) / (1024.0 * 1024.0), frameUpload.SetupTime, frameUpload.FrameTime);
+
+		CHECK(perObject.ResourceCount == int(objectCount * FrameCount));
+		CHECK(frameUpload.ResourceCount == int(FrameCount));
+	}
+
+	CHECK(Fake::LiveCount() == 0);
+	return TEST_RESULT();
+}
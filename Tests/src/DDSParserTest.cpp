@@ -0,0 +1,351 @@
+#include "DDSParser.h"
+#include "MappedFile.h"
+#include "TestUtil.h"
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+	// Constant values.
+	const uint32_t DDSD_MIPMAPCOUNT = 0x00020000;
+	const uint32_t DDSD_DEPTH = 0x00800000;
+	const uint32_t DDPF_FOURCC = 0x00000004;
+	const uint32_t DDPF_RGB = 0x00000040;
+	const uint32_t DDSCAPS2_CUBEMAP_ALLFACES = 0x0000fe00;
+	const uint32_t DDS_MISC_TEXTURECUBE = 0x4;
+
+	constexpr uint32_t FourCC(char a, char b, char c, char d)
+	{
+		return uint32_t(uint8_t(a)) | (uint32_t(uint8_t(b)) << 8) | (uint32_t(uint8_t(c)) << 16) | (uint32_t(uint8_t(d)) << 24);
+	}
+
+	//
+	// FileDesc structure
+	//
+	// Header fields of a DDS file written by MakeDDS().
+	//
+	struct FileDesc
+	{
+		uint32_t Width;
+		uint32_t Height;
+		uint32_t Depth; //!< written with DDSD_DEPTH when not 0
+		uint32_t MipCount; //!< written with DDSD_MIPMAPCOUNT when not 0
+		uint32_t FourCC; //!< 0 for the 32 bit RGBA mask format
+		uint32_t Caps2;
+		bool HasDX10; //!< whether the DX10 header follows
+		DXGI_FORMAT Format; //!< format of the DX10 header
+		uint32_t Dimension; //!< dimension of the DX10 header
+		uint32_t MiscFlag; //!< misc flag of the DX10 header
+		uint32_t ArraySize; //!< array size of the DX10 header
+	};
+
+	// write a DDS header followed by the data size given, filled with a counting pattern
+	std::vector<uint8_t> MakeDDS(const FileDesc& desc, size_t dataSize)
+	{
+		uint32_t header[32] = {};
+		header[0] = FourCC('D', 'D', 'S', ' ');
+		header[1] = 124;
+		header[2] = 0x1007 | (desc.MipCount ? DDSD_MIPMAPCOUNT : 0) | (desc.Depth ? DDSD_DEPTH : 0);
+		header[3] = desc.Height;
+		header[4] = desc.Width;
+		header[6] = desc.Depth;
+		header[7] = desc.MipCount;
+		header[19] = 32;
+		if (desc.HasDX10 || desc.FourCC != 0)
+		{
+			header[20] = DDPF_FOURCC;
+			header[21] = desc.HasDX10 ? FourCC('D', 'X', '1', '0') : desc.FourCC;
+		}
+		else
+		{
+			header[20] = DDPF_RGB;
+			header[22] = 32;
+			header[23] = 0x000000ff;
+			header[24] = 0x0000ff00;
+			header[25] = 0x00ff0000;
+			header[26] = 0xff000000;
+		}
+		header[28] = desc.Caps2;
+
+		std::vector<uint8_t> file(sizeof(header));
+		memcpy(file.data(), header, sizeof(header));
+		if (desc.HasDX10)
+		{
+			uint32_t ext[5] = { uint32_t(desc.Format), desc.Dimension, desc.MiscFlag, desc.ArraySize, 0 };
+			auto offset = file.size();
+			file.resize(offset + sizeof(ext));
+			memcpy(file.data() + offset, ext, sizeof(ext));
+		}
+
+		for (size_t i = 0; i < dataSize; ++i)
+		{
+			file.push_back(uint8_t(i * 7));
+		}
+		return file;
+	}
+
+	FileDesc MakeDesc(uint32_t width, uint32_t height, uint32_t mipCount)
+	{
+		FileDesc desc = {};
+		desc.Width = width;
+		desc.Height = height;
+		desc.MipCount = mipCount;
+		return desc;
+	}
+
+	void TestLegacyRGBA()
+	{
+		// 8x4 RGBA with 4 mips: 128 + 32 + 8 + 4 bytes
+		auto file = MakeDDS(MakeDesc(8, 4, 4), 172);
+
+		DDSInfo info;
+		CHECK(ParseDDS(file.data(), file.size(), info));
+		CHECK(info.Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE2D);
+		CHECK(info.Format == DXGI_FORMAT_R8G8B8A8_UNORM);
+		CHECK(info.Width == 8 && info.Height == 4 && info.Depth == 1);
+		CHECK(info.MipCount == 4 && info.ArraySize == 1 && !info.IsCube);
+		CHECK(info.Subresources.size() == 4);
+
+		const size_t sizes[] = { 128, 32, 8, 4 };
+		size_t offset = 128;
+		for (auto i = 0; i < 4; ++i)
+		{
+			const auto& sub = info.Subresources[i];
+			CHECK(sub.Offset == offset);
+			CHECK(sub.Size == sizes[i]);
+			CHECK(sub.RowPitch * sub.RowCount == sub.Size);
+			offset += sub.Size;
+		}
+		CHECK(info.Subresources[3].Width == 1 && info.Subresources[3].Height == 1);
+
+		// one byte short of the last mip
+		CHECK(!ParseDDS(file.data(), file.size() - 1, info));
+		CHECK(info.Subresources.empty());
+	}
+
+	void TestBlockCompressed()
+	{
+		// 16x16 DXT1 with 5 mips: blocks of 8 bytes, at least one block per mip
+		auto desc = MakeDesc(16, 16, 5);
+		desc.FourCC = FourCC('D', 'X', 'T', '1');
+		auto file = MakeDDS(desc, 128 + 32 + 8 + 8 + 8);
+
+		DDSInfo info;
+		CHECK(ParseDDS(file.data(), file.size(), info));
+		CHECK(info.Format == DXGI_FORMAT_BC1_UNORM);
+		CHECK(IsBlockCompressed(info.Format));
+		CHECK(info.Subresources[0].RowPitch == 32 && info.Subresources[0].RowCount == 4);
+		CHECK(info.Subresources[4].Size == 8);
+
+		uint32_t rowPitch = 0;
+		uint32_t rowCount = 0;
+		CHECK(GetSurfaceInfo(5, 3, DXGI_FORMAT_BC3_UNORM, rowPitch, rowCount));
+		CHECK(rowPitch == 32 && rowCount == 1);
+		CHECK(!GetSurfaceInfo(4, 4, DXGI_FORMAT_UNKNOWN, rowPitch, rowCount));
+	}
+
+	// parse a texture of the sample and check it against its format and mip chain
+	void CheckSampleFile(const wchar_t* name, DXGI_FORMAT format, uint32_t blockBytes)
+	{
+		std::wstring path = SAMPLE_RES_DIR L"/material_test/";
+		path += name;
+
+		MappedFile file;
+		if (!CHECK(file.Open(path.c_str())))
+		{
+			printf("  %ls not found\n", path.c_str());
+			return;
+		}
+
+		DDSInfo info;
+		if (!CHECK(ParseDDS(file.GetData(), file.GetSize(), info)))
+		{
+			return;
+		}
+
+		CHECK(info.Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE2D);
+		CHECK(info.Format == format);
+		CHECK(info.Width == 1024 && info.Height == 1024 && info.Depth == 1);
+		CHECK(info.MipCount == 11 && info.ArraySize == 1 && !info.IsCube);
+		if (!CHECK(info.Subresources.size() == 11))
+		{
+			return;
+		}
+
+		// mips follow the 128 byte header back to back and end with the file
+		auto isBC = IsBlockCompressed(format);
+		size_t offset = 128;
+		for (uint32_t mip = 0; mip < 11; ++mip)
+		{
+			const auto& sub = info.Subresources[mip];
+			auto size = 1024u >> mip;
+			auto units = isBC ? std::max(1u, size / 4) : size;
+
+			CHECK(sub.Width == size && sub.Height == size);
+			CHECK(sub.Offset == offset);
+			CHECK(sub.RowPitch == units * blockBytes && sub.RowCount == units);
+			CHECK(sub.Size == size_t(units) * units * blockBytes);
+			offset += sub.Size;
+		}
+		CHECK(offset == file.GetSize());
+	}
+
+	// textures of the sample: BC1 base colors, BC3 normals and L8 metalness and roughness
+	void TestSampleFiles()
+	{
+		CheckSampleFile(L"wall_bc.dds", DXGI_FORMAT_BC1_UNORM, 8);
+		CheckSampleFile(L"matball_bc.dds", DXGI_FORMAT_BC1_UNORM, 8);
+		CheckSampleFile(L"wall_n.dds", DXGI_FORMAT_BC3_UNORM, 16);
+		CheckSampleFile(L"matball_n.dds", DXGI_FORMAT_BC3_UNORM, 16);
+		CheckSampleFile(L"wall_m.dds", DXGI_FORMAT_R8_UNORM, 1);
+		CheckSampleFile(L"wall_r.dds", DXGI_FORMAT_R8_UNORM, 1);
+		CheckSampleFile(L"matball_m.dds", DXGI_FORMAT_R8_UNORM, 1);
+		CheckSampleFile(L"matball_r.dds", DXGI_FORMAT_R8_UNORM, 1);
+
+		// spot values of the BC1 chain: the 8x8 mip is 2x2 blocks, the last 3 mips one block each
+		MappedFile file;
+		DDSInfo info;
+		std::wstring path = SAMPLE_RES_DIR L"/material_test/wall_bc.dds";
+		if (CHECK(file.Open(path.c_str())) && CHECK(ParseDDS(file.GetData(), file.GetSize(), info)))
+		{
+			CHECK(info.Subresources[1].Offset == 128 + 524288);
+			CHECK(info.Subresources[7].Size == 32);
+			CHECK(info.Subresources[10].Offset == 699192 - 8 && info.Subresources[10].Size == 8);
+		}
+	}
+
+	void TestDX10()
+	{
+		// array of 2 cubes, 4x4 R16G16B16A16_FLOAT with 3 mips: 128 + 32 + 8 bytes per face
+		FileDesc desc = MakeDesc(4, 4, 3);
+		desc.HasDX10 = true;
+		desc.Format = DXGI_FORMAT_R16G16B16A16_FLOAT;
+		desc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+		desc.MiscFlag = DDS_MISC_TEXTURECUBE;
+		desc.ArraySize = 2;
+		auto file = MakeDDS(desc, 12 * 168);
+
+		DDSInfo info;
+		CHECK(ParseDDS(file.data(), file.size(), info));
+		CHECK(info.IsCube && info.ArraySize == 12);
+		CHECK(info.Subresources.size() == 36);
+
+		// every mip of a slice comes before the next slice
+		CHECK(info.Subresources[3].Offset == 148 + 168);
+		CHECK(info.Subresources[3].Width == 4);
+
+		// 3D texture
+		desc = MakeDesc(8, 8, 1);
+		desc.Depth = 4;
+		desc.HasDX10 = true;
+		desc.Format = DXGI_FORMAT_R8_UNORM;
+		desc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE3D;
+		desc.ArraySize = 1;
+		file = MakeDDS(desc, 256);
+		CHECK(ParseDDS(file.data(), file.size(), info));
+		CHECK(info.Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE3D);
+		CHECK(info.Depth == 4 && info.Subresources[0].SlicePitch == 64 && info.Subresources[0].Size == 256);
+
+		auto resource = GetDDSResourceDesc(info);
+		CHECK(resource.DepthOrArraySize == 4 && resource.MipLevels == 1);
+	}
+
+	void TestInvalid()
+	{
+		DDSInfo info;
+		CHECK(!ParseDDS(nullptr, 0, info));
+
+		auto file = MakeDDS(MakeDesc(4, 4, 1), 64);
+		CHECK(!ParseDDS(file.data(), 100, info));
+
+		auto bad = file;
+		bad[0] = 'X';
+		CHECK(!ParseDDS(bad.data(), bad.size(), info));
+
+		// more mips than the chain has
+		file = MakeDDS(MakeDesc(4, 4, 4), 1024);
+		CHECK(!ParseDDS(file.data(), file.size(), info));
+
+		// zero size
+		file = MakeDDS(MakeDesc(0, 4, 1), 1024);
+		CHECK(!ParseDDS(file.data(), file.size(), info));
+
+		// partial cube
+		auto desc = MakeDesc(4, 4, 1);
+		desc.Caps2 = 0x00000200 | 0x00000400;
+		file = MakeDDS(desc, 1024);
+		CHECK(!ParseDDS(file.data(), file.size(), info));
+
+		desc.Caps2 = DDSCAPS2_CUBEMAP_ALLFACES;
+		file = MakeDDS(desc, 6 * 64);
+		CHECK(ParseDDS(file.data(), file.size(), info));
+		CHECK(info.IsCube && info.ArraySize == 6);
+
+		// unknown four character code
+		desc = MakeDesc(4, 4, 1);
+		desc.FourCC = FourCC('A', 'B', 'C', 'D');
+		file = MakeDDS(desc, 1024);
+		CHECK(!ParseDDS(file.data(), file.size(), info));
+
+		// DX10 array of size 0
+		desc = MakeDesc(4, 4, 1);
+		desc.HasDX10 = true;
+		desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+		desc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+		file = MakeDDS(desc, 1024);
+		CHECK(!ParseDDS(file.data(), file.size(), info));
+	}
+
+	void TestFootprints()
+	{
+		// 20x8 RGBA: rows of 80 bytes are padded to 256 in the staging buffer
+		auto file = MakeDDS(MakeDesc(20, 8, 3), 640 + 160 + 40);
+
+		DDSInfo info;
+		CHECK(ParseDDS(file.data(), file.size(), info));
+
+		auto desc = GetDDSResourceDesc(info, 1);
+		CHECK(desc.Width == 10 && desc.Height == 4 && desc.MipLevels == 2);
+		CHECK(GetDDSResourceDesc(info, 3).MipLevels == 0);
+
+		std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> layouts;
+		auto end = GetDDSFootprints(info, 0, 100, layouts);
+		CHECK(layouts.size() == 3);
+		for (size_t i = 0; i < layouts.size(); ++i)
+		{
+			CHECK(layouts[i].Offset % D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT == 0);
+			CHECK(layouts[i].Footprint.RowPitch % D3D12_TEXTURE_DATA_PITCH_ALIGNMENT == 0);
+			CHECK(layouts[i].Footprint.RowPitch >= info.Subresources[i].RowPitch);
+			CHECK(i == 0 || layouts[i].Offset >= layouts[i - 1].Offset + UINT64(layouts[i - 1].Footprint.RowPitch) * info.Subresources[i - 1].RowCount);
+		}
+		CHECK(layouts[0].Offset == 512);
+		CHECK(end == layouts[2].Offset + 256 * 2);
+
+		CHECK(GetDDSFootprints(info, 3, 100, layouts) == 100);
+		CHECK(layouts.empty());
+
+		// each row lands at its padded position
+		GetDDSFootprints(info, 0, 0, layouts);
+		std::vector<uint8_t> staging(size_t(end), 0);
+		CopyDDSSubresource(file.data(), info.Subresources[0], layouts[0], staging.data());
+		for (auto y = 0u; y < 8; ++y)
+		{
+			auto pSrc = file.data() + info.Subresources[0].Offset + 80 * y;
+			auto pDst = staging.data() + layouts[0].Offset + 256 * y;
+			CHECK(memcmp(pSrc, pDst, 80) == 0);
+			CHECK(pDst[80] == 0);
+		}
+	}
+} // namespace
+
+int main()
+{
+	RUN_TEST(TestLegacyRGBA);
+	RUN_TEST(TestBlockCompressed);
+	RUN_TEST(TestSampleFiles);
+	RUN_TEST(TestDX10);
+	RUN_TEST(TestInvalid);
+	RUN_TEST(TestFootprints);
+	return TEST_RESULT();
+}
@@ -0,0 +1,236 @@
+#include "DeferredReleaseQueue.h"
+#include "DescriptorPool.h"
+#include "FakeDevice.h"
+#include "TestUtil.h"
+#include <thread>
+#include <vector>
+
+namespace {
+	// completed value of the fake GPU, which objects check when they are released
+	std::atomic<uint64_t> g_Completed(0);
+	std::atomic<int> g_Released(0);
+	std::atomic<int> g_Early(0);
+
+	//
+	// TaggedObject class
+	//
+	// Object which records whether it was released before the fence value of its last use.
+	//
+	class TaggedObject : public Fake::Object<IUnknown>
+	{
+	public:
+		explicit TaggedObject(uint64_t fenceValue)
+			: m_FenceValue(fenceValue)
+		{
+		}
+
+		~TaggedObject()
+		{
+			if (g_Completed.load() < m_FenceValue)
+			{
+				g_Early++;
+			}
+			g_Released++;
+		}
+
+	private:
+		uint64_t m_FenceValue;
+	};
+
+	DescriptorPool* CreatePool(ID3D12Device* pDevice, uint32_t count)
+	{
+		D3D12_DESCRIPTOR_HEAP_DESC desc = {};
+		desc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+		desc.NumDescriptors = count;
+		desc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+
+		DescriptorPool* pPool = nullptr;
+		if (!DescriptorPool::Create(pDevice, &desc, &pPool))
+		{
+			return nullptr;
+		}
+		return pPool;
+	}
+
+	void Reset()
+	{
+		g_Completed = 0;
+		g_Released = 0;
+		g_Early = 0;
+	}
+
+	void TestOrder()
+	{
+		Reset();
+
+		DeferredReleaseQueue queue;
+		queue.SetFenceValue(1);
+		CHECK(queue.GetFenceValue() == 1);
+
+		for (uint64_t value = 1; value <= 5; ++value)
+		{
+			CHECK(queue.Push(new TaggedObject(value), value));
+		}
+		CHECK(queue.Push(nullptr));
+		CHECK(queue.GetPendingCount() == 5);
+
+		// nothing has completed yet
+		CHECK(queue.Collect(0) == 0);
+		CHECK(g_Released == 0);
+
+		g_Completed = 2;
+		CHECK(queue.Collect(2) == 2);
+		CHECK(queue.GetPendingCount() == 3);
+
+		// entries without a value take the value of the frame being recorded
+		queue.SetFenceValue(4);
+		int called = 0;
+		CHECK(queue.PushCallback([&called]() { called++; }));
+		CHECK(queue.Push(new TaggedObject(4)));
+
+		g_Completed = 3;
+		CHECK(queue.Collect(3) == 1);
+		CHECK(called == 0);
+
+		g_Completed = 5;
+		CHECK(queue.Collect(5) == 4);
+		CHECK(called == 1);
+		CHECK(queue.GetPendingCount() == 0);
+		CHECK(g_Released == 6);
+		CHECK(g_Early == 0);
+	}
+
+	void TestTerm()
+	{
+		Reset();
+
+		{
+			DeferredReleaseQueue queue;
+			queue.SetFenceValue(10);
+			CHECK(queue.Push(new TaggedObject(0)));
+			CHECK(queue.Push(new TaggedObject(0), 20));
+
+			// Term() and the destructor release everything, the GPU being idle
+			queue.Term();
+			CHECK(queue.GetPendingCount() == 0);
+			CHECK(queue.GetFenceValue() == 0);
+			CHECK(g_Released == 2);
+
+			CHECK(queue.Push(new TaggedObject(0), 30));
+		}
+		CHECK(g_Released == 3);
+	}
+
+	void TestHandle()
+	{
+		Reset();
+
+		auto pDevice = new Fake::Device();
+		auto pPool = CreatePool(pDevice, 4);
+		if (!CHECK(pPool != nullptr))
+		{
+			pDevice->Release();
+			return;
+		}
+
+		DeferredReleaseQueue queue;
+		queue.SetFenceValue(1);
+
+		auto pHandle = pPool->AllocHandle();
+		CHECK(pHandle != nullptr);
+		CHECK(pPool->GetAllocatedHandleCount() == 1);
+
+		// the queue keeps the pool alive until the handle is freed
+		auto refCount = pPool->GetCount();
+		CHECK(queue.PushHandle(pPool, pHandle));
+		CHECK(pPool->GetCount() == refCount + 1);
+
+		CHECK(queue.Collect(0) == 0);
+		CHECK(pPool->GetAllocatedHandleCount() == 1);
+
+		CHECK(queue.Collect(1) == 1);
+		CHECK(pPool->GetAllocatedHandleCount() == 0);
+		CHECK(pPool->GetCount() == refCount);
+
+		// the pool may be released by its owner first
+		pHandle = pPool->AllocHandle();
+		CHECK(queue.PushHandle(pPool, pHandle, 2));
+		pPool->Release();
+		CHECK(queue.Collect(2) == 1);
+
+		pDevice->Release();
+		CHECK(Fake::LiveCount() == 0);
+	}
+
+	// producers push from several threads while the consumer advances the fence
+	void TestThreads()
+	{
+		Reset();
+
+		const int ThreadCount = 4;
+		const int PushCount = 20000;
+
+		DeferredReleaseQueue queue;
+		queue.SetFenceValue(1);
+
+		std::atomic<int> running(ThreadCount);
+		std::vector<std::thread> threads;
+		for (auto i = 0; i < ThreadCount; ++i)
+		{
+			threads.emplace_back([&queue, &running, PushCount]()
+			{
+				for (auto j = 0; j < PushCount; ++j)
+				{
+					// the value is read before the entry is pushed, so it may be one frame old
+					auto value = queue.GetFenceValue();
+					if (j % 2 == 0)
+					{
+						queue.Push(new TaggedObject(value), value);
+					}
+					else
+					{
+						queue.PushCallback([value]()
+						{
+							if (g_Completed.load() < value)
+							{
+								g_Early++;
+							}
+							g_Released++;
+						}, value);
+					}
+				}
+				running--;
+			});
+		}
+
+		// two frames in flight: the frame two behind the one being recorded has completed
+		uint64_t frame = 1;
+		while (running > 0)
+		{
+			frame++;
+			queue.SetFenceValue(frame);
+			g_Completed = frame - 2;
+			queue.Collect(frame - 2);
+		}
+
+		for (auto& thread : threads)
+		{
+			thread.join();
+		}
+
+		g_Completed = UINT64_MAX;
+		queue.Collect(UINT64_MAX);
+		CHECK(queue.GetPendingCount() == 0);
+		CHECK(g_Released == ThreadCount * PushCount);
+		CHECK(g_Early == 0);
+	}
+} // namespace
+
+int main()
+{
+	RUN_TEST(TestOrder);
+	RUN_TEST(TestTerm);
+	RUN_TEST(TestHandle);
+	RUN_TEST(TestThreads);
+	return TEST_RESULT();
+}
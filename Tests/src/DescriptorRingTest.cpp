@@ -0,0 +1,182 @@
+#include "DescriptorRing.h"
+#include "FakeDevice.h"
+#include "TestUtil.h"
+#include <deque>
+#include <vector>
+
+namespace {
+	void TestRing()
+	{
+		RingAllocator ring;
+		CHECK(!ring.Init(0));
+		CHECK(ring.Init(10));
+		CHECK(ring.GetCapacity() == 10);
+
+		CHECK(ring.Alloc(0) == RingAllocator::InvalidOffset);
+		CHECK(ring.Alloc(11) == RingAllocator::InvalidOffset);
+
+		CHECK(ring.Alloc(4) == 0);
+		CHECK(ring.Alloc(4) == 4);
+		ring.FinishFrame(1);
+
+		// 3 indices do not fit before the end, and the front is still in use
+		CHECK(ring.Alloc(3) == RingAllocator::InvalidOffset);
+		CHECK(ring.GetUsedCount() == 8);
+
+		// the tail is skipped once the front is free again
+		ring.Retire(0);
+		CHECK(ring.GetUsedCount() == 8);
+		ring.Retire(1);
+		CHECK(ring.GetUsedCount() == 0);
+		CHECK(ring.Alloc(3) == 0);
+		CHECK(ring.GetUsedCount() == 5);
+		ring.FinishFrame(2);
+
+		// an empty frame is not recorded, so it retires nothing
+		ring.FinishFrame(3);
+		CHECK(ring.Alloc(5) == 3);
+		ring.FinishFrame(4);
+		CHECK(ring.GetUsedCount() == 10);
+		CHECK(ring.Alloc(1) == RingAllocator::InvalidOffset);
+
+		ring.Retire(3);
+		CHECK(ring.GetUsedCount() == 5);
+		ring.Retire(4);
+		CHECK(ring.GetUsedCount() == 0);
+
+		ring.Term();
+		CHECK(ring.GetCapacity() == 0);
+		CHECK(ring.Alloc(1) == RingAllocator::InvalidOffset);
+	}
+
+	// frames retire with the values a fake fence completes, and their indices never overlap a frame in flight
+	void TestFuzz()
+	{
+		for (uint64_t seed = 0; seed < 50; ++seed)
+		{
+			TestUtil::Random random(seed);
+
+			const uint32_t Capacity = 64 + random.Next(512);
+			RingAllocator ring;
+			CHECK(ring.Init(Capacity));
+
+			auto pFence = new Fake::Fence(0);
+
+			// owner frame of every index, and the frames in flight
+			std::vector<uint64_t> owner(Capacity, 0);
+			std::deque<uint64_t> inFlight;
+			uint64_t frameValue = 1;
+
+			for (auto frame = 0; frame < 300; ++frame)
+			{
+				auto count = random.Next(8);
+				for (auto i = 0u; i < count; ++i)
+				{
+					auto size = 1 + random.Next(Capacity / 8);
+					auto offset = ring.Alloc(size);
+					if (offset == RingAllocator::InvalidOffset)
+					{
+						continue;
+					}
+
+					for (auto j = offset; j < offset + size; ++j)
+					{
+						if (!CHECK(j < Capacity) || !CHECK(owner[j] == 0 || owner[j] <= pFence->GetCompletedValue()))
+						{
+							pFence->Release();
+							return;
+						}
+						owner[j] = frameValue;
+					}
+				}
+
+				ring.FinishFrame(frameValue);
+				inFlight.push_back(frameValue);
+				frameValue++;
+
+				// the GPU keeps up to three frames in flight, finishing one or two at a time
+				while (inFlight.size() > 3 || (!inFlight.empty() && random.Next(3) == 0))
+				{
+					pFence->SetCompletedValue(inFlight.front());
+					inFlight.pop_front();
+				}
+				ring.Retire(pFence->GetCompletedValue());
+
+				if (inFlight.empty())
+				{
+					CHECK(ring.GetUsedCount() == 0);
+				}
+				CHECK(ring.GetUsedCount() <= Capacity);
+			}
+
+			pFence->Release();
+		}
+	}
+
+	void TestDescriptorRing()
+	{
+		auto pDevice = new Fake::Device();
+
+		D3D12_DESCRIPTOR_HEAP_DESC desc = {};
+		desc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+		desc.NumDescriptors = 64;
+		desc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+
+		DescriptorPool* pPool = nullptr;
+		CHECK(DescriptorPool::Create(pDevice, &desc, 32, &pPool));
+		auto pFence = new Fake::Fence(0);
+
+		{
+			DescriptorRing ring;
+			CHECK(!ring.Init(nullptr, 8));
+			CHECK(ring.Init(pPool, 16));
+
+			// descriptors are contiguous handles of the range region
+			auto first = ring.Alloc(4);
+			auto second = ring.Alloc();
+			CHECK(first.HandleCPU.ptr != 0 && first.HandleGPU.ptr != 0);
+			CHECK(second.HandleCPU.ptr == first.HandleCPU.ptr + 4 * Fake::Device::DescriptorSize);
+			CHECK(second.HandleGPU.ptr == first.HandleGPU.ptr + 4 * Fake::Device::DescriptorSize);
+			ring.FinishFrame(1);
+
+			// the ring is full until the frame's fence value completes
+			CHECK(ring.Alloc(11).HandleCPU.ptr == second.HandleCPU.ptr + Fake::Device::DescriptorSize);
+			ring.FinishFrame(2);
+			CHECK(ring.Alloc().HandleCPU.ptr == 0);
+
+			ring.Retire(pFence->GetCompletedValue());
+			CHECK(ring.Alloc().HandleCPU.ptr == 0);
+
+			pFence->SetCompletedValue(1);
+			ring.Retire(pFence->GetCompletedValue());
+			CHECK(ring.Alloc(5).HandleCPU.ptr == first.HandleCPU.ptr);
+
+			ring.Term();
+			CHECK(ring.Alloc().HandleCPU.ptr == 0);
+		}
+
+		// a pool without a range region can not hold a ring
+		{
+			DescriptorPool* pSmall = nullptr;
+			CHECK(DescriptorPool::Create(pDevice, &desc, &pSmall));
+
+			DescriptorRing ring;
+			CHECK(!ring.Init(pSmall, 8));
+			ring.Term();
+			pSmall->Release();
+		}
+
+		pFence->Release();
+		pPool->Release();
+		pDevice->Release();
+		CHECK(Fake::LiveCount() == 0);
+	}
+} // namespace
+
+int main()
+{
+	RUN_TEST(TestRing);
+	RUN_TEST(TestFuzz);
+	RUN_TEST(TestDescriptorRing);
+	return TEST_RESULT();
+}
@@ -0,0 +1,148 @@
+#include "FramePacer.h"
+#include "TestUtil.h"
+#include <algorithm>
+#include <deque>
+
+namespace {
+	//
+	// Timeline structure
+	//
+	// Result of a simulated run.
+	//
+	struct Timeline
+	{
+		uint64_t Time; //!< time the CPU finished recording the last frame
+		uint32_t MaxInFlight; //!< largest count of frames the GPU had not finished
+	};
+
+	// simulate a CPU recording frames and a GPU running them in order. the CPU takes cpuTime
+	// per frame and waits through the pacer, the GPU takes gpuTime per frame
+	Timeline Simulate(uint32_t frameCount, uint64_t cpuTime, uint64_t gpuTime, uint32_t frames)
+	{
+		Timeline result = {};
+
+		FramePacer pacer;
+		if (!CHECK(pacer.Init(frameCount)))
+		{
+			return result;
+		}
+
+		std::deque<std::pair<uint64_t, uint64_t>> queue; // finish time and fence value
+		uint64_t now = 0;
+		uint64_t gpuFree = 0;
+		uint64_t completed = 0;
+		uint64_t nextValue = 1;
+
+		auto advance = [&](uint64_t time)
+		{
+			while (!queue.empty() && queue.front().first <= time)
+			{
+				completed = queue.front().second;
+				queue.pop_front();
+			}
+		};
+
+		for (auto i = 0u; i < frames; ++i)
+		{
+			CHECK(pacer.GetSlot() == i % frameCount);
+			CHECK(pacer.CanBegin(completed));
+
+			// record, then submit and signal
+			now += cpuTime;
+			auto start = std::max(now, gpuFree);
+			gpuFree = start + gpuTime;
+			queue.push_back(std::make_pair(gpuFree, nextValue));
+
+			auto waitValue = pacer.EndFrame(nextValue);
+			CHECK(waitValue == pacer.GetWaitValue());
+			CHECK(waitValue <= nextValue);
+			nextValue++;
+
+			// wait for the frame which used the next slot
+			advance(now);
+			while (completed < waitValue)
+			{
+				now = queue.front().first;
+				advance(now);
+			}
+
+			auto inFlight = pacer.GetInFlightCount(completed);
+			result.MaxInFlight = std::max(result.MaxInFlight, inFlight);
+
+			// the frame waited for is done, so at most frameCount - 1 remain queued
+			CHECK(inFlight <= frameCount - 1 || frameCount == 1);
+		}
+
+		CHECK(pacer.GetLastValue() == nextValue - 1);
+		CHECK(pacer.GetFrameNumber() == frames);
+
+		result.Time = now;
+		return result;
+	}
+
+	void TestInit()
+	{
+		FramePacer pacer;
+		CHECK(!pacer.Init(0));
+		CHECK(!pacer.Init(FramePacer::MaxFrameCount + 1));
+		CHECK(pacer.GetWaitValue() == 0);
+		CHECK(pacer.GetLastValue() == 0);
+
+		CHECK(pacer.Init(FramePacer::MaxFrameCount));
+		CHECK(pacer.GetFrameCount() == FramePacer::MaxFrameCount);
+
+		pacer.Term();
+		CHECK(pacer.GetFrameCount() == 0);
+		CHECK(pacer.EndFrame(1) == 0);
+	}
+
+	void TestSlots()
+	{
+		FramePacer pacer;
+		CHECK(pacer.Init(2));
+
+		// slots never used need no wait
+		CHECK(pacer.EndFrame(1) == 0);
+		CHECK(pacer.GetSlot() == 1);
+
+		// the slot of frame 1 is reused after frame 2, so frame 1 must be waited for
+		CHECK(pacer.EndFrame(2) == 1);
+		CHECK(pacer.EndFrame(3) == 2);
+		CHECK(pacer.GetSlot() == 1);
+		CHECK(pacer.GetLastValue() == 3);
+		CHECK(pacer.GetFrameNumber() == 3);
+
+		CHECK(!pacer.CanBegin(1));
+		CHECK(pacer.CanBegin(2));
+		CHECK(pacer.GetInFlightCount(1) == 2);
+		CHECK(pacer.GetInFlightCount(3) == 0);
+	}
+
+	void TestTimeline()
+	{
+		// GPU bound: more frames in flight keep the GPU busy while the CPU records
+		auto one = Simulate(1, 10, 10, 100);
+		auto two = Simulate(2, 10, 10, 100);
+		auto three = Simulate(3, 10, 10, 100);
+		CHECK(two.Time < one.Time);
+		CHECK(three.Time <= two.Time);
+		CHECK(one.MaxInFlight <= 1);
+
+		// GPU slower than the CPU: the queue fills up to frameCount - 1 after each wait
+		auto gpuBound = Simulate(3, 5, 10, 100);
+		CHECK(gpuBound.MaxInFlight == 2);
+		CHECK(gpuBound.Time >= 97 * 10);
+
+		// CPU slower than the GPU: the CPU never waits
+		auto cpuBound = Simulate(2, 10, 3, 100);
+		CHECK(cpuBound.Time == 100 * 10);
+	}
+} // namespace
+
+int main()
+{
+	RUN_TEST(TestInit);
+	RUN_TEST(TestSlots);
+	RUN_TEST(TestTimeline);
+	return TEST_RESULT();
+}
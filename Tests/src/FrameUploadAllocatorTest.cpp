@@ -0,0 +1,175 @@
+#include "FrameUploadAllocator.h"
+#include "FakeDevice.h"
+#include "TestUtil.h"
+#include <vector>
+
+namespace {
+	void TestLinear()
+	{
+		LinearAllocator allocator;
+		CHECK(!allocator.Init(0));
+		CHECK(!allocator.Init(LinearAllocator::InvalidOffset));
+		CHECK(allocator.Init(1000));
+		CHECK(allocator.GetCapacity() == 1000);
+
+		CHECK(allocator.Alloc(0, 16) == LinearAllocator::InvalidOffset);
+		CHECK(allocator.Alloc(10, 0) == LinearAllocator::InvalidOffset);
+		CHECK(allocator.Alloc(10, 24) == LinearAllocator::InvalidOffset);
+
+		// padding to the alignment is counted as used
+		CHECK(allocator.Alloc(10, 1) == 0);
+		CHECK(allocator.Alloc(10, 256) == 256);
+		CHECK(allocator.GetUsedSize() == 266);
+
+		// the block must fit entirely, a failure leaves the position alone
+		CHECK(allocator.Alloc(500, 512) == LinearAllocator::InvalidOffset);
+		CHECK(allocator.GetUsedSize() == 266);
+		CHECK(allocator.Alloc(488, 512) == 512);
+		CHECK(allocator.GetUsedSize() == 1000);
+		CHECK(allocator.Alloc(1, 1) == LinearAllocator::InvalidOffset);
+
+		allocator.Reset();
+		CHECK(allocator.GetUsedSize() == 0);
+		CHECK(allocator.Alloc(1000, 1) == 0);
+
+		// an aligned offset past the end, and sizes which would wrap around
+		allocator.Reset();
+		CHECK(allocator.Alloc(1, 1) == 0);
+		CHECK(allocator.Alloc(1, 1024) == LinearAllocator::InvalidOffset);
+		CHECK(allocator.Alloc(UINT64_MAX, 1) == LinearAllocator::InvalidOffset);
+		CHECK(allocator.Alloc(1, uint64_t(1) << 63) == LinearAllocator::InvalidOffset);
+
+		allocator.Term();
+		CHECK(allocator.GetCapacity() == 0);
+		CHECK(allocator.Alloc(1, 1) == LinearAllocator::InvalidOffset);
+	}
+
+	// random allocations are aligned, inside the range, and never overlap until a reset
+	void TestLinearFuzz()
+	{
+		for (uint64_t seed = 0; seed < 50; ++seed)
+		{
+			TestUtil::Random random(seed);
+
+			const uint64_t Capacity = 256 + random.Next(8192);
+			LinearAllocator allocator;
+			CHECK(allocator.Init(Capacity));
+
+			std::vector<uint8_t> used(size_t(Capacity), 0);
+			for (auto step = 0; step < 500; ++step)
+			{
+				if (random.Next(50) == 0)
+				{
+					allocator.Reset();
+					std::fill(used.begin(), used.end(), uint8_t(0));
+					continue;
+				}
+
+				auto size = 1 + random.Next(512);
+				auto alignment = uint64_t(1) << random.Next(9);
+				auto before = allocator.GetUsedSize();
+				auto offset = allocator.Alloc(size, alignment);
+
+				auto aligned = (before + alignment - 1) & ~(alignment - 1);
+				auto fits = aligned + size <= Capacity;
+				if (!CHECK((offset != LinearAllocator::InvalidOffset) == fits))
+				{
+					return;
+				}
+
+				if (!fits)
+				{
+					CHECK(allocator.GetUsedSize() == before);
+					continue;
+				}
+
+				CHECK(offset == aligned);
+				CHECK(allocator.GetUsedSize() == offset + size);
+				for (auto i = offset; i < offset + size; ++i)
+				{
+					if (!CHECK(used[size_t(i)] == 0))
+					{
+						return;
+					}
+					used[size_t(i)] = 1;
+				}
+			}
+		}
+	}
+
+	void TestFrames()
+	{
+		auto pDevice = new Fake::Device();
+
+		{
+			FrameUploadAllocator allocator;
+			CHECK(!allocator.Init(nullptr, 2, 1024));
+			CHECK(!allocator.Init(pDevice, 0, 1024));
+			CHECK(!allocator.Init(pDevice, 2, 0));
+			CHECK(!allocator.Alloc(16).IsValid());
+			CHECK(allocator.GetUsedSize() == 0);
+
+			// one buffer per frame, whatever the allocation count
+			CHECK(allocator.Init(pDevice, 2, 1000));
+			CHECK(pDevice->GetResourceCount() == 2);
+
+			allocator.Begin(0);
+			CHECK(!allocator.Alloc(0).IsValid());
+
+			// sizes are rounded up to constant buffer alignment, and the frame size with them
+			auto a = allocator.Alloc(1);
+			auto b = allocator.Push(uint32_t(0x12345678));
+			auto c = allocator.Alloc(300);
+			CHECK(a.IsValid() && b.IsValid() && c.IsValid());
+			CHECK(a.Size == 256 && c.Size == 512);
+			CHECK(b.AddressGPU == a.AddressGPU + 256);
+			CHECK(c.AddressGPU == b.AddressGPU + 256);
+			CHECK(a.AddressGPU % D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT == 0);
+			CHECK(*b.GetPtr<uint32_t>() == 0x12345678);
+			CHECK(allocator.GetUsedSize() == 1024);
+
+			// the CPU pointer and the GPU address point at the same bytes
+			CHECK(reinterpret_cast<uintptr_t>(c.pCPU) == uintptr_t(c.AddressGPU));
+
+			auto view = c.GetViewDesc();
+			CHECK(view.BufferLocation == c.AddressGPU && view.SizeInBytes == 512);
+
+			// a full frame fails without moving on
+			CHECK(!allocator.Alloc(1).IsValid());
+			CHECK(allocator.GetUsedSize() == 1024);
+
+			// the other frame has its own buffer, and is kept until its index comes again
+			allocator.Begin(1);
+			CHECK(allocator.GetUsedSize() == 0);
+			auto d = allocator.Alloc(16);
+			CHECK(d.IsValid() && d.AddressGPU != a.AddressGPU);
+			*d.GetPtr<uint32_t>() = 42;
+
+			allocator.Begin(0);
+			CHECK(allocator.GetUsedSize() == 0);
+			CHECK(allocator.Alloc(16).AddressGPU == a.AddressGPU);
+			CHECK(*d.GetPtr<uint32_t>() == 42);
+		}
+
+		// buffers are unmapped and released at the end, also when Init() fails
+		{
+			FrameUploadAllocator allocator;
+			pDevice->SetFailResources(true);
+			CHECK(!allocator.Init(pDevice, 3, 256));
+			pDevice->SetFailResources(false);
+			allocator.Term();
+			CHECK(!allocator.Alloc(16).IsValid());
+		}
+
+		pDevice->Release();
+		CHECK(Fake::LiveCount() == 0);
+	}
+} // namespace
+
+int main()
+{
+	RUN_TEST(TestLinear);
+	RUN_TEST(TestLinearFuzz);
+	RUN_TEST(TestFrames);
+	return TEST_RESULT();
+}
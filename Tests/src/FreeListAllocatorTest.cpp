@@ -0,0 +1,214 @@
+#include "FreeListAllocator.h"
+#include "TestUtil.h"
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <vector>
+
+namespace {
+	void TestAlloc()
+	{
+		FreeListAllocator allocator;
+		CHECK(!allocator.Init(0));
+		CHECK(!allocator.Init(FreeListAllocator::InvalidOffset));
+		CHECK(allocator.Init(100));
+		CHECK(allocator.GetCapacity() == 100);
+		CHECK(allocator.IsCompact());
+
+		CHECK(allocator.Alloc(0) == FreeListAllocator::InvalidOffset);
+		CHECK(allocator.Alloc(101) == FreeListAllocator::InvalidOffset);
+
+		// first fit from the front
+		auto a = allocator.Alloc(10);
+		auto b = allocator.Alloc(20);
+		auto c = allocator.Alloc(30);
+		CHECK(a == 0 && b == 10 && c == 30);
+		CHECK(allocator.GetCount(b) == 20);
+		CHECK(allocator.GetCount(5) == 0);
+		CHECK(allocator.GetUsedCount() == 60);
+		CHECK(allocator.GetLargestFreeRange() == 40);
+
+		// a freed range is reused by the next allocation which fits
+		allocator.Free(b);
+		CHECK(!allocator.IsCompact());
+		CHECK(allocator.Alloc(25) == 60);
+		CHECK(allocator.Alloc(15) == 10);
+		CHECK(allocator.GetLargestFreeRange() == 15);
+
+		allocator.Free(FreeListAllocator::InvalidOffset);
+		CHECK(allocator.GetUsedCount() == 80);
+
+		allocator.Term();
+		CHECK(allocator.GetCapacity() == 0 && allocator.GetUsedCount() == 0);
+		CHECK(allocator.Alloc(1) == FreeListAllocator::InvalidOffset);
+	}
+
+	void TestMerge()
+	{
+		FreeListAllocator allocator;
+		CHECK(allocator.Init(40));
+
+		uint32_t offsets[4];
+		for (auto i = 0; i < 4; ++i)
+		{
+			offsets[i] = allocator.Alloc(10);
+		}
+		CHECK(allocator.Alloc(1) == FreeListAllocator::InvalidOffset);
+
+		// neighbours merge on both sides, so the whole middle is one range again
+		allocator.Free(offsets[1]);
+		allocator.Free(offsets[3]);
+		CHECK(allocator.GetLargestFreeRange() == 10);
+		allocator.Free(offsets[2]);
+		CHECK(allocator.GetLargestFreeRange() == 30);
+		CHECK(allocator.Alloc(30) == 10);
+
+		allocator.Free(10);
+		allocator.Free(offsets[0]);
+		CHECK(allocator.GetUsedCount() == 0);
+		CHECK(allocator.GetLargestFreeRange() == 40);
+		CHECK(allocator.IsCompact());
+	}
+
+	void TestCompact()
+	{
+		FreeListAllocator allocator;
+		CHECK(allocator.Init(100));
+
+		auto a = allocator.Alloc(10);
+		auto b = allocator.Alloc(20);
+		auto c = allocator.Alloc(30);
+		auto d = allocator.Alloc(5);
+		allocator.Free(a);
+		allocator.Free(c);
+		CHECK(!allocator.IsCompact());
+
+		std::vector<FreeListAllocator::Move> moves;
+		allocator.Compact(moves);
+		CHECK(allocator.IsCompact());
+		CHECK(moves.size() == 2);
+		CHECK(moves[0].SrcOffset == b && moves[0].DstOffset == 0 && moves[0].Count == 20);
+		CHECK(moves[1].SrcOffset == d && moves[1].DstOffset == 20 && moves[1].Count == 5);
+		CHECK(allocator.GetCount(0) == 20 && allocator.GetCount(20) == 5);
+		CHECK(allocator.GetLargestFreeRange() == 75);
+
+		// nothing moves once compact
+		allocator.Compact(moves);
+		CHECK(moves.empty());
+
+		// a full allocator is compact
+		CHECK(allocator.Alloc(75) == 25);
+		CHECK(allocator.IsCompact());
+		CHECK(allocator.GetLargestFreeRange() == 0);
+	}
+
+	// random allocations and frees never overlap, and compaction keeps every range's size and order
+	void TestFuzz()
+	{
+		for (uint64_t seed = 0; seed < 50; ++seed)
+		{
+			TestUtil::Random random(seed);
+
+			const uint32_t Capacity = 1000 + random.Next(4000);
+			FreeListAllocator allocator;
+			CHECK(allocator.Init(Capacity));
+
+			// reference: owner of every element, and the live ranges by offset
+			std::vector<int> owner(Capacity, -1);
+			std::map<uint32_t, uint32_t> live;
+			auto nextId = 0;
+
+			for (auto step = 0; step < 1000; ++step)
+			{
+				auto action = random.Next(10);
+				if (action < 6)
+				{
+					auto count = 1 + random.Next(100);
+					auto offset = allocator.Alloc(count);
+					if (offset == FreeListAllocator::InvalidOffset)
+					{
+						// first fit fails only when no free range is large enough
+						CHECK(allocator.GetLargestFreeRange() < count);
+						continue;
+					}
+
+					if (!CHECK(offset + count <= Capacity))
+					{
+						return;
+					}
+					for (auto i = offset; i < offset + count; ++i)
+					{
+						if (!CHECK(owner[i] == -1))
+						{
+							return;
+						}
+						owner[i] = nextId;
+					}
+					live[offset] = count;
+					nextId++;
+				}
+				else if (action < 9 && !live.empty())
+				{
+					auto itr = live.begin();
+					std::advance(itr, random.Next(uint32_t(live.size())));
+					allocator.Free(itr->first);
+					std::fill(owner.begin() + itr->first, owner.begin() + itr->first + itr->second, -1);
+					live.erase(itr);
+				}
+				else
+				{
+					std::vector<FreeListAllocator::Move> moves;
+					allocator.Compact(moves);
+					CHECK(allocator.IsCompact());
+
+					// apply the moves to the reference in order, as the owner copies its data
+					std::vector<int> packed(Capacity, -1);
+					std::map<uint32_t, uint32_t> packedLive;
+					auto cursor = 0u;
+					size_t moveIndex = 0;
+					for (auto& range : live)
+					{
+						if (range.first != cursor)
+						{
+							if (!CHECK(moveIndex < moves.size())
+							 || !CHECK(moves[moveIndex].SrcOffset == range.first)
+							 || !CHECK(moves[moveIndex].DstOffset == cursor)
+							 || !CHECK(moves[moveIndex].Count == range.second))
+							{
+								return;
+							}
+							moveIndex++;
+						}
+
+						std::copy(owner.begin() + range.first, owner.begin() + range.first + range.second, packed.begin() + cursor);
+						packedLive[cursor] = range.second;
+						cursor += range.second;
+					}
+					CHECK(moveIndex == moves.size());
+					owner.swap(packed);
+					live.swap(packedLive);
+				}
+
+				uint32_t used = 0;
+				for (auto& range : live)
+				{
+					CHECK(allocator.GetCount(range.first) == range.second);
+					used += range.second;
+				}
+				if (!CHECK(allocator.GetUsedCount() == used))
+				{
+					return;
+				}
+			}
+		}
+	}
+} // namespace
+
+int main()
+{
+	RUN_TEST(TestAlloc);
+	RUN_TEST(TestMerge);
+	RUN_TEST(TestCompact);
+	RUN_TEST(TestFuzz);
+	return TEST_RESULT();
+}
@@ -0,0 +1,365 @@
+#include "GeometryArena.h"
+#include "BufferUploadBatch.h"
+#include "DeferredReleaseQueue.h"
+#include "FakeDevice.h"
+#include "TestUtil.h"
+#include <cstring>
+#include <vector>
+
+namespace {
+	// size of one vertex of the tests
+	const uint32_t VertexStride = 8;
+
+	//
+	// MeshData structure
+	//
+	// Geometry of one mesh, filled with values unique to the mesh.
+	//
+	struct MeshData
+	{
+		std::vector<uint8_t> Vertices;
+		std::vector<uint32_t> Indices;
+		GeometryAllocation* pAllocation;
+	};
+
+	MeshData MakeMesh(uint32_t id, uint32_t vertexCount, uint32_t indexCount)
+	{
+		MeshData mesh;
+		mesh.Vertices.resize(size_t(vertexCount) * VertexStride);
+		for (size_t i = 0; i < mesh.Vertices.size(); ++i)
+		{
+			mesh.Vertices[i] = uint8_t(id * 37 + i);
+		}
+
+		mesh.Indices.resize(indexCount);
+		for (uint32_t i = 0; i < indexCount; ++i)
+		{
+			mesh.Indices[i] = (i * 7 + id) % vertexCount;
+		}
+
+		mesh.pAllocation = nullptr;
+		return mesh;
+	}
+
+	// memory of a fake buffer, whose GPU address is its CPU address
+	const uint8_t* GetMemory(D3D12_GPU_VIRTUAL_ADDRESS address)
+	{
+		return reinterpret_cast<const uint8_t*>(uintptr_t(address));
+	}
+
+	// whether the arena holds the geometry of the mesh where its allocation points
+	bool HasMesh(const GeometryArena& arena, const MeshData& mesh)
+	{
+		auto pAllocation = mesh.pAllocation;
+		auto pVertices = GetMemory(arena.GetVertexView().BufferLocation) + size_t(pAllocation->BaseVertex) * VertexStride;
+		if (memcmp(pVertices, mesh.Vertices.data(), mesh.Vertices.size()) != 0)
+		{
+			return false;
+		}
+
+		auto pIndices = GetMemory(arena.GetIndexView(pAllocation->IndexFormat).BufferLocation);
+		for (uint32_t i = 0; i < pAllocation->IndexCount; ++i)
+		{
+			auto index = (pAllocation->IndexFormat == DXGI_FORMAT_R16_UINT)
+				? reinterpret_cast<const uint16_t*>(pIndices)[pAllocation->FirstIndex + i]
+				: reinterpret_cast<const uint32_t*>(pIndices)[pAllocation->FirstIndex + i];
+			if (index != mesh.Indices[i])
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool Alloc(GeometryArena& arena, BufferUploadBatch& batch, MeshData& mesh)
+	{
+		mesh.pAllocation = arena.Alloc(
+			batch,
+			mesh.Vertices.data(),
+			uint32_t(mesh.Vertices.size() / VertexStride),
+			mesh.Indices.data(),
+			uint32_t(mesh.Indices.size()));
+		return mesh.pAllocation != nullptr;
+	}
+
+	void TestAlloc()
+	{
+		auto pDevice = new Fake::Device();
+		auto pQueue = new Fake::CommandQueue(D3D12_COMMAND_LIST_TYPE_COPY);
+
+		{
+			BufferUploadBatch batch;
+			CHECK(batch.Init(pDevice, pQueue, 4096));
+
+			GeometryArena arena;
+			CHECK(!arena.Init(nullptr, VertexStride, 100, 100, 100));
+			CHECK(!arena.Init(pDevice, VertexStride, 100, 0, 0));
+			CHECK(arena.Init(pDevice, VertexStride, 1000, 300, 1000));
+
+			batch.Begin();
+
+			// meshes take 16-bit indices until the 16-bit region is full
+			std::vector<MeshData> meshes;
+			for (uint32_t i = 0; i < 4; ++i)
+			{
+				meshes.push_back(MakeMesh(i, 50, 120));
+				CHECK(Alloc(arena, batch, meshes.back()));
+			}
+			CHECK(meshes[0].pAllocation->IndexFormat == DXGI_FORMAT_R16_UINT);
+			CHECK(meshes[1].pAllocation->IndexFormat == DXGI_FORMAT_R16_UINT);
+			CHECK(meshes[2].pAllocation->IndexFormat == DXGI_FORMAT_R32_UINT);
+			CHECK(meshes[3].pAllocation->FirstIndex == 120);
+			CHECK(arena.GetUsedVertexCount() == 200);
+			CHECK(arena.GetUsedIndexCount(DXGI_FORMAT_R16_UINT) == 240);
+			CHECK(arena.GetUsedIndexCount(DXGI_FORMAT_R32_UINT) == 240);
+
+			// out of vertices, and a failed allocation gives its vertices back
+			auto large = MakeMesh(9, 900, 3);
+			CHECK(!Alloc(arena, batch, large));
+			auto many = MakeMesh(10, 10, 900);
+			CHECK(!Alloc(arena, batch, many));
+			CHECK(arena.GetUsedVertexCount() == 200);
+
+			CHECK(arena.Alloc(batch, nullptr, 10, meshes[0].Indices.data(), 3) == nullptr);
+
+			CHECK(batch.End() != 0);
+			for (auto& mesh : meshes)
+			{
+				CHECK(HasMesh(arena, mesh));
+			}
+
+			GeometryAllocation* pNull = nullptr;
+			arena.Free(pNull);
+			arena.Free(meshes[1].pAllocation);
+			CHECK(meshes[1].pAllocation == nullptr);
+			CHECK(arena.GetUsedVertexCount() == 150);
+			CHECK(arena.GetUsedIndexCount(DXGI_FORMAT_R16_UINT) == 120);
+
+			arena.Term();
+			batch.Term();
+		}
+
+		pQueue->Release();
+		pDevice->Release();
+		CHECK(Fake::LiveCount() == 0);
+	}
+
+	// 16-bit input is uploaded as it is, and widened when the 16-bit region is full
+	void TestAlloc16()
+	{
+		auto pDevice = new Fake::Device();
+		auto pQueue = new Fake::CommandQueue(D3D12_COMMAND_LIST_TYPE_COPY);
+
+		{
+			BufferUploadBatch batch;
+			CHECK(batch.Init(pDevice, pQueue, 4096));
+
+			GeometryArena arena;
+			CHECK(arena.Init(pDevice, VertexStride, 1000, 150, 1000));
+
+			batch.Begin();
+
+			std::vector<MeshData> meshes;
+			for (uint32_t i = 0; i < 2; ++i)
+			{
+				meshes.push_back(MakeMesh(i, 50, 120));
+				auto& mesh = meshes.back();
+				std::vector<uint16_t> indices16(mesh.Indices.begin(), mesh.Indices.end());
+				mesh.pAllocation = arena.Alloc(
+					batch,
+					mesh.Vertices.data(),
+					50,
+					indices16.data(),
+					DXGI_FORMAT_R16_UINT,
+					uint32_t(indices16.size()));
+				CHECK(mesh.pAllocation != nullptr);
+			}
+			CHECK(meshes[0].pAllocation->IndexFormat == DXGI_FORMAT_R16_UINT);
+			CHECK(meshes[1].pAllocation->IndexFormat == DXGI_FORMAT_R32_UINT);
+
+			// only 16-bit and 32-bit indices are taken
+			CHECK(arena.Alloc(batch, meshes[0].Vertices.data(), 50, meshes[0].Indices.data(), DXGI_FORMAT_R8_UINT, 3) == nullptr);
+
+			CHECK(batch.End() != 0);
+			for (auto& mesh : meshes)
+			{
+				CHECK(HasMesh(arena, mesh));
+			}
+
+			arena.Term();
+			batch.Term();
+		}
+
+		pQueue->Release();
+		pDevice->Release();
+		CHECK(Fake::LiveCount() == 0);
+	}
+
+	// compaction keeps the geometry of every live allocation, and hands the old buffers to the release queue
+	void TestCompact()
+	{
+		auto pDevice = new Fake::Device();
+		auto pQueue = new Fake::CommandQueue(D3D12_COMMAND_LIST_TYPE_COPY);
+
+		{
+			BufferUploadBatch batch;
+			CHECK(batch.Init(pDevice, pQueue, 4096));
+
+			GeometryArena arena;
+			CHECK(arena.Init(pDevice, VertexStride, 2000, 1500, 3000));
+
+			TestUtil::Random random(1);
+			std::vector<MeshData> meshes;
+			batch.Begin();
+			for (uint32_t i = 0; i < 24; ++i)
+			{
+				meshes.push_back(MakeMesh(i, 10 + random.Next(60), 3 + random.Next(200)));
+				CHECK(Alloc(arena, batch, meshes.back()));
+			}
+			CHECK(batch.End() != 0);
+
+			CHECK(!arena.Compact(nullptr, nullptr));
+
+			// nothing to move, nothing created
+			auto resourceCount = pDevice->GetResourceCount();
+			CHECK(arena.Compact(pQueue, nullptr));
+			CHECK(pDevice->GetResourceCount() == resourceCount);
+
+			for (size_t i = 0; i < meshes.size(); i += 3)
+			{
+				arena.Free(meshes[i].pAllocation);
+			}
+
+			DeferredReleaseQueue releaseQueue;
+			releaseQueue.SetFenceValue(5);
+
+			auto oldVB = arena.GetVertexView().BufferLocation;
+			auto liveCount = Fake::LiveCount().load();
+			CHECK(arena.Compact(pQueue, &releaseQueue));
+
+			// old buffers are kept until the frames which may read them have finished
+			CHECK(arena.GetVertexView().BufferLocation != oldVB);
+			CHECK(releaseQueue.GetPendingCount() == 3);
+			CHECK(Fake::LiveCount() == liveCount + 3);
+			CHECK(releaseQueue.Collect(4) == 0);
+			CHECK(releaseQueue.Collect(5) == 3);
+			CHECK(Fake::LiveCount() == liveCount);
+
+			uint32_t vertexCount = 0;
+			for (auto& mesh : meshes)
+			{
+				if (mesh.pAllocation != nullptr)
+				{
+					CHECK(HasMesh(arena, mesh));
+					vertexCount += mesh.pAllocation->VertexCount;
+				}
+			}
+			CHECK(arena.GetUsedVertexCount() == vertexCount);
+
+			// live ranges were packed, so the space freed is one range at the end
+			auto tail = MakeMesh(100, 2000 - vertexCount, 3);
+			batch.Begin();
+			CHECK(Alloc(arena, batch, tail));
+			CHECK(batch.End() != 0);
+			CHECK(HasMesh(arena, tail));
+
+			// without a release queue the old buffers are released at once
+			arena.Free(meshes[1].pAllocation);
+			CHECK(arena.Compact(pQueue, nullptr));
+			CHECK(Fake::LiveCount() == liveCount);
+			CHECK(HasMesh(arena, tail));
+			CHECK(HasMesh(arena, meshes[2]));
+
+			releaseQueue.Term();
+			arena.Term();
+			batch.Term();
+		}
+
+		pQueue->Release();
+		pDevice->Release();
+		CHECK(Fake::LiveCount() == 0);
+	}
+
+	// a freed range is reused only after the frames which may draw from it have finished
+	void TestDeferredFree()
+	{
+		auto pDevice = new Fake::Device();
+		auto pQueue = new Fake::CommandQueue(D3D12_COMMAND_LIST_TYPE_COPY);
+
+		{
+			BufferUploadBatch batch;
+			CHECK(batch.Init(pDevice, pQueue, 4096));
+
+			DeferredReleaseQueue releaseQueue;
+			releaseQueue.SetFenceValue(1);
+
+			GeometryArena arena;
+			CHECK(arena.Init(pDevice, VertexStride, 256, 256, 256, &releaseQueue));
+
+			std::vector<MeshData> meshes;
+			batch.Begin();
+			for (uint32_t i = 0; i < 2; ++i)
+			{
+				meshes.push_back(MakeMesh(i, 128, 120));
+				CHECK(Alloc(arena, batch, meshes.back()));
+			}
+			CHECK(batch.End() != 0);
+
+			// the range of a freed mesh stays in use until its fence has passed
+			auto baseVertex = meshes[0].pAllocation->BaseVertex;
+			arena.Free(meshes[0].pAllocation);
+			meshes[0].pAllocation = nullptr;
+			CHECK(arena.GetUsedVertexCount() == 256);
+			CHECK(arena.GetUsedIndexCount(DXGI_FORMAT_R16_UINT) == 240);
+			CHECK(releaseQueue.GetPendingCount() == 1);
+
+			auto next = MakeMesh(2, 128, 120);
+			batch.Begin();
+			CHECK(!Alloc(arena, batch, next));
+			batch.End();
+
+			CHECK(releaseQueue.Collect(0) == 0);
+			CHECK(arena.GetUsedVertexCount() == 256);
+			CHECK(releaseQueue.Collect(1) == 1);
+			CHECK(arena.GetUsedVertexCount() == 128);
+			CHECK(arena.GetUsedIndexCount(DXGI_FORMAT_R16_UINT) == 120);
+
+			batch.Begin();
+			CHECK(Alloc(arena, batch, next));
+			CHECK(batch.End() != 0);
+			CHECK(next.pAllocation->BaseVertex == baseVertex);
+			CHECK(HasMesh(arena, next));
+			CHECK(HasMesh(arena, meshes[1]));
+
+			// compaction returns the ranges still queued, and their callbacks find nothing afterwards
+			releaseQueue.SetFenceValue(2);
+			arena.Free(next.pAllocation);
+			CHECK(arena.Compact(pQueue, &releaseQueue));
+			CHECK(arena.GetUsedVertexCount() == 128);
+			CHECK(HasMesh(arena, meshes[1]));
+			CHECK(releaseQueue.Collect(2) > 0);
+			CHECK(arena.GetUsedVertexCount() == 128);
+
+			// frees still queued when the arena ends do nothing
+			releaseQueue.SetFenceValue(3);
+			arena.Free(meshes[1].pAllocation);
+			arena.Term();
+			releaseQueue.Term();
+			CHECK(releaseQueue.GetPendingCount() == 0);
+			batch.Term();
+		}
+
+		pQueue->Release();
+		pDevice->Release();
+		CHECK(Fake::LiveCount() == 0);
+	}
+} // namespace
+
+int main()
+{
+	RUN_TEST(TestAlloc);
+	RUN_TEST(TestAlloc16);
+	RUN_TEST(TestCompact);
+	RUN_TEST(TestDeferredFree);
+	return TEST_RESULT();
+}
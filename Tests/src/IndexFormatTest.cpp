@@ -0,0 +1,185 @@
+#include "IndexFormat.h"
+#include "TestUtil.h"
+#include <vector>
+
+namespace {
+	// a grid of (width + 1) x (height + 1) vertices whose Position.x is the vertex index
+	ResMesh MakeGrid(uint32_t width, uint32_t height, uint32_t materialId)
+	{
+		ResMesh mesh;
+		mesh.MaterialId = materialId;
+
+		for (auto i = 0u; i < (width + 1) * (height + 1); ++i)
+		{
+			MeshVertex vertex = {};
+			vertex.Position.x = float(i);
+			mesh.Vertices.push_back(vertex);
+		}
+
+		for (auto y = 0u; y < height; ++y)
+		{
+			for (auto x = 0u; x < width; ++x)
+			{
+				auto i = y * (width + 1) + x;
+				const uint32_t quad[] = { i, i + 1, i + width + 1, i + 1, i + width + 2, i + width + 1 };
+				mesh.Indices.insert(mesh.Indices.end(), quad, quad + 6);
+			}
+		}
+		return mesh;
+	}
+
+	// chunks fit the limit, use each of their vertices, and draw the triangles of the mesh in order
+	bool CheckChunks(const ResMesh& mesh, const std::vector<ResMesh>& chunks, uint32_t maxVertexCount)
+	{
+		size_t t = 0;
+		for (auto& chunk : chunks)
+		{
+			if (!CHECK(chunk.MaterialId == mesh.MaterialId)
+			 || !CHECK(chunk.Vertices.size() <= maxVertexCount)
+			 || !CHECK(!chunk.Indices.empty() && chunk.Indices.size() % 3 == 0))
+			{
+				return false;
+			}
+
+			std::vector<bool> used(chunk.Vertices.size(), false);
+			for (auto index : chunk.Indices)
+			{
+				if (!CHECK(index < chunk.Vertices.size()) || !CHECK(t < mesh.Indices.size()))
+				{
+					return false;
+				}
+
+				used[index] = true;
+				if (!CHECK(uint32_t(chunk.Vertices[index].Position.x) == mesh.Indices[t]))
+				{
+					return false;
+				}
+				t++;
+			}
+
+			// vertices are not duplicated in a chunk, and none is unused
+			std::vector<bool> seen(mesh.Vertices.size(), false);
+			for (size_t i = 0; i < chunk.Vertices.size(); ++i)
+			{
+				auto v = uint32_t(chunk.Vertices[i].Position.x);
+				if (!CHECK(used[i]) || !CHECK(!seen[v]))
+				{
+					return false;
+				}
+				seen[v] = true;
+			}
+		}
+
+		return CHECK(t == mesh.Indices.size() - mesh.Indices.size() % 3);
+	}
+
+	void TestSelect()
+	{
+		CHECK(SelectIndexFormat(0) == DXGI_FORMAT_R16_UINT);
+		CHECK(SelectIndexFormat(MaxVertexCount16) == DXGI_FORMAT_R16_UINT);
+		CHECK(SelectIndexFormat(MaxVertexCount16 + 1) == DXGI_FORMAT_R32_UINT);
+		CHECK(GetIndexStride(DXGI_FORMAT_R16_UINT) == 2);
+		CHECK(GetIndexStride(DXGI_FORMAT_R32_UINT) == 4);
+
+		std::vector<uint32_t> indices = { 0, 1, 65535, 300 };
+		std::vector<uint16_t> packed;
+		PackIndices16(indices, packed);
+		CHECK(packed.size() == 4 && packed[2] == 65535 && packed[3] == 300);
+	}
+
+	void TestSplit()
+	{
+		std::vector<ResMesh> chunks;
+
+		// nothing to split
+		auto grid = MakeGrid(4, 4, 3);
+		SplitMesh(grid, 2, chunks);
+		CHECK(chunks.empty());
+		SplitMesh(ResMesh(), 16, chunks);
+		CHECK(chunks.empty());
+
+		// a mesh which fits is copied as one chunk
+		SplitMesh(grid, uint32_t(grid.Vertices.size()), chunks);
+		CHECK(chunks.size() == 1 && chunks[0].Vertices.size() == grid.Vertices.size());
+		CHECK(CheckChunks(grid, chunks, uint32_t(grid.Vertices.size())));
+
+		// one triangle per chunk at the smallest limit
+		SplitMesh(grid, 3, chunks);
+		CHECK(chunks.size() == grid.Indices.size() / 3);
+		CHECK(CheckChunks(grid, chunks, 3));
+
+		// degenerate triangles count their vertex once, a trailing partial triangle is dropped
+		ResMesh mesh = MakeGrid(1, 1, 0);
+		mesh.Indices = { 0, 0, 1, 2, 2, 2, 1, 3, 2, 0 };
+		SplitMesh(mesh, 3, chunks);
+		CHECK(chunks.size() == 2);
+		CHECK(chunks[0].Vertices.size() == 3 && chunks[1].Vertices.size() == 3);
+		CHECK(CheckChunks(mesh, chunks, 3));
+	}
+
+	// random grids split at random limits keep every triangle
+	void TestSplitFuzz()
+	{
+		for (uint64_t seed = 0; seed < 100; ++seed)
+		{
+			TestUtil::Random random(seed);
+
+			auto grid = MakeGrid(1 + random.Next(40), 1 + random.Next(40), random.Next(8));
+
+			// shuffle the triangles, so chunks take scattered vertices
+			if (random.Next(2) == 0)
+			{
+				auto triangleCount = grid.Indices.size() / 3;
+				for (size_t i = triangleCount - 1; i > 0; --i)
+				{
+					auto j = random.Next(uint32_t(i + 1));
+					for (auto k = 0; k < 3; ++k)
+					{
+						std::swap(grid.Indices[i * 3 + k], grid.Indices[j * 3 + k]);
+					}
+				}
+			}
+
+			auto maxVertexCount = 3 + random.Next(200);
+			std::vector<ResMesh> chunks;
+			SplitMesh(grid, maxVertexCount, chunks);
+			if (!CheckChunks(grid, chunks, maxVertexCount))
+			{
+				return;
+			}
+		}
+	}
+
+	void TestSplitLarge()
+	{
+		// 301 x 301 vertices need 32-bit indices, the meshes around it do not
+		std::vector<ResMesh> meshes;
+		meshes.push_back(MakeGrid(10, 10, 0));
+		meshes.push_back(MakeGrid(300, 300, 1));
+		meshes.push_back(MakeGrid(255, 255, 2));
+		auto large = meshes[1];
+		CHECK(SelectIndexFormat(large.Vertices.size()) == DXGI_FORMAT_R32_UINT);
+		CHECK(SelectIndexFormat(meshes[2].Vertices.size()) == DXGI_FORMAT_R16_UINT);
+
+		SplitLargeMeshes(meshes);
+		CHECK(meshes.size() == 4);
+		CHECK(meshes.front().MaterialId == 0 && meshes.front().Vertices.size() == 121);
+		CHECK(meshes.back().MaterialId == 2 && meshes.back().Vertices.size() == 65536);
+
+		std::vector<ResMesh> chunks(meshes.begin() + 1, meshes.end() - 1);
+		CHECK(CheckChunks(large, chunks, MaxVertexCount16));
+		for (auto& chunk : chunks)
+		{
+			CHECK(SelectIndexFormat(chunk.Vertices.size()) == DXGI_FORMAT_R16_UINT);
+		}
+	}
+} // namespace
+
+int main()
+{
+	RUN_TEST(TestSelect);
+	RUN_TEST(TestSplit);
+	RUN_TEST(TestSplitFuzz);
+	RUN_TEST(TestSplitLarge);
+	return TEST_RESULT();
+}
@@ -0,0 +1,135 @@
+#include "IntervalPacker.h"
+#include "TestUtil.h"
+#include <algorithm>
+#include <vector>
+
+namespace {
+	// an empty interval, an empty block and an alignment which is not a power of 2 are rejected
+	void TestAdd()
+	{
+		IntervalPacker packer;
+		CHECK(packer.Add(2, 1, 16, 16) == IntervalPacker::InvalidId);
+		CHECK(packer.Add(0, 1, 0, 16) == IntervalPacker::InvalidId);
+		CHECK(packer.Add(0, 1, 16, 0) == IntervalPacker::InvalidId);
+		CHECK(packer.Add(0, 1, 16, 3) == IntervalPacker::InvalidId);
+		CHECK(packer.GetCount() == 0);
+
+		CHECK(packer.Add(1, 1, 16, 1) == 0);
+		CHECK(packer.Add(0, 4, 16, 16) == 1);
+		CHECK(packer.GetCount() == 2);
+
+		packer.Reset();
+		CHECK(packer.GetCount() == 0 && packer.GetSize() == 0 && packer.GetUnaliasedSize() == 0);
+		CHECK(packer.Add(0, 0, 8, 8) == 0);
+	}
+
+	// larger blocks go first at the lowest aligned offset which fits
+	void TestPlacement()
+	{
+		IntervalPacker packer;
+		auto a = packer.Add(0, 1, 100, 64);
+		auto b = packer.Add(1, 2, 50, 64);
+		auto c = packer.Add(2, 3, 100, 64);
+		auto d = packer.Add(3, 3, 10, 256);
+		packer.Pack();
+
+		// a and c never live at once, b lives with both, d with c only
+		CHECK(packer.GetOffset(a) == 0 && packer.GetOffset(c) == 0);
+		CHECK(packer.GetOffset(b) == 128 && packer.GetOffset(d) == 256);
+		CHECK(packer.IsOverlapped(a, c) && !packer.IsOverlapped(a, b) && !packer.IsOverlapped(c, d));
+		CHECK(packer.GetSize() == 266);
+		CHECK(packer.GetUnaliasedSize() == 522);
+
+		// out of range ids
+		CHECK(packer.GetOffset(4) == 0 && !packer.IsOverlapped(a, 4));
+
+		// a smaller block fills the gap left by a block which is dead by then
+		packer.Reset();
+		auto first = packer.Add(0, 2, 100, 1);
+		auto shortLived = packer.Add(0, 0, 100, 1);
+		auto last = packer.Add(0, 2, 100, 1);
+		auto gap = packer.Add(1, 2, 80, 1);
+		packer.Pack();
+		CHECK(packer.GetOffset(first) == 0 && packer.GetOffset(shortLived) == 100 && packer.GetOffset(last) == 200);
+		CHECK(packer.GetOffset(gap) == 100);
+		CHECK(packer.GetSize() == 300 && packer.GetUnaliasedSize() == 380);
+
+		// the alignment moves a block past the end of another
+		packer.Reset();
+		auto small = packer.Add(0, 0, 10, 1);
+		auto aligned = packer.Add(0, 0, 5, 256);
+		packer.Pack();
+		CHECK(packer.GetOffset(small) == 0 && packer.GetOffset(aligned) == 256);
+		CHECK(packer.GetSize() == 261);
+
+		// Pack() again gives the same placement
+		packer.Pack();
+		CHECK(packer.GetOffset(aligned) == 256 && packer.GetSize() == 261 && packer.GetUnaliasedSize() == 261);
+	}
+
+	// blocks living at once never share memory, whatever is added
+	void TestRandom()
+	{
+		TestUtil::Random random(25);
+		IntervalPacker packer;
+		for (auto round = 0; round < 2000; ++round)
+		{
+			packer.Reset();
+
+			auto count = 1 + random.Next(16);
+			std::vector<uint32_t> firsts(count);
+			std::vector<uint32_t> lasts(count);
+			std::vector<uint64_t> sizes(count);
+			std::vector<uint64_t> alignments(count);
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				firsts[i] = random.Next(8);
+				lasts[i] = firsts[i] + random.Next(4);
+				sizes[i] = 1 + random.Next(8000);
+				alignments[i] = uint64_t(1) << random.Next(12);
+				CHECK(packer.Add(firsts[i], lasts[i], sizes[i], alignments[i]) == i);
+			}
+			packer.Pack();
+
+			auto isValid = true;
+			for (uint32_t i = 0; i < count && isValid; ++i)
+			{
+				auto offset = packer.GetOffset(i);
+				isValid = CHECK(offset % alignments[i] == 0) && CHECK(offset + sizes[i] <= packer.GetSize());
+
+				for (uint32_t j = i + 1; j < count && isValid; ++j)
+				{
+					if (firsts[i] <= lasts[j] && firsts[j] <= lasts[i])
+					{
+						isValid = CHECK(!packer.IsOverlapped(i, j));
+					}
+				}
+			}
+
+			// at least the blocks living at any one step, at most every block apart
+			uint64_t maxLiveSize = 0;
+			for (uint32_t step = 0; step < 11; ++step)
+			{
+				uint64_t liveSize = 0;
+				for (uint32_t i = 0; i < count; ++i)
+				{
+					liveSize += (firsts[i] <= step && step <= lasts[i]) ? sizes[i] : 0;
+				}
+				maxLiveSize = std::max(maxLiveSize, liveSize);
+			}
+
+			if (!isValid || !CHECK(maxLiveSize <= packer.GetSize()) || !CHECK(packer.GetSize() <= packer.GetUnaliasedSize()))
+			{
+				break;
+			}
+		}
+	}
+} // namespace
+
+int main()
+{
+	RUN_TEST(TestAdd);
+	RUN_TEST(TestPlacement);
+	RUN_TEST(TestRandom);
+	return TEST_RESULT();
+}
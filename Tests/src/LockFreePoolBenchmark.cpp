@@ -0,0 +1,122 @@
+#include "LockFreePool.h"
+#include "Pool.h"
+#include "TestUtil.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace {
+	//
+	// Handle structure
+	//
+	// Stands in for DescriptorHandle, which the descriptor pools keep.
+	//
+	struct Handle
+	{
+		uint64_t HandleCPU;
+		uint64_t HandleGPU;
+	};
+
+	// handles one thread holds at once, like a loader creating the views of a texture
+	const uint32_t BatchSize = 8;
+
+	// million allocations and frees per second of threadCount threads running rounds of batches
+	template<typename PoolType>
+	double Run(PoolType& pool, uint32_t threadCount, uint32_t roundCount)
+	{
+		std::atomic<uint32_t> ready(0);
+		std::atomic<bool> isStarted(false);
+		std::atomic<uint32_t> failures(0);
+
+		std::vector<std::thread> threads;
+		for (auto t = 0u; t < threadCount; ++t)
+		{
+			threads.emplace_back([&]()
+			{
+				Handle* pHandles[BatchSize];
+				ready++;
+				while (!isStarted.load())
+				{
+					std::this_thread::yield();
+				}
+
+				for (auto round = 0u; round < roundCount; ++round)
+				{
+					for (auto i = 0u; i < BatchSize; ++i)
+					{
+						pHandles[i] = pool.Alloc([](uint32_t index, Handle* pHandle)
+						{
+							pHandle->HandleCPU = index;
+							pHandle->HandleGPU = index;
+						});
+						if (pHandles[i] == nullptr)
+						{
+							failures++;
+						}
+					}
+
+					for (auto i = 0u; i < BatchSize; ++i)
+					{
+						pool.Free(pHandles[i]);
+					}
+				}
+			});
+		}
+
+		while (ready.load() != threadCount)
+		{
+			std::this_thread::yield();
+		}
+
+		auto start = std::chrono::steady_clock::now();
+		isStarted = true;
+		for (auto& thread : threads)
+		{
+			thread.join();
+		}
+		auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		CHECK(failures.load() == 0);
+		CHECK(pool.GetUsedCount() == 0);
+		return double(threadCount) * roundCount * BatchSize / seconds * 1.0e-6;
+	}
+} // namespace
+
+// contention of the mutex Pool against LockFreePool, for 1 to 32 threads.
+// --quick runs up to 4 threads briefly, to keep the program working under ctest
+int main(int argc, char** argv)
+{
+	auto isQuick = (argc > 1 && strcmp(argv[1], "--quick") == 0);
+	auto roundCount = isQuick ? 2000u : 200000u;
+
+	printf("hardware threads %u\n", std::thread::hardware_concurrency());
+
+	const uint32_t threadCounts[] = { 1, 2, 4, 8, 16, 32 };
+	for (auto threadCount : threadCounts)
+	{
+		if (isQuick && threadCount > 4)
+		{
+			break;
+		}
+
+		// the same capacity for both, enough for every batch and every magazine
+		const uint32_t Capacity = 4096;
+
+		Pool<Handle> mutexPool;
+		CHECK(mutexPool.Init(Capacity));
+		LockFreePool<Handle> lockFreePool;
+		CHECK(lockFreePool.Init(Capacity));
+
+		// total work is the same for every thread count
+		auto rounds = std::max(roundCount / threadCount, 1u);
+		auto mutexRate = Run(mutexPool, threadCount, rounds);
+		auto lockFreeRate = Run(lockFreePool, threadCount, rounds);
+		printf("threads %2u : Pool %8.2f Mops/s, LockFreePool %8.2f Mops/s (x%.2f)\n",
+			threadCount, mutexRate, lockFreeRate, lockFreeRate / mutexRate);
+	}
+
+	return TEST_RESULT();
+}
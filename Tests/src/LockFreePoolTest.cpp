@@ -0,0 +1,247 @@
+#include "LockFreePool.h"
+#include "TestUtil.h"
+#include <atomic>
+#include <new>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace {
+	// separate template arguments give each test its own thread slots
+	typedef LockFreePool<uint64_t, 16, 64> BasicPool;
+	typedef LockFreePool<uint32_t, 16, 64> StealPool;
+	typedef LockFreePool<uint16_t, 4, 2> SlotPool;
+
+	void TestAlloc()
+	{
+		BasicPool pool;
+		CHECK(!pool.Init(0));
+		CHECK(pool.Init(100));
+		CHECK(pool.GetSize() == 100);
+
+		// every item once, then nothing
+		std::set<uint32_t> indices;
+		std::vector<uint64_t*> items;
+		for (auto i = 0; i < 100; ++i)
+		{
+			auto pItem = pool.Alloc([&](uint32_t index, uint64_t* pValue)
+			{
+				indices.insert(index);
+				*pValue = index;
+			});
+			if (!CHECK(pItem != nullptr))
+			{
+				return;
+			}
+			items.push_back(pItem);
+		}
+		CHECK(indices.size() == 100);
+		CHECK(pool.GetAvailableCount() == 0);
+		CHECK(pool.Alloc() == nullptr);
+
+		for (auto pItem : items)
+		{
+			pool.Free(pItem);
+		}
+		pool.Free(nullptr);
+		CHECK(pool.GetUsedCount() == 0);
+		CHECK(pool.GetAvailableCount() == 100);
+
+		// a full magazine sends half of it back to the shared stack, so one magazine is parked at most
+		CHECK(pool.GetParkedCount() > 0 && pool.GetParkedCount() <= 16);
+		pool.Term();
+		CHECK(pool.GetSize() == 0);
+
+		// a pool on the heap, as a DescriptorPool holds it
+		auto pHeapPool = new (std::nothrow) BasicPool();
+		if (CHECK(pHeapPool != nullptr))
+		{
+			CHECK(pHeapPool->Init(8));
+			auto pItem = pHeapPool->Alloc();
+			CHECK(pItem != nullptr && pHeapPool->GetUsedCount() == 1);
+			pHeapPool->Free(pItem);
+			CHECK(pHeapPool->GetUsedCount() == 0);
+			delete pHeapPool;
+		}
+	}
+
+	// items parked in the magazine of a live thread are taken when the shared stack is empty
+	void TestSteal()
+	{
+		const uint32_t Capacity = 64;
+
+		StealPool pool;
+		CHECK(pool.Init(Capacity));
+
+		std::atomic<int> state(0);
+		std::thread other([&]()
+		{
+			// park a few items, then stay alive
+			std::vector<uint32_t*> items;
+			for (auto i = 0; i < 6; ++i)
+			{
+				items.push_back(pool.Alloc());
+			}
+			for (auto pItem : items)
+			{
+				pool.Free(pItem);
+			}
+
+			state = 1;
+			while (state.load() != 2)
+			{
+				std::this_thread::yield();
+			}
+		});
+
+		while (state.load() != 1)
+		{
+			std::this_thread::yield();
+		}
+		CHECK(pool.GetParkedCount() == 8);
+
+		// the whole capacity, whichever magazine it sits in
+		std::vector<uint32_t*> items;
+		for (auto i = 0u; i < Capacity; ++i)
+		{
+			auto pItem = pool.Alloc();
+			if (!CHECK(pItem != nullptr))
+			{
+				break;
+			}
+			items.push_back(pItem);
+		}
+		CHECK(pool.Alloc() == nullptr);
+		CHECK(pool.GetAvailableCount() == 0);
+		CHECK(pool.GetParkedCount() == 0);
+
+		state = 2;
+		other.join();
+
+		for (auto pItem : items)
+		{
+			pool.Free(pItem);
+		}
+		CHECK(pool.GetAvailableCount() == Capacity);
+	}
+
+	// an exiting thread flushes its magazine, and its slot goes to the next thread
+	void TestThreadExit()
+	{
+		SlotPool pool;
+		CHECK(pool.Init(32));
+
+		for (auto i = 0; i < 10; ++i)
+		{
+			auto parked = 0u;
+			std::thread thread([&]()
+			{
+				auto pItem = pool.Alloc();
+				pool.Free(pItem);
+
+				// only a thread with a slot parks the item
+				parked = pool.GetParkedCount();
+			});
+			thread.join();
+
+			if (!CHECK(parked > 0) || !CHECK(pool.GetParkedCount() == 0))
+			{
+				break;
+			}
+		}
+
+		// a pool created later starts without the magazines of threads gone before
+		SlotPool other;
+		CHECK(other.Init(4));
+		for (auto i = 0; i < 4; ++i)
+		{
+			CHECK(other.Alloc() != nullptr);
+		}
+	}
+
+	// items are never handed to two owners, and every item comes back
+	void TestConcurrent()
+	{
+		const uint32_t Capacity = 256;
+		const int ThreadCount = 8;
+
+		BasicPool pool;
+		CHECK(pool.Init(Capacity));
+
+		std::vector<std::atomic<int>> owners(Capacity);
+		for (auto& owner : owners)
+		{
+			owner = -1;
+		}
+
+		std::atomic<int> failures(0);
+		std::vector<std::thread> threads;
+		for (auto t = 0; t < ThreadCount; ++t)
+		{
+			threads.emplace_back([&, t]()
+			{
+				TestUtil::Random random(static_cast<uint64_t>(t));
+				std::vector<std::pair<uint32_t, uint64_t*>> held;
+				for (auto step = 0; step < 20000; ++step)
+				{
+					if (held.size() < 32 && random.Next(2) == 0)
+					{
+						uint32_t index = 0;
+						auto pItem = pool.Alloc([&](uint32_t i, uint64_t*) { index = i; });
+						if (pItem == nullptr)
+						{
+							continue;
+						}
+
+						auto expected = -1;
+						if (!owners[index].compare_exchange_strong(expected, t))
+						{
+							failures++;
+						}
+						held.push_back(std::make_pair(index, pItem));
+					}
+					else if (!held.empty())
+					{
+						auto i = random.Next(uint32_t(held.size()));
+						owners[held[i].first] = -1;
+						pool.Free(held[i].second);
+						held.erase(held.begin() + i);
+					}
+				}
+
+				for (auto& item : held)
+				{
+					owners[item.first] = -1;
+					pool.Free(item.second);
+				}
+			});
+		}
+
+		for (auto& thread : threads)
+		{
+			thread.join();
+		}
+
+		CHECK(failures.load() == 0);
+		CHECK(pool.GetUsedCount() == 0);
+		CHECK(pool.GetParkedCount() == 0);
+
+		// everything is in the shared stack again
+		for (auto i = 0u; i < Capacity; ++i)
+		{
+			if (!CHECK(pool.Alloc() != nullptr))
+			{
+				break;
+			}
+		}
+	}
+} // namespace
+
+int main()
+{
+	RUN_TEST(TestAlloc);
+	RUN_TEST(TestSteal);
+	RUN_TEST(TestThreadExit);
+	RUN_TEST(TestConcurrent);
+	return TEST_RESULT();
+}
@@ -0,0 +1,134 @@
+#include "MaterialTable.h"
+#include "FrameUploadAllocator.h"
+#include "FakeDevice.h"
+#include "TestUtil.h"
+#include <cstring>
+
+namespace {
+	// copy the table to the memory of the current frame, as Material::PushIndexTable() does
+	const MaterialIndices* Push(const MaterialTable& table, FrameUploadAllocator& allocator)
+	{
+		auto allocation = allocator.Alloc(table.GetSize());
+		if (!allocation.IsValid())
+		{
+			return nullptr;
+		}
+
+		memcpy(allocation.pCPU, table.GetData(), table.GetSize());
+		return allocation.GetPtr<MaterialIndices>();
+	}
+
+	void TestInit()
+	{
+		MaterialTable table;
+		CHECK(!table.Init(0, 1));
+		CHECK(table.GetCount() == 0);
+
+		CHECK(table.Init(3, 7));
+		CHECK(table.GetCount() == 3);
+		CHECK(table.GetSize() == 3 * sizeof(MaterialIndices));
+
+		// every slot starts with the default index
+		for (auto i = 0u; i < 3; ++i)
+		{
+			for (auto slot = 0u; slot < MaterialTable::SlotCount; ++slot)
+			{
+				CHECK(table.GetTexture(i, slot) == 7);
+			}
+		}
+
+		table.Term();
+		CHECK(table.GetCount() == 0);
+		CHECK(table.GetSize() == 0);
+	}
+
+	void TestSlots()
+	{
+		MaterialTable table;
+		CHECK(table.Init(2, 0));
+
+		// slots follow the members of MaterialIndices
+		CHECK(table.SetTexture(1, 0, 10));
+		CHECK(table.SetTexture(1, 1, 11));
+		CHECK(table.SetTexture(1, 2, 12));
+		CHECK(table.SetTexture(1, 3, 13));
+
+		const auto& entry = table.GetData()[1];
+		CHECK(entry.BaseColor == 10);
+		CHECK(entry.Metallic == 11);
+		CHECK(entry.Roughness == 12);
+		CHECK(entry.Normal == 13);
+
+		CHECK(table.GetTexture(1, 2) == 12);
+		CHECK(table.GetData()[0].BaseColor == 0);
+
+		// out of range leaves the table as it is
+		CHECK(!table.SetTexture(2, 0, 99));
+		CHECK(!table.SetTexture(0, MaterialTable::SlotCount, 99));
+		CHECK(table.GetTexture(2, 0) == 0);
+		CHECK(table.GetTexture(1, MaterialTable::SlotCount) == 0);
+		CHECK(table.GetData()[0].Normal == 0);
+	}
+
+	// the copy of a frame in flight does not change when the table changes in a later frame
+	void TestFrameCopies()
+	{
+		const uint32_t FrameCount = 3;
+
+		auto pDevice = new Fake::Device();
+		{
+			FrameUploadAllocator allocator;
+			CHECK(allocator.Init(pDevice, FrameCount, 64 * 1024));
+
+			MaterialTable table;
+			CHECK(table.Init(100, 1));
+
+			const MaterialIndices* pCopies[FrameCount] = {};
+			for (auto frame = 0u; frame < FrameCount; ++frame)
+			{
+				allocator.Begin(frame);
+				CHECK(table.SetTexture(5, 0, 100 + frame));
+
+				pCopies[frame] = Push(table, allocator);
+				if (!CHECK(pCopies[frame] != nullptr))
+				{
+					break;
+				}
+			}
+
+			if (pCopies[FrameCount - 1] != nullptr)
+			{
+				for (auto frame = 0u; frame < FrameCount; ++frame)
+				{
+					CHECK(pCopies[frame][5].BaseColor == 100 + frame);
+					CHECK(pCopies[frame][4].BaseColor == 1);
+				}
+
+				// reusing a frame rewrites only the memory of that frame
+				allocator.Begin(0);
+				CHECK(table.SetTexture(5, 0, 200));
+				auto pCopy = Push(table, allocator);
+				CHECK(pCopy != nullptr && pCopy[5].BaseColor == 200);
+				CHECK(pCopies[1][5].BaseColor == 101);
+				CHECK(pCopies[2][5].BaseColor == 102);
+			}
+
+			// a table larger than the frame buffer does not fit
+			MaterialTable large;
+			CHECK(large.Init(64 * 1024, 1));
+			CHECK(Push(large, allocator) == nullptr);
+
+			allocator.Term();
+		}
+		pDevice->Release();
+		CHECK(Fake::LiveCount() == 0);
+	}
+} // namespace
+
+int main()
+{
+	RUN_TEST(TestInit);
+	RUN_TEST(TestSlots);
+	RUN_TEST(TestFrameCopies);
+	return TEST_RESULT();
+}
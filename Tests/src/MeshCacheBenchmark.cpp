@@ -0,0 +1,290 @@
+#include "MeshCache.h"
+#include "IndexFormat.h"
+#include "MappedFile.h"
+#include "TestUtil.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+#if defined(HAS_ASSIMP)
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+#include <assimp/postprocess.h>
+#endif
+
+//
+// MeshVertex layout, which ResMesh.cpp defines in the sample. It needs assimp, so it is not built here.
+//
+const D3D12_INPUT_ELEMENT_DESC MeshVertex::InputElements[] = {
+	{ "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+	{ "NORMAL",   0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+	{ "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT,    0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+	{ "TANGENT",  0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 }
+};
+const D3D12_INPUT_LAYOUT_DESC MeshVertex::InputLayout = { MeshVertex::InputElements, MeshVertex::InputElementCout };
+
+namespace {
+	// write a dense scan as OBJ text: a wavy grid of side x side vertices
+	bool WriteScan(const std::string& path, uint32_t side)
+	{
+		auto pFile = fopen(path.c_str(), "w");
+		if (pFile == nullptr)
+		{
+			return false;
+		}
+
+		for (auto y = 0u; y < side; ++y)
+		{
+			for (auto x = 0u; x < side; ++x)
+			{
+				auto u = float(x) / float(side - 1);
+				auto v = float(y) / float(side - 1);
+				auto h = 0.2f * std::sin(u * 20.0f) * std::cos(v * 13.0f);
+				auto nx = -4.0f * std::cos(u * 20.0f) * std::cos(v * 13.0f) / 10.0f;
+				auto ny = 2.6f * std::sin(u * 20.0f) * std::sin(v * 13.0f) / 10.0f;
+				auto length = std::sqrt(nx * nx + ny * ny + 1.0f);
+				fprintf(pFile, "v %f %f %f\nvt %f %f\nvn %f %f %f\n",
+					u * 10.0f, v * 10.0f, h, u, v, nx / length, ny / length, 1.0f / length);
+			}
+		}
+
+		for (auto y = 0u; y + 1 < side; ++y)
+		{
+			for (auto x = 0u; x + 1 < side; ++x)
+			{
+				// OBJ indices start at 1
+				auto i = y * side + x + 1;
+				fprintf(pFile, "f %u/%u/%u %u/%u/%u %u/%u/%u\n", i, i, i, i + 1, i + 1, i + 1, i + side, i + side, i + side);
+				fprintf(pFile, "f %u/%u/%u %u/%u/%u %u/%u/%u\n", i + 1, i + 1, i + 1, i + side + 1, i + side + 1, i + side + 1, i + side, i + side, i + side);
+			}
+		}
+
+		return fclose(pFile) == 0;
+	}
+
+	// the least a text import does: parse the numbers of an OBJ file whose face corners share one
+	// index. vertices are not welded and tangents are not computed, so a real importer is slower
+	bool ParseScan(const wchar_t* path, ResMesh& mesh)
+	{
+		MappedFile file;
+		if (!file.Open(path))
+		{
+			return false;
+		}
+
+		// strtof() stops at the end of the number, a copy makes the text end with a terminator
+		std::string text(reinterpret_cast<const char*>(file.GetData()), file.GetSize());
+		std::vector<DirectX::XMFLOAT3> positions;
+		std::vector<DirectX::XMFLOAT2> texcoords;
+		std::vector<DirectX::XMFLOAT3> normals;
+
+		mesh.Vertices.clear();
+		mesh.Indices.clear();
+		mesh.MaterialId = 0;
+
+		auto p = text.c_str();
+		while (*p != '\0')
+		{
+			char* end = nullptr;
+			if (p[0] == 'v' && p[1] == ' ')
+			{
+				DirectX::XMFLOAT3 value;
+				value.x = strtof(p + 2, &end);
+				value.y = strtof(end, &end);
+				value.z = strtof(end, &end);
+				positions.push_back(value);
+				p = end;
+			}
+			else if (p[0] == 'v' && p[1] == 't')
+			{
+				DirectX::XMFLOAT2 value;
+				value.x = strtof(p + 2, &end);
+				value.y = strtof(end, &end);
+				texcoords.push_back(value);
+				p = end;
+			}
+			else if (p[0] == 'v' && p[1] == 'n')
+			{
+				DirectX::XMFLOAT3 value;
+				value.x = strtof(p + 2, &end);
+				value.y = strtof(end, &end);
+				value.z = strtof(end, &end);
+				normals.push_back(value);
+				p = end;
+			}
+			else if (p[0] == 'f' && p[1] == ' ')
+			{
+				end = const_cast<char*>(p + 1);
+				for (auto i = 0; i < 3; ++i)
+				{
+					auto index = strtoul(end, &end, 10);
+					strtoul(end + 1, &end, 10);
+					strtoul(end + 1, &end, 10);
+					mesh.Indices.push_back(uint32_t(index - 1));
+				}
+				p = end;
+			}
+
+			p = strchr(p, '\n');
+			if (p == nullptr)
+			{
+				break;
+			}
+			p++;
+		}
+
+		if (positions.size() != texcoords.size() || positions.size() != normals.size())
+		{
+			return false;
+		}
+
+		mesh.Vertices.resize(positions.size());
+		for (size_t i = 0; i < positions.size(); ++i)
+		{
+			mesh.Vertices[i] = MeshVertex(positions[i], normals[i], texcoords[i], DirectX::XMFLOAT3(1.0f, 0.0f, 0.0f));
+		}
+		return true;
+	}
+
+#if defined(HAS_ASSIMP)
+	// import as LoadMesh() does, with the flags of the sample
+	size_t ImportScan(const std::string& path)
+	{
+		Assimp::Importer importer;
+		auto pScene = importer.ReadFile(path,
+			aiProcess_Triangulate
+			| aiProcess_PreTransformVertices
+			| aiProcess_CalcTangentSpace
+			| aiProcess_GenSmoothNormals
+			| aiProcess_GenUVCoords
+			| aiProcess_RemoveRedundantMaterials
+			| aiProcess_OptimizeMeshes);
+
+		size_t vertexCount = 0;
+		for (auto i = 0u; pScene != nullptr && i < pScene->mNumMeshes; ++i)
+		{
+			vertexCount += pScene->mMeshes[i]->mNumVertices;
+		}
+		return vertexCount;
+	}
+#endif
+
+	// open the cooked file and read every byte the upload would copy
+	uint64_t OpenCooked(const wchar_t* path, uint64_t key, MeshCache& cache)
+	{
+		if (!cache.Open(path, key, VERTEX_FORMAT_QUANTIZED))
+		{
+			return 0;
+		}
+
+		uint64_t sum = 1;
+		for (size_t i = 0; i < cache.GetMeshCount(); ++i)
+		{
+			const auto& mesh = cache.GetMesh(i);
+			auto pVertices = static_cast<const uint8_t*>(mesh.pVertices);
+			auto vertexSize = size_t(GetVertexStride(VERTEX_FORMAT_QUANTIZED)) * mesh.VertexCount;
+			for (size_t j = 0; j < vertexSize; j += 64)
+			{
+				sum += pVertices[j];
+			}
+
+			auto pIndices = static_cast<const uint8_t*>(mesh.pIndices);
+			auto indexSize = size_t(GetIndexStride(mesh.IndexFormat)) * mesh.IndexCount;
+			for (size_t j = 0; j < indexSize; j += 64)
+			{
+				sum += pIndices[j];
+			}
+		}
+		return sum;
+	}
+
+	double GetElapsedMsec(std::chrono::steady_clock::time_point start)
+	{
+		auto end = std::chrono::steady_clock::now();
+		return std::chrono::duration<double, std::milli>(end - start).count();
+	}
+} // namespace
+
+// load time of scans of growing size: parsing the OBJ text (and importing it with assimp when
+// the build found it) against opening the cooked file, whose vertices and indices are read in
+// place. the cooked file is in the page cache, as on the second launch of the sample.
+// --quick runs the small scan once, to keep the program working under ctest
+int main(int argc, char** argv)
+{
+	auto isQuick = (argc > 1 && strcmp(argv[1], "--quick") == 0);
+	auto repeatCount = isQuick ? 1 : 5;
+
+	const uint32_t sides[] = { 128, 512, 1024 };
+	for (auto side : sides)
+	{
+		if (isQuick && side > 128)
+		{
+			break;
+		}
+
+		auto name = "MeshCacheBenchmark_" + std::to_string(getpid()) + ".obj";
+		auto path = std::wstring(name.begin(), name.end());
+		auto cachePath = GetMeshCachePath(path.c_str());
+		if (!CHECK(WriteScan(name, side)))
+		{
+			break;
+		}
+
+		// cook once, as the first launch does
+		ResMesh mesh;
+		CHECK(ParseScan(path.c_str(), mesh));
+		CHECK(mesh.Vertices.size() == size_t(side) * side);
+
+		auto start = std::chrono::steady_clock::now();
+		std::vector<ResMesh> meshes(1, mesh);
+		SplitLargeMeshes(meshes);
+		std::vector<uint8_t> data;
+		SerializeMeshCache(1, VERTEX_FORMAT_QUANTIZED, meshes, std::vector<ResMaterial>(), data);
+		CHECK(SaveMeshCache(cachePath.c_str(), data));
+		auto cookTime = GetElapsedMsec(start);
+
+		auto parseTime = 1.0e30;
+		auto openTime = 1.0e30;
+		for (auto repeat = 0; repeat < repeatCount; ++repeat)
+		{
+			start = std::chrono::steady_clock::now();
+			CHECK(ParseScan(path.c_str(), mesh));
+			parseTime = std::min(parseTime, GetElapsedMsec(start));
+
+			MeshCache cache;
+			start = std::chrono::steady_clock::now();
+			CHECK(OpenCooked(cachePath.c_str(), 1, cache) != 0);
+			openTime = std::min(openTime, GetElapsedMsec(start));
+			CHECK(cache.GetMeshCount() == meshes.size());
+		}
+
+		MappedFile source;
+		CHECK(source.Open(path.c_str()));
+		printf("vertices %7u : obj %7.2f MB parse %8.2f msec | cooked %6.2f MB open %7.3f msec (%6.1fx) | cook %8.2f msec\n",
+			side * side,
+			double(source.GetSize()) / (1024.0 * 1024.0),
+			parseTime,
+			double(data.size()) / (1024.0 * 1024.0),
+			openTime,
+			parseTime / openTime,
+			cookTime);
+		source.Close();
+
+	#if defined(HAS_ASSIMP)
+		start = std::chrono::steady_clock::now();
+		CHECK(ImportScan(name) > 0);
+		printf("  assimp import %8.2f msec\n", GetElapsedMsec(start));
+	#endif
+
+		DeleteFileW(path.c_str());
+		DeleteFileW(cachePath.c_str());
+	}
+
+	return TEST_RESULT();
+}
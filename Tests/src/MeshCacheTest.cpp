@@ -0,0 +1,337 @@
+#include "MeshCache.h"
+#include "IndexFormat.h"
+#include "TestUtil.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+//
+// MeshVertex layout, which ResMesh.cpp defines in the sample. It needs assimp, so it is not built here.
+//
+const D3D12_INPUT_ELEMENT_DESC MeshVertex::InputElements[] = {
+	{ "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+	{ "NORMAL",   0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+	{ "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT,    0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+	{ "TANGENT",  0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 }
+};
+const D3D12_INPUT_LAYOUT_DESC MeshVertex::InputLayout = { MeshVertex::InputElements, MeshVertex::InputElementCout };
+
+namespace {
+	// offset of the IndexStride of the first mesh (after the 40-byte header)
+	const size_t FirstIndexStrideOffset = 40 + 28;
+
+	// a grid of side x side vertices, moved by the id
+	ResMesh MakeGrid(uint32_t side, uint32_t id)
+	{
+		ResMesh mesh;
+		mesh.MaterialId = id;
+		for (auto y = 0u; y < side; ++y)
+		{
+			for (auto x = 0u; x < side; ++x)
+			{
+				auto u = float(x) / float(side - 1);
+				auto v = float(y) / float(side - 1);
+				mesh.Vertices.push_back(MeshVertex(
+					DirectX::XMFLOAT3(u * 4.0f + float(id), v * 2.0f, 0.1f * std::sin(u * 7.0f)),
+					DirectX::XMFLOAT3(0.0f, 0.0f, 1.0f),
+					DirectX::XMFLOAT2(u, v),
+					DirectX::XMFLOAT3(1.0f, 0.0f, 0.0f)));
+			}
+		}
+
+		for (auto y = 0u; y + 1 < side; ++y)
+		{
+			for (auto x = 0u; x + 1 < side; ++x)
+			{
+				auto i = y * side + x;
+				uint32_t quad[6] = { i, i + 1, i + side, i + 1, i + side + 1, i + side };
+				mesh.Indices.insert(mesh.Indices.end(), quad, quad + 6);
+			}
+		}
+		return mesh;
+	}
+
+	std::vector<ResMaterial> MakeMaterials()
+	{
+		std::vector<ResMaterial> materials(2);
+		materials[0].Diffuse = DirectX::XMFLOAT3(0.5f, 0.25f, 1.0f);
+		materials[0].Specular = DirectX::XMFLOAT3(1.0f, 1.0f, 1.0f);
+		materials[0].Alpha = 0.75f;
+		materials[0].Shininess = 32.0f;
+		materials[0].DiffuseMap = L"wall_bc.dds";
+		materials[0].NormalMap = L"wall_n.dds";
+		materials[1].Diffuse = DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f);
+		materials[1].Specular = DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f);
+		materials[1].Alpha = 1.0f;
+		materials[1].Shininess = 0.0f;
+		return materials;
+	}
+
+	// whether the cooked mesh holds the encoded vertices and the indices of the source
+	bool IsCookedFrom(const CookedMesh& cooked, const ResMesh& source, VERTEX_FORMAT format)
+	{
+		std::vector<uint8_t> vertices;
+		VertexQuantization quantization;
+		EncodeVertices(format, source.Vertices, vertices, quantization);
+
+		if (cooked.VertexCount != source.Vertices.size() || cooked.IndexCount != source.Indices.size())
+		{
+			return false;
+		}
+		if (cooked.MaterialId != source.MaterialId || memcmp(cooked.pVertices, vertices.data(), vertices.size()) != 0)
+		{
+			return false;
+		}
+		if (memcmp(&cooked.Quantization, &quantization, sizeof(quantization)) != 0)
+		{
+			return false;
+		}
+		if (cooked.IndexFormat != SelectIndexFormat(source.Vertices.size()))
+		{
+			return false;
+		}
+
+		for (uint32_t i = 0; i < cooked.IndexCount; ++i)
+		{
+			auto index = (cooked.IndexFormat == DXGI_FORMAT_R16_UINT)
+				? static_cast<const uint16_t*>(cooked.pIndices)[i]
+				: static_cast<const uint32_t*>(cooked.pIndices)[i];
+			if (index != source.Indices[i])
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// the cooked data is what the buffers upload: encoded vertices and 16-bit indices where they fit
+	void TestRoundTrip()
+	{
+		std::vector<ResMesh> meshes;
+		meshes.push_back(MakeGrid(10, 0));
+		meshes.push_back(MakeGrid(300, 1));
+		meshes.push_back(MakeGrid(3, 2));
+		auto materials = MakeMaterials();
+
+		for (auto i = 0; i < VERTEX_FORMAT_COUNT; ++i)
+		{
+			auto format = VERTEX_FORMAT(i);
+
+			std::vector<uint8_t> data;
+			SerializeMeshCache(42, format, meshes, materials, data);
+
+			MeshCache cache;
+			CHECK(cache.Init(data, 42, format));
+			CHECK(data.empty());
+			CHECK(cache.GetMeshCount() == 3);
+			for (size_t j = 0; j < meshes.size(); ++j)
+			{
+				const auto& cooked = cache.GetMesh(j);
+				CHECK(IsCookedFrom(cooked, meshes[j], format));
+				CHECK(uintptr_t(cooked.pVertices) % 16 == 0 && uintptr_t(cooked.pIndices) % 16 == 0);
+			}
+
+			// an unsplit mesh keeps its 32-bit indices
+			CHECK(cache.GetMesh(0).IndexFormat == DXGI_FORMAT_R16_UINT);
+			CHECK(cache.GetMesh(1).IndexFormat == DXGI_FORMAT_R32_UINT);
+
+			// bounding sphere of the AABB
+			auto minZ = FLT_MAX;
+			auto maxZ = -FLT_MAX;
+			for (const auto& vertex : meshes[0].Vertices)
+			{
+				minZ = std::min(minZ, vertex.Position.z);
+				maxZ = std::max(maxZ, vertex.Position.z);
+			}
+			const auto& bounds = cache.GetMesh(0).Bounds;
+			auto dz = maxZ - minZ;
+			CHECK(std::fabs(bounds.x - 2.0f) < 1.0e-5f && std::fabs(bounds.y - 1.0f) < 1.0e-5f);
+			CHECK(std::fabs(bounds.z - (minZ + maxZ) * 0.5f) < 1.0e-5f);
+			CHECK(std::fabs(bounds.w - 0.5f * std::sqrt(16.0f + 4.0f + dz * dz)) < 1.0e-4f);
+
+			const auto& restored = cache.GetMaterials();
+			CHECK(restored.size() == 2);
+			CHECK(restored[0].Diffuse.y == 0.25f && restored[0].Alpha == 0.75f && restored[0].Shininess == 32.0f);
+			CHECK(restored[0].DiffuseMap == L"wall_bc.dds" && restored[0].NormalMap == L"wall_n.dds");
+			CHECK(restored[0].SpecularMap.empty() && restored[1].DiffuseMap.empty());
+
+			cache.Term();
+			CHECK(cache.GetMeshCount() == 0 && cache.GetMaterials().empty());
+		}
+
+		// split meshes are all stored with 16-bit indices
+		SplitLargeMeshes(meshes);
+		std::vector<uint8_t> data;
+		SerializeMeshCache(42, VERTEX_FORMAT_QUANTIZED, meshes, materials, data);
+
+		MeshCache cache;
+		CHECK(cache.Init(data, 42, VERTEX_FORMAT_QUANTIZED));
+		CHECK(cache.GetMeshCount() == meshes.size());
+		for (size_t i = 0; i < cache.GetMeshCount(); ++i)
+		{
+			CHECK(cache.GetMesh(i).IndexFormat == DXGI_FORMAT_R16_UINT);
+			CHECK(IsCookedFrom(cache.GetMesh(i), meshes[i], VERTEX_FORMAT_QUANTIZED));
+		}
+	}
+
+	// stale, foreign and broken data is a cache miss
+	void TestReject()
+	{
+		std::vector<ResMesh> meshes;
+		meshes.push_back(MakeGrid(4, 0));
+		meshes.push_back(MakeGrid(3, 1));
+		auto materials = MakeMaterials();
+
+		std::vector<uint8_t> data;
+		SerializeMeshCache(7, VERTEX_FORMAT_COMPACT, meshes, materials, data);
+
+		MeshCache cache;
+		auto copy = data;
+		CHECK(!cache.Init(copy, 8, VERTEX_FORMAT_COMPACT));
+		copy = data;
+		CHECK(!cache.Init(copy, 7, VERTEX_FORMAT_QUANTIZED));
+		CHECK(cache.GetMeshCount() == 0);
+
+		// every truncation is rejected
+		for (size_t size = 0; size < data.size(); ++size)
+		{
+			std::vector<uint8_t> truncated(data.begin(), data.begin() + size);
+			if (!CHECK(!cache.Init(truncated, 7, VERTEX_FORMAT_COMPACT)) || !CHECK(cache.GetMeshCount() == 0))
+			{
+				break;
+			}
+		}
+
+		copy = data;
+		copy[0] ^= 0xff;
+		CHECK(!cache.Init(copy, 7, VERTEX_FORMAT_COMPACT));
+
+		copy = data;
+		copy[FirstIndexStrideOffset] = 3;
+		CHECK(!cache.Init(copy, 7, VERTEX_FORMAT_COMPACT));
+
+		// a huge count in a small file is rejected before allocating
+		copy = data;
+		copy[19] = 0x7f;
+		CHECK(!cache.Init(copy, 7, VERTEX_FORMAT_COMPACT));
+
+		copy = data;
+		CHECK(cache.Init(copy, 7, VERTEX_FORMAT_COMPACT));
+		CHECK(cache.GetMeshCount() == 2);
+	}
+
+	// a saved file is read in place through the mapping
+	void TestFile()
+	{
+		auto path = GetMeshCachePath((L"MeshCacheTest_" + std::to_wstring(getpid()) + L".obj").c_str());
+		CHECK(path.size() > 7 && path.compare(path.size() - 7, 7, L".cooked") == 0);
+
+		std::vector<ResMesh> meshes;
+		meshes.push_back(MakeGrid(20, 0));
+		auto materials = MakeMaterials();
+
+		std::vector<uint8_t> data;
+		SerializeMeshCache(3, VERTEX_FORMAT_QUANTIZED, meshes, materials, data);
+		CHECK(SaveMeshCache(path.c_str(), data));
+		CHECK(!SaveMeshCache(nullptr, data));
+
+		MeshCache cache;
+		CHECK(!cache.Open(path.c_str(), 4, VERTEX_FORMAT_QUANTIZED));
+		CHECK(cache.Open(path.c_str(), 3, VERTEX_FORMAT_QUANTIZED));
+		CHECK(cache.GetMeshCount() == 1);
+		CHECK(IsCookedFrom(cache.GetMesh(0), meshes[0], VERTEX_FORMAT_QUANTIZED));
+		CHECK(cache.GetMaterials().size() == 2);
+		cache.Term();
+
+		DeleteFileW(path.c_str());
+		CHECK(!cache.Open(path.c_str(), 3, VERTEX_FORMAT_QUANTIZED));
+
+		// the key covers the source, the importer flags and the format version
+		const char source[] = "v 0 0 0";
+		auto key = ComputeMeshCacheKey(nullptr, source, sizeof(source), 1);
+		CHECK(key == ComputeMeshCacheKey(nullptr, source, sizeof(source), 1));
+		CHECK(key != ComputeMeshCacheKey(nullptr, source, sizeof(source), 2));
+		CHECK(key != ComputeMeshCacheKey(nullptr, source, sizeof(source) - 1, 1));
+	}
+
+	// write a text file
+	bool WriteText(const std::string& path, const char* text)
+	{
+		auto pFile = fopen(path.c_str(), "wb");
+		if (pFile == nullptr)
+		{
+			return false;
+		}
+
+		fputs(text, pFile);
+		fclose(pFile);
+		return true;
+	}
+
+	// the key covers the material libraries of the source and the textures they refer to
+	void TestDependencies()
+	{
+		auto prefix = "MeshCacheTest_" + std::to_string(getpid());
+		auto objPath = prefix + ".obj";
+		auto mtlPath = prefix + ".mtl";
+		auto texturePath = prefix + "_bc.dds";
+
+		auto source = "mtllib " + mtlPath + "\nv 0 0 0\nusemtl wall\n";
+		auto filename = std::wstring(objPath.begin(), objPath.end());
+		auto GetKey = [&]()
+		{
+			return ComputeMeshCacheKey(filename.c_str(), source.data(), source.size(), 1);
+		};
+
+		// a library which is missing is part of the key, so creating it changes the key
+		auto missing = GetKey();
+		CHECK(missing != ComputeMeshCacheKey(nullptr, source.data(), source.size(), 1));
+
+		auto material = "newmtl wall\nKd 0.8 0.8 0.8\nmap_Kd -bm 1.0 " + texturePath + "\n";
+		CHECK(WriteText(mtlPath, material.c_str()));
+		auto withLibrary = GetKey();
+		CHECK(withLibrary != missing);
+
+		CHECK(WriteText(texturePath, "DDS 1"));
+		auto withTexture = GetKey();
+		CHECK(withTexture != withLibrary);
+		CHECK(withTexture == GetKey());
+
+		// editing the library or the texture changes the key
+		CHECK(WriteText(texturePath, "DDS 2"));
+		auto editedTexture = GetKey();
+		CHECK(editedTexture != withTexture);
+
+		material = "newmtl wall\nKd 0.5 0.8 0.8\nmap_Kd -bm 1.0 " + texturePath + "\n";
+		CHECK(WriteText(mtlPath, material.c_str()));
+		CHECK(GetKey() != editedTexture);
+
+		// a texture which no statement refers to is not part of it
+		auto unused = prefix + "_unused.dds";
+		auto before = GetKey();
+		CHECK(WriteText(unused, "DDS 3"));
+		CHECK(GetKey() == before);
+
+		auto mtlName = std::wstring(mtlPath.begin(), mtlPath.end());
+		auto textureName = std::wstring(texturePath.begin(), texturePath.end());
+		auto unusedName = std::wstring(unused.begin(), unused.end());
+		DeleteFileW(mtlName.c_str());
+		DeleteFileW(textureName.c_str());
+		DeleteFileW(unusedName.c_str());
+		CHECK(GetKey() == missing);
+	}
+} // namespace
+
+int main()
+{
+	RUN_TEST(TestRoundTrip);
+	RUN_TEST(TestReject);
+	RUN_TEST(TestFile);
+	RUN_TEST(TestDependencies);
+	return TEST_RESULT();
+}
@@ -0,0 +1,260 @@
+#include "ResMesh.h"
+#include "MeshOptimizer.h"
+#include "ThreadPool.h"
+#include "TestUtil.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+namespace {
+	// vertices of one mesh are a grid of this side
+	const uint32_t GridSide = 16;
+
+	//
+	// SourceMesh structure
+	//
+	// Stands in for an aiMesh: one array per attribute, as the importer hands them over.
+	//
+	struct SourceMesh
+	{
+		std::vector<DirectX::XMFLOAT3> Positions;
+		std::vector<DirectX::XMFLOAT3> Normals;
+		std::vector<DirectX::XMFLOAT3> TexCoords;
+		std::vector<DirectX::XMFLOAT3> Tangents;
+		std::vector<uint32_t> Faces;
+		uint32_t MaterialIndex;
+	};
+
+	SourceMesh MakeSource(uint32_t id)
+	{
+		SourceMesh mesh;
+		mesh.MaterialIndex = id;
+		for (auto y = 0u; y < GridSide; ++y)
+		{
+			for (auto x = 0u; x < GridSide; ++x)
+			{
+				auto u = float(x) / float(GridSide - 1);
+				auto v = float(y) / float(GridSide - 1);
+				mesh.Positions.push_back(DirectX::XMFLOAT3(u + float(id % 64), v + float(id / 64), 0.0f));
+				mesh.Normals.push_back(DirectX::XMFLOAT3(0.0f, 0.0f, 1.0f));
+				mesh.TexCoords.push_back(DirectX::XMFLOAT3(u, v, 0.0f));
+				mesh.Tangents.push_back(DirectX::XMFLOAT3(1.0f, 0.0f, 0.0f));
+			}
+		}
+
+		// rows in a scrambled order, so the optimizer has work to do
+		for (auto k = 0u; k + 1 < GridSide; ++k)
+		{
+			auto y = (k * 7) % (GridSide - 1);
+			for (auto x = 0u; x + 1 < GridSide; ++x)
+			{
+				auto i = y * GridSide + x;
+				uint32_t quad[6] = { i, i + 1, i + GridSide, i + 1, i + GridSide + 1, i + GridSide };
+				mesh.Faces.insert(mesh.Faces.end(), quad, quad + 6);
+			}
+		}
+		return mesh;
+	}
+
+	// what MeshLoader::Load() runs for each mesh: copy the attribute streams, then optimize
+	void ConvertMesh(const SourceMesh& src, ResMesh& dst)
+	{
+		dst.MaterialId = src.MaterialIndex;
+		dst.Vertices.resize(src.Positions.size());
+
+		auto pDst = dst.Vertices.data();
+		const auto count = src.Positions.size();
+		for (size_t i = 0; i < count; ++i)
+		{
+			pDst[i].Position = src.Positions[i];
+		}
+		for (size_t i = 0; i < count; ++i)
+		{
+			pDst[i].Normal = src.Normals[i];
+		}
+		for (size_t i = 0; i < count; ++i)
+		{
+			pDst[i].TexCoord = DirectX::XMFLOAT2(src.TexCoords[i].x, src.TexCoords[i].y);
+		}
+		for (size_t i = 0; i < count; ++i)
+		{
+			pDst[i].Tangent = src.Tangents[i];
+		}
+
+		dst.Indices = src.Faces;
+		OptimizeMesh(dst);
+	}
+
+#if defined(HAS_ASSIMP)
+	// write the meshes as OBJ objects, each with a material of its own so that the importer
+	// keeps them apart
+	bool WriteScene(const std::string& path, const std::vector<SourceMesh>& sources)
+	{
+		auto mtlPath = path + ".mtl";
+		auto pMtl = fopen(mtlPath.c_str(), "w");
+		if (pMtl == nullptr)
+		{
+			return false;
+		}
+		for (size_t i = 0; i < sources.size(); ++i)
+		{
+			fprintf(pMtl, "newmtl m%zu\nKd %f %f %f\n", i, float(i % 97) / 97.0f, float(i / 97) / 97.0f, 0.5f);
+		}
+		fclose(pMtl);
+
+		auto pFile = fopen(path.c_str(), "w");
+		if (pFile == nullptr)
+		{
+			return false;
+		}
+
+		auto slash = mtlPath.find_last_of('/');
+		fprintf(pFile, "mtllib %s\n", mtlPath.c_str() + ((slash == std::string::npos) ? 0 : slash + 1));
+
+		size_t base = 1;
+		for (size_t i = 0; i < sources.size(); ++i)
+		{
+			const auto& src = sources[i];
+			fprintf(pFile, "o m%zu\nusemtl m%zu\n", i, i);
+			for (size_t j = 0; j < src.Positions.size(); ++j)
+			{
+				fprintf(pFile, "v %f %f %f\nvt %f %f\nvn %f %f %f\n",
+					src.Positions[j].x, src.Positions[j].y, src.Positions[j].z,
+					src.TexCoords[j].x, src.TexCoords[j].y,
+					src.Normals[j].x, src.Normals[j].y, src.Normals[j].z);
+			}
+			for (size_t j = 0; j < src.Faces.size(); j += 3)
+			{
+				auto a = base + src.Faces[j + 0];
+				auto b = base + src.Faces[j + 1];
+				auto c = base + src.Faces[j + 2];
+				fprintf(pFile, "f %zu/%zu/%zu %zu/%zu/%zu %zu/%zu/%zu\n", a, a, a, b, b, b, c, c, c);
+			}
+			base += src.Positions.size();
+		}
+
+		return fclose(pFile) == 0;
+	}
+#endif
+
+	// msec of fn, best of the repeats
+	template<typename Func>
+	double Measure(int repeatCount, Func fn)
+	{
+		auto best = 1.0e30;
+		for (auto repeat = 0; repeat < repeatCount; ++repeat)
+		{
+			auto start = std::chrono::steady_clock::now();
+			fn();
+			auto end = std::chrono::steady_clock::now();
+			best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+		}
+		return best;
+	}
+} // namespace
+
+// time of the per-mesh conversion of MeshLoader::Load() over mesh count and thread count, and
+// of the whole LoadMesh() of an OBJ scene when the build found assimp. one thread is the pool
+// left uninitialized, which runs ParallelFor() serially; N threads are N - 1 workers and the
+// caller. --quick runs the small scenes with one and two threads, to keep the program working
+// under ctest
+int main(int argc, char** argv)
+{
+	auto isQuick = (argc > 1 && strcmp(argv[1], "--quick") == 0);
+	auto repeatCount = isQuick ? 1 : 3;
+
+	// powers of two up to the core count. --quick always takes the pool path once
+	auto maxThreadCount = std::max(1u, std::thread::hardware_concurrency());
+	std::vector<uint32_t> threadCounts;
+	for (auto count = 1u; count < maxThreadCount; count *= 2)
+	{
+		threadCounts.push_back(count);
+	}
+	threadCounts.push_back(maxThreadCount);
+	if (isQuick)
+	{
+		threadCounts.assign({ 1, 2 });
+	}
+
+	const uint32_t meshCounts[] = { 16, 256, 1024, 4096 };
+	for (auto meshCount : meshCounts)
+	{
+		if (isQuick && meshCount > 256)
+		{
+			break;
+		}
+
+		std::vector<SourceMesh> sources;
+		for (auto i = 0u; i < meshCount; ++i)
+		{
+			sources.push_back(MakeSource(i));
+		}
+
+	#if defined(HAS_ASSIMP)
+		auto name = "MeshLoadBenchmark_" + std::to_string(getpid()) + ".obj";
+		auto path = std::wstring(name.begin(), name.end());
+		CHECK(WriteScene(name, sources));
+	#endif
+
+		printf("meshes %5u (%u vertices each)\n", meshCount, GridSide * GridSide);
+
+		auto convertSerial = 0.0;
+	#if defined(HAS_ASSIMP)
+		auto loadSerial = 0.0;
+	#endif
+		for (auto threadCount : threadCounts)
+		{
+			ThreadPool pool;
+			if (threadCount > 1)
+			{
+				CHECK(pool.Init(threadCount - 1));
+			}
+
+			std::vector<ResMesh> meshes(meshCount);
+			auto convert = Measure(repeatCount, [&]()
+			{
+				pool.ParallelFor(meshes.size(), [&](size_t i)
+				{
+					ConvertMesh(sources[i], meshes[i]);
+				});
+			});
+			CHECK(meshes.back().Indices.size() == sources.back().Faces.size());
+
+			if (threadCount == 1)
+			{
+				convertSerial = convert;
+			}
+			printf("  threads %3u : convert %9.2f msec (x%5.2f)", threadCount, convert, convertSerial / convert);
+
+		#if defined(HAS_ASSIMP)
+			std::vector<ResMaterial> materials;
+			auto load = Measure(repeatCount, [&]()
+			{
+				CHECK(LoadMesh(path.c_str(), meshes, materials, &pool));
+			});
+			CHECK(meshes.size() == meshCount && materials.size() >= meshCount);
+
+			if (threadCount == 1)
+			{
+				loadSerial = load;
+			}
+			printf(" | LoadMesh %9.2f msec (x%5.2f)", load, loadSerial / load);
+		#endif
+
+			printf("\n");
+			pool.Term();
+		}
+
+	#if defined(HAS_ASSIMP)
+		DeleteFileW(path.c_str());
+		DeleteFileW((path + L".mtl").c_str());
+	#endif
+	}
+
+	return TEST_RESULT();
+}
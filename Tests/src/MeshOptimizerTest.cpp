@@ -0,0 +1,272 @@
+#include "MeshOptimizer.h"
+#include "TestUtil.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace {
+	// FIFO cache size which OptimizeMesh() reports its statistics with
+	const uint32_t CacheSize = 16;
+
+	// a UV sphere laid out like an exported mesh: a seam column of duplicated vertices and
+	// triangles in row order, which leaves the row above out of the cache
+	ResMesh MakeSphere(uint32_t rings, uint32_t segments)
+	{
+		ResMesh mesh;
+		mesh.MaterialId = 0;
+
+		for (uint32_t r = 0; r <= rings; ++r)
+		{
+			auto theta = DirectX::XM_PI * float(r) / float(rings);
+			for (uint32_t s = 0; s <= segments; ++s)
+			{
+				auto phi = 2.0f * DirectX::XM_PI * float(s) / float(segments);
+				DirectX::XMFLOAT3 normal(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+				DirectX::XMFLOAT3 tangent(-std::sin(phi), 0.0f, std::cos(phi));
+				DirectX::XMFLOAT2 texcoord(float(s) / float(segments), float(r) / float(rings));
+				mesh.Vertices.push_back(MeshVertex(normal, normal, texcoord, tangent));
+			}
+		}
+
+		for (uint32_t r = 0; r < rings; ++r)
+		{
+			for (uint32_t s = 0; s < segments; ++s)
+			{
+				auto i0 = r * (segments + 1) + s;
+				auto i1 = i0 + segments + 1;
+				uint32_t quad[] = { i0, i1, i0 + 1, i0 + 1, i1, i1 + 1 };
+				mesh.Indices.insert(mesh.Indices.end(), quad, quad + 6);
+			}
+		}
+
+		return mesh;
+	}
+
+	// triangles rotated so that the smallest index comes first, which keeps the winding
+	std::vector<std::array<uint32_t, 3>> GetTriangles(const std::vector<uint32_t>& indices)
+	{
+		std::vector<std::array<uint32_t, 3>> triangles(indices.size() / 3);
+		for (size_t t = 0; t < triangles.size(); ++t)
+		{
+			auto a = indices[t * 3 + 0];
+			auto b = indices[t * 3 + 1];
+			auto c = indices[t * 3 + 2];
+			if (b < a && b <= c)
+			{
+				triangles[t] = { b, c, a };
+			}
+			else if (c < a && c < b)
+			{
+				triangles[t] = { c, a, b };
+			}
+			else
+			{
+				triangles[t] = { a, b, c };
+			}
+		}
+
+		std::sort(triangles.begin(), triangles.end());
+		return triangles;
+	}
+
+	// every index refers to a vertex
+	bool IsInRange(const std::vector<uint32_t>& indices, size_t vertexCount)
+	{
+		for (size_t i = 0; i < indices.size(); ++i)
+		{
+			if (indices[i] >= vertexCount)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// the first use of each vertex comes in vertex order
+	bool IsInFetchOrder(const std::vector<uint32_t>& indices)
+	{
+		uint32_t next = 0;
+		for (size_t i = 0; i < indices.size(); ++i)
+		{
+			if (indices[i] > next)
+			{
+				return false;
+			}
+			if (indices[i] == next)
+			{
+				next++;
+			}
+		}
+		return true;
+	}
+
+	// a vertex is the same as another bit for bit
+	bool IsSameVertex(const MeshVertex& a, const MeshVertex& b)
+	{
+		return memcmp(&a, &b, sizeof(MeshVertex)) == 0;
+	}
+
+	// the simulated cache counts misses per triangle and per vertex
+	void TestACMR()
+	{
+		std::vector<uint32_t> empty;
+		auto atvr = 1.0f;
+		CHECK(ComputeACMR(empty, 0, CacheSize, &atvr) == 0.0f && atvr == 0.0f);
+
+		// a strip of 2 triangles misses each vertex once
+		std::vector<uint32_t> quad = { 0, 1, 2, 2, 1, 3 };
+		CHECK(ComputeACMR(quad, 4, CacheSize, &atvr) == 2.0f && atvr == 1.0f);
+
+		// a vertex which has left the cache misses again
+		std::vector<uint32_t> fan = { 0, 1, 2, 0, 2, 3, 0, 3, 4, 0, 4, 5 };
+		CHECK(ComputeACMR(fan, 6, 3, &atvr) == 1.75f && std::fabs(atvr - 7.0f / 6.0f) < 1.0e-6f);
+		CHECK(ComputeACMR(fan, 6, CacheSize, &atvr) == 1.5f && atvr == 1.0f);
+	}
+
+	// OptimizeMesh() lowers both ratios on a sphere, in row order and in random order
+	void TestStats()
+	{
+		auto sphere = MakeSphere(32, 64);
+		auto stats = OptimizeMesh(sphere);
+		printf("  row order    : ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n", stats.AcmrBefore, stats.AcmrAfter, stats.AtvrBefore, stats.AtvrAfter);
+		CHECK(stats.AcmrAfter < stats.AcmrBefore * 0.8f);
+		CHECK(stats.AtvrAfter < stats.AtvrBefore * 0.8f);
+
+		// the statistics are those of the result
+		auto atvr = 0.0f;
+		CHECK(ComputeACMR(sphere.Indices, sphere.Vertices.size(), CacheSize, &atvr) == stats.AcmrAfter);
+		CHECK(atvr == stats.AtvrAfter);
+
+		// the same triangles shuffled miss nearly every vertex, the result is as good as before
+		auto shuffled = MakeSphere(32, 64);
+		TestUtil::Random random(8);
+		auto triCount = uint32_t(shuffled.Indices.size() / 3);
+		for (uint32_t t = triCount - 1; t > 0; --t)
+		{
+			auto other = random.Next(t + 1);
+			std::swap_ranges(shuffled.Indices.begin() + t * 3, shuffled.Indices.begin() + t * 3 + 3, shuffled.Indices.begin() + other * 3);
+		}
+
+		auto shuffledStats = OptimizeMesh(shuffled);
+		printf("  random order : ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n", shuffledStats.AcmrBefore, shuffledStats.AcmrAfter, shuffledStats.AtvrBefore, shuffledStats.AtvrAfter);
+		CHECK(shuffledStats.AcmrAfter < shuffledStats.AcmrBefore * 0.5f);
+		CHECK(shuffledStats.AtvrAfter < shuffledStats.AtvrBefore * 0.5f);
+		CHECK(shuffledStats.AcmrAfter < stats.AcmrBefore);
+	}
+
+	// triangle reordering keeps every triangle and its winding
+	void TestTriangles()
+	{
+		auto sphere = MakeSphere(24, 48);
+		auto expected = GetTriangles(sphere.Indices);
+
+		auto indices = sphere.Indices;
+		OptimizeVertexCache(indices, sphere.Vertices.size());
+		CHECK(indices.size() == sphere.Indices.size());
+		CHECK(IsInRange(indices, sphere.Vertices.size()));
+		CHECK(GetTriangles(indices) == expected);
+
+		OptimizeOverdraw(indices, sphere.Vertices, CacheSize);
+		CHECK(indices.size() == sphere.Indices.size());
+		CHECK(IsInRange(indices, sphere.Vertices.size()));
+		CHECK(GetTriangles(indices) == expected);
+
+		// after the vertex remap, the triangles are the same in terms of the original vertices
+		auto vertices = sphere.Vertices;
+		OptimizeVertexFetch(vertices, indices);
+		CHECK(IsInRange(indices, vertices.size()));
+
+		std::vector<uint32_t> original(vertices.size());
+		for (size_t i = 0; i < vertices.size(); ++i)
+		{
+			auto itr = std::find_if(sphere.Vertices.begin(), sphere.Vertices.end(),
+				[&](const MeshVertex& vertex) { return IsSameVertex(vertex, vertices[i]); });
+			original[i] = uint32_t(itr - sphere.Vertices.begin());
+		}
+
+		for (auto& index : indices)
+		{
+			index = original[index];
+		}
+		CHECK(GetTriangles(indices) == expected);
+	}
+
+	// the vertex fetch remap moves data with its indices and drops unreferenced vertices
+	void TestVertexFetch()
+	{
+		TestUtil::Random random(17);
+
+		// 64 vertices of which only the even ones are used, in random order
+		std::vector<MeshVertex> vertices(64);
+		for (size_t i = 0; i < vertices.size(); ++i)
+		{
+			auto value = float(i);
+			vertices[i] = MeshVertex(
+				DirectX::XMFLOAT3(value, random.NextFloat(), random.NextFloat()),
+				DirectX::XMFLOAT3(0.0f, 1.0f, 0.0f),
+				DirectX::XMFLOAT2(random.NextFloat(), value),
+				DirectX::XMFLOAT3(1.0f, 0.0f, 0.0f));
+		}
+
+		std::vector<uint32_t> indices(300);
+		for (auto& index : indices)
+		{
+			index = random.Next(32) * 2;
+		}
+
+		auto before = vertices;
+		auto referenced = indices;
+		OptimizeVertexFetch(vertices, indices);
+
+		CHECK(vertices.size() == 32);
+		CHECK(indices.size() == referenced.size());
+		CHECK(IsInRange(indices, vertices.size()));
+		CHECK(IsInFetchOrder(indices));
+
+		auto isSame = true;
+		for (size_t i = 0; i < indices.size() && isSame; ++i)
+		{
+			isSame = CHECK(IsSameVertex(vertices[indices[i]], before[referenced[i]]));
+		}
+
+		// no vertex is kept twice, and none of the dropped ones is kept
+		for (size_t i = 0; i < vertices.size(); ++i)
+		{
+			CHECK(uint32_t(vertices[i].Position.x) % 2 == 0);
+			for (size_t j = i + 1; j < vertices.size(); ++j)
+			{
+				CHECK(!IsSameVertex(vertices[i], vertices[j]));
+			}
+		}
+
+		// a mesh without triangles keeps no vertex
+		std::vector<uint32_t> none;
+		OptimizeVertexFetch(vertices, none);
+		CHECK(vertices.empty() && none.empty());
+
+		// OptimizeMesh() drops them as well
+		auto sphere = MakeSphere(8, 16);
+		auto usedCount = sphere.Vertices.size();
+		sphere.Vertices.insert(sphere.Vertices.begin(), 10, sphere.Vertices.back());
+		for (auto& index : sphere.Indices)
+		{
+			index += 10;
+		}
+		sphere.Vertices.push_back(sphere.Vertices.front());
+		OptimizeMesh(sphere);
+		CHECK(sphere.Vertices.size() == usedCount);
+		CHECK(IsInRange(sphere.Indices, sphere.Vertices.size()));
+		CHECK(IsInFetchOrder(sphere.Indices));
+	}
+} // namespace
+
+int main()
+{
+	RUN_TEST(TestACMR);
+	RUN_TEST(TestStats);
+	RUN_TEST(TestTriangles);
+	RUN_TEST(TestVertexFetch);
+	return TEST_RESULT();
+}
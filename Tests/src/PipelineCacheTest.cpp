@@ -0,0 +1,335 @@
+#include "PipelineCache.h"
+#include "RootSignature.h"
+#include "FakeDevice.h"
+#include "TestUtil.h"
+#include <cstring>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+namespace {
+	//
+	// PipelineDesc structure
+	//
+	// A graphics pipeline description with the data its pointers refer to.
+	//
+	struct PipelineDesc
+	{
+		std::string Shader;
+		std::string Semantic;
+		D3D12_INPUT_ELEMENT_DESC Element;
+		D3D12_GRAPHICS_PIPELINE_STATE_DESC Desc;
+	};
+
+	// the description of the sample. padding is filled with the byte, which must not reach the hash
+	void MakePipelineDesc(uint8_t fill, ID3D12RootSignature* pRootSignature, PipelineDesc& result)
+	{
+		result.Shader = "DXBC vertex shader";
+		result.Semantic = "POSITION";
+		result.Element = { result.Semantic.c_str(), 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 };
+
+		auto& desc = result.Desc;
+		memset(&desc, fill, sizeof(desc));
+		desc.pRootSignature = pRootSignature;
+		desc.VS = { result.Shader.data(), result.Shader.size() };
+		desc.PS = {};
+		desc.DS = {};
+		desc.HS = {};
+		desc.GS = {};
+		desc.StreamOutput = {};
+
+		desc.BlendState.AlphaToCoverageEnable = FALSE;
+		desc.BlendState.IndependentBlendEnable = FALSE;
+		for (auto i = 0; i < D3D12_SIMULTANEOUS_RENDER_TARGET_COUNT; ++i)
+		{
+			auto& target = desc.BlendState.RenderTarget[i];
+			target.BlendEnable = FALSE;
+			target.LogicOpEnable = FALSE;
+			target.SrcBlend = D3D12_BLEND_ONE;
+			target.DestBlend = D3D12_BLEND_ZERO;
+			target.BlendOp = D3D12_BLEND_OP_ADD;
+			target.SrcBlendAlpha = D3D12_BLEND_ONE;
+			target.DestBlendAlpha = D3D12_BLEND_ZERO;
+			target.BlendOpAlpha = D3D12_BLEND_OP_ADD;
+			target.LogicOp = D3D12_LOGIC_OP_NOOP;
+			target.RenderTargetWriteMask = D3D12_COLOR_WRITE_ENABLE_ALL;
+			desc.RTVFormats[i] = DXGI_FORMAT_UNKNOWN;
+		}
+
+		desc.SampleMask = D3D12_DEFAULT_SAMPLE_MASK;
+		desc.RasterizerState.FillMode = D3D12_FILL_MODE_SOLID;
+		desc.RasterizerState.CullMode = D3D12_CULL_MODE_BACK;
+		desc.RasterizerState.FrontCounterClockwise = FALSE;
+		desc.RasterizerState.DepthBias = 0;
+		desc.RasterizerState.DepthBiasClamp = 0.0f;
+		desc.RasterizerState.SlopeScaledDepthBias = 0.0f;
+		desc.RasterizerState.DepthClipEnable = TRUE;
+		desc.RasterizerState.MultisampleEnable = FALSE;
+		desc.RasterizerState.AntialiasedLineEnable = FALSE;
+		desc.RasterizerState.ForcedSampleCount = 0;
+		desc.RasterizerState.ConservativeRaster = D3D12_CONSERVATIVE_RASTERIZATION_MODE_OFF;
+
+		D3D12_DEPTH_STENCILOP_DESC stencilOp = { D3D12_STENCIL_OP_KEEP, D3D12_STENCIL_OP_KEEP, D3D12_STENCIL_OP_KEEP, D3D12_COMPARISON_FUNC_ALWAYS };
+		desc.DepthStencilState.DepthEnable = TRUE;
+		desc.DepthStencilState.DepthWriteMask = D3D12_DEPTH_WRITE_MASK_ALL;
+		desc.DepthStencilState.DepthFunc = D3D12_COMPARISON_FUNC_LESS_EQUAL;
+		desc.DepthStencilState.StencilEnable = FALSE;
+		desc.DepthStencilState.StencilReadMask = 0xff;
+		desc.DepthStencilState.StencilWriteMask = 0xff;
+		desc.DepthStencilState.FrontFace = stencilOp;
+		desc.DepthStencilState.BackFace = stencilOp;
+
+		desc.InputLayout = { &result.Element, 1 };
+		desc.IBStripCutValue = D3D12_INDEX_BUFFER_STRIP_CUT_VALUE_DISABLED;
+		desc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
+		desc.NumRenderTargets = 1;
+		desc.RTVFormats[0] = DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+		desc.DSVFormat = DXGI_FORMAT_D32_FLOAT;
+		desc.SampleDesc = { 1, 0 };
+		desc.NodeMask = 0;
+		desc.CachedPSO = {};
+		desc.Flags = D3D12_PIPELINE_STATE_FLAG_NONE;
+	}
+
+	void MakeRootSignatureDesc(uint32_t reg, RootSignature::Desc& desc)
+	{
+		desc.Begin(2)
+			.SetCBV(ShaderStage::VS, 0, 0)
+			.SetRootCBV(ShaderStage::PS, 1, reg)
+			.AddStaticSmp(ShaderStage::PS, 0, SamplerState::LinearWrap)
+			.AllowIL()
+			.End();
+	}
+
+	// equal descriptions hash equal wherever they live, any member changes the hash
+	void TestHash()
+	{
+		RootSignature::Desc a;
+		RootSignature::Desc b;
+		MakeRootSignatureDesc(1, a);
+		MakeRootSignatureDesc(1, b);
+		CHECK(a.GetDesc()->pParameters != b.GetDesc()->pParameters);
+		CHECK(HashRootSignatureDesc(*a.GetDesc()) == HashRootSignatureDesc(*b.GetDesc()));
+
+		MakeRootSignatureDesc(2, b);
+		CHECK(HashRootSignatureDesc(*a.GetDesc()) != HashRootSignatureDesc(*b.GetDesc()));
+
+		// the root signature takes part by the hash of its description, never by its address
+		PipelineDesc x;
+		PipelineDesc y;
+		MakePipelineDesc(0x00, reinterpret_cast<ID3D12RootSignature*>(0x1234), x);
+		MakePipelineDesc(0xcd, reinterpret_cast<ID3D12RootSignature*>(0x5678), y);
+		CHECK(HashGraphicsPipelineDesc(x.Desc, 7) == HashGraphicsPipelineDesc(y.Desc, 7));
+		CHECK(HashGraphicsPipelineDesc(x.Desc, 7) != HashGraphicsPipelineDesc(x.Desc, 8));
+
+		// bytecode is hashed by contents
+		y.Shader[0] = 'B';
+		CHECK(HashGraphicsPipelineDesc(x.Desc, 7) != HashGraphicsPipelineDesc(y.Desc, 7));
+		y.Shader[0] = 'D';
+		CHECK(HashGraphicsPipelineDesc(x.Desc, 7) == HashGraphicsPipelineDesc(y.Desc, 7));
+
+		y.Semantic = "NORMAL";
+		y.Element.SemanticName = y.Semantic.c_str();
+		CHECK(HashGraphicsPipelineDesc(x.Desc, 7) != HashGraphicsPipelineDesc(y.Desc, 7));
+		MakePipelineDesc(0xcd, nullptr, y);
+
+		y.Desc.DepthStencilState.StencilWriteMask = 0;
+		CHECK(HashGraphicsPipelineDesc(x.Desc, 7) != HashGraphicsPipelineDesc(y.Desc, 7));
+		MakePipelineDesc(0xcd, nullptr, y);
+
+		y.Desc.RTVFormats[3] = DXGI_FORMAT_R8G8B8A8_UNORM;
+		CHECK(HashGraphicsPipelineDesc(x.Desc, 7) != HashGraphicsPipelineDesc(y.Desc, 7));
+		MakePipelineDesc(0xcd, nullptr, y);
+
+		// the cached blob is not part of the description
+		const char blob[] = "cached";
+		y.Desc.CachedPSO = { blob, sizeof(blob) };
+		CHECK(HashGraphicsPipelineDesc(x.Desc, 7) == HashGraphicsPipelineDesc(y.Desc, 7));
+
+		CHECK(GetPipelineName(0x0123456789abcdefull) == L"0123456789abcdef");
+		CHECK(GetPipelineName(0) == L"0000000000000000");
+	}
+
+	// the cache file restores the library bytes and rejects anything else
+	void TestSerialize()
+	{
+		std::vector<uint8_t> library(1000);
+		for (size_t i = 0; i < library.size(); ++i)
+		{
+			library[i] = uint8_t(i * 7);
+		}
+
+		std::vector<uint8_t> data;
+		SerializePipelineCache(library.data(), library.size(), data);
+
+		const uint8_t* pLibrary = nullptr;
+		size_t size = 0;
+		CHECK(DeserializePipelineCache(data.data(), data.size(), pLibrary, size));
+		CHECK(size == library.size() && memcmp(pLibrary, library.data(), size) == 0);
+
+		std::vector<uint8_t> again;
+		SerializePipelineCache(library.data(), library.size(), again);
+		CHECK(again == data);
+
+		// every truncation is rejected
+		for (size_t cut = 0; cut < data.size(); ++cut)
+		{
+			if (!CHECK(!DeserializePipelineCache(data.data(), cut, pLibrary, size)) || !CHECK(pLibrary == nullptr && size == 0))
+			{
+				break;
+			}
+		}
+		CHECK(!DeserializePipelineCache(nullptr, 0, pLibrary, size));
+
+		// a flipped bit and another version
+		auto broken = data;
+		broken[100] ^= 1;
+		CHECK(!DeserializePipelineCache(broken.data(), broken.size(), pLibrary, size));
+		broken = data;
+		broken[4] = uint8_t(PipelineCacheVersion + 1);
+		CHECK(!DeserializePipelineCache(broken.data(), broken.size(), pLibrary, size));
+
+		SerializePipelineCache(nullptr, 0, data);
+		CHECK(DeserializePipelineCache(data.data(), data.size(), pLibrary, size) && size == 0);
+	}
+
+	// identical descriptions share one object
+	void TestCache()
+	{
+		auto pDevice = new Fake::Device();
+
+		{
+			PipelineCache cache;
+			CHECK(!cache.Init(nullptr, nullptr));
+			CHECK(cache.Init(pDevice, nullptr));
+
+			RootSignature::Desc a;
+			RootSignature::Desc b;
+			MakeRootSignatureDesc(1, a);
+			MakeRootSignatureDesc(1, b);
+			auto pRootSignature = cache.GetRootSignature(a.GetDesc());
+			CHECK(pRootSignature != nullptr);
+			CHECK(cache.GetRootSignature(b.GetDesc()) == pRootSignature);
+			CHECK(pDevice->GetRootSignatureCount() == 1);
+
+			MakeRootSignatureDesc(2, b);
+			auto pOther = cache.GetRootSignature(b.GetDesc());
+			CHECK(pOther != nullptr && pOther != pRootSignature);
+			CHECK(pDevice->GetRootSignatureCount() == 2);
+
+			PipelineDesc x;
+			PipelineDesc y;
+			MakePipelineDesc(0x00, pRootSignature, x);
+			MakePipelineDesc(0xcd, pRootSignature, y);
+			auto pPipeline = cache.GetGraphicsPipeline(x.Desc);
+			CHECK(pPipeline != nullptr);
+			CHECK(cache.GetGraphicsPipeline(y.Desc) == pPipeline);
+			CHECK(pDevice->GetPipelineCount() == 1);
+
+			y.Desc.pRootSignature = pOther;
+			CHECK(cache.GetGraphicsPipeline(y.Desc) != pPipeline);
+			CHECK(pDevice->GetPipelineCount() == 2 && cache.GetPipelineCount() == 2);
+
+			// a root signature the cache did not create can not be hashed
+			Fake::RootSignature foreign;
+			y.Desc.pRootSignature = &foreign;
+			CHECK(cache.GetGraphicsPipeline(y.Desc) == nullptr);
+			CHECK(!cache.RequestGraphicsPipeline(y.Desc).IsValid());
+
+			// without workers a request compiles in Update(), and is taken by the next one
+			y.Desc.pRootSignature = pRootSignature;
+			y.Desc.DepthStencilState.DepthEnable = FALSE;
+			auto handle = cache.RequestGraphicsPipeline(y.Desc);
+			CHECK(handle.IsValid() && handle.Get() == nullptr);
+			CHECK(handle.GetState() == COMPILE_STATE_QUEUED);
+			cache.Update();
+			CHECK(pDevice->GetPipelineCount() == 3 && handle.Get() == nullptr);
+			cache.Update();
+			CHECK(handle.GetState() == COMPILE_STATE_READY && handle.Get() != nullptr);
+			CHECK(cache.GetGraphicsPipeline(y.Desc) == handle.Get());
+			CHECK(pDevice->GetPipelineCount() == 3 && cache.IsIdle());
+
+			// shader files are read once
+			auto path = L"PipelineCacheTest_" + std::to_wstring(getpid()) + L".cso";
+			auto hFile = CreateFileW(path.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+			DWORD written = 0;
+			CHECK(WriteFile(hFile, x.Shader.data(), DWORD(x.Shader.size()), &written, nullptr));
+			CloseHandle(hFile);
+
+			auto pShader = cache.LoadShader(path.c_str());
+			CHECK(pShader != nullptr && pShader->GetBufferSize() == x.Shader.size());
+			CHECK(memcmp(pShader->GetBufferPointer(), x.Shader.data(), x.Shader.size()) == 0);
+			DeleteFileW(path.c_str());
+			CHECK(cache.LoadShader(path.c_str()) == pShader);
+			CHECK(cache.LoadShader(L"PipelineCacheTest_missing.cso") == nullptr);
+
+			cache.Term();
+		}
+
+		pDevice->Release();
+		CHECK(Fake::LiveCount() == 0);
+	}
+
+	// pipelines stored in the library file are loaded without compiling on the next start
+	void TestLibrary()
+	{
+		auto path = L"PipelineCacheTest_" + std::to_wstring(getpid()) + L".bin";
+		auto pDevice = new Fake::Device();
+		pDevice->SetLibrarySupported(true);
+
+		{
+			RootSignature::Desc rootSignatureDesc;
+			MakeRootSignatureDesc(1, rootSignatureDesc);
+
+			PipelineDesc x;
+			PipelineDesc y;
+			MakePipelineDesc(0x00, nullptr, x);
+			MakePipelineDesc(0x00, nullptr, y);
+			y.Desc.RasterizerState.CullMode = D3D12_CULL_MODE_NONE;
+
+			// cold start compiles and writes the file
+			PipelineCache cache;
+			CHECK(cache.Init(pDevice, path.c_str()));
+			x.Desc.pRootSignature = cache.GetRootSignature(rootSignatureDesc.GetDesc());
+			y.Desc.pRootSignature = x.Desc.pRootSignature;
+			CHECK(cache.GetGraphicsPipeline(x.Desc) != nullptr);
+			CHECK(cache.GetGraphicsPipeline(y.Desc) != nullptr);
+			CHECK(pDevice->GetPipelineCount() == 2 && cache.GetLibraryHitCount() == 0);
+			cache.Term();
+
+			// warm start loads both
+			CHECK(cache.Init(pDevice, path.c_str()));
+			x.Desc.pRootSignature = cache.GetRootSignature(rootSignatureDesc.GetDesc());
+			y.Desc.pRootSignature = x.Desc.pRootSignature;
+			CHECK(cache.GetGraphicsPipeline(x.Desc) != nullptr);
+			CHECK(cache.GetGraphicsPipeline(y.Desc) != nullptr);
+			CHECK(pDevice->GetPipelineCount() == 2 && cache.GetLibraryHitCount() == 2);
+			cache.Term();
+
+			// a broken file starts over
+			auto hFile = CreateFileW(path.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+			DWORD written = 0;
+			CHECK(WriteFile(hFile, "broken", 6, &written, nullptr));
+			CloseHandle(hFile);
+
+			CHECK(cache.Init(pDevice, path.c_str()));
+			x.Desc.pRootSignature = cache.GetRootSignature(rootSignatureDesc.GetDesc());
+			CHECK(cache.GetGraphicsPipeline(x.Desc) != nullptr);
+			CHECK(pDevice->GetPipelineCount() == 3 && cache.GetLibraryHitCount() == 0);
+			cache.Term();
+		}
+
+		DeleteFileW(path.c_str());
+		pDevice->Release();
+		CHECK(Fake::LiveCount() == 0);
+	}
+} // namespace
+
+int main()
+{
+	RUN_TEST(TestHash);
+	RUN_TEST(TestSerialize);
+	RUN_TEST(TestCache);
+	RUN_TEST(TestLibrary);
+	return TEST_RESULT();
+}
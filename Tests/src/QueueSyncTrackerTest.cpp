@@ -0,0 +1,205 @@
+#include "QueueSyncTracker.h"
+#include "TestUtil.h"
+#include <algorithm>
+#include <vector>
+
+namespace {
+	const auto Direct = QUEUE_TYPE_DIRECT;
+	const auto Copy = QUEUE_TYPE_COPY;
+	const auto Compute = QUEUE_TYPE_COMPUTE;
+
+	void TestSignalAndWait()
+	{
+		QueueSyncTracker tracker;
+		CHECK(tracker.GetSignaledValue(Copy) == 0);
+
+		// values only increase
+		CHECK(tracker.Signal(Copy, 1));
+		CHECK(!tracker.Signal(Copy, 1));
+		CHECK(tracker.GetSignaledValue(Copy) == 1);
+
+		CHECK(tracker.NeedsWait(Direct, Copy, 1));
+		tracker.Wait(Direct, Copy, 1);
+		CHECK(!tracker.NeedsWait(Direct, Copy, 1));
+		CHECK(tracker.GetKnownValue(Direct, Copy) == 1);
+
+		// a queue never waits for itself
+		CHECK(!tracker.NeedsWait(Direct, Direct, 5));
+		tracker.Wait(Direct, Direct, 5);
+		CHECK(tracker.GetSignaledValue(Direct) == 0);
+
+		// a later value needs another wait
+		CHECK(tracker.Signal(Copy, 2));
+		CHECK(tracker.NeedsWait(Direct, Copy, 2));
+	}
+
+	// the geometry upload of the sample: the copy queue signals, the direct queue waits once
+	void TestUpload()
+	{
+		QueueSyncTracker tracker;
+
+		CHECK(tracker.Signal(Copy, 1));
+		CHECK(tracker.NeedsWait(Direct, Copy, 1));
+		tracker.Wait(Direct, Copy, 1);
+
+		// frames after the first are ordered after the upload already
+		CHECK(tracker.Signal(Direct, 1));
+		CHECK(tracker.Signal(Direct, 2));
+		CHECK(!tracker.NeedsWait(Direct, Copy, 1));
+
+		// a mip batch which the CPU has seen complete is not waited for on the GPU
+		CHECK(tracker.Signal(Copy, 2));
+		tracker.Complete(Copy, 2);
+		CHECK(!tracker.NeedsWait(Direct, Copy, 2));
+		CHECK(tracker.GetCompletedValue(Copy) == 2);
+
+		// completed values never go back
+		tracker.Complete(Copy, 1);
+		CHECK(tracker.GetCompletedValue(Copy) == 2);
+	}
+
+	void TestTransitive()
+	{
+		QueueSyncTracker tracker;
+
+		// compute waits for copy 2 and signals 1, so waiting for compute 1 covers copy 2
+		CHECK(tracker.Signal(Copy, 1));
+		CHECK(tracker.Signal(Copy, 2));
+		tracker.Wait(Compute, Copy, 2);
+		CHECK(tracker.Signal(Compute, 1));
+
+		tracker.Wait(Direct, Compute, 1);
+		CHECK(!tracker.NeedsWait(Direct, Copy, 2));
+		CHECK(tracker.GetKnownValue(Direct, Copy) == 2);
+
+		// copy 3 was signaled after what compute waited for
+		CHECK(tracker.Signal(Copy, 3));
+		CHECK(tracker.NeedsWait(Direct, Copy, 3));
+
+		// completion makes the waits of every queue unnecessary
+		tracker.Complete(Copy, 3);
+		CHECK(!tracker.NeedsWait(Direct, Copy, 3));
+		CHECK(!tracker.NeedsWait(Compute, Copy, 3));
+
+		// a wait for a value between signals ends at the next signal, and takes what it knew
+		CHECK(tracker.Signal(Compute, 5));
+		tracker.Wait(Copy, Compute, 4);
+		CHECK(tracker.GetKnownValue(Copy, Compute) == 5);
+		CHECK(tracker.GetKnownValue(Copy, Copy) == 3);
+
+		// a cycle does not raise the waiter's own value
+		tracker.Wait(Compute, Direct, 0);
+		CHECK(tracker.GetSignaledValue(Compute) == 5);
+
+		tracker.Reset();
+		CHECK(tracker.GetSignaledValue(Copy) == 0);
+		CHECK(tracker.GetCompletedValue(Copy) == 0);
+		CHECK(tracker.NeedsWait(Direct, Copy, 1));
+	}
+
+	// a wait is reported unnecessary only when a chain of real waits or a completion covers it
+	void TestFuzz()
+	{
+		for (uint64_t seed = 0; seed < 50; ++seed)
+		{
+			TestUtil::Random random(seed);
+
+			QueueSyncTracker tracker;
+
+			// reference: the values of every queue each signal is ordered after, found by
+			// following the waits recorded before it
+			struct Signal
+			{
+				uint64_t Known[QUEUE_TYPE_COUNT];
+			};
+			std::vector<Signal> signals[QUEUE_TYPE_COUNT];
+			uint64_t known[QUEUE_TYPE_COUNT][QUEUE_TYPE_COUNT] = {};
+			uint64_t completed[QUEUE_TYPE_COUNT] = {};
+
+			for (auto step = 0; step < 500; ++step)
+			{
+				auto queue = QUEUE_TYPE(random.Next(QUEUE_TYPE_COUNT));
+				auto other = QUEUE_TYPE(random.Next(QUEUE_TYPE_COUNT));
+				auto& history = signals[queue];
+				auto& otherHistory = signals[other];
+
+				switch (random.Next(4))
+				{
+				case 0:
+				{
+					auto value = uint64_t(history.size() + 1);
+					CHECK(tracker.Signal(queue, value));
+					known[queue][queue] = value;
+
+					Signal signal;
+					std::copy(known[queue], known[queue] + QUEUE_TYPE_COUNT, signal.Known);
+					history.push_back(signal);
+				}
+				break;
+
+				case 1:
+				case 2:
+				{
+					if (otherHistory.empty())
+					{
+						break;
+					}
+
+					auto value = uint64_t(1 + random.Next(uint32_t(otherHistory.size())));
+					auto needed = queue != other && value > completed[other] && value > known[queue][other];
+					if (!CHECK(tracker.NeedsWait(queue, other, value) == needed))
+					{
+						return;
+					}
+
+					if (queue == other)
+					{
+						break;
+					}
+
+					tracker.Wait(queue, other, value);
+
+					// the wait ends at the signal of the value
+					known[queue][other] = std::max(known[queue][other], value);
+					if (value > completed[other])
+					{
+						const auto& signal = otherHistory[size_t(value - 1)];
+						for (auto j = 0; j < QUEUE_TYPE_COUNT; ++j)
+						{
+							if (j != queue)
+							{
+								known[queue][j] = std::max(known[queue][j], signal.Known[j]);
+							}
+						}
+					}
+				}
+				break;
+
+				default:
+				{
+					// the GPU moves on by up to two signals
+					auto value = std::min<uint64_t>(completed[queue] + random.Next(3), history.size());
+					tracker.Complete(queue, value);
+					completed[queue] = std::max(completed[queue], value);
+				}
+				break;
+				}
+
+				for (auto i = 0; i < QUEUE_TYPE_COUNT; ++i)
+				{
+					CHECK(tracker.GetSignaledValue(QUEUE_TYPE(i)) == signals[i].size());
+					CHECK(tracker.GetCompletedValue(QUEUE_TYPE(i)) == completed[i]);
+				}
+			}
+		}
+	}
+} // namespace
+
+int main()
+{
+	RUN_TEST(TestSignalAndWait);
+	RUN_TEST(TestUpload);
+	RUN_TEST(TestTransitive);
+	RUN_TEST(TestFuzz);
+	return TEST_RESULT();
+}
@@ -0,0 +1,307 @@
+#include "RenderGraph.h"
+#include "TestUtil.h"
+#include <vector>
+
+namespace {
+	// placement alignment of textures
+	const uint64_t TextureAlignment = 65536;
+
+	RenderGraph::ResourceDesc MakeDesc(uint32_t usage, uint64_t size = 0, bool isTransient = false, bool isOutput = false)
+	{
+		RenderGraph::ResourceDesc desc = {};
+		desc.Usage = usage;
+		desc.Size = size;
+		desc.Alignment = TextureAlignment;
+		desc.IsTransient = isTransient;
+		desc.IsOutput = isOutput;
+		return desc;
+	}
+
+	// the frame of the sample: a pass nobody reads is culled, and each used resource goes from
+	// its usage between frames to the usage of its passes and back
+	void TestSampleGraph()
+	{
+		RenderGraph graph;
+		auto color = graph.AddResource("SceneColor", MakeDesc(RESOURCE_USAGE_PIXEL_SHADER));
+		auto depth = graph.AddResource("SceneDepth", MakeDesc(RESOURCE_USAGE_DEPTH_WRITE));
+		auto backBuffer = graph.AddResource("BackBuffer", MakeDesc(RESOURCE_USAGE_PRESENT, 0, false, true));
+		auto depthTarget = graph.AddResource("Depth", MakeDesc(RESOURCE_USAGE_DEPTH_WRITE));
+
+		auto scene = graph.AddPass("Scene");
+		CHECK(graph.Write(scene, color, RESOURCE_USAGE_RENDER_TARGET));
+		CHECK(graph.Write(scene, depth, RESOURCE_USAGE_DEPTH_WRITE));
+
+		auto unused = graph.AddPass("Unused");
+		CHECK(graph.Read(unused, color, RESOURCE_USAGE_PIXEL_SHADER));
+		CHECK(graph.Write(unused, depthTarget, RESOURCE_USAGE_DEPTH_WRITE));
+
+		auto tonemap = graph.AddPass("Tonemap");
+		CHECK(graph.Read(tonemap, color, RESOURCE_USAGE_PIXEL_SHADER));
+		CHECK(graph.Write(tonemap, backBuffer, RESOURCE_USAGE_RENDER_TARGET));
+		CHECK(graph.Write(tonemap, depthTarget, RESOURCE_USAGE_DEPTH_WRITE));
+
+		// one write usage per resource and pass
+		CHECK(!graph.Write(tonemap, backBuffer, RESOURCE_USAGE_DEPTH_WRITE));
+		CHECK(!graph.Write(tonemap, backBuffer, RESOURCE_USAGE_DEPTH_WRITE | RESOURCE_USAGE_RENDER_TARGET));
+
+		CHECK(graph.Compile());
+		CHECK(graph.IsCulled(unused) && !graph.IsCulled(scene) && !graph.IsCulled(tonemap));
+		CHECK(graph.GetPassOrder() == std::vector<uint32_t>({ scene, tonemap }));
+
+		// the depth buffer stays in its usage, so it needs no barrier
+		const auto& sceneBarriers = graph.GetBarriers(scene);
+		CHECK(sceneBarriers.size() == 1);
+		CHECK(sceneBarriers[0].Type == RenderGraph::BARRIER_TYPE_TRANSITION && sceneBarriers[0].Resource == color);
+		CHECK(sceneBarriers[0].Before == RESOURCE_USAGE_PIXEL_SHADER && sceneBarriers[0].After == RESOURCE_USAGE_RENDER_TARGET);
+
+		const auto& tonemapBarriers = graph.GetBarriers(tonemap);
+		CHECK(tonemapBarriers.size() == 2);
+		CHECK(tonemapBarriers[0].Resource == color && tonemapBarriers[0].After == RESOURCE_USAGE_PIXEL_SHADER);
+		CHECK(tonemapBarriers[1].Resource == backBuffer && tonemapBarriers[1].Before == RESOURCE_USAGE_PRESENT);
+		CHECK(tonemapBarriers[1].After == RESOURCE_USAGE_RENDER_TARGET);
+
+		const auto& finalBarriers = graph.GetFinalBarriers();
+		CHECK(finalBarriers.size() == 1);
+		CHECK(finalBarriers[0].Resource == backBuffer && finalBarriers[0].After == RESOURCE_USAGE_PRESENT);
+		CHECK(graph.GetHeapSize() == 0 && graph.GetUnaliasedSize() == 0);
+	}
+
+	// reads in a row share one barrier to the union of their usages
+	void TestReadMerging()
+	{
+		RenderGraph graph;
+		auto source = graph.AddResource("Source", MakeDesc(RESOURCE_USAGE_PIXEL_SHADER));
+		auto output = graph.AddResource("Output", MakeDesc(RESOURCE_USAGE_PRESENT, 0, false, true));
+
+		auto write = graph.AddPass("Write");
+		CHECK(graph.Write(write, source, RESOURCE_USAGE_RENDER_TARGET));
+
+		auto first = graph.AddPass("First");
+		CHECK(graph.Read(first, source, RESOURCE_USAGE_PIXEL_SHADER));
+		CHECK(graph.Read(first, output, RESOURCE_USAGE_RENDER_TARGET));
+		CHECK(graph.Write(first, output, RESOURCE_USAGE_RENDER_TARGET));
+
+		auto second = graph.AddPass("Second");
+		CHECK(graph.Read(second, source, RESOURCE_USAGE_NON_PIXEL_SHADER));
+		CHECK(graph.Read(second, output, RESOURCE_USAGE_RENDER_TARGET));
+		CHECK(graph.Write(second, output, RESOURCE_USAGE_RENDER_TARGET));
+
+		CHECK(graph.Compile());
+
+		const auto& firstBarriers = graph.GetBarriers(first);
+		CHECK(!firstBarriers.empty() && firstBarriers[0].Resource == source);
+		CHECK(!firstBarriers.empty() && firstBarriers[0].After == (RESOURCE_USAGE_PIXEL_SHADER | RESOURCE_USAGE_NON_PIXEL_SHADER));
+		CHECK(graph.GetBarriers(second).empty());
+		CHECK(graph.GetFinalBarriers().size() == 2);
+	}
+
+	// a write nobody reads before the next write is culled; a pass with side effects never is
+	void TestOverwrite()
+	{
+		RenderGraph graph;
+		auto output = graph.AddResource("Output", MakeDesc(RESOURCE_USAGE_PRESENT, 0, false, true));
+
+		auto first = graph.AddPass("First");
+		CHECK(graph.Write(first, output, RESOURCE_USAGE_RENDER_TARGET));
+		auto second = graph.AddPass("Second");
+		CHECK(graph.Write(second, output, RESOURCE_USAGE_RENDER_TARGET));
+		auto sideEffect = graph.AddPass("SideEffect", true);
+
+		CHECK(graph.Compile());
+		CHECK(graph.IsCulled(first) && !graph.IsCulled(second) && !graph.IsCulled(sideEffect));
+		CHECK(graph.GetPassOrder() == std::vector<uint32_t>({ second, sideEffect }));
+	}
+
+	// transient resources whose passes do not overlap share memory, and the one taking it over
+	// waits on an aliasing barrier
+	void TestAliasing()
+	{
+		const auto K = TextureAlignment;
+
+		RenderGraph graph;
+		CHECK(graph.AddResource("Empty", MakeDesc(RESOURCE_USAGE_PIXEL_SHADER, 0, true)) == RenderGraph::InvalidId);
+		graph.Reset();
+
+		auto a = graph.AddResource("A", MakeDesc(RESOURCE_USAGE_PIXEL_SHADER, 4 * K, true));
+		auto b = graph.AddResource("B", MakeDesc(RESOURCE_USAGE_PIXEL_SHADER, 2 * K, true));
+		auto c = graph.AddResource("C", MakeDesc(RESOURCE_USAGE_PIXEL_SHADER, 3 * K, true));
+		auto d = graph.AddResource("D", MakeDesc(RESOURCE_USAGE_DEPTH_WRITE, 1 * K, true));
+		auto output = graph.AddResource("Output", MakeDesc(RESOURCE_USAGE_PRESENT, 0, false, true));
+
+		auto p0 = graph.AddPass("P0");
+		CHECK(graph.Write(p0, a, RESOURCE_USAGE_RENDER_TARGET));
+		CHECK(graph.Write(p0, d, RESOURCE_USAGE_DEPTH_WRITE));
+		auto p1 = graph.AddPass("P1");
+		CHECK(graph.Read(p1, a, RESOURCE_USAGE_PIXEL_SHADER));
+		CHECK(graph.Write(p1, b, RESOURCE_USAGE_RENDER_TARGET));
+		auto p2 = graph.AddPass("P2");
+		CHECK(graph.Read(p2, b, RESOURCE_USAGE_PIXEL_SHADER));
+		CHECK(graph.Write(p2, c, RESOURCE_USAGE_RENDER_TARGET));
+		auto p3 = graph.AddPass("P3");
+		CHECK(graph.Read(p3, c, RESOURCE_USAGE_PIXEL_SHADER));
+		CHECK(graph.Write(p3, output, RESOURCE_USAGE_RENDER_TARGET));
+
+		CHECK(graph.Compile());
+
+		RenderGraph::Placement placeA, placeB, placeC, placeD, placeOutput;
+		CHECK(graph.GetPlacement(a, placeA) && graph.GetPlacement(b, placeB));
+		CHECK(graph.GetPlacement(c, placeC) && graph.GetPlacement(d, placeD));
+		CHECK(!graph.GetPlacement(output, placeOutput));
+		CHECK(placeA.Offset == 0 && placeB.Offset == 4 * K && placeC.Offset == 0 && placeD.Offset == 4 * K);
+		CHECK(placeA.FirstPass == 0 && placeA.LastPass == 1 && placeC.FirstPass == 2 && placeC.LastPass == 3);
+		CHECK(graph.GetHeapSize() == 6 * K && graph.GetUnaliasedSize() == 10 * K);
+
+		// B takes over the memory of D, C the memory of A
+		const auto& p1Barriers = graph.GetBarriers(p1);
+		CHECK(!p1Barriers.empty() && p1Barriers[0].Type == RenderGraph::BARRIER_TYPE_ALIASING);
+		CHECK(!p1Barriers.empty() && p1Barriers[0].Resource == b && p1Barriers[0].ResourceBefore == d);
+
+		const auto& p2Barriers = graph.GetBarriers(p2);
+		CHECK(!p2Barriers.empty() && p2Barriers[0].Type == RenderGraph::BARRIER_TYPE_ALIASING);
+		CHECK(!p2Barriers.empty() && p2Barriers[0].Resource == c && p2Barriers[0].ResourceBefore == a);
+
+		// A and D take their memory back from the previous frame
+		const auto& p0Barriers = graph.GetBarriers(p0);
+		CHECK(p0Barriers.size() >= 2);
+		CHECK(p0Barriers.size() >= 2 && p0Barriers[0].Type == RenderGraph::BARRIER_TYPE_ALIASING);
+		CHECK(p0Barriers.size() >= 2 && p0Barriers[1].Type == RenderGraph::BARRIER_TYPE_ALIASING);
+	}
+
+	// shared memory is undefined when a resource takes it over, so reading it first fails
+	void TestUnwrittenAlias()
+	{
+		RenderGraph graph;
+		auto a = graph.AddResource("A", MakeDesc(RESOURCE_USAGE_RENDER_TARGET, TextureAlignment, true));
+		auto b = graph.AddResource("B", MakeDesc(RESOURCE_USAGE_PIXEL_SHADER, TextureAlignment, true));
+		auto output = graph.AddResource("Output", MakeDesc(RESOURCE_USAGE_PRESENT, 0, false, true));
+
+		auto p0 = graph.AddPass("P0");
+		CHECK(graph.Write(p0, a, RESOURCE_USAGE_RENDER_TARGET));
+		auto p1 = graph.AddPass("P1");
+		CHECK(graph.Read(p1, a, RESOURCE_USAGE_PIXEL_SHADER));
+		CHECK(graph.Write(p1, output, RESOURCE_USAGE_RENDER_TARGET));
+		auto p2 = graph.AddPass("P2");
+		CHECK(graph.Read(p2, b, RESOURCE_USAGE_PIXEL_SHADER));
+		CHECK(graph.Read(p2, output, RESOURCE_USAGE_RENDER_TARGET));
+		CHECK(graph.Write(p2, output, RESOURCE_USAGE_RENDER_TARGET));
+
+		CHECK(!graph.Compile());
+	}
+
+	// the sample with its scene targets transient: the depth buffers share memory across the frame
+	void TestTransientTargets()
+	{
+		const auto K = TextureAlignment;
+
+		RenderGraph graph;
+		auto color = graph.AddResource("SceneColor", MakeDesc(RESOURCE_USAGE_PIXEL_SHADER, 128 * K, true));
+		auto depth = graph.AddResource("SceneDepth", MakeDesc(RESOURCE_USAGE_DEPTH_WRITE, 64 * K, true));
+		auto depthTarget = graph.AddResource("Depth", MakeDesc(RESOURCE_USAGE_DEPTH_WRITE, 64 * K, true));
+		auto backBuffer = graph.AddResource("BackBuffer", MakeDesc(RESOURCE_USAGE_PRESENT, 0, false, true));
+
+		auto scene = graph.AddPass("Scene");
+		CHECK(graph.Write(scene, color, RESOURCE_USAGE_RENDER_TARGET));
+		CHECK(graph.Write(scene, depth, RESOURCE_USAGE_DEPTH_WRITE));
+		auto tonemap = graph.AddPass("Tonemap");
+		CHECK(graph.Read(tonemap, color, RESOURCE_USAGE_PIXEL_SHADER));
+		CHECK(graph.Write(tonemap, backBuffer, RESOURCE_USAGE_RENDER_TARGET));
+		CHECK(graph.Write(tonemap, depthTarget, RESOURCE_USAGE_DEPTH_WRITE));
+
+		CHECK(graph.Compile());
+		CHECK(graph.GetHeapSize() == 192 * K && graph.GetUnaliasedSize() == 256 * K);
+
+		const auto& sceneBarriers = graph.GetBarriers(scene);
+		CHECK(sceneBarriers.size() == 2);
+		CHECK(sceneBarriers.size() == 2 && sceneBarriers[0].Type == RenderGraph::BARRIER_TYPE_ALIASING);
+		CHECK(sceneBarriers.size() == 2 && sceneBarriers[0].Resource == depth && sceneBarriers[0].ResourceBefore == depthTarget);
+
+		const auto& tonemapBarriers = graph.GetBarriers(tonemap);
+		CHECK(tonemapBarriers.size() == 3);
+		CHECK(tonemapBarriers.size() == 3 && tonemapBarriers[0].Type == RenderGraph::BARRIER_TYPE_ALIASING);
+		CHECK(tonemapBarriers.size() == 3 && tonemapBarriers[0].Resource == depthTarget && tonemapBarriers[0].ResourceBefore == depth);
+	}
+
+	// transient resources used in overlapping passes never share memory, whatever the graph
+	void TestRandomPlacement()
+	{
+		TestUtil::Random random(24);
+		RenderGraph graph;
+		for (auto round = 0; round < 500; ++round)
+		{
+			graph.Reset();
+
+			// passes with side effects are never culled, so every pass keeps its place in the order
+			auto passCount = 2 + random.Next(7);
+			for (uint32_t i = 0; i < passCount; ++i)
+			{
+				graph.AddPass("Pass", true);
+			}
+
+			// each resource is written by one pass and read by some of the passes after it
+			auto resourceCount = 1 + random.Next(12);
+			std::vector<uint32_t> resources;
+			std::vector<uint64_t> alignments;
+			for (uint32_t i = 0; i < resourceCount; ++i)
+			{
+				auto size = uint64_t(1 + random.Next(8)) * TextureAlignment;
+				auto desc = MakeDesc(RESOURCE_USAGE_PIXEL_SHADER, size, true);
+				desc.Alignment = uint64_t(1) << (8 + random.Next(9));
+				auto resource = graph.AddResource("Resource", desc);
+				resources.push_back(resource);
+				alignments.push_back(desc.Alignment);
+
+				auto writer = random.Next(passCount);
+				CHECK(graph.Write(writer, resource, RESOURCE_USAGE_RENDER_TARGET));
+				for (auto reader = writer + 1; reader < passCount; ++reader)
+				{
+					if (random.Next(3) == 0)
+					{
+						CHECK(graph.Read(reader, resource, RESOURCE_USAGE_PIXEL_SHADER));
+					}
+				}
+			}
+
+			if (!CHECK(graph.Compile()) || !CHECK(graph.GetPassOrder().size() == passCount))
+			{
+				break;
+			}
+
+			std::vector<RenderGraph::Placement> places(resourceCount);
+			auto isValid = true;
+			for (uint32_t i = 0; i < resourceCount && isValid; ++i)
+			{
+				const auto& place = places[i];
+				isValid = CHECK(graph.GetPlacement(resources[i], places[i]))
+					&& CHECK(place.FirstPass <= place.LastPass && place.LastPass < passCount)
+					&& CHECK(place.Offset % alignments[i] == 0)
+					&& CHECK(place.Offset + place.Size <= graph.GetHeapSize());
+
+				for (uint32_t j = 0; j < i && isValid; ++j)
+				{
+					const auto& other = places[j];
+					if (place.FirstPass <= other.LastPass && other.FirstPass <= place.LastPass)
+					{
+						isValid = CHECK(place.Offset + place.Size <= other.Offset || other.Offset + other.Size <= place.Offset);
+					}
+				}
+			}
+
+			if (!isValid || !CHECK(graph.GetHeapSize() <= graph.GetUnaliasedSize()))
+			{
+				break;
+			}
+		}
+	}
+} // namespace
+
+int main()
+{
+	RUN_TEST(TestSampleGraph);
+	RUN_TEST(TestReadMerging);
+	RUN_TEST(TestOverwrite);
+	RUN_TEST(TestAliasing);
+	RUN_TEST(TestUnwrittenAlias);
+	RUN_TEST(TestTransientTargets);
+	RUN_TEST(TestRandomPlacement);
+	return TEST_RESULT();
+}
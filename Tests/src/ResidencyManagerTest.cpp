@@ -0,0 +1,329 @@
+#include "ResidencyManager.h"
+#include "TestUtil.h"
+#include <cmath>
+#include <map>
+#include <vector>
+
+namespace {
+	// sizes of a square mip chain whose mip 0 has the size, 1 byte per texel
+	std::vector<uint64_t> MakeMipSizes(uint32_t size, uint32_t& mipCount)
+	{
+		std::vector<uint64_t> sizes;
+		for (auto s = size; s > 0; s >>= 1)
+		{
+			sizes.push_back(uint64_t(s) * s);
+		}
+		mipCount = uint32_t(sizes.size());
+		return sizes;
+	}
+
+	// bytes of mips [mip, mipCount)
+	uint64_t GetBytes(const std::vector<uint64_t>& sizes, uint32_t mip)
+	{
+		uint64_t bytes = 0;
+		for (auto i = mip; i < sizes.size(); ++i)
+		{
+			bytes += sizes[i];
+		}
+		return bytes;
+	}
+
+	// find the change of a texture, -1 if it did not change
+	int FindChange(const std::vector<ResidencyManager::Change>& changes, uint32_t id)
+	{
+		for (auto& change : changes)
+		{
+			if (change.Id == id)
+			{
+				return int(change.ResidentMip);
+			}
+		}
+		return -1;
+	}
+
+	void TestRegister()
+	{
+		ResidencyManager manager;
+		CHECK(!manager.Init(0));
+		CHECK(manager.Init(1024 * 1024));
+
+		uint32_t mipCount = 0;
+		auto sizes = MakeMipSizes(256, mipCount);
+		CHECK(mipCount == 9);
+
+		CHECK(manager.Register(nullptr, mipCount, 0) == ResidencyManager::InvalidId);
+		CHECK(manager.Register(sizes.data(), 0, 0) == ResidencyManager::InvalidId);
+		CHECK(manager.Register(sizes.data(), mipCount, mipCount) == ResidencyManager::InvalidId);
+
+		// the tail is counted at once and reported by the next update
+		auto id = manager.Register(sizes.data(), mipCount, 6);
+		CHECK(id != ResidencyManager::InvalidId);
+		CHECK(manager.GetResidentMip(id) == 6);
+		CHECK(manager.GetUsedBytes() == GetBytes(sizes, 6));
+
+		std::vector<ResidencyManager::Change> changes;
+		manager.Update(changes);
+		CHECK(changes.size() == 1 && FindChange(changes, id) == 6);
+
+		manager.Update(changes);
+		CHECK(changes.empty());
+
+		// a texture unregistered before the update is not reported, and its id is reused
+		auto other = manager.Register(sizes.data(), mipCount, 8);
+		manager.Unregister(other);
+		CHECK(manager.GetUsedBytes() == GetBytes(sizes, 6));
+		manager.Update(changes);
+		CHECK(changes.empty());
+		CHECK(manager.Register(sizes.data(), mipCount, 8) == other);
+
+		manager.Unregister(id);
+		manager.Unregister(id);
+		CHECK(manager.GetUsedBytes() == GetBytes(sizes, 8));
+	}
+
+	void TestUpgradeAndEvict()
+	{
+		uint32_t mipCount = 0;
+		auto sizes = MakeMipSizes(256, mipCount);
+		auto tail = 6u;
+
+		// room for one texture at mip 1 and the tails of both
+		ResidencyManager manager;
+		CHECK(manager.Init(GetBytes(sizes, 1) + GetBytes(sizes, tail)));
+
+		auto a = manager.Register(sizes.data(), mipCount, tail);
+		auto b = manager.Register(sizes.data(), mipCount, tail);
+
+		std::vector<ResidencyManager::Change> changes;
+		manager.Update(changes);
+
+		manager.Request(a, 1);
+		manager.Update(changes);
+		CHECK(FindChange(changes, a) == 1);
+		CHECK(manager.GetUsedBytes() <= manager.GetBudget());
+
+		// b needs the memory of a, which was not requested this frame
+		manager.Request(b, 1);
+		manager.Update(changes);
+		CHECK(FindChange(changes, a) == int(tail));
+		CHECK(FindChange(changes, b) == 1);
+		CHECK(manager.GetResidentMip(a) == tail);
+		CHECK(manager.GetUsedBytes() == GetBytes(sizes, 1) + GetBytes(sizes, tail));
+
+		// both requested: the finest mip which fits is taken
+		manager.Request(a, 0);
+		manager.Request(b, 1);
+		manager.Update(changes);
+		CHECK(manager.GetResidentMip(b) == 1);
+		CHECK(manager.GetResidentMip(a) > 1);
+		CHECK(manager.GetUsedBytes() <= manager.GetBudget());
+
+		// a smaller budget drops the unused mips without any request
+		manager.SetBudget(GetBytes(sizes, tail) * 2);
+		manager.Update(changes);
+		CHECK(manager.GetResidentMip(a) == tail);
+		CHECK(manager.GetResidentMip(b) == tail);
+		CHECK(manager.GetUsedBytes() == GetBytes(sizes, tail) * 2);
+	}
+
+	void TestUploadLimit()
+	{
+		uint32_t mipCount = 0;
+		auto sizes = MakeMipSizes(64, mipCount);
+
+		// one update may bring in mips 2 to the last of one texture
+		ResidencyManager manager;
+		CHECK(manager.Init(1024 * 1024, GetBytes(sizes, 2)));
+
+		std::vector<uint32_t> ids;
+		for (auto i = 0; i < 4; ++i)
+		{
+			ids.push_back(manager.Register(sizes.data(), mipCount, mipCount - 1));
+		}
+
+		std::vector<ResidencyManager::Change> changes;
+		manager.Update(changes);
+
+		for (auto id : ids)
+		{
+			manager.Request(id, 2);
+		}
+		manager.Update(changes);
+
+		auto upgraded = 0;
+		for (auto id : ids)
+		{
+			upgraded += (manager.GetResidentMip(id) == 2) ? 1 : 0;
+		}
+		CHECK(upgraded == 1);
+
+		// the others follow in later updates
+		for (auto frame = 0; frame < 4; ++frame)
+		{
+			for (auto id : ids)
+			{
+				manager.Request(id, 2);
+			}
+			manager.Update(changes);
+		}
+
+		for (auto id : ids)
+		{
+			CHECK(manager.GetResidentMip(id) == 2);
+		}
+	}
+
+	// a change the streamer could not apply is rolled back and requested again
+	void TestRollback()
+	{
+		uint32_t mipCount = 0;
+		auto sizes = MakeMipSizes(128, mipCount);
+		auto tail = 5u;
+
+		ResidencyManager manager;
+		CHECK(manager.Init(1024 * 1024));
+
+		auto id = manager.Register(sizes.data(), mipCount, tail);
+
+		// the tail failed to upload, so nothing is resident
+		std::vector<ResidencyManager::Change> changes;
+		manager.Update(changes);
+		CHECK(FindChange(changes, id) == int(tail));
+		manager.SetResidentMip(id, mipCount);
+		CHECK(manager.GetUsedBytes() == 0);
+
+		manager.Update(changes);
+		CHECK(FindChange(changes, id) == int(tail));
+		CHECK(manager.GetUsedBytes() == GetBytes(sizes, tail));
+
+		// the upgrade failed, so the tail stays resident
+		manager.Request(id, 0);
+		manager.Update(changes);
+		CHECK(FindChange(changes, id) == 0);
+		manager.SetResidentMip(id, tail);
+		CHECK(manager.GetResidentMip(id) == tail);
+		CHECK(manager.GetUsedBytes() == GetBytes(sizes, tail));
+
+		manager.Request(id, 0);
+		manager.Update(changes);
+		CHECK(FindChange(changes, id) == 0);
+		CHECK(manager.GetUsedBytes() == GetBytes(sizes, 0));
+
+		// invalid mips and ids are ignored
+		manager.SetResidentMip(id, mipCount + 1);
+		manager.SetResidentMip(ResidencyManager::InvalidId, 0);
+		CHECK(manager.GetResidentMip(id) == 0);
+		CHECK(manager.GetUsedBytes() == GetBytes(sizes, 0));
+	}
+
+	// random requests and failed changes keep the byte count and the budget
+	void TestFuzz()
+	{
+		for (uint64_t seed = 0; seed < 20; ++seed)
+		{
+			TestUtil::Random random(seed);
+
+			const uint32_t TextureCount = 16;
+			std::vector<std::vector<uint64_t>> sizes(TextureCount);
+			std::vector<uint32_t> mipCounts(TextureCount);
+			std::vector<uint32_t> tails(TextureCount);
+			uint64_t tailBytes = 0;
+			for (auto i = 0u; i < TextureCount; ++i)
+			{
+				sizes[i] = MakeMipSizes(1u << (4 + random.Next(6)), mipCounts[i]);
+				tails[i] = mipCounts[i] - 1 - random.Next(3);
+				tailBytes += GetBytes(sizes[i], tails[i]);
+			}
+
+			ResidencyManager manager;
+			CHECK(manager.Init(tailBytes + 64 * 1024 + random.Next(256 * 1024), random.Next(2) ? 32 * 1024 : 0));
+
+			std::map<uint32_t, uint32_t> index;
+			std::vector<uint32_t> resident(TextureCount, 0);
+			for (auto i = 0u; i < TextureCount; ++i)
+			{
+				auto id = manager.Register(sizes[i].data(), mipCounts[i], tails[i]);
+				index[id] = i;
+				resident[i] = mipCounts[i];
+			}
+
+			std::vector<ResidencyManager::Change> changes;
+			for (auto frame = 0; frame < 200; ++frame)
+			{
+				for (auto& itr : index)
+				{
+					if (random.Next(3) == 0)
+					{
+						manager.Request(itr.first, random.Next(mipCounts[itr.second]));
+					}
+				}
+
+				// a texture may change twice in an update, as MipStreamer applies the last change
+				manager.Update(changes);
+				std::map<uint32_t, uint32_t> latest;
+				for (auto& change : changes)
+				{
+					latest[change.Id] = change.ResidentMip;
+				}
+
+				for (auto& change : latest)
+				{
+					auto i = index[change.first];
+
+					// about one upgrade in ten fails to upload and is rolled back. a failed
+					// eviction keeps the finer mips, which may exceed the budget
+					if (change.second < resident[i] && random.Next(10) == 0)
+					{
+						manager.SetResidentMip(change.first, resident[i]);
+					}
+					else
+					{
+						resident[i] = change.second;
+					}
+				}
+
+				uint64_t used = 0;
+				for (auto& itr : index)
+				{
+					auto i = itr.second;
+					CHECK(manager.GetResidentMip(itr.first) == resident[i]);
+					used += GetBytes(sizes[i], resident[i]);
+				}
+
+				if (!CHECK(manager.GetUsedBytes() == used) || !CHECK(used <= manager.GetBudget()))
+				{
+					break;
+				}
+			}
+		}
+	}
+
+	void TestSelectMip()
+	{
+		CHECK(SelectMip(256, 256, 9, 1000.0f) == 0);
+		CHECK(SelectMip(256, 256, 9, 256.0f) == 0);
+		CHECK(SelectMip(256, 256, 9, 128.0f) == 1);
+		CHECK(SelectMip(256, 256, 9, 100.0f) == 1);
+		CHECK(SelectMip(256, 64, 9, 64.0f) == 2);
+		CHECK(SelectMip(256, 256, 9, 0.5f) == 8);
+		CHECK(SelectMip(256, 256, 4, 2.0f) == 3);
+		CHECK(SelectMip(256, 256, 0, 2.0f) == 0);
+
+		// an object as large as the view covers the viewport
+		auto size = ComputeScreenSize(2.0f, 1.0f, 2.0f * atanf(1.0f), 720.0f);
+		CHECK(fabsf(size - 720.0f) < 0.01f);
+		CHECK(ComputeScreenSize(1.0f, 0.0f, 1.0f, 720.0f) > 1.0e30f);
+		CHECK(ComputeScreenSize(1.0f, 20.0f, 1.0f, 720.0f) < ComputeScreenSize(1.0f, 10.0f, 1.0f, 720.0f));
+	}
+} // namespace
+
+int main()
+{
+	RUN_TEST(TestRegister);
+	RUN_TEST(TestUpgradeAndEvict);
+	RUN_TEST(TestUploadLimit);
+	RUN_TEST(TestRollback);
+	RUN_TEST(TestFuzz);
+	RUN_TEST(TestSelectMip);
+	return TEST_RESULT();
+}
@@ -0,0 +1,167 @@
+#include "RootSignature.h"
+#include "PipelineCache.h"
+#include "FakeDevice.h"
+#include "TestUtil.h"
+#include <vector>
+
+namespace {
+	// description over the parameters, without samplers
+	D3D12_ROOT_SIGNATURE_DESC MakeDesc(const std::vector<D3D12_ROOT_PARAMETER>& params)
+	{
+		D3D12_ROOT_SIGNATURE_DESC desc = {};
+		desc.NumParameters = UINT(params.size());
+		desc.pParameters = params.data();
+		return desc;
+	}
+
+	D3D12_ROOT_PARAMETER MakeParam(D3D12_ROOT_PARAMETER_TYPE type, UINT constantCount = 0)
+	{
+		D3D12_ROOT_PARAMETER param = {};
+		param.ParameterType = type;
+		if (type == D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS)
+		{
+			param.Constants.Num32BitValues = constantCount;
+		}
+		return param;
+	}
+
+	// tables cost 1, root descriptors 2 and constants 1 per value; samplers are free
+	void TestCost()
+	{
+		std::vector<D3D12_ROOT_PARAMETER> params;
+		CHECK(GetRootSignatureCost(MakeDesc(params)) == 0);
+
+		params.push_back(MakeParam(D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE));
+		CHECK(GetRootSignatureCost(MakeDesc(params)) == 1);
+
+		params.push_back(MakeParam(D3D12_ROOT_PARAMETER_TYPE_CBV));
+		params.push_back(MakeParam(D3D12_ROOT_PARAMETER_TYPE_SRV));
+		params.push_back(MakeParam(D3D12_ROOT_PARAMETER_TYPE_UAV));
+		CHECK(GetRootSignatureCost(MakeDesc(params)) == 7);
+
+		params.push_back(MakeParam(D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS, 5));
+		params.push_back(MakeParam(D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS, 0));
+		CHECK(GetRootSignatureCost(MakeDesc(params)) == 12);
+
+		D3D12_STATIC_SAMPLER_DESC sampler = {};
+		auto desc = MakeDesc(params);
+		desc.NumStaticSamplers = 1;
+		desc.pStaticSamplers = &sampler;
+		CHECK(GetRootSignatureCost(desc) == 12);
+	}
+
+	// 64 DWORDs is the limit itself, one more is over it
+	void TestLimit()
+	{
+		CHECK(MaxRootSignatureCost == 64);
+
+		std::vector<D3D12_ROOT_PARAMETER> params;
+		params.push_back(MakeParam(D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS, 64));
+		CHECK(GetRootSignatureCost(MakeDesc(params)) == 64);
+
+		params[0].Constants.Num32BitValues = 65;
+		CHECK(GetRootSignatureCost(MakeDesc(params)) == 65);
+
+		// 32 root descriptors fill the limit, and a table more breaks it
+		params.assign(32, MakeParam(D3D12_ROOT_PARAMETER_TYPE_CBV));
+		CHECK(GetRootSignatureCost(MakeDesc(params)) == 64);
+		params.push_back(MakeParam(D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE));
+		CHECK(GetRootSignatureCost(MakeDesc(params)) == 65);
+	}
+
+	// the builder reports the cost of what it built
+	void TestDesc()
+	{
+		RootSignature::Desc desc;
+		desc.Begin(5)
+			.SetCBV(ShaderStage::VS, 0, 0)
+			.SetSRV(ShaderStage::PS, 1, 0, 4)
+			.SetConstants(ShaderStage::PS, 2, 1, 8)
+			.SetRootCBV(ShaderStage::PS, 3, 2)
+			.SetRootSRV(ShaderStage::PS, 4, 4)
+			.AddStaticSmp(ShaderStage::PS, 0, SamplerState::LinearWrap)
+			.AllowIL()
+			.End();
+		CHECK(desc.GetCost() == 1 + 1 + 8 + 2 + 2);
+		CHECK(desc.GetCost() == GetRootSignatureCost(*desc.GetDesc()));
+		CHECK(desc.IsValid());
+
+		// an index past Begin() or below 0 is ignored
+		desc.SetConstants(ShaderStage::PS, 5, 0, 100).End();
+		CHECK(desc.GetCost() == 14);
+		desc.SetConstants(ShaderStage::PS, -1, 0, 100)
+			.SetRootCBV(ShaderStage::PS, -1, 0)
+			.SetSRV(ShaderStage::PS, -1, 0)
+			.End();
+		CHECK(desc.GetCost() == 14);
+
+		desc.Begin(2)
+			.SetConstants(ShaderStage::ALL, 0, 0, 62)
+			.SetRootCBV(ShaderStage::VS, 1, 0)
+			.End();
+		CHECK(desc.GetCost() == 64);
+		CHECK(desc.IsValid());
+
+		desc.Begin(2)
+			.SetConstants(ShaderStage::ALL, 0, 0, 63)
+			.SetRootSRV(ShaderStage::VS, 1, 0)
+			.End();
+		CHECK(desc.GetCost() == 65);
+		CHECK(!desc.IsValid());
+	}
+
+	// a description over the limit never reaches the device
+	void TestInit()
+	{
+		auto pDevice = new Fake::Device();
+
+		{
+			RootSignature::Desc fit;
+			fit.Begin(2)
+				.SetConstants(ShaderStage::ALL, 0, 0, 62)
+				.SetRootCBV(ShaderStage::VS, 1, 0)
+				.End();
+
+			RootSignature::Desc over;
+			over.Begin(2)
+				.SetConstants(ShaderStage::ALL, 0, 0, 63)
+				.SetRootCBV(ShaderStage::VS, 1, 0)
+				.End();
+
+			RootSignature rootSignature;
+			CHECK(!rootSignature.Init(pDevice, nullptr));
+			CHECK(!rootSignature.Init(pDevice, over.GetDesc()));
+			CHECK(rootSignature.GetPtr() == nullptr);
+			CHECK(pDevice->GetRootSignatureCount() == 0);
+
+			CHECK(rootSignature.Init(pDevice, fit.GetDesc()));
+			CHECK(rootSignature.GetPtr() != nullptr);
+			CHECK(pDevice->GetRootSignatureCount() == 1);
+			rootSignature.Term();
+
+			// the cache checks the limit as well
+			PipelineCache cache;
+			CHECK(cache.Init(pDevice, nullptr));
+			CHECK(!rootSignature.Init(&cache, over.GetDesc()));
+			CHECK(pDevice->GetRootSignatureCount() == 1);
+			CHECK(rootSignature.Init(&cache, fit.GetDesc()));
+			CHECK(rootSignature.GetPtr() == cache.GetRootSignature(fit.GetDesc()));
+			CHECK(pDevice->GetRootSignatureCount() == 2);
+
+			rootSignature.Term();
+			cache.Term();
+		}
+
+		pDevice->Release();
+		CHECK(Fake::LiveCount() == 0);
+	}
+} // namespace
+
+int main()
+{
+	RUN_TEST(TestCost);
+	RUN_TEST(TestLimit);
+	RUN_TEST(TestDesc);
+	RUN_TEST(TestInit);
+	return TEST_RESULT();
+}
@@ -0,0 +1,267 @@
+#include "StagingPlanner.h"
+#include "TestUtil.h"
+#include <algorithm>
+#include <vector>
+
+namespace {
+	// plan an upload in pieces of one chunk, starting over when the chunks would exceed
+	// the cap, as BufferUploadBatch::Upload() does. returns the number of flushes
+	int AddCapped(StagingPlanner& planner, uint32_t maxChunkCount, uint32_t target, uint64_t dstOffset, uint64_t size)
+	{
+		auto flushCount = 0;
+		while (size > 0)
+		{
+			auto piece = std::min(size, planner.GetChunkSize());
+			if (planner.GetRegionCount() > 0 && planner.GetChunkCountAfter(target, dstOffset, piece) > maxChunkCount)
+			{
+				planner.Reset();
+				flushCount++;
+			}
+
+			auto expected = planner.GetChunkCountAfter(target, dstOffset, piece);
+			CHECK(planner.Add(target, dstOffset, piece));
+			CHECK(planner.GetChunkCount() == expected);
+			CHECK(planner.GetChunkCount() <= maxChunkCount);
+
+			dstOffset += piece;
+			size -= piece;
+		}
+		return flushCount;
+	}
+
+	void TestInit()
+	{
+		StagingPlanner planner;
+		CHECK(!planner.Init(1024, 0));
+		CHECK(!planner.Init(1024, 24));
+		CHECK(!planner.Init(8, 16));
+		CHECK(planner.Init(1024, 16));
+		CHECK(planner.GetChunkSize() == 1024);
+		CHECK(planner.GetChunkCount() == 0);
+
+		CHECK(!planner.Add(0, 0, 0));
+		CHECK(planner.GetChunkCountAfter(0, 0, 0) == 0);
+
+		planner.Term();
+		CHECK(!planner.Add(0, 0, 16));
+	}
+
+	void TestPlacement()
+	{
+		StagingPlanner planner;
+		CHECK(planner.Init(1024, 16));
+
+		// placements start at aligned offsets
+		size_t first = 0;
+		CHECK(planner.Add(0, 0, 10, &first));
+		CHECK(first == 0);
+		CHECK(planner.Add(1, 0, 10, &first));
+		CHECK(first == 1);
+		CHECK(planner.GetRegion(0).SrcOffset == 0);
+		CHECK(planner.GetRegion(1).SrcOffset == 16);
+		CHECK(planner.GetChunkCount() == 1);
+
+		// an upload which fits in one chunk is not split, it opens a new chunk
+		CHECK(planner.GetChunkCountAfter(2, 0, 1000) == 2);
+		CHECK(planner.Add(2, 0, 1000, &first));
+		CHECK(planner.GetRegionCount() == 3);
+		CHECK(planner.GetRegion(2).Chunk == 1 && planner.GetRegion(2).SrcOffset == 0);
+
+		// an upload larger than a chunk fills the rest of the last chunk first
+		CHECK(planner.GetChunkCountAfter(3, 0, 2048) == 4);
+		CHECK(planner.Add(3, 0, 2048, &first));
+		CHECK(first == 3);
+		CHECK(planner.GetChunkCount() == 4);
+
+		uint64_t total = 0;
+		for (auto i = first; i < planner.GetRegionCount(); ++i)
+		{
+			const auto& region = planner.GetRegion(i);
+			CHECK(region.Target == 3);
+			CHECK(region.DstOffset == total);
+			CHECK(region.SrcOffset + region.Size <= 1024);
+			total += region.Size;
+		}
+		CHECK(total == 2048);
+		CHECK(planner.GetRegion(first).Chunk == 1 && planner.GetRegion(first).SrcOffset == 1008);
+
+		planner.Reset();
+		CHECK(planner.GetRegionCount() == 0);
+		CHECK(planner.GetChunkCount() == 0);
+		CHECK(planner.GetChunkCountAfter(0, 0, 1024) == 1);
+		CHECK(planner.GetChunkCountAfter(0, 0, 1025) == 2);
+	}
+
+	void TestCoalesce()
+	{
+		StagingPlanner planner;
+		CHECK(planner.Init(256, 16));
+
+		// uploads continuing each other are packed without padding and merged
+		CHECK(planner.Add(0, 0, 10));
+		CHECK(planner.Add(0, 10, 10));
+		CHECK(planner.Add(0, 20, 30));
+		CHECK(planner.GetRegion(1).SrcOffset == 10);
+
+		// a gap in the destination or another target starts a new copy
+		CHECK(planner.Add(0, 100, 10));
+		CHECK(planner.Add(1, 110, 10));
+
+		std::vector<StagingPlanner::Region> regions;
+		planner.Coalesce(regions);
+		CHECK(regions.size() == 3);
+		CHECK(regions[0].Target == 0 && regions[0].DstOffset == 0 && regions[0].Size == 50);
+		CHECK(regions[1].Target == 0 && regions[1].DstOffset == 100 && regions[1].SrcOffset == 64);
+		CHECK(regions[2].Target == 1 && regions[2].SrcOffset == 80);
+
+		// a continuation larger than a chunk fills the chunk, and is merged only within it
+		planner.Reset();
+		CHECK(planner.Add(0, 0, 200));
+		CHECK(planner.Add(0, 200, 300));
+		planner.Coalesce(regions);
+		CHECK(regions.size() == 2);
+		CHECK(regions[0].Chunk == 0 && regions[0].Size == 256);
+		CHECK(regions[1].Chunk == 1 && regions[1].DstOffset == 256 && regions[1].Size == 244);
+
+		// a continuation which fits in a chunk is kept in one piece in a new chunk
+		planner.Reset();
+		CHECK(planner.Add(0, 0, 200));
+		CHECK(planner.Add(0, 200, 200));
+		planner.Coalesce(regions);
+		CHECK(regions.size() == 2);
+		CHECK(regions[1].Chunk == 1 && regions[1].SrcOffset == 0 && regions[1].Size == 200);
+	}
+
+	void TestCap()
+	{
+		StagingPlanner planner;
+		CHECK(planner.Init(1024, 16));
+
+		// 10 chunks of data under a cap of 4 chunks
+		CHECK(AddCapped(planner, 4, 0, 0, 10 * 1024) == 2);
+		CHECK(planner.GetChunkCount() == 2);
+
+		// small uploads fill the chunks before a flush
+		planner.Reset();
+		auto flushCount = 0;
+		for (uint32_t i = 0; i < 256; ++i)
+		{
+			flushCount += AddCapped(planner, 2, i, 0, 100);
+		}
+
+		// 9 uploads padded to 112 bytes fit in a chunk, 18 under the cap
+		CHECK(flushCount == 14);
+
+		// a cap of one chunk still takes every upload
+		planner.Reset();
+		CHECK(AddCapped(planner, 1, 0, 0, 3000) == 2);
+	}
+
+	// regions of random uploads cover every destination byte once and never overlap in a chunk
+	void TestFuzz()
+	{
+		for (uint64_t seed = 0; seed < 50; ++seed)
+		{
+			TestUtil::Random random(seed);
+
+			const uint64_t ChunkSize = 256u << random.Next(4);
+			const uint64_t Alignment = 1u << random.Next(6);
+			const uint32_t TargetCount = 4;
+			const uint64_t TargetSize = 8192;
+
+			StagingPlanner planner;
+			CHECK(planner.Init(ChunkSize, Alignment));
+
+			std::vector<std::vector<uint8_t>> written(TargetCount, std::vector<uint8_t>(TargetSize, 0));
+			for (auto upload = 0; upload < 64; ++upload)
+			{
+				auto target = random.Next(TargetCount);
+				auto size = 1 + random.Next(uint32_t(ChunkSize * 3));
+				auto dstOffset = random.Next(uint32_t(TargetSize - size));
+
+				// continue the previous upload once in a while
+				if (planner.GetRegionCount() > 0 && random.Next(3) == 0)
+				{
+					const auto& last = planner.GetRegion(planner.GetRegionCount() - 1);
+					if (last.DstOffset + last.Size + size <= TargetSize)
+					{
+						target = last.Target;
+						dstOffset = uint32_t(last.DstOffset + last.Size);
+					}
+				}
+
+				// skip destination bytes written before, so each byte is written once
+				auto overlap = false;
+				for (auto i = dstOffset; i < dstOffset + size; ++i)
+				{
+					overlap |= (written[target][i] != 0);
+				}
+				if (overlap)
+				{
+					continue;
+				}
+
+				auto expected = planner.GetChunkCountAfter(target, dstOffset, size);
+				size_t first = 0;
+				CHECK(planner.Add(target, dstOffset, size, &first));
+				CHECK(planner.GetChunkCount() == expected);
+
+				uint64_t covered = 0;
+				for (auto i = first; i < planner.GetRegionCount(); ++i)
+				{
+					const auto& region = planner.GetRegion(i);
+					CHECK(region.Target == target);
+					CHECK(region.DstOffset == dstOffset + covered);
+					CHECK(region.Chunk < planner.GetChunkCount());
+					CHECK(region.SrcOffset + region.Size <= ChunkSize);
+					covered += region.Size;
+				}
+				CHECK(covered == size);
+				std::fill(written[target].begin() + dstOffset, written[target].begin() + dstOffset + size, uint8_t(1));
+			}
+
+			// staging bytes are used by one region at most
+			std::vector<std::vector<uint8_t>> used(planner.GetChunkCount(), std::vector<uint8_t>(size_t(ChunkSize), 0));
+			for (size_t i = 0; i < planner.GetRegionCount(); ++i)
+			{
+				const auto& region = planner.GetRegion(i);
+				for (auto j = region.SrcOffset; j < region.SrcOffset + region.Size; ++j)
+				{
+					if (!CHECK(used[region.Chunk][size_t(j)] == 0))
+					{
+						return;
+					}
+					used[region.Chunk][size_t(j)] = 1;
+				}
+			}
+
+			// merged copies move the same bytes as the regions
+			std::vector<StagingPlanner::Region> regions;
+			planner.Coalesce(regions);
+			CHECK(regions.size() <= planner.GetRegionCount());
+
+			uint64_t planned = 0;
+			uint64_t merged = 0;
+			for (size_t i = 0; i < planner.GetRegionCount(); ++i)
+			{
+				planned += planner.GetRegion(i).Size;
+			}
+			for (auto& region : regions)
+			{
+				merged += region.Size;
+				CHECK(region.SrcOffset + region.Size <= ChunkSize);
+			}
+			CHECK(planned == merged);
+		}
+	}
+} // namespace
+
+int main()
+{
+	RUN_TEST(TestInit);
+	RUN_TEST(TestPlacement);
+	RUN_TEST(TestCoalesce);
+	RUN_TEST(TestCap);
+	RUN_TEST(TestFuzz);
+	return TEST_RESULT();
+}
@@ -0,0 +1,382 @@
+#include "StreamingScheduler.h"
+#include "TestUtil.h"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+	//
+	// MockUploader class
+	//
+	// Records the order of the stages and the Finish() results. Read() waits while the gate is
+	// closed, the stages fail for the paths and ids they are told to, and a batch is complete
+	// once the test has completed its ticket.
+	//
+	class MockUploader : public StreamingUploader
+	{
+	public:
+		MockUploader()
+			: m_IsOpen(true)
+			, m_Reading(0)
+			, m_MaxReading(0)
+			, m_IsSubmitFailed(false)
+			, m_LastTicket(0)
+			, m_CompletedTicket(0)
+		{
+		}
+
+		bool Read(uint32_t id, const std::wstring& path) override
+		{
+			auto reading = ++m_Reading;
+			auto maxReading = m_MaxReading.load();
+			while (reading > maxReading && !m_MaxReading.compare_exchange_weak(maxReading, reading))
+			{
+			}
+
+			while (!m_IsOpen)
+			{
+				std::this_thread::yield();
+			}
+
+			bool isFailed;
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				m_Reads.push_back(path);
+				isFailed = std::find(m_FailPaths.begin(), m_FailPaths.end(), path) != m_FailPaths.end();
+			}
+			m_Reading--;
+			return !isFailed;
+		}
+
+		bool Parse(uint32_t id) override
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Parses.push_back(id);
+			return std::find(m_FailIds.begin(), m_FailIds.end(), id) == m_FailIds.end();
+		}
+
+		bool Submit(const std::vector<uint32_t>& ids, uint64_t& ticket) override
+		{
+			if (m_IsSubmitFailed)
+			{
+				return false;
+			}
+
+			m_Batches.push_back(ids);
+			ticket = ++m_LastTicket;
+			return true;
+		}
+
+		bool IsComplete(uint64_t ticket) override
+		{
+			return ticket <= m_CompletedTicket;
+		}
+
+		void Finish(uint32_t id, STREAMING_STATE state) override
+		{
+			m_Finished.push_back(std::make_pair(id, state));
+		}
+
+		void SetOpen(bool open)
+		{
+			m_IsOpen = open;
+		}
+
+		void FailRead(const std::wstring& path)
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_FailPaths.push_back(path);
+		}
+
+		void FailParse(uint32_t id)
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_FailIds.push_back(id);
+		}
+
+		void SetSubmitFailed(bool failed)
+		{
+			m_IsSubmitFailed = failed;
+		}
+
+		// complete every batch submitted so far (UINT64_MAX for later ones as well)
+		void Complete(uint64_t ticket = 0)
+		{
+			m_CompletedTicket = (ticket == 0) ? m_LastTicket : ticket;
+		}
+
+		std::vector<std::wstring> GetReads()
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			return m_Reads;
+		}
+
+		std::vector<uint32_t> GetParses()
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			return m_Parses;
+		}
+
+		const std::vector<std::vector<uint32_t>>& GetBatches() const
+		{
+			return m_Batches;
+		}
+
+		const std::vector<std::pair<uint32_t, STREAMING_STATE>>& GetFinished() const
+		{
+			return m_Finished;
+		}
+
+		int GetReading() const
+		{
+			return m_Reading;
+		}
+
+		int GetMaxReading() const
+		{
+			return m_MaxReading;
+		}
+
+	private:
+		std::atomic<bool> m_IsOpen;
+		std::atomic<int> m_Reading;
+		std::atomic<int> m_MaxReading;
+		bool m_IsSubmitFailed;
+		uint64_t m_LastTicket;
+		uint64_t m_CompletedTicket;
+		std::mutex m_Mutex;
+		std::vector<std::wstring> m_Reads;
+		std::vector<uint32_t> m_Parses;
+		std::vector<std::wstring> m_FailPaths;
+		std::vector<uint32_t> m_FailIds;
+		std::vector<std::vector<uint32_t>> m_Batches;
+		std::vector<std::pair<uint32_t, STREAMING_STATE>> m_Finished;
+	};
+
+	// higher priority first, request order within a priority, at most maxInFlight at once, and
+	// one batch on the GPU while the next one gathers
+	void TestOrder()
+	{
+		ThreadPool inlinePool;
+		MockUploader uploader;
+		StreamingScheduler scheduler;
+		CHECK(!scheduler.Init(nullptr, &inlinePool, &inlinePool, 2));
+		CHECK(!scheduler.Init(&uploader, &inlinePool, &inlinePool, 0));
+		CHECK(scheduler.Init(&uploader, &inlinePool, &inlinePool, 2));
+
+		auto a = scheduler.Request(L"a.dds", 0);
+		auto b = scheduler.Request(L"b.dds", 5);
+		auto c = scheduler.Request(L"c.dds", 0);
+		auto d = scheduler.Request(L"d.dds", 5);
+		CHECK(scheduler.GetState(a) == STREAMING_STATE_QUEUED);
+		CHECK(!scheduler.IsIdle());
+
+		// without workers a request is read and parsed in Update(), and batched by the next one
+		std::vector<StreamingScheduler::Result> results;
+		scheduler.Update(results);
+		CHECK(results.empty());
+		CHECK(uploader.GetReads() == std::vector<std::wstring>({ L"b.dds", L"d.dds" }));
+		CHECK(scheduler.GetState(b) == STREAMING_STATE_PARSED && scheduler.GetState(a) == STREAMING_STATE_QUEUED);
+
+		scheduler.Update(results);
+		CHECK(results.empty());
+		CHECK(uploader.GetBatches().size() == 1 && uploader.GetBatches()[0] == std::vector<uint32_t>({ b, d }));
+		CHECK(scheduler.GetState(b) == STREAMING_STATE_UPLOADING && scheduler.GetState(d) == STREAMING_STATE_UPLOADING);
+		CHECK(uploader.GetReads() == std::vector<std::wstring>({ L"b.dds", L"d.dds", L"a.dds", L"c.dds" }));
+
+		// a and c wait for the batch on the GPU
+		scheduler.Update(results);
+		CHECK(results.empty() && uploader.GetBatches().size() == 1);
+		CHECK(scheduler.GetState(a) == STREAMING_STATE_PARSED && scheduler.GetState(c) == STREAMING_STATE_PARSED);
+
+		uploader.Complete();
+		scheduler.Update(results);
+		CHECK(results.size() == 2 && results[0].Id == b && results[1].Id == d);
+		CHECK(results[0].State == STREAMING_STATE_RESIDENT && results[1].State == STREAMING_STATE_RESIDENT);
+		CHECK(uploader.GetBatches().size() == 2 && uploader.GetBatches()[1] == std::vector<uint32_t>({ a, c }));
+		CHECK(!scheduler.IsIdle());
+
+		uploader.Complete();
+		scheduler.Update(results);
+		CHECK(results.size() == 2 && results[0].Id == a && results[1].Id == c);
+		CHECK(scheduler.GetState(c) == STREAMING_STATE_RESIDENT);
+		CHECK(scheduler.IsIdle());
+
+		// Finish() is called once for each request, when it is reported
+		const auto& finished = uploader.GetFinished();
+		CHECK(finished.size() == 4);
+		CHECK(finished.size() == 4 && finished[0].first == b && finished[3].first == c);
+		CHECK(std::all_of(finished.begin(), finished.end(), [](const std::pair<uint32_t, STREAMING_STATE>& item)
+		{
+			return item.second == STREAMING_STATE_RESIDENT;
+		}));
+
+		// every call is a request of its own
+		CHECK(scheduler.Request(L"a.dds") != a);
+		CHECK(scheduler.GetState(StreamingScheduler::InvalidId) == STREAMING_STATE_FAILED);
+	}
+
+	// a failed stage finishes the request in the next Update(), and a failed submission fails its batch
+	void TestFailure()
+	{
+		ThreadPool inlinePool;
+		MockUploader uploader;
+		StreamingScheduler scheduler;
+		CHECK(scheduler.Init(&uploader, &inlinePool, &inlinePool, 4));
+
+		uploader.FailRead(L"missing.dds");
+		auto missing = scheduler.Request(L"missing.dds");
+		auto broken = scheduler.Request(L"broken.dds");
+		auto good = scheduler.Request(L"good.dds");
+		uploader.FailParse(broken);
+
+		std::vector<StreamingScheduler::Result> results;
+		scheduler.Update(results);
+		CHECK(scheduler.GetState(missing) == STREAMING_STATE_READING);
+		CHECK(uploader.GetParses() == std::vector<uint32_t>({ broken, good }));
+
+		scheduler.Update(results);
+		CHECK(scheduler.GetState(missing) == STREAMING_STATE_FAILED);
+		CHECK(results.size() == 2);
+		CHECK(results.size() == 2 && results[0].Id == missing && results[0].State == STREAMING_STATE_FAILED);
+		CHECK(results.size() == 2 && results[1].Id == broken && results[1].State == STREAMING_STATE_FAILED);
+		CHECK(scheduler.GetState(good) == STREAMING_STATE_UPLOADING);
+
+		uploader.Complete();
+		scheduler.Update(results);
+		CHECK(results.size() == 1 && results[0].Id == good && results[0].State == STREAMING_STATE_RESIDENT);
+
+		uploader.SetSubmitFailed(true);
+		auto a = scheduler.Request(L"a.dds");
+		auto b = scheduler.Request(L"b.dds");
+		scheduler.Update(results);
+		scheduler.Update(results);
+		CHECK(results.size() == 2 && results[0].Id == a && results[1].Id == b);
+		CHECK(scheduler.GetState(a) == STREAMING_STATE_FAILED && scheduler.GetState(b) == STREAMING_STATE_FAILED);
+		CHECK(!scheduler.Cancel(a));
+		CHECK(uploader.GetFinished().size() == 5);
+		CHECK(scheduler.IsIdle());
+
+		// a failure not reported yet can still be canceled
+		uploader.FailRead(L"late.dds");
+		auto late = scheduler.Request(L"late.dds");
+		scheduler.Update(results);
+		CHECK(scheduler.Cancel(late));
+		scheduler.Update(results);
+		CHECK(results.size() == 1 && results[0].Id == late && results[0].State == STREAMING_STATE_CANCELED);
+	}
+
+	// a request canceled at any stage finishes as canceled, and never reaches the later stages
+	void TestCancel()
+	{
+		ThreadPool inlinePool;
+		MockUploader uploader;
+		StreamingScheduler scheduler;
+		CHECK(scheduler.Init(&uploader, &inlinePool, &inlinePool, 4));
+
+		auto uploading = scheduler.Request(L"uploading.dds");
+		std::vector<StreamingScheduler::Result> results;
+		scheduler.Update(results);
+		scheduler.Update(results);
+		CHECK(scheduler.GetState(uploading) == STREAMING_STATE_UPLOADING);
+
+		auto queued = scheduler.Request(L"queued.dds");
+		auto parsed = scheduler.Request(L"parsed.dds");
+		CHECK(scheduler.Cancel(queued));
+		CHECK(!scheduler.Cancel(queued));
+		CHECK(!scheduler.Cancel(StreamingScheduler::InvalidId));
+		CHECK(scheduler.GetState(queued) == STREAMING_STATE_CANCELED);
+
+		// the queued one is reported at once, the parsed one when it leaves the pool threads
+		scheduler.Update(results);
+		CHECK(results.size() == 1 && results[0].Id == queued && results[0].State == STREAMING_STATE_CANCELED);
+		CHECK(scheduler.GetState(parsed) == STREAMING_STATE_PARSED);
+		CHECK(scheduler.Cancel(parsed));
+		CHECK(scheduler.Cancel(uploading));
+
+		// the batch keeps its canceled request until the GPU is done with it
+		scheduler.Update(results);
+		CHECK(results.size() == 1 && results[0].Id == parsed && results[0].State == STREAMING_STATE_CANCELED);
+		CHECK(!scheduler.IsIdle());
+
+		uploader.Complete();
+		scheduler.Update(results);
+		CHECK(results.size() == 1 && results[0].Id == uploading && results[0].State == STREAMING_STATE_CANCELED);
+		CHECK(scheduler.IsIdle());
+
+		CHECK(uploader.GetReads() == std::vector<std::wstring>({ L"uploading.dds", L"parsed.dds" }));
+		CHECK(uploader.GetBatches().size() == 1);
+		CHECK(uploader.GetFinished().size() == 3);
+	}
+
+	// a request canceled while it is read is never parsed, and the pools never read more than
+	// maxInFlight at once
+	void TestCancelReading()
+	{
+		ThreadPool ioPool;
+		ThreadPool workerPool;
+		CHECK(ioPool.Init(4));
+		CHECK(workerPool.Init(2));
+
+		MockUploader uploader;
+		uploader.SetOpen(false);
+		uploader.Complete(UINT64_MAX);
+		StreamingScheduler scheduler;
+		CHECK(scheduler.Init(&uploader, &ioPool, &workerPool, 2));
+
+		std::vector<uint32_t> ids;
+		for (auto i = 0; i < 6; ++i)
+		{
+			ids.push_back(scheduler.Request(L"texture" + std::to_wstring(i) + L".dds"));
+		}
+
+		std::vector<StreamingScheduler::Result> results;
+		scheduler.Update(results);
+		while (uploader.GetReading() < 2)
+		{
+			std::this_thread::yield();
+		}
+
+		CHECK(scheduler.GetState(ids[0]) == STREAMING_STATE_READING);
+		CHECK(scheduler.Cancel(ids[0]));
+		CHECK(scheduler.GetState(ids[0]) == STREAMING_STATE_CANCELED);
+
+		uploader.SetOpen(true);
+		auto residentCount = 0;
+		auto canceledCount = 0;
+		while (!scheduler.IsIdle())
+		{
+			scheduler.Update(results);
+			for (const auto& result : results)
+			{
+				residentCount += (result.State == STREAMING_STATE_RESIDENT) ? 1 : 0;
+				canceledCount += (result.State == STREAMING_STATE_CANCELED) ? 1 : 0;
+				CHECK(result.Id != ids[0] || result.State == STREAMING_STATE_CANCELED);
+			}
+			std::this_thread::yield();
+		}
+
+		CHECK(residentCount == 5 && canceledCount == 1);
+		CHECK(uploader.GetMaxReading() <= 2);
+
+		auto parses = uploader.GetParses();
+		CHECK(parses.size() == 5 && std::find(parses.begin(), parses.end(), ids[0]) == parses.end());
+
+		scheduler.Term();
+		workerPool.Term();
+		ioPool.Term();
+	}
+} // namespace
+
+int main()
+{
+	RUN_TEST(TestOrder);
+	RUN_TEST(TestFailure);
+	RUN_TEST(TestCancel);
+	RUN_TEST(TestCancelReading);
+	return TEST_RESULT();
+}
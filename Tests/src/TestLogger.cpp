@@ -0,0 +1,12 @@
+#include <cstdio>
+#include <cstdarg>
+
+// output log (console only, Logger.cpp needs Win32)
+void OutputLog(const char* format, ...)
+{
+	va_list arg;
+
+	va_start(arg, format);
+	vprintf(format, arg);
+	va_end(arg);
+}
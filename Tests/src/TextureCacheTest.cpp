@@ -0,0 +1,290 @@
+#include "TextureCache.h"
+#include "Hash.h"
+#include "MappedFile.h"
+#include "TestUtil.h"
+#include <map>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+namespace {
+	// contents of fake texture files by path
+	typedef std::map<std::wstring, std::vector<uint8_t>> FileMap;
+
+	std::vector<uint8_t> MakeFile(size_t size, uint8_t seed)
+	{
+		std::vector<uint8_t> data(size);
+		for (size_t i = 0; i < size; ++i)
+		{
+			data[i] = uint8_t(i * 31 + seed);
+		}
+		return data;
+	}
+
+	//
+	// KeyFinder class
+	//
+	// Calls TextureKeyTable::Find() on in-memory files and counts full hashes.
+	//
+	class KeyFinder
+	{
+	public:
+		explicit KeyFinder(const FileMap& files)
+			: m_Files(files)
+			, m_HashCount(0)
+		{
+		}
+
+		TextureKey Find(const std::wstring& path, bool isSRGB = false)
+		{
+			auto hashFile = [this](const std::wstring& filePath, uint64_t& hash)
+			{
+				auto itr = m_Files.find(filePath);
+				if (itr == m_Files.end())
+				{
+					return false;
+				}
+
+				m_HashCount++;
+				hash = ComputeTextureKey(itr->second.data(), itr->second.size(), false).Hash;
+				return true;
+			};
+
+			const auto& data = m_Files.at(path);
+			TextureKey key = {};
+			CHECK(m_Table.Find(path, data.data(), data.size(), isSRGB, hashFile, key));
+			return key;
+		}
+
+		TextureKeyTable& GetTable()
+		{
+			return m_Table;
+		}
+
+		int GetHashCount() const
+		{
+			return m_HashCount;
+		}
+
+	private:
+		const FileMap& m_Files;
+		TextureKeyTable m_Table;
+		int m_HashCount;
+	};
+
+	void TestKeys()
+	{
+		auto data = MakeFile(10000, 1);
+
+		auto key = ComputeTextureKey(data.data(), data.size(), false);
+		CHECK(key.Hash == HashBytes(data.data(), data.size()));
+		CHECK(key.Size == 10000 && !key.IsSRGB);
+		CHECK(!(key == ComputeTextureKey(data.data(), data.size(), true)));
+
+		// the pre-key reads only the first bytes, and is not a key of the whole file
+		auto preKey = ComputeTexturePreKey(data.data(), data.size(), false);
+		CHECK(!(preKey == key));
+		auto changed = data;
+		changed.back() ^= 0xff;
+		CHECK(ComputeTexturePreKey(changed.data(), changed.size(), false) == preKey);
+		CHECK(!(ComputeTextureKey(changed.data(), changed.size(), false) == key));
+		changed[10] ^= 0xff;
+		CHECK(!(ComputeTexturePreKey(changed.data(), changed.size(), false) == preKey));
+
+		// a file smaller than the pre-key range is hashed whole
+		auto small = MakeFile(100, 2);
+		CHECK(ComputeTexturePreKey(small.data(), small.size(), false).Size == 100);
+
+		// ordering distinguishes every field
+		TextureKey a = { 1, 2, false };
+		TextureKey b = { 1, 2, true };
+		TextureKey c = { 1, 3, false };
+		CHECK(a < b && !(b < a));
+		CHECK(a < c && !(c < a));
+		CHECK(a == a && !(a == b));
+	}
+
+	void TestKeyTable()
+	{
+		FileMap files;
+		files[L"a.dds"] = MakeFile(20000, 1);
+		files[L"copy_of_a.dds"] = files[L"a.dds"];
+		files[L"b.dds"] = MakeFile(20000, 2);
+		files[L"c.dds"] = MakeFile(30000, 1);
+
+		// same start as a, different tail
+		files[L"d.dds"] = files[L"a.dds"];
+		files[L"d.dds"].back() ^= 0xff;
+
+		KeyFinder finder(files);
+
+		// unique pre-keys are never hashed in full
+		auto keyA = finder.Find(L"a.dds");
+		auto keyB = finder.Find(L"b.dds");
+		auto keyC = finder.Find(L"c.dds");
+		CHECK(!(keyA == keyB) && !(keyA == keyC) && !(keyB == keyC));
+		CHECK(finder.Find(L"a.dds") == keyA);
+		CHECK(finder.GetHashCount() == 0);
+
+		// an identical file shares the key of the first one, after both are hashed once
+		CHECK(finder.Find(L"copy_of_a.dds") == keyA);
+		CHECK(finder.GetHashCount() == 2);
+		CHECK(finder.GetTable().GetFullHashCount() == 2);
+
+		// a file which only starts the same way gets the key of its full hash
+		auto keyD = finder.Find(L"d.dds");
+		CHECK(!(keyD == keyA));
+		CHECK(keyD == ComputeTextureKey(files[L"d.dds"].data(), files[L"d.dds"].size(), false));
+		CHECK(finder.GetHashCount() == 3);
+
+		// full hashes are kept
+		CHECK(finder.Find(L"d.dds") == keyD);
+		CHECK(finder.Find(L"copy_of_a.dds") == keyA);
+		CHECK(finder.GetHashCount() == 3);
+
+		// SRGB and linear views of a file differ
+		auto keySRGB = finder.Find(L"a.dds", true);
+		CHECK(keySRGB.IsSRGB && !(keySRGB == keyA));
+
+		finder.GetTable().Clear();
+		CHECK(finder.GetTable().GetFullHashCount() == 0);
+	}
+
+	void TestKeyTableFailure()
+	{
+		FileMap files;
+		files[L"a.dds"] = MakeFile(5000, 1);
+		auto copy = files[L"a.dds"];
+
+		TextureKeyTable table;
+		TextureKey key;
+		auto noHash = [](const std::wstring&, uint64_t&) { return false; };
+		CHECK(table.Find(L"a.dds", files[L"a.dds"].data(), 5000, false, noHash, key));
+
+		// a collision which can not be hashed fails
+		CHECK(!table.Find(L"b.dds", copy.data(), 5000, false, noHash, key));
+		CHECK(!table.Find(L"b.dds", copy.data(), 5000, false, TextureKeyTable::HashFunc(), key));
+		CHECK(table.GetFullHashCount() == 0);
+	}
+
+	void TestCache()
+	{
+		int textures[3] = {};
+		TextureKey keyA = { 1, 100, false };
+		TextureKey keyB = { 2, 200, false };
+
+		TextureCache<int> cache;
+		CHECK(cache.Acquire(keyA) == nullptr);
+		CHECK(cache.Add(keyA, &textures[0]));
+		CHECK(!cache.Add(keyA, &textures[1]));
+		CHECK(!cache.Add(keyB, &textures[0]));
+		CHECK(!cache.Add(keyB, nullptr));
+		CHECK(cache.Add(keyB, &textures[1]));
+		CHECK(cache.GetCount() == 2);
+
+		// sharing counts the bytes which were not loaded again
+		CHECK(cache.Acquire(keyA) == &textures[0]);
+		CHECK(cache.Acquire(keyA) == &textures[0]);
+		CHECK(cache.GetSavedBytes() == 200);
+
+		CHECK(!cache.Release(&textures[0]));
+		CHECK(!cache.Release(&textures[0]));
+		CHECK(cache.Release(&textures[0]));
+		CHECK(cache.Acquire(keyA) == nullptr);
+		CHECK(!cache.Release(&textures[2]));
+
+		// the key can be used again once released
+		CHECK(cache.Add(keyA, &textures[2]));
+		cache.Clear();
+		CHECK(cache.GetCount() == 0 && cache.GetSavedBytes() == 0);
+	}
+
+	void TestManifest()
+	{
+		std::vector<TextureManifestEntry> entries(2);
+		entries[0].Path = L"res/wall_bc.dds";
+		entries[0].Hash = 0x1234567890abcdefull;
+		entries[0].Size = 1024;
+		entries[1].Path = L"";
+		entries[1].Hash = 7;
+		entries[1].Size = 0;
+
+		std::vector<uint8_t> data;
+		SerializeTextureManifest(entries, data);
+
+		std::vector<TextureManifestEntry> restored;
+		CHECK(DeserializeTextureManifest(data.data(), data.size(), restored));
+		CHECK(restored.size() == 2);
+		CHECK(restored[0].Path == entries[0].Path && restored[0].Hash == entries[0].Hash && restored[0].Size == 1024);
+		CHECK(restored[1].Path.empty() && restored[1].Hash == 7);
+
+		// every truncation is rejected
+		for (size_t size = 0; size < data.size(); ++size)
+		{
+			if (!CHECK(!DeserializeTextureManifest(data.data(), size, restored)) || !CHECK(restored.empty()))
+			{
+				break;
+			}
+		}
+		CHECK(!DeserializeTextureManifest(nullptr, 0, restored));
+
+		auto broken = data;
+		broken[4] ^= 0xff;
+		CHECK(!DeserializeTextureManifest(broken.data(), broken.size(), restored));
+
+		// a huge count in a small file is rejected before allocating
+		broken = data;
+		broken[8] = 0xff;
+		broken[11] = 0x7f;
+		CHECK(!DeserializeTextureManifest(broken.data(), broken.size(), restored));
+
+		TextureManifest manifest;
+		manifest.SetEntries(entries);
+		CHECK(manifest.GetCount() == 2);
+
+		TextureKey key;
+		CHECK(manifest.Find(L"res/wall_bc.dds", true, key));
+		CHECK(key.Hash == entries[0].Hash && key.Size == 1024 && key.IsSRGB);
+		CHECK(!manifest.Find(L"res/other.dds", false, key));
+	}
+
+	// the manifest survives a round trip through a file, which MappedFile reads back
+	void TestManifestFile()
+	{
+		auto path = L"TextureCacheTest_" + std::to_wstring(getpid()) + L".manifest";
+
+		std::vector<TextureManifestEntry> entries(1);
+		entries[0].Path = L"a.dds";
+		entries[0].Hash = 42;
+		entries[0].Size = 4096;
+		CHECK(SaveTextureManifest(path.c_str(), entries));
+
+		std::vector<TextureManifestEntry> restored;
+		CHECK(LoadTextureManifest(path.c_str(), restored));
+		CHECK(restored.size() == 1 && restored[0].Hash == 42 && restored[0].Path == L"a.dds");
+
+		MappedFile file;
+		CHECK(file.Open(path.c_str()));
+		std::vector<uint8_t> data;
+		SerializeTextureManifest(entries, data);
+		CHECK(file.GetSize() == data.size());
+		file.Close();
+		CHECK(file.GetData() == nullptr);
+
+		DeleteFileW(path.c_str());
+		CHECK(!LoadTextureManifest(path.c_str(), restored));
+		CHECK(restored.empty());
+		CHECK(!SaveTextureManifest(nullptr, entries));
+	}
+} // namespace
+
+int main()
+{
+	RUN_TEST(TestKeys);
+	RUN_TEST(TestKeyTable);
+	RUN_TEST(TestKeyTableFailure);
+	RUN_TEST(TestCache);
+	RUN_TEST(TestManifest);
+	RUN_TEST(TestManifestFile);
+	return TEST_RESULT();
+}
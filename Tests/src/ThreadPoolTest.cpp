@@ -0,0 +1,155 @@
+#include "ThreadPool.h"
+#include "TestUtil.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace {
+	void TestParallelFor()
+	{
+		ThreadPool pool;
+		CHECK(pool.Init(3));
+		CHECK(pool.GetThreadCount() == 3);
+
+		// every index runs once, for any grain
+		const size_t grains[] = { 0, 1, 7, 1000, 5000 };
+		for (auto grain : grains)
+		{
+			std::vector<std::atomic<int>> counts(1000);
+			pool.ParallelFor(counts.size(), [&](size_t i) { counts[i]++; }, grain);
+
+			auto isOnce = true;
+			for (auto& count : counts)
+			{
+				isOnce &= (count.load() == 1);
+			}
+			CHECK(isOnce);
+		}
+
+		pool.ParallelFor(0, [](size_t) { CHECK(false); });
+		pool.Term();
+
+		// an uninitialized pool runs on the calling thread
+		auto caller = std::this_thread::get_id();
+		auto isCaller = true;
+		pool.ParallelFor(10, [&](size_t) { isCaller &= (std::this_thread::get_id() == caller); });
+		CHECK(isCaller);
+	}
+
+	// tasks submitted from outside and from tasks while workers run all run once, and Term()
+	// runs what is still queued
+	void TestSubmit()
+	{
+		for (auto round = 0; round < 20; ++round)
+		{
+			ThreadPool pool;
+			CHECK(pool.Init(3));
+
+			const auto TaskCount = 500;
+			std::vector<std::atomic<int>> counts(TaskCount * 2);
+			std::vector<std::thread> submitters;
+			for (auto t = 0; t < 2; ++t)
+			{
+				submitters.push_back(std::thread([&, t]()
+				{
+					for (auto i = t; i < TaskCount; i += 2)
+					{
+						pool.Submit([&, i]()
+						{
+							counts[i]++;
+							pool.Submit([&, i]() { counts[TaskCount + i]++; });
+						});
+					}
+				}));
+			}
+
+			for (auto& submitter : submitters)
+			{
+				submitter.join();
+			}
+			pool.Term();
+
+			auto isOnce = true;
+			for (auto& count : counts)
+			{
+				isOnce &= (count.load() == 1);
+			}
+			if (!CHECK(isOnce))
+			{
+				break;
+			}
+		}
+	}
+
+	// a ParallelFor() inside tasks finishes, as its caller runs the iterations nobody took
+	void TestNested()
+	{
+		ThreadPool pool;
+		CHECK(pool.Init(2));
+
+		std::atomic<int> total(0);
+		pool.ParallelFor(8, [&](size_t)
+		{
+			pool.ParallelFor(16, [&](size_t) { total++; });
+		});
+		CHECK(total.load() == 8 * 16);
+	}
+
+	// the caller waits for its own iterations without taking other tasks
+	void TestNoForeignTasks()
+	{
+		ThreadPool pool;
+		CHECK(pool.Init(2));
+
+		// one worker is held, so a task queued behind it stays queued
+		std::atomic<bool> isReleased(false);
+		std::atomic<bool> isHeld(false);
+		pool.Submit([&]()
+		{
+			isHeld = true;
+			while (!isReleased.load())
+			{
+				std::this_thread::yield();
+			}
+		});
+		while (!isHeld.load())
+		{
+			std::this_thread::yield();
+		}
+
+		auto caller = std::this_thread::get_id();
+		std::atomic<bool> isRunOnCaller(false);
+		std::atomic<bool> isForeignDone(false);
+		for (auto i = 0; i < 4; ++i)
+		{
+			pool.Submit([&]()
+			{
+				isRunOnCaller = isRunOnCaller.load() || (std::this_thread::get_id() == caller);
+				std::this_thread::sleep_for(std::chrono::milliseconds(20));
+				isForeignDone = true;
+			});
+		}
+
+		// the second iteration is slow, so the caller has time to wait
+		pool.ParallelFor(2, [](size_t i)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(i == 0 ? 1 : 30));
+		});
+		CHECK(!isRunOnCaller.load());
+
+		isReleased = true;
+		pool.Term();
+		CHECK(isForeignDone.load());
+		CHECK(!isRunOnCaller.load());
+	}
+} // namespace
+
+int main()
+{
+	RUN_TEST(TestParallelFor);
+	RUN_TEST(TestSubmit);
+	RUN_TEST(TestNested);
+	RUN_TEST(TestNoForeignTasks);
+	return TEST_RESULT();
+}
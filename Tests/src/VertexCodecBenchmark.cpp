@@ -0,0 +1,117 @@
+#include "VertexCodec.h"
+#include "TestUtil.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+//
+// MeshVertex layout, which ResMesh.cpp defines in the sample. It needs assimp, so it is not built here.
+//
+const D3D12_INPUT_ELEMENT_DESC MeshVertex::InputElements[] = {
+	{ "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+	{ "NORMAL",   0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+	{ "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT,    0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+	{ "TANGENT",  0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 }
+};
+const D3D12_INPUT_LAYOUT_DESC MeshVertex::InputLayout = { MeshVertex::InputElements, MeshVertex::InputElementCout };
+
+namespace {
+	const char* FormatNames[VERTEX_FORMAT_COUNT] = { "full", "compact", "quantized" };
+
+	// a dense scan: a grid of the given vertex count over 10 units, with a wavy surface
+	std::vector<MeshVertex> MakeScan(uint32_t vertexCount)
+	{
+		auto side = uint32_t(std::sqrt(double(vertexCount)));
+		std::vector<MeshVertex> vertices;
+		vertices.reserve(size_t(side) * side);
+		for (auto y = 0u; y < side; ++y)
+		{
+			for (auto x = 0u; x < side; ++x)
+			{
+				auto u = float(x) / float(side - 1);
+				auto v = float(y) / float(side - 1);
+				auto h = 0.2f * std::sin(u * 20.0f) * std::cos(v * 13.0f);
+				auto nx = -4.0f * std::cos(u * 20.0f) * std::cos(v * 13.0f) / 10.0f;
+				auto ny = 2.6f * std::sin(u * 20.0f) * std::sin(v * 13.0f) / 10.0f;
+				auto length = std::sqrt(nx * nx + ny * ny + 1.0f);
+
+				vertices.push_back(MeshVertex(
+					DirectX::XMFLOAT3(u * 10.0f, v * 10.0f, h),
+					DirectX::XMFLOAT3(nx / length, ny / length, 1.0f / length),
+					DirectX::XMFLOAT2(u, v),
+					DirectX::XMFLOAT3(1.0f, 0.0f, 0.0f)));
+			}
+		}
+		return vertices;
+	}
+
+	// million vertices per second of encoding and of decoding, best of the repeats
+	void MeasureRate(VERTEX_FORMAT format, const std::vector<MeshVertex>& vertices, int repeatCount, double& encodeRate, double& decodeRate)
+	{
+		std::vector<uint8_t> encoded;
+		std::vector<MeshVertex> decoded;
+		VertexQuantization quantization;
+
+		auto encodeTime = 1.0e30;
+		auto decodeTime = 1.0e30;
+		for (auto repeat = 0; repeat < repeatCount; ++repeat)
+		{
+			auto start = std::chrono::steady_clock::now();
+			EncodeVertices(format, vertices, encoded, quantization);
+			auto middle = std::chrono::steady_clock::now();
+			DecodeVertices(format, encoded.data(), vertices.size(), quantization, decoded);
+			auto end = std::chrono::steady_clock::now();
+
+			encodeTime = std::min(encodeTime, std::chrono::duration<double>(middle - start).count());
+			decodeTime = std::min(decodeTime, std::chrono::duration<double>(end - middle).count());
+		}
+
+		encodeRate = double(vertices.size()) / encodeTime * 1.0e-6;
+		decodeRate = double(vertices.size()) / decodeTime * 1.0e-6;
+	}
+} // namespace
+
+// vertex fetch bytes of each format against the full MeshVertex for scans of growing size, with
+// the round trip error and the encode and decode rates of the CPU. the bytes are what one pass
+// over the vertex buffer fetches, which bounds a scan drawn without vertex reuse.
+// --quick runs the small scans once, to keep the program working under ctest
+int main(int argc, char** argv)
+{
+	auto isQuick = (argc > 1 && strcmp(argv[1], "--quick") == 0);
+	auto repeatCount = isQuick ? 1 : 10;
+
+	const uint32_t vertexCounts[] = { 16384, 262144, 1048576, 4194304 };
+	for (auto vertexCount : vertexCounts)
+	{
+		if (isQuick && vertexCount > 16384)
+		{
+			break;
+		}
+
+		auto vertices = MakeScan(vertexCount);
+		auto fullBytes = double(GetVertexStride(VERTEX_FORMAT_FULL)) * vertices.size();
+		printf("vertices %7zu\n", vertices.size());
+
+		for (auto i = 0; i < VERTEX_FORMAT_COUNT; ++i)
+		{
+			auto format = VERTEX_FORMAT(i);
+			auto bytes = double(GetVertexStride(format)) * vertices.size();
+			auto error = MeasureVertexError(format, vertices);
+			auto limit = GetVertexErrorLimit(format, vertices);
+			CHECK(error.MaxPosition <= limit.MaxPosition && error.MaxNormalAngle <= limit.MaxNormalAngle);
+			CHECK(error.MaxTangentAngle <= limit.MaxTangentAngle && error.MaxTexCoord <= limit.MaxTexCoord);
+
+			double encodeRate = 0.0;
+			double decodeRate = 0.0;
+			MeasureRate(format, vertices, repeatCount, encodeRate, decodeRate);
+
+			printf("  %-9s %2u bytes %8.2f MB (%5.1f%%) | error position %.2e normal %.4f deg texcoord %.2e | encode %7.1f Mv/s decode %7.1f Mv/s\n",
+				FormatNames[i], GetVertexStride(format), bytes / (1024.0 * 1024.0), bytes / fullBytes * 100.0,
+				error.MaxPosition, error.MaxNormalAngle, error.MaxTexCoord, encodeRate, decodeRate);
+		}
+	}
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,272 @@
+#include "VertexCodec.h"
+#include "TestUtil.h"
+#include <DirectXPackedVector.h>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+//
+// MeshVertex layout, which ResMesh.cpp defines in the sample. It needs assimp, so it is not built here.
+//
+const D3D12_INPUT_ELEMENT_DESC MeshVertex::InputElements[] = {
+	{ "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+	{ "NORMAL",   0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+	{ "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT,    0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+	{ "TANGENT",  0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 }
+};
+const D3D12_INPUT_LAYOUT_DESC MeshVertex::InputLayout = { MeshVertex::InputElements, MeshVertex::InputElementCout };
+
+namespace {
+	// random unit vector, uniform on the sphere
+	DirectX::XMFLOAT3 RandomDirection(TestUtil::Random& random)
+	{
+		auto z = random.NextFloat() * 2.0f - 1.0f;
+		auto phi = random.NextFloat() * 2.0f * DirectX::XM_PI;
+		auto r = std::sqrt(std::max(0.0f, 1.0f - z * z));
+		return DirectX::XMFLOAT3(r * std::cos(phi), r * std::sin(phi), z);
+	}
+
+	// a mesh of random vertices in a box of the given center and size
+	std::vector<MeshVertex> MakeVertices(TestUtil::Random& random, size_t count, float center, float size, float uvScale)
+	{
+		std::vector<MeshVertex> vertices(count);
+		for (auto& vertex : vertices)
+		{
+			vertex.Position.x = center + (random.NextFloat() - 0.5f) * size;
+			vertex.Position.y = center + (random.NextFloat() - 0.5f) * size;
+			vertex.Position.z = center + (random.NextFloat() - 0.5f) * size;
+			vertex.Normal = RandomDirection(random);
+			vertex.Tangent = RandomDirection(random);
+			vertex.TexCoord.x = (random.NextFloat() * 2.0f - 1.0f) * uvScale;
+			vertex.TexCoord.y = (random.NextFloat() * 2.0f - 1.0f) * uvScale;
+		}
+		return vertices;
+	}
+
+	// the measured error of the format is inside its limits
+	bool CheckError(VERTEX_FORMAT format, const std::vector<MeshVertex>& vertices)
+	{
+		auto error = MeasureVertexError(format, vertices);
+		auto limit = GetVertexErrorLimit(format, vertices);
+		return CHECK(error.MaxPosition <= limit.MaxPosition)
+			&& CHECK(error.MaxNormalAngle <= limit.MaxNormalAngle)
+			&& CHECK(error.MaxTangentAngle <= limit.MaxTangentAngle)
+			&& CHECK(error.MaxTexCoord <= limit.MaxTexCoord);
+	}
+
+	// size of a DXGI format of an input element in bytes
+	uint32_t GetElementSize(DXGI_FORMAT format)
+	{
+		switch (format)
+		{
+		case DXGI_FORMAT_R32G32B32_FLOAT: return 12;
+		case DXGI_FORMAT_R32G32_FLOAT: return 8;
+		case DXGI_FORMAT_R16G16B16A16_UNORM: return 8;
+		case DXGI_FORMAT_R16G16_SNORM: return 4;
+		case DXGI_FORMAT_R16G16_FLOAT: return 4;
+		default: return 0;
+		}
+	}
+
+	void TestLayouts()
+	{
+		CHECK(GetVertexStride(VERTEX_FORMAT_FULL) == 44);
+		CHECK(GetVertexStride(VERTEX_FORMAT_COMPACT) == 24);
+		CHECK(GetVertexStride(VERTEX_FORMAT_QUANTIZED) == 20);
+
+		// every layout has the semantics BasicVS reads, and its elements fill the stride
+		const char* semantics[] = { "POSITION", "NORMAL", "TEXCOORD", "TANGENT" };
+		for (auto i = 0; i < VERTEX_FORMAT_COUNT; ++i)
+		{
+			auto format = VERTEX_FORMAT(i);
+			auto layout = GetVertexInputLayout(format);
+			CHECK(layout.NumElements == 4);
+
+			uint32_t size = 0;
+			for (auto& semantic : semantics)
+			{
+				auto found = false;
+				for (auto j = 0u; j < layout.NumElements; ++j)
+				{
+					found |= (strcmp(layout.pInputElementDescs[j].SemanticName, semantic) == 0);
+				}
+				CHECK(found);
+			}
+			for (auto j = 0u; j < layout.NumElements; ++j)
+			{
+				auto elementSize = GetElementSize(layout.pInputElementDescs[j].Format);
+				CHECK(elementSize > 0);
+				size += elementSize;
+			}
+			CHECK(size == GetVertexStride(format));
+		}
+	}
+
+	void TestFull()
+	{
+		TestUtil::Random random(1);
+		auto vertices = MakeVertices(random, 100, 0.0f, 10.0f, 1.0f);
+
+		// the full format is a copy
+		std::vector<uint8_t> encoded;
+		VertexQuantization quantization;
+		EncodeVertices(VERTEX_FORMAT_FULL, vertices, encoded, quantization);
+		CHECK(encoded.size() == 44 * vertices.size());
+		CHECK(memcmp(encoded.data(), vertices.data(), encoded.size()) == 0);
+
+		auto error = MeasureVertexError(VERTEX_FORMAT_FULL, vertices);
+		CHECK(error.MaxPosition == 0.0f && error.MaxNormalAngle == 0.0f);
+		CHECK(error.MaxTangentAngle == 0.0f && error.MaxTexCoord == 0.0f);
+
+		// nothing to encode
+		std::vector<MeshVertex> decoded;
+		EncodeVertices(VERTEX_FORMAT_COMPACT, std::vector<MeshVertex>(), encoded, quantization);
+		CHECK(encoded.empty());
+		DecodeVertices(VERTEX_FORMAT_COMPACT, nullptr, 0, quantization, decoded);
+		CHECK(decoded.empty());
+	}
+
+	void TestCompact()
+	{
+		TestUtil::Random random(2);
+		auto vertices = MakeVertices(random, 10000, 100.0f, 50.0f, 4.0f);
+		CHECK(CheckError(VERTEX_FORMAT_COMPACT, vertices));
+
+		// positions stay float, directions are within a hundredth of a degree
+		auto error = MeasureVertexError(VERTEX_FORMAT_COMPACT, vertices);
+		CHECK(error.MaxPosition == 0.0f);
+		CHECK(error.MaxNormalAngle < 0.01f && error.MaxTangentAngle < 0.01f);
+
+		// texture coords in [-4, 4] are within half a step of a half at 4
+		CHECK(error.MaxTexCoord <= 4.0f / 2048.0f);
+
+		// the poles and the axes, where the octahedral folding meets, are exact
+		std::vector<MeshVertex> axes;
+		const DirectX::XMFLOAT3 directions[] = {
+			{ 1.0f, 0.0f, 0.0f }, { -1.0f, 0.0f, 0.0f },
+			{ 0.0f, 1.0f, 0.0f }, { 0.0f, -1.0f, 0.0f },
+			{ 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f, -1.0f },
+		};
+		for (auto& direction : directions)
+		{
+			axes.push_back(MeshVertex(DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f), direction, DirectX::XMFLOAT2(0.5f, 0.25f), direction));
+		}
+		error = MeasureVertexError(VERTEX_FORMAT_COMPACT, axes);
+		CHECK(error.MaxNormalAngle < 1.0e-3f && error.MaxTexCoord == 0.0f);
+
+		// directions which are not normalized are encoded as their direction, zero as +Z
+		std::vector<uint8_t> encoded;
+		std::vector<MeshVertex> decoded;
+		VertexQuantization quantization;
+		std::vector<MeshVertex> scaled(2, axes[0]);
+		scaled[0].Normal = DirectX::XMFLOAT3(0.0f, 5.0f, 0.0f);
+		scaled[1].Normal = DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f);
+		EncodeVertices(VERTEX_FORMAT_COMPACT, scaled, encoded, quantization);
+		DecodeVertices(VERTEX_FORMAT_COMPACT, encoded.data(), scaled.size(), quantization, decoded);
+		CHECK(std::abs(decoded[0].Normal.y - 1.0f) < 1.0e-6f);
+		CHECK(std::abs(decoded[1].Normal.z - 1.0f) < 1.0e-6f);
+	}
+
+	void TestQuantized()
+	{
+		TestUtil::Random random(3);
+		auto vertices = MakeVertices(random, 10000, -20.0f, 200.0f, 1.0f);
+		CHECK(CheckError(VERTEX_FORMAT_QUANTIZED, vertices));
+
+		// positions are within a step of unorm16 over the 200 unit box
+		auto error = MeasureVertexError(VERTEX_FORMAT_QUANTIZED, vertices);
+		CHECK(error.MaxPosition > 0.0f && error.MaxPosition <= 200.0f / 65535.0f);
+		CHECK(error.MaxNormalAngle < 0.01f);
+
+		// the dequantization covers the bounds
+		std::vector<uint8_t> encoded;
+		VertexQuantization quantization;
+		EncodeVertices(VERTEX_FORMAT_QUANTIZED, vertices, encoded, quantization);
+		CHECK(encoded.size() == 20 * vertices.size());
+		CHECK(quantization.Offset.x >= -120.0f && quantization.Offset.x + quantization.Scale.x <= 80.0f);
+		CHECK(quantization.Scale.x > 190.0f);
+
+		// a flat mesh keeps scale 1 on its flat axis, and its coordinate exactly
+		for (auto& vertex : vertices)
+		{
+			vertex.Position.y = 3.0f;
+		}
+		EncodeVertices(VERTEX_FORMAT_QUANTIZED, vertices, encoded, quantization);
+		CHECK(quantization.Scale.y == 1.0f && quantization.Offset.y == 3.0f);
+
+		std::vector<MeshVertex> decoded;
+		DecodeVertices(VERTEX_FORMAT_QUANTIZED, encoded.data(), vertices.size(), quantization, decoded);
+		auto isFlat = true;
+		for (auto& vertex : decoded)
+		{
+			isFlat &= (vertex.Position.y == 3.0f);
+		}
+		CHECK(isFlat);
+
+		// a single vertex round trips to its own position
+		std::vector<MeshVertex> single(1, vertices[0]);
+		error = MeasureVertexError(VERTEX_FORMAT_QUANTIZED, single);
+		CHECK(error.MaxPosition == 0.0f);
+	}
+
+	// meshes of random extents, positions and UV ranges stay in the limits of every format
+	void TestFuzz()
+	{
+		for (uint64_t seed = 0; seed < 50; ++seed)
+		{
+			TestUtil::Random random(seed);
+
+			auto center = (random.NextFloat() - 0.5f) * 2000.0f;
+			auto size = std::pow(10.0f, random.NextFloat() * 6.0f - 3.0f);
+			auto uvScale = std::pow(2.0f, float(random.Next(12)) - 4.0f);
+			auto vertices = MakeVertices(random, 1 + random.Next(2000), center, size, uvScale);
+
+			for (auto i = 0; i < VERTEX_FORMAT_COUNT; ++i)
+			{
+				if (!CheckError(VERTEX_FORMAT(i), vertices))
+				{
+					return;
+				}
+			}
+		}
+	}
+
+	// the half conversion of the shim matches what the GPU reads
+	void TestHalf()
+	{
+		using namespace DirectX::PackedVector;
+
+		CHECK(XMConvertFloatToHalf(1.0f) == 0x3c00);
+		CHECK(XMConvertFloatToHalf(-2.0f) == 0xc000);
+		CHECK(XMConvertFloatToHalf(65504.0f) == 0x7bff);
+		CHECK(XMConvertFloatToHalf(1.0e6f) == 0x7c00);
+		CHECK(XMConvertFloatToHalf(1.0e-10f) == 0);
+
+		// every finite half round trips, and the smallest denormal survives
+		auto isExact = true;
+		for (uint32_t bits = 0; bits < 0x10000; ++bits)
+		{
+			if ((bits & 0x7c00) != 0x7c00)
+			{
+				isExact &= (XMConvertFloatToHalf(XMConvertHalfToFloat(HALF(bits))) == bits);
+			}
+		}
+		CHECK(isExact);
+		CHECK(XMConvertHalfToFloat(1) == std::ldexp(1.0f, -24));
+
+		// ties go to even
+		CHECK(XMConvertFloatToHalf(1.0f + std::ldexp(1.0f, -11)) == 0x3c00);
+		CHECK(XMConvertFloatToHalf(1.0f + 3.0f * std::ldexp(1.0f, -11)) == 0x3c02);
+	}
+} // namespace
+
+int main()
+{
+	RUN_TEST(TestLayouts);
+	RUN_TEST(TestFull);
+	RUN_TEST(TestCompact);
+	RUN_TEST(TestQuantized);
+	RUN_TEST(TestFuzz);
+	RUN_TEST(TestHalf);
+	return TEST_RESULT();
+}